@@ -16,7 +16,7 @@
 #include <string>
 #include <vector>
 
-__forceinline std::wstring stringFormat(const wchar_t* fmt, ...)
+inline std::wstring stringFormat(const wchar_t* fmt, ...)
 {
 	if (!fmt) {
 		return L"";
@@ -28,7 +28,14 @@ __forceinline std::wstring stringFormat(const wchar_t* fmt, ...)
 	va_list ap;
 	va_start(ap, fmt);
 	while (true) {
-		int ret = _vsnwprintf_s(buff.data(), size, _TRUNCATE, fmt, ap);
+		va_list aq;
+		va_copy(aq, ap);
+#ifdef _WIN32
+		int ret = _vsnwprintf_s(buff.data(), size, _TRUNCATE, fmt, aq);
+#else
+		int ret = vswprintf(buff.data(), size, fmt, aq);
+#endif
+		va_end(aq);
 		if (ret != -1)
 			break;
 		else {
@@ -808,6 +815,29 @@ EXTERN char walock[MAXTILES];
 extern const char pow2char[8];
 extern const int32_t pow2long[32];
 
+// Change journal: the sprite list mutators (insertsprite, deletesprite,
+// changespritesect, changespritestat, setsprite) and the sector/wall writers
+// (alignceilslope, alignflorslope, setfirstwall) flag what they touch here.
+// The network snapshot consumes the bits and resets them with clearchangejournal().
+// changejournalreset is set when the sprite lists were rebuilt wholesale.
+EXTERN uint8_t spritejournal[(MAXSPRITES+7)>>3];
+EXTERN uint8_t spritelinkjournal[(MAXSPRITES+7)>>3];
+EXTERN uint8_t headsectjournal[(MAXSECTORS+1+7)>>3];
+EXTERN uint8_t headstatjournal[(MAXSTATUS+1+7)>>3];
+EXTERN uint8_t sectorjournal[(MAXSECTORS+7)>>3];
+EXTERN uint8_t walljournal[(MAXWALLS+7)>>3];
+EXTERN int32_t changejournalreset;
+
+FORCE_INLINE void journal_mark(uint8_t *bitmap, int32_t i)
+{
+    bitmap[i>>3] |= pow2char[i&7];
+}
+
+FORCE_INLINE int32_t journal_test(const uint8_t *bitmap, int32_t i)
+{
+    return bitmap[i>>3] & pow2char[i&7];
+}
+
 // picanm[].sf:
 // |bit(1<<7)
 // |animtype|animtype|texhitscan|nofullbright|speed|speed|speed|speed|
@@ -1051,6 +1081,7 @@ int32_t    initengine(void);
 int32_t E_PostInit(void);
 void   uninitengine(void);
 void   initspritelists(void);
+void   clearchangejournal(void);
 int32_t loadlookups(int32_t fp);
 void generatefogpals(void);
 void fillemptylookups(void);
@@ -1188,6 +1219,17 @@ void bfirst_search_try(int16_t *list, uint8_t *bitmap, int32_t *eltnumptr, int16
 
 extern int32_t clipmoveboxtracenum;
 
+// While clipprofiling is set, clipmove() and hitscan() add their calls and time in ms to clipprofile. The
+// caller resets it, the engine never does.
+typedef struct
+{
+    uint32_t clipmoves, hitscans;
+    double clipmovems, hitscanms;
+} clipprofile_t;
+
+extern int32_t clipprofiling;
+extern clipprofile_t clipprofile;
+
 int32_t   clipmove(vec3_t *vect, int16_t *sectnum, int32_t xvect, int32_t yvect, int32_t walldist,
                    int32_t ceildist, int32_t flordist, uint32_t cliptype) ATTRIBUTE((nonnull(1,2)));
 
@@ -1203,6 +1245,13 @@ void   getzrange(const vec3_t *vect, int16_t sectnum, int32_t *ceilz, int32_t *c
                  int32_t *florhit, int32_t walldist, uint32_t cliptype) ATTRIBUTE((nonnull(1,3,4,5,6)));
 int32_t   hitscan(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32_t vz,
                   hitdata_t *hitinfo, uint32_t cliptype) ATTRIBUTE((nonnull(1,6)));
+// hitscan that can run on several threads at once: it walks the sector lists rather than the clip grid and
+// leaves the sectors the ray went through in sectlist[0..*numsects), sectlist holding MAXSECTORS entries.
+// Returns -2 without a result where only hitscan can go on (sector-like sprites, sprites with
+// texture-tested hits, TROR).
+int32_t   hitscan_sectlist(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32_t vz,
+                           hitdata_t *hitinfo, uint32_t cliptype, int16_t *sectlist, int32_t *numsects)
+                           ATTRIBUTE((nonnull(1,6,8,9)));
 
 void   neartag(int32_t xs, int32_t ys, int32_t zs, int16_t sectnum, int16_t ange,
                int16_t *neartagsector, int16_t *neartagwall, int16_t *neartagsprite,
@@ -1210,6 +1259,18 @@ void   neartag(int32_t xs, int32_t ys, int32_t zs, int16_t sectnum, int16_t ange
                int32_t (*blacklist_sprite_func)(int32_t)) ATTRIBUTE((nonnull(6,7,8)));
 int32_t   cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1,
                  int32_t x2, int32_t y2, int32_t z2, int16_t sect2);
+// cansee with the caller's scratch space, so it can run on several threads at once. sectbitmap holds
+// MAXSECTORS bits and sectlist MAXSECTORS entries; the sectors the line of sight went through are left in
+// sectlist[0..*numsects).
+int32_t   cansee_internal(int32_t x1, int32_t y1, int32_t z1, int16_t sect1,
+                          int32_t x2, int32_t y2, int32_t z2, int16_t sect2,
+                          uint8_t *sectbitmap, int16_t *sectlist, int32_t *numsects) ATTRIBUTE((nonnull(9,10,11)));
+// cansee_internal from each of the heights z1[0..numz), numz at most 32. Sets bit k of *seemask if the k-th
+// height can see, returns -1 without trying if the line of sight could cross into another TROR bunch.
+int32_t   cansee_multi(int32_t x1, int32_t y1, const int32_t *z1, int32_t numz, int16_t sect1,
+                       int32_t x2, int32_t y2, int32_t z2, int16_t sect2,
+                       uint8_t *sectbitmap, int16_t *sectlist, int32_t *numsects, uint32_t *seemask)
+                       ATTRIBUTE((nonnull(3,10,11,12,13)));
 void   updatesector(int32_t x, int32_t y, int16_t *sectnum) ATTRIBUTE((nonnull(3)));
 void updatesectorbreadth(int32_t x, int32_t y, int16_t *sectnum) ATTRIBUTE((nonnull(3)));
 void updatesectorexclude(int32_t x, int32_t y, int16_t *sectnum,
@@ -6,13 +6,21 @@
 class BuildImage;
 
 #define BUILD3D_INLINE __forceinline
+#ifdef _WIN32
 #include <windows.h>
+#else
+// only the bits of windows.h build3d uses
+#include <float.h>
+typedef unsigned int UINT;
+#endif
 typedef unsigned char byte;
 
 #include "build.h"
 
 //#include "../../rhi/D3D12/Core/PCH.h"
+#ifndef BUILD_RHI_NULL
 #include <DirectXMath.h>
+#endif
 #include "../src/IntelBuildCPUT/CPUTMath.h"
 #include "../src/IntelBuildCPUT/AxisAlignedBox.h"
 
@@ -20,7 +28,19 @@ class BaseModel;
 class Build3DBoard;
 struct Build3DPlane;
 struct Build3DSprite;
-struct ModelUpdateQueuedItem;
+struct ModelUploadRange;
+struct Build3DVertex;
+struct Build3DPackedVertex;
+
+// Stores the board and model meshes with Build3DPackedVertex instead of Build3DVertex, VertexShaderShared.hlsli has
+// to be built with the same define.
+//#define BUILD3D_PACKED_VERTEX
+
+#ifdef BUILD3D_PACKED_VERTEX
+typedef Build3DPackedVertex Build3DGPUVertex;
+#else
+typedef Build3DVertex Build3DGPUVertex;
+#endif
 
 extern float *currentModelViewMatrixCulling;
 
@@ -52,8 +72,12 @@ struct BuildVertex
 
 #define MAX_CONCURRENT_DRAWBOARDS 5
 
+// Frames that can be in flight between the game and render thread, one being built, one queued and one rendering.
+#define MAX_SMP_FRAMES		3
+
 extern const Build3DPlane		*renderPlanesGlobalPool[MAX_CONCURRENT_DRAWBOARDS][60000];
 extern const Build3DPlane		*renderPlanesGlobalPool2[MAX_CONCURRENT_DRAWBOARDS][60000];
+extern const Build3DPlane		*renderPlanesGlobalPool3[MAX_CONCURRENT_DRAWBOARDS][60000];
 
 //
 // BuildRenderThreadTaskDrawLights
@@ -63,6 +87,7 @@ class PolymerNGLightLocal;
 struct BuildRenderThreadTaskDrawLights
 {
 	PolymerNGLightLocal *visibleLights[MAX_VISIBLE_LIGHTS];
+	float4 lightScreenRects[MAX_VISIBLE_LIGHTS];
 	int numLights;
 	float4x4 inverseModelViewMatrix;
 	float4x4 inverseModelViewProjectionMatrix;
@@ -95,6 +120,7 @@ struct BuildRenderThreadTaskRenderWorld
 		{
 			renderplanesFrames[i][0] = (const Build3DPlane	**)&renderPlanesGlobalPool[i][0]; // We only draw one board at a time.
 			renderplanesFrames[i][1] = (const Build3DPlane	**)&renderPlanesGlobalPool2[i][1]; // We only draw one board at a time.
+			renderplanesFrames[i][2] = (const Build3DPlane	**)&renderPlanesGlobalPool3[i][0]; // We only draw one board at a time.
 		}
 	}
 	float3					position;
@@ -105,7 +131,7 @@ struct BuildRenderThreadTaskRenderWorld
 	float4x4				skyProjMatrix;
 	float4x4				occlusionViewProjMatrix;
 	const Build3DPlane		**renderplanes;
-	const Build3DPlane		**renderplanesFrames[MAX_CONCURRENT_DRAWBOARDS][2];
+	const Build3DPlane		**renderplanesFrames[MAX_CONCURRENT_DRAWBOARDS][MAX_SMP_FRAMES];
 	int						numRenderPlanes;
 	const Build3DBoard		*board;
 	int						gameSmpFrame;
@@ -136,6 +162,11 @@ struct BuildRenderThreadTaskUpdateModel
 {
 	BaseModel *model;
 	BuildRHIMesh *rhiMesh;
+
+	// Merged ranges for this frame, dataOffset of each range indexes vertexData.
+	const ModelUploadRange *ranges;
+	int numRanges;
+	const Build3DGPUVertex *vertexData;
 };
 
 //
@@ -265,6 +296,164 @@ struct Build3DVertex
 	Build3DVector4 normal;
 };
 
+//
+// Build3DPackedVertex
+//
+// Half the size of Build3DVertex. Positions stay float since map coordinates go well past what 16 bits can hold, the
+// uvs are half floats and the normal is octahedral encoded. The sector number Build3DVertex keeps in uv.z gets its own
+// field.
+//
+struct Build3DPackedVertex
+{
+	float		position[3];
+	uint16_t	uv[2];
+	int16_t		normal[2];
+	uint16_t	sectorNum;
+	uint16_t	pad;
+};
+
+//
+// Build3D_FloatToHalf
+//
+BUILD3D_INLINE uint16_t Build3D_FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	// Too big (or not a number) clamps to the largest half.
+	if (exponent >= 31)
+		return (uint16_t)(sign | 0x7bff);
+
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+			return (uint16_t)sign;
+
+		mantissa |= 0x800000;
+		int32_t shift = 14 - exponent;
+		uint32_t half = (mantissa >> shift) + ((mantissa >> (shift - 1)) & 1);
+		return (uint16_t)(sign | half);
+	}
+
+	uint32_t half = (exponent << 10) | (mantissa >> 13);
+	half += (mantissa >> 12) & 1;
+	if (half >= 0x7c00)
+		half = 0x7bff;
+
+	return (uint16_t)(sign | half);
+}
+
+//
+// Build3D_HalfToFloat
+//
+BUILD3D_INLINE float Build3D_HalfToFloat(uint16_t half)
+{
+	uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+	int32_t exponent = (half >> 10) & 0x1f;
+	uint32_t mantissa = half & 0x3ff;
+	uint32_t bits;
+
+	if (exponent == 0)
+	{
+		float value = (float)mantissa * (1.0f / 16777216.0f);
+		return sign ? -value : value;
+	}
+
+	bits = sign | ((uint32_t)(exponent - 15 + 127) << 23) | (mantissa << 13);
+
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+//
+// Build3D_PackVertex
+//
+// A sectorNum of -1 keeps whatever the vertex has in uv.z.
+//
+BUILD3D_INLINE void Build3D_PackVertex(const Build3DVertex &in, int sectorNum, Build3DPackedVertex &out)
+{
+	out.position[0] = in.position.x;
+	out.position[1] = in.position.y;
+	out.position[2] = in.position.z;
+
+	out.uv[0] = Build3D_FloatToHalf(in.uv.x);
+	out.uv[1] = Build3D_FloatToHalf(in.uv.y);
+
+	// Project onto the octahedron and fold the lower half over the upper one.
+	float length = fabsf(in.normal.x) + fabsf(in.normal.y) + fabsf(in.normal.z);
+	float x = 0.0f, y = 0.0f;
+	if (length > 0.000001f)
+	{
+		x = in.normal.x / length;
+		y = in.normal.y / length;
+		if (in.normal.z < 0.0f)
+		{
+			float foldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float foldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+	}
+	out.normal[0] = (int16_t)floorf(x * 32767.0f + 0.5f);
+	out.normal[1] = (int16_t)floorf(y * 32767.0f + 0.5f);
+
+	out.sectorNum = (uint16_t)((sectorNum != -1) ? sectorNum : (int)in.uv.z);
+	out.pad = 0;
+}
+
+//
+// Build3D_UnpackVertex
+//
+BUILD3D_INLINE void Build3D_UnpackVertex(const Build3DPackedVertex &in, Build3DVertex &out)
+{
+	out.position = Build3DVector4(in.position[0], in.position[1], in.position[2], 1.0f);
+	out.uv = Build3DVector4(Build3D_HalfToFloat(in.uv[0]), Build3D_HalfToFloat(in.uv[1]), (float)in.sectorNum, 0.0f);
+
+	float x = (in.normal[0] > -32767) ? in.normal[0] / 32767.0f : -1.0f;
+	float y = (in.normal[1] > -32767) ? in.normal[1] / 32767.0f : -1.0f;
+	float z = 1.0f - fabsf(x) - fabsf(y);
+	if (z < 0.0f)
+	{
+		float unfoldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float unfoldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = unfoldedX;
+		y = unfoldedY;
+	}
+
+	float length = sqrtf(x * x + y * y + z * z);
+	out.normal = Build3DVector4(x / length, y / length, z / length, 0.0f);
+}
+
+//
+// Build3D_PackVertexes
+//
+// Converts to whatever the GPU meshes are stored as, a sectorNum of -1 keeps the sector already in uv.z.
+//
+BUILD3D_INLINE void Build3D_PackVertexes(const Build3DVertex *in, Build3DGPUVertex *out, int numVertexes, int sectorNum)
+{
+#ifdef BUILD3D_PACKED_VERTEX
+	for (int i = 0; i < numVertexes; i++)
+	{
+		Build3D_PackVertex(in[i], sectorNum, out[i]);
+	}
+#else
+	memcpy(out, in, sizeof(Build3DVertex) * numVertexes);
+
+	if (sectorNum != -1)
+	{
+		for (int i = 0; i < numVertexes; i++)
+		{
+			out[i].uv.z = sectorNum;
+		}
+	}
+#endif
+}
+
 //
 // Build3DPlane
 //
@@ -302,6 +491,7 @@ struct Build3DPlane
 		isMaskWall = false;
 
 		dynamic_vbo_offset = -1;
+		boundsIndex = -1;
 	}
 	// geometry
 	Build3DVertex*        buffer;
@@ -340,6 +530,10 @@ struct Build3DPlane
 	int					dynamic_vbo_offset;
 
 	unsigned int		sectorNum;
+
+	// Slot in the Build3DPlaneBounds of the board.
+	int					boundsIndex;
+
 	void				GetBoundsWorldSpace(float3 *mBoundingBoxCenterWorldSpace, float3 *mBoundingBoxHalfWorldSpace);
 	void				GetBoundsObjectSpace(float3 *mBoundingBoxCenterObjectSpace, float3 *mBoundingBoxHalfObjectSpace)
 	{
@@ -547,6 +741,7 @@ struct Build3DSprite
 	float4x4		    modelMatrix;
 	float4x4			modelViewInverse;
 	float4x4		    ViewMatrix;
+	float3				position;
 	uint32_t        hash;
 	bool			isHorizsprite;
 	bool			isWallSprite;
@@ -665,6 +860,49 @@ private:
 
 void computeplane(Build3DPlane* p);
 
+// Every sector owns a contiguous range of bounds, the ceiling and floor followed by the wall, over and mask plane of each of its walls.
+#define BUILD3D_PLANEBOUNDS_CEIL		0
+#define BUILD3D_PLANEBOUNDS_FLOOR		1
+#define BUILD3D_PLANEBOUNDS_FIRSTWALL	2
+#define BUILD3D_PLANEBOUNDS_PERWALL		3
+#define BUILD3D_PLANEBOUNDS_WALL		0
+#define BUILD3D_PLANEBOUNDS_OVER		1
+#define BUILD3D_PLANEBOUNDS_MASK		2
+
+//
+// Build3DPlaneBounds
+//
+// World space boxes of all the planes on the board, kept as a structure of arrays so the culling code can test
+// four planes at a time with SSE. A plane without geometry gets an inverted box and never passes a test.
+//
+class Build3DPlaneBounds
+{
+public:
+	Build3DPlaneBounds();
+	~Build3DPlaneBounds();
+
+	void		Init(int numPlanes);
+	void		UpdatePlane(const Build3DPlane *plane);
+
+	int			GetNumPlanes() const { return numPlanes; }
+
+	bool		IsPlaneInBox(int index, const float *mins, const float *maxs) const;
+
+	// results gets one byte per plane, non zero if the plane can be inside. It must have room for count rounded up to a multiple of 4.
+	void		CullToBox(int first, int count, const float *mins, const float *maxs, uint8_t *results) const;
+	void		CullToBoxScalar(int first, int count, const float *mins, const float *maxs, uint8_t *results) const;
+
+	// frustum is numFrustumPlanes planes laid out as a, b, c, d with the normals pointing inside.
+	void		CullToFrustum(int first, int count, const float *frustum, int numFrustumPlanes, uint8_t *results) const;
+	void		CullToFrustumScalar(int first, int count, const float *frustum, int numFrustumPlanes, uint8_t *results) const;
+
+	float		*minX, *minY, *minZ;
+	float		*maxX, *maxY, *maxZ;
+private:
+	int			numPlanes;
+	float		*data;
+};
+
 //
 // Build3DBoard
 //
@@ -692,6 +930,9 @@ public:
 
 	Build3DPlane **GetGlobalPlaneList() { return &planelist[0]; }
 	int GetNumGlobalPlanes() { return planelist.size(); }
+
+	const Build3DPlaneBounds &GetPlaneBounds() const { return planeBounds; }
+	int GetSectorPlaneBounds(int sectnum) const { return sectorPlaneBounds[sectnum]; }
 private:
 	bool     buildfloor(int16_t sectnum);
 	static void	 tesserror(int error);
@@ -708,6 +949,10 @@ private:
 
 	std::vector<Build3DPlane *> planelist;
 
+	Build3DPlaneBounds	planeBounds;
+	int					sectorPlaneBounds[MAXSECTORS];
+	int					wallPlaneBounds[MAXWALLS];
+
 	struct GLUtesselator*  prtess;
 };
 
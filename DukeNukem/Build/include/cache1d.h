@@ -111,6 +111,32 @@ extern "C" {
 		BuildFileOpenType openType;
 	};
 
+	//
+	// BuildMappedFile
+	//
+	// Read only mapping of a whole file, this only works for files on disk and not files inside a group file.
+	//
+	class BuildMappedFile
+	{
+	public:
+		~BuildMappedFile();
+
+		// Returns NULL if the file can't be found on the search path or can't be mapped.
+		static BuildMappedFile *OpenFile(const char *fileName);
+
+		const uint8_t *GetData() const { return data; }
+		int64_t		GetLength() const { return length; }
+	private:
+		BuildMappedFile();
+	private:
+		const uint8_t *data;
+		int64_t	length;
+#ifdef _WIN32
+		HANDLE	fileHandle;
+		HANDLE	mappingHandle;
+#endif
+	};
+
 	//
 	// kreadfile
 	__forceinline char    *kreadfile(const char *filename, uint32_t &flen)
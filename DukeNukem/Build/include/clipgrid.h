@@ -0,0 +1,131 @@
+// clipgrid.h
+//
+// Broad phase for clipmove, getzrange and hitscan. Every sprite in a sector list is bucketed into a hashed
+// uniform grid; a query gathers the sprites around the move box or along the hitscan ray once, and the narrow
+// phase then asks for them sector by sector, in the same order the headspritesect walk would have visited them.
+//
+
+#ifndef CLIPGRID_H
+#define CLIPGRID_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLIPGRID_CELLSHIFT		10
+#define CLIPGRID_CELLSIZE		(1<<CLIPGRID_CELLSHIFT)
+#define CLIPGRID_HASHSIZE		4096	// must be a power of two
+
+// Sprites reaching further than this from their center live in the wide list, which every query checks.
+#define CLIPGRID_MAXRADIUS		CLIPGRID_CELLSIZE
+
+// Below this many sprites the list walk is cheaper than gathering.
+#define CLIPGRID_MINSPRITES		256
+
+typedef struct
+{
+    int32_t cur, end;
+    int16_t next;
+    int8_t usegrid;
+} clipgrid_iter_t;
+
+typedef struct
+{
+    uint32_t boxqueries, rayqueries, listqueries;
+    uint64_t candidates;
+    uint32_t syncs, rebuckets;
+    uint32_t checkedcalls, mismatches;
+} clipgridstats_t;
+
+extern int32_t clipgrid_enable;
+extern int32_t clipgrid_check;
+extern clipgridstats_t clipgridstats;
+
+// Gather results, sorted by sector and then by sector list order.
+extern int16_t clipgridcand[MAXSPRITES];
+extern int32_t clipgridquerygen;
+extern int32_t clipgridsectgen[MAXSECTORS];
+extern int32_t clipgridsectstart[MAXSECTORS], clipgridsectend[MAXSECTORS];
+extern int8_t clipgridactive;
+
+// Sprite list hooks, called by the engine's list functions.
+void clipgrid_reset(void);
+void clipgrid_invalidate(void);
+void clipgrid_insertsprite(int16_t spritenum, int16_t sectnum);
+void clipgrid_deletesprite(int16_t spritenum);
+void clipgrid_updatesprite(int16_t spritenum);
+
+// Starts a query. If the grid isn't worth using, the iterators below fall back to the sector lists.
+void clipgrid_beginbox(int32_t xmin, int32_t ymin, int32_t xmax, int32_t ymax);
+void clipgrid_beginray(const vec3_t *sv, int32_t vx, int32_t vy);
+
+// Engine side, conservative distance from a sprite's position to anything the clipping code tests
+// against, -1 for sprites with sector-like clipping.
+int32_t clipgrid_spriteradius(const spritetype *spr);
+
+// The list walking versions of the queries, the public functions dispatch to these.
+int32_t clipmove_internal(vec3_t *pos, int16_t *sectnum, int32_t xvect, int32_t yvect,
+                          int32_t walldist, int32_t ceildist, int32_t flordist, uint32_t cliptype);
+void getzrange_internal(const vec3_t *pos, int16_t sectnum, int32_t *ceilz, int32_t *ceilhit, int32_t *florz,
+                        int32_t *florhit, int32_t walldist, uint32_t cliptype);
+int32_t hitscan_internal(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32_t vz,
+                         hitdata_t *hit, uint32_t cliptype);
+
+// Regression harness. While tracing, calls are recorded and/or run against both the grid and the sector
+// lists, the list result is what the caller gets.
+extern int32_t clipgrid_tracing;
+int32_t clipgrid_traceclipmove(vec3_t *pos, int16_t *sectnum, int32_t xvect, int32_t yvect,
+                               int32_t walldist, int32_t ceildist, int32_t flordist, uint32_t cliptype);
+void clipgrid_tracegetzrange(const vec3_t *pos, int16_t sectnum, int32_t *ceilz, int32_t *ceilhit, int32_t *florz,
+                             int32_t *florhit, int32_t walldist, uint32_t cliptype);
+int32_t clipgrid_tracehitscan(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32_t vz,
+                              hitdata_t *hit, uint32_t cliptype);
+
+void clipgrid_initosd(void);
+
+//
+// clipgrid_firstsprite
+//
+FORCE_INLINE int32_t clipgrid_firstsprite(clipgrid_iter_t *it, int32_t sectnum)
+{
+    it->usegrid = clipgridactive;
+
+    if (!it->usegrid)
+    {
+        const int32_t j = headspritesect[sectnum];
+        it->next = (j >= 0) ? nextspritesect[j] : -1;
+        return j;
+    }
+
+    if (clipgridsectgen[sectnum] != clipgridquerygen)
+        return -1;
+
+    it->cur = clipgridsectstart[sectnum];
+    it->end = clipgridsectend[sectnum];
+
+    return clipgridcand[it->cur++];
+}
+
+//
+// clipgrid_nextsprite
+//
+FORCE_INLINE int32_t clipgrid_nextsprite(clipgrid_iter_t *it)
+{
+    if (!it->usegrid)
+    {
+        const int32_t j = it->next;
+        it->next = (j >= 0) ? nextspritesect[j] : -1;
+        return j;
+    }
+
+    if (it->cur >= it->end)
+        return -1;
+
+    return clipgridcand[it->cur++];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -706,11 +706,19 @@ FORCE_INLINE uint16_t system_15bit_rand(void) { return ((uint16_t)rand())&0x7fff
 #  define Bchdir chdir
 #  define Bgetcwd getcwd
 # endif
-# define Bopen _open
-# define Bclose _close
-# define Bwrite _write
-# define Bread _read
-# define Blseek _lseek
+# ifdef _MSC_VER
+#  define Bopen _open
+#  define Bclose _close
+#  define Bwrite _write
+#  define Bread _read
+#  define Blseek _lseek
+# else
+#  define Bopen open
+#  define Bclose close
+#  define Bwrite write
+#  define Bread read
+#  define Blseek lseek
+# endif
 # if defined(__GNUC__)
 #  define Btell(h) lseek(h,0,SEEK_CUR)
 # else
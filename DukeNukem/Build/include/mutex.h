@@ -6,6 +6,8 @@
 #ifdef RENDERTYPEWIN
 # include <windows.h>
 # include <process.h>
+#elif defined BUILD_HEADLESS
+# include <pthread.h>
 #else
 # define SDL_MAIN_HANDLED
 # include "sdl_inc.h"
@@ -17,6 +19,8 @@ extern "C" {
 
 #ifdef RENDERTYPEWIN
 typedef HANDLE mutex_t;
+#elif defined BUILD_HEADLESS
+typedef pthread_mutex_t mutex_t;
 #else
 /* PK: I don't like pointer typedefs, but SDL_CreateMutex() _returns_ one,
  *     so we're out of luck with our interface. */
@@ -0,0 +1,27 @@
+// Null interface layer for the Build Engine
+// Headless builds (BUILD_HEADLESS) open no window and have no input devices, see nulllayer.cpp.
+
+#ifndef build_interface_layer_
+#define build_interface_layer_ HEADLESS
+
+extern uint32_t maxrefreshfreq;
+
+extern void idle_waitevent_timeout(uint32_t timeout);
+
+static inline void idle_waitevent(void)
+{
+    idle_waitevent_timeout(100);
+}
+
+static inline void idle(void)
+{
+    idle_waitevent();
+}
+
+#include "baselayer.h"
+
+#else
+#if (build_interface_layer_ != HEADLESS)
+#error "Already using the " build_interface_layer_ ". Can't now use the null layer."
+#endif
+#endif // build_interface_layer_
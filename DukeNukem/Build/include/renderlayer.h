@@ -1,6 +1,8 @@
 
 #ifdef RENDERTYPEWIN
 # include "winlayer.h"
+#elif defined BUILD_HEADLESS
+# include "nulllayer.h"
 #else
 # include "sdlayer.h"
 #endif
@@ -2,7 +2,7 @@
 #ifndef BUILD_SCRIPTFILE_H_
 #define BUILD_SCRIPTFILE_H_
 
-#include <Vector>
+#include <vector>
 
 typedef struct {
 	char *textbuf;
@@ -13,11 +13,17 @@ but WITHOUT ANY WARRANTY; without even the implied warranty of
 MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
 Lesser General Public License for more details.
 */
-#if 0
 
-typedef unsigned char   byte;
-typedef unsigned short  word;
-typedef unsigned int    dword;
+// DXT5YcocgCompression.cpp
+//
+// Reworked so the output pointer is passed along instead of living in a global, that lets images get compressed
+// in parallel. The plain RGB DXT1 and DXT5 compressors follow the same real-time approach from the same paper.
+//
+
+#include "DXT5YcocgCompression.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
 
 #define INSET_COLOR_SHIFT       4       // inset color bounding box
 #define INSET_ALPHA_SHIFT       5       // inset alpha bounding box
@@ -27,39 +33,54 @@ typedef unsigned int    dword;
 
 #define NVIDIA_G7X_HARDWARE_BUG_FIX     // keep the colors sorted as: max, min
 
-byte *globalOutData;
+typedef uint8_t         byte;
+typedef uint16_t        word;
+typedef uint32_t        dword;
 
-word ColorTo565(const byte *color) {
+static word ColorTo565(const byte *color) {
 	return ((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3);
 }
 
-void EmitByte(byte b) {
-	globalOutData[0] = b;
-	globalOutData += 1;
+static void EmitByte(byte *&outData, byte b) {
+	outData[0] = b;
+	outData += 1;
 }
 
-void EmitWord(word s) {
-	globalOutData[0] = (s >> 0) & 255;
-	globalOutData[1] = (s >> 8) & 255;
-	globalOutData += 2;
+static void EmitWord(byte *&outData, word s) {
+	outData[0] = (s >> 0) & 255;
+	outData[1] = (s >> 8) & 255;
+	outData += 2;
 }
 
-void EmitDoubleWord(dword i) {
-	globalOutData[0] = (i >> 0) & 255;
-	globalOutData[1] = (i >> 8) & 255;
-	globalOutData[2] = (i >> 16) & 255;
-	globalOutData[3] = (i >> 24) & 255;
-	globalOutData += 4;
+static void EmitDoubleWord(byte *&outData, dword i) {
+	outData[0] = (i >> 0) & 255;
+	outData[1] = (i >> 8) & 255;
+	outData[2] = (i >> 16) & 255;
+	outData[3] = (i >> 24) & 255;
+	outData += 4;
 }
 
-void ExtractBlock(const byte *inPtr, const int width, byte *colorBlock) {
+// Pixels past the right or bottom edge repeat the last row and column.
+static void ExtractBlock(const byte *inBuf, const int width, const int height, const int x, const int y, byte *colorBlock) {
+	if (x + 4 <= width && y + 4 <= height) {
+		const byte *inPtr = inBuf + (y * width + x) * 4;
+		for (int j = 0; j < 4; j++) {
+			memcpy(&colorBlock[j * 4 * 4], inPtr, 4 * 4);
+			inPtr += width * 4;
+		}
+		return;
+	}
+
 	for (int j = 0; j < 4; j++) {
-		memcpy(&colorBlock[j * 4 * 4], inPtr, 4 * 4);
-		inPtr += width * 4;
+		int py = (y + j < height) ? y + j : height - 1;
+		for (int i = 0; i < 4; i++) {
+			int px = (x + i < width) ? x + i : width - 1;
+			memcpy(&colorBlock[(j * 4 + i) * 4], inBuf + (py * width + px) * 4, 4);
+		}
 	}
 }
 
-void GetMinMaxYCoCg(byte *colorBlock, byte *minColor, byte *maxColor) {
+static void GetMinMaxYCoCg(const byte *colorBlock, byte *minColor, byte *maxColor) {
 	minColor[0] = minColor[1] = minColor[2] = minColor[3] = 255;
 	maxColor[0] = maxColor[1] = maxColor[2] = maxColor[3] = 0;
 
@@ -91,7 +112,7 @@ void GetMinMaxYCoCg(byte *colorBlock, byte *minColor, byte *maxColor) {
 	}
 }
 
-void ScaleYCoCg(byte *colorBlock, byte *minColor, byte *maxColor) {
+static void ScaleYCoCg(byte *colorBlock, byte *minColor, byte *maxColor) {
 	int m0 = abs(minColor[0] - 128);
 	int m1 = abs(minColor[1] - 128);
 	int m2 = abs(maxColor[0] - 128);
@@ -122,7 +143,7 @@ void ScaleYCoCg(byte *colorBlock, byte *minColor, byte *maxColor) {
 	}
 }
 
-void InsetYCoCgBBox(byte *minColor, byte *maxColor) {
+static void InsetYCoCgBBox(byte *minColor, byte *maxColor) {
 	int inset[4];
 	int mini[4];
 	int maxi[4];
@@ -156,7 +177,7 @@ void InsetYCoCgBBox(byte *minColor, byte *maxColor) {
 	maxColor[3] = maxi[3];
 }
 
-void SelectYCoCgDiagonal(const byte *colorBlock, byte *minColor, byte *maxColor) const {
+static void SelectYCoCgDiagonal(const byte *colorBlock, byte *minColor, byte *maxColor) {
 	byte mid0 = ((int)minColor[0] + maxColor[0] + 1) >> 1;
 	byte mid1 = ((int)minColor[1] + maxColor[1] + 1) >> 1;
 
@@ -169,20 +190,23 @@ void SelectYCoCgDiagonal(const byte *colorBlock, byte *minColor, byte *maxColor)
 
 	byte mask = -(side > 8);
 
-#ifdef NVIDIA_7X_HARDWARE_BUG_FIX
+#ifdef NVIDIA_G7X_HARDWARE_BUG_FIX
 	mask &= -(minColor[0] != maxColor[0]);
 #endif
 
 	byte c0 = minColor[1];
 	byte c1 = maxColor[1];
 
-	c0 ^= c1 ^= mask &= c0 ^= c1;
+	c0 ^= c1;
+	mask &= c0;
+	c1 ^= mask;
+	c0 ^= c1;
 
 	minColor[1] = c0;
 	maxColor[1] = c1;
 }
 
-void EmitAlphaIndices(const byte *colorBlock, const byte minAlpha, const byte maxAlpha) {
+static void EmitAlphaIndices(byte *&outData, const byte *colorBlock, const byte minAlpha, const byte maxAlpha) {
 
 	assert(maxAlpha >= minAlpha);
 
@@ -214,18 +238,18 @@ void EmitAlphaIndices(const byte *colorBlock, const byte minAlpha, const byte ma
 		indexes[i] = index ^ (2 > index);
 	}
 
-	EmitByte((indexes[0] >> 0) | (indexes[1] << 3) | (indexes[2] << 6));
-	EmitByte((indexes[2] >> 2) | (indexes[3] << 1) | (indexes[4] << 4) | (indexes[5] << 7));
-	EmitByte((indexes[5] >> 1) | (indexes[6] << 2) | (indexes[7] << 5));
+	EmitByte(outData, (indexes[0] >> 0) | (indexes[1] << 3) | (indexes[2] << 6));
+	EmitByte(outData, (indexes[2] >> 2) | (indexes[3] << 1) | (indexes[4] << 4) | (indexes[5] << 7));
+	EmitByte(outData, (indexes[5] >> 1) | (indexes[6] << 2) | (indexes[7] << 5));
 
-	EmitByte((indexes[8] >> 0) | (indexes[9] << 3) | (indexes[10] << 6));
-	EmitByte((indexes[10] >> 2) | (indexes[11] << 1) | (indexes[12] << 4) | (indexes[13] << 7));
-	EmitByte((indexes[13] >> 1) | (indexes[14] << 2) | (indexes[15] << 5));
+	EmitByte(outData, (indexes[8] >> 0) | (indexes[9] << 3) | (indexes[10] << 6));
+	EmitByte(outData, (indexes[10] >> 2) | (indexes[11] << 1) | (indexes[12] << 4) | (indexes[13] << 7));
+	EmitByte(outData, (indexes[13] >> 1) | (indexes[14] << 2) | (indexes[15] << 5));
 }
 
-void EmitColorIndices(const byte *colorBlock, const byte *minColor, const byte *maxColor) {
+static void EmitYCoCgColorIndices(byte *&outData, const byte *colorBlock, const byte *minColor, const byte *maxColor) {
 	word colors[4][4];
-	unsigned int result = 0;
+	dword result = 0;
 
 	colors[0][0] = (maxColor[0] & C565_5_MASK) | (maxColor[0] >> 5);
 	colors[0][1] = (maxColor[1] & C565_6_MASK) | (maxColor[1] >> 6);
@@ -245,10 +269,8 @@ void EmitColorIndices(const byte *colorBlock, const byte *minColor, const byte *
 	colors[3][3] = 0;
 
 	for (int i = 15; i >= 0; i--) {
-		int c0, c1, d0, d1, d2, d3;
-
-		c0 = colorBlock[i * 4 + 0];
-		c1 = colorBlock[i * 4 + 1];
+		int c0 = colorBlock[i * 4 + 0];
+		int c1 = colorBlock[i * 4 + 1];
 
 		int d0 = abs(colors[0][0] - c0) + abs(colors[0][1] - c1);
 		int d1 = abs(colors[1][0] - c0) + abs(colors[1][1] - c1);
@@ -268,40 +290,150 @@ void EmitColorIndices(const byte *colorBlock, const byte *minColor, const byte *
 		result |= (x2 | ((x0 | x1) << 1)) << (i << 1);
 	}
 
-	EmitUInt(result);
+	EmitDoubleWord(outData, result);
 }
 
-bool CompressYCoCgDXT5(const byte *inBuf, byte *outBuf, int width, int height, int &outputBytes) {
+static void GetMinMaxColors(const byte *colorBlock, byte *minColor, byte *maxColor) {
+	GetMinMaxYCoCg(colorBlock, minColor, maxColor);
+
+	// Pull the box in a bit, the end points are hit less often than the colors between them.
+	byte inset[3];
+	inset[0] = (maxColor[0] - minColor[0]) >> INSET_COLOR_SHIFT;
+	inset[1] = (maxColor[1] - minColor[1]) >> INSET_COLOR_SHIFT;
+	inset[2] = (maxColor[2] - minColor[2]) >> INSET_COLOR_SHIFT;
+
+	minColor[0] = (minColor[0] + inset[0] <= 255) ? minColor[0] + inset[0] : 255;
+	minColor[1] = (minColor[1] + inset[1] <= 255) ? minColor[1] + inset[1] : 255;
+	minColor[2] = (minColor[2] + inset[2] <= 255) ? minColor[2] + inset[2] : 255;
+
+	maxColor[0] = (maxColor[0] >= inset[0]) ? maxColor[0] - inset[0] : 0;
+	maxColor[1] = (maxColor[1] >= inset[1]) ? maxColor[1] - inset[1] : 0;
+	maxColor[2] = (maxColor[2] >= inset[2]) ? maxColor[2] - inset[2] : 0;
+}
+
+static void EmitColorIndices(byte *&outData, const byte *colorBlock, const byte *minColor, const byte *maxColor) {
+	int colors[4][3];
+	dword result = 0;
+
+	colors[0][0] = (maxColor[0] & C565_5_MASK) | (maxColor[0] >> 5);
+	colors[0][1] = (maxColor[1] & C565_6_MASK) | (maxColor[1] >> 6);
+	colors[0][2] = (maxColor[2] & C565_5_MASK) | (maxColor[2] >> 5);
+	colors[1][0] = (minColor[0] & C565_5_MASK) | (minColor[0] >> 5);
+	colors[1][1] = (minColor[1] & C565_6_MASK) | (minColor[1] >> 6);
+	colors[1][2] = (minColor[2] & C565_5_MASK) | (minColor[2] >> 5);
+	colors[2][0] = (2 * colors[0][0] + 1 * colors[1][0]) / 3;
+	colors[2][1] = (2 * colors[0][1] + 1 * colors[1][1]) / 3;
+	colors[2][2] = (2 * colors[0][2] + 1 * colors[1][2]) / 3;
+	colors[3][0] = (1 * colors[0][0] + 2 * colors[1][0]) / 3;
+	colors[3][1] = (1 * colors[0][1] + 2 * colors[1][1]) / 3;
+	colors[3][2] = (1 * colors[0][2] + 2 * colors[1][2]) / 3;
+
+	for (int i = 15; i >= 0; i--) {
+		int r = colorBlock[i * 4 + 0];
+		int g = colorBlock[i * 4 + 1];
+		int b = colorBlock[i * 4 + 2];
+
+		int d0 = abs(colors[0][0] - r) + abs(colors[0][1] - g) + abs(colors[0][2] - b);
+		int d1 = abs(colors[1][0] - r) + abs(colors[1][1] - g) + abs(colors[1][2] - b);
+		int d2 = abs(colors[2][0] - r) + abs(colors[2][1] - g) + abs(colors[2][2] - b);
+		int d3 = abs(colors[3][0] - r) + abs(colors[3][1] - g) + abs(colors[3][2] - b);
+
+		bool b0 = d0 > d3;
+		bool b1 = d1 > d2;
+		bool b2 = d0 > d2;
+		bool b3 = d1 > d3;
+		bool b4 = d2 > d3;
+
+		int x0 = b1 & b2;
+		int x1 = b0 & b3;
+		int x2 = b0 & b4;
+
+		result |= (x2 | ((x0 | x1) << 1)) << (i << 1);
+	}
+
+	EmitDoubleWord(outData, result);
+}
+
+bool CompressImageDXT1(const byte *inBuf, byte *outBuf, int width, int height, int &outputBytes) {
 	byte block[64];
 	byte minColor[4];
 	byte maxColor[4];
+	byte *outData = outBuf;
+
+	for (int j = 0; j < height; j += 4) {
+		for (int i = 0; i < width; i += 4) {
+			ExtractBlock(inBuf, width, height, i, j, block);
+			GetMinMaxColors(block, minColor, maxColor);
+
+			EmitWord(outData, ColorTo565(maxColor));
+			EmitWord(outData, ColorTo565(minColor));
 
-	globalOutData = outBuf;
+			EmitColorIndices(outData, block, minColor, maxColor);
+		}
+	}
+
+	outputBytes = outData - outBuf;
+
+	return true;
+}
+
+bool CompressImageDXT5(const byte *inBuf, byte *outBuf, int width, int height, int &outputBytes) {
+	byte block[64];
+	byte minColor[4];
+	byte maxColor[4];
+	byte *outData = outBuf;
+
+	for (int j = 0; j < height; j += 4) {
+		for (int i = 0; i < width; i += 4) {
+			ExtractBlock(inBuf, width, height, i, j, block);
+			GetMinMaxColors(block, minColor, maxColor);
+
+			EmitByte(outData, maxColor[3]);
+			EmitByte(outData, minColor[3]);
+
+			EmitAlphaIndices(outData, block, minColor[3], maxColor[3]);
+
+			EmitWord(outData, ColorTo565(maxColor));
+			EmitWord(outData, ColorTo565(minColor));
+
+			EmitColorIndices(outData, block, minColor, maxColor);
+		}
+	}
+
+	outputBytes = outData - outBuf;
+
+	return true;
+}
+
+bool CompressYCoCgDXT5(const byte *inBuf, byte *outBuf, int width, int height, int &outputBytes) {
+	byte block[64];
+	byte minColor[4];
+	byte maxColor[4];
+	byte *outData = outBuf;
 
-	for (int j = 0; j < height; j += 4, inBuf += width * 4 * 4) {
+	for (int j = 0; j < height; j += 4) {
 		for (int i = 0; i < width; i += 4) {
 
-			ExtractBlock(inBuf + i * 4, width, block);
+			ExtractBlock(inBuf, width, height, i, j, block);
 
 			GetMinMaxYCoCg(block, minColor, maxColor);
 			ScaleYCoCg(block, minColor, maxColor);
 			InsetYCoCgBBox(minColor, maxColor);
 			SelectYCoCgDiagonal(block, minColor, maxColor);
 
-			EmitByte(maxColor[3]);
-			EmitByte(minColor[3]);
+			EmitByte(outData, maxColor[3]);
+			EmitByte(outData, minColor[3]);
 
-			EmitAlphaIndices(block, minColor[3], maxColor[3]);
+			EmitAlphaIndices(outData, block, minColor[3], maxColor[3]);
 
-			EmitUShort(ColorTo565(maxColor));
-			EmitUShort(ColorTo565(minColor));
+			EmitWord(outData, ColorTo565(maxColor));
+			EmitWord(outData, ColorTo565(minColor));
 
-			EmitColorIndices(block, minColor, maxColor);
+			EmitYCoCgColorIndices(outData, block, minColor, maxColor);
 		}
 	}
 
-	outputBytes = globalOutData - outBuf;
+	outputBytes = outData - outBuf;
 
 	return true;
 }
-#endif
\ No newline at end of file
@@ -0,0 +1,28 @@
+// DXT5YcocgCompression.h
+//
+
+#pragma once
+
+#include <stdint.h>
+
+//
+// Real-time DXT block compression.
+//
+// The input is 32 bit RGBA, width * height * 4 bytes, and none of these keep any state between calls so images can
+// be compressed on as many threads at once as you like. Sizes that are not a multiple of 4 repeat the edge pixels
+// into the partial blocks.
+//
+
+// Bytes of compressed data for an image, blockSize is 8 for DXT1 and 16 for DXT5.
+inline int DXT_GetCompressedSize(int width, int height, int blockSize)
+{
+	int blocksX = (width + 3) / 4;
+	int blocksY = (height + 3) / 4;
+	return (blocksX > 0 ? blocksX : 1) * (blocksY > 0 ? blocksY : 1) * blockSize;
+}
+
+bool CompressImageDXT1(const uint8_t *inBuf, uint8_t *outBuf, int width, int height, int &outputBytes);
+bool CompressImageDXT5(const uint8_t *inBuf, uint8_t *outBuf, int width, int height, int &outputBytes);
+
+// The input has to be converted to CoCg_Y already, Co in red, Cg in green and Y in alpha.
+bool CompressYCoCgDXT5(const uint8_t *inBuf, uint8_t *outBuf, int width, int height, int &outputBytes);
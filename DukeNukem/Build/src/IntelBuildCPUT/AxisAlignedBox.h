@@ -0,0 +1,65 @@
+// AxisAlignedBox.h
+//
+// The bounding box build3d keeps for each sector, included from the bottom of CPUTMath.h. Only what the board
+// and the light code use: growing the box point by point and testing a light's sphere against it.
+//
+
+#ifndef __AxisAlignedBox_h__
+#define __AxisAlignedBox_h__
+
+#include <float.h>
+
+namespace Math
+{
+    //
+    // AxisAlignedBox
+    //
+    // Stays plain data, Build3DSector memsets it. An empty box has min above max and intersects nothing.
+    //
+    struct AxisAlignedBox
+    {
+        float3 minExtent;
+        float3 maxExtent;
+
+        void Clear()
+        {
+            minExtent = float3(FLT_MAX);
+            maxExtent = float3(-FLT_MAX);
+        }
+
+        // Same as Clear, the next add starts the box.
+        void Zero() { Clear(); }
+
+        bool isEmpty() const
+        {
+            return minExtent.x > maxExtent.x || minExtent.y > maxExtent.y || minExtent.z > maxExtent.z;
+        }
+
+        void add(const float3 &point)
+        {
+            minExtent = float3(fminf(minExtent.x, point.x), fminf(minExtent.y, point.y), fminf(minExtent.z, point.z));
+            maxExtent = float3(fmaxf(maxExtent.x, point.x), fmaxf(maxExtent.y, point.y), fmaxf(maxExtent.z, point.z));
+        }
+
+        // True if the sphere reaches into the box, the distance from the center to the closest point inside it.
+        bool intersectsSphere(const float3 &center, float radius) const
+        {
+            if (isEmpty())
+                return false;
+
+            float distSq = 0.0f;
+
+            for (int i = 0; i < 3; i++)
+            {
+                if (center.f[i] < minExtent.f[i])
+                    distSq += (minExtent.f[i] - center.f[i]) * (minExtent.f[i] - center.f[i]);
+                else if (center.f[i] > maxExtent.f[i])
+                    distSq += (center.f[i] - maxExtent.f[i]) * (center.f[i] - maxExtent.f[i]);
+            }
+
+            return distSq <= radius * radius;
+        }
+    };
+}
+
+#endif // #ifndef __AxisAlignedBox_h__
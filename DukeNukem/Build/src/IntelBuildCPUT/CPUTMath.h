@@ -500,7 +500,7 @@ inline float3 abs3( const float3 &l )
 /**************************************\
 float4
 \**************************************/
-__declspec(align(16)) struct float4
+struct alignas(16) float4
 {
     union
     {
@@ -688,12 +688,9 @@ float3x3
 struct float4x4;
 struct float3x3
 {
-    struct
-    {
-        float3 r0;
-        float3 r1;
-        float3 r2;
-    };
+    float3 r0;
+    float3 r1;
+    float3 r2;
 
     /***************************************\
     |   Constructors                        |
@@ -1022,13 +1019,10 @@ float4x4
 \**************************************/
 struct float4x4
 {
-    struct
-    {
-        float4 r0;
-        float4 r1;
-        float4 r2;
-        float4 r3;
-    };
+    float4 r0;
+    float4 r1;
+    float4 r2;
+    float4 r3;
 
     /***************************************\
     |   Constructors                        |
@@ -1,44 +1,279 @@
 // BaseModel.cpp
 //
 
-#include "../PolymerNG.h"
+#include "../PolymerNG_local.h"
+
+#include <algorithm>
+
+static ModelUploadStats uploadStats;
+
+//
+// osdcmd_vertexuploadstats
+//
+static int32_t osdcmd_vertexuploadstats(const osdfuncparm_t *parm)
+{
+	if (parm->numparms == 1 && !Bstrcasecmp(parm->parms[0], "reset"))
+	{
+		BaseModel::ResetUploadStats();
+		return OSDCMD_OK;
+	}
+
+	if (parm->numparms != 0)
+		return OSDCMD_SHOWHELP;
+
+	BaseModel::PrintUploadStats();
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_vertexformatreport
+//
+static int32_t osdcmd_vertexformatreport(const osdfuncparm_t *parm)
+{
+	if (polymerNGPrivate.currentBoard == NULL)
+	{
+		initprintf("No board loaded\n");
+		return OSDCMD_OK;
+	}
+
+	polymerNGPrivate.currentBoard->GetBoard()->GetBaseModel()->PrintVertexFormatReport();
+
+	return OSDCMD_OK;
+}
+
+BaseModelStagingRing::BaseModelStagingRing()
+{
+	head = 0;
+	for (int i = 0; i < MODEL_UPLOAD_SLOTS; i++)
+	{
+		slotStart[i] = slotEnd[i] = 0;
+	}
+}
+
+Build3DGPUVertex *BaseModelStagingRing::Allocate(int slot, int numVertexes)
+{
+	// Whatever this slot held last time around has been consumed by now.
+	slotStart[slot] = slotEnd[slot] = 0;
+
+	if (numVertexes <= 0 || numVertexes > MODEL_STAGING_RING_VERTEXES)
+		return NULL;
+
+	// Most models never upload anything, so the memory is only grabbed on the first upload.
+	if (vertexes.empty())
+	{
+		vertexes.resize(MODEL_STAGING_RING_VERTEXES);
+	}
+
+	int start = head;
+	if (start + numVertexes > MODEL_STAGING_RING_VERTEXES)
+	{
+		start = 0;
+	}
+
+	for (int i = 0; i < MODEL_UPLOAD_SLOTS; i++)
+	{
+		if (i == slot || slotStart[i] == slotEnd[i])
+			continue;
+
+		if (start < slotEnd[i] && start + numVertexes > slotStart[i])
+			return NULL;
+	}
+
+	slotStart[slot] = start;
+	slotEnd[slot] = start + numVertexes;
+	head = start + numVertexes;
+
+	return &vertexes[start];
+}
 
 BaseModel::BaseModel()
 {
 	rhiVertexBufferStatic = NULL;
-	numUpdateQueues = 0;
-	dynamicBufferDirty[0] = false;
-	dynamicBufferDirty[1] = false;
+	numDirtyRanges = 0;
 	//meshVertexes.reserve(300);
 }
 
-void BaseModel::AllocateBuffer(int size)
+void BaseModel::Init()
 {
-	meshVertexes.resize(size);
+	ResetUploadStats();
+
+	OSD_RegisterFunction("r_vertexformatreport", "r_vertexformatreport: compares the memory and bandwidth of the full and packed vertex layouts for the current board", osdcmd_vertexformatreport);
+	OSD_RegisterFunction("r_vertexuploadstats", "r_vertexuploadstats [reset]: prints how many dynamic vertex ranges and bytes get uploaded per frame", osdcmd_vertexuploadstats);
 }
 
-int BaseModel::UpdateBuffer(int startPosition, int numVertexes, Build3DVertex *vertexes, int sectorNum, bool cpuUpdateOnly)
+void BaseModel::PrintUploadStats()
 {
-	Build3DVertex *vertexpool = &meshVertexes[startPosition];
-	memcpy(vertexpool, vertexes, sizeof(Build3DVertex) * numVertexes);
+	const ModelUploadStats &stats = uploadStats;
 
-	if (cpuUpdateOnly)
-		return startPosition;
+	if (stats.numFrames == 0)
+	{
+		initprintf("No vertex uploads yet\n");
+		return;
+	}
+
+	initprintf("Vertex uploads over %llu frames\n", (unsigned long long)stats.numFrames);
+	initprintf("  %.1f ranges queued, %.1f uploaded per frame\n", (double)stats.numRangesQueued / stats.numFrames, (double)stats.numRangesUploaded / stats.numFrames);
+	initprintf("  %.1fkb per frame, %.1fkb max\n", (double)stats.bytesUploaded / stats.numFrames / 1024.0, (double)stats.maxBytesPerFrame / 1024.0);
+	initprintf("  %llu range list overflows, %llu frames uploaded without staging\n", (unsigned long long)stats.numOverflows, (unsigned long long)stats.numStagingFallbacks);
+}
 
-	if (sectorNum != -1)
+void BaseModel::ResetUploadStats()
+{
+	memset(&uploadStats, 0, sizeof(uploadStats));
+}
+
+void BaseModel::PrintVertexFormatReport() const
+{
+	const uint64_t numVertexes = meshVertexes.size();
+	const uint64_t fullSize = numVertexes * sizeof(Build3DVertex);
+	const uint64_t packedSize = numVertexes * sizeof(Build3DPackedVertex);
+	const double uploadedVertexesPerFrame = uploadStats.numFrames ? (double)uploadStats.bytesUploaded / sizeof(Build3DGPUVertex) / uploadStats.numFrames : 0.0;
+
+	initprintf("--------Vertex Format Report (%llu vertexes, %s in use)--------\n", (unsigned long long)numVertexes, (sizeof(Build3DGPUVertex) == sizeof(Build3DPackedVertex)) ? "packed" : "full");
+	initprintf("..full:   %d bytes per vertex, %.2fmb cpu + %.2fmb gpu, %.1fkb uploaded per frame\n", (int)sizeof(Build3DVertex), fullSize / 1048576.0, fullSize / 1048576.0, uploadedVertexesPerFrame * sizeof(Build3DVertex) / 1024.0);
+	initprintf("..packed: %d bytes per vertex, %.2fmb cpu + %.2fmb gpu, %.1fkb uploaded per frame\n", (int)sizeof(Build3DPackedVertex), packedSize / 1048576.0, packedSize / 1048576.0, uploadedVertexesPerFrame * sizeof(Build3DPackedVertex) / 1024.0);
+
+	// Every draw reads each vertex it touches once at least, so vertex fetch bandwidth scales the same way.
+	initprintf("..packed saves %.2fmb and %.0f%% of the vertex fetch and upload bandwidth\n", (fullSize - packedSize) / 1048576.0, 100.0 - (sizeof(Build3DPackedVertex) * 100.0) / sizeof(Build3DVertex));
+}
+
+void BaseModel::AddDirtyRange(int startVertex, int numVertexes)
+{
+	uploadStats.numRangesQueued++;
+
+	// Walls and sectors mostly get updated in buffer order, so the new range usually continues the last one.
+	if (numDirtyRanges > 0)
 	{
-		for (int i = 0; i < numVertexes; i++)
+		ModelUploadRange &last = dirtyRanges[numDirtyRanges - 1];
+		if (startVertex >= last.startVertex && startVertex <= last.startVertex + last.numVertexes + MODEL_DIRTY_RANGE_MERGE_GAP)
 		{
-			vertexpool[i].uv.z = sectorNum;
+			last.numVertexes = max(last.numVertexes, startVertex + numVertexes - last.startVertex);
+			return;
 		}
 	}
 
-	ModelUpdateQueuedItem *queuedItem = &modelUpdateQueue[numUpdateQueues++];
-	queuedItem->startPosition = startPosition;
-	queuedItem->numVertexes = numVertexes;
+	if (numDirtyRanges == MODEL_MAX_DIRTY_RANGES)
+	{
+		MergeDirtyRanges();
 
-	dynamicBufferDirty[0] = true;
-	dynamicBufferDirty[1] = true;
+		// Still too scattered to track, upload everything between the first and the last range instead.
+		if (numDirtyRanges > MODEL_MAX_DIRTY_RANGES / 2)
+		{
+			int endVertex = dirtyRanges[numDirtyRanges - 1].startVertex + dirtyRanges[numDirtyRanges - 1].numVertexes;
+			dirtyRanges[0].numVertexes = endVertex - dirtyRanges[0].startVertex;
+			numDirtyRanges = 1;
+		}
+
+		uploadStats.numOverflows++;
+	}
+
+	dirtyRanges[numDirtyRanges].startVertex = startVertex;
+	dirtyRanges[numDirtyRanges].numVertexes = numVertexes;
+	dirtyRanges[numDirtyRanges].dataOffset = 0;
+	numDirtyRanges++;
+}
+
+void BaseModel::MergeDirtyRanges()
+{
+	if (numDirtyRanges <= 1)
+		return;
+
+	std::sort(&dirtyRanges[0], &dirtyRanges[numDirtyRanges], [](const ModelUploadRange &a, const ModelUploadRange &b) {
+		return a.startVertex < b.startVertex;
+	});
+
+	int numMerged = 0;
+	for (int i = 1; i < numDirtyRanges; i++)
+	{
+		ModelUploadRange &merged = dirtyRanges[numMerged];
+		const ModelUploadRange &range = dirtyRanges[i];
+
+		if (range.startVertex <= merged.startVertex + merged.numVertexes + MODEL_DIRTY_RANGE_MERGE_GAP)
+		{
+			merged.numVertexes = max(merged.numVertexes, range.startVertex + range.numVertexes - merged.startVertex);
+		}
+		else
+		{
+			dirtyRanges[++numMerged] = range;
+		}
+	}
+
+	numDirtyRanges = numMerged + 1;
+}
+
+void BaseModel::BuildUploadCommand(int drawRoomsIdx, int smpFrame, BuildRenderThreadTaskUpdateModel &task)
+{
+	int slot = (drawRoomsIdx * MAX_SMP_FRAMES) + smpFrame;
+
+	MergeDirtyRanges();
+
+	std::vector<ModelUploadRange> &ranges = uploadRanges[slot];
+	ranges.resize(numDirtyRanges);
+
+	int numVertexes = 0;
+	for (int i = 0; i < numDirtyRanges; i++)
+	{
+		ranges[i] = dirtyRanges[i];
+		ranges[i].dataOffset = numVertexes;
+		numVertexes += dirtyRanges[i].numVertexes;
+	}
+
+	// The vertexes get copied out now, so the game thread can keep changing the mesh while the render thread uploads.
+	Build3DGPUVertex *staging = stagingRing.Allocate(slot, numVertexes);
+	if (staging != NULL)
+	{
+		for (int i = 0; i < numDirtyRanges; i++)
+		{
+			memcpy(&staging[ranges[i].dataOffset], &meshVertexes[ranges[i].startVertex], sizeof(Build3DGPUVertex) * ranges[i].numVertexes);
+		}
+
+		task.vertexData = staging;
+	}
+	else
+	{
+		// Too much for the ring, upload straight out of the mesh like before.
+		for (int i = 0; i < numDirtyRanges; i++)
+		{
+			ranges[i].dataOffset = ranges[i].startVertex;
+		}
+
+		task.vertexData = &meshVertexes[0];
+		uploadStats.numStagingFallbacks++;
+	}
+
+	task.ranges = &ranges[0];
+	task.numRanges = numDirtyRanges;
+
+	uint64_t numBytes = (uint64_t)numVertexes * sizeof(Build3DGPUVertex);
+	uploadStats.numFrames++;
+	uploadStats.numRangesUploaded += numDirtyRanges;
+	uploadStats.bytesUploaded += numBytes;
+	uploadStats.maxBytesPerFrame = max(uploadStats.maxBytesPerFrame, numBytes);
+
+	numDirtyRanges = 0;
+}
+
+void BaseModel::AllocateBuffer(int size)
+{
+	meshVertexes.resize(size);
+}
+
+int BaseModel::UpdateBuffer(int startPosition, int numVertexes, Build3DVertex *vertexes, int sectorNum, bool cpuUpdateOnly)
+{
+	if (startPosition < 0 || numVertexes <= 0 || startPosition + numVertexes > meshVertexes.size())
+	{
+		initprintf("BaseModel::UpdateBuffer: Tried to update vertexes outside of the buffer!\n");
+		return startPosition;
+	}
+
+	// CPU only updates have always kept the sector the vertexes came with.
+	Build3D_PackVertexes(vertexes, &meshVertexes[startPosition], numVertexes, cpuUpdateOnly ? -1 : sectorNum);
+
+	if (cpuUpdateOnly)
+		return startPosition;
+
+	AddDirtyRange(startPosition, numVertexes);
 
 	return startPosition;
 }
@@ -75,17 +310,8 @@ int BaseModel::AddVertexesToBuffer(int numVertexes, Build3DVertex *vertexes, int
 {
 	int startPosition = meshVertexes.size();
 	meshVertexes.resize(startPosition + numVertexes);
-	Build3DVertex *vertexpool = &meshVertexes[startPosition];
 
-	memcpy(vertexpool, vertexes, sizeof(Build3DVertex) * numVertexes);
-
-	if (sectorNum != -1)
-	{
-		for (int i = 0; i < numVertexes; i++)
-		{
-			vertexpool[i].uv.z = sectorNum;
-		}
-	}
+	Build3D_PackVertexes(vertexes, &meshVertexes[startPosition], numVertexes, sectorNum);
 
 	//for (int i = numVertexes - 1; i >= 0; i--)
 	//{
@@ -6,6 +6,45 @@
 void CacheModel::Init(const PolymerNGModelCachePayload *payload)
 {
 	this->payload = payload;
+
+	boundsMin = float3(FLT_MAX, FLT_MAX, FLT_MAX);
+	boundsMax = float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	for (int i = 0; i < payload->modelCacheInfo.numSurfaces; i++)
+	{
+		CacheModelSurface *surface = &surfaces[i];
+
+		// Chunked caches come with the bounds already worked out by MeshBuildTool.
+		if (payload->hasSurfaceBounds)
+		{
+			const ModelCacheSurfaceBounds &bounds = payload->surfaceBounds[i];
+			surface->boundsMin = float3(bounds.mins[0], bounds.mins[1], bounds.mins[2]);
+			surface->boundsMax = float3(bounds.maxs[0], bounds.maxs[1], bounds.maxs[2]);
+		}
+		else
+		{
+			surface->boundsMin = float3(FLT_MAX, FLT_MAX, FLT_MAX);
+			surface->boundsMax = float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+			const ModelCacheSurface &cacheSurface = payload->surfaces[i];
+			for (int d = 0; d < cacheSurface.numVertexes; d++)
+			{
+				const Build3DVector4 &position = payload->vertexes[cacheSurface.startVertex + d].position;
+
+				surface->boundsMin = float3(min(surface->boundsMin.x, position.x), min(surface->boundsMin.y, position.y), min(surface->boundsMin.z, position.z));
+				surface->boundsMax = float3(max(surface->boundsMax.x, position.x), max(surface->boundsMax.y, position.y), max(surface->boundsMax.z, position.z));
+			}
+		}
+
+		boundsMin = float3(min(boundsMin.x, surface->boundsMin.x), min(boundsMin.y, surface->boundsMin.y), min(boundsMin.z, surface->boundsMin.z));
+		boundsMax = float3(max(boundsMax.x, surface->boundsMax.x), max(boundsMax.y, surface->boundsMax.y), max(boundsMax.z, surface->boundsMax.z));
+	}
+}
+
+void CacheModel::GetBounds(float3 &mins, float3 &maxs) const
+{
+	mins = boundsMin;
+	maxs = boundsMax;
 }
 
 void CacheModel::SetTextureForSurface(PolymerNGModelCacheSurfaceDefine *cacheSurfaceDefines)
@@ -16,6 +16,10 @@ struct CacheModelSurface
 
 	int startIndex;
 	int numIndexes;
+
+	// Model space bounds of the surface, lets the surfaces of a model be culled one by one.
+	float3 boundsMin;
+	float3 boundsMax;
 };
 
 //
@@ -38,9 +42,15 @@ public:
 
 	// Functions needed for rendering.
 	BaseModel		*GetBaseModel() { return baseMesh; }
+
+	// Model space bounds of every vertex in the payload.
+	void			GetBounds(float3 &mins, float3 &maxs) const;
 private:
 	const PolymerNGModelCachePayload *payload;
 	CacheModelSurface	surfaces[20];
 
 	BaseModel		*baseMesh;
+
+	float3			boundsMin;
+	float3			boundsMax;
 };
@@ -5,6 +5,20 @@
 
 #define MODELCACHE_PAYLOAD_IDEN "jmModelPayload"
 
+// Same layout, except the vertexes are written as Build3DPackedVertex.
+#define MODELCACHE_PAYLOAD_PACKED_IDEN "jmModelPacked"
+
+// Each payload is the payload info, the surfaces, a ModelCacheSurfaceBounds per surface and then a run of chunks
+// ending with MODELCACHE_CHUNK_END. The vertex and index data is split into chunks so it can be inflated a piece at
+// a time straight into the payload, without ever holding the whole thing compressed in memory.
+#define MODELCACHE_PAYLOAD_CHUNKED_IDEN "jmModelChunks"
+
+// Largest decompressed chunk, chunks always hold whole vertexes or indexes.
+#define MODELCACHE_CHUNK_SIZE (64 * 1024)
+
+// Most surfaces a payload can have.
+#define MAX_MODEL_SURFACES 20
+
 //
 // ModelCacheHeader
 // 
@@ -15,6 +29,9 @@ struct ModelCacheHeader
 		strcpy(iden, MODELCACHE_PAYLOAD_IDEN);
 		numPayloads = 0;
 	}
+
+	bool HasPackedVertexes() const { return !strncmp(iden, MODELCACHE_PAYLOAD_PACKED_IDEN, sizeof(iden)); }
+	bool IsChunked() const { return !strncmp(iden, MODELCACHE_PAYLOAD_CHUNKED_IDEN, sizeof(iden)); }
 	char iden[14];
 	int numPayloads;
 };
@@ -53,3 +70,45 @@ struct ModelCachePayloadInfo
 	int numFrames;
 };
 
+
+//
+// ModelCacheSurfaceBounds
+//
+// Model space bounds of the vertexes a surface draws.
+//
+struct ModelCacheSurfaceBounds
+{
+	float mins[3];
+	float maxs[3];
+};
+
+//
+// ModelCacheChunkType
+//
+enum ModelCacheChunkType
+{
+	MODELCACHE_CHUNK_END = 0,
+	MODELCACHE_CHUNK_VERTEXES,			// Build3DVertex
+	MODELCACHE_CHUNK_PACKED_VERTEXES,	// Build3DPackedVertex
+	MODELCACHE_CHUNK_INDEXES			// unsigned int, relative to the surface's startVertex like always
+};
+
+//
+// ModelCacheChunkCodec
+//
+enum ModelCacheChunkCodec
+{
+	MODELCACHE_CODEC_STORED = 0,
+	MODELCACHE_CODEC_ZLIB
+};
+
+//
+// ModelCacheChunkHeader
+//
+struct ModelCacheChunkHeader
+{
+	int type;
+	int codec;
+	int compressedLength;
+	int decompressedLength;
+};
@@ -17,6 +17,8 @@ PolymerNGModelCache::PolymerNGModelCache()
 void PolymerNGModelCache::LoadModelCache()
 {
 	ModelCacheHeader header;
+	hasPackedVertexes = false;
+	isChunked = false;
 	cacheFile = BuildFile::OpenFile(MODELCACHE_FILENAME, BuildFile::BuildFile_Read);
 	if (cacheFile == NULL)
 	{
@@ -33,11 +35,120 @@ void PolymerNGModelCache::LoadModelCache()
 	payloads = new PolymerNGModelCachePayload[header.numPayloads];
 
 	numPayloads = header.numPayloads;
+	hasPackedVertexes = header.HasPackedVertexes();
+	isChunked = header.IsChunked();
 
 	// Read in all the payload info.
 	cacheFile->Read(payloadHeaders, header.numPayloads * sizeof(ModelCachePayloadHeader));
 
-	initprintf("Model Cache has %d payloads\n", numPayloads);
+	initprintf("Model Cache has %d payloads%s\n", numPayloads, isChunked ? " in chunks" : (hasPackedVertexes ? " with packed vertexes" : ""));
+}
+
+//
+// PolymerNGModelCache::ReadPayloadChunks
+//
+// Inflates the chunks of a payload straight into its vertex and index arrays, packed vertexes go through chunkData.
+//
+bool PolymerNGModelCache::ReadPayloadChunks(PolymerNGModelCachePayload *payload)
+{
+	int numVertexesRead = 0;
+	int numIndexesRead = 0;
+
+	chunkBuffer.resize(MODELCACHE_CHUNK_SIZE);
+	chunkData.resize(MODELCACHE_CHUNK_SIZE);
+
+	while (true)
+	{
+		ModelCacheChunkHeader chunk;
+		if (cacheFile->Read(&chunk, sizeof(ModelCacheChunkHeader)) != sizeof(ModelCacheChunkHeader))
+			return false;
+
+		if (chunk.type == MODELCACHE_CHUNK_END)
+			break;
+
+		if (chunk.decompressedLength <= 0 || chunk.decompressedLength > MODELCACHE_CHUNK_SIZE || chunk.compressedLength <= 0 || chunk.compressedLength > MODELCACHE_CHUNK_SIZE)
+			return false;
+
+		int elementSize;
+		int numElements;
+		byte *dest;
+		switch (chunk.type)
+		{
+			case MODELCACHE_CHUNK_VERTEXES:
+				elementSize = sizeof(Build3DVertex);
+				numElements = chunk.decompressedLength / elementSize;
+				if (numVertexesRead + numElements > payload->modelCacheInfo.numVertexes)
+					return false;
+				dest = (byte *)&payload->vertexes[numVertexesRead];
+				break;
+
+			case MODELCACHE_CHUNK_PACKED_VERTEXES:
+				elementSize = sizeof(Build3DPackedVertex);
+				numElements = chunk.decompressedLength / elementSize;
+				if (numVertexesRead + numElements > payload->modelCacheInfo.numVertexes)
+					return false;
+				dest = &chunkData[0];
+				break;
+
+			case MODELCACHE_CHUNK_INDEXES:
+				elementSize = sizeof(unsigned int);
+				numElements = chunk.decompressedLength / elementSize;
+				if (numIndexesRead + numElements > payload->modelCacheInfo.numIndexes)
+					return false;
+				dest = (byte *)&payload->indexes[numIndexesRead];
+				break;
+
+			default:
+				return false;
+		}
+
+		if (numElements * elementSize != chunk.decompressedLength)
+			return false;
+
+		if (chunk.codec == MODELCACHE_CODEC_STORED)
+		{
+			if (chunk.compressedLength != chunk.decompressedLength)
+				return false;
+
+			cacheFile->Read(dest, chunk.decompressedLength);
+		}
+		else
+		{
+			cacheFile->Read(&chunkBuffer[0], chunk.compressedLength);
+
+			z_stream infstream;
+			infstream.zalloc = Z_NULL;
+			infstream.zfree = Z_NULL;
+			infstream.opaque = Z_NULL;
+			infstream.avail_in = (uInt)chunk.compressedLength;
+			infstream.next_in = (Bytef *)&chunkBuffer[0];
+			infstream.avail_out = (uInt)chunk.decompressedLength;
+			infstream.next_out = (Bytef *)dest;
+
+			if (inflateInit(&infstream) != Z_OK)
+				return false;
+			int result = inflate(&infstream, Z_FINISH);
+			inflateEnd(&infstream);
+			if (result != Z_STREAM_END || infstream.total_out != chunk.decompressedLength)
+				return false;
+		}
+
+		if (chunk.type == MODELCACHE_CHUNK_PACKED_VERTEXES)
+		{
+			const Build3DPackedVertex *packedVertexes = (const Build3DPackedVertex *)&chunkData[0];
+			for (int i = 0; i < numElements; i++)
+			{
+				Build3D_UnpackVertex(packedVertexes[i], payload->vertexes[numVertexesRead + i]);
+			}
+		}
+
+		if (chunk.type == MODELCACHE_CHUNK_INDEXES)
+			numIndexesRead += numElements;
+		else
+			numVertexesRead += numElements;
+	}
+
+	return numVertexesRead == payload->modelCacheInfo.numVertexes && numIndexesRead == payload->modelCacheInfo.numIndexes;
 }
 
 void PolymerNGModelCache::BeginLevelLoad()
@@ -109,10 +220,43 @@ CacheModel *PolymerNGModelCache::LoadModelForTile(int tileNum)
 	currentPayload->vertexes = new Build3DVertex[currentPayload->modelCacheInfo.numVertexes];
 	currentPayload->indexes = new unsigned int[currentPayload->modelCacheInfo.numIndexes];
 
-	cacheFile->Read(&currentPayload->vertexes[0], currentPayload->modelCacheInfo.numVertexes * sizeof(Build3DVertex));
+	// The payload always hands out full vertexes, BaseModel packs them again if the GPU meshes are packed.
+	if (isChunked)
+	{
+		cacheFile->Read(&currentPayload->surfaceBounds[0], currentPayload->modelCacheInfo.numSurfaces * sizeof(ModelCacheSurfaceBounds));
+		currentPayload->hasSurfaceBounds = true;
+
+		if (!ReadPayloadChunks(currentPayload))
+		{
+			initprintf("PolymerNGModelCache: Failed to read payload %s\n", currentPayloadInfo->modelpath);
+
+			delete[] currentPayload->vertexes;
+			delete[] currentPayload->indexes;
+			currentPayload->vertexes = NULL;
+			currentPayload->indexes = NULL;
+
+			// Don't try again every time the tile is drawn.
+			tileCacheOverride[tileNum].payloadHeader = NULL;
+			return NULL;
+		}
+	}
+	else if (hasPackedVertexes)
+	{
+		std::vector<Build3DPackedVertex> packedVertexes(currentPayload->modelCacheInfo.numVertexes);
+		cacheFile->Read(&packedVertexes[0], currentPayload->modelCacheInfo.numVertexes * sizeof(Build3DPackedVertex));
+
+		for (int i = 0; i < currentPayload->modelCacheInfo.numVertexes; i++)
+		{
+			Build3D_UnpackVertex(packedVertexes[i], currentPayload->vertexes[i]);
+		}
+	}
+	else
+	{
+		cacheFile->Read(&currentPayload->vertexes[0], currentPayload->modelCacheInfo.numVertexes * sizeof(Build3DVertex));
+	}
 	cacheFile->Read(&currentPayload->indexes[0], currentPayload->modelCacheInfo.numIndexes * sizeof(unsigned int));
 
-	totalSizeOfHighQualityAssets += currentPayload->modelCacheInfo.numVertexes * sizeof(Build3DVertex);
+	totalSizeOfHighQualityAssets += currentPayload->modelCacheInfo.numVertexes * sizeof(Build3DGPUVertex);
 	totalSizeOfHighQualityAssets += currentPayload->modelCacheInfo.numIndexes * sizeof(unsigned int);
 
 	loadedmodels[tileNum] = new CacheModel();
@@ -159,7 +303,7 @@ bool PolymerNGModelCache::SetModelTile(const char *fileName, int tileNum)
 
 	for (int i = 0; i < numPayloads; i++)
 	{
-		if (!stricmp(payloadHeaders[i].modelpath, fileName))
+		if (!Bstrcasecmp(payloadHeaders[i].modelpath, fileName))
 		{
 			currentPayloadInfo = &payloadHeaders[i];
 			currentPayload = &payloads[i];
@@ -12,8 +12,6 @@
 class CacheModel;
 class BuildFile;
 
-#define MAX_MODEL_SURFACES 20
-
 //
 // PolymerNGModelCachePayload
 //
@@ -27,6 +25,10 @@ struct PolymerNGModelCachePayload
 	ModelCachePayloadInfo	modelCacheInfo;
 	ModelCacheSurface		surfaces[MAX_MODEL_SURFACES];
 
+	// Only chunked caches store these, CacheModel works them out itself otherwise.
+	bool					hasSurfaceBounds;
+	ModelCacheSurfaceBounds	surfaceBounds[MAX_MODEL_SURFACES];
+
 	unsigned int	*indexes;
 	Build3DVertex *vertexes;
 };
@@ -61,10 +63,17 @@ public:
 	bool SetModelTile(const char *fileName, int tileNum);
 private:
 	void LoadModelCache();
+	bool ReadPayloadChunks(PolymerNGModelCachePayload *payload);
 
 	BuildFile *cacheFile;
 	int numPayloads;
 	int totalSizeOfHighQualityAssets;
+	bool hasPackedVertexes;
+	bool isChunked;
+
+	// Compressed chunks are read into here, never bigger than a chunk.
+	std::vector<byte> chunkBuffer;
+	std::vector<byte> chunkData;
 
 	ModelCachePayloadHeader *payloadHeaders;
 	PolymerNGModelCachePayload *payloads;
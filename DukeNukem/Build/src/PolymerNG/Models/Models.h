@@ -19,13 +19,62 @@ struct PolymerNGModelCacheSurfaceDefine
 
 class BuildRHIMesh;
 
+// Dirty ranges queued up between two uploads, when it fills up the ranges are merged and finally collapsed into one.
+#define MODEL_MAX_DIRTY_RANGES			4096
+
+// Ranges closer than this many vertexes are uploaded as one, the few clean vertexes are cheaper than another update.
+#define MODEL_DIRTY_RANGE_MERGE_GAP		16
+
+// Vertexes the staging ring holds for all the frames in flight.
+#define MODEL_STAGING_RING_VERTEXES		65536
+
+// Uploads are double buffered the same way as the render plane lists, one slot per DrawRooms call and SMP frame.
+#define MODEL_UPLOAD_SLOTS				(MAX_CONCURRENT_DRAWBOARDS * MAX_SMP_FRAMES)
+
 //
-// ModelUpdateQueuedItem
+// ModelUploadRange
 //
-struct ModelUpdateQueuedItem
+struct ModelUploadRange
 {
-	int startPosition;
+	int startVertex;
 	int numVertexes;
+
+	// Where the vertexes for this range start in the upload data.
+	int dataOffset;
+};
+
+//
+// ModelUploadStats
+//
+struct ModelUploadStats
+{
+	uint64_t numFrames;
+	uint64_t numRangesQueued;
+	uint64_t numRangesUploaded;
+	uint64_t bytesUploaded;
+	uint64_t maxBytesPerFrame;
+	uint64_t numOverflows;
+	uint64_t numStagingFallbacks;
+};
+
+//
+// BaseModelStagingRing
+//
+// Persistent staging memory for the vertex uploads, every upload slot gets a contiguous span. A span is only handed out
+// again once its slot comes around, which is when the render thread is done with it.
+//
+class BaseModelStagingRing
+{
+public:
+	BaseModelStagingRing();
+
+	// Returns NULL if the frames still in flight don't leave enough room.
+	Build3DGPUVertex		*Allocate(int slot, int numVertexes);
+private:
+	std::vector<Build3DGPUVertex> vertexes;
+	int						head;
+	int						slotStart[MODEL_UPLOAD_SLOTS];
+	int						slotEnd[MODEL_UPLOAD_SLOTS];
 };
 
 //
@@ -43,15 +92,32 @@ public:
 	int						AddIndexesToBuffer(int numIndexes, unsigned short *indexes, int startVertexPosition);
 	int						AddIndexesToBuffer(int numIndexes, unsigned int *indexes, int startVertexPosition);
 
-	std::vector<Build3DVertex> meshVertexes;
+	bool					HasPendingUploads() const { return numDirtyRanges > 0; }
+
+	// Game thread, merges everything queued since the last call into one upload for the render thread.
+	void					BuildUploadCommand(int drawRoomsIdx, int smpFrame, BuildRenderThreadTaskUpdateModel &task);
+
+	static void				Init();
+	static void				PrintUploadStats();
+	static void				ResetUploadStats();
+
+	// Compares what the mesh costs with either vertex layout.
+	void					PrintVertexFormatReport() const;
+
+	// Stored the way the GPU wants them, see BUILD3D_PACKED_VERTEX.
+	std::vector<Build3DGPUVertex> meshVertexes;
 	std::vector<unsigned int>  meshIndexes;
 
 	BuildRHIMesh			*rhiVertexBufferStatic;
+private:
+	void					AddDirtyRange(int startVertex, int numVertexes);
+	void					MergeDirtyRanges();
 
-	ModelUpdateQueuedItem   modelUpdateQueue[5000];
-	int	numUpdateQueues;
+	ModelUploadRange		dirtyRanges[MODEL_MAX_DIRTY_RANGES];
+	int						numDirtyRanges;
 
-	bool					dynamicBufferDirty[2];
+	std::vector<ModelUploadRange> uploadRanges[MODEL_UPLOAD_SLOTS];
+	BaseModelStagingRing	stagingRing;
 };
 
 #include "ModelCacheFormat.h"
@@ -21,6 +21,11 @@ void PolymerNG::Init()
 
 	renderer.Init();
 	imageManager.Init();
+	cameraPath.Init();
+	lightBinning.Init();
+	planeCulling.Init();
+	PolymerNGVisibilityEngine::Init();
+	BaseModel::Init();
 }
 
 //
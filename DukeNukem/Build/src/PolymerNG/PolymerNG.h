@@ -13,7 +13,7 @@
 #include "../RHI/BuildRHI.h"
 #include "PolymerNG_Image.h"
 #include "PolymerNG_Material.h"
-#include "../../Include/build3d.h"
+#include "../../include/build3d.h"
 #include "Models/Models.h"
 #include "PolymerNG_Material.h"
 #include "TextureCache/TextureCache.h"
@@ -42,8 +42,8 @@ public:
 	PolymerNGLight *AddLightToCurrentBoard(PolymerNGLightOpts lightOpts);
 	virtual void RemoveLightFromCurrentBoard(PolymerNGLight *);
 
-	// Loads in the new board.
-	void		LoadBoard();
+	// Loads in the new board, textures visible from startSectorNum are loaded first.
+	void		LoadBoard(int16_t startSectorNum);
 	void		DrawRooms(int32_t daposx, int32_t daposy, int32_t daposz, int16_t daang, int32_t dahoriz, int16_t dacursectnum);
 
 
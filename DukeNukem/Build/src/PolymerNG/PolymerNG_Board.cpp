@@ -6,16 +6,18 @@
 
 #include "../engine_priv.h"
 #include "Models/Models.h"
+#include "../Profiler/profiler.h"
 
 /*
 =============
 PolymerNGBoard::PolymerNGBoard
 =============
 */
-PolymerNGBoard::PolymerNGBoard()
+PolymerNGBoard::PolymerNGBoard(int16_t startSectorNum)
 {
 	visibilityEngine = new PolymerNGVisibilityEngine(this);
-	InitBoard();
+	lightGatherFrame = 0;
+	InitBoard(startSectorNum);
 }
 
 /*
@@ -84,15 +86,79 @@ void PolymerNGBoard::FindMapSky()
 	}
 }
 
+/*
+=============
+PolymerNGBoard::QueueBoardTextures
+
+Walks the sectors breadth first from the start sector, so the high quality textures the player
+sees first are the first ones the texture cache workers inflate, while we build the geometry.
+=============
+*/
+void PolymerNGBoard::QueueBoardTextures(int16_t startSectorNum)
+{
+	static int16_t sectorQueue[MAXSECTORS];
+	static uint8_t sectorQueued[(MAXSECTORS + 7) >> 3];
+	int queueHead = 0, queueTail = 0;
+
+	Bmemset(sectorQueued, 0, sizeof(sectorQueued));
+
+	if (startSectorNum >= 0 && startSectorNum < numsectors)
+	{
+		sectorQueue[queueTail++] = startSectorNum;
+		sectorQueued[startSectorNum >> 3] |= pow2char[startSectorNum & 7];
+	}
+
+	// Anything we can't reach from the start sector goes in last, in sector order.
+	for (int nextUnreached = 0; queueHead < numsectors; )
+	{
+		if (queueHead == queueTail)
+		{
+			while (sectorQueued[nextUnreached >> 3] & pow2char[nextUnreached & 7])
+				nextUnreached++;
+			sectorQueue[queueTail++] = nextUnreached;
+			sectorQueued[nextUnreached >> 3] |= pow2char[nextUnreached & 7];
+		}
+
+		int16_t sectnum = sectorQueue[queueHead++];
+		const sectortype *sec = &::sector[sectnum];
+
+		imageManager.QueueTileLoad(sec->ceilingpicnum);
+		imageManager.QueueTileLoad(sec->floorpicnum);
+
+		for (int w = sec->wallptr; w < sec->wallptr + sec->wallnum; w++)
+		{
+			imageManager.QueueTileLoad(::wall[w].picnum);
+			if (::wall[w].cstat & 16)
+				imageManager.QueueTileLoad(::wall[w].overpicnum);
+
+			int16_t nextsectnum = ::wall[w].nextsector;
+			if (nextsectnum >= 0 && !(sectorQueued[nextsectnum >> 3] & pow2char[nextsectnum & 7]))
+			{
+				sectorQueue[queueTail++] = nextsectnum;
+				sectorQueued[nextsectnum >> 3] |= pow2char[nextsectnum & 7];
+			}
+		}
+
+		for (int i = headspritesect[sectnum]; i >= 0; i = nextspritesect[i])
+		{
+			imageManager.QueueTileLoad(::sprite[i].picnum);
+		}
+	}
+
+	imageManager.SubmitQueuedTileLoads();
+}
+
 /*
 =============
 PolymerNGBoard::InitBoard
 =============
 */
-void PolymerNGBoard::InitBoard()
+void PolymerNGBoard::InitBoard(int16_t startSectorNum)
 {
 	imageManager.BeginLevelLoad();
 	modelCacheSystem.BeginLevelLoad();
+
+	QueueBoardTextures(startSectorNum);
 	
 	board = new Build3DBoard();
 
@@ -198,6 +264,8 @@ PolymerNG::DrawRooms
 */
 void PolymerNGBoard::DrawRooms(int32_t daposx, int32_t daposy, int32_t daposz, int16_t daang, int32_t dahoriz, int16_t dacursectnum)
 {
+	BUILD_PROFILE_SCOPE("PolymerNGBoard::DrawRooms");
+
 	float           skyhoriz, ang, tiltang;
 	float			horizang;
 	float4x4 viewMatrix, rotationMatrix;
@@ -257,21 +325,6 @@ void PolymerNGBoard::DrawRooms(int32_t daposx, int32_t daposy, int32_t daposz, i
 	updatesectorbreadth(daposx, daposy, &cursectnum);
 
 	int smpframe = renderer.GetCurrentFrameNum();
-	{
-		if (board->GetBaseModel()->dynamicBufferDirty[smpframe])
-		{
-			BuildRenderCommand command;
-			command.taskId = BUILDRENDER_TASK_UPDATEMODEL;
-			command.taskUpdateModel.rhiMesh = board->GetBaseModel()->rhiVertexBufferStatic;
-
-			command.taskUpdateModel.model = board->GetBaseModel();
-			board->GetBaseModel()->dynamicBufferDirty[smpframe] = false;
-			renderer.AddRenderCommand(command);
-		}
-		
-	}
-
-
 
 	{
 		BuildRenderCommand command;
@@ -281,7 +334,21 @@ void PolymerNGBoard::DrawRooms(int32_t daposx, int32_t daposy, int32_t daposz, i
 		command.taskRenderWorld.skyMaterialHandle = boardSkyMaterial;
 		command.taskRenderWorld.gameSmpFrame = smpframe;
 		command.taskRenderWorld.renderplanes = command.taskRenderWorld.renderplanesFrames[currentDrawRoomsIdx][smpframe];
+		planeCulling.SetFrustum(modelViewProjection, position);
+		visibilityEngine->BeginOcclusion(occlusionViewProjection);
 		FindVisibleSectors(command.taskRenderWorld, modelViewProjection, viewMatrix, projectionMatrix, cursectnum);
+		visibilityEngine->RasterizeOccluders();
+
+		// Sectors and walls the gather just rebuilt get uploaded before the world draws with them.
+		if (board->GetBaseModel()->HasPendingUploads())
+		{
+			BuildRenderCommand updateCommand;
+			updateCommand.taskId = BUILDRENDER_TASK_UPDATEMODEL;
+			updateCommand.taskUpdateModel.rhiMesh = board->GetBaseModel()->rhiVertexBufferStatic;
+			updateCommand.taskUpdateModel.model = board->GetBaseModel();
+			board->GetBaseModel()->BuildUploadCommand(currentDrawRoomsIdx, smpframe, updateCommand.taskUpdateModel);
+			renderer.AddRenderCommand(updateCommand);
+		}
 
 		float4x4 inverseView = viewMatrix;
 		inverseView.invert();
@@ -334,7 +401,7 @@ void PolymerNGBoard::DrawRooms(int32_t daposx, int32_t daposy, int32_t daposz, i
 		command.taskDrawLights.cameraposition = float4(position.x, position.y, position.z, 1.0);
 
 		float4x4 viewMatrix_((float *)&viewMatrix);
-		FindVisibleLightsForScene(prsprites, numSprites, &command.taskDrawLights.visibleLights[0], command.taskDrawLights.numLights, viewMatrix_);
+		FindVisibleLightsForScene(prsprites, numSprites, command.taskDrawLights, viewMatrix_, modelViewProjection);
 		renderer.AddRenderCommand(command);
 	}
 }
@@ -726,6 +793,18 @@ bool PolymerNGBoard::ComputeModelSpriteRender(float4x4 &viewMatrix, float4x4 &pr
 	return true;
 }
 
+/*
+=============
+PolymerNG::AddLightToMap
+=============
+*/
+PolymerNGLightLocal *PolymerNGBoard::AddLightToMap(PolymerNGLightLocal *light)
+{
+	mapLights.push_back(light);
+	LinkLightToSectors(light);
+	return light;
+}
+
 /*
 =============
 PolymerNG::RemoveLightFromCurrentBoard
@@ -737,6 +816,7 @@ void PolymerNGBoard::RemoveLightFromCurrentBoard(PolymerNGLightLocal *light)
 	{
 		if (mapLights[i] == light)
 		{
+			UnlinkLightFromSectors(light);
 			mapLights.erase(mapLights.begin() + i);
 			return;
 		}
@@ -745,6 +825,50 @@ void PolymerNGBoard::RemoveLightFromCurrentBoard(PolymerNGLightLocal *light)
 	initprintf("PolymerNGBoard::RemoveLightFromCurrentBoard: Failed to remove light\n");
 }
 
+/*
+=============
+PolymerNG::LinkLightToSectors
+=============
+*/
+void PolymerNGBoard::LinkLightToSectors(PolymerNGLightLocal *light)
+{
+	const std::vector<int> &sectorInfluences = light->GetSectorInfluences();
+	for (int i = 0; i < sectorInfluences.size(); i++)
+	{
+		sectorLights[sectorInfluences[i]].push_back(light);
+	}
+
+	light->isLinkedToBoard = true;
+}
+
+/*
+=============
+PolymerNG::UnlinkLightFromSectors
+=============
+*/
+void PolymerNGBoard::UnlinkLightFromSectors(PolymerNGLightLocal *light)
+{
+	if (!light->isLinkedToBoard)
+		return;
+
+	const std::vector<int> &sectorInfluences = light->GetSectorInfluences();
+	for (int i = 0; i < sectorInfluences.size(); i++)
+	{
+		std::vector<PolymerNGLightLocal *> &lights = sectorLights[sectorInfluences[i]];
+		for (int d = 0; d < lights.size(); d++)
+		{
+			if (lights[d] == light)
+			{
+				lights[d] = lights[lights.size() - 1];
+				lights.pop_back();
+				break;
+			}
+		}
+	}
+
+	light->isLinkedToBoard = false;
+}
+
 /*
 =============
 PolymerNG::GetAmbientSectorColor
@@ -798,6 +922,7 @@ void PolymerNGBoard::DrawSprites(BuildRenderCommand &command, float4x4 &viewMatr
 		}
 		
 		sprite->paletteNum = tspr->pal;
+		sprite->position = float3((float)tspr->y, -(float)tspr->z / 16.0f, -(float)tspr->x);
 		sprite->plane.tileNum = tspr->picnum;
 		sprite->plane.renderMaterialHandle = materialManager.LoadMaterialForTile(tspr->picnum);
 
@@ -809,6 +934,11 @@ void PolymerNGBoard::DrawSprites(BuildRenderCommand &command, float4x4 &viewMatr
 		{
 			sprite->isVisible = ComputeSpritePlane(viewMatrix, projectionMatrix, horizang, daang, sprite, tspr);
 		}
+
+		if (sprite->isVisible)
+		{
+			sprite->isVisible = visibilityEngine->IsSpriteVisible(sprite);
+		}
 		
 		GetAmbientSectorColor(board->GetSector(tspr->sectnum)->ambientSectorId, sprite->ambientColor);
 	}
@@ -819,9 +949,9 @@ void PolymerNGBoard::DrawSprites(BuildRenderCommand &command, float4x4 &viewMatr
 PolymerNG::LoadBoard
 =============
 */
-void PolymerNG::LoadBoard()
+void PolymerNG::LoadBoard(int16_t startSectorNum)
 {
-	polymerNGPrivate.currentBoard = new PolymerNGBoard();
+	polymerNGPrivate.currentBoard = new PolymerNGBoard(startSectorNum);
 }
 
 /*
@@ -831,6 +961,7 @@ PolymerNG::DrawRooms
 */
 void PolymerNG::DrawRooms(int32_t daposx, int32_t daposy, int32_t daposz, int16_t daang, int32_t dahoriz, int16_t dacursectnum)
 {
+	cameraPath.ProcessView(daposx, daposy, daposz, daang, dahoriz, dacursectnum);
 	polymerNGPrivate.currentBoard->DrawRooms(daposx, daposy, daposz, daang, dahoriz, dacursectnum);
 }
 
@@ -11,16 +11,20 @@ class PolymerNGVisibilityEngine;
 class PolymerNGBoard
 {
 public:
-	PolymerNGBoard();
+	PolymerNGBoard(int16_t startSectorNum);
 	~PolymerNGBoard();
 
 	void		 DrawRooms(int32_t daposx, int32_t daposy, int32_t daposz, int16_t daang, int32_t dahoriz, int16_t dacursectnum);
 	void		 CreateProjectionMatrix(int32_t fov, float4x4 &projectionMatrix, int width, int height);
 	void		 AddRenderPlaneToDrawList(BuildRenderThreadTaskRenderWorld &renderWorldTask, Build3DPlane *plane, int buildTileNum);
 
-	PolymerNGLightLocal		*AddLightToMap(PolymerNGLightLocal *light) { mapLights.push_back(light); return mapLights[mapLights.size() - 1]; }
+	PolymerNGLightLocal		*AddLightToMap(PolymerNGLightLocal *light);
 	void		RemoveLightFromCurrentBoard(PolymerNGLightLocal	*light);
 
+	// Keeps the per sector light lists in sync with the sectors a light influences.
+	void		LinkLightToSectors(PolymerNGLightLocal *light);
+	void		UnlinkLightFromSectors(PolymerNGLightLocal *light);
+
 	Build3DBoard *GetBoard() { return board; }
 
 	void		 MoveLightsInSector(int sectorNum, float deltax, float deltay);
@@ -30,7 +34,8 @@ public:
 	void		 DrawSprites(BuildRenderCommand &command, float4x4 &viewMatrix, float4x4 &projectionMatrix, float horizang, int16_t daang, float3 &position);
 private:
 	void		 GetAmbientSectorColor(int ambientColorId, byte *ambientColorArray);
-	void		 InitBoard();
+	void		 InitBoard(int16_t startSectorNum);
+	void		 QueueBoardTextures(int16_t startSectorNum);
 	void		 PokeSector(int16_t secnum);
 	void		 FindVisibleSectors(BuildRenderThreadTaskRenderWorld &renderWorldTask, const float4x4 &modelViewProjectionMatrix, const float4x4 &modelViewMatrix, const float4x4 &projectionMatrix, int16_t dacursectnum);
 	void		 ScanSprites(int16_t sectnum, tspritetype* localtsprite, int32_t* localspritesortcnt);
@@ -43,7 +48,7 @@ private:
 
 	void		 FindMapSky();
 
-	void		 FindVisibleLightsForScene(Build3DSprite *prsprites, int numSprites, PolymerNGLightLocal **lights, int &numVisibleLights, float4x4 modelViewMatrix);
+	void		 FindVisibleLightsForScene(Build3DSprite *prsprites, int numSprites, BuildRenderThreadTaskDrawLights &drawLightsTask, float4x4 modelViewMatrix, const float4x4 &modelViewProjectionMatrix);
 
 	Build3DBoard *board;
 
@@ -51,7 +56,7 @@ private:
 
 
 private:
-	Build3DSprite	prsprites[2][MAXSPRITESONSCREEN];
+	Build3DSprite	prsprites[MAX_SMP_FRAMES][MAXSPRITESONSCREEN];
 
 	int32_t         localspritesortcnt;
 	float			curskyangmul;
@@ -60,6 +65,10 @@ private:
 	PolymerNGVisibilityEngine *visibilityEngine;
 	std::vector<PolymerNGLightLocal *> mapLights;
 
+	// Lights that influence each sector, so finding the visible lights only has to walk the visible sectors.
+	std::vector<PolymerNGLightLocal *> sectorLights[MAXSECTORS];
+	uint32_t		lightGatherFrame;
+
 	int visibleSectorsArray[MAXSECTORS];
 	int numVisibleSectors;
 };
@@ -32,7 +32,8 @@ PolymerNGBoard::RenderOccluderFromPlane
 */
 void PolymerNGBoard::RenderOccluderFromPlane(const float4x4 &modelViewProjectionMatrix, const Build3DPlane *plane)
 {
-
+	// Queued up here, they all get rasterized once the gather is done.
+	visibilityEngine->AddOccluder(plane);
 }
 
 /*
@@ -188,10 +189,13 @@ void PolymerNGBoard::FindVisibleSectors(BuildRenderThreadTaskRenderWorld &render
 
 		PokeSector(sectorNum);
 
+		// Visible sectors can still have planes that are outside of the view.
+		const uint8_t *planeInFrustum = planeCulling.CullSectorToFrustum(board, sectorNum);
+
 		byte ambient[4] = { 0, 0, 0, 0 };
 		GetAmbientSectorColor(sector->ambientSectorId, &ambient[0]);
 		
-		if (!sector->IsCeilParalaxed() && yax_getbunch(sectorNum, YAX_CEILING) < 0)
+		if (!sector->IsCeilParalaxed() && yax_getbunch(sectorNum, YAX_CEILING) < 0 && planeInFrustum[BUILD3D_PLANEBOUNDS_CEIL])
 		{
 			sector->ceil.paletteNum = sec->ceilingpal;
 			sector->ceil.shadeNum = sec->ceilingshade;
@@ -200,9 +204,10 @@ void PolymerNGBoard::FindVisibleSectors(BuildRenderThreadTaskRenderWorld &render
 			sector->ceil.ambient[1] = ambient[1];
 			sector->ceil.ambient[2] = ambient[2];
 			AddRenderPlaneToDrawList(renderWorldTask, &sector->ceil, sector->ceilingpicnum_anim);
+			RenderOccluderFromPlane(modelViewProjectionMatrix, &sector->ceil);
 		}
 
-		if (!sector->IsFloorParalaxed() && yax_getbunch(sectorNum, YAX_FLOOR) < 0)
+		if (!sector->IsFloorParalaxed() && yax_getbunch(sectorNum, YAX_FLOOR) < 0 && planeInFrustum[BUILD3D_PLANEBOUNDS_FLOOR])
 		{
 			sector->floor.paletteNum = sec->floorpal;
 			sector->floor.shadeNum = sec->floorshade;
@@ -211,6 +216,7 @@ void PolymerNGBoard::FindVisibleSectors(BuildRenderThreadTaskRenderWorld &render
 			sector->floor.ambient[1] = ambient[1];
 			sector->floor.ambient[2] = ambient[2];
 			AddRenderPlaneToDrawList(renderWorldTask, &sector->floor, sector->floorpicnum_anim);
+			RenderOccluderFromPlane(modelViewProjectionMatrix, &sector->floor);
 		}
 
 		ScanSprites(sectorNum, localtsprite, &localspritesortcnt);
@@ -219,6 +225,7 @@ void PolymerNGBoard::FindVisibleSectors(BuildRenderThreadTaskRenderWorld &render
 		do
 		{
 			int32_t wallNum = sec->wallptr + i;
+			const uint8_t *wallInFrustum = &planeInFrustum[BUILD3D_PLANEBOUNDS_FIRSTWALL + (i * BUILD3D_PLANEBOUNDS_PERWALL)];
 			//if (wallvisible(globalposx, globalposy, wallNum)) // No reason to do this.
 			{
 				Build3DWall *wall = board->GetWall(wallNum);
@@ -240,7 +247,7 @@ void PolymerNGBoard::FindVisibleSectors(BuildRenderThreadTaskRenderWorld &render
 				}
 
 				bool parralaxFloor = (neighborSector != NULL && neighborSector && sector->IsFloorParalaxed() && neighborSector->IsFloorParalaxed());
-				if ((wall->underover & 1) && (!parralaxFloor || searchit == 2))
+				if ((wall->underover & 1) && (!parralaxFloor || searchit == 2) && wallInFrustum[BUILD3D_PLANEBOUNDS_WALL])
 				{
 					wall->wall.paletteNum = ::wall[wallNum].pal;
 					wall->wall.shadeNum = ::wall[wallNum].shade;
@@ -249,10 +256,11 @@ void PolymerNGBoard::FindVisibleSectors(BuildRenderThreadTaskRenderWorld &render
 					wall->wall.ambient[1] = ambient[1];
 					wall->wall.ambient[2] = ambient[2];
 					AddRenderPlaneToDrawList(renderWorldTask, &wall->wall, wall->picnum);
+					RenderOccluderFromPlane(modelViewProjectionMatrix, &wall->wall);
 				}
 
 				bool parralaxCeiling = (neighborSector != NULL && neighborSector && sector->IsCeilParalaxed() && neighborSector->IsCeilParalaxed());
-				if ((wall->underover & 2) && (!parralaxCeiling || searchit == 2))
+				if ((wall->underover & 2) && (!parralaxCeiling || searchit == 2) && wallInFrustum[BUILD3D_PLANEBOUNDS_OVER])
 				{
 					wall->over.paletteNum = ::wall[wallNum].pal;
 					wall->over.shadeNum = ::wall[wallNum].shade;
@@ -261,10 +269,11 @@ void PolymerNGBoard::FindVisibleSectors(BuildRenderThreadTaskRenderWorld &render
 					wall->over.ambient[1] = ambient[1];
 					wall->over.ambient[2] = ambient[2];
 					AddRenderPlaneToDrawList(renderWorldTask, &wall->over, wall->overpicnum);
+					RenderOccluderFromPlane(modelViewProjectionMatrix, &wall->over);
 				}
 
 			//	if ((::wall[wallNum].cstat & 32) && (::wall[wallNum].nextsector >= 0))
-				if ((::wall[wallNum].cstat & 48) == 16)
+				if ((::wall[wallNum].cstat & 48) == 16 && wallInFrustum[BUILD3D_PLANEBOUNDS_MASK])
 				{
 					wall->mask.paletteNum = ::wall[wallNum].pal;
 					wall->mask.shadeNum = ::wall[wallNum].shade;
@@ -0,0 +1,255 @@
+// PolymerNG_CameraPath.cpp
+//
+
+#include "PolymerNG_local.h"
+#include "baselayer.h"
+#include <algorithm>
+
+PolymerNGCameraPath cameraPath;
+
+//
+// osdcmd_camerapathrecord
+//
+static int32_t osdcmd_camerapathrecord(const osdfuncparm_t *parm)
+{
+	UNREFERENCED_PARAMETER(parm);
+
+	cameraPath.StartRecording();
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_camerapathsave
+//
+static int32_t osdcmd_camerapathsave(const osdfuncparm_t *parm)
+{
+	if (parm->numparms != 1)
+		return OSDCMD_SHOWHELP;
+
+	cameraPath.SaveRecording(parm->parms[0]);
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_camerapathplay
+//
+static int32_t osdcmd_camerapathplay(const osdfuncparm_t *parm)
+{
+	if (parm->numparms < 1 || parm->numparms > 2)
+		return OSDCMD_SHOWHELP;
+
+	int numLoops = 1;
+	if (parm->numparms == 2)
+	{
+		numLoops = Batol(parm->parms[1]);
+	}
+
+	cameraPath.StartPlayback(parm->parms[0], numLoops);
+
+	return OSDCMD_OK;
+}
+
+/*
+=============
+PolymerNGCameraPath::PolymerNGCameraPath
+=============
+*/
+PolymerNGCameraPath::PolymerNGCameraPath()
+{
+	mode = CAMERAPATH_IDLE;
+	currentView = 0;
+	loopsLeft = 0;
+	lastFrameTime = 0;
+}
+
+/*
+=============
+PolymerNGCameraPath::Init
+=============
+*/
+void PolymerNGCameraPath::Init()
+{
+	OSD_RegisterFunction("r_camerapath_record", "r_camerapath_record: starts recording the camera views the renderer draws", osdcmd_camerapathrecord);
+	OSD_RegisterFunction("r_camerapath_save", "r_camerapath_save <file>: stops recording and writes the camera path to a file", osdcmd_camerapathsave);
+	OSD_RegisterFunction("r_camerapath_play", "r_camerapath_play <file> [loops]: replays a camera path and prints the frame times", osdcmd_camerapathplay);
+}
+
+/*
+=============
+PolymerNGCameraPath::StartRecording
+=============
+*/
+void PolymerNGCameraPath::StartRecording()
+{
+	views.clear();
+	mode = CAMERAPATH_RECORDING;
+	initprintf("Recording camera path\n");
+}
+
+/*
+=============
+PolymerNGCameraPath::SaveRecording
+=============
+*/
+bool PolymerNGCameraPath::SaveRecording(const char *fileName)
+{
+	if (mode != CAMERAPATH_RECORDING)
+	{
+		initprintf("PolymerNGCameraPath::SaveRecording: not recording a camera path\n");
+		return false;
+	}
+
+	mode = CAMERAPATH_IDLE;
+
+	BuildFile *file = BuildFile::OpenFile(fileName, BuildFile::BuildFile_Write);
+	if (file == NULL)
+	{
+		initprintf("PolymerNGCameraPath::SaveRecording: failed to open %s\n", fileName);
+		return false;
+	}
+
+	char line[128];
+	for (int i = 0; i < views.size(); i++)
+	{
+		const PolymerNGCameraView &view = views[i];
+		int length = Bsprintf(line, "%d %d %d %d %d %d\n", view.x, view.y, view.z, view.ang, view.horiz, view.sectnum);
+		file->Write(line, length);
+	}
+	delete file;
+
+	initprintf("Wrote %d camera views to %s\n", (int)views.size(), fileName);
+	return true;
+}
+
+/*
+=============
+PolymerNGCameraPath::StartPlayback
+=============
+*/
+bool PolymerNGCameraPath::StartPlayback(const char *fileName, int numLoops)
+{
+	uint32_t length;
+	char *buffer = kreadfile(fileName, length);
+	if (buffer == NULL)
+	{
+		initprintf("PolymerNGCameraPath::StartPlayback: failed to open %s\n", fileName);
+		return false;
+	}
+
+	views.clear();
+
+	char *line = buffer;
+	while (*line)
+	{
+		int x, y, z, ang, horiz, sectnum;
+		if (sscanf(line, "%d %d %d %d %d %d", &x, &y, &z, &ang, &horiz, &sectnum) == 6 && sectnum >= 0 && sectnum < numsectors)
+		{
+			PolymerNGCameraView view;
+			view.x = x;
+			view.y = y;
+			view.z = z;
+			view.ang = (int16_t)ang;
+			view.horiz = horiz;
+			view.sectnum = (int16_t)sectnum;
+			views.push_back(view);
+		}
+
+		while (*line && *line != '\n')
+			line++;
+		while (*line == '\n' || *line == '\r')
+			line++;
+	}
+	Bfree(buffer);
+
+	if (views.size() == 0)
+	{
+		initprintf("PolymerNGCameraPath::StartPlayback: %s has no views for the current board\n", fileName);
+		mode = CAMERAPATH_IDLE;
+		return false;
+	}
+
+	initprintf("Playing %d camera views from %s\n", (int)views.size(), fileName);
+
+	mode = CAMERAPATH_PLAYING;
+	currentView = 0;
+	loopsLeft = numLoops > 0 ? numLoops : 1;
+	lastFrameTime = 0;
+	frameTimes.clear();
+	frameTimes.reserve(views.size() * loopsLeft);
+	return true;
+}
+
+/*
+=============
+PolymerNGCameraPath::ProcessView
+=============
+*/
+void PolymerNGCameraPath::ProcessView(int32_t &daposx, int32_t &daposy, int32_t &daposz, int16_t &daang, int32_t &dahoriz, int16_t &dacursectnum)
+{
+	if (mode == CAMERAPATH_RECORDING)
+	{
+		PolymerNGCameraView view;
+		view.x = daposx;
+		view.y = daposy;
+		view.z = daposz;
+		view.ang = daang;
+		view.horiz = dahoriz;
+		view.sectnum = dacursectnum;
+		views.push_back(view);
+		return;
+	}
+
+	if (mode != CAMERAPATH_PLAYING)
+		return;
+
+	// Frame time is measured from one DrawRooms to the next, so it includes waiting on the render thread.
+	double currentTime = gethiticks();
+	if (lastFrameTime != 0)
+	{
+		frameTimes.push_back(currentTime - lastFrameTime);
+	}
+	lastFrameTime = currentTime;
+
+	if (currentView == views.size())
+	{
+		currentView = 0;
+		if (--loopsLeft <= 0)
+		{
+			FinishPlayback();
+			return;
+		}
+	}
+
+	const PolymerNGCameraView &view = views[currentView++];
+	daposx = view.x;
+	daposy = view.y;
+	daposz = view.z;
+	daang = view.ang;
+	dahoriz = view.horiz;
+	dacursectnum = view.sectnum;
+}
+
+/*
+=============
+PolymerNGCameraPath::FinishPlayback
+=============
+*/
+void PolymerNGCameraPath::FinishPlayback()
+{
+	mode = CAMERAPATH_IDLE;
+
+	if (frameTimes.size() == 0)
+		return;
+
+	double totalTime = 0;
+	for (int i = 0; i < frameTimes.size(); i++)
+	{
+		totalTime += frameTimes[i];
+	}
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	initprintf("Camera path: %d frames, avg %.3fms min %.3fms 95%% %.3fms max %.3fms\n", (int)frameTimes.size(), totalTime / frameTimes.size(), frameTimes[0], frameTimes[(frameTimes.size() * 95) / 100], frameTimes[frameTimes.size() - 1]);
+}
@@ -0,0 +1,57 @@
+// PolymerNG_CameraPath.h
+//
+
+#pragma once
+
+//
+// PolymerNGCameraView
+//
+struct PolymerNGCameraView
+{
+	int32_t x;
+	int32_t y;
+	int32_t z;
+	int32_t horiz;
+	int16_t ang;
+	int16_t sectnum;
+};
+
+//
+// PolymerNGCameraPath
+//
+// Records the views passed to DrawRooms so the same frames can be replayed later, this lets us benchmark the renderer
+// over a fixed set of views without the game simulation getting in the way.
+//
+class PolymerNGCameraPath
+{
+public:
+	PolymerNGCameraPath();
+
+	void				Init();
+
+	// Records the view while recording, while playing back the view is replaced with the next one on the path.
+	void				ProcessView(int32_t &daposx, int32_t &daposy, int32_t &daposz, int16_t &daang, int32_t &dahoriz, int16_t &dacursectnum);
+
+	void				StartRecording();
+	bool				SaveRecording(const char *fileName);
+	bool				StartPlayback(const char *fileName, int numLoops);
+private:
+	void				FinishPlayback();
+
+	enum PolymerNGCameraPathMode
+	{
+		CAMERAPATH_IDLE = 0,
+		CAMERAPATH_RECORDING,
+		CAMERAPATH_PLAYING
+	};
+
+	PolymerNGCameraPathMode mode;
+	std::vector<PolymerNGCameraView> views;
+
+	int					currentView;
+	int					loopsLeft;
+	double				lastFrameTime;
+	std::vector<double>	frameTimes;
+};
+
+extern PolymerNGCameraPath cameraPath;
@@ -34,7 +34,7 @@ void PolymerNGPaletteManager::UpdatePaletteLookupTable(int idx)
 		return;
 
 	wchar_t palette_name[512];
-	swprintf(palette_name, L"build_numshadespalette%d", idx);
+	swprintf(palette_name, ARRAY_SIZE(palette_name), L"build_numshadespalette%d", idx);
 
 	// Load in system textures.
 	{
@@ -167,7 +167,7 @@ void PolymerNGPaletteManager::UpdatePalette(int idx)
 		return;
 
 	wchar_t palette_name[512];
-	swprintf(palette_name, L"build_palette%d", idx);
+	swprintf(palette_name, ARRAY_SIZE(palette_name), L"build_palette%d", idx);
 
 	// Load in system textures.
 	{
@@ -260,6 +260,27 @@ void PolymerNGImageManager::EndLevelLoad()
 	textureCache->EndLevelLoad();
 }
 
+//
+// PolymerNGImageManager::QueueTileLoad
+//
+void PolymerNGImageManager::QueueTileLoad(int tilenum)
+{
+	if (!textureCache->IsLoaded())
+		return;
+
+	textureCache->QueueTileLoad(tilenum);
+}
+
+//
+// PolymerNGImageManager::SubmitQueuedTileLoads
+//
+void PolymerNGImageManager::SubmitQueuedTileLoads()
+{
+	if (!textureCache->IsLoaded())
+		return;
+
+	textureCache->SubmitQueuedLoads();
+}
 
 //
 // PolymerNGImageManager::AppendImageToUploadQueue
@@ -32,6 +32,10 @@ public:
 	void BeginLevelLoad();
 	void EndLevelLoad();
 
+	// Queues the high quality textures for a tile to be loaded in the background, in queue order.
+	void QueueTileLoad(int tilenum);
+	void SubmitQueuedTileLoads();
+
 	BuildImage *LoadFromTileId(int tilenum, PolymerNGTextureCachePayloadImageType payloadImageType);
 	BuildImage *LoadTexture(const char *name);
 
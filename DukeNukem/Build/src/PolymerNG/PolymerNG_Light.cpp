@@ -15,46 +15,47 @@ PolymerNGLightLocal::PolymerNGLightLocal(PolymerNGLightOpts opts, PolymerNGBoard
 	this->polymerNGboard = board;
 	this->board = board->GetBoard();
 
+	isLinkedToBoard = false;
+	visibleFrame = 0;
+	Bmemset(lightVisibility.sectorInfluenceBits, 0, sizeof(lightVisibility.sectorInfluenceBits));
+
 	CalculateLightVisibility();
 }
 
 /*
 ============================
-PolymerNGLightLocal::IsPlaneInLight
+PolymerNGLightLocal::GetLightBox
+
+The box around the light radius, in the same space as the board planes.
 ============================
 */
-bool PolymerNGLightLocal::IsPlaneInLight(Build3DPlane* plane)
+void PolymerNGLightLocal::GetLightBox(float *mins, float *maxs)
 {
 	float           lightpos[3] = { GetOpts()->position[1], -GetOpts()->position[2] / 16.0f, -GetOpts()->position[0] };
 
-	int32_t         i, j, k, l;
-
-	if (!plane->vertcount || plane->buffer == NULL)
-		return 0;
-
-
-	i = 0;
-
 	int radius = GetOpts()->radius * 1000;
 
-	do
+	for (int i = 0; i < 3; i++)
 	{
-		j = k = l = 0;
+		mins[i] = lightpos[i] - radius;
+		maxs[i] = lightpos[i] + radius;
+	}
+}
 
-		do
-		{
-			if ((&plane->buffer[j].position.x)[i] > (lightpos[i] + radius)) k++;
-			if ((&plane->buffer[j].position.x)[i] < (lightpos[i] - radius)) l++;
-		} while (++j < plane->vertcount);
+/*
+============================
+PolymerNGLightLocal::IsPlaneInLight
+============================
+*/
+bool PolymerNGLightLocal::IsPlaneInLight(Build3DPlane* plane)
+{
+	float mins[3], maxs[3];
 
-		if ((k == plane->vertcount) || (l == plane->vertcount))
-			return 0;
-	} while (++i < 3);
+	GetLightBox(mins, maxs);
 
-	return 1;
+	return board->GetPlaneBounds().IsPlaneInBox(plane->boundsIndex, mins, maxs);
 }
 
-
 /*
 ============================
 PolymerNGLightLocal::CalculateLightVisibility
@@ -70,6 +71,16 @@ void  PolymerNGLightLocal::CalculateLightVisibility()
 	Bmemset(drawingstate, 0, sizeof(int16_t) * numsectors);
 	drawingstate[opts.sector] = 1;
 
+	// Pull the light out of the sector lists while the influences change under it.
+	bool wasLinkedToBoard = isLinkedToBoard;
+	polymerNGboard->UnlinkLightFromSectors(this);
+
+	for (int i = 0; i < lightVisibility.sectorInfluences.size(); i++)
+	{
+		int sectorId = lightVisibility.sectorInfluences[i];
+		lightVisibility.sectorInfluenceBits[sectorId >> 3] &= ~pow2char[sectorId & 7];
+	}
+
 	if (opts.lightType == POLYMERNG_LIGHTTYPE_POINT)
 	{
 		float3 lightPosition(opts.position[1], -opts.position[2] / 16.0f, -opts.position[0]);
@@ -139,22 +150,19 @@ void  PolymerNGLightLocal::CalculateLightVisibility()
 			lightVisibility.sectorInfluences.push_back(d);
 		}
 	}
-}
 
-/*
-============================
-PolymerNGLightLocal::DoesLightInfluenceSector
-============================
-*/
-bool PolymerNGLightLocal::DoesLightInfluenceSector(int sectorId)
-{
 	for (int i = 0; i < lightVisibility.sectorInfluences.size(); i++)
 	{
-		if (lightVisibility.sectorInfluences[i] == sectorId)
-			return true;
+		int sectorId = lightVisibility.sectorInfluences[i];
+		lightVisibility.sectorInfluenceBits[sectorId >> 3] |= pow2char[sectorId & 7];
+	}
+
+	if (wasLinkedToBoard)
+	{
+		polymerNGboard->LinkLightToSectors(this);
 	}
 
-	return false;
+	shadowCacheEntry.isDirty = true;
 }
 
 /*
@@ -208,19 +216,233 @@ bool PolymerNGLightLocal::IsPlaneInFrustum(Build3DPlane *plane, float* frustum)
 	return true;
 }
 
+/*
+============================
+PolymerNGLightLocal::UpdateShadowCacheLightState
+
+Returns true if the light moved or changed shape since the last time we looked.
+============================
+*/
+bool PolymerNGLightLocal::UpdateShadowCacheLightState()
+{
+	ShadowCacheLightState lightState;
+
+	// Cleared so the padding compares equal.
+	memset(&lightState, 0, sizeof(lightState));
+	lightState.lightType = opts.lightType;
+	lightState.position[0] = opts.position[0];
+	lightState.position[1] = opts.position[1];
+	lightState.position[2] = opts.position[2];
+	lightState.range = opts.range;
+	lightState.radius = opts.radius;
+	lightState.angle = opts.angle;
+	lightState.horiz = opts.horiz;
+	lightState.faderadius = opts.faderadius;
+	lightState.sector = opts.sector;
+
+	if (!memcmp(&lightState, &shadowCacheEntry.lightState, sizeof(lightState)))
+		return false;
+
+	shadowCacheEntry.lightState = lightState;
+	return true;
+}
+
+/*
+============================
+ShadowCacheHash
+============================
+*/
+static inline uint32_t ShadowCacheHash(uint32_t key, uint32_t value)
+{
+	return (key ^ value) * 16777619u;
+}
+
+/*
+============================
+PolymerNGLightLocal::CalculateSectorGeometryKey
+
+updatesector bumps the invalidid of a sector whenever its geometry changes, and the walls
+carry the sum of the ids of the sectors on either side, so this changes whenever anything
+the occluder lists were built from moved.
+============================
+*/
+uint32_t PolymerNGLightLocal::CalculateSectorGeometryKey()
+{
+	uint32_t key = 2166136261u;
+
+	key = ShadowCacheHash(key, searchit == 2);
+
+	for (int d = 0; d < lightVisibility.sectorInfluences.size(); d++)
+	{
+		int sectorId = lightVisibility.sectorInfluences[d];
+		Build3DSector *build3DSector = board->GetSector(sectorId);
+		tsectortype *sec = (tsectortype *)&sector[sectorId];
+
+		key = ShadowCacheHash(key, sectorId);
+		key = ShadowCacheHash(key, build3DSector->invalidid);
+
+		for (int w = 0; w < sec->wallnum; w++)
+		{
+			int wallNum = sec->wallptr + w;
+			Build3DWall *wall = board->GetWall(wallNum);
+			uint32_t wallState = wall->underover | ((::wall[wallNum].cstat & 48) << 2);
+
+			if (::wall[wallNum].nextsector >= 0)
+			{
+				Build3DSector *neighborSector = board->GetSector(::wall[wallNum].nextsector);
+				wallState |= (neighborSector->IsFloorParalaxed() << 8) | (neighborSector->IsCeilParalaxed() << 9);
+			}
+
+			key = ShadowCacheHash(key, wall->invalidid);
+			key = ShadowCacheHash(key, wallState);
+		}
+	}
+
+	return key;
+}
+
+/*
+============================
+PolymerNGLightLocal::BuildPlaneOccluders
+============================
+*/
+void PolymerNGLightLocal::BuildPlaneOccluders()
+{
+	std::vector<const Build3DPlane *> &planeOccluders = shadowCacheEntry.planeOccluders;
+
+	planeOccluders.clear();
+
+	// The spot light influences aren't right yet(see CalculateLightVisibility), so only point lights get their planes culled.
+	bool cullToLight = (opts.lightType == POLYMERNG_LIGHTTYPE_POINT);
+
+	float mins[3], maxs[3];
+	GetLightBox(mins, maxs);
+
+	// Find all the sectors this light can influence. 
+	for (int d = 0; d < lightVisibility.sectorInfluences.size(); d++)
+	{
+		int sectorId = lightVisibility.sectorInfluences[d];
+		Build3DSector *build3DSector = board->GetSector(sectorId);
+		tsectortype *sec = (tsectortype *)&sector[sectorId];
+
+		// All the planes of the sector are tested against the light in one go.
+		const uint8_t *planeInLight = cullToLight ? planeCulling.CullSectorToBox(board, sectorId, mins, maxs) : NULL;
+
+		if (!cullToLight || planeInLight[BUILD3D_PLANEBOUNDS_CEIL])
+		{
+			planeOccluders.push_back(&build3DSector->ceil);
+		}
+
+		if (!cullToLight || planeInLight[BUILD3D_PLANEBOUNDS_FLOOR])
+		{
+			planeOccluders.push_back(&build3DSector->floor);
+		}
+
+		for (int w = 0; w < sec->wallnum; w++)
+		{
+			int wallNum = sec->wallptr + w;
+			Build3DWall *wall = board->GetWall(wallNum);
+			Build3DSector *neighborSector = NULL;
+			const uint8_t *wallInLight = cullToLight ? &planeInLight[BUILD3D_PLANEBOUNDS_FIRSTWALL + (w * BUILD3D_PLANEBOUNDS_PERWALL)] : NULL;
+
+			/*
+			==============================================
+
+			Hidden walls
+
+			The logic here is if there is a parralax sector, wrapped inside of another paralax sector, don't draw the walls.
+
+			==============================================
+			*/
+
+			if (::wall[wallNum].nextsector >= 0)
+			{
+				neighborSector = board->GetSector(::wall[wallNum].nextsector);
+			}
+
+			bool parralaxFloor = (neighborSector != NULL && neighborSector && build3DSector->IsFloorParalaxed() && neighborSector->IsFloorParalaxed());
+			if ((wall->underover & 1) && (!parralaxFloor || searchit == 2) && (!cullToLight || wallInLight[BUILD3D_PLANEBOUNDS_WALL]))
+			{
+				planeOccluders.push_back(&wall->wall);
+			}
+			bool parralaxCeiling = (neighborSector != NULL && neighborSector && build3DSector->IsCeilParalaxed() && neighborSector->IsCeilParalaxed());
+			if ((wall->underover & 2) && (!parralaxCeiling || searchit == 2) && (!cullToLight || wallInLight[BUILD3D_PLANEBOUNDS_OVER]))
+			{
+				planeOccluders.push_back(&wall->over);
+			}
+
+			//if ((::wall[wallNum].cstat & 32) && (::wall[wallNum].nextsector >= 0))
+			if ((::wall[wallNum].cstat & 48) == 16 && (!cullToLight || wallInLight[BUILD3D_PLANEBOUNDS_MASK]))
+			{
+				planeOccluders.push_back(&wall->mask);
+			}
+		}
+	}
+}
+
 /*
 ============================
 PolymerNGLightLocal::PrepareShadows
+
+The occluder lists are only rebuilt when the light, the sectors it touches or the model sprites
+inside of it changed, otherwise last frames lists are copied forward into this SMP frame.
 ============================
 */
 void PolymerNGLightLocal::PrepareShadows(Build3DSprite *prsprites, int numSprites, float4x4 modelViewMatrix)
 {
-	bool smpFrame = !renderer.GetCurrentFrameNum();
+	int smpFrame = renderer.GetCurrentFrameNum();
+	ShadowCacheStats &stats = shadowCache.GetStats();
+
+	bool lightChanged = UpdateShadowCacheLightState();
+	uint32_t sectorGeometryKey = CalculateSectorGeometryKey();
+	if (lightChanged || shadowCacheEntry.isDirty || sectorGeometryKey != shadowCacheEntry.sectorGeometryKey || !shadowCache.IsEnabled())
+	{
+		BuildPlaneOccluders();
+
+		shadowCacheEntry.sectorGeometryKey = sectorGeometryKey;
+		shadowCacheEntry.isDirty = false;
+		shadowCacheEntry.version++;
+		stats.occluderRebuilds++;
+	}
+	else
+	{
+		stats.occluderHits++;
+	}
+
 	if (opts.lightType == POLYMERNG_LIGHTTYPE_POINT)
 	{
 		float3 lightPosition(opts.position[1], -opts.position[2] / 16.0f, -opts.position[0]);
+		float spriteRadius = GetOpts()->radius * 1000 + SHADOWCACHE_SPRITE_MARGIN;
+
+		// Find all sprites that this light can influence.
+		// Despite the bad naming on my part, drawsprites just agros a list of visible sprites.
+		shadowCacheEntry.spriteOccluders.clear();
+		uint32_t spriteKey = 0;
+		for (int d = 0; d < numSprites; d++)
+		{
+			// Todo: Add wall sprite alpha support!
+			if (!prsprites[d].cacheModel)
+				continue;
+
+			float3 delta = prsprites[d].position - lightPosition;
+			if (fabs(delta.x) > spriteRadius || fabs(delta.y) > spriteRadius || fabs(delta.z) > spriteRadius)
+				continue;
+
+			shadowCacheEntry.spriteOccluders.push_back(d);
 
-		Build3DPlane **boardPlanes = board->GetGlobalPlaneList();
+			// Summed so the order drawsprites hands them to us in doesn't matter.
+			spriteKey += XXH32(&prsprites[d].modelMatrix, sizeof(float4x4), (uint32_t)(intptr_t)prsprites[d].cacheModel);
+		}
+		spriteKey = ShadowCacheHash(spriteKey, shadowCacheEntry.spriteOccluders.size());
+
+		if (spriteKey != shadowCacheEntry.spriteKey)
+		{
+			shadowCacheEntry.spriteKey = spriteKey;
+			shadowCacheEntry.version++;
+			stats.spriteRebuilds++;
+		}
+
+		bool rebuildOccluders = (shadowCacheEntry.frameVersion[smpFrame] != shadowCacheEntry.version);
 
 		for (int i = 0; i < 6; i++)
 		{
@@ -235,89 +457,28 @@ void PolymerNGLightLocal::PrepareShadows(Build3DSprite *prsprites, int numSprite
 			shadowPasses[i].shadowViewMatrix = lightMatrix;
 			shadowPasses[i].shadowProjectionMatrix = lightProjectionMatrix;
 
-			shadowPasses[i].shadowOccluders[smpFrame].clear();
-			
-			// Find all sprites that this light can influence.
-			// Despite the bad naming on my part, drawsprites just agros a list of visible sprites.
+			if (!rebuildOccluders)
+				continue;
 
-			for (int d = 0; d < numSprites; d++)
-			{
-				// Todo: Add wall sprite alpha support!
-				if (!prsprites[d].cacheModel)
-					continue;
+			std::vector<PolymerNGShadowOccluder> &shadowOccluders = shadowPasses[i].shadowOccluders[smpFrame];
+			shadowOccluders.clear();
 
+			for (int d = 0; d < shadowCacheEntry.spriteOccluders.size(); d++)
+			{
 				PolymerNGShadowOccluder occluder;
-				occluder.sprite = prsprites[d];
+				occluder.sprite = prsprites[shadowCacheEntry.spriteOccluders[d]];
 				occluder.sprite.ViewMatrix = lightMatrix;
 
 				float4x4 modelViewMatrix = lightMatrix * occluder.sprite.modelMatrix;
 				occluder.sprite.modelViewProjectionMatrix = sliceProjectionMatrix * modelViewMatrix;
-				shadowPasses[i].shadowOccluders[smpFrame].push_back(occluder);
+				shadowOccluders.push_back(occluder);
 			}
 
-			// Find all the sectors this light can influence. 
-			for (int d = 0; d < lightVisibility.sectorInfluences.size(); d++)
+			for (int d = 0; d < shadowCacheEntry.planeOccluders.size(); d++)
 			{
-				int sectorId = lightVisibility.sectorInfluences[d];
-				Build3DSector *build3DSector = board->GetSector(sectorId);
-				tsectortype *sec = (tsectortype *)&sector[sectorId];
-
-				{
-					PolymerNGShadowOccluder occluder;
-					occluder.plane = &build3DSector->ceil;
-					shadowPasses[i].shadowOccluders[smpFrame].push_back(occluder);
-				}
-
-				{
-					PolymerNGShadowOccluder occluder;
-					occluder.plane = &build3DSector->floor;
-					shadowPasses[i].shadowOccluders[smpFrame].push_back(occluder);
-				}
-
-				for (int w = 0; w < sec->wallnum; w++)
-				{
-					int wallNum = sec->wallptr + w;
-					Build3DWall *wall = board->GetWall(wallNum);
-					Build3DSector *neighborSector = NULL;
-
-					/*
-					==============================================
-
-					Hidden walls
-
-					The logic here is if there is a parralax sector, wrapped inside of another paralax sector, don't draw the walls.
-
-					==============================================
-					*/
-
-					if (::wall[wallNum].nextsector >= 0)
-					{
-						neighborSector = board->GetSector(::wall[wallNum].nextsector);
-					}
-
-					bool parralaxFloor = (neighborSector != NULL && neighborSector && build3DSector->IsFloorParalaxed() && neighborSector->IsFloorParalaxed());
-					if ((wall->underover & 1) && (!parralaxFloor || searchit == 2))
-					{
-						PolymerNGShadowOccluder occluder;
-						occluder.plane = &wall->wall;
-						shadowPasses[i].shadowOccluders[smpFrame].push_back(occluder);
-					}
-					bool parralaxCeiling = (neighborSector != NULL && neighborSector && build3DSector->IsCeilParalaxed() && neighborSector->IsCeilParalaxed());
-					if ((wall->underover & 2) && (!parralaxCeiling || searchit == 2))
-					{
-						PolymerNGShadowOccluder occluder;
-						occluder.plane = &wall->over;
-						shadowPasses[i].shadowOccluders[smpFrame].push_back(occluder);
-					}
-
-					//if ((::wall[wallNum].cstat & 32) && (::wall[wallNum].nextsector >= 0))
-					if ((::wall[wallNum].cstat & 48) == 16)
-					{
-						PolymerNGShadowOccluder occluder;
-						occluder.plane = &wall->mask;
-						shadowPasses[i].shadowOccluders[smpFrame].push_back(occluder);
-					}
-				}
+				PolymerNGShadowOccluder occluder;
+				occluder.plane = shadowCacheEntry.planeOccluders[d];
+				shadowOccluders.push_back(occluder);
 			}
 		}
 	}
@@ -372,71 +533,23 @@ void PolymerNGLightLocal::PrepareShadows(Build3DSprite *prsprites, int numSprite
 		shadowPasses[0].spotdir = transformedDirection;
 		shadowPasses[0].spotRadius = indir;
 
-		for (int d = 0; d < lightVisibility.sectorInfluences.size(); d++)
+		if (shadowCacheEntry.frameVersion[smpFrame] != shadowCacheEntry.version)
 		{
-			int sectorId = lightVisibility.sectorInfluences[d];
-			Build3DSector *build3DSector = board->GetSector(sectorId);
-			tsectortype *sec = (tsectortype *)&sector[sectorId];
-
-			{
-				PolymerNGShadowOccluder occluder;
-				occluder.plane = &build3DSector->ceil;
-				shadowPasses[0].shadowOccluders[smpFrame].push_back(occluder);
-			}
+			std::vector<PolymerNGShadowOccluder> &shadowOccluders = shadowPasses[0].shadowOccluders[smpFrame];
+			shadowOccluders.clear();
 
+			for (int d = 0; d < shadowCacheEntry.planeOccluders.size(); d++)
 			{
 				PolymerNGShadowOccluder occluder;
-				occluder.plane = &build3DSector->floor;
-				shadowPasses[0].shadowOccluders[smpFrame].push_back(occluder);
-			}
-
-			for (int w = 0; w < sec->wallnum; w++)
-			{
-				int wallNum = sec->wallptr + w;
-				Build3DWall *wall = board->GetWall(wallNum);
-				Build3DSector *neighborSector = NULL;
-
-				/*
-				==============================================
-
-				Hidden walls
-
-				The logic here is if there is a parralax sector, wrapped inside of another paralax sector, don't draw the walls.
-
-				==============================================
-				*/
-
-				if (::wall[wallNum].nextsector >= 0)
-				{
-					neighborSector = board->GetSector(::wall[wallNum].nextsector);
-				}
-
-				bool parralaxFloor = (neighborSector != NULL && neighborSector && build3DSector->IsFloorParalaxed() && neighborSector->IsFloorParalaxed());
-				if ((wall->underover & 1) && (!parralaxFloor || searchit == 2))
-				{
-					PolymerNGShadowOccluder occluder;
-					occluder.plane = &wall->wall;
-					shadowPasses[0].shadowOccluders[smpFrame].push_back(occluder);
-				}
-				bool parralaxCeiling = (neighborSector != NULL && neighborSector && build3DSector->IsCeilParalaxed() && neighborSector->IsCeilParalaxed());
-				if ((wall->underover & 2) && (!parralaxCeiling || searchit == 2))
-				{
-					PolymerNGShadowOccluder occluder;
-					occluder.plane = &wall->over;
-					shadowPasses[0].shadowOccluders[smpFrame].push_back(occluder);
-				}
-
-				//if ((::wall[wallNum].cstat & 32) && (::wall[wallNum].nextsector >= 0))
-				if ((::wall[wallNum].cstat & 48) == 16)
-				{
-					PolymerNGShadowOccluder occluder;
-					occluder.plane = &wall->mask;
-					shadowPasses[0].shadowOccluders[smpFrame].push_back(occluder);
-				}
+				occluder.plane = shadowCacheEntry.planeOccluders[d];
+				shadowOccluders.push_back(occluder);
 			}
 		}
 	}
+
+	shadowCacheEntry.frameVersion[smpFrame] = shadowCacheEntry.version;
 }
+
 /*
 ============================
 PolymerNGLightLocal::MoveLightsInSector
@@ -472,7 +585,7 @@ void PolymerNGBoard::SetAmbientLightForSector(int sectorNum, int ambientNum)
 PolymerNGLightLocal::FindVisibleLightsForScene
 ============================
 */
-void PolymerNGBoard::FindVisibleLightsForScene(Build3DSprite *prsprites, int numSprites, PolymerNGLightLocal **lights, int &numVisibleLights, float4x4 modelViewMatrix)
+void PolymerNGBoard::FindVisibleLightsForScene(Build3DSprite *prsprites, int numSprites, BuildRenderThreadTaskDrawLights &drawLightsTask, float4x4 modelViewMatrix, const float4x4 &modelViewProjectionMatrix)
 {
 	// Tick all the lights
 	for (int i = 0; i < mapLights.size(); i++)
@@ -512,35 +625,51 @@ void PolymerNGBoard::FindVisibleLightsForScene(Build3DSprite *prsprites, int num
 		}
 	}
 
+	PolymerNGLightLocal **lights = &drawLightsTask.visibleLights[0];
+	int &numVisibleLights = drawLightsTask.numLights;
+
+	lightBinning.BeginFrame(modelViewProjectionMatrix);
+
+	// Walk the lights linked to each visible sector, visibleFrame makes sure a light that touches
+	// several visible sectors only gets picked up once.
+	lightGatherFrame++;
 	numVisibleLights = 0;
-	for (int i = 0; i < mapLights.size(); i++)
+	for (int d = 0; d < numVisibleSectors; d++)
 	{
-		if (numVisibleLights >= MAX_VISIBLE_LIGHTS)
+		std::vector<PolymerNGLightLocal *> &lightsInSector = sectorLights[visibleSectorsArray[d]];
+		for (int i = 0; i < lightsInSector.size(); i++)
 		{
-			initprintf("PolymerNGBoard::FindVisibleLightsForScene: Too many lights in view at once!\n");
-			return;
-		}
+			PolymerNGLightLocal *light = lightsInSector[i];
+			if (light->visibleFrame == lightGatherFrame)
+				continue;
 
-		bool isLightVisible = false;
-		for (int d = 0; d < numVisibleSectors; d++)
-		{
-			if (mapLights[i]->DoesLightInfluenceSector(visibleSectorsArray[d]))
+			light->visibleFrame = lightGatherFrame;
+
+			if (numVisibleLights >= MAX_VISIBLE_LIGHTS)
 			{
-				isLightVisible = true;
-				break;
+				initprintf("PolymerNGBoard::FindVisibleLightsForScene: Too many lights in view at once!\n");
+				lightBinning.EndFrame();
+				return;
 			}
-		}
 
-		if (!isLightVisible)
-			continue;
+			// Lights hidden behind walls don't need a shadow map or a bin, unless their fog reaches the screen anyway.
+			if (!light->GetOpts()->enableVolumetricLight && !visibilityEngine->IsLightVisible(light))
+				continue;
 
-		lights[numVisibleLights] = mapLights[i];
+			// Volumetric lights can scatter onto the screen without their sphere being on it.
+			if (!lightBinning.BinLight(light, numVisibleLights, drawLightsTask.lightScreenRects[numVisibleLights]) && !light->GetOpts()->enableVolumetricLight)
+				continue;
 
-		if (lights[numVisibleLights]->GetOpts()->castShadows)
-		{
-			lights[numVisibleLights]->PrepareShadows(prsprites, numSprites, modelViewMatrix);
-		}
+			lights[numVisibleLights] = light;
+
+			if (light->GetOpts()->castShadows)
+			{
+				light->PrepareShadows(prsprites, numSprites, modelViewMatrix);
+			}
 
-		numVisibleLights++;
+			numVisibleLights++;
+		}
 	}
+
+	lightBinning.EndFrame();
 }
\ No newline at end of file
@@ -28,7 +28,7 @@ struct PolymerNGShadowPass
 	float frustum[5 * 4];
 	float3 spotdir;
 	float3 spotRadius;
-	std::vector<PolymerNGShadowOccluder> shadowOccluders[2];
+	std::vector<PolymerNGShadowOccluder> shadowOccluders[MAX_SMP_FRAMES];
 };
 
 //
@@ -37,6 +37,9 @@ struct PolymerNGShadowPass
 struct PolymerNGLightVisbility
 {
 	std::vector<int>		sectorInfluences;
+
+	// The same sectors as a bitset, so DoesLightInfluenceSector doesn't have to search the list.
+	uint8_t					sectorInfluenceBits[(MAXSECTORS + 7) >> 3];
 };
 
 //
@@ -61,14 +64,31 @@ public:
 		return board->GetBaseModel()->rhiVertexBufferStatic;
 	}
 
-	bool DoesLightInfluenceSector(int sectorId);
+	bool DoesLightInfluenceSector(int sectorId) const {
+		return (lightVisibility.sectorInfluenceBits[sectorId >> 3] & pow2char[sectorId & 7]) != 0;
+	}
+
+	const std::vector<int> &GetSectorInfluences() const { return lightVisibility.sectorInfluences; }
 
 	void  CalculateLightVisibility();
+
+	// World space box around everything the light can reach.
+	void  GetLightBox(float *mins, float *maxs);
+
+	// Set by the board while the light is in its per sector light lists.
+	bool		isLinkedToBoard;
+
+	// Last FindVisibleLightsForScene call that picked this light up.
+	uint32_t	visibleFrame;
 private:
 	void  CreateFrustumFromModelViewMatrix(float *modelViewProjectionMatrix, float* frustum);
 	bool  IsPlaneInFrustum(Build3DPlane *plane, float* frustum);
 	bool  IsPlaneInLight(Build3DPlane* plane);
 
+	bool  UpdateShadowCacheLightState();
+	uint32_t CalculateSectorGeometryKey();
+	void  BuildPlaneOccluders();
+
 	PolymerNGLightOpts opts;
 	PolymerNGLightOpts opts_original;
 	PolymerNGBoard *polymerNGboard;
@@ -78,4 +98,7 @@ private:
 
 	float4x4 lightProjectionMatrix;
 	PolymerNGShadowPass shadowPasses[6];
+
+public:
+	ShadowCacheEntry shadowCacheEntry;
 };
\ No newline at end of file
@@ -0,0 +1,227 @@
+// PolymerNG_LightBinning.cpp
+//
+
+#include "PolymerNG_local.h"
+
+PolymerNGLightBinning lightBinning;
+
+//
+// osdcmd_lightbinning
+//
+static int32_t osdcmd_lightbinning(const osdfuncparm_t *parm)
+{
+	if (parm->numparms != 1)
+	{
+		initprintf("r_lightbinning is %d\n", lightBinning.enabled ? 1 : 0);
+		return OSDCMD_OK;
+	}
+
+	lightBinning.enabled = Batol(parm->parms[0]) != 0;
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_lightbinstats
+//
+static int32_t osdcmd_lightbinstats(const osdfuncparm_t *parm)
+{
+	if (parm->numparms == 1 && !Bstrcasecmp(parm->parms[0], "reset"))
+	{
+		lightBinning.ResetStats();
+		return OSDCMD_OK;
+	}
+
+	if (parm->numparms != 0)
+		return OSDCMD_SHOWHELP;
+
+	lightBinning.PrintStats();
+
+	return OSDCMD_OK;
+}
+
+/*
+=============
+PolymerNGLightBinning::PolymerNGLightBinning
+=============
+*/
+PolymerNGLightBinning::PolymerNGLightBinning()
+{
+	enabled = true;
+	memset(modelViewProjectionMatrix, 0, sizeof(modelViewProjectionMatrix));
+	memset(tiles, 0, sizeof(tiles));
+	ResetStats();
+}
+
+/*
+=============
+PolymerNGLightBinning::Init
+=============
+*/
+void PolymerNGLightBinning::Init()
+{
+	OSD_RegisterFunction("r_lightbinning", "r_lightbinning <0/1>: bins lights into screen tiles and only shades the tiles a light covers", osdcmd_lightbinning);
+	OSD_RegisterFunction("r_lightbinstats", "r_lightbinstats [reset]: prints how many lights land in each screen tile", osdcmd_lightbinstats);
+}
+
+/*
+=============
+PolymerNGLightBinning::BeginFrame
+=============
+*/
+void PolymerNGLightBinning::BeginFrame(const float4x4 &modelViewProjectionMatrix)
+{
+	memcpy(this->modelViewProjectionMatrix, &modelViewProjectionMatrix.r0.x, sizeof(this->modelViewProjectionMatrix));
+
+	for (int y = 0; y < LIGHTBIN_TILES_Y; y++)
+	{
+		for (int x = 0; x < LIGHTBIN_TILES_X; x++)
+		{
+			tiles[y][x].numLights = 0;
+		}
+	}
+
+	numFrames++;
+}
+
+/*
+=============
+PolymerNGLightBinning::BinLight
+=============
+*/
+bool PolymerNGLightBinning::BinLight(PolymerNGLightLocal *light, int lightIndex, float4 &screenRect)
+{
+	const PolymerNGLightOpts *opts = light->GetOpts();
+	float lightPosition[3] = { opts->position[1], -opts->position[2] / 16.0f, -opts->position[0] };
+
+	// The lighting shaders discard everything outside of this range, for spot lights as well.
+	float radius = opts->radius * 1000.0f;
+
+	float mins[2] = { 1.0f, 1.0f };
+	float maxs[2] = { 0.0f, 0.0f };
+	bool coversScreen = !enabled;
+
+	// Project the corners of the box around the light sphere.
+	for (int i = 0; i < 8 && !coversScreen; i++)
+	{
+		float corner[3];
+		corner[0] = lightPosition[0] + ((i & 1) ? radius : -radius);
+		corner[1] = lightPosition[1] + ((i & 2) ? radius : -radius);
+		corner[2] = lightPosition[2] + ((i & 4) ? radius : -radius);
+
+		float clip[4];
+		for (int d = 0; d < 4; d++)
+		{
+			clip[d] = modelViewProjectionMatrix[d] * corner[0] + modelViewProjectionMatrix[4 + d] * corner[1] + modelViewProjectionMatrix[8 + d] * corner[2] + modelViewProjectionMatrix[12 + d];
+		}
+
+		// Part of the box is behind the camera, there isn't a useful bound to be had.
+		if (clip[3] <= 0.01f)
+		{
+			coversScreen = true;
+			break;
+		}
+
+		float u = (clip[0] / clip[3]) * 0.5f + 0.5f;
+		float v = 0.5f - (clip[1] / clip[3]) * 0.5f;
+
+		mins[0] = min(mins[0], u);
+		mins[1] = min(mins[1], v);
+		maxs[0] = max(maxs[0], u);
+		maxs[1] = max(maxs[1], v);
+	}
+
+	int tileMins[2], tileMaxs[2];
+	if (coversScreen)
+	{
+		tileMins[0] = tileMins[1] = 0;
+		tileMaxs[0] = LIGHTBIN_TILES_X - 1;
+		tileMaxs[1] = LIGHTBIN_TILES_Y - 1;
+	}
+	else
+	{
+		if (maxs[0] <= 0.0f || maxs[1] <= 0.0f || mins[0] >= 1.0f || mins[1] >= 1.0f)
+		{
+			numLightsCulled++;
+			screenRect = float4(0.0f, 0.0f, 0.0f, 0.0f);
+			return false;
+		}
+
+		tileMins[0] = max(0, (int)(mins[0] * LIGHTBIN_TILES_X));
+		tileMins[1] = max(0, (int)(mins[1] * LIGHTBIN_TILES_Y));
+		tileMaxs[0] = min(LIGHTBIN_TILES_X - 1, (int)(maxs[0] * LIGHTBIN_TILES_X));
+		tileMaxs[1] = min(LIGHTBIN_TILES_Y - 1, (int)(maxs[1] * LIGHTBIN_TILES_Y));
+	}
+
+	for (int y = tileMins[1]; y <= tileMaxs[1]; y++)
+	{
+		for (int x = tileMins[0]; x <= tileMaxs[0]; x++)
+		{
+			PolymerNGLightTile *tile = &tiles[y][x];
+			tile->lights[tile->numLights++] = (uint8_t)lightIndex;
+		}
+	}
+
+	screenRect.x = (float)tileMins[0] / LIGHTBIN_TILES_X;
+	screenRect.y = (float)tileMins[1] / LIGHTBIN_TILES_Y;
+	screenRect.z = (float)(tileMaxs[0] + 1) / LIGHTBIN_TILES_X;
+	screenRect.w = (float)(tileMaxs[1] + 1) / LIGHTBIN_TILES_Y;
+
+	numLightsBinned++;
+	numTileEntries += (tileMaxs[0] - tileMins[0] + 1) * (tileMaxs[1] - tileMins[1] + 1);
+	return true;
+}
+
+/*
+=============
+PolymerNGLightBinning::EndFrame
+=============
+*/
+void PolymerNGLightBinning::EndFrame()
+{
+	for (int y = 0; y < LIGHTBIN_TILES_Y; y++)
+	{
+		for (int x = 0; x < LIGHTBIN_TILES_X; x++)
+		{
+			maxLightsInTile = max(maxLightsInTile, tiles[y][x].numLights);
+		}
+	}
+}
+
+/*
+=============
+PolymerNGLightBinning::PrintStats
+=============
+*/
+void PolymerNGLightBinning::PrintStats()
+{
+	if (numFrames == 0)
+	{
+		initprintf("No frames binned yet\n");
+		return;
+	}
+
+	const int numTiles = LIGHTBIN_TILES_X * LIGHTBIN_TILES_Y;
+
+	initprintf("Light binning (%s, %dx%d tiles) over %llu frames\n", enabled ? "enabled" : "disabled", LIGHTBIN_TILES_X, LIGHTBIN_TILES_Y, (unsigned long long)numFrames);
+	initprintf("  %.2f lights binned, %.2f culled off screen per frame\n", (double)numLightsBinned / numFrames, (double)numLightsCulled / numFrames);
+	initprintf("  %.2f lights per tile on average, %d at most\n", (double)numTileEntries / (numFrames * numTiles), maxLightsInTile);
+	if (numLightsBinned)
+	{
+		initprintf("  a light covers %.1f%% of the screen on average\n", ((double)numTileEntries * 100.0) / (numLightsBinned * numTiles));
+	}
+}
+
+/*
+=============
+PolymerNGLightBinning::ResetStats
+=============
+*/
+void PolymerNGLightBinning::ResetStats()
+{
+	numFrames = 0;
+	numLightsBinned = 0;
+	numLightsCulled = 0;
+	numTileEntries = 0;
+	maxLightsInTile = 0;
+}
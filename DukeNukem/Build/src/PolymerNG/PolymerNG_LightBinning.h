@@ -0,0 +1,58 @@
+// PolymerNG_LightBinning.h
+//
+
+#pragma once
+
+#define LIGHTBIN_TILES_X			16
+#define LIGHTBIN_TILES_Y			9
+
+//
+// PolymerNGLightTile
+//
+struct PolymerNGLightTile
+{
+	int						numLights;
+	uint8_t					lights[MAX_VISIBLE_LIGHTS];	// Indexes into the visible light list of the frame.
+};
+
+//
+// PolymerNGLightBinning
+//
+// Splits the screen into a grid of tiles and bins the visible lights into the tiles their bounding sphere covers.
+// Lights that don't cover a single tile are dropped before we spend any time on their shadows, and the lighting pass
+// only shades the tiles a light was binned into instead of the whole screen.
+//
+class PolymerNGLightBinning
+{
+public:
+	PolymerNGLightBinning();
+
+	void				Init();
+
+	void				BeginFrame(const float4x4 &modelViewProjectionMatrix);
+
+	// Returns false if the light can't touch a pixel on screen. screenRect is the bounds of the tiles the light was
+	// binned into, xy is the top left corner and zw the bottom right corner in texture coordinates.
+	bool				BinLight(PolymerNGLightLocal *light, int lightIndex, float4 &screenRect);
+
+	const PolymerNGLightTile *GetTile(int x, int y) const { return &tiles[y][x]; }
+
+	void				EndFrame();
+
+	void				PrintStats();
+	void				ResetStats();
+
+	bool				enabled;
+private:
+	float				modelViewProjectionMatrix[16];
+	PolymerNGLightTile	tiles[LIGHTBIN_TILES_Y][LIGHTBIN_TILES_X];
+
+	// Stats
+	uint64_t			numFrames;
+	uint64_t			numLightsBinned;
+	uint64_t			numLightsCulled;
+	uint64_t			numTileEntries;
+	int					maxLightsInTile;
+};
+
+extern PolymerNGLightBinning lightBinning;
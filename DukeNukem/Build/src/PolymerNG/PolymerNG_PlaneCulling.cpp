@@ -0,0 +1,336 @@
+// PolymerNG_PlaneCulling.cpp
+//
+
+#include "PolymerNG_local.h"
+
+PolymerNGPlaneCulling planeCulling;
+
+//
+// osdcmd_planeculling
+//
+static int32_t osdcmd_planeculling(const osdfuncparm_t *parm)
+{
+	if (parm->numparms != 1)
+	{
+		initprintf("r_planeculling is %d\n", planeCulling.enabled ? 1 : 0);
+		return OSDCMD_OK;
+	}
+
+	planeCulling.enabled = Batol(parm->parms[0]) != 0;
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_planecullsimd
+//
+static int32_t osdcmd_planecullsimd(const osdfuncparm_t *parm)
+{
+	if (parm->numparms != 1)
+	{
+		initprintf("r_planecullsimd is %d\n", planeCulling.useSIMD ? 1 : 0);
+		return OSDCMD_OK;
+	}
+
+	planeCulling.useSIMD = Batol(parm->parms[0]) != 0;
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_planecullbenchmark
+//
+static int32_t osdcmd_planecullbenchmark(const osdfuncparm_t *parm)
+{
+	if (polymerNGPrivate.currentBoard == NULL)
+	{
+		initprintf("r_planecullbenchmark: no board loaded\n");
+		return OSDCMD_OK;
+	}
+
+	int iterations = 100;
+	float radius = 4096.0f;
+
+	if (parm->numparms > 0)
+		iterations = max(1, Batol(parm->parms[0]));
+
+	if (parm->numparms > 1)
+		radius = max(1.0f, (float)Batof(parm->parms[1]));
+
+	planeCulling.RunBenchmark(polymerNGPrivate.currentBoard->GetBoard(), iterations, radius);
+
+	return OSDCMD_OK;
+}
+
+//
+// PlaneCulling_IsPlaneInBoxVertexes
+//
+// The per vertex test the light code did before the board kept plane bounds around.
+//
+static bool PlaneCulling_IsPlaneInBoxVertexes(const Build3DPlane *plane, const float *mins, const float *maxs)
+{
+	if (plane->buffer == NULL || !plane->vertcount)
+		return false;
+
+	for (int i = 0; i < 3; i++)
+	{
+		int numAbove = 0, numBelow = 0;
+
+		for (int j = 0; j < plane->vertcount; j++)
+		{
+			float position = (&plane->buffer[j].position.x)[i];
+			numAbove += (position > maxs[i]);
+			numBelow += (position < mins[i]);
+		}
+
+		if (numAbove == plane->vertcount || numBelow == plane->vertcount)
+			return false;
+	}
+
+	return true;
+}
+
+//
+// PlaneCulling_IsPlaneInFrustumVertexes
+//
+static bool PlaneCulling_IsPlaneInFrustumVertexes(const Build3DPlane *plane, const float *frustum)
+{
+	if (plane->buffer == NULL || !plane->vertcount)
+		return false;
+
+	for (int f = 0; f < PLANECULLING_NUM_FRUSTUM_PLANES; f++)
+	{
+		const float *frustumPlane = &frustum[f * 4];
+		int numBehind = 0;
+
+		for (int j = 0; j < plane->vertcount; j++)
+		{
+			const Build3DVector4 &position = plane->buffer[j].position;
+			numBehind += (frustumPlane[0] * position.x + frustumPlane[1] * position.y + frustumPlane[2] * position.z + frustumPlane[3]) < 0.0f;
+		}
+
+		if (numBehind == plane->vertcount)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+=============
+PolymerNGPlaneCulling::PolymerNGPlaneCulling
+=============
+*/
+PolymerNGPlaneCulling::PolymerNGPlaneCulling()
+{
+	enabled = true;
+	useSIMD = true;
+	hasFrustum = false;
+	memset(frustum, 0, sizeof(frustum));
+	memset(cameraPosition, 0, sizeof(cameraPosition));
+}
+
+/*
+=============
+PolymerNGPlaneCulling::Init
+=============
+*/
+void PolymerNGPlaneCulling::Init()
+{
+	OSD_RegisterFunction("r_planeculling", "r_planeculling <0/1>: skips the planes of visible sectors that are outside of the view frustum", osdcmd_planeculling);
+	OSD_RegisterFunction("r_planecullsimd", "r_planecullsimd <0/1>: tests four plane bounds at a time with SSE", osdcmd_planecullsimd);
+	OSD_RegisterFunction("r_planecullbenchmark", "r_planecullbenchmark [iterations] [radius]: times plane culling over the whole board against the last view and a light box around the camera", osdcmd_planecullbenchmark);
+}
+
+/*
+=============
+PolymerNGPlaneCulling::SetFrustum
+
+Left, right, top, bottom and far, the same planes the light code pulls out of its matrices.
+=============
+*/
+void PolymerNGPlaneCulling::SetFrustum(const float4x4 &modelViewProjectionMatrix, const float3 &cameraPosition)
+{
+	const float *m = &modelViewProjectionMatrix.r0.x;
+
+	for (int i = 0; i < 4; i++)
+	{
+		int ii = i << 2, iii = (i << 2) + 3;
+
+		frustum[i] = m[iii] + m[ii];				// left
+		frustum[i + 4] = m[iii] - m[ii];			// right
+		frustum[i + 8] = m[iii] - m[ii + 1];		// top
+		frustum[i + 12] = m[iii] + m[ii + 1];		// bottom
+		frustum[i + 16] = m[iii] - m[ii + 2];		// far
+	}
+
+	this->cameraPosition[0] = cameraPosition.x;
+	this->cameraPosition[1] = cameraPosition.y;
+	this->cameraPosition[2] = cameraPosition.z;
+
+	hasFrustum = true;
+}
+
+/*
+=============
+PolymerNGPlaneCulling::GetResults
+=============
+*/
+uint8_t *PolymerNGPlaneCulling::GetResults(const Build3DBoard *board, int sectorNum, int &first, int &count)
+{
+	first = board->GetSectorPlaneBounds(sectorNum);
+	count = BUILD3D_PLANEBOUNDS_FIRSTWALL + (sector[sectorNum].wallnum * BUILD3D_PLANEBOUNDS_PERWALL);
+
+	// The SIMD path writes whole batches of four.
+	int numResults = (count + 3) & ~3;
+	if (results.size() < numResults)
+	{
+		results.resize(numResults);
+	}
+
+	return &results[0];
+}
+
+/*
+=============
+PolymerNGPlaneCulling::CullSectorToFrustum
+=============
+*/
+const uint8_t *PolymerNGPlaneCulling::CullSectorToFrustum(const Build3DBoard *board, int sectorNum)
+{
+	int first, count;
+	uint8_t *sectorResults = GetResults(board, sectorNum, first, count);
+
+	if (!enabled || !hasFrustum)
+	{
+		memset(sectorResults, 1, count);
+	}
+	else if (useSIMD)
+	{
+		board->GetPlaneBounds().CullToFrustum(first, count, frustum, PLANECULLING_NUM_FRUSTUM_PLANES, sectorResults);
+	}
+	else
+	{
+		board->GetPlaneBounds().CullToFrustumScalar(first, count, frustum, PLANECULLING_NUM_FRUSTUM_PLANES, sectorResults);
+	}
+
+	return sectorResults;
+}
+
+/*
+=============
+PolymerNGPlaneCulling::CullSectorToBox
+=============
+*/
+const uint8_t *PolymerNGPlaneCulling::CullSectorToBox(const Build3DBoard *board, int sectorNum, const float *mins, const float *maxs)
+{
+	int first, count;
+	uint8_t *sectorResults = GetResults(board, sectorNum, first, count);
+
+	if (useSIMD)
+	{
+		board->GetPlaneBounds().CullToBox(first, count, mins, maxs, sectorResults);
+	}
+	else
+	{
+		board->GetPlaneBounds().CullToBoxScalar(first, count, mins, maxs, sectorResults);
+	}
+
+	return sectorResults;
+}
+
+/*
+=============
+PolymerNGPlaneCulling::RunBenchmark
+
+Culls every plane on the board against the last camera frustum and a box around the camera, once walking the
+vertexes of every plane like the old code did, then with the cached bounds one plane at a time and four at a time.
+=============
+*/
+void PolymerNGPlaneCulling::RunBenchmark(const Build3DBoard *board, int iterations, float radius)
+{
+	if (!hasFrustum)
+	{
+		initprintf("r_planecullbenchmark: draw a frame first\n");
+		return;
+	}
+
+	const Build3DPlaneBounds &planeBounds = board->GetPlaneBounds();
+
+	float mins[3] = { cameraPosition[0] - radius, cameraPosition[1] - radius, cameraPosition[2] - radius };
+	float maxs[3] = { cameraPosition[0] + radius, cameraPosition[1] + radius, cameraPosition[2] + radius };
+
+	int numBoxVertexes = 0, numFrustumVertexes = 0;
+	double startTime = gethiticks();
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		numBoxVertexes = numFrustumVertexes = 0;
+		for (int s = 0; s < numsectors; s++)
+		{
+			const Build3DSector *build3DSector = board->GetSector(s);
+			numBoxVertexes += PlaneCulling_IsPlaneInBoxVertexes(&build3DSector->ceil, mins, maxs) + PlaneCulling_IsPlaneInBoxVertexes(&build3DSector->floor, mins, maxs);
+			numFrustumVertexes += PlaneCulling_IsPlaneInFrustumVertexes(&build3DSector->ceil, frustum) + PlaneCulling_IsPlaneInFrustumVertexes(&build3DSector->floor, frustum);
+
+			for (int w = 0; w < sector[s].wallnum; w++)
+			{
+				const Build3DWall *wall = board->GetWall(sector[s].wallptr + w);
+				numBoxVertexes += PlaneCulling_IsPlaneInBoxVertexes(&wall->wall, mins, maxs) + PlaneCulling_IsPlaneInBoxVertexes(&wall->over, mins, maxs) + PlaneCulling_IsPlaneInBoxVertexes(&wall->mask, mins, maxs);
+				numFrustumVertexes += PlaneCulling_IsPlaneInFrustumVertexes(&wall->wall, frustum) + PlaneCulling_IsPlaneInFrustumVertexes(&wall->over, frustum) + PlaneCulling_IsPlaneInFrustumVertexes(&wall->mask, frustum);
+			}
+		}
+	}
+	double vertexTime = gethiticks() - startTime;
+
+	std::vector<uint8_t> scalarBox, scalarFrustum, simdBox, simdFrustum;
+	int numPlanes = planeBounds.GetNumPlanes();
+	int numResults = numPlanes + 4;
+	scalarBox.resize(numResults);
+	scalarFrustum.resize(numResults);
+	simdBox.resize(numResults);
+	simdFrustum.resize(numResults);
+
+	// Per sector batches, the way the gather and the light code call in.
+	startTime = gethiticks();
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		for (int s = 0; s < numsectors; s++)
+		{
+			int first = board->GetSectorPlaneBounds(s);
+			int count = BUILD3D_PLANEBOUNDS_FIRSTWALL + (sector[s].wallnum * BUILD3D_PLANEBOUNDS_PERWALL);
+			planeBounds.CullToBoxScalar(first, count, mins, maxs, &scalarBox[first]);
+			planeBounds.CullToFrustumScalar(first, count, frustum, PLANECULLING_NUM_FRUSTUM_PLANES, &scalarFrustum[first]);
+		}
+	}
+	double scalarTime = gethiticks() - startTime;
+
+	// Batches write past their end, go through the sectors in order so the overlap is overwritten by the next sector.
+	startTime = gethiticks();
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		for (int s = 0; s < numsectors; s++)
+		{
+			int first = board->GetSectorPlaneBounds(s);
+			int count = BUILD3D_PLANEBOUNDS_FIRSTWALL + (sector[s].wallnum * BUILD3D_PLANEBOUNDS_PERWALL);
+			planeBounds.CullToBox(first, count, mins, maxs, &simdBox[first]);
+			planeBounds.CullToFrustum(first, count, frustum, PLANECULLING_NUM_FRUSTUM_PLANES, &simdFrustum[first]);
+		}
+	}
+	double simdTime = gethiticks() - startTime;
+
+	int numBoxScalar = 0, numFrustumScalar = 0, numMismatches = 0;
+	for (int i = 0; i < numPlanes; i++)
+	{
+		numBoxScalar += scalarBox[i];
+		numFrustumScalar += scalarFrustum[i];
+		numMismatches += (scalarBox[i] != simdBox[i]) + (scalarFrustum[i] != simdFrustum[i]);
+	}
+
+	double numTests = (double)numPlanes * iterations * 2;
+
+	initprintf("--------Plane Culling Benchmark (%d planes, %d iterations)--------\n", numPlanes, iterations);
+	initprintf("..per vertex %.2fms (%.1fns per plane), %d in the box, %d in the frustum\n", vertexTime, vertexTime * 1000000.0 / numTests, numBoxVertexes, numFrustumVertexes);
+	initprintf("..cached bounds %.2fms (%.1fns per plane), %d in the box, %d in the frustum\n", scalarTime, scalarTime * 1000000.0 / numTests, numBoxScalar, numFrustumScalar);
+	initprintf("..cached bounds SSE %.2fms (%.1fns per plane)\n", simdTime, simdTime * 1000000.0 / numTests);
+	if (numMismatches)
+		initprintf("..%d SSE results don't match the scalar path!\n", numMismatches);
+}
@@ -0,0 +1,40 @@
+// PolymerNG_PlaneCulling.h
+//
+
+#pragma once
+
+#define PLANECULLING_NUM_FRUSTUM_PLANES		5
+
+//
+// PolymerNGPlaneCulling
+//
+// Culls all the planes of a sector against the camera frustum or a light box in one batch, using the plane bounds the
+// board keeps up to date. The results are laid out like the sector's range in Build3DPlaneBounds.
+//
+class PolymerNGPlaneCulling
+{
+public:
+	PolymerNGPlaneCulling();
+
+	void				Init();
+
+	void				SetFrustum(const float4x4 &modelViewProjectionMatrix, const float3 &cameraPosition);
+
+	// Game thread, the returned results are only valid until the next call.
+	const uint8_t		*CullSectorToFrustum(const Build3DBoard *board, int sectorNum);
+	const uint8_t		*CullSectorToBox(const Build3DBoard *board, int sectorNum, const float *mins, const float *maxs);
+
+	void				RunBenchmark(const Build3DBoard *board, int iterations, float radius);
+
+	bool				enabled;
+	bool				useSIMD;
+private:
+	uint8_t				*GetResults(const Build3DBoard *board, int sectorNum, int &first, int &count);
+
+	bool				hasFrustum;
+	float				frustum[PLANECULLING_NUM_FRUSTUM_PLANES * 4];
+	float				cameraPosition[3];
+	std::vector<uint8_t> results;
+};
+
+extern PolymerNGPlaneCulling planeCulling;
@@ -8,19 +8,170 @@
 #include "Models/Models.h"
 
 #include <algorithm>
+#include <xmmintrin.h>
 
+// Occluders whose screen bounds cover less than this percentage of the occlusion buffer aren't worth rasterizing.
 float gOccluderSizeThreshold = 1.5f;
 float gOccludeeSizeThreshold = 0.01f;
 
 float *currentModelViewMatrixCulling;
 
+// Anything closer than this to the camera is clipped away from occluders, and never occluded itself.
+#define OCCLUSION_NEAR_W				0.01f
+
+// Occluders are clipped to twice the size of the screen, so the edge functions stay well inside of float precision.
+#define OCCLUSION_GUARD_BAND			2.0f
+
+// A triangle clipped against five planes gains at most five vertexes.
+#define OCCLUSION_MAX_CLIP_VERTEXES		8
+
+static bool occlusionEnabled = true;
+static PolymerNGOcclusionStats occlusionStats;
+
+//
+// osdcmd_occlusion
+//
+static int32_t osdcmd_occlusion(const osdfuncparm_t *parm)
+{
+	if (parm->numparms != 1)
+	{
+		initprintf("r_occlusion is %d\n", occlusionEnabled ? 1 : 0);
+		return OSDCMD_OK;
+	}
+
+	occlusionEnabled = Batol(parm->parms[0]) != 0;
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_occlusionstats
+//
+static int32_t osdcmd_occlusionstats(const osdfuncparm_t *parm)
+{
+	if (parm->numparms == 1 && !Bstrcasecmp(parm->parms[0], "reset"))
+	{
+		PolymerNGVisibilityEngine::ResetStats();
+		return OSDCMD_OK;
+	}
+
+	if (parm->numparms != 0)
+		return OSDCMD_SHOWHELP;
+
+	PolymerNGVisibilityEngine::PrintStats();
+
+	return OSDCMD_OK;
+}
+
+//
+// Occlusion_ClipPolygon
+//
+// Sutherland-Hodgman against the near plane and the guard band, vertexes are clip space x, y, z, w.
+//
+static int Occlusion_ClipPolygon(float4 *vertexes, int numVertexes, float4 *scratch)
+{
+	float4 *in = vertexes;
+	float4 *out = scratch;
+
+	for (int p = 0; p < 5 && numVertexes > 0; p++)
+	{
+		float distances[OCCLUSION_MAX_CLIP_VERTEXES];
+		for (int i = 0; i < numVertexes; i++)
+		{
+			const float4 &v = in[i];
+			switch (p)
+			{
+				case 0: distances[i] = v.w - OCCLUSION_NEAR_W; break;
+				case 1: distances[i] = OCCLUSION_GUARD_BAND * v.w - v.x; break;
+				case 2: distances[i] = OCCLUSION_GUARD_BAND * v.w + v.x; break;
+				case 3: distances[i] = OCCLUSION_GUARD_BAND * v.w - v.y; break;
+				case 4: distances[i] = OCCLUSION_GUARD_BAND * v.w + v.y; break;
+			}
+		}
+
+		int numOut = 0;
+		for (int i = 0; i < numVertexes; i++)
+		{
+			int next = (i + 1) % numVertexes;
+
+			if (distances[i] >= 0.0f)
+			{
+				out[numOut++] = in[i];
+			}
+
+			if ((distances[i] >= 0.0f) != (distances[next] >= 0.0f))
+			{
+				float t = distances[i] / (distances[i] - distances[next]);
+				out[numOut++] = in[i] + (in[next] - in[i]) * t;
+			}
+		}
+
+		std::swap(in, out);
+		numVertexes = numOut;
+	}
+
+	if (in != vertexes)
+	{
+		memcpy(vertexes, in, sizeof(float4) * numVertexes);
+	}
+
+	return numVertexes;
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::PolymerNGVisibilityEngine
+=============
+*/
 PolymerNGVisibilityEngine::PolymerNGVisibilityEngine(PolymerNGBoard *board)
 {
 	currentBoard = board;
+	occlusionReady = false;
+	memset(occlusionViewProjectionMatrix, 0, sizeof(occlusionViewProjectionMatrix));
+
+	int width = OCCLUSION_BUFFER_WIDTH;
+	int height = OCCLUSION_BUFFER_HEIGHT;
+	for (numHiZLevels = 0; numHiZLevels < OCCLUSION_MAX_HIZ_LEVELS; numHiZLevels++)
+	{
+		hiZ[numHiZLevels] = (float *)Xaligned_alloc(16, width * height * sizeof(float));
+		hiZWidth[numHiZLevels] = width;
+		hiZHeight[numHiZLevels] = height;
+
+		if (width == 1 && height == 1)
+		{
+			numHiZLevels++;
+			break;
+		}
+
+		width = (width + 1) / 2;
+		height = (height + 1) / 2;
+	}
 }
 
+/*
+=============
+PolymerNGVisibilityEngine::~PolymerNGVisibilityEngine
+=============
+*/
 PolymerNGVisibilityEngine::~PolymerNGVisibilityEngine()
 {
+	for (int i = 0; i < numHiZLevels; i++)
+	{
+		Baligned_free(hiZ[i]);
+	}
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::Init
+=============
+*/
+void PolymerNGVisibilityEngine::Init()
+{
+	ResetStats();
+
+	OSD_RegisterFunction("r_occlusion", "r_occlusion <0/1>: rasterizes the big walls and floors in software and skips the sprites and lights behind them", osdcmd_occlusion);
+	OSD_RegisterFunction("r_occlusionstats", "r_occlusionstats [reset]: prints how many sprites and lights the occlusion culling skipped", osdcmd_occlusionstats);
 }
 
 //
@@ -28,7 +179,7 @@ PolymerNGVisibilityEngine::~PolymerNGVisibilityEngine()
 //
 void PolymerNGVisibilityEngine::CreateOcclusionFromBoard()
 {
-	// Don't have to anything :).
+	// Occluders come straight from the board planes every frame, there is nothing to build up front.
 }
 
 //
@@ -50,4 +201,496 @@ void PolymerNGVisibilityEngine::FindVisibleSectors(BuildRenderThreadTaskRenderWo
 
 //	std::sort(visibleSectorList.begin(), visibleSectorList.end());
 //	visibleSectorList.erase(std::unique(visibleSectorList.begin(), visibleSectorList.end()), visibleSectorList.end());
-}
\ No newline at end of file
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::BeginOcclusion
+=============
+*/
+void PolymerNGVisibilityEngine::BeginOcclusion(const float4x4 &occlusionViewProjectionMatrix)
+{
+	memcpy(this->occlusionViewProjectionMatrix, &occlusionViewProjectionMatrix.r0.x, sizeof(this->occlusionViewProjectionMatrix));
+
+	occluders.clear();
+	occlusionReady = false;
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::AddOccluder
+=============
+*/
+void PolymerNGVisibilityEngine::AddOccluder(const Build3DPlane *plane)
+{
+	if (!occlusionEnabled)
+		return;
+
+	occluders.push_back(plane);
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::RasterizeOccluders
+=============
+*/
+void PolymerNGVisibilityEngine::RasterizeOccluders()
+{
+	if (!occlusionEnabled)
+		return;
+
+	double startTime = gethiticks();
+
+	triangles.clear();
+	for (int i = 0; i < occluders.size(); i++)
+	{
+		SetupOccluder(occluders[i]);
+	}
+
+	// Every band owns its own rows of the depth buffer, so the jobs never touch the same memory.
+	BuildJobCounter rasterCounter;
+	jobSystem.ParallelFor(OCCLUSION_NUM_BANDS, 1, RasterizeBandJob, this, &rasterCounter);
+	jobSystem.Wait(&rasterCounter);
+
+	BuildHiZ();
+
+	occlusionReady = true;
+
+	occlusionStats.numFrames++;
+	occlusionStats.numOccluders += occluders.size();
+	occlusionStats.numTriangles += triangles.size();
+	occlusionStats.rasterTimeMs += gethiticks() - startTime;
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::SetupOccluder
+=============
+*/
+void PolymerNGVisibilityEngine::SetupOccluder(const Build3DPlane *plane)
+{
+	if (plane->buffer == NULL || plane->indices == NULL || plane->indicescount < 3)
+		return;
+
+	const float *m = occlusionViewProjectionMatrix;
+
+	clipVertexes.resize(plane->vertcount);
+
+	float mins[2] = { FLT_MAX, FLT_MAX };
+	float maxs[2] = { -FLT_MAX, -FLT_MAX };
+	bool crossesNearPlane = false;
+
+	for (int i = 0; i < plane->vertcount; i++)
+	{
+		const Build3DVector4 &position = plane->buffer[i].position;
+		float4 &clip = clipVertexes[i];
+
+		clip.x = m[0] * position.x + m[4] * position.y + m[8] * position.z + m[12];
+		clip.y = m[1] * position.x + m[5] * position.y + m[9] * position.z + m[13];
+		clip.z = m[2] * position.x + m[6] * position.y + m[10] * position.z + m[14];
+		clip.w = m[3] * position.x + m[7] * position.y + m[11] * position.z + m[15];
+
+		if (clip.w <= OCCLUSION_NEAR_W)
+		{
+			crossesNearPlane = true;
+			continue;
+		}
+
+		float x = clip.x / clip.w;
+		float y = clip.y / clip.w;
+		mins[0] = min(mins[0], x);
+		mins[1] = min(mins[1], y);
+		maxs[0] = max(maxs[0], x);
+		maxs[1] = max(maxs[1], y);
+	}
+
+	// Planes the camera is standing next to are always big enough.
+	if (!crossesNearPlane)
+	{
+		// Normalized device coordinates span 2x2, so a quarter of the area is the fraction of the screen.
+		float screenArea = (min(maxs[0], 1.0f) - max(mins[0], -1.0f)) * (min(maxs[1], 1.0f) - max(mins[1], -1.0f)) * 0.25f;
+		if (maxs[0] <= -1.0f || mins[0] >= 1.0f || maxs[1] <= -1.0f || mins[1] >= 1.0f || screenArea * 100.0f < gOccluderSizeThreshold)
+			return;
+	}
+
+	for (int i = 0; i + 2 < plane->indicescount; i += 3)
+	{
+		float4 polygon[OCCLUSION_MAX_CLIP_VERTEXES];
+		float4 scratch[OCCLUSION_MAX_CLIP_VERTEXES];
+
+		polygon[0] = clipVertexes[plane->indices[i + 0]];
+		polygon[1] = clipVertexes[plane->indices[i + 1]];
+		polygon[2] = clipVertexes[plane->indices[i + 2]];
+
+		int numVertexes = Occlusion_ClipPolygon(polygon, 3, scratch);
+		for (int d = 1; d + 1 < numVertexes; d++)
+		{
+			SetupTriangle(&polygon[0].x, &polygon[d].x, &polygon[d + 1].x);
+		}
+	}
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::SetupTriangle
+=============
+*/
+void PolymerNGVisibilityEngine::SetupTriangle(const float *v0, const float *v1, const float *v2)
+{
+	const float *clip[3] = { v0, v1, v2 };
+	float x[3], y[3], invW[3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		invW[i] = 1.0f / clip[i][3];
+		x[i] = (clip[i][0] * invW[i] * 0.5f + 0.5f) * VISPASS_WIDTH;
+		y[i] = (0.5f - clip[i][1] * invW[i] * 0.5f) * VISPASS_HEIGHT;
+	}
+
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (fabs(area) < 0.0001f)
+		return;
+
+	// Both sides of a plane occlude, flip the winding so the inside is always positive.
+	if (area < 0.0f)
+	{
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		std::swap(invW[1], invW[2]);
+		area = -area;
+	}
+
+	PolymerNGOccluderTriangle triangle;
+
+	triangle.minX = max(0, (int)floorf(min(x[0], min(x[1], x[2]))));
+	triangle.maxX = min(VISPASS_WIDTH - 1, (int)ceilf(max(x[0], max(x[1], x[2]))));
+	triangle.minY = max(0, (int)floorf(min(y[0], min(y[1], y[2]))));
+	triangle.maxY = min(VISPASS_HEIGHT - 1, (int)ceilf(max(y[0], max(y[1], y[2]))));
+
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+		return;
+
+	// Edge i runs from vertex i to the next one, and weighs the vertex across from it.
+	for (int i = 0; i < 3; i++)
+	{
+		int next = (i + 1) % 3;
+		triangle.edgeA[i] = y[i] - y[next];
+		triangle.edgeB[i] = x[next] - x[i];
+		triangle.edgeC[i] = x[i] * y[next] - y[i] * x[next];
+	}
+
+	float oneOverArea = 1.0f / area;
+	triangle.depthA = (triangle.edgeA[1] * invW[0] + triangle.edgeA[2] * invW[1] + triangle.edgeA[0] * invW[2]) * oneOverArea;
+	triangle.depthB = (triangle.edgeB[1] * invW[0] + triangle.edgeB[2] * invW[1] + triangle.edgeB[0] * invW[2]) * oneOverArea;
+	triangle.depthC = (triangle.edgeC[1] * invW[0] + triangle.edgeC[2] * invW[1] + triangle.edgeC[0] * invW[2]) * oneOverArea;
+
+	triangles.push_back(triangle);
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::RasterizeBandJob
+=============
+*/
+void PolymerNGVisibilityEngine::RasterizeBandJob(void *data, int begin, int end)
+{
+	PolymerNGVisibilityEngine *engine = (PolymerNGVisibilityEngine *)data;
+
+	for (int band = begin; band < end; band++)
+	{
+		engine->RasterizeBand(band);
+	}
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::RasterizeBand
+
+The depth buffer holds 1/w, zero is infinitely far away. Four pixels of a row are done at a time.
+=============
+*/
+void PolymerNGVisibilityEngine::RasterizeBand(int band)
+{
+	const int rowsPerBand = (OCCLUSION_BUFFER_HEIGHT + OCCLUSION_NUM_BANDS - 1) / OCCLUSION_NUM_BANDS;
+	const int bandMinY = band * rowsPerBand;
+	const int bandMaxY = min(OCCLUSION_BUFFER_HEIGHT, bandMinY + rowsPerBand) - 1;
+
+	float *depthBuffer = hiZ[0];
+
+	if (bandMinY > bandMaxY)
+		return;
+
+	memset(&depthBuffer[bandMinY * OCCLUSION_BUFFER_WIDTH], 0, (bandMaxY - bandMinY + 1) * OCCLUSION_BUFFER_WIDTH * sizeof(float));
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 pixelCenters = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 four = _mm_set1_ps(4.0f);
+
+	for (int t = 0; t < triangles.size(); t++)
+	{
+		const PolymerNGOccluderTriangle &triangle = triangles[t];
+
+		int minY = max(triangle.minY, bandMinY);
+		int maxY = min(triangle.maxY, bandMaxY);
+		if (minY > maxY)
+			continue;
+
+		const __m128 edgeA0 = _mm_set1_ps(triangle.edgeA[0]);
+		const __m128 edgeA1 = _mm_set1_ps(triangle.edgeA[1]);
+		const __m128 edgeA2 = _mm_set1_ps(triangle.edgeA[2]);
+		const __m128 depthA = _mm_set1_ps(triangle.depthA);
+
+		int startX = triangle.minX & ~3;
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			float pixelY = (float)y + 0.5f;
+
+			const __m128 rowEdge0 = _mm_set1_ps(triangle.edgeB[0] * pixelY + triangle.edgeC[0]);
+			const __m128 rowEdge1 = _mm_set1_ps(triangle.edgeB[1] * pixelY + triangle.edgeC[1]);
+			const __m128 rowEdge2 = _mm_set1_ps(triangle.edgeB[2] * pixelY + triangle.edgeC[2]);
+			const __m128 rowDepth = _mm_set1_ps(triangle.depthB * pixelY + triangle.depthC);
+
+			float *row = &depthBuffer[y * OCCLUSION_BUFFER_WIDTH];
+			__m128 pixelX = _mm_add_ps(_mm_set1_ps((float)startX), pixelCenters);
+
+			for (int x = startX; x <= triangle.maxX; x += 4)
+			{
+				__m128 edge0 = _mm_add_ps(_mm_mul_ps(edgeA0, pixelX), rowEdge0);
+				__m128 edge1 = _mm_add_ps(_mm_mul_ps(edgeA1, pixelX), rowEdge1);
+				__m128 edge2 = _mm_add_ps(_mm_mul_ps(edgeA2, pixelX), rowEdge2);
+
+				__m128 inside = _mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_and_ps(_mm_cmpge_ps(edge1, zero), _mm_cmpge_ps(edge2, zero)));
+				if (_mm_movemask_ps(inside))
+				{
+					__m128 depth = _mm_add_ps(_mm_mul_ps(depthA, pixelX), rowDepth);
+					__m128 current = _mm_load_ps(&row[x]);
+					__m128 nearest = _mm_max_ps(current, depth);
+					_mm_store_ps(&row[x], _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+				}
+
+				pixelX = _mm_add_ps(pixelX, four);
+			}
+		}
+	}
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::BuildHiZ
+
+Texels past the edge of the level below count as empty, so they can only make the test more conservative.
+=============
+*/
+void PolymerNGVisibilityEngine::BuildHiZ()
+{
+	for (int level = 1; level < numHiZLevels; level++)
+	{
+		const float *src = hiZ[level - 1];
+		const int srcWidth = hiZWidth[level - 1];
+		const int srcHeight = hiZHeight[level - 1];
+		float *dst = hiZ[level];
+
+		for (int y = 0; y < hiZHeight[level]; y++)
+		{
+			int y0 = y * 2;
+			int y1 = min(y0 + 1, srcHeight - 1);
+
+			for (int x = 0; x < hiZWidth[level]; x++)
+			{
+				int x0 = x * 2;
+				int x1 = x0 + 1;
+
+				float farthest = min(src[y0 * srcWidth + x0], src[y1 * srcWidth + x0]);
+				if (x1 < srcWidth)
+				{
+					farthest = min(farthest, min(src[y0 * srcWidth + x1], src[y1 * srcWidth + x1]));
+				}
+				else
+				{
+					farthest = 0.0f;
+				}
+
+				if (y0 + 1 >= srcHeight)
+				{
+					farthest = 0.0f;
+				}
+
+				dst[y * hiZWidth[level] + x] = farthest;
+			}
+		}
+	}
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::IsBoxVisible
+=============
+*/
+bool PolymerNGVisibilityEngine::IsBoxVisible(const float *mins, const float *maxs)
+{
+	if (!occlusionEnabled || !occlusionReady)
+		return true;
+
+	const float *m = occlusionViewProjectionMatrix;
+
+	float screenMins[2] = { FLT_MAX, FLT_MAX };
+	float screenMaxs[2] = { -FLT_MAX, -FLT_MAX };
+	float nearestDepth = 0.0f;
+
+	for (int i = 0; i < 8; i++)
+	{
+		float corner[3];
+		corner[0] = (i & 1) ? maxs[0] : mins[0];
+		corner[1] = (i & 2) ? maxs[1] : mins[1];
+		corner[2] = (i & 4) ? maxs[2] : mins[2];
+
+		float clipX = m[0] * corner[0] + m[4] * corner[1] + m[8] * corner[2] + m[12];
+		float clipY = m[1] * corner[0] + m[5] * corner[1] + m[9] * corner[2] + m[13];
+		float clipW = m[3] * corner[0] + m[7] * corner[1] + m[11] * corner[2] + m[15];
+
+		if (clipW <= OCCLUSION_NEAR_W)
+			return true;
+
+		float invW = 1.0f / clipW;
+		float x = (clipX * invW * 0.5f + 0.5f) * VISPASS_WIDTH;
+		float y = (0.5f - clipY * invW * 0.5f) * VISPASS_HEIGHT;
+
+		screenMins[0] = min(screenMins[0], x);
+		screenMins[1] = min(screenMins[1], y);
+		screenMaxs[0] = max(screenMaxs[0], x);
+		screenMaxs[1] = max(screenMaxs[1], y);
+		nearestDepth = max(nearestDepth, invW);
+	}
+
+	int minX = max(0, (int)floorf(screenMins[0]));
+	int minY = max(0, (int)floorf(screenMins[1]));
+	int maxX = min(VISPASS_WIDTH - 1, (int)floorf(screenMaxs[0]));
+	int maxY = min(VISPASS_HEIGHT - 1, (int)floorf(screenMaxs[1]));
+
+	// Off the occlusion buffer, that's for the frustum culling to decide.
+	if (minX > maxX || minY > maxY)
+		return true;
+
+	// Go up the pyramid until the box covers a couple of texels.
+	int level = 0;
+	while (level < numHiZLevels - 1 && max((maxX >> level) - (minX >> level), (maxY >> level) - (minY >> level)) > 2)
+	{
+		level++;
+	}
+
+	const float *levelDepth = hiZ[level];
+	const int levelWidth = hiZWidth[level];
+	float farthestOccluder = FLT_MAX;
+
+	for (int y = minY >> level; y <= (maxY >> level); y++)
+	{
+		for (int x = minX >> level; x <= (maxX >> level); x++)
+		{
+			farthestOccluder = min(farthestOccluder, levelDepth[y * levelWidth + x]);
+		}
+	}
+
+	return nearestDepth >= farthestOccluder;
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::IsSpriteVisible
+=============
+*/
+bool PolymerNGVisibilityEngine::IsSpriteVisible(const Build3DSprite *sprite)
+{
+	float3 localMins, localMaxs;
+
+	if (sprite->cacheModel)
+	{
+		sprite->cacheModel->GetBounds(localMins, localMaxs);
+
+		if (localMins.x > localMaxs.x)
+			return true;
+	}
+	else
+	{
+		// Covers both the upright and the flat sprite quad.
+		localMins = float3(-0.5f, 0.0f, -0.5f);
+		localMaxs = float3(0.5f, 1.0f, 0.5f);
+	}
+
+	float mins[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float maxs[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	for (int i = 0; i < 8; i++)
+	{
+		float4 corner((i & 1) ? localMaxs.x : localMins.x, (i & 2) ? localMaxs.y : localMins.y, (i & 4) ? localMaxs.z : localMins.z, 1.0f);
+		float4 worldCorner = corner * sprite->modelMatrix;
+
+		mins[0] = min(mins[0], worldCorner.x);
+		mins[1] = min(mins[1], worldCorner.y);
+		mins[2] = min(mins[2], worldCorner.z);
+		maxs[0] = max(maxs[0], worldCorner.x);
+		maxs[1] = max(maxs[1], worldCorner.y);
+		maxs[2] = max(maxs[2], worldCorner.z);
+	}
+
+	bool isVisible = IsBoxVisible(mins, maxs);
+
+	occlusionStats.numSpritesTested++;
+	occlusionStats.numSpritesCulled += !isVisible;
+
+	return isVisible;
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::IsLightVisible
+
+Everything a light can touch is inside of its box, if the box is hidden so is everything it lights.
+=============
+*/
+bool PolymerNGVisibilityEngine::IsLightVisible(PolymerNGLightLocal *light)
+{
+	float mins[3], maxs[3];
+
+	light->GetLightBox(mins, maxs);
+
+	bool isVisible = IsBoxVisible(mins, maxs);
+
+	occlusionStats.numLightsTested++;
+	occlusionStats.numLightsCulled += !isVisible;
+
+	return isVisible;
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::PrintStats
+=============
+*/
+void PolymerNGVisibilityEngine::PrintStats()
+{
+	const PolymerNGOcclusionStats &stats = occlusionStats;
+
+	if (stats.numFrames == 0)
+	{
+		initprintf("No frames rasterized yet\n");
+		return;
+	}
+
+	initprintf("Occlusion culling (%s, %dx%d, %d bands) over %llu frames\n", occlusionEnabled ? "enabled" : "disabled", VISPASS_WIDTH, VISPASS_HEIGHT, OCCLUSION_NUM_BANDS, (unsigned long long)stats.numFrames);
+	initprintf("  %.1f occluders, %.1f triangles, %.3fms rasterizing per frame\n", (double)stats.numOccluders / stats.numFrames, (double)stats.numTriangles / stats.numFrames, stats.rasterTimeMs / stats.numFrames);
+	initprintf("  sprites: %.1f tested, %.1f culled per frame (%.1f%%)\n", (double)stats.numSpritesTested / stats.numFrames, (double)stats.numSpritesCulled / stats.numFrames,
+		stats.numSpritesTested ? (stats.numSpritesCulled * 100.0) / stats.numSpritesTested : 0.0);
+	initprintf("  lights: %.1f tested, %.1f culled per frame (%.1f%%)\n", (double)stats.numLightsTested / stats.numFrames, (double)stats.numLightsCulled / stats.numFrames,
+		stats.numLightsTested ? (stats.numLightsCulled * 100.0) / stats.numLightsTested : 0.0);
+}
+
+/*
+=============
+PolymerNGVisibilityEngine::ResetStats
+=============
+*/
+void PolymerNGVisibilityEngine::ResetStats()
+{
+	memset(&occlusionStats, 0, sizeof(occlusionStats));
+}
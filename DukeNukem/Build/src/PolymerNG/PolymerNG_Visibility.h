@@ -3,21 +3,105 @@
 
 #pragma once
 
+#include "../Threading/jobsystem.h"
+
 class PolymerNGBoard;
+class PolymerNGLightLocal;
+
+// VISPASS_WIDTH rounded up so the rasterizer can always write four pixels at a time, and VISPASS_HEIGHT.
+#define OCCLUSION_BUFFER_WIDTH			276
+#define OCCLUSION_BUFFER_HEIGHT			154
+#define OCCLUSION_MAX_HIZ_LEVELS		10
+
+// The depth buffer is split into bands of rows, each band is rasterized by its own job.
+#define OCCLUSION_NUM_BANDS				14
+
+//
+// PolymerNGOccluderTriangle
+//
+// Screen space triangle set up for rasterizing, a pixel is covered when all three edge functions are positive at its center.
+//
+struct PolymerNGOccluderTriangle
+{
+	float		edgeA[3];
+	float		edgeB[3];
+	float		edgeC[3];
+
+	// 1/w across the triangle is depthA * x + depthB * y + depthC.
+	float		depthA;
+	float		depthB;
+	float		depthC;
+
+	int			minX, maxX;
+	int			minY, maxY;
+};
+
+//
+// PolymerNGOcclusionStats
+//
+struct PolymerNGOcclusionStats
+{
+	uint64_t	numFrames;
+	uint64_t	numOccluders;
+	uint64_t	numTriangles;
+	uint64_t	numSpritesTested;
+	uint64_t	numSpritesCulled;
+	uint64_t	numLightsTested;
+	uint64_t	numLightsCulled;
+	double		rasterTimeMs;
+};
 
 //
 // PolymerNGVisibilityEngine
 //
+// Besides finding the visible sectors, the big walls and floors of those sectors are rasterized into a small depth
+// buffer with a hierarchical-Z pyramid on top of it. Sprites, models and lights are tested against the pyramid before
+// they get drawn.
+//
 class PolymerNGVisibilityEngine
 {
 public:
 	PolymerNGVisibilityEngine(PolymerNGBoard *board);
 	~PolymerNGVisibilityEngine();
 
+	static void				Init();
+
 	void					CreateOcclusionFromBoard();
 
 	void					FindVisibleSectors(BuildRenderThreadTaskRenderWorld &renderWorldTask, float *modelViewMatrix, float *projectionMatrix, int32_t *visibleSectorList, int &numVisibleSectors);
+
+	// Game thread, occluders are queued up while the visible planes are gathered and rasterized in one go.
+	void					BeginOcclusion(const float4x4 &occlusionViewProjectionMatrix);
+	void					AddOccluder(const Build3DPlane *plane);
+	void					RasterizeOccluders();
+
+	// Boxes are in world space, anything that can't be tested is visible.
+	bool					IsBoxVisible(const float *mins, const float *maxs);
+	bool					IsSpriteVisible(const Build3DSprite *sprite);
+	bool					IsLightVisible(PolymerNGLightLocal *light);
+
+	static void				PrintStats();
+	static void				ResetStats();
 private:
+	void					SetupOccluder(const Build3DPlane *plane);
+	void					SetupTriangle(const float *v0, const float *v1, const float *v2);
+	void					RasterizeBand(int band);
+	void					BuildHiZ();
+
+	static void				RasterizeBandJob(void *data, int begin, int end);
 
 	PolymerNGBoard			*currentBoard;
-};
\ No newline at end of file
+
+	float					occlusionViewProjectionMatrix[16];
+	bool					occlusionReady;
+
+	std::vector<const Build3DPlane *> occluders;
+	std::vector<PolymerNGOccluderTriangle> triangles;
+	std::vector<float4>		clipVertexes;
+
+	// Level zero is the depth buffer itself, every level after holds the farthest depth of the four texels below it.
+	float					*hiZ[OCCLUSION_MAX_HIZ_LEVELS];
+	int						hiZWidth[OCCLUSION_MAX_HIZ_LEVELS];
+	int						hiZHeight[OCCLUSION_MAX_HIZ_LEVELS];
+	int						numHiZLevels;
+};
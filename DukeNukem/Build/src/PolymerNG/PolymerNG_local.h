@@ -10,6 +10,7 @@
 #include "cache1d.h"
 #include "a.h"
 #include "osd.h"
+#include "baselayer.h"
 #include "crc32.h"
 #include "xxhash.h"
 #include "lz4.h"
@@ -21,8 +22,12 @@
 #include "PolymerNG_RenderProgram.h"
 #include "PolymerNG_RenderTarget.h"
 #include "PolymerNG_Visibility.h"
+#include "ShadowCache/ShadowCache.h"
 #include "PolymerNG_Light.h"
+#include "PolymerNG_LightBinning.h"
+#include "PolymerNG_PlaneCulling.h"
 #include "PolymerNG_Board.h"
+#include "PolymerNG_CameraPath.h"
 
 //#include "ShaderBuild/ShaderBinary.h"
 //#include "ShaderBuild/ShaderBuild.h"
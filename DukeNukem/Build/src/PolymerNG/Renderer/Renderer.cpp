@@ -4,7 +4,9 @@
 #include "Renderer.h"
 #include "build3d.h"
 #include "../PolymerNG_local.h"
+#include "../../Profiler/profiler.h"
 #include <mutex>
+#include <chrono>
 
 Renderer renderer;
 
@@ -15,24 +17,59 @@ int gpuExecTimeInMilliseconds = 0;
 
 int GetCurrentTimeInMilliseconds()
 {
+#ifdef _WIN32
 	SYSTEMTIME st;
 	GetSystemTime(&st);
 	return st.wMilliseconds;
+#else
+	// the millisecond field of the wall clock, same as wMilliseconds
+	return (int)(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() % 1000);
+#endif
+}
+
+//
+// osdcmd_renderqueuestats
+//
+static int32_t osdcmd_renderqueuestats(const osdfuncparm_t *parm)
+{
+	UNREFERENCED_PARAMETER(parm);
+
+	renderer.PrintQueueStats();
+
+	return OSDCMD_OK;
 }
 
 Renderer::Renderer()
 {
-	currentFrame = 0;
-	memset(&numRenderCommands, 0, sizeof(int) * MAX_SMP_FRAMES);
-	num2DRenderCommands = 0;
-	currentRenderCommand = NULL;
-	currentNumRenderCommand = 0;
+	for (int i = 0; i < MAX_SMP_FRAMES; i++)
+	{
+		frames[i].commands.resize(MAX_RENDER_COMMANDS);
+		frames[i].numCommands = 0;
+		memset(&frames[i].nextPageParams, 0, sizeof(SceneNextPageParms));
+	}
+
+	submittedFrames.store(0);
+	completedFrames.store(0);
+	renderThreadWaiting.store(false);
+	gameThreadWaiting.store(false);
+	memset(&stats, 0, sizeof(stats));
+
+	_2dcommands.reserve(MAX_RENDER_COMMANDS);
+
+	gameFrame = 0;
+	renderFrame = 0;
 	vlsShadowLightMap = NULL;
 	vlsLight = NULL;
 }
 
 void Renderer::Init()
 {
+#ifdef BUILD3D_PACKED_VERTEX
+	rhi.SetWorldVertexLayout(WORLD_VERTEX_LAYOUT_PACKED);
+#else
+	rhi.SetWorldVertexLayout(WORLD_VERTEX_LAYOUT_FULL);
+#endif
+
 	// Load in all of our shaders.
 	ui_texture_basic						= PolymerNGRenderProgram::LoadRenderProgram("guishader", true);
 	ui_texture_hq_basic						= PolymerNGRenderProgram::LoadRenderProgram("guishaderHighQuality", true);
@@ -83,6 +120,8 @@ void Renderer::Init()
 	InitShadowMaps();
 
 	gpuPerfCounter = BuildRHI::AllocatePerformanceCounter();
+
+	OSD_RegisterFunction("r_renderqueuestats", "r_renderqueuestats: prints the game to render thread frame queue stats", osdcmd_renderqueuestats);
 }
 
 void Renderer::SetShaderForPSO(BuildRHIPipelineStateObject *pso, PolymerNGRenderProgram *program)
@@ -90,33 +129,145 @@ void Renderer::SetShaderForPSO(BuildRHIPipelineStateObject *pso, PolymerNGRender
 
 }
 
+//
+// Renderer::GrowFrame
+//
+void Renderer::GrowFrame(RendererFrame &frame)
+{
+	// Only the game thread touches the frame it is building, so growing it can't race the render thread.
+	frame.commands.resize(frame.commands.size() * 2);
+	stats.frameGrows++;
+}
+
+//
+// Renderer::SubmitFrame
+//
 void Renderer::SubmitFrame(SceneNextPageParms nextpageParams)
 {
 	currentGameSubmitTime = GetCurrentTimeInMilliseconds();
 
 	gameExecTimeInMilliseconds = currentGameSubmitTime - startTimeForGameFrame;
 
-	while (HasWork())
-		Sleep(0);
+	RendererFrame &frame = frames[gameFrame];
+
+	// Nothing to draw, keep building into the same frame.
+	if (frame.numCommands == 0)
+	{
+		stats.emptyFrames++;
+		startTimeForGameFrame = GetCurrentTimeInMilliseconds();
+		return;
+	}
+
+	if (frame.numCommands > stats.maxCommandsPerFrame)
+		stats.maxCommandsPerFrame = frame.numCommands;
+
+	frame.nextPageParams = nextpageParams;
 
-	currentNextPageParam = nextpageParams;
-	currentRenderCommand = commands[currentFrame];
-	currentFrame = !currentFrame;
-	currentNumRenderCommand = numRenderCommands[!currentFrame];
-	numRenderCommands[!currentFrame] = 0;
+	// Sequentially consistent so the waiting flag checks below can't miss a thread going to sleep.
+	uint32_t submitted = submittedFrames.load(std::memory_order_relaxed) + 1;
+	submittedFrames.store(submitted);
+	stats.framesSubmitted++;
+
+	if (renderThreadWaiting.load())
+	{
+		{
+			std::lock_guard<std::mutex> lock(frameLock);
+		}
+		frameQueuedCondition.notify_one();
+	}
+
+	// The next slot is free as long as the render thread is less than MAX_SMP_FRAMES frames behind.
+	int queueDepth = (int)(submitted - completedFrames.load());
+	stats.queueDepthTotal += queueDepth;
+	if (queueDepth > stats.maxQueueDepth)
+		stats.maxQueueDepth = queueDepth;
+
+	if (queueDepth >= MAX_SMP_FRAMES)
+	{
+		double stallStartTime = gethiticks();
+
+		std::unique_lock<std::mutex> lock(frameLock);
+		gameThreadWaiting.store(true);
+		frameCompletedCondition.wait(lock, [this, submitted] { return (int)(submitted - completedFrames.load()) < MAX_SMP_FRAMES; });
+		gameThreadWaiting.store(false);
+
+		stats.stalls++;
+		stats.stallTimeMs += gethiticks() - stallStartTime;
+	}
+
+	gameFrame = submitted % MAX_SMP_FRAMES;
+	frames[gameFrame].numCommands = 0;
 
 	startTimeForGameFrame = GetCurrentTimeInMilliseconds();
 }
 
+//
+// Renderer::HasWork
+//
 bool Renderer::HasWork()
 {
-	return currentRenderCommand != NULL && currentNumRenderCommand > 0; // numRenderCommands[currentFrame] != 0;
+	return submittedFrames.load() != completedFrames.load(std::memory_order_relaxed);
+}
+
+//
+// Renderer::WaitForWork
+//
+bool Renderer::WaitForWork(int timeoutMs)
+{
+	if (HasWork())
+		return true;
+
+	std::unique_lock<std::mutex> lock(frameLock);
+	renderThreadWaiting.store(true);
+	bool hasWork = frameQueuedCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return HasWork(); });
+	renderThreadWaiting.store(false);
+
+	return hasWork;
+}
+
+//
+// Renderer::ReleaseRenderFrame
+//
+void Renderer::ReleaseRenderFrame()
+{
+	completedFrames.store(completedFrames.load(std::memory_order_relaxed) + 1);
+	stats.framesRendered++;
+
+	if (gameThreadWaiting.load())
+	{
+		{
+			std::lock_guard<std::mutex> lock(frameLock);
+		}
+		frameCompletedCondition.notify_one();
+	}
+}
+
+//
+// Renderer::PrintQueueStats
+//
+void Renderer::PrintQueueStats()
+{
+	initprintf("-------- Renderer::PrintQueueStats ---------\n");
+	initprintf("Frames submitted: %llu rendered: %llu empty: %llu\n", stats.framesSubmitted, stats.framesRendered, stats.emptyFrames);
+	initprintf("Queue depth avg: %.2f max: %d of %d\n", stats.framesSubmitted ? (double)stats.queueDepthTotal / stats.framesSubmitted : 0.0, stats.maxQueueDepth, MAX_SMP_FRAMES);
+	initprintf("Game thread stalls: %llu (%.2fms)\n", stats.stalls, stats.stallTimeMs);
+	initprintf("Max commands per frame: %d, frame grows: %llu, dropped commands: 0\n", stats.maxCommandsPerFrame, stats.frameGrows);
 }
 
 void Renderer::RenderFrame()
 {
+	BUILD_PROFILE_SCOPE("Renderer::RenderFrame");
+
+	renderFrame = completedFrames.load(std::memory_order_relaxed) % MAX_SMP_FRAMES;
+
+	RendererFrame &frame = frames[renderFrame];
+	BuildRenderCommand *currentRenderCommand = &frame.commands[0];
+	int currentNumRenderCommand = frame.numCommands;
+
 	bool shouldClear = true;
+	rhi.BeginPass("UploadImages");
 	polymerNG.UploadPendingImages();
+	rhi.EndPass();
 
 	std::vector<BuildRenderCommand> lightDrawCommands;
 	BuildRenderCommand *drawWorldCommand = NULL;
@@ -132,7 +283,9 @@ void Renderer::RenderFrame()
 
 		if (command.taskId == BUILDRENDER_TASK_DRAWCLASSICSCREEN)
 		{
+			rhi.BeginPass("ClassicFS");
 			classicFSPass.Draw(command);
+			rhi.EndPass();
 		}
 		else if (command.taskId == BUILDRENDER_TASK_ROTATESPRITE && command.taskRotateSprite.is2D)
 		{
@@ -145,7 +298,7 @@ void Renderer::RenderFrame()
 
 			if (!GetNextPageParms().shouldSkipUI)
 			{
-				_2dcommands[num2DRenderCommands++] = &command;
+				_2dcommands.push_back(&command);
 			}
 		}
 		else if (command.taskId == BUILDRENDER_TASK_CREATEMODEL)
@@ -153,12 +306,14 @@ void Renderer::RenderFrame()
 			BaseModel *model = command.taskCreateModel.model;
 			if (model->rhiVertexBufferStatic == NULL)
 			{
-				BuildRHIMesh *rhiMeshData = rhi.AllocateRHIMesh(sizeof(Build3DVertex), model->meshVertexes.size(), &model->meshVertexes[0], true);
+				rhi.BeginPass("CreateModel");
+				BuildRHIMesh *rhiMeshData = rhi.AllocateRHIMesh(sizeof(Build3DGPUVertex), model->meshVertexes.size(), &model->meshVertexes[0], true);
 				if (model->meshIndexes.size() > 0)
 				{
 					rhi.AllocateRHIMeshIndexes(rhiMeshData, model->meshIndexes.size(), &model->meshIndexes[0], false);
 				}
 				model->rhiVertexBufferStatic = rhiMeshData;
+				rhi.EndPass();
 			}
 
 			// Create the dynamic buffers.
@@ -181,13 +336,14 @@ void Renderer::RenderFrame()
 
 			if (!model)
 				continue;
-			int32_t numUpdateItems = command.taskUpdateModel.model->numUpdateQueues;
-			ModelUpdateQueuedItem *queuedItems = &command.taskUpdateModel.model->modelUpdateQueue[0];
-			for (int d = 0; d < numUpdateItems; d++)
+			// The ranges come in sorted and merged, and point into data staged on the game thread.
+			const ModelUploadRange *ranges = command.taskUpdateModel.ranges;
+			rhi.BeginPass("UpdateModel");
+			for (int d = 0; d < command.taskUpdateModel.numRanges; d++)
 			{
-				rhi.UpdateRHIMesh(model, queuedItems[d].startPosition, sizeof(Build3DVertex), queuedItems[d].numVertexes, &command.taskUpdateModel.model->meshVertexes[queuedItems[d].startPosition]);
+				rhi.UpdateRHIMesh(model, ranges[d].startVertex, sizeof(Build3DGPUVertex), ranges[d].numVertexes, (void *)&command.taskUpdateModel.vertexData[ranges[d].dataOffset]);
 			}
-			command.taskUpdateModel.model->numUpdateQueues = 0;
+			rhi.EndPass();
 		}
 		else if (command.taskId == BUILDRENDER_TASK_RENDERWORLD)
 		{
@@ -197,20 +353,24 @@ void Renderer::RenderFrame()
 			// Normal albedo pass.
 			if (shouldClear)
 			{
+				rhi.BeginPass("ClassicSky");
 				rhi.SetDepthEnable(false);
 				drawClassicSkyPass.Draw(command);
 				rhi.SetDepthEnable(true);
+				rhi.EndPass();
 			}
 			else
 			{
 				rhi.SetDepthEnable(true);
 			}
 
+			rhi.BeginPass("DrawWorld");
 			drawWorldPass.BindDrawWorldRenderTarget(true, shouldClear);
 			rhi.ToggleDeferredRenderContext(true);
 			drawWorldPass.Draw(command);
 			drawWorldCommand = &command;
 			rhi.ToggleDeferredRenderContext(false);
+			rhi.EndPass();
 
 			
 		}
@@ -218,13 +378,17 @@ void Renderer::RenderFrame()
 		{
 			if (!GetNextPageParms().shouldSkipSprites)
 			{
+				rhi.BeginPass("DrawSprites");
 				drawSpritePass.Draw(command);
+				rhi.EndPass();
 			}
 
 			if (drawWorldCommand)
 			{
+				rhi.BeginPass("DrawTrans");
 				drawWorldPass.DrawTrans(*drawWorldCommand);
 				drawWorldCommand = NULL;
+				rhi.EndPass();
 			}
 			drawWorldPass.BindDrawWorldRenderTarget(false, false);
 		}
@@ -235,17 +399,26 @@ void Renderer::RenderFrame()
 		}
 	}
 
+	rhi.BeginPass("Lighting");
 	for (int i = 0; i < lightDrawCommands.size(); i++)
 	{
 		drawLightingPass.shouldClear = (i == 0);
 		drawLightingPass.Draw(lightDrawCommands[i]);
 	}
+	rhi.EndPass();
 	
+	rhi.BeginPass("PostProcess");
 	drawPostProcessPass.Draw(currentRenderCommand[currentNumRenderCommand - 1]);
+	rhi.EndPass();
 	if (!renderer.GetNextPageParms().shouldSkipDOFAndAA)
 	{
+		rhi.BeginPass("DOF");
 		dofPass.Draw(currentRenderCommand[currentNumRenderCommand - 1]);
+		rhi.EndPass();
+
+		rhi.BeginPass("AntiAlias");
 		drawAAPass.Draw(currentRenderCommand[currentNumRenderCommand - 1]);
+		rhi.EndPass();
 	}
 	
 
@@ -260,12 +433,16 @@ void Renderer::RenderFrame()
 
 void Renderer::RenderFrame2D(class GraphicsContext& Context)
 {
-	for (int i = 0; i < num2DRenderCommands; i++)
+	rhi.BeginPass("DrawUI");
+	for (int i = 0; i < _2dcommands.size(); i++)
 	{
 		drawUIPass.Draw( *_2dcommands[i]);
 	}
+	rhi.EndPass();
+
+	_2dcommands.clear();
+	rhi.EndFrame();
 
-	num2DRenderCommands = 0;
-	currentNumRenderCommand = 0;
-	currentRenderCommand = NULL;
+	// The frame is done, hand the slot back to the game thread.
+	ReleaseRenderFrame();
 }
\ No newline at end of file
@@ -7,6 +7,9 @@
 #include "build3d.h"
 #include "../PolymerNG_local.h"
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 class BuildRHIPipelineStateObject;
 
@@ -45,15 +48,48 @@ protected:
 
 #include "Renderer_Shadows.h"
 
-#define MAX_SMP_FRAMES		2
+// Commands reserved per frame up front, frames grow past this instead of dropping commands.
 #define MAX_RENDER_COMMANDS 800
 
+// How long the render thread sleeps waiting for a frame before it goes back to pumping window messages.
+#define RENDER_IDLE_WAIT_MS	4
+
 #define VISPASS_WIDTH		274
 #define VISPASS_HEIGHT		154
 
+//
+// RendererFrame
+//
+struct RendererFrame
+{
+	std::vector<BuildRenderCommand> commands;
+	int					numCommands;
+	SceneNextPageParms	nextPageParams;
+};
+
+//
+// RendererQueueStats
+//
+struct RendererQueueStats
+{
+	uint64_t			framesSubmitted;
+	uint64_t			framesRendered;
+	uint64_t			emptyFrames;
+	uint64_t			queueDepthTotal;
+	int					maxQueueDepth;
+	uint64_t			stalls;
+	double				stallTimeMs;
+	uint64_t			frameGrows;
+	int					maxCommandsPerFrame;
+};
+
 //
 // Renderer
 //
+// The game thread builds frames and hands them to the render thread through a single producer, single consumer
+// ring of MAX_SMP_FRAMES frames. Neither side spins, the game thread only sleeps when every frame is in flight
+// and the render thread sleeps while the ring is empty.
+//
 class Renderer
 {
 public:
@@ -69,22 +105,33 @@ public:
 
 	bool		HasWork();
 
+	// Sleeps the render thread until a frame is queued or timeoutMs passes.
+	bool		WaitForWork(int timeoutMs);
+
 	void		RenderFrame2D(class GraphicsContext& Context);
 
 	void		AddRenderCommand(BuildRenderCommand &command) {
-		if (numRenderCommands[currentFrame] >= MAX_RENDER_COMMANDS)
-		{ 
-			initprintf("AddRenderCommand: MAX_RENDER_COMMANDS exceeded!!!...\n"); 
-			return;
-		} 
-		commands[currentFrame][numRenderCommands[currentFrame]++] = command;
+		RendererFrame &frame = frames[gameFrame];
+		if (frame.numCommands >= (int)frame.commands.size())
+		{
+			GrowFrame(frame);
+		}
+		frame.commands[frame.numCommands++] = command;
 	}
 
-	int			GetCurrentFrameNum() { return currentFrame; }
+	// Frame slot the game thread is building, only valid on the game thread.
+	int			GetCurrentFrameNum() { return gameFrame; }
+
+	// Frame slot the render thread is drawing, only valid on the render thread.
+	int			GetRenderFrameNum() { return renderFrame; }
+
+	const RendererQueueStats &GetQueueStats() { return stats; }
+	void		PrintQueueStats();
 
 	BuildImage *GetPreviousFrameImage() { return drawWorldPass.GetPreviousRenderFrame(); }
 
 	PolymerNGRenderTarget  *GetWorldRenderTarget() { return drawWorldPass.GetDrawWorldRenderTarget(); }
+	RendererDrawPassDrawWorld *GetDrawWorldPass() { return &drawWorldPass; }
 	PolymerNGRenderTarget  *GetHDRLightingRenderTarget() { return drawLightingPass.GetHDRLightingBuffer(); }
 	PolymerNGRenderTarget  *GetPostProcessRenderTarget() { return drawPostProcessPass.GetPostProcessRenderTarget(); }
 	PolymerNGRenderTarget  *GetDOFRenderTarget() { return dofPass.GetDOFRenderTarget(); }
@@ -120,11 +167,11 @@ public:
 
 // Shadow code Begin
 public:
-	ShadowMap *RenderShadowsForLight(PolymerNGLightLocal *light, int shadowId);
+	ShadowMap *RenderShadowsForLight(PolymerNGLightLocal *light);
 
 	BuildImage *GetWorldDepthBuffer() { return drawWorldPass.GetWorldDepthImage(); }
 
-	SceneNextPageParms GetNextPageParms() { return currentNextPageParam; }
+	SceneNextPageParms GetNextPageParms() { return frames[renderFrame].nextPageParams; }
 
 	float4x4 pointLightShadowFaceMatrix[6];
 public:
@@ -141,12 +188,26 @@ private:
 	VS_SHADOW_POINT_CONSTANT_BUFFER drawShadowPointLightBuffer;
 	BuildRHIConstantBuffer		*drawShadowPointLightConstantBuffer;
 private:
-	int numRenderCommands[MAX_SMP_FRAMES];
-	BuildRenderCommand	commands[MAX_SMP_FRAMES][MAX_RENDER_COMMANDS];
-	SceneNextPageParms  currentNextPageParam;
+	void		GrowFrame(RendererFrame &frame);
+	void		ReleaseRenderFrame();
 
-	int num2DRenderCommands;
-	BuildRenderCommand *_2dcommands[MAX_RENDER_COMMANDS];
+	RendererFrame		frames[MAX_SMP_FRAMES];
+
+	// Monotonic frame counters, the ring slot is the counter modulo MAX_SMP_FRAMES. submittedFrames is only written
+	// by the game thread and completedFrames only by the render thread.
+	std::atomic<uint32_t> submittedFrames;
+	std::atomic<uint32_t> completedFrames;
+
+	// Only taken when one of the threads has to sleep.
+	std::mutex			frameLock;
+	std::condition_variable frameQueuedCondition;
+	std::condition_variable frameCompletedCondition;
+	std::atomic<bool>	renderThreadWaiting;
+	std::atomic<bool>	gameThreadWaiting;
+
+	RendererQueueStats	stats;
+
+	std::vector<BuildRenderCommand *> _2dcommands;
 
 	RendererDrawPassAA drawAAPass;
 	RendererDrawPassDrawUI drawUIPass;
@@ -161,10 +222,8 @@ private:
 
 	BuildRHIGPUPerformanceCounter *gpuPerfCounter;
 	
-	int			currentFrame;
-
-	BuildRenderCommand *currentRenderCommand;
-	int currentNumRenderCommand;
+	int			gameFrame;
+	int			renderFrame;
 
 	ShadowMap	shadowMaps[NUM_QUEUED_SHADOW_MAPS];
 };
@@ -24,7 +24,7 @@ void RendererDrawPassDrawClassicScreenFS::Init()
 	classScreenImageFS = new BuildImage(opts);
 	classScreenImageFS->UpdateImagePost(NULL);
 
-	gpuScreenBuffer = new byte[globalWindowWidth * globalWindowHeight * 4];
+	gpuScreenBuffer = new byte[(int)(globalWindowWidth * globalWindowHeight) * 4];
 }
 
 /*
@@ -26,7 +26,7 @@ void RendererDrawPassDrawClassicSky::Init()
 	artskydata[12] = 0.0f;          artskydata[13] = -1.0f;         // 6
 	artskydata[14] = -halfsqrt2;    artskydata[15] = -halfsqrt2;    // 7
 
-	classicSkyRHIMesh = rhi.AllocateRHIMesh(sizeof(Build3DVertex), numClassicSkyPlanes * 4, NULL, true);
+	classicSkyRHIMesh = rhi.AllocateRHIMesh(sizeof(Build3DGPUVertex), numClassicSkyPlanes * 4, NULL, true);
 
 	classicSkyConstantBuffer = rhi.AllocateRHIConstantBuffer(sizeof(VS_DRAWCLASSICSKY_BUFFER), &drawClassicSkyBuffer);
 }
@@ -52,7 +52,10 @@ void RendererDrawPassDrawClassicSky::Draw(const BuildRenderCommand &command)
 		classicSkyVertexes[(i * 4) + 3].SetVertex(Build3DVector4(artskydata[(p2 * 2) + 1], height, artskydata[p2 * 2], 1.0f), Build3DVector4(1.0f, 0.0f, 0.0f, 0.0f));
 	}
 
-	rhi.UpdateRHIMesh(classicSkyRHIMesh, 0, sizeof(Build3DVertex), numClassicSkyPlanes * 4, classicSkyVertexes);
+	Build3DGPUVertex classicSkyGPUVertexes[8 * 4];
+	Build3D_PackVertexes(classicSkyVertexes, classicSkyGPUVertexes, numClassicSkyPlanes * 4, -1);
+
+	rhi.UpdateRHIMesh(classicSkyRHIMesh, 0, sizeof(Build3DGPUVertex), numClassicSkyPlanes * 4, classicSkyGPUVertexes);
 
 	PolymerNGMaterial *material = static_cast<PolymerNGMaterial *>(command.taskRenderWorld.skyMaterialHandle);
 	if (material == NULL)
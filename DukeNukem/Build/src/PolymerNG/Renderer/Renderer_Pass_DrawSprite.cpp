@@ -25,10 +25,13 @@ void RendererDrawPassDrawSprite::Init()
 	spriteVertexes[6].SetVertex(Build3DVector4(0.5f, 0.0f, -0.5f, 1.0f), Build3DVector4(1.0f, 1.0f, 0.0f, 0.0f));
 	spriteVertexes[7].SetVertex(Build3DVector4(-0.5f, 0.0f, -0.5f, 1.0f), Build3DVector4(0.0f, 1.0f, 0.0f, 0.0f));
 
+	Build3DGPUVertex spriteGPUVertexes[8];
+	Build3D_PackVertexes(&spriteVertexes[0], &spriteGPUVertexes[0], 8, -1);
+
 #if !POLYMERNG_NOSYNC_SPRITES
-	spriteRHIMesh = rhi.AllocateRHIMesh(sizeof(Build3DVertex), 8, &spriteVertexes[0], false);
+	spriteRHIMesh = rhi.AllocateRHIMesh(sizeof(Build3DGPUVertex), 8, &spriteGPUVertexes[0], false);
 #else
-	spriteRHIMesh = rhi.AllocateRHIMesh(sizeof(Build3DVertex), 8, &spriteVertexes[0], true);
+	spriteRHIMesh = rhi.AllocateRHIMesh(sizeof(Build3DGPUVertex), 8, &spriteGPUVertexes[0], true);
 #endif
 
 	sprite3DPlanes[SPRITE_FACING_VERTICAL].buffer = &spriteVertexes[0];
@@ -202,11 +205,14 @@ void RendererDrawPassDrawSprite::Draw(const BuildRenderCommand &command)
 			// Calculate the normals for the sprite
 			memcpy(&spriteVertexesGPU[0], &spriteVertexes[0], sizeof(Build3DVertex) * 8);
 
+			Build3DGPUVertex uploadVertexes[4];
+
 			if (sprite->isHorizsprite)
 			{
 #if POLYMERNG_NOSYNC_SPRITES
 				CalculateTransformAndNormalsForSprite(SPRITE_FACING_HORIZONTAL, spriteModelMatrix);
-				rhi.UpdateRHIMesh(spriteRHIMesh, sprite3DPlanes[SPRITE_FACING_HORIZONTAL].vbo_offset, sizeof(Build3DVertex), sprite3DPlanes[SPRITE_FACING_HORIZONTAL].vertcount, sprite3DPlanes[SPRITE_FACING_HORIZONTAL].buffer);
+				Build3D_PackVertexes(sprite3DPlanes[SPRITE_FACING_HORIZONTAL].buffer, &uploadVertexes[0], sprite3DPlanes[SPRITE_FACING_HORIZONTAL].vertcount, -1);
+				rhi.UpdateRHIMesh(spriteRHIMesh, sprite3DPlanes[SPRITE_FACING_HORIZONTAL].vbo_offset, sizeof(Build3DGPUVertex), sprite3DPlanes[SPRITE_FACING_HORIZONTAL].vertcount, &uploadVertexes[0]);
 #endif
 				rhi.DrawIndexedQuad(shader, spriteRHIMesh, 0, sprite3DPlanes[SPRITE_FACING_HORIZONTAL].ibo_offset, sprite3DPlanes[SPRITE_FACING_HORIZONTAL].indicescount);
 			}
@@ -214,7 +220,8 @@ void RendererDrawPassDrawSprite::Draw(const BuildRenderCommand &command)
 			{
 #if POLYMERNG_NOSYNC_SPRITES
 				CalculateTransformAndNormalsForSprite(SPRITE_FACING_VERTICAL, spriteModelMatrix);
-				rhi.UpdateRHIMesh(spriteRHIMesh, sprite3DPlanes[SPRITE_FACING_VERTICAL].vbo_offset, sizeof(Build3DVertex), sprite3DPlanes[SPRITE_FACING_VERTICAL].vertcount, sprite3DPlanes[SPRITE_FACING_VERTICAL].buffer);
+				Build3D_PackVertexes(sprite3DPlanes[SPRITE_FACING_VERTICAL].buffer, &uploadVertexes[0], sprite3DPlanes[SPRITE_FACING_VERTICAL].vertcount, -1);
+				rhi.UpdateRHIMesh(spriteRHIMesh, sprite3DPlanes[SPRITE_FACING_VERTICAL].vbo_offset, sizeof(Build3DGPUVertex), sprite3DPlanes[SPRITE_FACING_VERTICAL].vertcount, &uploadVertexes[0]);
 #endif
 				rhi.DrawIndexedQuad(shader, spriteRHIMesh, 0, sprite3DPlanes[SPRITE_FACING_VERTICAL].ibo_offset, sprite3DPlanes[SPRITE_FACING_VERTICAL].indicescount);
 			}
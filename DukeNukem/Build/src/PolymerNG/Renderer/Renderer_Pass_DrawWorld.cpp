@@ -6,6 +6,111 @@
 #include "../PolymerNG_local.h"
 #include <mutex>
 
+//
+// osdcmd_worldbatching
+//
+static int32_t osdcmd_worldbatching(const osdfuncparm_t *parm)
+{
+	RendererDrawPassDrawWorld *drawWorldPass = renderer.GetDrawWorldPass();
+
+	if (parm->numparms != 1)
+	{
+		initprintf("r_worldbatching is %d\n", drawWorldPass->batchingEnabled ? 1 : 0);
+		return OSDCMD_OK;
+	}
+
+	drawWorldPass->batchingEnabled = Batol(parm->parms[0]) != 0;
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_worlddrawstats
+//
+static int32_t osdcmd_worlddrawstats(const osdfuncparm_t *parm)
+{
+	if (parm->numparms == 1 && !Bstrcasecmp(parm->parms[0], "reset"))
+	{
+		renderer.GetDrawWorldPass()->ResetStats();
+		return OSDCMD_OK;
+	}
+
+	if (parm->numparms != 0)
+		return OSDCMD_SHOWHELP;
+
+	renderer.GetDrawWorldPass()->PrintStats();
+
+	return OSDCMD_OK;
+}
+
+//
+// GetWorldProgram
+//
+static RendererWorldProgram GetWorldProgram(PolymerNGMaterial *material, const Build3DPlane *plane, bool isTransparent)
+{
+	bool isHighQuality = material->GetDiffuseTexture()->GetOpts().isHighQualityImage;
+
+	if (isTransparent)
+	{
+		return isHighQuality ? WORLD_PROGRAM_HQ_TRANSPARENT : WORLD_PROGRAM_SIMPLE_TRANSPARENT;
+	}
+
+	if (isHighQuality)
+	{
+		if (material->GetNormalMap() == NULL)
+		{
+			return G_IsGlowSprite(plane->tileNum) ? WORLD_PROGRAM_HQ_NONORMALMAP_GLOW : WORLD_PROGRAM_HQ_NONORMALMAP;
+		}
+
+		return G_IsGlowSprite(plane->tileNum) ? WORLD_PROGRAM_HQ_GLOW : WORLD_PROGRAM_HQ;
+	}
+
+	if (material->GetGlowMap() && material->GetGlowMap()->GetRHITexture() != NULL)
+	{
+		return WORLD_PROGRAM_SIMPLE_GLOWMAP;
+	}
+
+	return G_IsGlowSprite(plane->tileNum) ? WORLD_PROGRAM_SIMPLE_GLOW : WORLD_PROGRAM_SIMPLE;
+}
+
+//
+// GetWorldProgramShader
+//
+static BuildRHIShader *GetWorldProgramShader(RendererWorldProgram program)
+{
+	switch (program)
+	{
+		case WORLD_PROGRAM_SIMPLE:					return renderer.albedoSimpleProgram->GetRHIShader();
+		case WORLD_PROGRAM_SIMPLE_GLOW:				return renderer.albedoSimpleGlowProgram->GetRHIShader();
+		case WORLD_PROGRAM_SIMPLE_GLOWMAP:			return renderer.AlbedoSimpleGlowMapProgram->GetRHIShader();
+		case WORLD_PROGRAM_SIMPLE_TRANSPARENT:		return renderer.albedoSimpleTransparentProgram->GetRHIShader();
+		case WORLD_PROGRAM_HQ:						return renderer.albedoHQProgram->GetRHIShader();
+		case WORLD_PROGRAM_HQ_GLOW:					return renderer.albedoHQGlowProgram->GetRHIShader();
+		case WORLD_PROGRAM_HQ_NONORMALMAP:			return renderer.albedoHQNoNormalMapProgram->GetRHIShader();
+		case WORLD_PROGRAM_HQ_NONORMALMAP_GLOW:		return renderer.albedoHQNoNormalMapGlowProgram->GetRHIShader();
+		case WORLD_PROGRAM_HQ_TRANSPARENT:			return renderer.albedoHQTransparentProgram->GetRHIShader();
+
+		case WORLD_PROGRAM_NONE:
+		default:
+			break;
+	}
+
+	return NULL;
+}
+
+//
+// IsPlaneDrawable
+//
+static bool IsPlaneDrawable(const Build3DPlane *plane)
+{
+	PolymerNGMaterial *material = static_cast<PolymerNGMaterial *>(plane->renderMaterialHandle);
+
+	if (material == NULL)
+		return false;
+
+	return material->GetDiffuseTexture()->GetOpts().width > 1 && material->GetDiffuseTexture()->GetOpts().height > 1;
+}
+
 /*
 ========================
 RendererDrawPassDrawWorld::Init
@@ -22,6 +127,17 @@ void RendererDrawPassDrawWorld::Init()
 	BuildImage *specularGlowPropertyRenderBuffer;
 	BuildImage *glowColorBuffer;
 
+	batchingEnabled = true;
+	ResetStats();
+	ResetBoundState();
+	pendingShader = NULL;
+	pendingMesh = NULL;
+	pendingStartIndex = 0;
+	pendingNumIndexes = 0;
+
+	OSD_RegisterFunction("r_worldbatching", "r_worldbatching <0/1>: sorts the world planes by state and merges the draws that share it", osdcmd_worldbatching);
+	OSD_RegisterFunction("r_worlddrawstats", "r_worlddrawstats [reset]: prints the world draws, state changes and sort time per frame", osdcmd_worlddrawstats);
+
 	drawWorldConstantBuffer = rhi.AllocateRHIConstantBuffer(sizeof(VS_DRAWWORLD_BUFFER), &drawWorldBuffer);
 	drawWorldPixelConstantBuffer[0] = rhi.AllocateRHIConstantBuffer(sizeof(PS_CONSTANT_BUFFER), &drawWorldPixelBuffer);
 	drawWorldPixelConstantBuffer[1] = rhi.AllocateRHIConstantBuffer(sizeof(PS_CONSTANT_BUFFER), &drawWorldPixelBuffer);
@@ -157,130 +273,329 @@ void RendererDrawPassDrawWorld::Init()
 
 /*
 ========================
-RendererDrawPassDrawWorld::DrawPlane
+RendererDrawPassDrawWorld::PrintStats
 ========================
 */
-void RendererDrawPassDrawWorld::DrawPlane(BuildRHIMesh *rhiMesh, const BaseModel *model, const Build3DPlane *plane, bool isTransparent)
+void RendererDrawPassDrawWorld::PrintStats()
+{
+	if (stats.numFrames == 0)
+	{
+		initprintf("No world frames drawn yet\n");
+		return;
+	}
+
+	initprintf("World draws over %llu frames, batching is %s\n", (unsigned long long)stats.numFrames, batchingEnabled ? "on" : "off");
+	initprintf("  %.1f planes, %.1f draws, %.1f planes merged per frame\n", (double)stats.numPlanes / stats.numFrames, (double)stats.numDraws / stats.numFrames, (double)stats.numMergedPlanes / stats.numFrames);
+	initprintf("  %.1f state changes per frame\n", (double)stats.numStateChanges / stats.numFrames);
+	initprintf("  %.3fms sort per frame, %.3fms max\n", stats.sortTime / stats.numFrames, stats.maxSortTime);
+}
+
+/*
+========================
+RendererDrawPassDrawWorld::ResetStats
+========================
+*/
+void RendererDrawPassDrawWorld::ResetStats()
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+/*
+========================
+RendererDrawPassDrawWorld::BuildSortKey
+========================
+*/
+uint64_t RendererDrawPassDrawWorld::BuildSortKey(const Build3DBoard *board, const float3 &viewPosition, const Build3DPlane *plane, bool isTransparent, bool isGlow) const
 {
-	static bool useDoubleBuffer = false;
 	PolymerNGMaterial *material = static_cast<PolymerNGMaterial *>(plane->renderMaterialHandle);
+	uint64_t pass = isTransparent ? 2 : (isGlow ? 1 : 0);
+	uint64_t depth = 0;
 
-	if (material != NULL)
+	if (isTransparent && plane->boundsIndex != -1)
 	{
-		if (material->GetDiffuseTexture()->GetOpts().width <= 1 || material->GetDiffuseTexture()->GetOpts().height <= 1)
-			return;
+		const Build3DPlaneBounds &bounds = board->GetPlaneBounds();
+		int index = plane->boundsIndex;
+		float x = (bounds.minX[index] + bounds.maxX[index]) * 0.5f - viewPosition.x;
+		float y = (bounds.minY[index] + bounds.maxY[index]) * 0.5f - viewPosition.y;
+		float z = (bounds.minZ[index] + bounds.maxZ[index]) * 0.5f - viewPosition.z;
+		float distance = x * x + y * y + z * z;
+
+		// Positive floats sort the same as their bits, the top 16 are plenty to order the planes. Farthest goes first.
+		uint32_t bits;
+		memcpy(&bits, &distance, sizeof(bits));
+		depth = 0xffff - (bits >> 16);
+	}
 
-		drawWorldPixelBuffer.shadeOffsetVisibility[0] = plane->shadeNum;
-		drawWorldPixelBuffer.shadeOffsetVisibility[1] = plane->visibility;
-		drawWorldPixelBuffer.fogColor[0] = plane->fogColor[0];
-		drawWorldPixelBuffer.fogColor[1] = plane->fogColor[1];
-		drawWorldPixelBuffer.fogColor[2] = plane->fogColor[2];
+	uint64_t program = GetWorldProgram(material, plane, isTransparent);
+	uint64_t tile = plane->tileNum & 0x7fff;
+	uint64_t palette = plane->paletteNum & 0xff;
 
-		drawWorldPixelBuffer.fogDensistyScaleEnd[0] = plane->fogDensity;
-		drawWorldPixelBuffer.fogDensistyScaleEnd[1] = plane->fogStart;
-		drawWorldPixelBuffer.fogDensistyScaleEnd[2] = plane->fogEnd;
+	return (pass << 62) | (depth << 46) | (program << 42) | (tile << 27) | (palette << 19);
+}
 
-		drawWorldPixelBuffer.tangent[0] = plane->tbn[0][0];
-		drawWorldPixelBuffer.tangent[1] = plane->tbn[1][0];
-		drawWorldPixelBuffer.tangent[2] = plane->tbn[2][0];
+/*
+========================
+RendererDrawPassDrawWorld::SortDrawItems
 
-		drawWorldPixelBuffer.normal[0] = plane->tbn[0][2];
-		drawWorldPixelBuffer.normal[1] = plane->tbn[1][2];
-		drawWorldPixelBuffer.normal[2] = plane->tbn[2][2];
+LSD radix sort a byte at a time, bytes that are the same for every key get skipped. The sort is stable, so planes
+with the same key stay in the order they were added.
+========================
+*/
+void RendererDrawPassDrawWorld::SortDrawItems(std::vector<RendererWorldDrawItem> &items)
+{
+	const int numItems = items.size();
+	if (numItems < 2)
+		return;
 
-		drawWorldPixelBuffer.ambient[0] = plane->ambient[0];
-		drawWorldPixelBuffer.ambient[1] = plane->ambient[1];
-		drawWorldPixelBuffer.ambient[2] = plane->ambient[2];
+	uint64_t sameBits = ~0ull;
+	for (int i = 1; i < numItems; i++)
+	{
+		sameBits &= ~(items[i].sortKey ^ items[0].sortKey);
+	}
 
-		drawWorldPixelConstantBuffer[useDoubleBuffer]->UpdateBuffer(&drawWorldPixelBuffer, sizeof(PS_CONSTANT_BUFFER), 0);
-		rhi.SetConstantBuffer(0, drawWorldPixelConstantBuffer[useDoubleBuffer], SHADER_BIND_PIXELSHADER);
+	sortScratch.resize(numItems);
 
-		rhi.SetImageForContext(0, material->GetDiffuseTexture()->GetRHITexture());
-		rhi.SetImageForContext(1, imageManager.GetPaletteManager()->GetPaletteImage()->GetRHITexture());
-		rhi.SetImageForContext(2, imageManager.GetPaletteManager()->GetPaletteLookupImage(plane->paletteNum)->GetRHITexture());		
+	RendererWorldDrawItem *src = &items[0];
+	RendererWorldDrawItem *dst = &sortScratch[0];
 
-		BuildRHIShader *shader = NULL;
-		if (isTransparent)
-		{
-			if (material->GetDiffuseTexture()->GetOpts().isHighQualityImage)
-			{
-				shader = renderer.albedoHQTransparentProgram->GetRHIShader();
-			}
-			else
-			{
-				rhi.SetImageForContext(3, material->GetNormalMap()->GetRHITexture());
-				rhi.SetImageForContext(6, renderer.GetPreviousFrameImage()->GetRHITexture());
-				shader = renderer.albedoSimpleTransparentProgram->GetRHIShader();
-			}
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		if (((sameBits >> shift) & 0xff) == 0xff)
+			continue;
+
+		int offsets[256];
+		memset(offsets, 0, sizeof(offsets));
 
-			rhi.SetDepthWriteEnable(false);
+		for (int i = 0; i < numItems; i++)
+		{
+			offsets[(src[i].sortKey >> shift) & 0xff]++;
 		}
-		else if (material->GetDiffuseTexture()->GetOpts().isHighQualityImage)
+
+		int total = 0;
+		for (int d = 0; d < 256; d++)
 		{
-			if (material->GetNormalMap() == NULL)
-			{
-				if (G_IsGlowSprite(plane->tileNum))
-				{
-					shader = renderer.albedoHQNoNormalMapGlowProgram->GetRHIShader();
-				}
-				else
-				{
-					shader = renderer.albedoHQNoNormalMapProgram->GetRHIShader();
-				}
-			}
-			else
-			{
-				rhi.SetImageForContext(3, material->GetNormalMap()->GetRHITexture());
-
-				if (material->GetSpecularMap())
-				{
-					rhi.SetImageForContext(4, material->GetSpecularMap()->GetRHITexture());
-				}
-				else
-				{
-					rhi.SetImageForContext(4, imageManager.GetBlackImage()->GetRHITexture());
-				}
-
-				if (G_IsGlowSprite(plane->tileNum))
-				{
-					shader = renderer.albedoHQGlowProgram->GetRHIShader();
-				}
-				else
-				{
-					shader = renderer.albedoHQProgram->GetRHIShader();
-				}
-			}
+			int count = offsets[d];
+			offsets[d] = total;
+			total += count;
 		}
-		else
+
+		for (int i = 0; i < numItems; i++)
 		{
-			if (material->GetGlowMap() && material->GetGlowMap()->GetRHITexture() != NULL)
-			{
-				shader = renderer.AlbedoSimpleGlowMapProgram->GetRHIShader();
-				rhi.SetImageForContext(5, material->GetGlowMap()->GetRHITexture());
-			}
-			else if (G_IsGlowSprite(plane->tileNum))
+			dst[offsets[(src[i].sortKey >> shift) & 0xff]++] = src[i];
+		}
+
+		RendererWorldDrawItem *temp = src;
+		src = dst;
+		dst = temp;
+	}
+
+	if (src != &items[0])
+	{
+		memcpy(&items[0], src, sizeof(RendererWorldDrawItem) * numItems);
+	}
+}
+
+/*
+========================
+RendererDrawPassDrawWorld::ResetBoundState
+========================
+*/
+void RendererDrawPassDrawWorld::ResetBoundState()
+{
+	for (int i = 0; i < 7; i++)
+	{
+		boundImages[i] = NULL;
+	}
+
+	isPixelBufferBound = false;
+	isDepthWriteEnabled = true;
+}
+
+/*
+========================
+RendererDrawPassDrawWorld::SetImage
+========================
+*/
+void RendererDrawPassDrawWorld::SetImage(int slot, const BuildRHITexture *image)
+{
+	if (boundImages[slot] == image && image != NULL)
+		return;
+
+	FlushDraw();
+
+	rhi.SetImageForContext(slot, image);
+	boundImages[slot] = image;
+	stats.numStateChanges++;
+}
+
+/*
+========================
+RendererDrawPassDrawWorld::SetDepthWrite
+========================
+*/
+void RendererDrawPassDrawWorld::SetDepthWrite(bool enable)
+{
+	if (isDepthWriteEnabled == enable)
+		return;
+
+	FlushDraw();
+
+	rhi.SetDepthWriteEnable(enable);
+	isDepthWriteEnabled = enable;
+	stats.numStateChanges++;
+}
+
+/*
+========================
+RendererDrawPassDrawWorld::QueueDraw
+========================
+*/
+void RendererDrawPassDrawWorld::QueueDraw(BuildRHIShader *shader, BuildRHIMesh *rhiMesh, const Build3DPlane *plane)
+{
+	if (plane->ibo_offset == -1)
+	{
+		FlushDraw();
+
+		rhi.DrawUnoptimizedQuad(shader, rhiMesh, plane->vbo_offset, plane->vertcount);
+		stats.numDraws++;
+		return;
+	}
+
+	// Same state and the indexes pick up where the last plane stopped, so they go out as one draw.
+	if (pendingNumIndexes > 0 && pendingShader == shader && pendingMesh == rhiMesh && pendingStartIndex + pendingNumIndexes == plane->ibo_offset)
+	{
+		pendingNumIndexes += plane->indicescount;
+		stats.numMergedPlanes++;
+		return;
+	}
+
+	FlushDraw();
+
+	pendingShader = shader;
+	pendingMesh = rhiMesh;
+	pendingStartIndex = plane->ibo_offset;
+	pendingNumIndexes = plane->indicescount;
+}
+
+/*
+========================
+RendererDrawPassDrawWorld::FlushDraw
+========================
+*/
+void RendererDrawPassDrawWorld::FlushDraw()
+{
+	if (pendingNumIndexes <= 0)
+		return;
+
+	rhi.DrawIndexedQuad(pendingShader, pendingMesh, 0, pendingStartIndex, pendingNumIndexes);
+	stats.numDraws++;
+
+	pendingNumIndexes = 0;
+}
+
+/*
+========================
+RendererDrawPassDrawWorld::DrawPlane
+========================
+*/
+void RendererDrawPassDrawWorld::DrawPlane(BuildRHIMesh *rhiMesh, const BaseModel *model, const Build3DPlane *plane, bool isTransparent)
+{
+	PolymerNGMaterial *material = static_cast<PolymerNGMaterial *>(plane->renderMaterialHandle);
+
+	if (!IsPlaneDrawable(plane))
+		return;
+
+	// Without batching every plane binds all of its state and gets its own draw, like it always has.
+	if (!batchingEnabled)
+	{
+		FlushDraw();
+		ResetBoundState();
+	}
+
+	stats.numPlanes++;
+
+	memset(&drawWorldPixelBuffer, 0, sizeof(PS_CONSTANT_BUFFER));
+	drawWorldPixelBuffer.shadeOffsetVisibility[0] = plane->shadeNum;
+	drawWorldPixelBuffer.shadeOffsetVisibility[1] = plane->visibility;
+	drawWorldPixelBuffer.fogColor[0] = plane->fogColor[0];
+	drawWorldPixelBuffer.fogColor[1] = plane->fogColor[1];
+	drawWorldPixelBuffer.fogColor[2] = plane->fogColor[2];
+
+	drawWorldPixelBuffer.fogDensistyScaleEnd[0] = plane->fogDensity;
+	drawWorldPixelBuffer.fogDensistyScaleEnd[1] = plane->fogStart;
+	drawWorldPixelBuffer.fogDensistyScaleEnd[2] = plane->fogEnd;
+
+	drawWorldPixelBuffer.tangent[0] = plane->tbn[0][0];
+	drawWorldPixelBuffer.tangent[1] = plane->tbn[1][0];
+	drawWorldPixelBuffer.tangent[2] = plane->tbn[2][0];
+
+	drawWorldPixelBuffer.normal[0] = plane->tbn[0][2];
+	drawWorldPixelBuffer.normal[1] = plane->tbn[1][2];
+	drawWorldPixelBuffer.normal[2] = plane->tbn[2][2];
+
+	drawWorldPixelBuffer.ambient[0] = plane->ambient[0];
+	drawWorldPixelBuffer.ambient[1] = plane->ambient[1];
+	drawWorldPixelBuffer.ambient[2] = plane->ambient[2];
+
+	if (!isPixelBufferBound || memcmp(&boundPixelBuffer, &drawWorldPixelBuffer, sizeof(PS_CONSTANT_BUFFER)))
+	{
+		FlushDraw();
+
+		drawWorldPixelConstantBuffer[0]->UpdateBuffer(&drawWorldPixelBuffer, sizeof(PS_CONSTANT_BUFFER), 0);
+		rhi.SetConstantBuffer(0, drawWorldPixelConstantBuffer[0], SHADER_BIND_PIXELSHADER);
+
+		memcpy(&boundPixelBuffer, &drawWorldPixelBuffer, sizeof(PS_CONSTANT_BUFFER));
+		isPixelBufferBound = true;
+		stats.numStateChanges++;
+	}
+
+	SetImage(0, material->GetDiffuseTexture()->GetRHITexture());
+	SetImage(1, imageManager.GetPaletteManager()->GetPaletteImage()->GetRHITexture());
+	SetImage(2, imageManager.GetPaletteManager()->GetPaletteLookupImage(plane->paletteNum)->GetRHITexture());
+
+	RendererWorldProgram program = GetWorldProgram(material, plane, isTransparent);
+	switch (program)
+	{
+		case WORLD_PROGRAM_SIMPLE_TRANSPARENT:
+			SetImage(3, material->GetNormalMap()->GetRHITexture());
+			SetImage(6, renderer.GetPreviousFrameImage()->GetRHITexture());
+			break;
+
+		case WORLD_PROGRAM_HQ:
+		case WORLD_PROGRAM_HQ_GLOW:
+			SetImage(3, material->GetNormalMap()->GetRHITexture());
+			if (material->GetSpecularMap())
 			{
-				shader = renderer.albedoSimpleGlowProgram->GetRHIShader();
+				SetImage(4, material->GetSpecularMap()->GetRHITexture());
 			}
 			else
 			{
-				shader = renderer.albedoSimpleProgram->GetRHIShader();
+				SetImage(4, imageManager.GetBlackImage()->GetRHITexture());
 			}
-		}
+			break;
 
-		if (plane->ibo_offset != -1)
-		{
-			rhi.DrawIndexedQuad(shader, rhiMesh, 0, plane->ibo_offset, plane->indicescount);
-		}
-		else
-		{
-			rhi.DrawUnoptimizedQuad(shader, rhiMesh, plane->vbo_offset, plane->vertcount);
-		}
+		case WORLD_PROGRAM_SIMPLE_GLOWMAP:
+			SetImage(5, material->GetGlowMap()->GetRHITexture());
+			break;
 
-		if (isTransparent)
-		{
-			rhi.SetDepthWriteEnable(true);
-		}
+		default:
+			break;
+	}
+
+	SetDepthWrite(!isTransparent);
+
+	BuildRHIShader *shader = GetWorldProgramShader(program);
+	if (pendingNumIndexes > 0 && pendingShader != shader)
+	{
+		stats.numStateChanges++;
+	}
+
+	QueueDraw(shader, rhiMesh, plane);
+
+	if (!batchingEnabled)
+	{
+		FlushDraw();
+		SetDepthWrite(true);
 	}
 }
 /*
@@ -324,22 +639,34 @@ void RendererDrawPassDrawWorld::DrawTrans(const BuildRenderCommand &command)
 
 	const Build3DBoard *board = command.taskRenderWorld.board;
 
-	int currentSMPFrame = renderer.GetCurrentFrameNum();
+	// The sprites pass ran in between, so nothing we bound before can be trusted.
+	ResetBoundState();
 
-	// Render all of the glow planes
-	for (int i = 0; i < glowPlaneList.size(); i++)
+	if (batchingEnabled)
 	{
-		DrawPlane(board->GetBaseModel()->rhiVertexBufferStatic, board->GetBaseModel(), glowPlaneList[i], false);
+		double startTime = gethiticks();
+		SortDrawItems(transDrawItems);
+
+		double sortTime = gethiticks() - startTime;
+		stats.sortTime += sortTime;
+		stats.frameSortTime += sortTime;
+		if (stats.frameSortTime > stats.maxSortTime)
+		{
+			stats.maxSortTime = stats.frameSortTime;
+		}
 	}
 
-	// Render all of the transparent planes
-	for (int i = 0; i < transparentPlaneList.size(); i++)
+	// Render all of the glow planes, then all of the transparent planes back to front.
+	for (int i = 0; i < transDrawItems.size(); i++)
 	{
-		DrawPlane(board->GetBaseModel()->rhiVertexBufferStatic, board->GetBaseModel(), transparentPlaneList[i], true);
+		bool isTransparent = (transDrawItems[i].sortKey >> 62) == 2;
+		DrawPlane(board->GetBaseModel()->rhiVertexBufferStatic, board->GetBaseModel(), transDrawItems[i].plane, isTransparent);
 	}
 
-	glowPlaneList.clear();
-	transparentPlaneList.clear();
+	FlushDraw();
+	SetDepthWrite(true);
+
+	transDrawItems.clear();
 }
 
 /*
@@ -365,25 +692,54 @@ void RendererDrawPassDrawWorld::Draw(const BuildRenderCommand &command)
 
 	const Build3DBoard *board = command.taskRenderWorld.board;
 
-	int currentSMPFrame = renderer.GetCurrentFrameNum();
+	ResetBoundState();
+	stats.numFrames++;
 
-//	drawWorldPixelConstantBuffer->UpdateBuffer(&drawWorldPixelBuffer, sizeof(PS_CONSTANT_BUFFER), 0);
-//	rhi.SetConstantBuffer(0, drawWorldPixelConstantBuffer, SHADER_BIND_PIXELSHADER);
-	
-	// Render all of the static sectors.
+	double startTime = gethiticks();
+
+	// Split the planes into the passes and key them, the glow and transparent ones wait for DrawTrans.
+	opaqueDrawItems.clear();
 	for (int i = 0; i < command.taskRenderWorld.numRenderPlanes; i++)
 	{
-		if (IsTransparentTile(command.taskRenderWorld.renderplanes[i]->tileNum))
-		{
-			transparentPlaneList.push_back(command.taskRenderWorld.renderplanes[i]);
-		}
-		else if (G_IsGlowSprite(command.taskRenderWorld.renderplanes[i]->tileNum))
+		const Build3DPlane *plane = command.taskRenderWorld.renderplanes[i];
+		if (!IsPlaneDrawable(plane))
+			continue;
+
+		bool isTransparent = IsTransparentTile(plane->tileNum);
+		bool isGlow = !isTransparent && G_IsGlowSprite(plane->tileNum);
+
+		RendererWorldDrawItem item;
+		item.sortKey = BuildSortKey(board, command.taskRenderWorld.position, plane, isTransparent, isGlow);
+		item.plane = plane;
+
+		if (isTransparent || isGlow)
 		{
-			glowPlaneList.push_back(command.taskRenderWorld.renderplanes[i]);
+			transDrawItems.push_back(item);
 		}
 		else
 		{
-			DrawPlane(board->GetBaseModel()->rhiVertexBufferStatic, board->GetBaseModel(), command.taskRenderWorld.renderplanes[i], false);
+			opaqueDrawItems.push_back(item);
 		}
 	}
-}
\ No newline at end of file
+
+	if (batchingEnabled)
+	{
+		SortDrawItems(opaqueDrawItems);
+	}
+
+	double sortTime = gethiticks() - startTime;
+	stats.sortTime += sortTime;
+	stats.frameSortTime = sortTime;
+	if (sortTime > stats.maxSortTime)
+	{
+		stats.maxSortTime = sortTime;
+	}
+
+	// Render all of the static sectors.
+	for (int i = 0; i < opaqueDrawItems.size(); i++)
+	{
+		DrawPlane(board->GetBaseModel()->rhiVertexBufferStatic, board->GetBaseModel(), opaqueDrawItems[i].plane, false);
+	}
+
+	FlushDraw();
+}
@@ -21,6 +21,52 @@ struct PS_CONSTANT_BUFFER
 	float ambient[4];
 };
 
+//
+// RendererWorldProgram
+//
+enum RendererWorldProgram
+{
+	WORLD_PROGRAM_SIMPLE = 0,
+	WORLD_PROGRAM_SIMPLE_GLOW,
+	WORLD_PROGRAM_SIMPLE_GLOWMAP,
+	WORLD_PROGRAM_SIMPLE_TRANSPARENT,
+	WORLD_PROGRAM_HQ,
+	WORLD_PROGRAM_HQ_GLOW,
+	WORLD_PROGRAM_HQ_NONORMALMAP,
+	WORLD_PROGRAM_HQ_NONORMALMAP_GLOW,
+	WORLD_PROGRAM_HQ_TRANSPARENT,
+	WORLD_PROGRAM_NONE
+};
+
+//
+// RendererWorldDrawItem
+//
+// The sort key is, from the top bit down, pass(2) depth(16) program(4) tile(15) palette(8). Only the transparent
+// pass fills in depth, back to front. The opaque and glow planes keep the order FindVisibleSectors found them in
+// within a state, which is roughly front to back already and keeps neighbouring planes next to each other in the
+// index buffer so they can be merged into one draw.
+//
+struct RendererWorldDrawItem
+{
+	uint64_t				sortKey;
+	const Build3DPlane		*plane;
+};
+
+//
+// RendererWorldDrawStats
+//
+struct RendererWorldDrawStats
+{
+	uint64_t				numFrames;
+	uint64_t				numPlanes;
+	uint64_t				numDraws;
+	uint64_t				numMergedPlanes;
+	uint64_t				numStateChanges;
+	double					sortTime;
+	double					maxSortTime;		// Draw and DrawTrans of the same frame together
+	double					frameSortTime;
+};
+
 class RendererDrawPassDrawWorld : public RendererDrawPassBase
 {
 public:
@@ -42,9 +88,26 @@ public:
 	PolymerNGRenderTarget		*GetDrawWorldRenderTarget() { return renderTarget; }
 
 	BuildImage					*GetPreviousRenderFrame() { return diffuseRenderBufferPrev; }
+
+	void						PrintStats();
+	void						ResetStats();
+
+	// Sorts the planes by state and merges neighbouring draws that share it, off draws every plane in the order it was found.
+	bool						batchingEnabled;
 private:
 	void						DrawPlane(BuildRHIMesh *rhiMesh, const BaseModel *model, const Build3DPlane *plane, bool isTransparent);
 
+	uint64_t					BuildSortKey(const Build3DBoard *board, const float3 &viewPosition, const Build3DPlane *plane, bool isTransparent, bool isGlow) const;
+	void						SortDrawItems(std::vector<RendererWorldDrawItem> &items);
+
+	// These skip the RHI call if the state is already bound, anything that does change it flushes the pending draw first.
+	void						SetImage(int slot, const BuildRHITexture *image);
+	void						SetDepthWrite(bool enable);
+	void						ResetBoundState();
+
+	void						QueueDraw(BuildRHIShader *shader, BuildRHIMesh *rhiMesh, const Build3DPlane *plane);
+	void						FlushDraw();
+
 	BuildRHIConstantBuffer		*drawWorldPixelConstantBuffer[2];
 	BuildRHIConstantBuffer		*drawWorldConstantBuffer;
 	VS_DRAWWORLD_BUFFER			drawWorldBuffer;
@@ -56,6 +119,21 @@ private:
 
 	PolymerNGRenderTarget		*renderTarget;
 private:
-	std::vector<const Build3DPlane *> transparentPlaneList;
-	std::vector<const Build3DPlane *> glowPlaneList;
+	std::vector<RendererWorldDrawItem> opaqueDrawItems;
+	std::vector<RendererWorldDrawItem> transDrawItems;
+	std::vector<RendererWorldDrawItem> sortScratch;
+
+	// State currently bound on the context.
+	const BuildRHITexture		*boundImages[7];
+	PS_CONSTANT_BUFFER			boundPixelBuffer;
+	bool						isPixelBufferBound;
+	bool						isDepthWriteEnabled;
+
+	// Indexed draw that later planes can still be appended to.
+	BuildRHIShader				*pendingShader;
+	BuildRHIMesh				*pendingMesh;
+	int							pendingStartIndex;
+	int							pendingNumIndexes;
+
+	RendererWorldDrawStats		stats;
 };
\ No newline at end of file
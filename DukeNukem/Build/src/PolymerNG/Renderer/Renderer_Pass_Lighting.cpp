@@ -37,26 +37,29 @@ RendererDrawPassLighting::Draw
 void RendererDrawPassLighting::Draw(const BuildRenderCommand &command)
 {
 	PolymerNGRenderTarget *drawWorldRenderTarget = renderer.GetWorldRenderTarget();
-	ShadowMap *shadowMapPool[NUM_QUEUED_SHADOW_MAPS];
-	int numShadowedLights = 0;
+	ShadowMap *shadowMapPool[MAX_VISIBLE_LIGHTS];
 
 	renderer.vlsLight = NULL;
 	renderer.vlsShadowLightMap = NULL;
 
 	rhi.SetBlendState(BLENDSTATE_ALPHA);
 	rhi.SetFaceCulling(CULL_FACE_BACK);
+
+	shadowCache.BeginFrame();
 	
 	for (int i = 0; i < command.taskDrawLights.numLights; i++)
 	{
+		shadowMapPool[i] = NULL;
+
+		// If the shadow cache runs out of slots the light is drawn without shadows.
 		if (command.taskDrawLights.visibleLights[i]->GetOpts()->castShadows)
 		{
-			shadowMapPool[numShadowedLights] = renderer.RenderShadowsForLight(command.taskDrawLights.visibleLights[i], numShadowedLights);
-			numShadowedLights++;
+			shadowMapPool[i] = renderer.RenderShadowsForLight(command.taskDrawLights.visibleLights[i]);
 		}
 
 		if (command.taskDrawLights.visibleLights[i]->GetOpts()->enableVolumetricLight)
 		{
-			renderer.vlsShadowLightMap = shadowMapPool[numShadowedLights - 1];
+			renderer.vlsShadowLightMap = shadowMapPool[i];
 			renderer.vlsLight = command.taskDrawLights.visibleLights[i];
 		}
 	}
@@ -65,16 +68,11 @@ void RendererDrawPassLighting::Draw(const BuildRenderCommand &command)
 
 	renderTarget->Bind(0, shouldClear);
 
-	for (int i = 0, d  = 0; i < command.taskDrawLights.numLights; i++)
+	for (int i = 0; i < command.taskDrawLights.numLights; i++)
 	{
-		ShadowMap *shadowMap = NULL;
-		
-		if (command.taskDrawLights.visibleLights[i]->GetOpts()->castShadows)
-		{
-			shadowMap = shadowMapPool[d++];
-		}
+		ShadowMap *shadowMap = shadowMapPool[i];
 		
-		if (command.taskDrawLights.visibleLights[i]->GetOpts()->castShadows)
+		if (shadowMap != NULL)
 		{
 			switch (command.taskDrawLights.visibleLights[i]->GetOpts()->lightType)
 			{
@@ -106,7 +104,7 @@ void RendererDrawPassLighting::Draw(const BuildRenderCommand &command)
 		rhi.SetImageForContext(4, drawWorldRenderTarget->GetDiffuseImage(4)->GetRHITexture());
 		rhi.SetImageForContext(5, renderer.GetWorldDepthBuffer()->GetRHITexture());
 
-		if (command.taskDrawLights.visibleLights[i]->GetOpts()->castShadows)
+		if (shadowMap != NULL)
 		{
 			switch (command.taskDrawLights.visibleLights[i]->GetOpts()->lightType)
 			{
@@ -146,7 +144,11 @@ void RendererDrawPassLighting::Draw(const BuildRenderCommand &command)
 
 		drawLightingBuffer.numLightsUnkown[0] = 1;
 
+		// The vertex shader only covers the screen tiles the light was binned into.
+		drawLightingBuffer.lightScreenRect = command.taskDrawLights.lightScreenRects[i];
+
 		drawLightingConstantBuffer->UpdateBuffer(&drawLightingBuffer, sizeof(PS_DRAWLIGHTING_BUFFER), 0);
+		rhi.SetConstantBuffer(0, drawLightingConstantBuffer, SHADER_BIND_VERTEXSHADER);
 		rhi.SetConstantBuffer(0, drawLightingConstantBuffer, SHADER_BIND_PIXELSHADER);
 		rhi.DrawUnoptimized2DQuad(NULL);
 	}
@@ -27,6 +27,7 @@ struct PS_DRAWLIGHTING_BUFFER
 	float4x4 inverseViewMatrix;
 	float4 spotDir;
 	float4 spotRadius;
+	float4 lightScreenRect;
 };
 
 class RendererDrawPassLighting : public RendererDrawPassBase
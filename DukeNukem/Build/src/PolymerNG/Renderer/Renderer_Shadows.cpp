@@ -75,17 +75,21 @@ void Renderer::InitShadowMaps()
 		shadowMaps[i].shadowMapCubeMap = new PolymerNGRenderTarget(NULL, depthRenderBuffer, NULL);
 		shadowMaps[i].spotLightMap = new PolymerNGRenderTarget(NULL, depthRenderBuffer2D, NULL);
 	}
+
+	shadowCache.Init(NUM_QUEUED_SHADOW_MAPS);
 }
 
 /*
 ==================
 Renderer::RenderShadowsForLight
+
+Returns NULL if the light can't get a shadow map this frame. The shadow map is only
+re-rendered if the occluders changed since the light last rendered into its slot.
 ==================
 */
-ShadowMap *Renderer::RenderShadowsForLight(PolymerNGLightLocal *light, int shadowId)
+ShadowMap *Renderer::RenderShadowsForLight(PolymerNGLightLocal *light)
 {
-	int shadowOccluderFrame = renderer.GetCurrentFrameNum();
-	ShadowMap *shadowMap = &this->shadowMaps[shadowId];
+	int shadowOccluderFrame = renderer.GetRenderFrameNum();
 
 	int numShadowMapPasses = 6;
 
@@ -103,6 +107,16 @@ ShadowMap *Renderer::RenderShadowsForLight(PolymerNGLightLocal *light, int shado
 		return NULL;
 	}
 
+	bool needsRender;
+	uint32_t occluderVersion = light->shadowCacheEntry.frameVersion[shadowOccluderFrame];
+	int shadowId = shadowCache.AcquireShadowMap(&light->shadowCacheEntry, occluderVersion, needsRender);
+	if (shadowId == -1)
+		return NULL;
+
+	ShadowMap *shadowMap = &this->shadowMaps[shadowId];
+	if (!needsRender)
+		return shadowMap;
+
 	for (int i = 0; i < numShadowMapPasses; i++)
 	{
 		if (light->GetOpts()->lightType == POLYMERNG_LIGHTTYPE_SPOT)
@@ -219,5 +233,7 @@ ShadowMap *Renderer::RenderShadowsForLight(PolymerNGLightLocal *light, int shado
 		}
 	}
 
+	light->shadowCacheEntry.renderedVersion = occluderVersion;
+
 	return shadowMap;
 }
\ No newline at end of file
@@ -0,0 +1,185 @@
+// ShadowCache.cpp
+//
+
+#include "../PolymerNG_local.h"
+
+ShadowCache shadowCache;
+
+//
+// osdcmd_shadowcachestats
+//
+static int32_t osdcmd_shadowcachestats(const osdfuncparm_t *parm)
+{
+	if (parm->numparms == 1 && !Bstrcasecmp(parm->parms[0], "reset"))
+	{
+		shadowCache.ResetStats();
+		return OSDCMD_OK;
+	}
+
+	if (parm->numparms != 0)
+		return OSDCMD_SHOWHELP;
+
+	shadowCache.PrintStats();
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_shadowcache
+//
+static int32_t osdcmd_shadowcache(const osdfuncparm_t *parm)
+{
+	if (parm->numparms != 1)
+	{
+		initprintf("r_shadowcache is %d\n", shadowCache.IsEnabled() ? 1 : 0);
+		return OSDCMD_OK;
+	}
+
+	shadowCache.SetEnabled(Batol(parm->parms[0]) != 0);
+
+	return OSDCMD_OK;
+}
+
+/*
+=============
+ShadowCache::ShadowCache
+=============
+*/
+ShadowCache::ShadowCache()
+{
+	frameNum = 0;
+	enabled = true;
+	ResetStats();
+}
+
+/*
+=============
+ShadowCache::Init
+=============
+*/
+void ShadowCache::Init(int numSlots)
+{
+	slots.resize(numSlots);
+	for (int i = 0; i < numSlots; i++)
+	{
+		slots[i].owner = NULL;
+		slots[i].lastUsedFrame = 0;
+	}
+
+	OSD_RegisterFunction("r_shadowcache", "r_shadowcache <0/1>: reuse shadow maps and shadow caster lists across frames", osdcmd_shadowcache);
+	OSD_RegisterFunction("r_shadowcachestats", "r_shadowcachestats [reset]: prints how often the shadow cache was hit", osdcmd_shadowcachestats);
+}
+
+/*
+=============
+ShadowCache::SetEnabled
+=============
+*/
+void ShadowCache::SetEnabled(bool enabled)
+{
+	this->enabled = enabled;
+	initprintf("Shadow cache %s\n", enabled ? "enabled" : "disabled");
+}
+
+/*
+=============
+ShadowCache::BeginFrame
+=============
+*/
+void ShadowCache::BeginFrame()
+{
+	// Frame zero means the slot has never been used.
+	frameNum++;
+}
+
+/*
+=============
+ShadowCache::AcquireShadowMap
+=============
+*/
+int ShadowCache::AcquireShadowMap(ShadowCacheEntry *entry, uint32_t version, bool &needsRender)
+{
+	int slot = entry->shadowMapSlot;
+
+	// Still holding the slot from a previous frame?
+	if (slot >= 0 && slot < slots.size() && slots[slot].owner == entry)
+	{
+		slots[slot].lastUsedFrame = frameNum;
+
+		needsRender = !enabled || entry->renderedVersion != version;
+		if (needsRender)
+		{
+			stats.shadowMapRebuilds++;
+		}
+		else
+		{
+			stats.shadowMapHits++;
+		}
+		return slot;
+	}
+
+	// Take the least recently used slot, anything used this frame is still bound to a light in the lighting pass.
+	slot = -1;
+	for (int i = 0; i < slots.size(); i++)
+	{
+		if (slots[i].lastUsedFrame == frameNum)
+			continue;
+
+		if (slot == -1 || slots[i].lastUsedFrame < slots[slot].lastUsedFrame)
+		{
+			slot = i;
+		}
+	}
+
+	if (slot == -1)
+		return -1;
+
+	if (slots[slot].owner != NULL)
+	{
+		slots[slot].owner->shadowMapSlot = -1;
+		stats.shadowMapEvictions++;
+	}
+
+	slots[slot].owner = entry;
+	slots[slot].lastUsedFrame = frameNum;
+
+	entry->shadowMapSlot = slot;
+	entry->renderedVersion = 0;
+
+	stats.shadowMapMisses++;
+	needsRender = true;
+	return slot;
+}
+
+/*
+=============
+ShadowCache::PrintStats
+=============
+*/
+void ShadowCache::PrintStats()
+{
+	uint64_t occluderLookups = stats.occluderHits + stats.occluderRebuilds;
+	uint64_t shadowMapLookups = stats.shadowMapHits + stats.shadowMapMisses + stats.shadowMapRebuilds;
+
+	initprintf("Shadow cache (%s, %d slots)\n", enabled ? "enabled" : "disabled", (int)slots.size());
+	initprintf("  occluder lists: %llu reused, %llu rebuilt (%.1f%% hit), %llu sprite list changes\n", (unsigned long long)stats.occluderHits, (unsigned long long)stats.occluderRebuilds,
+		occluderLookups ? (stats.occluderHits * 100.0) / occluderLookups : 0.0, (unsigned long long)stats.spriteRebuilds);
+	initprintf("  shadow maps: %llu reused, %llu rendered into a new slot, %llu re-rendered (%.1f%% hit), %llu evictions\n", (unsigned long long)stats.shadowMapHits, (unsigned long long)stats.shadowMapMisses,
+		(unsigned long long)stats.shadowMapRebuilds, shadowMapLookups ? (stats.shadowMapHits * 100.0) / shadowMapLookups : 0.0, (unsigned long long)stats.shadowMapEvictions);
+}
+
+/*
+=============
+ShadowCache::ResetStats
+=============
+*/
+void ShadowCache::ResetStats()
+{
+	stats.occluderHits = 0;
+	stats.occluderRebuilds = 0;
+	stats.spriteRebuilds = 0;
+	stats.shadowMapHits = 0;
+	stats.shadowMapMisses = 0;
+	stats.shadowMapRebuilds = 0;
+	stats.shadowMapEvictions = 0;
+}
@@ -3,29 +3,116 @@
 
 #pragma once
 
-#define NUM_QUEUED_SHADOW_MAPS 10
+#include <atomic>
+
+class PolymerNGLightLocal;
+
+// How far outside of the light radius a sprite origin can be and still cast into the light volume.
+#define SHADOWCACHE_SPRITE_MARGIN		2048.0f
+
+//
+// ShadowCacheLightState
+//
+// The parts of the light options that the shadow matrices and occluder lists are built from.
+//
+struct ShadowCacheLightState
+{
+	int			lightType;
+	float		position[3];
+	float		range;
+	float		radius;
+	int			angle;
+	int			horiz;
+	int			faderadius;
+	int			sector;
+};
 
 //
 // ShadowCacheEntry
 //
+// Every shadow casting light owns one of these. The game thread fields decide when the occluder lists need to be
+// rebuilt, the render thread fields decide when the shadow map the light holds needs to be re-rendered.
+//
 struct ShadowCacheEntry
 {
 	ShadowCacheEntry()
 	{
-		light = NULL;
+		memset(&lightState, 0, sizeof(lightState));
+		memset(frameVersion, 0, sizeof(frameVersion));
+		isDirty = true;
+		sectorGeometryKey = 0;
+		spriteKey = 0;
+		version = 1;
+		shadowMapSlot = -1;
+		renderedVersion = 0;
 	}
 
-	PolymerNGLight *light;
-	bool isDirty;
+	// Game thread.
+	ShadowCacheLightState lightState;
+	bool		isDirty;
+	uint32_t	sectorGeometryKey;
+	uint32_t	spriteKey;
+	uint32_t	version;
+	std::vector<const Build3DPlane *> planeOccluders;
+	std::vector<int> spriteOccluders;
+
+	// Version of the occluder lists that was written into each of the SMP frames.
+	uint32_t	frameVersion[MAX_SMP_FRAMES];
+
+	// Render thread.
+	int			shadowMapSlot;
+	uint32_t	renderedVersion;
+};
+
+//
+// ShadowCacheStats
+//
+struct ShadowCacheStats
+{
+	std::atomic<uint64_t> occluderHits;
+	std::atomic<uint64_t> occluderRebuilds;
+	std::atomic<uint64_t> spriteRebuilds;
+	std::atomic<uint64_t> shadowMapHits;
+	std::atomic<uint64_t> shadowMapMisses;
+	std::atomic<uint64_t> shadowMapRebuilds;
+	std::atomic<uint64_t> shadowMapEvictions;
 };
 
 //
 // ShadowCache
 //
+// Keeps shadow maps resident across frames, a light only gets its shadow map re-rendered when its occluder lists
+// changed since the last time it was rendered into the slot it holds. Slots are handed out least recently used first.
+//
 class ShadowCache
 {
 public:
+	ShadowCache();
+
+	void		Init(int numSlots);
 
+	bool		IsEnabled() const { return enabled; }
+	void		SetEnabled(bool enabled);
+
+	// Render thread, a slot that has been acquired this frame is never evicted until the next BeginFrame.
+	void		BeginFrame();
+	int			AcquireShadowMap(ShadowCacheEntry *entry, uint32_t version, bool &needsRender);
+
+	ShadowCacheStats &GetStats() { return stats; }
+	void		PrintStats();
+	void		ResetStats();
 private:
+	struct ShadowCacheSlot
+	{
+		ShadowCacheEntry *owner;
+		uint32_t	lastUsedFrame;
+	};
+
+	std::vector<ShadowCacheSlot> slots;
+	uint32_t	frameNum;
+	volatile bool enabled;
+
+	ShadowCacheStats stats;
+};
 
-};
\ No newline at end of file
+extern ShadowCache shadowCache;
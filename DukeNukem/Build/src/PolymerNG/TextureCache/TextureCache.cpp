@@ -8,10 +8,212 @@
 
 #include "../../../../Third-Party/zlib/zlib.h"
 
+#include <thread>
+#include <algorithm>
+
+//
+// PolymerNGTextureCacheArena::PolymerNGTextureCacheArena
+//
+PolymerNGTextureCacheArena::PolymerNGTextureCacheArena()
+{
+	currentBlock = NULL;
+	currentBlockUsed = 0;
+	currentBlockSize = 0;
+}
+
+//
+// PolymerNGTextureCacheArena::Alloc
+//
+byte *PolymerNGTextureCacheArena::Alloc(int size)
+{
+	// Keep the DXT blocks 16 byte aligned.
+	size = (size + 15) & ~15;
+
+	// Big payloads get an allocation of their own, so they don't waste the end of a block.
+	if (size > TEXTURECACHE_ARENA_BLOCKSIZE / 4)
+		return new byte[size];
+
+	std::lock_guard<std::mutex> guard(lock);
+	if (currentBlock == NULL || currentBlockUsed + size > currentBlockSize)
+	{
+		currentBlock = new byte[TEXTURECACHE_ARENA_BLOCKSIZE];
+		currentBlockUsed = 0;
+		currentBlockSize = TEXTURECACHE_ARENA_BLOCKSIZE;
+	}
+
+	byte *block = currentBlock + currentBlockUsed;
+	currentBlockUsed += size;
+	return block;
+}
+
+//
+// PolymerNGTextureCacheIndex::PolymerNGTextureCacheIndex
+//
+PolymerNGTextureCacheIndex::PolymerNGTextureCacheIndex()
+{
+	slots = NULL;
+	slotMask = 0;
+}
+
+//
+// PolymerNGTextureCacheIndex::~PolymerNGTextureCacheIndex
+//
+PolymerNGTextureCacheIndex::~PolymerNGTextureCacheIndex()
+{
+	delete[] slots;
+}
+
+//
+// PolymerNGTextureCacheIndex::Init
+//
+void PolymerNGTextureCacheIndex::Init(int numEntries)
+{
+	// Keep the load factor under a half so probe chains stay short.
+	uint32_t numSlots = 16;
+	while (numSlots < (uint32_t)numEntries * 2)
+		numSlots <<= 1;
+
+	delete[] slots;
+	slots = new Slot[numSlots];
+	slotMask = numSlots - 1;
+
+	for (uint32_t i = 0; i < numSlots; i++)
+	{
+		slots[i].nameHash = 0;
+		slots[i].payloadNum = -1;
+	}
+}
+
+//
+// PolymerNGTextureCacheIndex::Insert
+//
+void PolymerNGTextureCacheIndex::Insert(uint64_t nameHash, int payloadNum)
+{
+	uint32_t slot = (uint32_t)nameHash & slotMask;
+	while (slots[slot].payloadNum != -1)
+		slot = (slot + 1) & slotMask;
+
+	slots[slot].nameHash = nameHash;
+	slots[slot].payloadNum = payloadNum;
+}
+
+//
+// PolymerNGTextureCacheIndex::Find
+//
+int PolymerNGTextureCacheIndex::Find(const char *name, const CachePayloadInfo *payloadInfo) const
+{
+	if (slots == NULL)
+		return -1;
+
+	uint64_t nameHash = TextureCache_HashName(name);
+	for (uint32_t slot = (uint32_t)nameHash & slotMask; slots[slot].payloadNum != -1; slot = (slot + 1) & slotMask)
+	{
+		if (slots[slot].nameHash == nameHash && !strcmp(payloadInfo[slots[slot].payloadNum].cacheFileName, name))
+			return slots[slot].payloadNum;
+	}
+
+	return -1;
+}
+
+//
+// osdcmd_texturecachebenchmark
+//
+// Times payload name lookups on a synthetic cache, the old linear scan against the hashed index.
+//
+static int32_t osdcmd_texturecachebenchmark(const osdfuncparm_t *parm)
+{
+	int numBenchmarkPayloads = 10000;
+	if (parm->numparms > 0)
+		numBenchmarkPayloads = max(1, Batol(parm->parms[0]));
+
+	CachePayloadInfo *benchmarkInfo = new CachePayloadInfo[numBenchmarkPayloads];
+	for (int i = 0; i < numBenchmarkPayloads; i++)
+	{
+		Bsprintf(benchmarkInfo[i].cacheFileName, "highres/textures/benchmark/%06d_tile.png", i);
+	}
+
+	// Build the index the way the build tool does, then load it the way LoadTextureCache does.
+	double startTime = gethiticks();
+	CachePayloadIndexEntry *indexEntries = new CachePayloadIndexEntry[numBenchmarkPayloads];
+	for (int i = 0; i < numBenchmarkPayloads; i++)
+	{
+		indexEntries[i].nameHash = TextureCache_HashName(benchmarkInfo[i].cacheFileName);
+		indexEntries[i].payloadNum = i;
+		indexEntries[i].reserved = 0;
+	}
+	std::sort(indexEntries, indexEntries + numBenchmarkPayloads, [](const CachePayloadIndexEntry &a, const CachePayloadIndexEntry &b) { return a.nameHash < b.nameHash; });
+	double buildTime = gethiticks() - startTime;
+
+	startTime = gethiticks();
+	PolymerNGTextureCacheIndex index;
+	index.Init(numBenchmarkPayloads);
+	for (int i = 0; i < numBenchmarkPayloads; i++)
+	{
+		index.Insert(indexEntries[i].nameHash, indexEntries[i].payloadNum);
+	}
+	double loadTime = gethiticks() - startTime;
+
+	// Every payload gets looked up once, like a DEF file that uses the whole cache.
+	int numMismatches = 0;
+	startTime = gethiticks();
+	for (int i = 0; i < numBenchmarkPayloads; i++)
+	{
+		int found = -1;
+		for (int d = 0; d < numBenchmarkPayloads; d++)
+		{
+			if (!strcmp(benchmarkInfo[d].cacheFileName, benchmarkInfo[i].cacheFileName))
+			{
+				found = d;
+				break;
+			}
+		}
+		numMismatches += (found != i);
+	}
+	double linearTime = gethiticks() - startTime;
+
+	startTime = gethiticks();
+	for (int i = 0; i < numBenchmarkPayloads; i++)
+	{
+		numMismatches += (index.Find(benchmarkInfo[i].cacheFileName, benchmarkInfo) != i);
+	}
+	double hashedTime = gethiticks() - startTime;
+
+	initprintf("--------Texture Cache Benchmark (%d payloads)--------\n", numBenchmarkPayloads);
+	initprintf("..index build %.2fms, index load %.2fms\n", buildTime, loadTime);
+	initprintf("..linear lookups %.2fms (%.0fns per lookup)\n", linearTime, linearTime * 1000000.0 / numBenchmarkPayloads);
+	initprintf("..hashed lookups %.2fms (%.0fns per lookup)\n", hashedTime, hashedTime * 1000000.0 / numBenchmarkPayloads);
+	if (numMismatches)
+		initprintf("..%d lookups returned the wrong payload!\n", numMismatches);
+
+	delete[] indexEntries;
+	delete[] benchmarkInfo;
+
+	return OSDCMD_OK;
+}
+
 PolymerNGTextureCache::PolymerNGTextureCache()
 {
+	mappedCacheFile = NULL;
+	payloadResidentData = NULL;
+	nextQueuedLoad = 0;
+	totalSizeOfHighQualityAssets = 0;
+	totalCompressedBytesRead = 0;
+	totalInflateMicroseconds = 0;
+	numPayloadsLoaded = 0;
+	levelLoadStartTime = 0;
+
 	LoadTextureCache();
-	memset(&tileCacheOverride, 0, sizeof(PolymerNGTileCacheOverride) * MAXTILES);
+	memset(&tileCacheOverride, 0, sizeof(tileCacheOverride));
+
+	OSD_RegisterFunction("r_texturecachebenchmark", "r_texturecachebenchmark [payloads]: times texture cache name lookups, defaults to 10000 payloads", osdcmd_texturecachebenchmark);
+
+	for (int i = 0; i < PAYLOAD_IMAGE_NUMTYPES; i++)
+	{
+		for (int d = 0; d < MAXTILES; d++)
+		{
+			tileState[i][d].store(TEXTURECACHE_TILE_IDLE, std::memory_order_relaxed);
+		}
+	}
 }
 
 void PolymerNGTextureCache::LoadTextureCache()
@@ -28,16 +230,72 @@ void PolymerNGTextureCache::LoadTextureCache()
 
 	// Read in the texture cache header.
 	cacheFile->Read(&header, sizeof(PayloadHeader));
+	if (memcmp(header.iden, PAYLOAD_IDEN, PAYLOAD_IDEN_LENGTH) || header.version > PAYLOAD_VERSION)
+	{
+		numPayloads = -1;
+		initprintf("Texture cache has a invalid header or is a newer version.\n");
+		isLoaded = false;
+		delete cacheFile;
+		cacheFile = NULL;
+		return;
+	}
+
 	payloadInfo = new CachePayloadInfo[header.numPayloads];
 	payloads = new PolymerNGTextureCachePayload[header.numPayloads];
 
 	numPayloads = header.numPayloads;
 
 	// Read in all the payload info.
-	cacheFile->Read(payloadInfo, header.numPayloads * sizeof(CachePayloadInfo));
+	if (header.version == 0)
+	{
+		for (int i = 0; i < numPayloads; i++)
+		{
+			CachePayloadInfoVersion0 oldInfo;
+			cacheFile->Read(&oldInfo, sizeof(CachePayloadInfoVersion0));
+
+			memcpy(payloadInfo[i].cacheFileName, oldInfo.cacheFileName, sizeof(oldInfo.cacheFileName));
+			payloadInfo[i].format = oldInfo.format;
+			payloadInfo[i].width = oldInfo.width;
+			payloadInfo[i].height = oldInfo.height;
+			payloadInfo[i].startPosition = oldInfo.startPosition;
+			payloadInfo[i].compressedPayloadLength = oldInfo.compressedPayloadLength;
+			payloadInfo[i].decompressedPayloadLength = oldInfo.decompressedPayloadLength;
+			payloadInfo[i].codec = TEXTURE_CACHE_CODEC_ZLIB;
+		}
+	}
+	else
+	{
+		cacheFile->Read(payloadInfo, header.numPayloads * sizeof(CachePayloadInfo));
+	}
+
+	payloadIndex.Init(numPayloads);
+	payloadResidentData = new PolymerNGTextureCacheResidentData[numPayloads];
+
+	// Newer caches have the name hashes precomputed, older ones we have to hash every name.
+	if (header.version >= 2)
+	{
+		CachePayloadIndexEntry *indexEntries = new CachePayloadIndexEntry[numPayloads];
+		cacheFile->Read(indexEntries, numPayloads * sizeof(CachePayloadIndexEntry));
+		for (int i = 0; i < numPayloads; i++)
+		{
+			if (indexEntries[i].payloadNum >= 0 && indexEntries[i].payloadNum < numPayloads)
+				payloadIndex.Insert(indexEntries[i].nameHash, indexEntries[i].payloadNum);
+		}
+		delete[] indexEntries;
+	}
+	else
+	{
+		for (int i = 0; i < numPayloads; i++)
+		{
+			payloadIndex.Insert(TextureCache_HashName(payloadInfo[i].cacheFileName), i);
+		}
+	}
+
+	// Map the whole cache if we can, payloads are then inflated straight out of the mapping with no reads or seeks.
+	mappedCacheFile = BuildMappedFile::OpenFile(TEXTURECACHE_FILENAME);
 
 	isLoaded = true;
-	initprintf("Texture Cache has %d payloads\n", numPayloads);
+	initprintf("Texture Cache has %d payloads%s\n", numPayloads, mappedCacheFile ? " (memory mapped)" : "");
 	// We never close the cache file!
 	//delete cacheFile;
 }
@@ -47,7 +305,15 @@ void PolymerNGTextureCache::BeginLevelLoad()
 	if (numPayloads == -1)
 		return;
 
+	// Loads queued by the last level should have been finished by EndLevelLoad.
+	jobSystem.Wait(&loadCounter);
+
+	levelLoadStartTime = gethiticks();
 	totalSizeOfHighQualityAssets = 0;
+	totalCompressedBytesRead = 0;
+	totalInflateMicroseconds = 0;
+	numPayloadsLoaded = 0;
+
 	// Free all previous loaded payloads.
 	for (int i = 0; i < numPayloads; i++)
 	{
@@ -64,102 +330,228 @@ void PolymerNGTextureCache::EndLevelLoad()
 	if (numPayloads == -1)
 		return;
 
+	// Finish whatever the workers haven't gotten to yet.
+	jobSystem.Wait(&loadCounter);
+
+	// Without workers the queued tiles are loaded on demand instead.
+	for (int i = 0; i < loadQueue.size(); i++)
+	{
+		unsigned char expected = TEXTURECACHE_TILE_QUEUED;
+		tileState[loadQueue[i].payloadImageType][loadQueue[i].tileNum].compare_exchange_strong(expected, TEXTURECACHE_TILE_IDLE);
+	}
+	loadQueue.clear();
+
+	double levelLoadTime = gethiticks() - levelLoadStartTime;
+	double inflateSeconds = totalInflateMicroseconds / 1000000.0;
+	double decompressedMegabytes = totalSizeOfHighQualityAssets / (1024.0 * 1024.0);
+
 	initprintf("--------PolymerNGTextureCache::EndLevelLoad---------\n");
-	initprintf("..%dmb of high resolution textures\n", totalSizeOfHighQualityAssets >> 20);
+	initprintf("..%dmb of high resolution textures\n", (int)(totalSizeOfHighQualityAssets >> 20));
+	initprintf("..%d payloads, %dmb read, %.1f MB/s inflate per thread\n", (int)numPayloadsLoaded, (int)(totalCompressedBytesRead >> 20), inflateSeconds > 0 ? decompressedMegabytes / inflateSeconds : 0.0);
+	initprintf("..level load took %.1fms\n", levelLoadTime);
 	initprintf("----------------------------------------------------\n");
 }
 
+void PolymerNGTextureCache::QueueTileLoad(int tileNum)
+{
+	if (numPayloads == -1 || tileNum < 0 || tileNum >= MAXTILES)
+		return;
+
+	for (int i = 0; i < PAYLOAD_IMAGE_NUMTYPES; i++)
+	{
+		if (tileCacheOverride[i][tileNum].payloadInfo == NULL)
+			continue;
+
+		// Already resident, in flight or queued by a more visible surface.
+		unsigned char expected = TEXTURECACHE_TILE_IDLE;
+		if (!tileState[i][tileNum].compare_exchange_strong(expected, TEXTURECACHE_TILE_QUEUED))
+			continue;
+
+		PolymerNGTextureCacheLoadRequest request;
+		request.tileNum = tileNum;
+		request.payloadImageType = (PolymerNGTextureCachePayloadImageType)i;
+		loadQueue.push_back(request);
+	}
+}
+
+void PolymerNGTextureCache::SubmitQueuedLoads()
+{
+	if (loadQueue.empty() || !jobSystem.IsInitialized())
+		return;
+
+	// One long running job per worker, each one pulls the next request off the queue so the
+	// most visible tiles are always started first. A tile the game thread asks for before a
+	// worker gets to it is just loaded on the game thread.
+	nextQueuedLoad = 0;
+	jobSystem.ParallelFor(jobSystem.GetNumWorkers(), 1, LoadQueuedTilesJob, this, &loadCounter);
+}
+
+void PolymerNGTextureCache::LoadQueuedTilesJob(void *data, int begin, int end)
+{
+	PolymerNGTextureCache *cache = (PolymerNGTextureCache *)data;
+	std::vector<byte> jobStagingBuffer;
+
+	while (true)
+	{
+		int requestNum = cache->nextQueuedLoad.fetch_add(1);
+		if (requestNum >= cache->loadQueue.size())
+			break;
+
+		const PolymerNGTextureCacheLoadRequest &request = cache->loadQueue[requestNum];
+		unsigned char expected = TEXTURECACHE_TILE_QUEUED;
+		if (!cache->tileState[request.payloadImageType][request.tileNum].compare_exchange_strong(expected, TEXTURECACHE_TILE_LOADING))
+			continue;
+
+		cache->LoadTile(request.tileNum, request.payloadImageType, jobStagingBuffer);
+	}
+}
+
+const PolymerNGTextureCacheResidentData *PolymerNGTextureCache::LoadTile(int tileNum, PolymerNGTextureCachePayloadImageType payloadImageType, std::vector<byte> &stagingBuffer)
+{
+	const PolymerNGTextureCacheResidentData *data = ReadDataFromTextureCache(tileCacheOverride[payloadImageType][tileNum].payloadInfo, &residentDataStorage[payloadImageType][tileNum], stagingBuffer);
+	tileState[payloadImageType][tileNum].store(data ? TEXTURECACHE_TILE_RESIDENT : TEXTURECACHE_TILE_FAILED, std::memory_order_release);
+	return data;
+}
+
 const PolymerNGTextureCacheResidentData *PolymerNGTextureCache::LoadHighqualityTextureForTile(int tileNum, PolymerNGTextureCachePayloadImageType payloadImageType)
 {
-	PolymerNGTextureCachePayload *currentPayload = tileCacheOverride[payloadImageType][tileNum].payload;
 	CachePayloadInfo *currentPayloadInfo = tileCacheOverride[payloadImageType][tileNum].payloadInfo;
 
-	if (residentDataStorage[payloadImageType][tileNum].rawImageDataBlob)
-		return &residentDataStorage[payloadImageType][tileNum];
-
-	if (tileCacheOverride[payloadImageType][tileNum].payload == NULL)
+	if (tileCacheOverride[payloadImageType][tileNum].payload == NULL || currentPayloadInfo == NULL)
 		return NULL;
 
-	if (currentPayload == NULL || currentPayloadInfo == NULL)
-		return NULL;
+	while (true)
+	{
+		unsigned char state = tileState[payloadImageType][tileNum].load(std::memory_order_acquire);
+		switch (state)
+		{
+		case TEXTURECACHE_TILE_RESIDENT:
+			return &residentDataStorage[payloadImageType][tileNum];
+
+		case TEXTURECACHE_TILE_FAILED:
+			return NULL;
 
-	return ReadDataFromTextureCache(currentPayload, currentPayloadInfo, &residentDataStorage[payloadImageType][tileNum]);
+		case TEXTURECACHE_TILE_LOADING:
+			// A worker has it, it will be done sooner then we could do it.
+			std::this_thread::yield();
+			break;
 
-	return NULL;
+		default:
+			// Idle or still waiting in the queue, take it and load it here.
+			if (tileState[payloadImageType][tileNum].compare_exchange_strong(state, TEXTURECACHE_TILE_LOADING))
+				return LoadTile(tileNum, payloadImageType, gameThreadStagingBuffer);
+			break;
+		}
+	}
 }
 
 const PolymerNGTextureCacheResidentData *PolymerNGTextureCache::LoadHighqualityTexture(const char *name)
 {
-	PolymerNGTextureCachePayload *currentPayload = NULL;
-	CachePayloadInfo *currentPayloadInfo = NULL;
-
 	if (numPayloads == -1)
 	{
-		return false;
+		return NULL;
 	}
 
-	std::size_t name_hash = name_hash = std::hash<std::string>()(name);
+	// Bail if its not in the cache.
+	int payloadNum = payloadIndex.Find(name, payloadInfo);
+	if (payloadNum == -1)
+		return NULL;
 
 	// Check to see if its already loaded.
-	for (int i = 0; i < residentDataStorageDyanmic.size(); i++)
+	if (payloadResidentData[payloadNum].rawImageDataBlob)
+		return &payloadResidentData[payloadNum];
+
+	return ReadDataFromTextureCache(&payloadInfo[payloadNum], &payloadResidentData[payloadNum], gameThreadStagingBuffer);
+}
+
+//
+// InflatePayload
+//
+static bool InflatePayload(const CachePayloadInfo *info, const byte *compressedBuffer, byte *decompressedBuffer)
+{
+	switch (info->codec)
 	{
-		if (name_hash == residentDataStorageDyanmic[i].name_hash)
-			return &residentDataStorageDyanmic[i];
+	case TEXTURE_CACHE_CODEC_ZLIB:
+		{
+			z_stream infstream;
+			infstream.zalloc = Z_NULL;
+			infstream.zfree = Z_NULL;
+			infstream.opaque = Z_NULL;
+			infstream.avail_in = (uInt)info->compressedPayloadLength;
+			infstream.next_in = (Bytef *)compressedBuffer;
+			infstream.avail_out = (uInt)info->decompressedPayloadLength;
+			infstream.next_out = (Bytef *)decompressedBuffer;
+
+			if (inflateInit(&infstream) != Z_OK)
+				return false;
+			int result = inflate(&infstream, Z_FINISH);
+			inflateEnd(&infstream);
+			return result == Z_STREAM_END;
+		}
+
+	case TEXTURE_CACHE_CODEC_LZ4:
+		return LZ4_decompress_safe((const char *)compressedBuffer, (char *)decompressedBuffer, info->compressedPayloadLength, info->decompressedPayloadLength) == info->decompressedPayloadLength;
+
+	case TEXTURE_CACHE_CODEC_STORED:
+		if (info->compressedPayloadLength != info->decompressedPayloadLength)
+			return false;
+		memcpy(decompressedBuffer, compressedBuffer, info->decompressedPayloadLength);
+		return true;
 	}
 
-	// Check to see if this texture is in the texture cache.
-	for (int i = 0; i < numPayloads; i++)
+	return false;
+}
+
+//
+// PolymerNGTextureCache::ReadDataFromTextureCache
+//
+// Safe to call from any thread, as long as no one else is loading into the same storage.
+//
+const PolymerNGTextureCacheResidentData *PolymerNGTextureCache::ReadDataFromTextureCache(CachePayloadInfo *currentPayloadInfo, PolymerNGTextureCacheResidentData *storage, std::vector<byte> &stagingBuffer)
+{
+	const byte *compressedBuffer = NULL;
+
+	if (mappedCacheFile)
 	{
-		if (!strcmp(payloadInfo[i].cacheFileName, name))
+		if (currentPayloadInfo->startPosition < 0 || currentPayloadInfo->startPosition + (int64_t)currentPayloadInfo->compressedPayloadLength > mappedCacheFile->GetLength())
 		{
-			currentPayloadInfo = &payloadInfo[i];
-			break;
+			initprintf("PolymerNGTextureCache: Payload %s is past the end of the cache\n", currentPayloadInfo->cacheFileName);
+			return NULL;
 		}
+		compressedBuffer = mappedCacheFile->GetData() + currentPayloadInfo->startPosition;
 	}
+	else
+	{
+		if (stagingBuffer.size() < currentPayloadInfo->compressedPayloadLength)
+			stagingBuffer.resize(currentPayloadInfo->compressedPayloadLength);
 
-	// Bail if its not in the cache.
-	if (currentPayloadInfo == NULL)
+		std::lock_guard<std::mutex> guard(cacheFileLock);
+		cacheFile->Seek(currentPayloadInfo->startPosition, SEEK_SET);
+		cacheFile->Read(&stagingBuffer[0], currentPayloadInfo->compressedPayloadLength);
+		compressedBuffer = &stagingBuffer[0];
+	}
+
+	double inflateStartTime = gethiticks();
+
+	byte *decompressedBuffer = arena.Alloc(currentPayloadInfo->decompressedPayloadLength);
+	if (!InflatePayload(currentPayloadInfo, compressedBuffer, decompressedBuffer))
+	{
+		initprintf("PolymerNGTextureCache: Failed to inflate payload %s\n", currentPayloadInfo->cacheFileName);
 		return NULL;
+	}
 
-	PolymerNGTextureCacheResidentData newResidentDataBlank;
-	residentDataStorageDyanmic.push_back(newResidentDataBlank);
-	
-	return ReadDataFromTextureCache(NULL, currentPayloadInfo, &residentDataStorageDyanmic[residentDataStorageDyanmic.size() - 1]);
-}
-
-const PolymerNGTextureCacheResidentData *PolymerNGTextureCache::ReadDataFromTextureCache(PolymerNGTextureCachePayload *currentPayload, CachePayloadInfo *currentPayloadInfo, PolymerNGTextureCacheResidentData *storage)
-{
-	byte *compressedBuffer = new byte[currentPayloadInfo->compressedPayloadLength];
-	byte *decompressedBuffer = new byte[currentPayloadInfo->decompressedPayloadLength];
-	cacheFile->Seek(currentPayloadInfo->startPosition, SEEK_SET);
-	cacheFile->Read(compressedBuffer, currentPayloadInfo->compressedPayloadLength);
-
-	z_stream infstream;
-	infstream.zalloc = Z_NULL;
-	infstream.zfree = Z_NULL;
-	infstream.opaque = Z_NULL;
-	// setup "b" as the input and "c" as the compressed output
-	infstream.avail_in = (uInt)(currentPayloadInfo->compressedPayloadLength); // size of input
-	infstream.next_in = (Bytef *)compressedBuffer; // input char array
-	infstream.avail_out = (uInt)currentPayloadInfo->decompressedPayloadLength; // size of output
-	infstream.next_out = (Bytef *)decompressedBuffer; // output char array
-													  // the actual DE-compression work.
-	inflateInit(&infstream);
-	inflate(&infstream, Z_NO_FLUSH);
-	inflateEnd(&infstream);
+	totalInflateMicroseconds += (int64_t)((gethiticks() - inflateStartTime) * 1000.0);
 
 	//BuildImage *image = polymerNG.AllocHighresImage(tileNum, currentPayloadInfo->width, currentPayloadInfo->height, decompressedBuffer);
 	storage->width = currentPayloadInfo->width;
 	storage->height = currentPayloadInfo->height;
 	storage->format = currentPayloadInfo->format;
 	storage->rawImageDataBlob = decompressedBuffer;
-	std::string name = currentPayloadInfo->cacheFileName;
-	storage->name_hash = std::hash<std::string>()(name);
-	delete compressedBuffer;
-	//delete decompressedBuffer;
+	storage->name_hash = (std::size_t)TextureCache_HashName(currentPayloadInfo->cacheFileName);
 
-	//	currentPayload->payloadbuffer = NULL;
-	totalSizeOfHighQualityAssets += payloadInfo->decompressedPayloadLength;
+	totalSizeOfHighQualityAssets += currentPayloadInfo->decompressedPayloadLength;
+	totalCompressedBytesRead += currentPayloadInfo->compressedPayloadLength;
+	numPayloadsLoaded++;
 
 	return storage;
 }
@@ -174,14 +566,11 @@ bool PolymerNGTextureCache::SetHighQualityTextureForTile(const char *fileName, i
 		return false;
 	}
 
-	for (int i = 0; i < numPayloads; i++)
+	int payloadNum = payloadIndex.Find(fileName, payloadInfo);
+	if (payloadNum != -1)
 	{
-		if (!strcmp(payloadInfo[i].cacheFileName, fileName))
-		{
-			currentPayloadInfo = &payloadInfo[i];
-			currentPayload = &payloads[i];
-			break;
-		}
+		currentPayloadInfo = &payloadInfo[payloadNum];
+		currentPayload = &payloads[payloadNum];
 	}
 
 	if (currentPayloadInfo == NULL || currentPayload == NULL)
@@ -3,7 +3,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 #include "TextureCacheFormat.h"
+#include "../../Threading/jobsystem.h"
 
 #ifdef SWGAME
 #define TEXTURECACHE_FILENAME "Assets\\SWData\\game_textures.payloads"
@@ -11,7 +16,10 @@
 #define TEXTURECACHE_FILENAME "Assets\\DukeData\\game_textures.payloads"
 #endif
 
+#define TEXTURECACHE_ARENA_BLOCKSIZE		(32 << 20)
+
 class BuildFile;
+class BuildMappedFile;
 
 //
 // PolymerNGTextureCachePayloadImageType
@@ -66,6 +74,72 @@ struct PolymerNGTextureCacheResidentData
 	std::size_t name_hash;
 };
 
+//
+// PolymerNGTextureCacheTileState
+//
+enum PolymerNGTextureCacheTileState
+{
+	TEXTURECACHE_TILE_IDLE = 0,
+	TEXTURECACHE_TILE_QUEUED,
+	TEXTURECACHE_TILE_LOADING,
+	TEXTURECACHE_TILE_RESIDENT,
+	TEXTURECACHE_TILE_FAILED
+};
+
+//
+// PolymerNGTextureCacheLoadRequest
+//
+struct PolymerNGTextureCacheLoadRequest
+{
+	int tileNum;
+	PolymerNGTextureCachePayloadImageType payloadImageType;
+};
+
+//
+// PolymerNGTextureCacheArena
+//
+// Inflated payloads are carved out of large blocks, resident data is never freed so there is no free.
+//
+class PolymerNGTextureCacheArena
+{
+public:
+	PolymerNGTextureCacheArena();
+
+	byte *Alloc(int size);
+private:
+	std::mutex lock;
+	byte *currentBlock;
+	int currentBlockUsed;
+	int currentBlockSize;
+};
+
+//
+// PolymerNGTextureCacheIndex
+//
+// Open addressed name hash to payload map, collisions are resolved by comparing the payload names.
+//
+class PolymerNGTextureCacheIndex
+{
+public:
+	PolymerNGTextureCacheIndex();
+	~PolymerNGTextureCacheIndex();
+
+	void Init(int numEntries);
+	void Insert(uint64_t nameHash, int payloadNum);
+
+	// Returns the payload number for name, or -1 if it isn't in the cache.
+	int Find(const char *name, const CachePayloadInfo *payloadInfo) const;
+private:
+	struct Slot
+	{
+		uint64_t nameHash;
+		int payloadNum;
+	};
+
+	Slot *slots;
+	uint32_t slotMask;
+};
+
 //
 // PolymerNGTextureCache
 //
@@ -79,24 +153,48 @@ public:
 
 	bool IsLoaded() { return isLoaded; }
 
+	// Queues all the payloads for a tile, loads are started in queue order so queue the most visible tiles first.
+	void QueueTileLoad(int tileNum);
+
+	// Kicks off the queued loads on the job system, the loads are finished by EndLevelLoad.
+	void SubmitQueuedLoads();
+
 	const PolymerNGTextureCacheResidentData *LoadHighqualityTextureForTile(int tileNum, PolymerNGTextureCachePayloadImageType payloadImageType);
 	const PolymerNGTextureCacheResidentData *LoadHighqualityTexture(const char *name);
 	bool SetHighQualityTextureForTile(const char *fileName, int tileNum, PolymerNGTextureCachePayloadImageType payloadImageType);
 private:
 	void LoadTextureCache();
 
-	const PolymerNGTextureCacheResidentData *ReadDataFromTextureCache(PolymerNGTextureCachePayload *currentPayload, CachePayloadInfo *currentPayloadInfo, PolymerNGTextureCacheResidentData *storage);
+	static void LoadQueuedTilesJob(void *data, int begin, int end);
+
+	const PolymerNGTextureCacheResidentData *LoadTile(int tileNum, PolymerNGTextureCachePayloadImageType payloadImageType, std::vector<byte> &stagingBuffer);
+	const PolymerNGTextureCacheResidentData *ReadDataFromTextureCache(CachePayloadInfo *currentPayloadInfo, PolymerNGTextureCacheResidentData *storage, std::vector<byte> &stagingBuffer);
 
 	CachePayloadInfo *payloadInfo;
 	PolymerNGTextureCachePayload *payloads;
+	PolymerNGTextureCacheIndex payloadIndex;
 	BuildFile *cacheFile;
+	BuildMappedFile *mappedCacheFile;
+	std::mutex cacheFileLock;		// Only needed when the cache isn't mapped.
+
+	PolymerNGTextureCacheArena arena;
+	std::vector<byte> gameThreadStagingBuffer;
+
+	std::vector<PolymerNGTextureCacheLoadRequest> loadQueue;
+	std::atomic<int> nextQueuedLoad;
+	BuildJobCounter loadCounter;
 
-	int totalSizeOfHighQualityAssets;
+	std::atomic<int64_t> totalSizeOfHighQualityAssets;
+	std::atomic<int64_t> totalCompressedBytesRead;
+	std::atomic<int64_t> totalInflateMicroseconds;
+	std::atomic<int> numPayloadsLoaded;
+	double levelLoadStartTime;
 	int numPayloads;
 
 	bool isLoaded;
 
 	PolymerNGTileCacheOverride tileCacheOverride[PAYLOAD_IMAGE_NUMTYPES][MAXTILES];
 	PolymerNGTextureCacheResidentData residentDataStorage[PAYLOAD_IMAGE_NUMTYPES][MAXTILES];
-	std::vector<PolymerNGTextureCacheResidentData> residentDataStorageDyanmic;
+	std::atomic<unsigned char> tileState[PAYLOAD_IMAGE_NUMTYPES][MAXTILES];
+	PolymerNGTextureCacheResidentData *payloadResidentData;	// For textures loaded by name, one per payload so pointers we hand out stay valid.
 };
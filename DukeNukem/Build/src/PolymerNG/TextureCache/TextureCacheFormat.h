@@ -4,8 +4,30 @@
 #pragma once
 
 #include <stdio.h>
+#include <stdint.h>
 
 #define PAYLOAD_IDEN "jmpayload"
+#define PAYLOAD_IDEN_LENGTH 9
+
+// Version 0 payload files are all zlib and don't have a codec in their payload info.
+// Version 2 payload files have a CachePayloadIndexEntry per payload after the payload infos, sorted by name hash.
+#define PAYLOAD_VERSION 2
+
+//
+// TextureCache_HashName
+//
+// FNV-1a, the hashes are stored in the payload file so this can never change.
+//
+inline uint64_t TextureCache_HashName(const char *name)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	while (*name)
+	{
+		hash ^= (unsigned char)*name++;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
 
 //
 // TextureCacheImageFormat
@@ -21,6 +43,30 @@ enum TextureCacheImageFormat
 	TEXTURE_CACHE_RXGB
 };
 
+//
+// TextureCacheCodec
+//
+enum TextureCacheCodec
+{
+	TEXTURE_CACHE_CODEC_ZLIB = 0,
+	TEXTURE_CACHE_CODEC_LZ4,
+	TEXTURE_CACHE_CODEC_STORED
+};
+
+//
+// CachePayloadInfoVersion0
+//
+struct CachePayloadInfoVersion0
+{
+	char cacheFileName[128];
+	TextureCacheImageFormat format;
+	int width;
+	int height;
+	int startPosition;
+	int compressedPayloadLength;
+	int decompressedPayloadLength;
+};
+
 //
 // CachePayloadInfo
 //
@@ -29,6 +75,7 @@ struct CachePayloadInfo
 	CachePayloadInfo()
 	{
 		memset(cacheFileName, 0, sizeof(cacheFileName));
+		codec = TEXTURE_CACHE_CODEC_ZLIB;
 	}
 	char cacheFileName[128];
 	TextureCacheImageFormat format;
@@ -37,6 +84,17 @@ struct CachePayloadInfo
 	int startPosition;
 	int compressedPayloadLength;
 	int decompressedPayloadLength;
+	TextureCacheCodec codec;
+};
+
+//
+// CachePayloadIndexEntry
+//
+struct CachePayloadIndexEntry
+{
+	uint64_t nameHash;
+	int payloadNum;
+	int reserved;
 };
 
 //
@@ -46,10 +104,12 @@ struct PayloadHeader
 {
 	PayloadHeader()
 	{
-		strcpy(iden, PAYLOAD_IDEN);
+		memcpy(iden, PAYLOAD_IDEN, PAYLOAD_IDEN_LENGTH);
+		version = PAYLOAD_VERSION;
 		numPayloads = 0;
 	}
-	char iden[9];
+	char iden[PAYLOAD_IDEN_LENGTH];
+	unsigned char version;		// Sits in what used to be padding, old files have the iden terminator here.
 	int numPayloads;
 };
 
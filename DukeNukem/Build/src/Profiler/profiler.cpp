@@ -0,0 +1,467 @@
+// profiler.cpp
+//
+
+#include "profiler.h"
+
+#include <thread>
+
+#include "compat.h"
+#include "osd.h"
+#include "build.h"
+#include "baselayer.h"
+
+BuildProfiler buildProfiler;
+
+// The calling thread's buffer, allocated by its first timed scope.
+static thread_local BuildProfileThread *profileThread = NULL;
+static thread_local bool profileThreadFull = false;
+static thread_local char profileThreadName[32];
+
+// Weight of the newest frame in the averages.
+#define BUILD_PROFILE_AVERAGE_WEIGHT	0.05
+
+BuildProfiler::BuildProfiler()
+{
+	numScopes.store(0);
+	numThreads.store(0);
+	active.store(false);
+	capturing.store(false);
+	level = 0;
+
+	for (int i = 0; i < BUILD_PROFILE_MAX_SCOPES; i++)
+	{
+		scopeNames[i] = NULL;
+		scopeDepth[i].store(0, std::memory_order_relaxed);
+		lastTime[i] = 0;
+		lastCalls[i] = 0;
+		averageMs[i] = 0.0;
+		averageCalls[i] = 0.0;
+	}
+
+	for (int i = 0; i < BUILD_PROFILE_MAX_THREADS; i++)
+		threads[i] = NULL;
+
+	captureFile[0] = 0;
+	captureFramesLeft = 0;
+	captureStart = captureEnd = 0;
+	lastFrameTime = 0;
+	averageFrameMs = 0.0;
+}
+
+//
+// BuildProfiler::RegisterScope
+//
+int BuildProfiler::RegisterScope(const char *name)
+{
+	std::lock_guard<std::mutex> lock(registerLock);
+	int scope = numScopes.load(std::memory_order_relaxed);
+
+	if (scope == BUILD_PROFILE_MAX_SCOPES)
+		return -1;
+
+	scopeNames[scope] = name;
+	numScopes.store(scope + 1, std::memory_order_release);
+
+	return scope;
+}
+
+//
+// BuildProfiler::GetThread
+//
+BuildProfileThread *BuildProfiler::GetThread()
+{
+	if (profileThread != NULL || profileThreadFull)
+		return profileThread;
+
+	std::lock_guard<std::mutex> lock(registerLock);
+	int index = numThreads.load(std::memory_order_relaxed);
+
+	if (index == BUILD_PROFILE_MAX_THREADS)
+	{
+		profileThreadFull = true;
+		return NULL;
+	}
+
+	BuildProfileThread *thread = new BuildProfileThread;
+
+	if (profileThreadName[0])
+		Bstrncpyz(thread->name, profileThreadName, sizeof(thread->name));
+	else
+		Bsnprintf(thread->name, sizeof(thread->name), "thread %d", index);
+
+	thread->index = index;
+	thread->depth = 0;
+	thread->head.store(0, std::memory_order_relaxed);
+	thread->writing.store(0, std::memory_order_relaxed);
+
+	for (int i = 0; i < BUILD_PROFILE_MAX_SCOPES; i++)
+	{
+		thread->scopeTime[i].store(0, std::memory_order_relaxed);
+		thread->scopeCalls[i].store(0, std::memory_order_relaxed);
+	}
+
+	threads[index] = thread;
+	numThreads.store(index + 1, std::memory_order_release);
+
+	profileThread = thread;
+	return thread;
+}
+
+//
+// BuildProfiler::SetThreadName
+//
+void BuildProfiler::SetThreadName(const char *name)
+{
+	Bstrncpyz(profileThreadName, name, sizeof(profileThreadName));
+
+	if (profileThread != NULL)
+	{
+		std::lock_guard<std::mutex> lock(registerLock);
+		Bstrncpyz(profileThread->name, name, sizeof(profileThread->name));
+	}
+}
+
+//
+// BuildProfiler::BeginScope
+//
+void BuildProfiler::BeginScope()
+{
+	BuildProfileThread *thread = GetThread();
+
+	if (thread != NULL)
+		thread->depth++;
+}
+
+//
+// BuildProfiler::EndScope
+//
+void BuildProfiler::EndScope(int scope, int64_t start)
+{
+	int64_t end = GetTime();
+	BuildProfileThread *thread = profileThread;
+
+	if (thread == NULL)
+		return;
+
+	int depth = --thread->depth;
+
+	// only this thread writes its totals, the game thread just reads them
+	thread->scopeTime[scope].store(thread->scopeTime[scope].load(std::memory_order_relaxed) + (end - start), std::memory_order_relaxed);
+	thread->scopeCalls[scope].store(thread->scopeCalls[scope].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	scopeDepth[scope].store((uint16_t)depth, std::memory_order_relaxed);
+
+	if (!capturing.load(std::memory_order_relaxed))
+		return;
+
+	// FinishCapture clears capturing and then waits for writing to drop, so once it reads the ring nothing is
+	// still going into it.
+	thread->writing.store(1);
+
+	if (capturing.load())
+	{
+		uint64_t head = thread->head.load(std::memory_order_relaxed);
+		BuildProfileEvent &event = thread->events[head & (BUILD_PROFILE_RING_SIZE - 1)];
+
+		event.start = start;
+		event.duration = end - start;
+		event.scope = (uint16_t)scope;
+		event.depth = (uint16_t)depth;
+
+		thread->head.store(head + 1, std::memory_order_release);
+	}
+
+	thread->writing.store(0, std::memory_order_release);
+}
+
+//
+// BuildProfiler::UpdateActive
+//
+void BuildProfiler::UpdateActive()
+{
+	active.store(level > 0 || capturing.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+//
+// BuildProfiler::SetLevel
+//
+void BuildProfiler::SetLevel(int newLevel)
+{
+	if (level == 0 && newLevel > 0)
+	{
+		// start the averages from the totals so far, anything timed while they were off would show as one frame
+		int n = numScopes.load(std::memory_order_acquire);
+		int nt = numThreads.load(std::memory_order_acquire);
+
+		for (int i = 0; i < n; i++)
+		{
+			lastTime[i] = 0;
+			lastCalls[i] = 0;
+
+			for (int t = 0; t < nt; t++)
+			{
+				lastTime[i] += threads[t]->scopeTime[i].load(std::memory_order_relaxed);
+				lastCalls[i] += threads[t]->scopeCalls[i].load(std::memory_order_relaxed);
+			}
+
+			averageMs[i] = averageCalls[i] = 0.0;
+		}
+
+		lastFrameTime = GetTime();
+		averageFrameMs = 0.0;
+	}
+
+	level = newLevel;
+	UpdateActive();
+}
+
+//
+// BuildProfiler::StartCapture
+//
+void BuildProfiler::StartCapture(const char *filename, int numFrames)
+{
+	if (IsCapturing())
+		FinishCapture();
+
+	Bstrncpyz(captureFile, filename, sizeof(captureFile));
+	captureFramesLeft = numFrames;
+	captureStart = GetTime();
+	capturing.store(true);
+
+	UpdateActive();
+}
+
+//
+// BuildProfiler::FinishCapture
+//
+void BuildProfiler::FinishCapture()
+{
+	if (!IsCapturing())
+		return;
+
+	capturing.store(false);
+	captureEnd = GetTime();
+	captureFramesLeft = 0;
+	UpdateActive();
+
+	int nt = numThreads.load(std::memory_order_acquire);
+
+	for (int t = 0; t < nt; t++)
+	{
+		while (threads[t]->writing.load())
+			std::this_thread::yield();
+	}
+
+	if (WriteTrace(captureFile))
+		initprintf("profile_trace: wrote %.1f ms to \"%s\"\n", (captureEnd - captureStart) / 1000000.0, captureFile);
+}
+
+//
+// BuildProfiler::WriteTrace
+//
+// Chrome trace event format, complete ("X") events in microseconds.
+//
+bool BuildProfiler::WriteTrace(const char *filename)
+{
+	FILE *fp = Bfopen(filename, "w");
+
+	if (fp == NULL)
+	{
+		initprintf("profile_trace: couldn't open \"%s\"\n", filename);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(registerLock);
+	int nt = numThreads.load(std::memory_order_acquire);
+	uint64_t dropped = 0;
+	bool first = true;
+
+	Bfprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	for (int t = 0; t < nt; t++)
+	{
+		BuildProfileThread *thread = threads[t];
+		uint64_t head = thread->head.load(std::memory_order_acquire);
+		uint64_t tail = (head > BUILD_PROFILE_RING_SIZE) ? head - BUILD_PROFILE_RING_SIZE : 0;
+
+		Bfprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n",
+			thread->index, thread->name);
+		first = false;
+
+		// the ring also holds events of earlier captures, the oldest one left shows whether this one wrapped
+		if (tail > 0 && thread->events[tail & (BUILD_PROFILE_RING_SIZE - 1)].start >= captureStart)
+			dropped++;
+
+		for (uint64_t i = tail; i < head; i++)
+		{
+			const BuildProfileEvent &event = thread->events[i & (BUILD_PROFILE_RING_SIZE - 1)];
+
+			if (event.start < captureStart || event.start > captureEnd)
+				continue;
+
+			Bfprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", scopeNames[event.scope],
+				thread->index, (event.start - captureStart) / 1000.0, event.duration / 1000.0);
+		}
+	}
+
+	Bfprintf(fp, "\n]}\n");
+	Bfclose(fp);
+
+	if (dropped)
+		initprintf("profile_trace: %d threads filled their %d event rings, their oldest events are missing\n", (int)dropped, BUILD_PROFILE_RING_SIZE);
+
+	return true;
+}
+
+//
+// BuildProfiler::EndFrame
+//
+void BuildProfiler::EndFrame()
+{
+	if (captureFramesLeft > 0 && --captureFramesLeft == 0)
+		FinishCapture();
+
+	if (level == 0)
+		return;
+
+	int64_t now = GetTime();
+	double frameMs = (now - lastFrameTime) / 1000000.0;
+	lastFrameTime = now;
+
+	averageFrameMs += (frameMs - averageFrameMs) * BUILD_PROFILE_AVERAGE_WEIGHT;
+
+	int n = numScopes.load(std::memory_order_acquire);
+	int nt = numThreads.load(std::memory_order_acquire);
+
+	for (int i = 0; i < n; i++)
+	{
+		int64_t time = 0;
+		uint32_t calls = 0;
+
+		for (int t = 0; t < nt; t++)
+		{
+			time += threads[t]->scopeTime[i].load(std::memory_order_relaxed);
+			calls += threads[t]->scopeCalls[i].load(std::memory_order_relaxed);
+		}
+
+		averageMs[i] += ((time - lastTime[i]) / 1000000.0 - averageMs[i]) * BUILD_PROFILE_AVERAGE_WEIGHT;
+		averageCalls[i] += ((double)(calls - lastCalls[i]) - averageCalls[i]) * BUILD_PROFILE_AVERAGE_WEIGHT;
+
+		lastTime[i] = time;
+		lastCalls[i] = calls;
+	}
+}
+
+//
+// BuildProfiler::PrintStats
+//
+void BuildProfiler::PrintStats()
+{
+	if (level == 0)
+	{
+		initprintf("profile is off, \"profile 1\" starts timing\n");
+		return;
+	}
+
+	int n = numScopes.load(std::memory_order_acquire);
+
+	initprintf("-------- profile, per frame averages ---------\n");
+	initprintf("Frame: %.3f ms, threads: %d\n", averageFrameMs, numThreads.load(std::memory_order_acquire));
+
+	for (int i = 0; i < n; i++)
+	{
+		int depth = min((int)scopeDepth[i].load(std::memory_order_relaxed), 8);
+
+		initprintf("%*s%-*s %8.3f ms %8.1f calls %8.2f us/call\n", depth * 2, "", 28 - depth * 2, scopeNames[i], averageMs[i],
+			averageCalls[i], averageCalls[i] > 0.0 ? averageMs[i] * 1000.0 / averageCalls[i] : 0.0);
+	}
+}
+
+//
+// BuildProfiler::DrawOverlay
+//
+void BuildProfiler::DrawOverlay(int x, int y, int color)
+{
+	char buf[128];
+
+	if (level < 2)
+		return;
+
+	int n = numScopes.load(std::memory_order_acquire);
+
+	Bsnprintf(buf, sizeof(buf), "frame %7.3f ms", averageFrameMs);
+	printext256(x, y, color, -1, buf, 1);
+	y += 8;
+
+	for (int i = 0; i < n; i++)
+	{
+		// scopes that stopped running fade out of the list
+		if (averageCalls[i] < 0.01)
+			continue;
+
+		int depth = min((int)scopeDepth[i].load(std::memory_order_relaxed), 8);
+
+		Bsnprintf(buf, sizeof(buf), "%*s%-*s %7.3f ms %7.1f", depth, "", 24 - depth, scopeNames[i], averageMs[i], averageCalls[i]);
+		printext256(x, y, color, -1, buf, 1);
+		y += 8;
+	}
+}
+
+//
+// osdcmd_profile
+//
+static int32_t osdcmd_profile(const osdfuncparm_t *parm)
+{
+	if (parm->numparms != 1)
+	{
+		OSD_Printf("profile is %d\n", buildProfiler.GetLevel());
+		return OSDCMD_SHOWHELP;
+	}
+
+	buildProfiler.SetLevel(clamp(Batol(parm->parms[0]), 0, 2));
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_profile_stats
+//
+static int32_t osdcmd_profile_stats(const osdfuncparm_t *parm)
+{
+	UNREFERENCED_PARAMETER(parm);
+
+	buildProfiler.PrintStats();
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_profile_trace
+//
+static int32_t osdcmd_profile_trace(const osdfuncparm_t *parm)
+{
+	if (parm->numparms == 0)
+	{
+		if (!buildProfiler.IsCapturing())
+			return OSDCMD_SHOWHELP;
+
+		buildProfiler.FinishCapture();
+		return OSDCMD_OK;
+	}
+
+	int numFrames = (parm->numparms > 1) ? Batol(parm->parms[1]) : BUILD_PROFILE_TRACE_FRAMES;
+
+	buildProfiler.StartCapture(parm->parms[0], max(numFrames, 1));
+	OSD_Printf("profile_trace: recording %d frames to \"%s\"\n", max(numFrames, 1), parm->parms[0]);
+
+	return OSDCMD_OK;
+}
+
+//
+// BuildProfiler::InitOSD
+//
+void BuildProfiler::InitOSD()
+{
+	OSD_RegisterFunction("profile", "profile <0/1/2>: times the profiled scopes, 1: per frame averages for profile_stats  2: and an overlay", osdcmd_profile);
+	OSD_RegisterFunction("profile_stats", "profile_stats: prints the per frame averages of the profiled scopes", osdcmd_profile_stats);
+	OSD_RegisterFunction("profile_trace", "profile_trace <file> [frames]: writes every profiled scope of the next frames as a Chrome trace, no file ends it early", osdcmd_profile_trace);
+}
@@ -0,0 +1,163 @@
+// profiler.h
+//
+// Scoped CPU timers. BUILD_PROFILE_SCOPE("name") times the rest of the enclosing block on whatever thread runs
+// it, scopes nest. Each thread records into its own ring buffer, allocated the first time the thread records
+// anything, so a timed scope costs two clock reads and a few stores with no locks and no allocation. While the
+// profiler is off a scope is a load and a branch, and building with BUILD_PROFILER defined to 0 compiles them
+// out altogether.
+//
+// The profile cvar turns on the per scope averages that profile_stats prints and the overlay draws,
+// profile_trace writes the events of the next frames as a Chrome trace for chrome://tracing or Perfetto.
+//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <stdint.h>
+
+#ifndef BUILD_PROFILER
+#define BUILD_PROFILER					1
+#endif
+
+#define BUILD_PROFILE_MAX_SCOPES		128
+#define BUILD_PROFILE_MAX_THREADS		64
+#define BUILD_PROFILE_RING_SIZE			32768	// events per thread, must be a power of two
+#define BUILD_PROFILE_TRACE_FRAMES		60		// profile_trace default
+
+//
+// BuildProfileEvent
+//
+struct BuildProfileEvent
+{
+	int64_t				start;			// ns
+	int64_t				duration;
+	uint16_t			scope;
+	uint16_t			depth;
+};
+
+//
+// BuildProfileThread
+//
+// Written only by its own thread. The totals are atomics so the game thread can sum them up every frame.
+//
+struct BuildProfileThread
+{
+	char				name[32];
+	int					index;
+	int					depth;
+
+	std::atomic<uint64_t>	head;		// events recorded, the ring keeps the last BUILD_PROFILE_RING_SIZE
+	std::atomic<int>	writing;		// set while an event goes into the ring, see BuildProfiler::FinishCapture
+	BuildProfileEvent	events[BUILD_PROFILE_RING_SIZE];
+
+	std::atomic<int64_t>	scopeTime[BUILD_PROFILE_MAX_SCOPES];
+	std::atomic<uint32_t>	scopeCalls[BUILD_PROFILE_MAX_SCOPES];
+};
+
+//
+// BuildProfiler
+//
+class BuildProfiler
+{
+public:
+	BuildProfiler();
+
+	static int64_t		GetTime() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+	// Thread safe, BUILD_PROFILE_SCOPE calls it once per scope. Scopes past BUILD_PROFILE_MAX_SCOPES get -1
+	// and aren't timed.
+	int					RegisterScope(const char *name);
+
+	bool				IsActive() const { return active.load(std::memory_order_relaxed); }
+
+	// Names the calling thread in traces and profile_stats.
+	void				SetThreadName(const char *name);
+
+	// BuildProfileTimer's slow path, only called while the profiler is active.
+	void				BeginScope();
+	void				EndScope(int scope, int64_t start);
+
+	// 0: off  1: per scope averages  2: averages and the overlay
+	void				SetLevel(int level);
+	int					GetLevel() const { return level; }
+
+	// Records every scope until numFrames frames have ended and then writes filename.
+	void				StartCapture(const char *filename, int numFrames);
+	void				FinishCapture();
+	bool				IsCapturing() const { return capturing.load(std::memory_order_relaxed); }
+
+	// Once a frame on the game thread: updates the averages and ends a capture that ran its frames.
+	void				EndFrame();
+
+	void				PrintStats();
+	void				DrawOverlay(int x, int y, int color);
+
+	void				InitOSD();
+private:
+	BuildProfileThread	*GetThread();
+	void				UpdateActive();
+	bool				WriteTrace(const char *filename);
+
+	std::mutex			registerLock;
+
+	const char			*scopeNames[BUILD_PROFILE_MAX_SCOPES];
+	std::atomic<int>	numScopes;
+	std::atomic<uint16_t> scopeDepth[BUILD_PROFILE_MAX_SCOPES];	// nesting depth of the last call, for the overlay
+
+	BuildProfileThread	*threads[BUILD_PROFILE_MAX_THREADS];
+	std::atomic<int>	numThreads;
+
+	std::atomic<bool>	active;
+	std::atomic<bool>	capturing;
+	int					level;
+
+	// capture, game thread only
+	char				captureFile[260];
+	int					captureFramesLeft;
+	int64_t				captureStart;
+	int64_t				captureEnd;
+
+	// averages, game thread only
+	int64_t				lastTime[BUILD_PROFILE_MAX_SCOPES];
+	uint32_t			lastCalls[BUILD_PROFILE_MAX_SCOPES];
+	double				averageMs[BUILD_PROFILE_MAX_SCOPES];		// per frame
+	double				averageCalls[BUILD_PROFILE_MAX_SCOPES];		// per frame
+	int64_t				lastFrameTime;
+	double				averageFrameMs;
+};
+
+extern BuildProfiler buildProfiler;
+
+//
+// BuildProfileTimer
+//
+class BuildProfileTimer
+{
+public:
+	BuildProfileTimer(int scope) : _scope(scope), _start(0) {
+		if (buildProfiler.IsActive() && scope >= 0) {
+			buildProfiler.BeginScope();
+			_start = BuildProfiler::GetTime();
+		}
+	}
+
+	~BuildProfileTimer() {
+		if (_start)
+			buildProfiler.EndScope(_scope, _start);
+	}
+private:
+	int					_scope;
+	int64_t				_start;
+};
+
+#if BUILD_PROFILER
+#define BUILD_PROFILE_CONCAT_(a, b)		a##b
+#define BUILD_PROFILE_CONCAT(a, b)		BUILD_PROFILE_CONCAT_(a, b)
+#define BUILD_PROFILE_SCOPE(name) \
+	static const int BUILD_PROFILE_CONCAT(profileScope, __LINE__) = buildProfiler.RegisterScope(name); \
+	BuildProfileTimer BUILD_PROFILE_CONCAT(profileTimer, __LINE__)(BUILD_PROFILE_CONCAT(profileScope, __LINE__))
+#else
+#define BUILD_PROFILE_SCOPE(name)
+#endif
@@ -6,6 +6,15 @@
 //#include "../../rhi/D3D12/Core/pch.h"
 //#include "../../rhi/D3D12/Core/TextureManager.h"
 //#include <d3d11.h>
+#ifdef BUILD_RHI_NULL
+// The null backend doesn't talk to a GPU, so it only needs the portable headers.
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+typedef uint64_t UINT64;
+typedef unsigned char byte;
+#else
 #include <wrl.h>
 #include <wrl/client.h>
 #include <dxgi1_2.h>
@@ -16,6 +25,7 @@
 #include <wincodec.h>
 #include <DirectXColors.h>
 #include <DirectXMath.h>
+#endif
 #include <memory>
 
 /*
@@ -25,7 +35,7 @@ RHI - render hardware interface
 
 ================================
 */
-#ifdef BUILD_D3D12
+#if defined(BUILD_D3D12) && !defined(BUILD_RHI_NULL)
 typedef DXGI_FORMAT BuildRHITextureFormat;
 #endif
 
@@ -65,6 +75,10 @@ enum BuildImageFormat
 	IMAGE_FORMAT_DXT5
 };
 
+#ifdef BUILD_RHI_NULL
+typedef BuildImageFormat BuildRHITextureFormat;
+#endif
+
 //
 // BuildShaderTarget
 //
@@ -95,6 +109,15 @@ enum BuildBlendState
 	BLENDSTATE_ADDITIVE
 };
 
+//
+// BuildRHIWorldVertexLayout
+//
+enum BuildRHIWorldVertexLayout
+{
+	WORLD_VERTEX_LAYOUT_FULL = 0,	// Build3DVertex
+	WORLD_VERTEX_LAYOUT_PACKED		// Build3DPackedVertex
+};
+
 //
 // BuildRHITexture
 //
@@ -216,7 +239,7 @@ public:
 //
 // BuildRHIUIVertex
 //
-__declspec(align(16)) struct BuildRHIUIVertex
+struct alignas(16) BuildRHIUIVertex
 {
 	float X, Y, Z, W;		
 	float U, V, U1, U2;
@@ -279,6 +302,9 @@ public:
 	// Draws a quad.
 	static void DrawUnoptimized2DQuad( BuildRHIUIVertex *vertexes);
 
+	// Picks the vertex layout the world shaders are loaded with, has to be set before any of them are.
+	static void SetWorldVertexLayout(BuildRHIWorldVertexLayout layout);
+
 	// Allocates a RHI mesh.
 	static BuildRHIMesh *AllocateRHIMesh(int vertexSize, int numVertexes, void * initialData, bool isDynamic);
 
@@ -333,6 +359,13 @@ public:
 
 	// Sets the RHI blend state.
 	static void SetBlendState(BuildBlendState blendstate);
+
+	// Marks the start and end of a render pass, passes can't be nested.
+	static void BeginPass(const char *name);
+	static void EndPass();
+
+	// Called once the renderer has finished a frame.
+	static void EndFrame();
 };
 
 extern BuildRHIInputElementDesc *ui_VertexElementDescriptor;
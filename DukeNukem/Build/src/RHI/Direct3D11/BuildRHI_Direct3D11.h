@@ -142,6 +142,8 @@ public:
 
 extern D3D11_INPUT_ELEMENT_DESC guiModelInputElementDesc[];
 extern D3D11_INPUT_ELEMENT_DESC worldModelInputElementDesc[];
+extern D3D11_INPUT_ELEMENT_DESC worldModelPackedInputElementDesc[];
+extern BuildRHIWorldVertexLayout rhiWorldVertexLayout;
 
 //
 // BuildRHICurrentRenderState
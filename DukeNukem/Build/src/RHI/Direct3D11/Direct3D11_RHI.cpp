@@ -4,6 +4,7 @@
 #include "BuildRHI_Direct3D11.h"
 
 BuildRHIDirect3D11Private rhiPrivate;
+BuildRHIWorldVertexLayout rhiWorldVertexLayout = WORLD_VERTEX_LAYOUT_FULL;
 
 void BuildRHI::Init()
 {
@@ -110,6 +111,11 @@ void BuildRHI::Init()
 	}
 }
 
+void BuildRHI::SetWorldVertexLayout(BuildRHIWorldVertexLayout layout)
+{
+	rhiWorldVertexLayout = layout;
+}
+
 BuildRHIMesh *BuildRHI::AllocateRHIMesh(int vertexSize, int numVertexes, void * initialData, bool isDynamic)
 {
 	BuildRHIDirect3DMesh *mesh = new BuildRHIDirect3DMesh();
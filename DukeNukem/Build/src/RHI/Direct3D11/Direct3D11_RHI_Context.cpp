@@ -210,4 +210,19 @@ void BuildRHI::DrawIndexedQuad(BuildRHIShader *shader, BuildRHIMesh *mesh, int s
 	//	}
 	DX::RHIGetD3DDeviceContext()->DrawIndexed(numIndexes, startIndex, startVertex);
 	//rhiPrivate.ResetContext();
-}
\ No newline at end of file
+}
+
+void BuildRHI::BeginPass(const char *name)
+{
+	// Pass markers are only used by the null RHI trace.
+}
+
+void BuildRHI::EndPass()
+{
+
+}
+
+void BuildRHI::EndFrame()
+{
+	// Present is done by the app.
+}
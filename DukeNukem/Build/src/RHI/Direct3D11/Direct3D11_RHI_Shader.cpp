@@ -71,7 +71,14 @@ bool BuildRHIDirect3D11Shader::LoadShader(BuildShaderTarget target, const char *
 			{
 				if (!FAILED(hr))
 				{
-					hr = DX::RHIGetD3DDevice()->CreateInputLayout(worldModelInputElementDesc, 3, buffer, length, &worldInputLayout);
+					if (rhiWorldVertexLayout == WORLD_VERTEX_LAYOUT_PACKED)
+					{
+						hr = DX::RHIGetD3DDevice()->CreateInputLayout(worldModelPackedInputElementDesc, 3, buffer, length, &worldInputLayout);
+					}
+					else
+					{
+						hr = DX::RHIGetD3DDevice()->CreateInputLayout(worldModelInputElementDesc, 3, buffer, length, &worldInputLayout);
+					}
 				}
 			}
 			break;
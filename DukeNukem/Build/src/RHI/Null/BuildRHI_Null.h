@@ -0,0 +1,210 @@
+// BuildRHI_Null.h
+//
+
+#pragma once
+
+#include "../BuildRHI.h"
+#include <vector>
+#include <mutex>
+#include <chrono>
+
+#ifndef BUILD_RHI_NULL
+#error "The null RHI needs BUILD_RHI_NULL defined for the whole build."
+#endif
+
+//
+// BuildRHINullTraceOp
+//
+enum BuildRHINullTraceOp
+{
+	RHITRACE_DRAW = 0,
+	RHITRACE_DRAWINDEXED,
+	RHITRACE_DRAW2D,
+	RHITRACE_ALLOCATE,
+	RHITRACE_UPDATEMESH,
+	RHITRACE_UPDATECONSTANTBUFFER,
+	RHITRACE_UPLOADTEXTURE,
+	RHITRACE_BINDRENDERTARGET,
+	RHITRACE_SETIMAGE,
+	RHITRACE_SETSHADER,
+	RHITRACE_SETCONSTANTBUFFER,
+	RHITRACE_SETSTATE,
+	RHITRACE_COPYIMAGE,
+	RHITRACE_READBACK,
+
+	RHITRACE_NUMOPS
+};
+
+//
+// BuildRHINullTraceCommand
+//
+// One recorded RHI call, this is what a real backend would have written into its command buffer.
+//
+struct BuildRHINullTraceCommand
+{
+	unsigned char		op;
+	unsigned char		pass;
+	unsigned short		pad;
+	int					arg0;		// Vertex, index or texel count depending on the op.
+	int					arg1;		// Start vertex, slot or render target slice depending on the op.
+	int					bytes;		// Bytes that would have been sent to the GPU.
+};
+
+#define RHINULL_MAX_PASSES			32
+
+//
+// BuildRHINullPassStats
+//
+struct BuildRHINullPassStats
+{
+	const char			*name;
+	double				cpuTimeMs;
+	uint64_t			numExecutions;
+	uint64_t			numDrawCalls;
+	uint64_t			numPrimitives;
+	uint64_t			bytesUploaded;
+	uint64_t			numCommands;
+};
+
+//
+// BuildRHINullTrace
+//
+// All of the recording is done on the render thread, the per frame counters get folded into the totals under
+// a lock at the end of the frame so the OSD commands can read them from the game thread.
+//
+class BuildRHINullTrace
+{
+public:
+	BuildRHINullTrace();
+
+	void				Record(BuildRHINullTraceOp op, int arg0, int arg1, int bytes);
+
+	void				BeginPass(const char *name);
+	void				EndPass();
+	void				EndFrame();
+
+	void				Reset();
+	void				PrintReport();
+
+	// Writes the commands of the last completed frame, one per line.
+	bool				WriteLastFrame(const char *fileName);
+private:
+	int					FindPass(const char *name);
+	void				ClearFrame();
+
+	std::vector<BuildRHINullTraceCommand> frameCommands;
+	std::vector<BuildRHINullTraceCommand> lastFrameCommands;
+
+	BuildRHINullPassStats framePasses[RHINULL_MAX_PASSES];
+	BuildRHINullPassStats totalPasses[RHINULL_MAX_PASSES];
+	int					numPasses;
+
+	int					currentPass;
+	std::chrono::high_resolution_clock::time_point passStartTime;
+
+	uint64_t			frameOpCounts[RHITRACE_NUMOPS];
+	uint64_t			totalOpCounts[RHITRACE_NUMOPS];
+
+	uint64_t			numFrames;
+	uint64_t			maxCommandBufferBytes;
+	uint64_t			totalCommandBufferBytes;
+	uint64_t			bytesAllocated;
+
+	std::mutex			statsLock;
+};
+
+extern BuildRHINullTrace rhiNullTrace;
+
+//
+// BuildRHINullTexture
+//
+class BuildRHINullTexture : public BuildRHITexture
+{
+public:
+	BuildRHINullTexture(int width, int height, BuildRHITextureFormat format, bool isCubeMap);
+
+	virtual int			GetWidth() { return _width; }
+	virtual int			GetHeight() { return _height; }
+	virtual void		UploadRegion(int x, int y, int width, int height, const void *buffer) const;
+
+	// Returns the number of bytes needed to store width x height texels of this image.
+	int					GetRegionSize(int width, int height) const;
+
+	BuildRHITextureFormat format;
+	int _width;
+	int _height;
+	bool _isCubeMap;
+};
+
+//
+// BuildRHINullMesh
+//
+class BuildRHINullMesh : public BuildRHIMesh
+{
+public:
+	int					vertexSize;
+	int					numVertexes;
+	int					numIndexes;
+	bool				isDynamic;
+};
+
+//
+// BuildRHINullShader
+//
+class BuildRHINullShader : public BuildRHIShader
+{
+public:
+	virtual bool LoadShader(BuildShaderTarget target, const char *buffer, int length, bool useGUIVertexLayout);
+};
+
+//
+// BuildRHINullConstantBuffer
+//
+class BuildRHINullConstantBuffer : public BuildRHIConstantBuffer
+{
+public:
+	BuildRHINullConstantBuffer(int size) : size(size) { }
+
+	virtual void UpdateBuffer(void *data, int size, int offset);
+private:
+	int					size;
+};
+
+//
+// BuildRHINullRenderTarget
+//
+class BuildRHINullRenderTarget : public BuildRHIRenderTarget
+{
+public:
+	BuildRHINullRenderTarget(BuildRHITexture *diffuseTexture, BuildRHITexture *depthTexture, BuildRHITexture *stencilTexture);
+
+	virtual void				AddRenderTarget(BuildRHITexture *image);
+
+	int							numRenderTargets;
+	BuildRHITexture				*diffuseTexture[MAX_RENDER_TARGETS];
+	BuildRHITexture				*depthTexture;
+};
+
+//
+// BuildRHINullGPUPerformanceCounter
+//
+class BuildRHINullGPUPerformanceCounter : public BuildRHIGPUPerformanceCounter
+{
+public:
+	virtual void			Begin() { }
+	virtual void			End() { }
+	virtual UINT64			GetTime() { return 0; }
+};
+
+//
+// BuildRHINullGPUOcclusionQuery
+//
+// Without a GPU nothing is ever occluded.
+//
+class BuildRHINullGPUOcclusionQuery : public BuildRHIGPUOcclusionQuery
+{
+public:
+	virtual void			Begin() { }
+	virtual void			End() { }
+	virtual bool			IsVisible() { return true; }
+};
@@ -0,0 +1,479 @@
+// Null_RHI.cpp
+//
+// RHI that doesn't talk to a GPU, every call is recorded into a trace so the CPU side of PolymerNG
+// can run and be profiled headless.
+//
+
+#include "BuildRHI_Null.h"
+#include "compat.h"
+#include "osd.h"
+#include <stdio.h>
+#include <string.h>
+
+BuildRHI rhi;
+BuildRHINullTrace rhiNullTrace;
+
+BuildRHIInputElementDesc *ui_VertexElementDescriptor = NULL;
+BuildRHIInputElementDesc *world_VertexElementDescriptor = NULL;
+
+static const char *rhiTraceOpNames[RHITRACE_NUMOPS] = {
+	"Draw",
+	"DrawIndexed",
+	"Draw2D",
+	"Allocate",
+	"UpdateMesh",
+	"UpdateConstantBuffer",
+	"UploadTexture",
+	"BindRenderTarget",
+	"SetImage",
+	"SetShader",
+	"SetConstantBuffer",
+	"SetState",
+	"CopyImage",
+	"ReadBack"
+};
+
+//
+// osdcmd_rhitrace
+//
+static int32_t osdcmd_rhitrace(const osdfuncparm_t *parm)
+{
+	UNREFERENCED_PARAMETER(parm);
+
+	rhiNullTrace.PrintReport();
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_rhitracereset
+//
+static int32_t osdcmd_rhitracereset(const osdfuncparm_t *parm)
+{
+	UNREFERENCED_PARAMETER(parm);
+
+	rhiNullTrace.Reset();
+	initprintf("RHI trace reset\n");
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_rhitracedump
+//
+static int32_t osdcmd_rhitracedump(const osdfuncparm_t *parm)
+{
+	if (parm->numparms != 1)
+		return OSDCMD_SHOWHELP;
+
+	if (!rhiNullTrace.WriteLastFrame(parm->parms[0]))
+	{
+		initprintf("r_rhitrace_dump: failed to write %s\n", parm->parms[0]);
+	}
+
+	return OSDCMD_OK;
+}
+
+//
+// BuildRHINullTrace::BuildRHINullTrace
+//
+BuildRHINullTrace::BuildRHINullTrace()
+{
+	memset(framePasses, 0, sizeof(framePasses));
+	memset(totalPasses, 0, sizeof(totalPasses));
+
+	// Pass 0 collects everything recorded outside of a BeginPass/EndPass pair.
+	framePasses[0].name = totalPasses[0].name = "(no pass)";
+	numPasses = 1;
+	currentPass = 0;
+
+	memset(frameOpCounts, 0, sizeof(frameOpCounts));
+	memset(totalOpCounts, 0, sizeof(totalOpCounts));
+
+	numFrames = 0;
+	maxCommandBufferBytes = 0;
+	totalCommandBufferBytes = 0;
+	bytesAllocated = 0;
+
+	frameCommands.reserve(65536);
+}
+
+//
+// BuildRHINullTrace::Record
+//
+void BuildRHINullTrace::Record(BuildRHINullTraceOp op, int arg0, int arg1, int bytes)
+{
+	BuildRHINullTraceCommand command;
+	command.op = (unsigned char)op;
+	command.pass = (unsigned char)currentPass;
+	command.pad = 0;
+	command.arg0 = arg0;
+	command.arg1 = arg1;
+	command.bytes = bytes;
+	frameCommands.push_back(command);
+
+	BuildRHINullPassStats &pass = framePasses[currentPass];
+	pass.numCommands++;
+	pass.bytesUploaded += bytes;
+
+	switch (op)
+	{
+		case RHITRACE_DRAW:
+			pass.numDrawCalls++;
+			pass.numPrimitives += arg0 > 2 ? arg0 - 2 : 0;
+			break;
+		case RHITRACE_DRAWINDEXED:
+			pass.numDrawCalls++;
+			pass.numPrimitives += arg0 / 3;
+			break;
+		case RHITRACE_DRAW2D:
+			pass.numDrawCalls++;
+			pass.numPrimitives += 2;
+			break;
+		case RHITRACE_ALLOCATE:
+			bytesAllocated += arg0;
+			break;
+		default:
+			break;
+	}
+
+	frameOpCounts[op]++;
+}
+
+//
+// BuildRHINullTrace::FindPass
+//
+int BuildRHINullTrace::FindPass(const char *name)
+{
+	for (int i = 1; i < numPasses; i++)
+	{
+		if (framePasses[i].name == name || !strcmp(framePasses[i].name, name))
+			return i;
+	}
+
+	if (numPasses >= RHINULL_MAX_PASSES)
+	{
+		initprintf("BuildRHINullTrace::FindPass: too many passes, %s is traced as part of (no pass)\n", name);
+		return 0;
+	}
+
+	std::lock_guard<std::mutex> lock(statsLock);
+	framePasses[numPasses].name = name;
+	totalPasses[numPasses].name = name;
+	return numPasses++;
+}
+
+//
+// BuildRHINullTrace::BeginPass
+//
+void BuildRHINullTrace::BeginPass(const char *name)
+{
+	if (currentPass != 0)
+	{
+		initprintf("BuildRHINullTrace::BeginPass: %s started inside of %s\n", name, framePasses[currentPass].name);
+		EndPass();
+	}
+
+	currentPass = FindPass(name);
+	framePasses[currentPass].numExecutions++;
+	passStartTime = std::chrono::high_resolution_clock::now();
+}
+
+//
+// BuildRHINullTrace::EndPass
+//
+void BuildRHINullTrace::EndPass()
+{
+	if (currentPass == 0)
+		return;
+
+	std::chrono::duration<double, std::milli> passTime = std::chrono::high_resolution_clock::now() - passStartTime;
+	framePasses[currentPass].cpuTimeMs += passTime.count();
+	currentPass = 0;
+}
+
+//
+// BuildRHINullTrace::EndFrame
+//
+void BuildRHINullTrace::EndFrame()
+{
+	EndPass();
+
+	uint64_t commandBufferBytes = frameCommands.size() * sizeof(BuildRHINullTraceCommand);
+
+	{
+		std::lock_guard<std::mutex> lock(statsLock);
+
+		for (int i = 0; i < numPasses; i++)
+		{
+			totalPasses[i].cpuTimeMs += framePasses[i].cpuTimeMs;
+			totalPasses[i].numExecutions += framePasses[i].numExecutions;
+			totalPasses[i].numDrawCalls += framePasses[i].numDrawCalls;
+			totalPasses[i].numPrimitives += framePasses[i].numPrimitives;
+			totalPasses[i].bytesUploaded += framePasses[i].bytesUploaded;
+			totalPasses[i].numCommands += framePasses[i].numCommands;
+		}
+
+		for (int i = 0; i < RHITRACE_NUMOPS; i++)
+		{
+			totalOpCounts[i] += frameOpCounts[i];
+		}
+
+		numFrames++;
+		totalCommandBufferBytes += commandBufferBytes;
+		if (commandBufferBytes > maxCommandBufferBytes)
+			maxCommandBufferBytes = commandBufferBytes;
+
+		lastFrameCommands.swap(frameCommands);
+	}
+
+	ClearFrame();
+}
+
+//
+// BuildRHINullTrace::ClearFrame
+//
+void BuildRHINullTrace::ClearFrame()
+{
+	for (int i = 0; i < numPasses; i++)
+	{
+		const char *name = framePasses[i].name;
+		memset(&framePasses[i], 0, sizeof(BuildRHINullPassStats));
+		framePasses[i].name = name;
+	}
+
+	memset(frameOpCounts, 0, sizeof(frameOpCounts));
+	frameCommands.clear();
+}
+
+//
+// BuildRHINullTrace::Reset
+//
+void BuildRHINullTrace::Reset()
+{
+	std::lock_guard<std::mutex> lock(statsLock);
+
+	for (int i = 0; i < numPasses; i++)
+	{
+		const char *name = totalPasses[i].name;
+		memset(&totalPasses[i], 0, sizeof(BuildRHINullPassStats));
+		totalPasses[i].name = name;
+	}
+
+	memset(totalOpCounts, 0, sizeof(totalOpCounts));
+	numFrames = 0;
+	maxCommandBufferBytes = 0;
+	totalCommandBufferBytes = 0;
+}
+
+//
+// BuildRHINullTrace::PrintReport
+//
+void BuildRHINullTrace::PrintReport()
+{
+	std::lock_guard<std::mutex> lock(statsLock);
+
+	if (numFrames == 0)
+	{
+		initprintf("RHI trace: no frames recorded\n");
+		return;
+	}
+
+	double frames = (double)numFrames;
+	double totalTimeMs = 0;
+
+	initprintf("RHI trace: %llu frames\n", (unsigned long long)numFrames);
+	initprintf("%-20s %10s %10s %12s %12s %10s\n", "pass", "cpu ms", "draws", "primitives", "upload KB", "commands");
+	for (int i = 0; i < numPasses; i++)
+	{
+		const BuildRHINullPassStats &pass = totalPasses[i];
+		if (pass.numCommands == 0 && pass.numExecutions == 0)
+			continue;
+
+		initprintf("%-20s %10.3f %10.1f %12.1f %12.2f %10.1f\n", pass.name, pass.cpuTimeMs / frames, pass.numDrawCalls / frames, pass.numPrimitives / frames, (pass.bytesUploaded / 1024.0) / frames, pass.numCommands / frames);
+		totalTimeMs += pass.cpuTimeMs;
+	}
+	initprintf("Pass cpu time: %.3fms per frame\n", totalTimeMs / frames);
+	initprintf("Command buffer: %.2fKB avg %.2fKB max per frame\n", (totalCommandBufferBytes / 1024.0) / frames, maxCommandBufferBytes / 1024.0);
+	initprintf("Buffers allocated: %.2fMB\n", bytesAllocated / (1024.0 * 1024.0));
+
+	for (int i = 0; i < RHITRACE_NUMOPS; i++)
+	{
+		if (totalOpCounts[i] == 0)
+			continue;
+
+		initprintf("    %-22s %.1f per frame\n", rhiTraceOpNames[i], totalOpCounts[i] / frames);
+	}
+}
+
+//
+// BuildRHINullTrace::WriteLastFrame
+//
+bool BuildRHINullTrace::WriteLastFrame(const char *fileName)
+{
+	std::vector<BuildRHINullTraceCommand> commands;
+	const char *passNames[RHINULL_MAX_PASSES];
+	int numPassNames;
+
+	{
+		std::lock_guard<std::mutex> lock(statsLock);
+		commands = lastFrameCommands;
+		numPassNames = numPasses;
+		for (int i = 0; i < numPassNames; i++)
+		{
+			passNames[i] = totalPasses[i].name;
+		}
+	}
+
+	FILE *file = fopen(fileName, "w");
+	if (file == NULL)
+		return false;
+
+	for (size_t i = 0; i < commands.size(); i++)
+	{
+		const BuildRHINullTraceCommand &command = commands[i];
+		fprintf(file, "%s %s %d %d %d\n", passNames[command.pass], rhiTraceOpNames[command.op], command.arg0, command.arg1, command.bytes);
+	}
+
+	fclose(file);
+
+	initprintf("Wrote %d RHI commands to %s\n", (int)commands.size(), fileName);
+	return true;
+}
+
+void BuildRHI::Init()
+{
+	initprintf("Initializing null RHI\n");
+
+	OSD_RegisterFunction("r_rhitrace", "r_rhitrace: prints the per pass cpu time, draw calls and uploads recorded by the null RHI", osdcmd_rhitrace);
+	OSD_RegisterFunction("r_rhitrace_reset", "r_rhitrace_reset: clears the null RHI trace stats", osdcmd_rhitracereset);
+	OSD_RegisterFunction("r_rhitrace_dump", "r_rhitrace_dump <file>: writes the RHI commands of the last frame to a file", osdcmd_rhitracedump);
+}
+
+void BuildRHI::BeginPass(const char *name)
+{
+	rhiNullTrace.BeginPass(name);
+}
+
+void BuildRHI::EndPass()
+{
+	rhiNullTrace.EndPass();
+}
+
+void BuildRHI::EndFrame()
+{
+	rhiNullTrace.EndFrame();
+}
+
+void BuildRHI::SetWorldVertexLayout(BuildRHIWorldVertexLayout layout)
+{
+	// No input layouts to build, the traced vertex sizes already follow the layout.
+}
+
+BuildRHIMesh *BuildRHI::AllocateRHIMesh(int vertexSize, int numVertexes, void * initialData, bool isDynamic)
+{
+	BuildRHINullMesh *mesh = new BuildRHINullMesh();
+	mesh->vertexSize = vertexSize;
+	mesh->numVertexes = numVertexes;
+	mesh->numIndexes = 0;
+	mesh->isDynamic = isDynamic;
+
+	rhiNullTrace.Record(RHITRACE_ALLOCATE, vertexSize * numVertexes, 0, initialData ? vertexSize * numVertexes : 0);
+	return mesh;
+}
+
+void BuildRHI::UpdateRHIMesh(BuildRHIMesh *mesh, int startVertex, int vertexSize, int numVertexes, void *initialData)
+{
+	rhiNullTrace.Record(RHITRACE_UPDATEMESH, numVertexes, startVertex, vertexSize * numVertexes);
+}
+
+void BuildRHI::AllocateRHIMeshIndexes(BuildRHIMesh *mesh, int numIndexes, void * initialData, bool isDynamic)
+{
+	BuildRHINullMesh *mesh_internal = static_cast<BuildRHINullMesh *>(mesh);
+	mesh_internal->numIndexes = numIndexes;
+
+	// Index buffers are always 32bit.
+	rhiNullTrace.Record(RHITRACE_ALLOCATE, sizeof(unsigned int) * numIndexes, 0, initialData ? sizeof(unsigned int) * numIndexes : 0);
+}
+
+void BuildRHI::SetRHIMeshIndexBuffer(BuildRHIMesh *mesh, BuildRHIMesh *parentMesh)
+{
+	static_cast<BuildRHINullMesh *>(mesh)->numIndexes = static_cast<BuildRHINullMesh *>(parentMesh)->numIndexes;
+}
+
+BuildRHIConstantBuffer *BuildRHI::AllocateRHIConstantBuffer(int size, void *initialData)
+{
+	rhiNullTrace.Record(RHITRACE_ALLOCATE, size, 0, initialData ? size : 0);
+	return new BuildRHINullConstantBuffer(size);
+}
+
+void BuildRHINullConstantBuffer::UpdateBuffer(void *data, int size, int offset)
+{
+	rhiNullTrace.Record(RHITRACE_UPDATECONSTANTBUFFER, size, offset, size);
+}
+
+void BuildRHI::SetBlendState(BuildBlendState blendstate)
+{
+	rhiNullTrace.Record(RHITRACE_SETSTATE, blendstate, 0, 0);
+}
+
+void BuildRHI::SetFaceCulling(BuildRHIFaceCulling cullMode)
+{
+	rhiNullTrace.Record(RHITRACE_SETSTATE, cullMode, 1, 0);
+}
+
+void BuildRHI::SetDepthEnable(bool depthEnable)
+{
+	rhiNullTrace.Record(RHITRACE_SETSTATE, depthEnable, 2, 0);
+}
+
+void BuildRHI::SetDepthWriteEnable(bool depthWriteEnable)
+{
+	rhiNullTrace.Record(RHITRACE_SETSTATE, depthWriteEnable, 3, 0);
+}
+
+void BuildRHI::ToggleDeferredRenderContext(bool enable)
+{
+
+}
+
+void BuildRHI::SetImageForContext(int rootIndex, const BuildRHITexture *image, bool useLinearFilter)
+{
+	rhiNullTrace.Record(RHITRACE_SETIMAGE, useLinearFilter, rootIndex, 0);
+}
+
+void BuildRHI::SetShader(BuildRHIShader *shader)
+{
+	rhiNullTrace.Record(RHITRACE_SETSHADER, 0, 0, 0);
+}
+
+void BuildRHI::SetConstantBuffer(int index, BuildRHIConstantBuffer *constantBuffer, BuildShaderBindTarget target)
+{
+	rhiNullTrace.Record(RHITRACE_SETCONSTANTBUFFER, target, index, 0);
+}
+
+void BuildRHI::DrawUnoptimized2DQuad(BuildRHIUIVertex *vertexes)
+{
+	// The GUI mesh gets the four vertexes uploaded before every draw.
+	rhiNullTrace.Record(RHITRACE_DRAW2D, 4, 0, vertexes ? 4 * sizeof(BuildRHIUIVertex) : 0);
+}
+
+void BuildRHI::DrawUnoptimizedQuad(BuildRHIShader *shader, BuildRHIMesh *mesh, int startVertex, int numVertexes)
+{
+	rhiNullTrace.Record(RHITRACE_DRAW, numVertexes, startVertex, 0);
+}
+
+void BuildRHI::DrawIndexedQuad(BuildRHIShader *shader, BuildRHIMesh *mesh, int startVertex, int startIndex, int numIndexes)
+{
+	rhiNullTrace.Record(RHITRACE_DRAWINDEXED, numIndexes, startIndex, 0);
+}
+
+BuildRHIGPUOcclusionQuery *BuildRHI::AllocateOcclusionQuery()
+{
+	return new BuildRHINullGPUOcclusionQuery();
+}
+
+BuildRHIGPUPerformanceCounter *BuildRHI::AllocatePerformanceCounter()
+{
+	return new BuildRHINullGPUPerformanceCounter();
+}
@@ -0,0 +1,256 @@
+// Null_RHI_Images.cpp
+//
+
+#include "BuildRHI_Null.h"
+#include "compat.h"
+#include <stdlib.h>
+#include <string.h>
+
+BuildRHITextureFormat BuildRHI::GetRHITextureFormat(BuildImageFormat format)
+{
+	return format;
+}
+
+int BuildRHI::GetImageBitsFromTextureFormat(BuildRHITextureFormat format)
+{
+	switch (format)
+	{
+	case IMAGE_FORMAT_R8:
+		return 1;
+	case IMAGE_FORMAT_RGBA8:
+		return 4;
+	case IMAGE_FORMAT_DEPTH:
+		return 4;
+	case IMAGE_FORMAT_R8G8:
+		return 2;
+	case IMAGE_FORMAT_R16:
+		return 2;
+	case IMAGE_FORMAT_RGB32:
+		return 16;
+	case IMAGE_FORMAT_RGB16:
+		return 8;
+	case IMAGE_FORMAT_R11G11B10_FLOAT:
+		return 4;
+	case IMAGE_FORMAT_R10G10B10A2:
+		return 4;
+	case IMAGE_FORMAT_R16_FLOAT:
+		return 2;
+
+	case IMAGE_FORMAT_DXT1:
+		return 8;
+	case IMAGE_FORMAT_DXT3:
+		return 16;
+	case IMAGE_FORMAT_DXT5:
+		return 16;
+	case IMAGE_FORMAT_3DC:
+		return 16;
+
+	default:
+		break;
+	}
+
+	return -1;
+}
+
+int BuildRHI::GetImagePitchFromTextureFormat(BuildRHITextureFormat format, int width)
+{
+	int bpp = GetImageBitsFromTextureFormat(format);
+	switch (format)
+	{
+	case IMAGE_FORMAT_DXT1:
+	case IMAGE_FORMAT_DXT3:
+	case IMAGE_FORMAT_DXT5:
+	case IMAGE_FORMAT_3DC:
+		return ((width + 3) / 4) * bpp;
+
+	default:
+		break;
+	}
+
+	return bpp * width;
+}
+
+//
+// BuildRHINullTexture::BuildRHINullTexture
+//
+BuildRHINullTexture::BuildRHINullTexture(int width, int height, BuildRHITextureFormat format, bool isCubeMap)
+{
+	_width = width;
+	_height = height;
+	this->format = format;
+	_isCubeMap = isCubeMap;
+}
+
+//
+// BuildRHINullTexture::GetRegionSize
+//
+int BuildRHINullTexture::GetRegionSize(int width, int height) const
+{
+	int numRows = height;
+	switch (format)
+	{
+	case IMAGE_FORMAT_DXT1:
+	case IMAGE_FORMAT_DXT3:
+	case IMAGE_FORMAT_DXT5:
+	case IMAGE_FORMAT_3DC:
+		numRows = (height + 3) / 4;
+		break;
+
+	default:
+		break;
+	}
+
+	return rhi.GetImagePitchFromTextureFormat(format, width) * numRows;
+}
+
+//
+// BuildRHINullTexture::UploadRegion
+//
+void BuildRHINullTexture::UploadRegion(int x, int y, int width, int height, const void *buffer) const
+{
+	UNREFERENCED_PARAMETER(x);
+	UNREFERENCED_PARAMETER(y);
+	UNREFERENCED_PARAMETER(buffer);
+
+	rhiNullTrace.Record(RHITRACE_UPLOADTEXTURE, width * height, format, GetRegionSize(width, height));
+}
+
+const BuildRHITexture* BuildRHI::LoadTextureFromMemory(const std::wstring &textureName, size_t Width, size_t Height, BuildRHITextureFormat Format, const void* InitData, bool allowCPUWrites, bool allowCPUReads, bool isRenderTargetImage)
+{
+	(void)textureName;
+	UNREFERENCED_PARAMETER(allowCPUWrites);
+	UNREFERENCED_PARAMETER(allowCPUReads);
+	UNREFERENCED_PARAMETER(isRenderTargetImage);
+
+	BuildRHINullTexture *textureRHI = new BuildRHINullTexture((int)Width, (int)Height, Format, false);
+	int size = textureRHI->GetRegionSize((int)Width, (int)Height);
+
+	rhiNullTrace.Record(RHITRACE_ALLOCATE, size, 0, 0);
+	if (InitData)
+	{
+		rhiNullTrace.Record(RHITRACE_UPLOADTEXTURE, (int)(Width * Height), Format, size);
+	}
+
+	return textureRHI;
+}
+
+const BuildRHITexture* BuildRHI::LoadTextureCubeFromMemory(const std::wstring &textureName, size_t Width, size_t Height, BuildRHITextureFormat Format, const void* InitData, bool allowCPUWrites, bool allowCPUReads, bool isRenderTargetImage)
+{
+	(void)textureName;
+	UNREFERENCED_PARAMETER(allowCPUWrites);
+	UNREFERENCED_PARAMETER(allowCPUReads);
+	UNREFERENCED_PARAMETER(isRenderTargetImage);
+
+	BuildRHINullTexture *textureRHI = new BuildRHINullTexture((int)Width, (int)Height, Format, true);
+	int size = textureRHI->GetRegionSize((int)Width, (int)Height) * 6;
+
+	rhiNullTrace.Record(RHITRACE_ALLOCATE, size, 0, 0);
+	if (InitData)
+	{
+		rhiNullTrace.Record(RHITRACE_UPLOADTEXTURE, (int)(Width * Height * 6), Format, size);
+	}
+
+	return textureRHI;
+}
+
+void BuildRHI::ReadBackPixelsFromImage(const BuildRHITexture *image, byte *buffer)
+{
+	const BuildRHINullTexture *rhiImage = static_cast<const BuildRHINullTexture *>(image);
+	int size = rhiImage->GetRegionSize(rhiImage->_width, rhiImage->_height);
+
+	// Nothing was ever rendered, so hand back a cleared image.
+	memset(buffer, 0, size);
+	rhiNullTrace.Record(RHITRACE_READBACK, rhiImage->_width * rhiImage->_height, rhiImage->format, size);
+}
+
+void BuildRHI::CopyImageToAnotherImage(const BuildRHITexture *src, const BuildRHITexture *dst, int x, int y, int width, int height)
+{
+	UNREFERENCED_PARAMETER(src);
+	UNREFERENCED_PARAMETER(dst);
+	UNREFERENCED_PARAMETER(x);
+	UNREFERENCED_PARAMETER(y);
+
+	rhiNullTrace.Record(RHITRACE_COPYIMAGE, width * height, 0, 0);
+}
+
+void BuildRHI::CopyDepthToAnotherImage(const BuildRHITexture *src, const BuildRHITexture *dst)
+{
+	UNREFERENCED_PARAMETER(dst);
+
+	const BuildRHINullTexture *rhiImage = static_cast<const BuildRHINullTexture *>(src);
+	rhiNullTrace.Record(RHITRACE_COPYIMAGE, rhiImage->_width * rhiImage->_height, 1, 0);
+}
+
+//
+// BuildRHINullRenderTarget::BuildRHINullRenderTarget
+//
+BuildRHINullRenderTarget::BuildRHINullRenderTarget(BuildRHITexture *diffuseTexture, BuildRHITexture *depthTexture, BuildRHITexture *stencilTexture)
+{
+	UNREFERENCED_PARAMETER(stencilTexture);
+
+	memset(this->diffuseTexture, 0, sizeof(this->diffuseTexture));
+	this->diffuseTexture[0] = diffuseTexture;
+	this->depthTexture = depthTexture;
+	numRenderTargets = diffuseTexture ? 1 : 0;
+}
+
+//
+// BuildRHINullRenderTarget::AddRenderTarget
+//
+void BuildRHINullRenderTarget::AddRenderTarget(BuildRHITexture *image)
+{
+	if (numRenderTargets >= MAX_RENDER_TARGETS)
+	{
+		initprintf("BuildRHINullRenderTarget::AddRenderTarget: Too many render targets!\n");
+		return;
+	}
+
+	diffuseTexture[numRenderTargets++] = image;
+}
+
+BuildRHIRenderTarget *BuildRHI::AllocateRHIRenderTarget(BuildRHITexture *diffuseTexture, BuildRHITexture *depthTexture, BuildRHITexture *stencilTexture)
+{
+	return new BuildRHINullRenderTarget(diffuseTexture, depthTexture, stencilTexture);
+}
+
+void BuildRHI::BindRenderTarget(BuildRHIRenderTarget *renderTarget, int slice, bool shouldClear)
+{
+	// A NULL render target is the back buffer.
+	int numRenderTargets = renderTarget ? static_cast<BuildRHINullRenderTarget *>(renderTarget)->numRenderTargets : 1;
+	rhiNullTrace.Record(RHITRACE_BINDRENDERTARGET, numRenderTargets, slice, 0);
+}
+
+//
+// BuildRHINullShader::LoadShader
+//
+bool BuildRHINullShader::LoadShader(BuildShaderTarget target, const char *buffer, int length, bool useGUIVertexLayout)
+{
+	return buffer != NULL && length > 0;
+}
+
+BuildRHIShader *BuildRHI::AllocateShaderObject()
+{
+	return new BuildRHINullShader();
+}
+
+BuildRHIBlob::BuildRHIBlob()
+{
+	blob_buffer = NULL;
+	blob_buffer_length = -1;
+}
+
+BuildRHIBlob::~BuildRHIBlob()
+{
+	if (blob_buffer == NULL)
+		return;
+
+	free(blob_buffer);
+	blob_buffer = NULL;
+}
+
+void BuildRHIBlob::SetMemory(void *memory, size_t blob_buffer_length)
+{
+	this->blob_buffer_length = blob_buffer_length;
+	this->blob_buffer = malloc(blob_buffer_length);
+	memcpy(this->blob_buffer, memory, blob_buffer_length);
+}
@@ -19,7 +19,9 @@ Abstract:
 #define __glu_h__
 #define __GLU_H__
 
+#ifdef _WIN32
 #include <winapifamily.h>
+#endif
 
 typedef unsigned int GLenum;
 typedef unsigned char GLboolean;
@@ -0,0 +1,113 @@
+// jobbenchmark.cpp
+//
+// Standalone driver for the job system microbenchmark, runs the job_benchmark OSD command from
+// jobsystem_osd.cpp without the engine or the game. It supplies the handful of console and timer
+// functions the job system, its OSD command and the profiler link against.
+//
+//	jobbench [workers] [items] [rounds]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <chrono>
+
+#include "compat.h"
+#include "osd.h"
+#include "build.h"
+#include "baselayer.h"
+
+#include "jobsystem.h"
+#include "Profiler/profiler.h"
+
+static int32_t (*jobBenchmarkCommand)(const osdfuncparm_t *);
+
+//
+// OSD_Printf
+//
+void OSD_Printf(const char *fmt, ...)
+{
+	va_list va;
+
+	va_start(va, fmt);
+	vprintf(fmt, va);
+	va_end(va);
+}
+
+//
+// OSD_RegisterFunction
+//
+// Only job_benchmark is kept, the driver calls it directly.
+//
+int32_t OSD_RegisterFunction(const char *name, const char *help, int32_t (*func)(const osdfuncparm_t*))
+{
+	UNREFERENCED_PARAMETER(help);
+
+	if (!Bstrcmp(name, "job_benchmark"))
+		jobBenchmarkCommand = func;
+	return 0;
+}
+
+void initprintf(const char *f, ...)
+{
+	va_list va;
+
+	va_start(va, f);
+	vprintf(f, va);
+	va_end(va);
+}
+
+// The profiler overlay has nowhere to draw.
+void printext256(int32_t xpos, int32_t ypos, int16_t col, int16_t backcol, const char *name, char fontsize)
+{
+	UNREFERENCED_PARAMETER(xpos);
+	UNREFERENCED_PARAMETER(ypos);
+	UNREFERENCED_PARAMETER(col);
+	UNREFERENCED_PARAMETER(backcol);
+	UNREFERENCED_PARAMETER(name);
+	UNREFERENCED_PARAMETER(fontsize);
+}
+
+void handle_memerr(void)
+{
+	fputs("jobbench: out of memory\n", stderr);
+	exit(EXIT_FAILURE);
+}
+
+// Returns the time since an unspecified starting time in milliseconds.
+double gethiticks(void)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//
+// main
+//
+int main(int argc, char **argv)
+{
+	if (argc > 4)
+	{
+		fputs("usage: jobbench [workers] [items] [rounds]\n", stderr);
+		return EXIT_FAILURE;
+	}
+
+	buildProfiler.SetThreadName("main");
+
+	jobSystem.Init((argc >= 2) ? Batol(argv[1]) : 0);
+	jobSystem.InitOSD();
+
+	if (!jobBenchmarkCommand)
+		return EXIT_FAILURE;
+
+	osdfuncparm_t parm;
+	parm.numparms = max(argc - 2, 0);
+	parm.name = "job_benchmark";
+	parm.parms = (const char **)(argv + 2);
+	parm.raw = "job_benchmark";
+
+	const int32_t result = jobBenchmarkCommand(&parm);
+
+	jobSystem.Shutdown();
+
+	return (result == OSDCMD_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
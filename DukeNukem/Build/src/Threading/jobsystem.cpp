@@ -0,0 +1,538 @@
+// jobsystem.cpp
+//
+
+#include "jobsystem.h"
+#include "../Profiler/profiler.h"
+
+#include <stdio.h>
+
+BuildJobSystem jobSystem;
+
+// Index of the deque owned by the current thread, -1 for threads the job system doesn't own.
+static thread_local int jobWorkerIndex = -1;
+
+//
+// BuildJobWorker
+//
+class BuildJobWorker : public BuildThread
+{
+public:
+	BuildJobWorker(BuildJobSystem *system, int workerIndex) : BuildThread(workerIndex) {
+		_system = system; _workerIndex = workerIndex;
+		Start();
+	}
+
+	virtual int Execute();
+private:
+	BuildJobSystem *_system;
+	int _workerIndex;
+};
+
+int BuildJobWorker::Execute()
+{
+	char name[32];
+
+	snprintf(name, sizeof(name), "worker %d", _workerIndex);
+	buildProfiler.SetThreadName(name);
+
+	jobWorkerIndex = _workerIndex;
+	_system->WorkerLoop(_workerIndex);
+
+	return 0;
+}
+
+BuildJobCounter::BuildJobCounter()
+{
+	count.store(0);
+	numWaiters = 0;
+}
+
+BuildJobDeque::BuildJobDeque()
+{
+	top.store(0);
+	bottom.store(0);
+	for (int i = 0; i < BUILD_JOB_QUEUE_SIZE; i++)
+	{
+		jobs[i].store(NULL, std::memory_order_relaxed);
+	}
+}
+
+//
+// BuildJobDeque::Push
+//
+bool BuildJobDeque::Push(BuildJob *job)
+{
+	int64_t b = bottom.load(std::memory_order_relaxed);
+	int64_t t = top.load(std::memory_order_acquire);
+
+	if (b - t >= BUILD_JOB_QUEUE_SIZE)
+		return false;
+
+	jobs[b & (BUILD_JOB_QUEUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release);
+
+	return true;
+}
+
+//
+// BuildJobDeque::Pop
+//
+BuildJob *BuildJobDeque::Pop()
+{
+	int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = top.load(std::memory_order_relaxed);
+
+	if (t > b)
+	{
+		// Empty.
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return NULL;
+	}
+
+	BuildJob *job = jobs[b & (BUILD_JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+	if (t == b)
+	{
+		// Last job, race the thieves for it.
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = NULL;
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+//
+// BuildJobDeque::Steal
+//
+BuildJob *BuildJobDeque::Steal()
+{
+	int64_t t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t b = bottom.load(std::memory_order_acquire);
+
+	if (t >= b)
+		return NULL;
+
+	BuildJob *job = jobs[t & (BUILD_JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return NULL;
+
+	return job;
+}
+
+BuildJobSystem::BuildJobSystem()
+{
+	numWorkers = 0;
+	for (int i = 0; i <= BUILD_JOB_MAX_WORKERS; i++)
+	{
+		deques[i] = NULL;
+		jobPools[i] = NULL;
+		jobPoolIndex[i] = 0;
+	}
+	for (int i = 0; i < BUILD_JOB_MAX_WORKERS; i++)
+	{
+		workers[i] = NULL;
+	}
+
+	externalDeque = NULL;
+	externalPool = NULL;
+	externalPoolIndex = 0;
+
+	running.store(false);
+	numQueuedJobs.store(0);
+	numSleepingWorkers.store(0);
+}
+
+//
+// BuildJobSystem::~BuildJobSystem
+//
+// exit() without uninitengine() still has workers asleep on wakeCondition, and destroying a condition variable
+// that has waiters blocks on glibc.
+//
+BuildJobSystem::~BuildJobSystem()
+{
+	Shutdown();
+}
+
+//
+// BuildJobSystem::Init
+//
+void BuildJobSystem::Init(int numWorkers)
+{
+	if (IsInitialized())
+		return;
+
+	if (numWorkers <= 0)
+		numWorkers = BuildThread::GetNumHardwareThreads() - 1;
+	if (numWorkers < 1)
+		numWorkers = 1;
+	if (numWorkers > BUILD_JOB_MAX_WORKERS)
+		numWorkers = BUILD_JOB_MAX_WORKERS;
+
+	for (int i = 0; i <= numWorkers; i++)
+	{
+		deques[i] = new BuildJobDeque();
+		jobPools[i] = new BuildJob[BUILD_JOB_QUEUE_SIZE];
+		jobPoolIndex[i] = 0;
+		for (int j = 0; j < BUILD_JOB_QUEUE_SIZE; j++)
+			jobPools[i][j].inFlight.store(false, std::memory_order_relaxed);
+	}
+
+	externalDeque = new BuildJobDeque();
+	externalPool = new BuildJob[BUILD_JOB_QUEUE_SIZE];
+	externalPoolIndex = 0;
+	for (int j = 0; j < BUILD_JOB_QUEUE_SIZE; j++)
+		externalPool[j].inFlight.store(false, std::memory_order_relaxed);
+
+	jobWorkerIndex = 0;
+	running.store(true);
+
+	this->numWorkers = numWorkers;
+	for (int i = 0; i < numWorkers; i++)
+	{
+		workers[i] = new BuildJobWorker(this, i + 1);
+	}
+}
+
+//
+// BuildJobSystem::Shutdown
+//
+void BuildJobSystem::Shutdown()
+{
+	if (!IsInitialized())
+		return;
+
+	running.store(false);
+	{
+		std::lock_guard<std::mutex> lock(wakeLock);
+	}
+	wakeCondition.notify_all();
+
+	for (int i = 0; i < numWorkers; i++)
+	{
+		workers[i]->Join();
+		delete workers[i];
+		workers[i] = NULL;
+	}
+
+	for (int i = 0; i <= numWorkers; i++)
+	{
+		delete deques[i];
+		delete[] jobPools[i];
+		deques[i] = NULL;
+		jobPools[i] = NULL;
+	}
+
+	delete externalDeque;
+	delete[] externalPool;
+	externalDeque = NULL;
+	externalPool = NULL;
+
+	numWorkers = 0;
+	jobWorkerIndex = -1;
+}
+
+//
+// BuildJobSystem::AllocJobFromRing
+//
+BuildJob *BuildJobSystem::AllocJobFromRing(BuildJob *pool, uint32_t &poolIndex)
+{
+	BuildJob *job = &pool[poolIndex & (BUILD_JOB_QUEUE_SIZE - 1)];
+	if (job->inFlight.load(std::memory_order_acquire))
+		return NULL;
+
+	poolIndex++;
+	job->inFlight.store(true, std::memory_order_relaxed);
+	return job;
+}
+
+//
+// BuildJobSystem::AllocJob
+//
+// Jobs come out of a per thread ring of BUILD_JOB_QUEUE_SIZE, only the owning thread allocates
+// from it. Returns NULL when the next slot hasn't run yet, the caller then runs the job itself.
+//
+BuildJob *BuildJobSystem::AllocJob()
+{
+	int index = jobWorkerIndex;
+
+	if (index < 0)
+	{
+		std::lock_guard<std::mutex> lock(externalLock);
+		return AllocJobFromRing(externalPool, externalPoolIndex);
+	}
+
+	return AllocJobFromRing(jobPools[index], jobPoolIndex[index]);
+}
+
+//
+// BuildJobSystem::Enqueue
+//
+void BuildJobSystem::Enqueue(BuildJob *job)
+{
+	int index = jobWorkerIndex;
+	bool queued;
+
+	if (index < 0)
+	{
+		std::lock_guard<std::mutex> lock(externalLock);
+		queued = externalDeque->Push(job);
+	}
+	else
+	{
+		queued = deques[index]->Push(job);
+	}
+
+	if (!queued)
+	{
+		// Queue is full, just do the work here.
+		Execute(job);
+		return;
+	}
+
+	numQueuedJobs.fetch_add(1);
+	WakeWorkers();
+}
+
+//
+// BuildJobSystem::Submit
+//
+void BuildJobSystem::Submit(BuildJob *job, BuildJobCounter *dependency)
+{
+	if (dependency != NULL)
+	{
+		std::unique_lock<std::mutex> lock(dependency->waitersLock);
+		if (!dependency->IsDone())
+		{
+			if (dependency->numWaiters < BUILD_JOB_MAX_WAITERS)
+			{
+				dependency->waiters[dependency->numWaiters++] = job;
+				return;
+			}
+
+			lock.unlock();
+			Wait(dependency);
+		}
+	}
+
+	Enqueue(job);
+}
+
+//
+// BuildJobSystem::RunInline
+//
+// For when the job ring is used up, the job is on the caller's stack.
+//
+void BuildJobSystem::RunInline(BuildJob *job, BuildJobCounter *dependency)
+{
+	if (dependency != NULL)
+		Wait(dependency);
+
+	Execute(job);
+}
+
+//
+// BuildJobSystem::Run
+//
+void BuildJobSystem::Run(BuildJobFunction func, void *data, BuildJobCounter *counter, BuildJobCounter *dependency)
+{
+	if (!IsInitialized())
+	{
+		if (dependency != NULL)
+			Wait(dependency);
+		func(data, 0, 1);
+		return;
+	}
+
+	BuildJob inlineJob;
+	BuildJob *job = AllocJob();
+	if (job == NULL)
+		job = &inlineJob;
+
+	job->func = func;
+	job->data = data;
+	job->begin = 0;
+	job->end = 1;
+	job->counter = counter;
+
+	if (counter != NULL)
+		counter->count.fetch_add(1);
+
+	if (job == &inlineJob)
+		RunInline(job, dependency);
+	else
+		Submit(job, dependency);
+}
+
+//
+// BuildJobSystem::ParallelFor
+//
+void BuildJobSystem::ParallelFor(int count, int batchSize, BuildJobFunction func, void *data, BuildJobCounter *counter, BuildJobCounter *dependency)
+{
+	if (count <= 0)
+		return;
+
+	if (!IsInitialized())
+	{
+		if (dependency != NULL)
+			Wait(dependency);
+		func(data, 0, count);
+		return;
+	}
+
+	if (batchSize < 1)
+		batchSize = 1;
+
+	int numBatches = (count + batchSize - 1) / batchSize;
+	if (counter != NULL)
+		counter->count.fetch_add(numBatches);
+
+	for (int begin = 0; begin < count; begin += batchSize)
+	{
+		BuildJob inlineJob;
+		BuildJob *job = AllocJob();
+		if (job == NULL)
+			job = &inlineJob;
+
+		job->func = func;
+		job->data = data;
+		job->begin = begin;
+		job->end = (begin + batchSize < count) ? begin + batchSize : count;
+		job->counter = counter;
+
+		if (job == &inlineJob)
+			RunInline(job, dependency);
+		else
+			Submit(job, dependency);
+	}
+}
+
+//
+// BuildJobSystem::GetJob
+//
+BuildJob *BuildJobSystem::GetJob(int workerIndex)
+{
+	BuildJob *job = NULL;
+
+	if (workerIndex >= 0)
+		job = deques[workerIndex]->Pop();
+
+	if (job == NULL)
+		job = externalDeque->Steal();
+
+	for (int i = 1; job == NULL && i <= numWorkers + 1; i++)
+	{
+		int victim = (workerIndex + i) % (numWorkers + 1);
+		if (victim == workerIndex)
+			continue;
+
+		job = deques[victim]->Steal();
+	}
+
+	if (job != NULL)
+		numQueuedJobs.fetch_sub(1);
+
+	return job;
+}
+
+//
+// BuildJobSystem::Execute
+//
+void BuildJobSystem::Execute(BuildJob *job)
+{
+	job->func(job->data, job->begin, job->end);
+
+	// The slot can be handed out again as soon as the flag drops, so nothing reads the job after.
+	BuildJobCounter *counter = job->counter;
+	job->inFlight.store(false, std::memory_order_release);
+
+	if (counter == NULL)
+		return;
+
+	// Anything but the last job just counts down.
+	int count = counter->count.load(std::memory_order_relaxed);
+	while (count > 1)
+	{
+		if (counter->count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+			return;
+	}
+
+	// The last one counts down under the lock, Wait takes the lock before it returns, so the
+	// counter is still alive until we let go of it and isn't touched after that.
+	BuildJob *released[BUILD_JOB_MAX_WAITERS];
+	int numReleased = 0;
+	{
+		std::lock_guard<std::mutex> lock(counter->waitersLock);
+		if (counter->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			numReleased = counter->numWaiters;
+			for (int i = 0; i < numReleased; i++)
+				released[i] = counter->waiters[i];
+			counter->numWaiters = 0;
+		}
+	}
+
+	for (int i = 0; i < numReleased; i++)
+		Enqueue(released[i]);
+}
+
+//
+// BuildJobSystem::Wait
+//
+void BuildJobSystem::Wait(BuildJobCounter *counter)
+{
+	int workerIndex = jobWorkerIndex;
+
+	while (!counter->IsDone())
+	{
+		BuildJob *job = IsInitialized() ? GetJob(workerIndex) : NULL;
+		if (job != NULL)
+		{
+			Execute(job);
+			continue;
+		}
+
+		std::this_thread::yield();
+	}
+
+	// The job that finished the counter may still hold the lock, the caller is free to destroy
+	// the counter once we have had it.
+	std::lock_guard<std::mutex> lock(counter->waitersLock);
+}
+
+//
+// BuildJobSystem::WakeWorkers
+//
+void BuildJobSystem::WakeWorkers()
+{
+	if (numSleepingWorkers.load() == 0)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(wakeLock);
+	}
+	wakeCondition.notify_one();
+}
+
+//
+// BuildJobSystem::WorkerLoop
+//
+void BuildJobSystem::WorkerLoop(int workerIndex)
+{
+	while (running.load())
+	{
+		BuildJob *job = GetJob(workerIndex);
+		if (job != NULL)
+		{
+			Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wakeLock);
+		numSleepingWorkers.fetch_add(1);
+		wakeCondition.wait(lock, [this] { return !running.load() || numQueuedJobs.load() > 0; });
+		numSleepingWorkers.fetch_sub(1);
+	}
+}
@@ -0,0 +1,133 @@
+// jobsystem.h
+//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+#include "thread.h"
+
+#define BUILD_JOB_MAX_WORKERS			32
+#define BUILD_JOB_QUEUE_SIZE			4096	// must be a power of two
+#define BUILD_JOB_MAX_WAITERS			64
+
+typedef void (*BuildJobFunction)(void *data, int begin, int end);
+
+class BuildJobCounter;
+
+//
+// BuildJob
+//
+struct BuildJob
+{
+	BuildJobFunction	func;
+	void				*data;
+	int					begin;
+	int					end;
+	BuildJobCounter		*counter;
+	std::atomic<bool>	inFlight;		// from AllocJob until the job has run
+};
+
+//
+// BuildJobCounter
+//
+// Counts the unfinished jobs of a submission; jobs can be made to wait on one before they start.
+//
+class BuildJobCounter
+{
+	friend class BuildJobSystem;
+public:
+	BuildJobCounter();
+
+	bool				IsDone() const { return count.load(std::memory_order_acquire) == 0; }
+private:
+	std::atomic<int>	count;
+
+	std::mutex			waitersLock;
+	BuildJob			*waiters[BUILD_JOB_MAX_WAITERS];
+	int					numWaiters;
+};
+
+//
+// BuildJobDeque
+//
+// Fixed size Chase-Lev work stealing deque. Only the owning thread pushes and pops, any thread can steal.
+//
+class BuildJobDeque
+{
+public:
+	BuildJobDeque();
+
+	bool				Push(BuildJob *job);
+	BuildJob			*Pop();
+	BuildJob			*Steal();
+private:
+	std::atomic<int64_t>	top;
+	std::atomic<int64_t>	bottom;
+	std::atomic<BuildJob *>	jobs[BUILD_JOB_QUEUE_SIZE];
+};
+
+//
+// BuildJobSystem
+//
+class BuildJobSystem
+{
+	friend class BuildJobWorker;
+public:
+	BuildJobSystem();
+	~BuildJobSystem();
+
+	// numWorkers == 0 picks one worker per hardware thread, minus the calling thread.
+	void				Init(int numWorkers = 0);
+	void				Shutdown();
+
+	bool				IsInitialized() const { return numWorkers > 0; }
+	int					GetNumWorkers() const { return numWorkers; }
+
+	// Queues a single job, if dependency is set the job won't start until the dependency is done.
+	void				Run(BuildJobFunction func, void *data, BuildJobCounter *counter, BuildJobCounter *dependency = NULL);
+
+	// Splits [0, count) into batches of batchSize and queues a job per batch.
+	void				ParallelFor(int count, int batchSize, BuildJobFunction func, void *data, BuildJobCounter *counter, BuildJobCounter *dependency = NULL);
+
+	// Runs queued jobs on the calling thread until the counter reaches zero.
+	void				Wait(BuildJobCounter *counter);
+
+	// Registers job_benchmark, see jobsystem_osd.cpp.
+	void				InitOSD();
+private:
+	BuildJob			*AllocJob();
+	BuildJob			*AllocJobFromRing(BuildJob *pool, uint32_t &poolIndex);
+	void				Submit(BuildJob *job, BuildJobCounter *dependency);
+	void				RunInline(BuildJob *job, BuildJobCounter *dependency);
+	void				Enqueue(BuildJob *job);
+	BuildJob			*GetJob(int workerIndex);
+	void				Execute(BuildJob *job);
+	void				WakeWorkers();
+	void				WorkerLoop(int workerIndex);
+
+	int					numWorkers;
+	class BuildJobWorker *workers[BUILD_JOB_MAX_WORKERS];
+
+	// Slot 0 belongs to the thread that called Init, workers start at 1.
+	BuildJobDeque		*deques[BUILD_JOB_MAX_WORKERS + 1];
+	BuildJob			*jobPools[BUILD_JOB_MAX_WORKERS + 1];
+	uint32_t			jobPoolIndex[BUILD_JOB_MAX_WORKERS + 1];
+
+	// Jobs submitted from threads the job system doesn't own.
+	std::mutex			externalLock;
+	BuildJobDeque		*externalDeque;
+	BuildJob			*externalPool;
+	uint32_t			externalPoolIndex;
+
+	std::atomic<bool>	running;
+	std::atomic<int>	numQueuedJobs;
+	std::atomic<int>	numSleepingWorkers;
+	std::mutex			wakeLock;
+	std::condition_variable wakeCondition;
+};
+
+extern BuildJobSystem jobSystem;
@@ -0,0 +1,129 @@
+// jobsystem_osd.cpp
+//
+
+#include "compat.h"
+#include "osd.h"
+#include "build.h"
+#include "baselayer.h"
+
+#include "jobsystem.h"
+
+#define JOB_BENCHMARK_ITEMS			65536
+#define JOB_BENCHMARK_ITERATIONS	64		// hash rounds per item
+
+static uint32_t *jobBenchmarkResults;
+static int jobBenchmarkIterations;
+
+//
+// JobBenchmarkItems
+//
+// Roughly the cost of a sprite or sector worth of work per item.
+//
+static void JobBenchmarkItems(void *data, int begin, int end)
+{
+	UNREFERENCED_PARAMETER(data);
+
+	for (int i = begin; i < end; i++)
+	{
+		uint32_t h = (uint32_t)i * 2654435761u;
+		for (int j = 0; j < jobBenchmarkIterations; j++)
+			h = (h ^ (h >> 15)) * 2246822519u + j;
+		jobBenchmarkResults[i] = h;
+	}
+}
+
+static void JobBenchmarkEmpty(void *data, int begin, int end)
+{
+	UNREFERENCED_PARAMETER(data);
+	UNREFERENCED_PARAMETER(begin);
+	UNREFERENCED_PARAMETER(end);
+}
+
+//
+// osdcmd_job_benchmark
+//
+// Times ParallelFor against a plain loop at a few batch sizes, the round trip of empty jobs and a
+// chain of dependent submissions, and checks every item was written exactly as the loop does.
+//
+static int32_t osdcmd_job_benchmark(const osdfuncparm_t *parm)
+{
+	if (parm->numparms > 2)
+		return OSDCMD_SHOWHELP;
+
+	const int numItems = (parm->numparms >= 1) ? max(Batol(parm->parms[0]), 1) : JOB_BENCHMARK_ITEMS;
+	jobBenchmarkIterations = (parm->numparms == 2) ? max(Batol(parm->parms[1]), 1) : JOB_BENCHMARK_ITERATIONS;
+
+	if (!jobSystem.IsInitialized())
+	{
+		OSD_Printf("job_benchmark: the job system isn't running\n");
+		return OSDCMD_OK;
+	}
+
+	uint32_t *reference = (uint32_t *)Xmalloc(numItems * sizeof(uint32_t));
+	jobBenchmarkResults = reference;
+
+	double startTime = gethiticks();
+	JobBenchmarkItems(NULL, 0, numItems);
+	const double serialTime = gethiticks() - startTime;
+
+	OSD_Printf("job_benchmark: %d workers, %d items of %d rounds, serial %.3fms\n", jobSystem.GetNumWorkers(),
+			   numItems, jobBenchmarkIterations, serialTime);
+
+	jobBenchmarkResults = (uint32_t *)Xmalloc(numItems * sizeof(uint32_t));
+
+	static const int batchSizes[] = { 1, 16, 256, 4096 };
+	for (int i = 0; i < ARRAY_SSIZE(batchSizes); i++)
+	{
+		Bmemset(jobBenchmarkResults, 0, numItems * sizeof(uint32_t));
+
+		BuildJobCounter counter;
+		startTime = gethiticks();
+		jobSystem.ParallelFor(numItems, batchSizes[i], JobBenchmarkItems, NULL, &counter);
+		jobSystem.Wait(&counter);
+		const double parallelTime = gethiticks() - startTime;
+
+		OSD_Printf("job_benchmark: batch %4d: %.3fms, %.2fx%s\n", batchSizes[i], parallelTime,
+				   serialTime / max(parallelTime, 0.001),
+				   Bmemcmp(jobBenchmarkResults, reference, numItems * sizeof(uint32_t)) ? ", results DIFFER" : "");
+	}
+
+	// Scheduling overhead, one empty job per item.
+	{
+		BuildJobCounter counter;
+		startTime = gethiticks();
+		for (int i = 0; i < numItems; i++)
+			jobSystem.Run(JobBenchmarkEmpty, NULL, &counter);
+		jobSystem.Wait(&counter);
+		const double runTime = gethiticks() - startTime;
+
+		OSD_Printf("job_benchmark: %d empty jobs: %.3fms, %.0fns per job\n", numItems, runTime, runTime * 1000000.0 / numItems);
+	}
+
+	// Dependencies, each step waits on the one before.
+	{
+		static const int numSteps = 64;
+		BuildJobCounter counters[numSteps];
+
+		startTime = gethiticks();
+		for (int i = 0; i < numSteps; i++)
+			jobSystem.ParallelFor(numSteps, 1, JobBenchmarkEmpty, NULL, &counters[i], i ? &counters[i - 1] : NULL);
+		jobSystem.Wait(&counters[numSteps - 1]);
+		const double chainTime = gethiticks() - startTime;
+
+		OSD_Printf("job_benchmark: %d dependent steps of %d jobs: %.3fms\n", numSteps, numSteps, chainTime);
+	}
+
+	Bfree(jobBenchmarkResults);
+	Bfree(reference);
+	jobBenchmarkResults = NULL;
+
+	return OSDCMD_OK;
+}
+
+//
+// BuildJobSystem::InitOSD
+//
+void BuildJobSystem::InitOSD()
+{
+	OSD_RegisterFunction("job_benchmark", "job_benchmark [items] [rounds]: times ParallelFor against a plain loop, empty jobs and dependency chains", osdcmd_job_benchmark);
+}
@@ -2,14 +2,35 @@
 
 BuildThread::BuildThread(int core)
 {
-	DWORD   dwThreadIdArray;
-	_sysHandle = ::CreateThread( NULL, 0,MyThreadFunction, this, 0, &dwThreadIdArray);
-//	SetThreadAffinityMask(_sysHandle, core);
+	_core = core;
 }
 
-DWORD WINAPI BuildThread::MyThreadFunction(LPVOID lpParam)
+BuildThread::~BuildThread()
 {
-	BuildThread *thread = (BuildThread *)lpParam;
+	if (_sysThread.joinable())
+		_sysThread.detach();
+}
+
+void BuildThread::Start()
+{
+	_sysThread = std::thread(ThreadFunction, this);
+//	SetThreadAffinityMask(_sysThread.native_handle(), _core);
+}
+
+void BuildThread::Join()
+{
+	if (_sysThread.joinable())
+		_sysThread.join();
+}
+
+int BuildThread::GetNumHardwareThreads()
+{
+	int numThreads = (int)std::thread::hardware_concurrency();
 
-	return thread->Execute();
+	return (numThreads > 0) ? numThreads : 1;
+}
+
+void BuildThread::ThreadFunction(BuildThread *thread)
+{
+	thread->Execute();
 }
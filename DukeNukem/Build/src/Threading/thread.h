@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include <windows.h>
+#include <thread>
 
 //
 // BuildThread
@@ -12,10 +12,18 @@ class BuildThread
 {
 public:
 	BuildThread(int core);
+	virtual ~BuildThread();
 
 	virtual int		Execute() = 0;
+
+	// Spawns the thread, call once the derived class is fully constructed.
+	void			Start();
+	void			Join();
+
+	static int		GetNumHardwareThreads();
 private:
-	static DWORD WINAPI MyThreadFunction(LPVOID lpParam);
+	static void		ThreadFunction(BuildThread *thread);
 
-	HANDLE _sysHandle;
+	std::thread		_sysThread;
+	int				_core;
 };
@@ -7,6 +7,9 @@
 
 #include "a.h"
 #include "polymost.h"
+#include "clipgrid.h"
+#include "Profiler/profiler.h"
+#include "Threading/jobsystem.h"
 
 // input
 char inputdevices=0;
@@ -549,6 +552,10 @@ int32_t baselayer_init(void)
                              (cvars_engine[i].type & CVAR_FUNCPTR) ? osdcmd_cvar_set_baselayer : osdcmd_cvar_set);
     }
 
+    clipgrid_initosd();
+    buildProfiler.InitOSD();
+    jobSystem.InitOSD();
+
 #ifdef USE_OPENGL
     OSD_RegisterFunction("setrendermode","setrendermode <number>: sets the engine's rendering mode.\n"
                          "Mode numbers are:\n"
@@ -12,7 +12,9 @@
 #include "engine_priv.h"
 #include "hightile.h"
 #include "polymost.h"
+#ifndef BUILD_RHI_NULL
 #include "polymer.h"
+#endif
 #include "cache1d.h"
 #include "kplib.h"
 #include "texcache.h"
@@ -49,6 +51,7 @@ int32_t vsync = 0;
 
 const Build3DPlane		*renderPlanesGlobalPool[MAX_CONCURRENT_DRAWBOARDS][60000];
 const Build3DPlane		*renderPlanesGlobalPool2[MAX_CONCURRENT_DRAWBOARDS][60000];
+const Build3DPlane		*renderPlanesGlobalPool3[MAX_CONCURRENT_DRAWBOARDS][60000];
 
 #include <math.h> //<-important!
 #include <float.h>
@@ -303,6 +306,19 @@ Build3DBoard::Build3DBoard()
 {
 	prtess = gluNewTess();
 	model = new BaseModel();
+
+	// Lay out the plane bounds sector by sector, so a sector and all of its walls can be culled in one batch.
+	int numPlanes = 0;
+	for (int i = 0; i < numsectors; i++)
+	{
+		sectorPlaneBounds[i] = numPlanes;
+		for (int w = 0; w < sector[i].wallnum; w++)
+		{
+			wallPlaneBounds[sector[i].wallptr + w] = numPlanes + BUILD3D_PLANEBOUNDS_FIRSTWALL + (w * BUILD3D_PLANEBOUNDS_PERWALL);
+		}
+		numPlanes += BUILD3D_PLANEBOUNDS_FIRSTWALL + (sector[i].wallnum * BUILD3D_PLANEBOUNDS_PERWALL);
+	}
+	planeBounds.Init(numPlanes);
 }
 
 /*
@@ -357,6 +373,10 @@ bool Build3DBoard::initwall(int16_t wallnum)
 
 	w->flags.empty = 1;
 
+	w->wall.boundsIndex = wallPlaneBounds[wallnum] + BUILD3D_PLANEBOUNDS_WALL;
+	w->over.boundsIndex = wallPlaneBounds[wallnum] + BUILD3D_PLANEBOUNDS_OVER;
+	w->mask.boundsIndex = wallPlaneBounds[wallnum] + BUILD3D_PLANEBOUNDS_MASK;
+
 	prwalls[wallnum] = w;
 
 	return true;
@@ -963,6 +983,10 @@ bool Build3DBoard::updatewall(int16_t wallnum)
 	//	w->mask.mapvbo_vertoffset = -1;
 	//}
 
+	planeBounds.UpdatePlane(&w->wall);
+	planeBounds.UpdatePlane(&w->over);
+	planeBounds.UpdatePlane(&w->mask);
+
 	w->flags.empty = 0;
 	w->flags.uptodate = 1;
 	w->flags.invalidtex = 0;
@@ -993,6 +1017,9 @@ bool Build3DBoard::initsector(int16_t sectnum)
 	s->ceil.vertcount = sec->wallnum;
 	s->flags.empty = 1; // let updatesector know that everything needs to go
 
+	s->ceil.boundsIndex = sectorPlaneBounds[sectnum] + BUILD3D_PLANEBOUNDS_CEIL;
+	s->floor.boundsIndex = sectorPlaneBounds[sectnum] + BUILD3D_PLANEBOUNDS_FLOOR;
+
 	prsectors[sectnum] = s;
 
 	return true;
@@ -1454,6 +1481,9 @@ finish:
 		// TODO: Performance!!!! !!This does ANOTHER memcpy!!!
 		model->UpdateBuffer(s->floor.vbo_offset, sec->wallnum, s->floor.buffer, sectnum, true);
 		model->UpdateBuffer(s->ceil.vbo_offset, sec->wallnum, s->ceil.buffer, sectnum, true);
+
+		planeBounds.UpdatePlane(&s->floor);
+		planeBounds.UpdatePlane(&s->ceil);
 	}
 
 	s->flags.empty = 0;
@@ -1532,9 +1562,9 @@ bool  Build3DBoard::buildfloor(int16_t sectnum)
 
 	s->curindice = 0;
 
-	gluTessCallbackUWP(prtess, GLU_TESS_VERTEX_DATA, (void(*)(void))tessvertex);
-	gluTessCallbackUWP(prtess, GLU_TESS_EDGE_FLAG, (void(*)(void))tessedgeflag);
-	gluTessCallbackUWP(prtess, GLU_TESS_ERROR, (void(*)(void))tesserror);
+	gluTessCallbackUWP(prtess, GLU_TESS_VERTEX_DATA, (void *)tessvertex);
+	gluTessCallbackUWP(prtess, GLU_TESS_EDGE_FLAG, (void *)tessedgeflag);
+	gluTessCallbackUWP(prtess, GLU_TESS_ERROR, (void *)tesserror);
 
 	gluTessProperty(prtess, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_POSITIVE);
 
@@ -0,0 +1,266 @@
+// build3d_planebounds.cpp
+//
+
+#include "compat.h"
+#include "build3d.h"
+
+#include <xmmintrin.h>
+
+/*
+==========================================================
+
+Build3DPlaneBounds
+
+The culling loops in here touch every plane of every sector a light or the camera can see, walking the vertex
+buffers for that was most of the cost. The boxes are built once when updatesector or updatewall rebuilds a plane,
+and the loops only read the six arrays they need.
+
+This lives outside of build3d.cpp so it gets built with optimizations on.
+==========================================================
+*/
+
+// Left, right, top, bottom, near and far.
+#define BUILD3D_PLANEBOUNDS_MAXFRUSTUMPLANES	6
+
+/*
+================
+Build3DPlaneBounds::Build3DPlaneBounds
+================
+*/
+Build3DPlaneBounds::Build3DPlaneBounds()
+{
+	numPlanes = 0;
+	data = NULL;
+	minX = minY = minZ = NULL;
+	maxX = maxY = maxZ = NULL;
+}
+
+/*
+================
+Build3DPlaneBounds::~Build3DPlaneBounds
+================
+*/
+Build3DPlaneBounds::~Build3DPlaneBounds()
+{
+	if (data != NULL)
+	{
+		Baligned_free(data);
+		data = NULL;
+	}
+}
+
+/*
+================
+Build3DPlaneBounds::Init
+================
+*/
+void Build3DPlaneBounds::Init(int numPlanes)
+{
+	if (data != NULL)
+	{
+		Baligned_free(data);
+	}
+
+	this->numPlanes = numPlanes;
+
+	// A batch can start on any plane and always loads four, pad the arrays so the last batch stays inside of them.
+	int stride = ((numPlanes + 3) & ~3) + 4;
+
+	data = (float *)Xaligned_alloc(16, stride * 6 * sizeof(float));
+	minX = data;
+	minY = data + stride;
+	minZ = data + (stride * 2);
+	maxX = data + (stride * 3);
+	maxY = data + (stride * 4);
+	maxZ = data + (stride * 5);
+
+	for (int i = 0; i < stride; i++)
+	{
+		minX[i] = minY[i] = minZ[i] = FLT_MAX;
+		maxX[i] = maxY[i] = maxZ[i] = -FLT_MAX;
+	}
+}
+
+/*
+================
+Build3DPlaneBounds::UpdatePlane
+================
+*/
+void Build3DPlaneBounds::UpdatePlane(const Build3DPlane *plane)
+{
+	int index = plane->boundsIndex;
+
+	if (index < 0 || index >= numPlanes)
+		return;
+
+	float mins[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float maxs[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	if (plane->buffer != NULL)
+	{
+		for (int i = 0; i < plane->vertcount; i++)
+		{
+			const Build3DVector4 &position = plane->buffer[i].position;
+
+			mins[0] = min(mins[0], position.x);
+			mins[1] = min(mins[1], position.y);
+			mins[2] = min(mins[2], position.z);
+			maxs[0] = max(maxs[0], position.x);
+			maxs[1] = max(maxs[1], position.y);
+			maxs[2] = max(maxs[2], position.z);
+		}
+	}
+
+	minX[index] = mins[0];
+	minY[index] = mins[1];
+	minZ[index] = mins[2];
+	maxX[index] = maxs[0];
+	maxY[index] = maxs[1];
+	maxZ[index] = maxs[2];
+}
+
+/*
+================
+Build3DPlaneBounds::IsPlaneInBox
+================
+*/
+bool Build3DPlaneBounds::IsPlaneInBox(int index, const float *mins, const float *maxs) const
+{
+	return	minX[index] <= maxs[0] && maxX[index] >= mins[0] &&
+			minY[index] <= maxs[1] && maxY[index] >= mins[1] &&
+			minZ[index] <= maxs[2] && maxZ[index] >= mins[2];
+}
+
+/*
+================
+Build3DPlaneBounds::CullToBox
+================
+*/
+void Build3DPlaneBounds::CullToBox(int first, int count, const float *mins, const float *maxs, uint8_t *results) const
+{
+	const __m128 boxMinX = _mm_set1_ps(mins[0]);
+	const __m128 boxMinY = _mm_set1_ps(mins[1]);
+	const __m128 boxMinZ = _mm_set1_ps(mins[2]);
+	const __m128 boxMaxX = _mm_set1_ps(maxs[0]);
+	const __m128 boxMaxY = _mm_set1_ps(maxs[1]);
+	const __m128 boxMaxZ = _mm_set1_ps(maxs[2]);
+
+	for (int i = 0; i < count; i += 4)
+	{
+		int p = first + i;
+
+		__m128 inside = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&minX[p]), boxMaxX), _mm_cmpge_ps(_mm_loadu_ps(&maxX[p]), boxMinX));
+		inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&minY[p]), boxMaxY), _mm_cmpge_ps(_mm_loadu_ps(&maxY[p]), boxMinY)));
+		inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&minZ[p]), boxMaxZ), _mm_cmpge_ps(_mm_loadu_ps(&maxZ[p]), boxMinZ)));
+
+		int mask = _mm_movemask_ps(inside);
+		results[i + 0] = mask & 1;
+		results[i + 1] = (mask >> 1) & 1;
+		results[i + 2] = (mask >> 2) & 1;
+		results[i + 3] = (mask >> 3) & 1;
+	}
+}
+
+/*
+================
+Build3DPlaneBounds::CullToBoxScalar
+================
+*/
+void Build3DPlaneBounds::CullToBoxScalar(int first, int count, const float *mins, const float *maxs, uint8_t *results) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		results[i] = IsPlaneInBox(first + i, mins, maxs);
+	}
+}
+
+/*
+================
+Build3DPlaneBounds::CullToFrustum
+
+A box is outside if the corner furthest along the normal of any of the planes is behind it.
+================
+*/
+void Build3DPlaneBounds::CullToFrustum(int first, int count, const float *frustum, int numFrustumPlanes, uint8_t *results) const
+{
+	__m128 planeA[BUILD3D_PLANEBOUNDS_MAXFRUSTUMPLANES];
+	__m128 planeB[BUILD3D_PLANEBOUNDS_MAXFRUSTUMPLANES];
+	__m128 planeC[BUILD3D_PLANEBOUNDS_MAXFRUSTUMPLANES];
+	__m128 planeD[BUILD3D_PLANEBOUNDS_MAXFRUSTUMPLANES];
+	const float *cornerX[BUILD3D_PLANEBOUNDS_MAXFRUSTUMPLANES];
+	const float *cornerY[BUILD3D_PLANEBOUNDS_MAXFRUSTUMPLANES];
+	const float *cornerZ[BUILD3D_PLANEBOUNDS_MAXFRUSTUMPLANES];
+
+	numFrustumPlanes = min(numFrustumPlanes, BUILD3D_PLANEBOUNDS_MAXFRUSTUMPLANES);
+
+	// The sign of the normal picks the corner, which is the same for every box, so pick the arrays up front.
+	for (int f = 0; f < numFrustumPlanes; f++)
+	{
+		const float *plane = &frustum[f * 4];
+
+		planeA[f] = _mm_set1_ps(plane[0]);
+		planeB[f] = _mm_set1_ps(plane[1]);
+		planeC[f] = _mm_set1_ps(plane[2]);
+		planeD[f] = _mm_set1_ps(plane[3]);
+
+		cornerX[f] = (plane[0] >= 0.0f) ? maxX : minX;
+		cornerY[f] = (plane[1] >= 0.0f) ? maxY : minY;
+		cornerZ[f] = (plane[2] >= 0.0f) ? maxZ : minZ;
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int i = 0; i < count; i += 4)
+	{
+		int p = first + i;
+
+		// Planes without geometry have their mins past their maxs.
+		__m128 inside = _mm_cmple_ps(_mm_loadu_ps(&minX[p]), _mm_loadu_ps(&maxX[p]));
+
+		for (int f = 0; f < numFrustumPlanes; f++)
+		{
+			__m128 distance = _mm_mul_ps(planeA[f], _mm_loadu_ps(&cornerX[f][p]));
+			distance = _mm_add_ps(distance, _mm_mul_ps(planeB[f], _mm_loadu_ps(&cornerY[f][p])));
+			distance = _mm_add_ps(distance, _mm_mul_ps(planeC[f], _mm_loadu_ps(&cornerZ[f][p])));
+			distance = _mm_add_ps(distance, planeD[f]);
+
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		results[i + 0] = mask & 1;
+		results[i + 1] = (mask >> 1) & 1;
+		results[i + 2] = (mask >> 2) & 1;
+		results[i + 3] = (mask >> 3) & 1;
+	}
+}
+
+/*
+================
+Build3DPlaneBounds::CullToFrustumScalar
+================
+*/
+void Build3DPlaneBounds::CullToFrustumScalar(int first, int count, const float *frustum, int numFrustumPlanes, uint8_t *results) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		int p = first + i;
+
+		results[i] = minX[p] <= maxX[p];
+
+		for (int f = 0; f < numFrustumPlanes && results[i]; f++)
+		{
+			const float *plane = &frustum[f * 4];
+
+			float distance = plane[0] * ((plane[0] >= 0.0f) ? maxX[p] : minX[p]) +
+							 plane[1] * ((plane[1] >= 0.0f) ? maxY[p] : minY[p]) +
+							 plane[2] * ((plane[2] >= 0.0f) ? maxZ[p] : minZ[p]) +
+							 plane[3];
+
+			if (distance < 0.0f)
+			{
+				results[i] = 0;
+			}
+		}
+	}
+}
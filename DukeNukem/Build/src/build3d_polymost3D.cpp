@@ -12,7 +12,9 @@
 #include "engine_priv.h"
 #include "hightile.h"
 #include "polymost.h"
+#ifndef BUILD_RHI_NULL
 #include "polymer.h"
+#endif
 #include "cache1d.h"
 #include "kplib.h"
 #include "texcache.h"
@@ -23,6 +23,7 @@
 # define Bmemcpy memcpy
 # define Bassert assert
 # define bsize_t size_t
+# define BUILD_PROFILE_SCOPE(name)
 #else
 // cache1d.o for EDuke32
 # define C1D_STATIC static
@@ -36,6 +37,7 @@
 #include "pragmas.h"
 #include "baselayer.h"
 #include "crc32.h"
+#include "Profiler/profiler.h"
 
 #ifdef WITHKPLIB
 #include "kplib.h"
@@ -60,6 +62,8 @@ int32_t kpzbufsiz;
 
 int32_t kpzbufloadfil(int32_t const handle)
 {
+	BUILD_PROFILE_SCOPE("kpzbufloadfil");
+
 	int32_t const leng = kfilelength(handle);
 	if (leng > kpzbufsiz)
 	{
@@ -1110,6 +1114,8 @@ char const * kfileparent(int32_t const handle)
 
 int32_t kopen4load(const char *filename, char searchfirst)
 {
+	BUILD_PROFILE_SCOPE("kopen4load");
+
 	int32_t newhandle = MAXOPENFILES - 1;
 
 	if (filename == NULL)
@@ -1287,6 +1293,8 @@ void kclose_internal(int32_t handle, uint8_t *arraygrp, intptr_t *arrayhan)
 
 int32_t kread(int32_t handle, void *buffer, int32_t leng)
 {
+	BUILD_PROFILE_SCOPE("kread");
+
 	return kread_internal(handle, buffer, leng, filegrp, filehan, filepos);
 }
 int32_t klseek(int32_t handle, int32_t offset, int32_t whence)
@@ -1742,6 +1750,8 @@ C1D_STATIC int32_t c1d_read_compressed(void *buffer, bsize_t dasizeof, bsize_t c
 
 int32_t kdfread(void *buffer, bsize_t dasizeof, bsize_t count, int32_t fil)
 {
+	BUILD_PROFILE_SCOPE("kdfread");
+
 	return c1d_read_compressed(buffer, dasizeof, count, (intptr_t)fil);
 }
 
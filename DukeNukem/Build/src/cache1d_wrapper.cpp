@@ -8,6 +8,10 @@
 #endif
 #include "cache1d.h"
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
 FILE* fopen_mkdir(const char* name, const char* mode) 
 {
 	char* mname = strdup(name);
@@ -283,4 +287,116 @@ void BuildFile::WriteString(const char *string)
 	int len = strlen(string);
 	WriteInt(len);
 	fwrite(string, 1, len, file);
-}
\ No newline at end of file
+}
+
+//
+// BuildMappedFile::BuildMappedFile
+//
+BuildMappedFile::BuildMappedFile()
+{
+	data = NULL;
+	length = 0;
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = NULL;
+#endif
+}
+
+//
+// BuildMappedFile::~BuildMappedFile
+//
+BuildMappedFile::~BuildMappedFile()
+{
+#ifdef _WIN32
+	if (data != NULL)
+		UnmapViewOfFile(data);
+	if (mappingHandle != NULL)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+#else
+	if (data != NULL)
+		munmap((void *)data, (size_t)length);
+#endif
+}
+
+//
+// BuildMappedFile::OpenFile
+//
+BuildMappedFile *BuildMappedFile::OpenFile(const char *fileName)
+{
+	char *fullPath = NULL;
+
+	if (findfrompath(fileName, &fullPath) < 0 || fullPath == NULL)
+		return NULL;
+
+	BuildMappedFile *mappedFile = new BuildMappedFile();
+
+#ifdef _WIN32
+	wchar_t widePath[BMAX_PATH];
+	MultiByteToWideChar(CP_UTF8, 0, fullPath, -1, widePath, BMAX_PATH);
+	Bfree(fullPath);
+
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+	mappedFile->fileHandle = CreateFileW(widePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+#else
+	mappedFile->fileHandle = CreateFile2(widePath, GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, NULL);
+#endif
+	if (mappedFile->fileHandle == INVALID_HANDLE_VALUE)
+	{
+		delete mappedFile;
+		return NULL;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(mappedFile->fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		delete mappedFile;
+		return NULL;
+	}
+	mappedFile->length = fileSize.QuadPart;
+
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+	mappedFile->mappingHandle = CreateFileMappingW(mappedFile->fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappedFile->mappingHandle != NULL)
+		mappedFile->data = (const uint8_t *)MapViewOfFile(mappedFile->mappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+	mappedFile->mappingHandle = CreateFileMappingFromApp(mappedFile->fileHandle, NULL, PAGE_READONLY, 0, NULL);
+	if (mappedFile->mappingHandle != NULL)
+		mappedFile->data = (const uint8_t *)MapViewOfFileFromApp(mappedFile->mappingHandle, FILE_MAP_READ, 0, 0);
+#endif
+#else
+	int fd = open(fullPath, O_RDONLY);
+	Bfree(fullPath);
+
+	if (fd < 0)
+	{
+		delete mappedFile;
+		return NULL;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) < 0 || st.st_size == 0)
+	{
+		close(fd);
+		delete mappedFile;
+		return NULL;
+	}
+	mappedFile->length = st.st_size;
+
+	// The mapping keeps its own reference to the file.
+	void *view = mmap(NULL, (size_t)mappedFile->length, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (view != MAP_FAILED)
+		mappedFile->data = (const uint8_t *)view;
+#endif
+
+	if (mappedFile->data == NULL)
+	{
+		delete mappedFile;
+		return NULL;
+	}
+
+	return mappedFile;
+}
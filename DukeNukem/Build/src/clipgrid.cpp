@@ -0,0 +1,892 @@
+// clipgrid.cpp
+//
+
+#include "compat.h"
+#include "build.h"
+#include "osd.h"
+#include "baselayer.h"
+#include "engine_priv.h"
+#include "clipgrid.h"
+
+#include <math.h>
+
+int32_t clipgrid_enable = 1;
+int32_t clipgrid_check = 0;
+int32_t clipgrid_tracing = 0;
+clipgridstats_t clipgridstats;
+
+int16_t clipgridcand[MAXSPRITES];
+int32_t clipgridquerygen = 0;
+int32_t clipgridsectgen[MAXSECTORS];
+int32_t clipgridsectstart[MAXSECTORS], clipgridsectend[MAXSECTORS];
+int8_t clipgridactive = 0;
+
+// Bucket index used for the wide list.
+#define CLIPGRID_WIDE			CLIPGRID_HASHSIZE
+
+// Per sprite state, gridbucket is -1 for sprites that aren't in a sector list.
+static int16_t gridhead[CLIPGRID_HASHSIZE+1];
+static int16_t gridnext[MAXSPRITES], gridprev[MAXSPRITES];
+static int16_t gridbucket[MAXSPRITES];
+static int16_t gridsect[MAXSPRITES];
+static int32_t gridradius[MAXSPRITES];
+
+// Position and shape each sprite was bucketed with. The game writes x/y and sizes directly, every query
+// rebuckets whatever no longer matches before gathering.
+static int32_t gridx[MAXSPRITES], gridy[MAXSPRITES];
+static uint64_t gridshape[MAXSPRITES];
+
+// Indexed sprites packed together for that check, gridslot is a sprite's index in gridsprites.
+static int16_t gridsprites[MAXSPRITES];
+static int16_t gridslot[MAXSPRITES];
+
+// Position in the sector list, smaller ranks come first. Inserts go to the head of a list, so they take
+// one less than the current head.
+static uint32_t gridrank[MAXSPRITES];
+#define CLIPGRID_BASERANK		0x40000000u
+
+static int32_t gridnumsprites;
+static int32_t gridminx, gridminy, gridmaxx, gridmaxy;
+static int32_t gridsyncclock;
+static int32_t gridinvalid = 1;
+
+// Sprites already gathered by the current query.
+static int32_t gridvisitgen[MAXSPRITES];
+
+static uint64_t gridkeys[MAXSPRITES];
+static int32_t numgridkeys;
+
+//
+// clipgrid_hash
+//
+FORCE_INLINE int32_t clipgrid_hash(int32_t cx, int32_t cy)
+{
+    return (int32_t)(((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u)) & (CLIPGRID_HASHSIZE-1);
+}
+
+//
+// clipgrid_shapekey
+//
+// Everything of a sprite's own that clipgrid_spriteradius reads.
+//
+FORCE_INLINE uint64_t clipgrid_shapekey(const spritetype *spr)
+{
+    return (uint64_t)(uint16_t)spr->picnum | ((uint64_t)(spr->cstat&48)<<16) | ((uint64_t)spr->xrepeat<<24) |
+           ((uint64_t)spr->yrepeat<<32) | ((uint64_t)(uint8_t)spr->xoffset<<40) | ((uint64_t)(uint8_t)spr->yoffset<<48);
+}
+
+//
+// clipgrid_link
+//
+static void clipgrid_link(int16_t spritenum, int32_t bucket)
+{
+    const int16_t ohead = gridhead[bucket];
+
+    gridprev[spritenum] = -1;
+    gridnext[spritenum] = ohead;
+    if (ohead >= 0)
+        gridprev[ohead] = spritenum;
+    gridhead[bucket] = spritenum;
+    gridbucket[spritenum] = bucket;
+}
+
+//
+// clipgrid_unlink
+//
+static void clipgrid_unlink(int16_t spritenum)
+{
+    const int32_t bucket = gridbucket[spritenum];
+    const int16_t prev = gridprev[spritenum], next = gridnext[spritenum];
+
+    if (bucket < 0)
+        return;
+
+    if (gridhead[bucket] == spritenum)
+        gridhead[bucket] = next;
+    if (prev >= 0)
+        gridnext[prev] = next;
+    if (next >= 0)
+        gridprev[next] = prev;
+
+    gridbucket[spritenum] = -1;
+}
+
+//
+// clipgrid_place
+//
+// Puts an indexed sprite into the bucket matching its current position and shape.
+//
+static void clipgrid_place(int16_t spritenum)
+{
+    const spritetype *const spr = &sprite[spritenum];
+    const int32_t radius = clipgrid_spriteradius(spr);
+    int32_t bucket;
+
+    if (radius < 0 || radius > CLIPGRID_MAXRADIUS)
+        bucket = CLIPGRID_WIDE;
+    else
+        bucket = clipgrid_hash(spr->x>>CLIPGRID_CELLSHIFT, spr->y>>CLIPGRID_CELLSHIFT);
+
+    gridradius[spritenum] = radius;
+    gridx[spritenum] = spr->x;
+    gridy[spritenum] = spr->y;
+    gridshape[spritenum] = clipgrid_shapekey(spr);
+
+    if (bucket != gridbucket[spritenum])
+    {
+        clipgrid_unlink(spritenum);
+        clipgrid_link(spritenum, bucket);
+        clipgridstats.rebuckets++;
+    }
+
+    if (bucket != CLIPGRID_WIDE)
+    {
+        gridminx = min(gridminx, spr->x); gridmaxx = max(gridmaxx, spr->x);
+        gridminy = min(gridminy, spr->y); gridmaxy = max(gridmaxy, spr->y);
+    }
+}
+
+//
+// clipgrid_add
+//
+static void clipgrid_add(int16_t spritenum)
+{
+    gridslot[spritenum] = gridnumsprites;
+    gridsprites[gridnumsprites++] = spritenum;
+}
+
+//
+// clipgrid_remove
+//
+static void clipgrid_remove(int16_t spritenum)
+{
+    const int16_t last = gridsprites[--gridnumsprites];
+
+    gridsprites[gridslot[spritenum]] = last;
+    gridslot[last] = gridslot[spritenum];
+
+    clipgrid_unlink(spritenum);
+    gridsect[spritenum] = -1;
+}
+
+//
+// clipgrid_reset
+//
+void clipgrid_reset(void)
+{
+    int32_t i;
+
+    for (i=0; i<=CLIPGRID_HASHSIZE; i++)
+        gridhead[i] = -1;
+
+    for (i=0; i<MAXSPRITES; i++)
+    {
+        gridbucket[i] = -1;
+        gridsect[i] = -1;
+        gridvisitgen[i] = 0;
+    }
+
+    gridnumsprites = 0;
+    gridminx = gridminy = INT32_MAX;
+    gridmaxx = gridmaxy = INT32_MIN;
+    gridinvalid = 1;
+}
+
+//
+// clipgrid_invalidate
+//
+// For code that rewrites the sprite lists wholesale (savegames, snapshots), forces a sync before the next query.
+//
+void clipgrid_invalidate(void)
+{
+    gridinvalid = 1;
+}
+
+//
+// clipgrid_insertsprite
+//
+void clipgrid_insertsprite(int16_t spritenum, int16_t sectnum)
+{
+    const int16_t next = nextspritesect[spritenum];
+
+    // changespritesect() can park sprites in the MAXSECTORS list, which no query looks at.
+    if (sectnum >= MAXSECTORS)
+    {
+        clipgrid_deletesprite(spritenum);
+        return;
+    }
+
+    gridrank[spritenum] = (next >= 0 && gridsect[next] == sectnum) ? gridrank[next]-1 : CLIPGRID_BASERANK;
+    gridsect[spritenum] = sectnum;
+
+    if (gridbucket[spritenum] < 0)
+        clipgrid_add(spritenum);
+
+    clipgrid_place(spritenum);
+}
+
+//
+// clipgrid_deletesprite
+//
+void clipgrid_deletesprite(int16_t spritenum)
+{
+    if (gridbucket[spritenum] < 0)
+        return;
+
+    clipgrid_remove(spritenum);
+}
+
+//
+// clipgrid_updatesprite
+//
+void clipgrid_updatesprite(int16_t spritenum)
+{
+    if (gridbucket[spritenum] >= 0)
+        clipgrid_place(spritenum);
+}
+
+//
+// clipgrid_sync
+//
+// Walks every sector list and renumbers the list order. Anything left over from lists that were overwritten
+// wholesale gets dropped.
+//
+static void clipgrid_sync(void)
+{
+    int32_t i, j;
+    const int32_t gen = ++clipgridquerygen;
+
+    gridminx = gridminy = INT32_MAX;
+    gridmaxx = gridmaxy = INT32_MIN;
+
+    for (i=0; i<numsectors; i++)
+    {
+        uint32_t rank = CLIPGRID_BASERANK;
+
+        for (j=headspritesect[i]; j>=0; j=nextspritesect[j])
+        {
+            if (gridbucket[j] < 0)
+                clipgrid_add(j);
+
+            gridsect[j] = i;
+            gridrank[j] = rank++;
+            gridvisitgen[j] = gen;
+
+            clipgrid_place(j);
+        }
+    }
+
+    for (j=0; j<MAXSPRITES; j++)
+    {
+        if (gridbucket[j] >= 0 && gridvisitgen[j] != gen)
+            clipgrid_remove(j);
+    }
+
+    gridsyncclock = totalclock;
+    gridinvalid = 0;
+    clipgridstats.syncs++;
+}
+
+//
+// clipgrid_refresh
+//
+// Rebuckets the sprites the game moved or reshaped by writing to them directly since they were placed, so
+// the buckets match what the narrow phase will test.
+//
+static void clipgrid_refresh(void)
+{
+    for (int32_t i=0; i<gridnumsprites; i++)
+    {
+        const int16_t j = gridsprites[i];
+        const spritetype *const spr = &sprite[j];
+
+        if (spr->x != gridx[j] || spr->y != gridy[j] || clipgrid_shapekey(spr) != gridshape[j])
+            clipgrid_place(j);
+    }
+}
+
+//
+// clipgrid_beginquery
+//
+static int32_t clipgrid_beginquery(void)
+{
+    clipgridactive = 0;
+
+    if (!clipgrid_enable || editstatus)
+        return 0;
+
+    if (gridinvalid || gridsyncclock != totalclock)
+        clipgrid_sync();
+
+    if (gridnumsprites < CLIPGRID_MINSPRITES)
+        return 0;
+
+    clipgrid_refresh();
+
+    clipgridquerygen++;
+    numgridkeys = 0;
+
+    return 1;
+}
+
+//
+// clipgrid_gather
+//
+FORCE_INLINE void clipgrid_gather(int16_t spritenum)
+{
+    if (gridvisitgen[spritenum] == clipgridquerygen)
+        return;
+    gridvisitgen[spritenum] = clipgridquerygen;
+
+    gridkeys[numgridkeys++] = ((uint64_t)gridsect[spritenum]<<47) | ((uint64_t)gridrank[spritenum]<<15) | (uint64_t)spritenum;
+}
+
+//
+// clipgrid_compare
+//
+static int clipgrid_compare(const void *a, const void *b)
+{
+    const uint64_t ka = *(const uint64_t *)a, kb = *(const uint64_t *)b;
+    return (ka > kb) - (ka < kb);
+}
+
+//
+// clipgrid_endquery
+//
+// Sorts the gathered sprites into sector list order and builds the per sector ranges.
+//
+static void clipgrid_endquery(void)
+{
+    int32_t i, j;
+
+    if (numgridkeys <= 32)
+    {
+        for (i=1; i<numgridkeys; i++)
+        {
+            const uint64_t key = gridkeys[i];
+            for (j=i-1; j>=0 && gridkeys[j] > key; j--)
+                gridkeys[j+1] = gridkeys[j];
+            gridkeys[j+1] = key;
+        }
+    }
+    else
+    {
+        qsort(gridkeys, numgridkeys, sizeof(gridkeys[0]), clipgrid_compare);
+    }
+
+    for (i=0; i<numgridkeys; i++)
+    {
+        const int32_t sectnum = (int32_t)(gridkeys[i]>>47);
+
+        clipgridcand[i] = (int16_t)(gridkeys[i] & 32767);
+
+        if (clipgridsectgen[sectnum] != clipgridquerygen)
+        {
+            clipgridsectgen[sectnum] = clipgridquerygen;
+            clipgridsectstart[sectnum] = i;
+        }
+        clipgridsectend[sectnum] = i+1;
+    }
+
+    clipgridstats.candidates += numgridkeys;
+    clipgridactive = 1;
+}
+
+//
+// clipgrid_beginbox
+//
+void clipgrid_beginbox(int32_t xmin, int32_t ymin, int32_t xmax, int32_t ymax)
+{
+    int32_t j;
+
+    if (!clipgrid_beginquery())
+    {
+        clipgridstats.listqueries++;
+        return;
+    }
+
+    const int32_t margin = CLIPGRID_MAXRADIUS;
+    const int32_t cx1 = (max(xmin, gridminx)-margin)>>CLIPGRID_CELLSHIFT, cx2 = (min(xmax, gridmaxx)+margin)>>CLIPGRID_CELLSHIFT;
+    const int32_t cy1 = (max(ymin, gridminy)-margin)>>CLIPGRID_CELLSHIFT, cy2 = (min(ymax, gridmaxy)+margin)>>CLIPGRID_CELLSHIFT;
+
+    // A box covering most of the map touches every bucket anyway.
+    const int32_t numcells = (cx2 >= cx1 && cy2 >= cy1) ? (cx2-cx1+1)*(cy2-cy1+1) : 0;
+    const int32_t numbuckets = (numcells > CLIPGRID_HASHSIZE) ? CLIPGRID_HASHSIZE : numcells;
+
+    for (int32_t n=0; n<numbuckets; n++)
+    {
+        const int32_t bucket = (numcells > CLIPGRID_HASHSIZE) ? n :
+            clipgrid_hash(cx1 + n%(cx2-cx1+1), cy1 + n/(cx2-cx1+1));
+
+        for (j=gridhead[bucket]; j>=0; j=gridnext[j])
+        {
+            const spritetype *const spr = &sprite[j];
+            const int32_t r = gridradius[j];
+
+            if (spr->x+r < xmin || spr->x-r > xmax || spr->y+r < ymin || spr->y-r > ymax)
+                continue;
+
+            clipgrid_gather(j);
+        }
+    }
+
+    for (j=gridhead[CLIPGRID_WIDE]; j>=0; j=gridnext[j])
+    {
+        const spritetype *const spr = &sprite[j];
+        const int32_t r = gridradius[j];
+
+        if (gridradius[j] >= 0 && (spr->x+r < xmin || spr->x-r > xmax || spr->y+r < ymin || spr->y-r > ymax))
+            continue;
+
+        clipgrid_gather(j);
+    }
+
+    clipgridstats.boxqueries++;
+    clipgrid_endquery();
+}
+
+//
+// clipgrid_segdistsq
+//
+FORCE_INLINE double clipgrid_segdistsq(double px, double py, double x0, double y0, double x1, double y1)
+{
+    const double dx = x1-x0, dy = y1-y0;
+    const double len = dx*dx + dy*dy;
+    double t = 0.0;
+
+    if (len > 0.0)
+    {
+        t = ((px-x0)*dx + (py-y0)*dy) / len;
+        t = (t < 0.0) ? 0.0 : ((t > 1.0) ? 1.0 : t);
+    }
+
+    const double ex = x0 + t*dx - px, ey = y0 + t*dy - py;
+    return ex*ex + ey*ey;
+}
+
+//
+// clipgrid_beginray
+//
+// Gathers everything within reach of the ray from sv along (vx,vy), up to where it leaves the area the
+// indexed sprites cover.
+//
+void clipgrid_beginray(const vec3_t *sv, int32_t vx, int32_t vy)
+{
+    int32_t j;
+
+    if (!clipgrid_beginquery())
+    {
+        clipgridstats.listqueries++;
+        return;
+    }
+
+    const double margin = CLIPGRID_MAXRADIUS;
+    const double bx0 = (double)gridminx-margin, bx1 = (double)gridmaxx+margin;
+    const double by0 = (double)gridminy-margin, by1 = (double)gridmaxy+margin;
+    double t0 = 0.0, t1 = 1e30;
+    int32_t hitbox = (gridminx <= gridmaxx);
+
+    // Clip the ray against the grid bounds.
+    if (vx != 0)
+    {
+        double ta = (bx0-sv->x)/vx, tb = (bx1-sv->x)/vx;
+        if (ta > tb) { double t = ta; ta = tb; tb = t; }
+        t0 = max(t0, ta); t1 = min(t1, tb);
+    }
+    else if (sv->x < bx0 || sv->x > bx1)
+        hitbox = 0;
+
+    if (vy != 0)
+    {
+        double ta = (by0-sv->y)/vy, tb = (by1-sv->y)/vy;
+        if (ta > tb) { double t = ta; ta = tb; tb = t; }
+        t0 = max(t0, ta); t1 = min(t1, tb);
+    }
+    else if (sv->y < by0 || sv->y > by1)
+        hitbox = 0;
+
+    if (vx == 0 && vy == 0)
+        t1 = t0;
+
+    if (hitbox && t0 <= t1)
+    {
+        const double x0 = sv->x + t0*vx, y0 = sv->y + t0*vy;
+        const double x1 = sv->x + t1*vx, y1 = sv->y + t1*vy;
+        const double sxmin = min(x0, x1), sxmax = max(x0, x1);
+        const int32_t cx1 = (int32_t)floor((sxmin-margin)/CLIPGRID_CELLSIZE);
+        const int32_t cx2 = (int32_t)floor((sxmax+margin)/CLIPGRID_CELLSIZE);
+        int32_t numbuckets = 0;
+
+        // Walk the columns the fattened segment crosses, each one only spans a few cells in y.
+        for (int32_t cx=cx1; cx<=cx2 && numbuckets<CLIPGRID_HASHSIZE*2; cx++)
+        {
+            const double colx0 = max((double)cx*CLIPGRID_CELLSIZE - margin, sxmin);
+            const double colx1 = min((double)(cx+1)*CLIPGRID_CELLSIZE + margin, sxmax);
+            double ylo, yhi;
+
+            if (colx0 > colx1)
+                continue;
+
+            if (x1 - x0 > -1.0 && x1 - x0 < 1.0)
+            {
+                ylo = min(y0, y1); yhi = max(y0, y1);
+            }
+            else
+            {
+                const double slope = (y1-y0)/(x1-x0);
+                const double ya = y0 + (colx0-x0)*slope, yb = y0 + (colx1-x0)*slope;
+                ylo = min(ya, yb); yhi = max(ya, yb);
+            }
+
+            const int32_t cy1 = (int32_t)floor((ylo-margin)/CLIPGRID_CELLSIZE);
+            const int32_t cy2 = (int32_t)floor((yhi+margin)/CLIPGRID_CELLSIZE);
+
+            for (int32_t cy=cy1; cy<=cy2; cy++, numbuckets++)
+            {
+                for (j=gridhead[clipgrid_hash(cx, cy)]; j>=0; j=gridnext[j])
+                {
+                    const spritetype *const spr = &sprite[j];
+                    const double r = gridradius[j];
+
+                    if (clipgrid_segdistsq(spr->x, spr->y, x0, y0, x1, y1) > r*r)
+                        continue;
+
+                    clipgrid_gather(j);
+                }
+            }
+        }
+
+        if (numbuckets >= CLIPGRID_HASHSIZE*2)
+        {
+            // Degenerate ray, take everything.
+            for (int32_t bucket=0; bucket<CLIPGRID_HASHSIZE; bucket++)
+                for (j=gridhead[bucket]; j>=0; j=gridnext[j])
+                    clipgrid_gather(j);
+        }
+    }
+
+    for (j=gridhead[CLIPGRID_WIDE]; j>=0; j=gridnext[j])
+        clipgrid_gather(j);
+
+    clipgridstats.rayqueries++;
+    clipgrid_endquery();
+}
+
+////////// Regression harness //////////
+
+#define CLIPGRID_TRACE_CLIPMOVE		0
+#define CLIPGRID_TRACE_GETZRANGE	1
+#define CLIPGRID_TRACE_HITSCAN		2
+
+#define CLIPGRID_TRACE_MAGIC		"CLIPGRIDTRACE01"
+
+typedef struct
+{
+    int32_t type;
+    vec3_t pos;
+    int32_t sectnum;
+    int32_t vx, vy, vz;
+    int32_t walldist, ceildist, flordist;
+    uint32_t cliptype;
+} clipgridtrace_t;
+
+typedef struct
+{
+    int32_t ret;
+    vec3_t pos;
+    int32_t sectnum;
+    int32_t ceilz, ceilhit, florz, florhit;
+    hitdata_t hit;
+} clipgridresult_t;
+
+static FILE *clipgridtracefp = NULL;
+static double clipgridtimelist, clipgridtimegrid;
+
+//
+// clipgrid_updatetracing
+//
+static void clipgrid_updatetracing(void)
+{
+    clipgrid_tracing = (clipgridtracefp != NULL || clipgrid_check);
+}
+
+//
+// clipgrid_run
+//
+// Runs a traced call with the grid either on or off.
+//
+static void clipgrid_run(const clipgridtrace_t *tr, clipgridresult_t *res, int32_t usegrid)
+{
+    const int32_t oenable = clipgrid_enable;
+    const double starttime = gethiticks();
+
+    Bmemset(res, 0, sizeof(clipgridresult_t));
+    clipgrid_enable = usegrid;
+
+    switch (tr->type)
+    {
+    case CLIPGRID_TRACE_CLIPMOVE:
+    {
+        int16_t sectnum = (int16_t)tr->sectnum;
+        res->pos = tr->pos;
+        res->ret = clipmove_internal(&res->pos, &sectnum, tr->vx, tr->vy, tr->walldist, tr->ceildist, tr->flordist, tr->cliptype);
+        res->sectnum = sectnum;
+        break;
+    }
+    case CLIPGRID_TRACE_GETZRANGE:
+        getzrange_internal(&tr->pos, (int16_t)tr->sectnum, &res->ceilz, &res->ceilhit, &res->florz, &res->florhit,
+                           tr->walldist, tr->cliptype);
+        break;
+    case CLIPGRID_TRACE_HITSCAN:
+        res->ret = hitscan_internal(&tr->pos, (int16_t)tr->sectnum, tr->vx, tr->vy, tr->vz, &res->hit, tr->cliptype);
+        break;
+    }
+
+    clipgrid_enable = oenable;
+
+    if (usegrid)
+        clipgridtimegrid += gethiticks()-starttime;
+    else
+        clipgridtimelist += gethiticks()-starttime;
+}
+
+//
+// clipgrid_compareresults
+//
+static int32_t clipgrid_compareresults(const clipgridtrace_t *tr, const clipgridresult_t *a, const clipgridresult_t *b)
+{
+    static const char *names[] = { "clipmove", "getzrange", "hitscan" };
+
+    if (Bmemcmp(a, b, sizeof(clipgridresult_t)) == 0)
+        return 0;
+
+    clipgridstats.mismatches++;
+    if (clipgridstats.mismatches <= 16)
+        initprintf("clipgrid: %s mismatch at (%d,%d,%d) sect %d\n", names[tr->type], tr->pos.x, tr->pos.y, tr->pos.z, tr->sectnum);
+
+    return 1;
+}
+
+//
+// clipgrid_trace
+//
+static void clipgrid_trace(const clipgridtrace_t *tr, clipgridresult_t *res)
+{
+    if (clipgridtracefp)
+        Bfwrite(tr, sizeof(clipgridtrace_t), 1, clipgridtracefp);
+
+    clipgrid_run(tr, res, 0);
+
+    if (clipgrid_check)
+    {
+        clipgridresult_t gridres;
+
+        clipgrid_run(tr, &gridres, 1);
+        clipgridstats.checkedcalls++;
+        clipgrid_compareresults(tr, res, &gridres);
+
+        // The grid run left its own state in the clip globals, put the reference run's back.
+        clipgrid_run(tr, res, 0);
+    }
+}
+
+//
+// clipgrid_traceclipmove
+//
+int32_t clipgrid_traceclipmove(vec3_t *pos, int16_t *sectnum, int32_t xvect, int32_t yvect,
+                               int32_t walldist, int32_t ceildist, int32_t flordist, uint32_t cliptype)
+{
+    clipgridtrace_t tr;
+    clipgridresult_t res;
+
+    Bmemset(&tr, 0, sizeof(tr));
+    tr.type = CLIPGRID_TRACE_CLIPMOVE;
+    tr.pos = *pos; tr.sectnum = *sectnum;
+    tr.vx = xvect; tr.vy = yvect;
+    tr.walldist = walldist; tr.ceildist = ceildist; tr.flordist = flordist;
+    tr.cliptype = cliptype;
+
+    clipgrid_trace(&tr, &res);
+
+    *pos = res.pos;
+    *sectnum = (int16_t)res.sectnum;
+    return res.ret;
+}
+
+//
+// clipgrid_tracegetzrange
+//
+void clipgrid_tracegetzrange(const vec3_t *pos, int16_t sectnum, int32_t *ceilz, int32_t *ceilhit, int32_t *florz,
+                             int32_t *florhit, int32_t walldist, uint32_t cliptype)
+{
+    clipgridtrace_t tr;
+    clipgridresult_t res;
+
+    Bmemset(&tr, 0, sizeof(tr));
+    tr.type = CLIPGRID_TRACE_GETZRANGE;
+    tr.pos = *pos; tr.sectnum = sectnum;
+    tr.walldist = walldist;
+    tr.cliptype = cliptype;
+
+    clipgrid_trace(&tr, &res);
+
+    *ceilz = res.ceilz; *ceilhit = res.ceilhit;
+    *florz = res.florz; *florhit = res.florhit;
+}
+
+//
+// clipgrid_tracehitscan
+//
+int32_t clipgrid_tracehitscan(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32_t vz,
+                              hitdata_t *hit, uint32_t cliptype)
+{
+    clipgridtrace_t tr;
+    clipgridresult_t res;
+
+    Bmemset(&tr, 0, sizeof(tr));
+    tr.type = CLIPGRID_TRACE_HITSCAN;
+    tr.pos = *sv; tr.sectnum = sectnum;
+    tr.vx = vx; tr.vy = vy; tr.vz = vz;
+    tr.cliptype = cliptype;
+
+    clipgrid_trace(&tr, &res);
+
+    *hit = res.hit;
+    return res.ret;
+}
+
+//
+// osdcmd_clipgrid_record
+//
+static int32_t osdcmd_clipgrid_record(const osdfuncparm_t *parm)
+{
+    if (clipgridtracefp)
+    {
+        Bfclose(clipgridtracefp);
+        clipgridtracefp = NULL;
+        initprintf("clipgrid_record: stopped\n");
+    }
+
+    if (parm->numparms == 1)
+    {
+        clipgridtracefp = Bfopen(parm->parms[0], "wb");
+        if (!clipgridtracefp)
+        {
+            initprintf("clipgrid_record: couldn't open \"%s\"\n", parm->parms[0]);
+        }
+        else
+        {
+            Bfwrite(CLIPGRID_TRACE_MAGIC, 16, 1, clipgridtracefp);
+            initprintf("clipgrid_record: recording to \"%s\"\n", parm->parms[0]);
+        }
+    }
+
+    clipgrid_updatetracing();
+    return OSDCMD_OK;
+}
+
+//
+// osdcmd_clipgrid_replay
+//
+// Replays a recorded trace against the loaded map with and without the grid and compares the results.
+//
+static int32_t osdcmd_clipgrid_replay(const osdfuncparm_t *parm)
+{
+    char magic[16];
+    clipgridtrace_t tr;
+    clipgridresult_t listres, gridres;
+    int32_t numcalls = 0, nummismatches = 0;
+
+    if (parm->numparms != 1)
+        return OSDCMD_SHOWHELP;
+
+    FILE *fp = Bfopen(parm->parms[0], "rb");
+    if (!fp)
+    {
+        initprintf("clipgrid_replay: couldn't open \"%s\"\n", parm->parms[0]);
+        return OSDCMD_OK;
+    }
+
+    if (Bfread(magic, 16, 1, fp) != 1 || Bmemcmp(magic, CLIPGRID_TRACE_MAGIC, 16))
+    {
+        initprintf("clipgrid_replay: \"%s\" isn't a clipgrid trace\n", parm->parms[0]);
+        Bfclose(fp);
+        return OSDCMD_OK;
+    }
+
+    clipgridtimelist = clipgridtimegrid = 0.0;
+
+    while (Bfread(&tr, sizeof(tr), 1, fp) == 1)
+    {
+        if ((unsigned)tr.type > CLIPGRID_TRACE_HITSCAN || (unsigned)tr.sectnum >= (unsigned)numsectors)
+            continue;
+
+        clipgrid_run(&tr, &listres, 0);
+        clipgrid_run(&tr, &gridres, 1);
+
+        nummismatches += clipgrid_compareresults(&tr, &listres, &gridres);
+        numcalls++;
+    }
+
+    Bfclose(fp);
+
+    initprintf("clipgrid_replay: %d calls, %d mismatches, sector lists %.2fms, grid %.2fms\n",
+               numcalls, nummismatches, clipgridtimelist, clipgridtimegrid);
+
+    return OSDCMD_OK;
+}
+
+//
+// osdcmd_clipgrid_stats
+//
+static int32_t osdcmd_clipgrid_stats(const osdfuncparm_t *parm)
+{
+    const uint32_t numqueries = clipgridstats.boxqueries + clipgridstats.rayqueries;
+
+    UNREFERENCED_PARAMETER(parm);
+
+    initprintf("-------- clipgrid stats ---------\n");
+    initprintf("Indexed sprites: %d\n", gridnumsprites);
+    initprintf("Box queries: %u, ray queries: %u, list queries: %u\n",
+               clipgridstats.boxqueries, clipgridstats.rayqueries, clipgridstats.listqueries);
+    initprintf("Candidates per query: %.2f\n", numqueries ? (double)clipgridstats.candidates / numqueries : 0.0);
+    initprintf("Syncs: %u, rebuckets: %u\n", clipgridstats.syncs, clipgridstats.rebuckets);
+    initprintf("Checked calls: %u, mismatches: %u\n", clipgridstats.checkedcalls, clipgridstats.mismatches);
+
+    return OSDCMD_OK;
+}
+
+//
+// osdcmd_clipgrid_cvar
+//
+static int32_t osdcmd_clipgrid_cvar(const osdfuncparm_t *parm)
+{
+    const int32_t r = osdcmd_cvar_set(parm);
+
+    clipgrid_updatetracing();
+    return r;
+}
+
+//
+// clipgrid_initosd
+//
+void clipgrid_initosd(void)
+{
+    static cvar_t cvars_clipgrid[] =
+    {
+        { "clipgrid", "enable/disable the sprite grid used by clipmove, getzrange and hitscan", (void *) &clipgrid_enable, CVAR_BOOL, 0, 1 },
+        { "clipgrid_check", "run clipping queries with and without the sprite grid and report differences", (void *) &clipgrid_check, CVAR_BOOL, 0, 1 },
+    };
+
+    for (uint32_t i=0; i<ARRAY_SIZE(cvars_clipgrid); i++)
+    {
+        if (OSD_RegisterCvar(&cvars_clipgrid[i]))
+            continue;
+
+        OSD_RegisterFunction(cvars_clipgrid[i].name, cvars_clipgrid[i].desc, osdcmd_clipgrid_cvar);
+    }
+
+    OSD_RegisterFunction("clipgrid_record", "clipgrid_record [file]: records clipping queries to a trace file, no file stops recording", osdcmd_clipgrid_record);
+    OSD_RegisterFunction("clipgrid_replay", "clipgrid_replay <file>: replays a clipping trace with and without the sprite grid", osdcmd_clipgrid_replay);
+    OSD_RegisterFunction("clipgrid_stats", "clipgrid_stats: prints sprite grid statistics", osdcmd_clipgrid_stats);
+}
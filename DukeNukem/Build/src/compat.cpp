@@ -35,8 +35,6 @@
 # include <sys/sysctl.h> // for sysctl() to get path to executable
 #endif
 
-#include "baselayer.h"
-
 ////////// PANICKING ALLOCATION FUNCTIONS //////////
 
 static void (*g_MemErrHandler)(int32_t line, const char *file, const char *func);
@@ -245,12 +243,12 @@ typedef BOOL (WINAPI * aSHGetSpecialFolderPathAtype)(HWND, LPTSTR, int, BOOL);
 
 char *Bgethomedir(void)
 {
-	return "Assets";
+	return Bstrdup("Assets");
 }
 
 char *Bgetappdir(void)
 {
-	return "Assets";
+	return Bstrdup("Assets");
 }
 
 int32_t Bcorrectfilename(char *filename, int32_t removefn)
@@ -18,7 +18,9 @@
 #include "colmatch.h"
 
 // jmarshall
+#ifndef BUILD_HEADLESS
 #include "PolymerNG/PolymerNG.h"
+#endif
 // jmarshall end
 
 #ifdef USE_OPENGL
@@ -1458,6 +1460,7 @@ static int32_t defsparser(scriptfile *script)
 					globalNumTiles = ltilenume;
                     for (tilex = ftilenume; tilex <= ltilenume && happy; tilex++)
                     {
+#ifndef BUILD_HEADLESS
 						if (!modelCacheSystem.SetModelTile(modelfn, tilex))
 						{
 							initprintf("Warning: Failed load model \"%s\"\n", modelfn);
@@ -1467,6 +1470,7 @@ static int32_t defsparser(scriptfile *script)
 						}
 
 						modelCacheSystem.DefineTextureForModelSurface(tilex, 0, lastModelMaterialInfo.skinfn.c_str());
+#endif
 						
 						happy = 1;
                         //framei = md_defineframe(lastmodelid, framename, tilex, max(0,modelskin), smoothduration,pal);
@@ -1784,10 +1788,12 @@ static int32_t defsparser(scriptfile *script)
                 break;
                 }
             }
+#ifndef BUILD_HEADLESS
 			for (int i = globalStartTile; i <= globalNumTiles; i++)
 			{
 				modelCacheSystem.SetMiscForModelSurface(i, (float)scale, shadeoffs, (float)mzadd, (float)myoffset, flags);
 			}
+#endif
 			
 #ifdef USE_OPENGL
             if (EDUKE32_PREDICT_FALSE(!model_ok))
@@ -2328,8 +2334,10 @@ static int32_t defsparser(scriptfile *script)
                     }
 
 // jmarshall
+#ifndef BUILD_HEADLESS
 					if (polymerNG.SetHighQualityTextureForTile(fn, tile, PAYLOAD_IMAGE_DIFFUSE))
 						break;
+#endif
 // jmarshall end
 
                     if (EDUKE32_PREDICT_FALSE(check_file_exist(fn)))
@@ -2408,6 +2416,7 @@ static int32_t defsparser(scriptfile *script)
                         break;
                     }
 
+#ifndef BUILD_HEADLESS
 					// jmarshall
 					if (token == T_NORMAL && polymerNG.SetHighQualityTextureForTile(fn, tile, PAYLOAD_IMAGE_NORMAL))
 						break;
@@ -2419,6 +2428,7 @@ static int32_t defsparser(scriptfile *script)
 					if (token == T_GLOW && polymerNG.SetHighQualityTextureForTile(fn, tile, PAYLOAD_IMAGE_GLOW))
 						break;
 					// jmarshall end
+#endif
 
                     if (EDUKE32_PREDICT_FALSE(check_file_exist(fn)))
                         break;
@@ -12,8 +12,10 @@
 # include <string.h>
 #endif
 #include "compat.h"
+#ifndef BUILD_HEADLESS
 #include "build3d.h"
 #include "PolymerNG/Renderer/Renderer.h"
+#endif
 #include "build.h"
 //#include "editor.h"
 #include "pragmas.h"
@@ -42,10 +44,15 @@
 # endif
 #endif
 
-#if defined(BUILD_NEXTGEN)
+#if defined(BUILD_NEXTGEN) && !defined(BUILD_HEADLESS)
 #include "PolymerNG/PolymerNG.h"
+#elif defined(BUILD_HEADLESS)
+#include "PolymerNG/PolymerNG_public.h"
 #endif
 
+#include "Threading/jobsystem.h"
+#include "Profiler/profiler.h"
+
 #ifdef USE_LIBPNG
 //# include <setjmp.h>
 # include <png.h>
@@ -54,6 +61,7 @@
 #include <math.h>  // pow
 
 #include "engine_priv.h"
+#include "clipgrid.h"
 
 #ifdef LUNATIC
 # include "lunatic.h"
@@ -7591,6 +7599,9 @@ static void dorotatesprite(int32_t sx, int32_t sy, int32_t z, int16_t a, int16_t
         polymost_dorotatesprite(sx,sy,z,a,picnum,dashade,dapalnum,dastat,daalpha,cx1,cy1,cx2,cy2,uniqid);
         return;
     }
+#elif defined(BUILD_HEADLESS)
+	UNREFERENCED_PARAMETER(uniqid);
+	return;
 #elif defined(BUILD_D3D12)
 	BuildRenderCommand command;
 	build3D.dorotatesprite(command, sx, sy, z, a, picnum, dashade, dapalnum, dastat, daalpha, cx1, cy1, cx2, cy2, uniqid);
@@ -8623,10 +8634,19 @@ LISTFN_STATIC void do_insertsprite_at_headofsect(int16_t spritenum, int16_t sect
     prevspritesect[spritenum] = -1;
     nextspritesect[spritenum] = ohead;
     if (ohead >= 0)
+    {
         prevspritesect[ohead] = spritenum;
+        journal_mark(spritelinkjournal, ohead);
+    }
     headspritesect[sectnum] = spritenum;
 
     sprite[spritenum].sectnum = sectnum;
+
+    journal_mark(spritejournal, spritenum);
+    journal_mark(spritelinkjournal, spritenum);
+    journal_mark(headsectjournal, sectnum);
+
+    clipgrid_insertsprite(spritenum, sectnum);
 }
 
 // remove sprite 'deleteme' from its sector list
@@ -8635,12 +8655,23 @@ LISTFN_STATIC void do_deletespritesect(int16_t deleteme)
     int32_t sectnum = sprite[deleteme].sectnum;
     int32_t prev = prevspritesect[deleteme], next = nextspritesect[deleteme];
 
+    clipgrid_deletesprite(deleteme);
+
     if (headspritesect[sectnum] == deleteme)
+    {
         headspritesect[sectnum] = next;
+        journal_mark(headsectjournal, sectnum);
+    }
     if (prev >= 0)
+    {
         nextspritesect[prev] = next;
+        journal_mark(spritelinkjournal, prev);
+    }
     if (next >= 0)
+    {
         prevspritesect[next] = prev;
+        journal_mark(spritelinkjournal, next);
+    }
 }
 
 ///// now, status lists /////
@@ -8653,10 +8684,17 @@ LISTFN_STATIC void do_insertsprite_at_headofstat(int16_t spritenum, int16_t stat
     prevspritestat[spritenum] = -1;
     nextspritestat[spritenum] = ohead;
     if (ohead >= 0)
+    {
         prevspritestat[ohead] = spritenum;
+        journal_mark(spritelinkjournal, ohead);
+    }
     headspritestat[statnum] = spritenum;
 
     sprite[spritenum].statnum = statnum;
+
+    journal_mark(spritejournal, spritenum);
+    journal_mark(spritelinkjournal, spritenum);
+    journal_mark(headstatjournal, statnum);
 }
 
 // insertspritestat (internal)
@@ -8673,10 +8711,15 @@ LISTFN_STATIC int32_t insertspritestat(int16_t statnum)
 
     // make back-link of the new freelist head point to nil
     if (headspritestat[MAXSTATUS] >= 0)
+    {
         prevspritestat[headspritestat[MAXSTATUS]] = -1;
+        journal_mark(spritelinkjournal, headspritestat[MAXSTATUS]);
+    }
     else
         tailspritefree = -1;
 
+    journal_mark(headstatjournal, MAXSTATUS);
+
     do_insertsprite_at_headofstat(blanktouse, statnum);
 
     return(blanktouse);
@@ -8689,11 +8732,20 @@ static void do_deletespritestat(int16_t deleteme)
     int32_t prev = prevspritestat[deleteme], next = nextspritestat[deleteme];
 
     if (headspritestat[sectnum] == deleteme)
+    {
         headspritestat[sectnum] = next;
+        journal_mark(headstatjournal, sectnum);
+    }
     if (prev >= 0)
+    {
         nextspritestat[prev] = next;
+        journal_mark(spritelinkjournal, prev);
+    }
     if (next >= 0)
+    {
         prevspritestat[next] = prev;
+        journal_mark(spritelinkjournal, next);
+    }
 }
 
 
@@ -8739,11 +8791,20 @@ int32_t deletesprite(int16_t spritenum)
     prevspritestat[spritenum] = tailspritefree;
     nextspritestat[spritenum] = -1;
     if (tailspritefree >= 0)
+    {
         nextspritestat[tailspritefree] = spritenum;
+        journal_mark(spritelinkjournal, tailspritefree);
+    }
     else
+    {
         headspritestat[MAXSTATUS] = spritenum;
+        journal_mark(headstatjournal, MAXSTATUS);
+    }
     sprite[spritenum].statnum = MAXSTATUS;
 
+    journal_mark(spritejournal, spritenum);
+    journal_mark(spritelinkjournal, spritenum);
+
     tailspritefree = spritenum;
     Numsprites--;
 
@@ -9203,6 +9264,8 @@ int32_t initengine(void)
 
     loadpalette();
 
+    jobSystem.Init();
+
 #ifdef USE_OPENGL
     if (!hicinitcounter) hicinit();
     if (!mdinited) mdinit();
@@ -9287,6 +9350,8 @@ void uninitengine(void)
     DO_FREE_AND_NULL(kpzbuf);
     kpzbufsiz = 0;
 
+    jobSystem.Shutdown();
+
     uninitsystem();
 
     for (int i = 0; i < num_usermaphacks; i++)
@@ -9349,6 +9414,25 @@ void initspritelists(void)
 
     tailspritefree = MAXSPRITES-1;
     Numsprites = 0;
+
+    // Every list entry was rewritten, let the journal consumers resync.
+    changejournalreset = 1;
+
+    clipgrid_reset();
+}
+
+//
+// clearchangejournal
+//
+void clearchangejournal(void)
+{
+    Bmemset(spritejournal, 0, sizeof(spritejournal));
+    Bmemset(spritelinkjournal, 0, sizeof(spritelinkjournal));
+    Bmemset(headsectjournal, 0, sizeof(headsectjournal));
+    Bmemset(headstatjournal, 0, sizeof(headstatjournal));
+    Bmemset(sectorjournal, 0, sizeof(sectorjournal));
+    Bmemset(walljournal, 0, sizeof(walljournal));
+    changejournalreset = 0;
 }
 
 
@@ -9443,7 +9527,9 @@ int32_t drawrooms(int32_t daposx, int32_t daposy, int32_t daposz,
     }
 
 // jmarshall
-#if 1
+#if defined(BUILD_HEADLESS)
+	return 0;
+#else
 	if (!isOcclusionPass)
 	{
 		polymerNG.DrawRooms(daposx, daposy, daposz, daang, dahoriz, dacursectnum);
@@ -10667,7 +10753,9 @@ static int32_t finish_loadboard(const vec3_t *dapos, int16_t *dacursectnum, int1
         }
 # endif
 #endif
-		polymerNG.LoadBoard();
+#ifndef BUILD_HEADLESS
+		polymerNG.LoadBoard(*dacursectnum);
+#endif
 
     }
 
@@ -11481,7 +11569,9 @@ int32_t loadmaphack(const char *filename)
 
 			lightOpts.castShadows = true;
 
+#ifndef BUILD_HEADLESS
 			polymerNG.AddLightToCurrentBoard(lightOpts);
+#endif
 
 			break;
 		}
@@ -11910,6 +12000,8 @@ void nextpage(SceneNextPageParms nextpageParams)
 	renderer.SubmitFrame(nextpageParams);
 #endif
 
+    buildProfiler.EndFrame();
+
     //char snotbuf[32];
     //j = 0; k = 0;
     //for(i=0;i<4096;i++)
@@ -12553,8 +12645,10 @@ int32_t qloadkvx(int32_t voxindex, const char *filename, int32_t tileNum)
 
 		sprintf(filename_fixed, "highres/voxels/%s", filename);
 		ReplaceFileExtension(filename_fixed, "obj");
+#ifndef BUILD_HEADLESS
 		if (!modelCacheSystem.SetModelTile(filename_fixed, tileNum))
 			return -1;
+#endif
 
 		return 0;
 	}
@@ -12795,6 +12889,9 @@ int32_t setsprite(int16_t spritenum, const vec3_t *newpos)
     if ((void *)newpos != (void *)&sprite[spritenum])
         Bmemcpy(&sprite[spritenum], newpos, sizeof(vec3_t));
 
+    journal_mark(spritejournal, spritenum);
+    clipgrid_updatesprite(spritenum);
+
     updatesector(newpos->x,newpos->y,&tempsectnum);
 
     if (tempsectnum < 0)
@@ -12812,6 +12909,9 @@ int32_t setspritez(int16_t spritenum, const vec3_t *newpos)
     if ((void *)newpos != (void *)&sprite[spritenum])
         Bmemcpy(&sprite[spritenum], newpos, sizeof(vec3_t));
 
+    journal_mark(spritejournal, spritenum);
+    clipgrid_updatesprite(spritenum);
+
     updatesectorz(newpos->x,newpos->y,newpos->z,&tempsectnum);
 
     if (tempsectnum < 0)
@@ -12869,11 +12969,23 @@ int32_t nextsectorneighborz(int16_t sectnum, int32_t refz, int16_t topbottom, in
 // cansee
 //
 int32_t cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2)
+{
+    static uint8_t sectbitmap[MAXSECTORS>>3];
+    int32_t numsects;
+
+    return cansee_internal(x1, y1, z1, sect1, x2, y2, z2, sect2, sectbitmap, clipsectorlist, &numsects);
+}
+
+//
+// cansee_internal
+//
+int32_t cansee_internal(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2,
+                        uint8_t *sectbitmap, int16_t *sectlist, int32_t *numsects)
 {
     int32_t dacnt, danum;
     const int32_t x21 = x2-x1, y21 = y2-y1, z21 = z2-z1;
 
-    static uint8_t sectbitmap[MAXSECTORS>>3];
+    *numsects = 0;
 #ifdef YAX_ENABLE
     int16_t pendingsectnum;
     vec3_t pendingvec;
@@ -12897,11 +13009,11 @@ restart_grand:
     pendingsectnum = -1;
 #endif
     sectbitmap[sect1>>3] |= (1<<(sect1&7));
-    clipsectorlist[0] = sect1; danum = 1;
+    sectlist[0] = sect1; *numsects = danum = 1;
 
     for (dacnt=0; dacnt<danum; dacnt++)
     {
-        const int32_t dasectnum = clipsectorlist[dacnt];
+        const int32_t dasectnum = sectlist[dacnt];
         const sectortype *const sec = &sector[dasectnum];
         const walltype *wal;
         int32_t cnt;
@@ -13024,7 +13136,8 @@ add_nextsector:
             if (!(sectbitmap[nexts>>3] & (1<<(nexts&7))))
             {
                 sectbitmap[nexts>>3] |= (1<<(nexts&7));
-                clipsectorlist[danum++] = nexts;
+                sectlist[danum++] = nexts;
+                *numsects = danum;
             }
         }
 
@@ -13046,6 +13159,103 @@ add_nextsector:
     return 0;
 }
 
+//
+// cansee_multi
+//
+// cansee from numz heights above the same point at once. Where a line of sight crosses a wall only depends on
+// x and y, so the sectors are walked once and each crossing is tested at every height still in view. A height
+// that fails a test would have stopped cansee right there, one that never fails walked the same sectors.
+//
+int32_t cansee_multi(int32_t x1, int32_t y1, const int32_t *z1, int32_t numz, int16_t sect1,
+                     int32_t x2, int32_t y2, int32_t z2, int16_t sect2,
+                     uint8_t *sectbitmap, int16_t *sectlist, int32_t *numsects, uint32_t *seemask)
+{
+    int32_t dacnt, danum;
+    const int32_t x21 = x2-x1, y21 = y2-y1;
+    uint32_t inview = (numz < 32) ? (1u<<numz)-1 : UINT32_MAX;
+
+    *numsects = 0;
+    *seemask = 0;
+#ifdef YAX_ENABLE
+    // lines of sight restart from the bunch they cross into
+    if (numyaxbunches > 0)
+        return -1;
+
+    if ((unsigned)sect1 >= MAXSECTORS || (unsigned)sect2 >= MAXSECTORS)
+        return 0;
+#endif
+    Bmemset(sectbitmap, 0, (numsectors+7)>>3);
+
+    if (x1 == x2 && y1 == y2)
+    {
+        if (sect1 == sect2)
+            *seemask = inview;
+        return 0;
+    }
+
+    sectbitmap[sect1>>3] |= (1<<(sect1&7));
+    sectlist[0] = sect1; *numsects = danum = 1;
+
+    for (dacnt=0; dacnt<danum; dacnt++)
+    {
+        const int32_t dasectnum = sectlist[dacnt];
+        const sectortype *const sec = &sector[dasectnum];
+        const walltype *wal;
+        int32_t cnt;
+
+        for (cnt=sec->wallnum,wal=&wall[sec->wallptr]; cnt>0; cnt--,wal++)
+        {
+            const twalltype *const wal2 = (twalltype *)&wall[wal->point2];
+            const int32_t x31 = wal->x-x1, x34 = wal->x-wal2->x;
+            const int32_t y31 = wal->y-y1, y34 = wal->y-wal2->y;
+
+            int32_t x, y, k, nexts, t, bot;
+            int32_t cfz[2], nextcfz[2];
+            uint32_t passed = 0;
+
+            bot = y21*x34-x21*y34; if (bot <= 0) continue;
+            // XXX: OVERFLOW
+            t = y21*x31-x21*y31; if ((unsigned)t >= (unsigned)bot) continue;
+            t = y31*x34-x31*y34; if ((unsigned)t >= (unsigned)bot) continue;
+
+            nexts = wal->nextsector;
+            if (nexts < 0 || wal->cstat&32)
+                return 0;
+
+            t = divscale24(t,bot);
+            x = x1 + mulscale24(x21,t);
+            y = y1 + mulscale24(y21,t);
+
+            getzsofslope(dasectnum, x,y, &cfz[0],&cfz[1]);
+            getzsofslope(nexts, x,y, &nextcfz[0],&nextcfz[1]);
+
+            for (k=0; k<numz; k++)
+            {
+                const int32_t z = z1[k] + mulscale24(z2-z1[k],t);
+
+                if (z > cfz[0] && z < cfz[1] && z > nextcfz[0] && z < nextcfz[1])
+                    passed |= 1u<<k;
+            }
+
+            inview &= passed;
+            if (inview == 0)
+                return 0;
+
+            if (!(sectbitmap[nexts>>3] & (1<<(nexts&7))))
+            {
+                sectbitmap[nexts>>3] |= (1<<(nexts&7));
+                sectlist[danum++] = nexts;
+                *numsects = danum;
+            }
+        }
+    }
+
+    if (sectbitmap[sect2>>3] & (1<<(sect2&7)))
+        *seemask = inview;
+
+    return 0;
+}
+
 static inline void hit_set(hitdata_t *hit, int32_t sectnum, int32_t wallnum, int32_t spritenum,
                            int32_t x, int32_t y, int32_t z)
 {
@@ -13063,7 +13273,8 @@ static int32_t hitscan_hitsectcf=-1;
 // how: -1: behave like ceiling, 1: behave like floor
 static int32_t hitscan_trysector(const vec3_t *sv, const sectortype *sec, hitdata_t *hit,
                                  int32_t vx, int32_t vy, int32_t vz,
-                                 uint16_t stat, int16_t heinum, int32_t z, int32_t how, const intptr_t *tmp)
+                                 uint16_t stat, int16_t heinum, int32_t z, int32_t how, const intptr_t *tmp,
+                                 int32_t *hitsectcf)
 {
     int32_t x1 = INT32_MAX, y1, z1;
     int32_t i;
@@ -13109,7 +13320,7 @@ static int32_t hitscan_trysector(const vec3_t *sv, const sectortype *sec, hitdat
             if (inside(x1,y1,sec-sector) == 1)
             {
                 hit_set(hit, sec-sector, -1, -1, x1, y1, z1);
-                hitscan_hitsectcf = (how+1)>>1;
+                *hitsectcf = (how+1)>>1;
             }
         }
         else
@@ -13211,6 +13422,40 @@ static void get_floorspr_points(const tspritetype *spr, int32_t px, int32_t py,
     k = -mulscale16(sinang,l); *y3 = *y2+k; *y4 = *y1+k;
 }
 
+//
+// clipgrid_spriteradius
+//
+// Conservative reach of a sprite around its position, covering the face sprite hitscan disc and the
+// wall/floor sprite endpoints computed above.
+int32_t clipgrid_spriteradius(const spritetype *spr)
+{
+    const int32_t tilenum = spr->picnum;
+    const int32_t xspan = tilesiz[tilenum].x, xrepeat = spr->xrepeat;
+    const int32_t yspan = tilesiz[tilenum].y, yrepeat = spr->yrepeat;
+
+#ifdef HAVE_CLIPSHAPE_FEATURE
+    if (pictoidx[tilenum] >= 0)
+        return -1;
+#endif
+
+    switch (spr->cstat&48)
+    {
+    case 0:
+        return ((xspan*xrepeat)>>3)+2;
+    case 16:
+    {
+        const int32_t xoff = picanm[tilenum].flags.xofs + spr->xoffset;
+        return ((((xspan>>1)+klabs(xoff)+1)*xrepeat)>>2)+2;
+    }
+    default:
+    {
+        const int32_t dax = ((xspan>>1)+klabs(picanm[tilenum].flags.xofs + spr->xoffset))*xrepeat;
+        const int32_t day = ((yspan>>1)+klabs(picanm[tilenum].flags.yofs + spr->yoffset))*yrepeat;
+        return (dax+day+xspan*xrepeat+yspan*yrepeat)/4+4;
+    }
+    }
+}
+
 static int32_t get_floorspr_clipyou(int32_t x1, int32_t x2, int32_t x3, int32_t x4,
                                    int32_t y1, int32_t y2, int32_t y3, int32_t y4)
 {
@@ -13295,12 +13540,48 @@ static int32_t try_facespr_intersect(const spritetype *spr, const vec3_t *refpos
 static int32_t clipsprite_initindex(int32_t curidx, spritetype *curspr, int32_t *clipsectcnt, const vec3_t *vect);
 #endif
 
+FORCE_INLINE int32_t hitscan_dispatch(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32_t vz,
+                                             hitdata_t *hit, uint32_t cliptype)
+{
+    if (clipgrid_tracing)
+        return clipgrid_tracehitscan(sv, sectnum, vx, vy, vz, hit, cliptype);
+
+    return hitscan_internal(sv, sectnum, vx, vy, vz, hit, cliptype);
+}
+
 int32_t hitscan(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32_t vz,
                 hitdata_t *hit, uint32_t cliptype)
+{
+    BUILD_PROFILE_SCOPE("hitscan");
+
+    if (EDUKE32_PREDICT_FALSE(clipprofiling))
+    {
+        const double t = gethiticks();
+        const int32_t ret = hitscan_dispatch(sv, sectnum, vx, vy, vz, hit, cliptype);
+
+        clipprofile.hitscanms += gethiticks()-t;
+        clipprofile.hitscans++;
+        return ret;
+    }
+
+    return hitscan_dispatch(sv, sectnum, vx, vy, vz, hit, cliptype);
+}
+
+//
+// hitscan_sectors
+//
+// The body of hitscan_internal and hitscan_sectlist. The sectors the ray went through are left in
+// sectlist[0..*numsects). With concurrent set, it walks the sector lists instead of the clip grid, leaves every
+// global alone and gives up with -2 where only the game thread can go on.
+//
+FORCE_INLINE int32_t hitscan_sectors(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32_t vz,
+                                     hitdata_t *hit, uint32_t cliptype, int16_t *sectlist, int32_t *numsects,
+                                     const int32_t concurrent)
 {
     int32_t x1, y1=0, z1=0, x2, y2, intx, inty, intz;
     int32_t i, k, daz;
     int16_t tempshortcnt, tempshortnum;
+    clipgrid_iter_t cgit;
 
     spritetype *curspr = NULL;
     int32_t clipspritecnt, curidx=-1;
@@ -13312,19 +13593,31 @@ int32_t hitscan(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32
 #endif
     const int32_t dawalclipmask = (cliptype&65535);
     const int32_t dasprclipmask = (cliptype>>16);
+    int32_t concurrenthitsectcf;
+    int32_t *const hitsectcf = concurrent ? &concurrenthitsectcf : &hitscan_hitsectcf;
 
+    *numsects = 0;
     hit->sect = -1; hit->wall = -1; hit->sprite = -1;
     if (sectnum < 0)
         return -1;
 
 #ifdef YAX_ENABLE
+    // a ray into another bunch restarts from there
+    if (concurrent && numyaxbunches > 0)
+        return -2;
+
 restart_grand:
 #endif
     hit->pos.x = hitscangoalx; hit->pos.y = hitscangoaly;
 
-    clipsectorlist[0] = sectnum;
+    if (!concurrent)
+        clipgrid_beginray(sv, vx, vy);
+
+    sectlist[0] = sectnum;
     tempshortcnt = 0; tempshortnum = 1;
-    clipspritecnt = clipspritenum = 0;
+    clipspritecnt = 0;
+    if (!concurrent)
+        clipspritenum = 0;
     do
     {
         const sectortype *sec;
@@ -13356,7 +13649,7 @@ restart_grand:
             tempshortcnt = 0;
         }
 #endif
-        dasector = clipsectorlist[tempshortcnt]; sec = &sector[dasector];
+        dasector = sectlist[tempshortcnt]; sec = &sector[dasector];
 
         i = 1;
 #ifdef HAVE_CLIPSHAPE_FEATURE
@@ -13370,9 +13663,11 @@ restart_grand:
             else tmp[2] = 0;
         }
 #endif
-        if (hitscan_trysector(sv, sec, hit, vx,vy,vz, sec->ceilingstat, sec->ceilingheinum, sec->ceilingz, -i, tmpptr))
+        if (hitscan_trysector(sv, sec, hit, vx,vy,vz, sec->ceilingstat, sec->ceilingheinum, sec->ceilingz, -i, tmpptr,
+                              hitsectcf))
             continue;
-        if (hitscan_trysector(sv, sec, hit, vx,vy,vz, sec->floorstat, sec->floorheinum, sec->floorz, i, tmpptr))
+        if (hitscan_trysector(sv, sec, hit, vx,vy,vz, sec->floorstat, sec->floorheinum, sec->floorz, i, tmpptr,
+                              hitsectcf))
             continue;
 
         ////////// Walls //////////
@@ -13431,8 +13726,8 @@ restart_grand:
             }
 #endif
             for (zz=tempshortnum-1; zz>=0; zz--)
-                if (clipsectorlist[zz] == nextsector) break;
-            if (zz < 0) clipsectorlist[tempshortnum++] = nextsector;
+                if (sectlist[zz] == nextsector) break;
+            if (zz < 0) sectlist[tempshortnum++] = nextsector;
         }
 
         ////////// Sprites //////////
@@ -13444,7 +13739,8 @@ restart_grand:
         if (curspr)
             continue;
 #endif
-        for (z=headspritesect[dasector]; z>=0; z=nextspritesect[z])
+        for (z = concurrent ? headspritesect[dasector] : clipgrid_firstsprite(&cgit, dasector); z>=0;
+             z = concurrent ? nextspritesect[z] : clipgrid_nextsprite(&cgit))
         {
             const spritetype *const spr = &sprite[z];
             const int32_t cstat = spr->cstat;
@@ -13460,6 +13756,8 @@ restart_grand:
             // handle sector-like floor sprites separately
             while (i>=0 && (spr->cstat&32) != (clipmapinfo.sector[sectq[clipinfo[i].qbeg]].CM_CSTAT&32))
                 i = clipinfo[i].next;
+            if (i>=0 && concurrent)
+                return -2;
             if (i>=0 && clipspritenum<MAXCLIPNUM)
             {
                 clipspritelist[clipspritenum++] = z;
@@ -13502,6 +13800,10 @@ restart_grand:
                 {
                     if (picanm[tilenum].flags.sf&PICANM_TEXHITSCAN_BIT)
                     {
+                        // may have to load the tile
+                        if (concurrent)
+                            return -2;
+
                         DO_TILE_ANIM(tilenum, 0);
 
                         if (!waloff[tilenum])
@@ -13563,13 +13865,18 @@ restart_grand:
             }
         }
     }
-    while (++tempshortcnt < tempshortnum || clipspritecnt < clipspritenum);
+    while (++tempshortcnt < tempshortnum || (!concurrent && clipspritecnt < clipspritenum));
+
+    *numsects = tempshortnum;
 
 #ifdef HAVE_CLIPSHAPE_FEATURE
     if (curspr)
         mapinfo_set(NULL, &origmapinfo);
 #endif
 
+    if (concurrent)
+        return 0;
+
 #ifdef YAX_ENABLE
     if (numyaxbunches == 0 || editstatus)
         return 0;
@@ -13615,6 +13922,26 @@ restart_grand:
     return(0);
 }
 
+//
+// hitscan_internal
+//
+int32_t hitscan_internal(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32_t vz,
+                         hitdata_t *hit, uint32_t cliptype)
+{
+    int32_t numsects;
+
+    return hitscan_sectors(sv, sectnum, vx, vy, vz, hit, cliptype, clipsectorlist, &numsects, 0);
+}
+
+//
+// hitscan_sectlist
+//
+int32_t hitscan_sectlist(const vec3_t *sv, int16_t sectnum, int32_t vx, int32_t vy, int32_t vz,
+                         hitdata_t *hit, uint32_t cliptype, int16_t *sectlist, int32_t *numsects)
+{
+    return hitscan_sectors(sv, sectnum, vx, vy, vz, hit, cliptype, sectlist, numsects, 1);
+}
+
 
 //
 // neartag
@@ -13902,6 +14229,9 @@ int32_t lastwall(int16_t point)
 
 int32_t clipmoveboxtracenum = 3;
 
+int32_t clipprofiling = 0;
+clipprofile_t clipprofile;
+
 #ifdef HAVE_CLIPSHAPE_FEATURE
 static int32_t clipsprite_try(const spritetype *spr, int32_t xmin, int32_t ymin, int32_t xmax, int32_t ymax)
 {
@@ -14092,14 +14422,47 @@ int32_t clipmovex(vec3_t *pos, int16_t *sectnum,
 //
 // clipmove
 //
+FORCE_INLINE int32_t clipmove_dispatch(vec3_t *pos, int16_t *sectnum,
+                                              int32_t xvect, int32_t yvect,
+                                              int32_t walldist, int32_t ceildist, int32_t flordist, uint32_t cliptype)
+{
+    if (clipgrid_tracing)
+        return clipgrid_traceclipmove(pos, sectnum, xvect, yvect, walldist, ceildist, flordist, cliptype);
+
+    return clipmove_internal(pos, sectnum, xvect, yvect, walldist, ceildist, flordist, cliptype);
+}
+
 int32_t clipmove(vec3_t *pos, int16_t *sectnum,
                  int32_t xvect, int32_t yvect,
                  int32_t walldist, int32_t ceildist, int32_t flordist, uint32_t cliptype)
+{
+    BUILD_PROFILE_SCOPE("clipmove");
+
+    if (EDUKE32_PREDICT_FALSE(clipprofiling))
+    {
+        const double t = gethiticks();
+        const int32_t ret = clipmove_dispatch(pos, sectnum, xvect, yvect, walldist, ceildist, flordist, cliptype);
+
+        clipprofile.clipmovems += gethiticks()-t;
+        clipprofile.clipmoves++;
+        return ret;
+    }
+
+    return clipmove_dispatch(pos, sectnum, xvect, yvect, walldist, ceildist, flordist, cliptype);
+}
+
+//
+// clipmove_internal
+//
+int32_t clipmove_internal(vec3_t *pos, int16_t *sectnum,
+                          int32_t xvect, int32_t yvect,
+                          int32_t walldist, int32_t ceildist, int32_t flordist, uint32_t cliptype)
 {
     int32_t i, j, k, tempint1, tempint2;
     int32_t x1, y1, x2, y2;
     int32_t dax, day;
     int32_t retval=0;
+    clipgrid_iter_t cgit;
 
     spritetype *curspr=NULL;  // non-NULL when handling sprite with sector-like clipping
     int32_t curidx=-1, clipsectcnt, clipspritecnt;
@@ -14126,6 +14489,8 @@ int32_t clipmove(vec3_t *pos, int16_t *sectnum,
     clipmove_warned = 0;
     clipnum = 0;
 
+    clipgrid_beginbox(xmin, ymin, xmax, ymax);
+
     clipsectorlist[0] = (*sectnum);
     clipsectcnt = 0; clipsectnum = 1;
     clipspritecnt = 0; clipspritenum = 0;
@@ -14296,7 +14661,7 @@ int32_t clipmove(vec3_t *pos, int16_t *sectnum,
         if (curspr)
             continue;  // next sector of this index
 #endif
-        for (j=headspritesect[dasect]; j>=0; j=nextspritesect[j])
+        for (j=clipgrid_firstsprite(&cgit, dasect); j>=0; j=clipgrid_nextsprite(&cgit))
         {
             const spritetype *const spr = &sprite[j];
             const int32_t cstat = spr->cstat;
@@ -14965,8 +15330,27 @@ int32_t krand(void)
 void getzrange(const vec3_t *pos, int16_t sectnum,
                int32_t *ceilz, int32_t *ceilhit, int32_t *florz, int32_t *florhit,
                int32_t walldist, uint32_t cliptype)
+{
+    BUILD_PROFILE_SCOPE("getzrange");
+
+    if (clipgrid_tracing)
+    {
+        clipgrid_tracegetzrange(pos, sectnum, ceilz, ceilhit, florz, florhit, walldist, cliptype);
+        return;
+    }
+
+    getzrange_internal(pos, sectnum, ceilz, ceilhit, florz, florhit, walldist, cliptype);
+}
+
+//
+// getzrange_internal
+//
+void getzrange_internal(const vec3_t *pos, int16_t sectnum,
+                        int32_t *ceilz, int32_t *ceilhit, int32_t *florz, int32_t *florhit,
+                        int32_t walldist, uint32_t cliptype)
 {
     int32_t clipsectcnt;
+    clipgrid_iter_t cgit;
     int32_t daz, daz2, i, j, x1, y1, x2, y2;
 
 #ifdef YAX_ENABLE
@@ -14995,6 +15379,8 @@ void getzrange(const vec3_t *pos, int16_t sectnum,
     getzsofslope(sectnum,pos->x,pos->y,ceilz,florz);
     *ceilhit = sectnum+16384; *florhit = sectnum+16384;
 
+    clipgrid_beginbox(xmin, ymin, xmax, ymax);
+
 #ifdef YAX_ENABLE
     origclipsectorlist[0] = sectnum;
     origclipsectnum = 1;
@@ -15186,7 +15572,7 @@ restart_grand:
         if (dasprclipmask==0)
             break;
 
-        for (j=headspritesect[clipsectorlist[i]]; j>=0; j=nextspritesect[j])
+        for (j=clipgrid_firstsprite(&cgit, clipsectorlist[i]); j>=0; j=clipgrid_nextsprite(&cgit))
         {
             const spritetype *const spr = &sprite[j];
             const int32_t cstat = spr->cstat;
@@ -15440,7 +15826,9 @@ void setview(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
     ydimen = (y2-y1)+1;
 
     fxdimen = (float) xdimen;
+#ifndef BUILD_HEADLESS
     fydimen = (float) ydimen;
+#endif
     setaspect_new();
 
     for (i=0; i<windowx1; i++) { startumost[i] = 1, startdmost[i] = 0; }
@@ -15614,7 +16002,9 @@ int32_t setpalookup(int32_t palnum, const uint8_t *shtab)
     {
         maybe_alloc_palookup(palnum);
         Bmemcpy(palookup[palnum], shtab, 256*numshades);
+#ifndef BUILD_HEADLESS
 		polymerNG.UpdatePaletteLookupTable(palnum);
+#endif
     }
 
     return 0;
@@ -15700,7 +16090,9 @@ void makepalookup(int32_t palnum, const char *remapbuf, uint8_t r, uint8_t g, ui
             }
         }
     }
+#ifndef BUILD_HEADLESS
 	polymerNG.UpdatePaletteLookupTable(palnum);
+#endif
 
     palookupfog[palnum].r = r;
     palookupfog[palnum].g = g;
@@ -15717,8 +16109,9 @@ void setbasepal(int32_t id, uint8_t const * const table)
 
     Bmemcpy(basepaltable[id], table, 768);
 
-
+#ifndef BUILD_HEADLESS
 	polymerNG.UpdatePalette(id);
+#endif
 }
 void removebasepal(int32_t const id)
 {
@@ -15760,7 +16153,9 @@ void setbrightness(char dabrightness, uint8_t dapalid, uint8_t flags)
 
     dapal = basepaltable[curbasepal];
 
+#ifndef BUILD_HEADLESS
 	polymerNG.UpdatePalette(dapalid);
+#endif
 
     if (!(flags&4))
     {
@@ -16373,6 +16768,8 @@ void alignceilslope(int16_t dasect, int32_t x, int32_t y, int32_t z)
     if (sector[dasect].ceilingheinum == 0)
         sector[dasect].ceilingstat &= ~2;
     else sector[dasect].ceilingstat |= 2;
+
+    journal_mark(sectorjournal, dasect);
 }
 
 
@@ -16394,6 +16791,8 @@ void alignflorslope(int16_t dasect, int32_t x, int32_t y, int32_t z)
     if (sector[dasect].floorheinum == 0)
         sector[dasect].floorstat &= ~2;
     else sector[dasect].floorstat |= 2;
+
+    journal_mark(sectorjournal, dasect);
 }
 
 
@@ -16490,8 +16889,14 @@ void setfirstwall(int16_t sectnum, int16_t newfirstwall)
     }
 
     for (i=startwall; i<endwall; i++)
+    {
+        journal_mark(walljournal, i);
         if (wall[i].nextwall >= 0)
+        {
             wall[wall[i].nextwall].nextwall = i;
+            journal_mark(walljournal, wall[i].nextwall);
+        }
+    }
 
 #ifdef YAX_ENABLE
     {
@@ -16985,7 +17390,7 @@ void qsetmodeany(int32_t daxdim, int32_t daydim)
         midydim16 = ydim16 >> 1; // scale(200,yres,480);
 
         begindrawing(); //{{{
-		if (frameplace != NULL)
+		if (frameplace != 0)
 		{
 			Bmemset((char *)frameplace, 0, yres*bytesperline);
 		}
@@ -17003,7 +17408,7 @@ void clear2dscreen(void)
 {
     int32_t const clearsz = (ydim16 <= yres - STATUS2DSIZ2) ? yres - STATUS2DSIZ2 : yres;
     begindrawing();  //{{{
-	if (frameplace != NULL)
+	if (frameplace != 0)
 	{
 		Bmemset((char *)frameplace, 0, bytesperline*clearsz);
 	}
@@ -17989,7 +18394,9 @@ void printext256(int32_t xpos, int32_t ypos, int16_t col, int16_t backcol, const
     if (fontsize) { fontptr = smalltextfont; charxsiz = 4; }
     else { fontptr = textfont; charxsiz = 8; }
 
+#ifndef BUILD_HEADLESS
 	Build3D::printext256(xpos, ypos, col, backcol, name, fontsize);
+#endif
 	//jmarshall:
 	return; // FIXME!!!
 #ifdef USE_OPENGL
@@ -18487,7 +18894,7 @@ void setrollangle(int32_t rolla)
 //
 void invalidatetile(int16_t tilenume, int32_t pal, int32_t how)
 {
-#if defined BUILD_NEXTGEN
+#if defined BUILD_NEXTGEN && !defined BUILD_HEADLESS
 	polymerNG.FlushTile(tilenume);
 #elif !defined USE_OPENGL
     UNREFERENCED_PARAMETER(tilenume);
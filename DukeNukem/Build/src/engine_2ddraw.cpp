@@ -2,8 +2,10 @@
 # include <string.h>
 #endif
 #include "compat.h"
+#ifndef BUILD_HEADLESS
 #include "build3d.h"
 #include "PolymerNG/Renderer/Renderer.h"
+#endif
 #include "build.h"
 //#include "editor.h"
 #include "pragmas.h"
@@ -21,7 +23,7 @@
 static int _2dWindowWidth[2];
 static int _2dWindowHeight[2];
 
-byte *_2dbuffer[2];
+uint8_t *_2dbuffer[2];
 static bool smpFrame = false;
 
 void begindrawing2D(void)
@@ -39,7 +41,7 @@ void begindrawing2D(void)
 
 	if (xres != _2dWindowWidth[smpFrame] || yres != _2dWindowHeight[smpFrame])
 	{
-		_2dbuffer[smpFrame] = (byte *)realloc(_2dbuffer[smpFrame], xres * yres);
+		_2dbuffer[smpFrame] = (uint8_t *)realloc(_2dbuffer[smpFrame], xres * yres);
 		_2dWindowWidth[smpFrame] = xres;
 		_2dWindowHeight[smpFrame] = yres;
 	}
@@ -68,12 +70,14 @@ void enddrawing2D(void)
 	if (!frameplace) return;
 	if (!offscreenrendering) frameplace = 0;
 
+#ifndef BUILD_HEADLESS
 	BuildRenderCommand command;
 	command.taskId = BUILDRENDER_TASK_DRAWCLASSICSCREEN;
 	command.taskDrawClassicScreen.width = _2dWindowWidth[smpFrame];
 	command.taskDrawClassicScreen.height = _2dWindowHeight[smpFrame];
 	command.taskDrawClassicScreen.screen_buffer = _2dbuffer[smpFrame];
 	renderer.AddRenderCommand(command);
+#endif
 
 	smpFrame = !smpFrame;
 
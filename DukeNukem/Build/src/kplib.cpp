@@ -3062,6 +3062,8 @@ int32_t kzseek(int32_t offset, int32_t whence)
 
 //====================== ZIP decompression code ends =========================
 //===================== HANDY PICTURE function begins ========================
+// Standalone tools that load their own files define KPLIB_NO_KPZLOAD to drop the cache1d dependency.
+#ifndef KPLIB_NO_KPZLOAD
 #include "cache1d.h"
 
 void kpzdecode(int32_t const leng, intptr_t * const pic, int32_t * const bpl, int32_t * const xsiz, int32_t * const ysiz)
@@ -3086,4 +3088,5 @@ void kpzload(const char * const filnam, intptr_t * const pic, int32_t * const bp
 {
     kpzdecode(kpzbufload(filnam), pic, bpl, xsiz, ysiz);
 }
+#endif
 //====================== HANDY PICTURE function ends =========================
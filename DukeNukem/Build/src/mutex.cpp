@@ -6,6 +6,8 @@ int32_t mutex_init(mutex_t *mutex)
 #ifdef RENDERTYPEWIN
     *mutex = CreateMutex(0, FALSE, 0);
     return (*mutex == 0);
+#elif defined BUILD_HEADLESS
+    return pthread_mutex_init(mutex, NULL);
 #else
     if (mutex)
     {
@@ -21,6 +23,8 @@ int32_t mutex_lock(mutex_t *mutex)
 {
 #ifdef RENDERTYPEWIN
     return (WaitForSingleObject(*mutex, INFINITE) == WAIT_FAILED);
+#elif defined BUILD_HEADLESS
+    return pthread_mutex_lock(mutex);
 #else
     return SDL_LockMutex(*mutex);
 #endif
@@ -30,6 +34,8 @@ int32_t mutex_unlock(mutex_t *mutex)
 {
 #ifdef RENDERTYPEWIN
     return (ReleaseMutex(*mutex) == 0);
+#elif defined BUILD_HEADLESS
+    return pthread_mutex_unlock(mutex);
 #else
     return SDL_UnlockMutex(*mutex);
 #endif
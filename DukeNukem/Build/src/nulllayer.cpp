@@ -0,0 +1,431 @@
+// nulllayer.cpp
+//
+// Null interface layer for headless builds (BUILD_HEADLESS), the counterpart of syslayer.cpp and
+// syslayer_deprecated.cpp. There is no window, no input and no renderer; the game runs on the main
+// thread and prints to stdout.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <chrono>
+
+#include "compat.h"
+#include "nulllayer.h"
+#include "baselayer.h"
+#include "build.h"
+#include "osd.h"
+
+#include "PolymerNG/PolymerNG_public.h"
+#include "Input/InputSystem.h"
+#include "Profiler/profiler.h"
+
+// video
+int32_t xres = -1;
+int32_t yres = -1;
+int32_t fullscreen = 0;
+int32_t bpp = 0;
+int32_t bytesperline = 0;
+int32_t lockcount = 0;
+int32_t glcolourdepth = 32;
+uint32_t maxrefreshfreq = 60;
+intptr_t frameplace = 0;
+char modechange = 1;
+char repaintneeded = 0;
+char offscreenrendering = 0;
+char videomodereset = 0;
+
+// Set by the launcher's window on Windows, the game reads them for the default mode.
+float globalWindowWidth = 640;
+float globalWindowHeight = 480;
+
+// No models without the renderer.
+int32_t usemodels = 0;
+
+// input and events
+char quitevent = 0;
+char appactive = 1;
+char realfs = 0;
+char regrabmouse = 0;
+int32_t inputchecked = 0;
+
+//
+// NullPolymerNGLight
+//
+class NullPolymerNGLight : public PolymerNGLight
+{
+public:
+	virtual PolymerNGLightOpts *GetOpts() { return &opts; }
+	virtual const PolymerNGLightOpts *GetOriginalOpts() { return &originalOpts; }
+
+	PolymerNGLightOpts opts;
+	PolymerNGLightOpts originalOpts;
+};
+
+//
+// NullPolymerNGPublic
+//
+// Hands the game somewhere to keep its light state so light effects still tick the same way they do with
+// the renderer. Lights come from a ring, a board never holds more lights than it has sprites.
+//
+class NullPolymerNGPublic : public PolymerNGPublic
+{
+public:
+	virtual PolymerNGLight *AddLightToCurrentBoard(PolymerNGLightOpts lightOpts)
+	{
+		NullPolymerNGLight *light = &lights[nextLight];
+		nextLight = (nextLight + 1) % MAXSPRITES;
+
+		light->opts = lightOpts;
+		light->originalOpts = lightOpts;
+		return light;
+	}
+	virtual void RemoveLightFromCurrentBoard(PolymerNGLight *) { }
+	virtual void MoveLightsInSector(int sectorNum, float deltax, float deltay) { }
+	virtual void SetAmbientLightForSector(int sectorNum, int ambientLightNum) { }
+private:
+	NullPolymerNGLight	lights[MAXSPRITES];
+	int					nextLight;
+};
+
+static NullPolymerNGPublic polymerNGNull;
+PolymerNGPublic *polymerNGPublic = &polymerNGNull;
+
+//
+// NullBuildInputSystem
+//
+class NullBuildInputSystem : public XBuildInputSystem
+{
+public:
+	virtual bool ControllerKeyDown(XControllerButton button) { return false; }
+	virtual void SetControllerButtonsUp() { }
+	virtual void Update() { }
+};
+
+static NullBuildInputSystem xBuildInputSystemNull;
+XBuildInputSystem *xBuildInputSystem = &xBuildInputSystemNull;
+
+//
+// main
+//
+int main(int argc, char **argv)
+{
+	buildProfiler.SetThreadName("game");
+
+	baselayer_init();
+
+	return app_main(argc, (char const * const *)argv);
+}
+
+//
+// initprintf() -- prints a formatted string to the intitialization window
+//
+void initprintf(const char *f, ...)
+{
+	va_list va;
+	char buf[2048];
+
+	va_start(va, f);
+	Bvsnprintf(buf, sizeof(buf), f, va);
+	va_end(va);
+
+	initputs(buf);
+}
+
+//
+// initputs() -- prints a string to the intitialization window
+//
+void initputs(const char *buf)
+{
+	fputs(buf, stdout);
+}
+
+//
+// wm_setapptitle() -- changes the window title
+//
+void wm_setapptitle(const char *name)
+{
+
+}
+
+//
+// wm_msgbox/wm_ynbox() -- window-manager-provided message boxes
+//
+int32_t wm_msgbox(const char *name, const char *fmt, ...)
+{
+	va_list va;
+	char buf[2048];
+
+	va_start(va, fmt);
+	Bvsnprintf(buf, sizeof(buf), fmt, va);
+	va_end(va);
+
+	fprintf(stderr, "%s: %s\n", name, buf);
+	return 0;
+}
+
+int32_t wm_ynbox(const char *name, const char *fmt, ...)
+{
+	return 0;
+}
+
+//
+// handleevents() -- nothing to pump without a window
+//
+int32_t handleevents(void)
+{
+	sampletimer();
+	return 0;
+}
+
+int32_t handleevents_peekkeys(void)
+{
+	return 0;
+}
+
+void idle_waitevent_timeout(uint32_t timeout)
+{
+
+}
+
+//-------------------------------------------------------------------------------------------------
+//  TIMER
+//=================================================================================================
+
+typedef std::chrono::steady_clock nullclock_t;
+
+static nullclock_t::time_point timerstart;
+static int32_t timerlastsample = 0;
+int32_t timerticspersec = 0;
+static void(*usertimercallback)(void) = NULL;
+
+//
+// installusertimercallback() -- set up a callback function to be called when the timer is fired
+//
+void(*installusertimercallback(void(*callback)(void)))(void)
+{
+	void(*oldtimercallback)(void);
+
+	oldtimercallback = usertimercallback;
+	usertimercallback = callback;
+
+	return oldtimercallback;
+}
+
+//
+// inittimer() -- initialize timer
+//
+int32_t inittimer(int32_t tickspersecond)
+{
+	if (timerticspersec) return 0;	// already installed
+
+	timerstart = nullclock_t::now();
+	timerticspersec = tickspersecond;
+	timerlastsample = 0;
+
+	usertimercallback = NULL;
+
+	return 0;
+}
+
+//
+// uninittimer() -- shut down timer
+//
+void uninittimer(void)
+{
+	timerticspersec = 0;
+}
+
+//
+// sampletimer() -- update totalclock
+//
+void sampletimer(void)
+{
+	int32_t n;
+
+	if (!timerticspersec) return;
+
+	n = (int32_t)(getu64ticks() * timerticspersec / getu64tickspersec()) - timerlastsample;
+
+	if (n <= 0) return;
+
+	totalclock += n;
+	timerlastsample += n;
+
+	if (usertimercallback) for (; n > 0; n--) usertimercallback();
+}
+
+//
+// getticks() -- returns the milliseconds since the timer started
+//
+uint32_t getticks(void)
+{
+	return (uint32_t)(getu64ticks() * 1000 / getu64tickspersec());
+}
+
+// high-resolution timers for profiling
+uint64_t getu64ticks(void)
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(nullclock_t::now() - timerstart).count();
+}
+
+uint64_t getu64tickspersec(void)
+{
+	return 1000000000;
+}
+
+// Returns the time since an unspecified starting time in milliseconds.
+double gethiticks(void)
+{
+	return (double)getu64ticks() * 1e-6;
+}
+
+//
+// gettimerfreq() -- returns the number of ticks per second the timer is configured to generate
+//
+int32_t gettimerfreq(void)
+{
+	return timerticspersec;
+}
+
+//
+// system_getcvars() -- propagate any cvars that are read post-initialization
+//
+void system_getcvars(void)
+{
+
+}
+
+int32_t initsystem(void)
+{
+	return 0;
+}
+
+//
+// uninitsystem() -- uninit systems
+//
+void uninitsystem(void)
+{
+
+}
+
+//
+// setvideomode() -- records the mode so the engine's view math matches a windowed build, nothing is drawn
+//
+int32_t setvideomode(int32_t x, int32_t y, int32_t c, int32_t fs)
+{
+	xres = x;
+	yres = y;
+	bpp = c;
+	fullscreen = fs;
+	bytesperline = 0;
+	modechange = 1;
+	videomodereset = 0;
+
+	return 0;
+}
+
+void getvalidmodes(void)
+{
+
+}
+
+int32_t checkvideomode(int32_t *x, int32_t *y, int32_t c, int32_t fs, int32_t forced)
+{
+	return 1;
+}
+
+//
+// resetvideomode() -- resets the video system
+//
+void resetvideomode(void)
+{
+	videomodereset = 1;
+}
+
+//
+// showframe() -- update the display
+//
+void showframe(int32_t w)
+{
+
+}
+
+int32_t setpalette(int32_t start, int32_t num)
+{
+	return 0;
+}
+
+int32_t setgamma(void)
+{
+	return 0;
+}
+
+//
+// initinput() -- init input system
+//
+int32_t initinput(void)
+{
+	return 0;
+}
+
+//
+// uninitinput() -- uninit input system
+//
+void uninitinput(void)
+{
+
+}
+
+void releaseallbuttons(void)
+{
+
+}
+
+//
+// setjoydeadzone() -- sets the dead and saturation zones for the joystick
+//
+void setjoydeadzone(int32_t axis, uint16_t dead, uint16_t satur)
+{
+
+}
+
+const char *getjoyname(int32_t what, int32_t num)
+{
+	return NULL;
+}
+
+int32_t initmouse(void)
+{
+	return 0;
+}
+
+void uninitmouse(void)
+{
+
+}
+
+void grabmouse(char a)
+{
+
+}
+
+void AppGrabMouse(char a)
+{
+
+}
+
+void readmousexy(int32_t *x, int32_t *y)
+{
+	*x = *y = 0;
+}
+
+void readmousebstatus(int32_t *b)
+{
+	*b = 0;
+}
+
+void XHandleControllerMovement(int32_t *dx, int32_t *dy)
+{
+
+}
@@ -54,6 +54,7 @@
 #include "PolymerNG/Renderer/Renderer.h"
 
 #include "Threading/Thread.h"
+#include "Profiler/profiler.h"
 
 #include "BuildEngineApp.h"
 
@@ -97,6 +98,7 @@ class EditorThread : BuildThread
 public:
 	EditorThread(int32_t buildargc, const char **buildargv) : BuildThread(2) {
 		_buildargc = buildargc; _buildargv = buildargv;
+		Start();
 	}
 	virtual int Execute();
 
@@ -116,6 +118,7 @@ class GameThread : BuildThread
 public:
 	GameThread(int32_t buildargc, const char **buildargv) : BuildThread(2) {
 		_buildargc = buildargc; _buildargv = buildargv;
+		Start();
 	}
 
 	virtual int Execute();
@@ -126,6 +129,8 @@ public:
 
 int GameThread::Execute()
 {
+	buildProfiler.SetThreadName("game");
+
 	//startwin_open();
 	baselayer_init();
 
@@ -136,6 +141,8 @@ int GameThread::Execute()
 
 void BuildEngineApp::Startup()
 {
+	buildProfiler.SetThreadName("render");
+
 	_buildargc = 0;
 
 	// carve up the command line into more recognizable pieces
@@ -237,7 +244,7 @@ void BuildEngineApp::Update(float deltaT)
 
 bool BuildEngineApp::HasWork()
 {
-	return renderer.HasWork();
+	return renderer.WaitForWork(RENDER_IDLE_WAIT_MS);
 }
 
 void BuildEngineApp::RenderScene()
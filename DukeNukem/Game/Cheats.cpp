@@ -23,7 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "pch.h"
 #include "duke3d.h"
 #include "osdcmds.h"
-#include "cheats.h"
+#include "Cheats.h"
 
 // KEEPINSYNC game.h: enum cheatindex_t
 char CheatStrings [][MAXCHEATLEN] =
@@ -0,0 +1,976 @@
+// actorjobs.cpp
+//
+
+#include "pch.h"
+#include "duke3d.h"
+#include "actorjobs.h"
+#include "demobench.h"
+#include "xxhash.h"
+
+#include "../Build/src/Threading/jobsystem.h"
+
+int32_t g_actorJobs = ACTORJOBS_OFF;
+int32_t g_actorScripts = 0;
+actorjobstats_t g_actorJobStats;
+
+static actorread_t actorread[MAXSPRITES];
+static int16_t readlist[MAXSPRITES];
+static int32_t g_actorReadPhase = 0;
+
+// Everything A_FindPlayer looks at besides the sprite itself, taken once per read phase.
+typedef struct
+{
+    vec3_t opos;
+    int16_t i, extra, next, filler;
+} readplayer_t;
+
+static readplayer_t readplayers[MAXPLAYERS];
+static int32_t numreadplayers;
+
+static int16_t sightsectors[MAXSPRITES][ACTORSIGHT_NUM][ACTORJOBS_MAXSIGHTSECTORS];
+static int16_t shootsectors[MAXSPRITES][ACTORJOBS_MAXSHOOTSECTORS];
+
+// The random part of the height each kind of line of sight is looked from.
+static const int32_t sightzmask[ACTORSIGHT_NUM] = { 0, 41<<8, 47<<8 };
+
+// Set to the read phase in sectors the actors committed so far moved or changed sprites in.
+static int32_t dirtyphase[MAXSECTORS];
+static int32_t readstatnum;
+static uint32_t readworldwrites;
+static int32_t readworldintact;
+static int16_t commitsectnum;
+
+static FILE *checksumfp = NULL;
+static uint32_t checksumtick;
+
+#define ACTORJOBS_MAXREPORTS    16
+
+static int16_t batchlist[ACTORJOBS_MAXSCRIPTS];
+static vmstate_t scriptctx[ACTORJOBS_MAXSCRIPTS];
+static int32_t scriptkill[ACTORJOBS_MAXSCRIPTS];
+
+//
+// G_GetReadPlayers
+//
+static int32_t G_GetReadPlayers(readplayer_t *rp)
+{
+    int32_t j, n = 0;
+
+    if (!g_netServer && ud.multimode < 2)
+    {
+        const DukePlayer_t *const ps = g_player[myconnectindex].ps;
+
+        Bmemset(&rp[0], 0, sizeof(readplayer_t));
+        rp[0].opos = ps->opos;
+        return 1;
+    }
+
+    for (TRAVERSE_CONNECT(j))
+    {
+        const DukePlayer_t *const ps = g_player[j].ps;
+
+        Bmemset(&rp[n], 0, sizeof(readplayer_t));
+        rp[n].opos = ps->opos;
+        rp[n].i = ps->i;
+        rp[n].extra = sprite[ps->i].extra;
+        rp[n].next = connectpoint2[j];
+        n++;
+    }
+
+    return n;
+}
+
+//
+// G_ReadPlayersValid
+//
+// Compares the live players against the snapshot of the read phase in place.
+//
+static int32_t G_ReadPlayersValid(void)
+{
+    int32_t j, n = 0;
+
+    if (!g_netServer && ud.multimode < 2)
+    {
+        const vec3_t *const opos = &g_player[myconnectindex].ps->opos;
+
+        return (opos->x == readplayers[0].opos.x && opos->y == readplayers[0].opos.y &&
+                opos->z == readplayers[0].opos.z);
+    }
+
+    for (TRAVERSE_CONNECT(j))
+    {
+        const DukePlayer_t *const ps = g_player[j].ps;
+        const readplayer_t *const rp = &readplayers[n++];
+
+        if (n > numreadplayers || ps->opos.x != rp->opos.x || ps->opos.y != rp->opos.y || ps->opos.z != rp->opos.z ||
+            ps->i != rp->i || sprite[ps->i].extra != rp->extra || connectpoint2[j] != rp->next)
+            return 0;
+    }
+
+    return (n == numreadplayers);
+}
+
+//
+// G_HashSightHeights
+//
+// The heights and slopes cansee reads of a sector it passes through or looks into.
+//
+static void G_HashSightHeights(XXH32_stateSpace_t *state, int32_t sectnum)
+{
+    const sectortype *const sec = &sector[sectnum];
+    const walltype *const wal = &wall[sec->wallptr];
+
+    XXH32_update(state, &sec->ceilingz, sizeof(sec->ceilingz));
+    XXH32_update(state, &sec->floorz, sizeof(sec->floorz));
+    XXH32_update(state, &sec->ceilingstat, sizeof(sec->ceilingstat));
+    XXH32_update(state, &sec->floorstat, sizeof(sec->floorstat));
+    XXH32_update(state, &sec->ceilingheinum, sizeof(sec->ceilingheinum));
+    XXH32_update(state, &sec->floorheinum, sizeof(sec->floorheinum));
+
+    // the slope runs along the first wall
+    XXH32_update(state, &wal->x, sizeof(wal->x));
+    XXH32_update(state, &wal->y, sizeof(wal->y));
+    XXH32_update(state, &wall[wal->point2].x, sizeof(wal->x));
+    XXH32_update(state, &wall[wal->point2].y, sizeof(wal->y));
+}
+
+//
+// G_HashSightSector
+//
+// A sector cansee passes through: its walls, and the heights of the sectors behind them.
+//
+static void G_HashSightSector(XXH32_stateSpace_t *state, int32_t sectnum)
+{
+    const sectortype *const sec = &sector[sectnum];
+    int32_t w;
+
+    XXH32_update(state, &sec->wallptr, sizeof(sec->wallptr));
+    XXH32_update(state, &sec->wallnum, sizeof(sec->wallnum));
+    G_HashSightHeights(state, sectnum);
+
+    for (w=sec->wallptr; w<sec->wallptr+sec->wallnum; w++)
+    {
+        const walltype *const wal = &wall[w];
+
+        XXH32_update(state, &wal->x, sizeof(wal->x));
+        XXH32_update(state, &wal->y, sizeof(wal->y));
+        XXH32_update(state, &wal->point2, sizeof(wal->point2));
+        XXH32_update(state, &wal->nextsector, sizeof(wal->nextsector));
+        XXH32_update(state, &wal->cstat, sizeof(wal->cstat));
+
+        if (wal->nextsector >= 0)
+            G_HashSightHeights(state, wal->nextsector);
+    }
+}
+
+//
+// G_SightHash
+//
+static uint32_t G_SightHash(const int16_t *sectlist, int32_t numsects)
+{
+    XXH32_stateSpace_t state;
+    int32_t k;
+
+    XXH32_resetState(&state, 0x5EE5EE5E);
+
+    for (k=0; k<numsects; k++)
+        G_HashSightSector(&state, sectlist[k]);
+
+    return XXH32_digest(&state);
+}
+
+//
+// G_ActorSightTarget
+//
+// Where a kind of line of sight looks at player ps.
+//
+static void G_ActorSightTarget(int32_t kind, const DukePlayer_t *ps, vec3_t *pos, int16_t *sectnum)
+{
+    const spritetype *const spr = &sprite[ps->i];
+
+    switch (kind)
+    {
+    case ACTORSIGHT_VIEW:
+        *pos = ps->pos;
+        *sectnum = ps->cursectnum;
+        return;
+    case ACTORSIGHT_TARGET:
+        *pos = ps->pos;
+        *sectnum = spr->sectnum;
+        return;
+    default:
+        pos->x = spr->x;
+        pos->y = spr->y;
+        pos->z = spr->z-(24<<8);
+        *sectnum = spr->sectnum;
+        return;
+    }
+}
+
+//
+// A_SightZoff
+//
+// The k-th height a line of sight is read from: k with its bits spread over the mask.
+//
+static int32_t A_SightZoff(int32_t mask, int32_t k)
+{
+    int32_t zoff = 0, bit;
+
+    for (bit=1; mask; bit<<=1, mask &= mask-1)
+        if (k & bit)
+            zoff |= mask & -mask;
+
+    return zoff;
+}
+
+//
+// A_SightZoffIndex
+//
+static int32_t A_SightZoffIndex(int32_t mask, int32_t zoff)
+{
+    int32_t k = 0, bit;
+
+    for (bit=1; mask; bit<<=1, mask &= mask-1)
+        if (zoff & mask & -mask)
+            k |= bit;
+
+    return k;
+}
+
+//
+// A_ReadSight
+//
+static void A_ReadSight(int32_t spritenum, int32_t kind, int32_t phase, uint8_t *sectbitmap, int16_t *sectlist)
+{
+    const spritetype *const s = &sprite[spritenum];
+    actorsight_t *const sight = &actorread[spritenum].sight[kind];
+    int32_t z[32], numz = 0, numsects, k;
+    int16_t sectnum;
+    vec3_t pos;
+
+    sight->phase = 0;
+
+    if (!sight->want)
+        return;
+
+    // only asked for again if the commit phase uses it
+    sight->want = 0;
+
+    G_ActorSightTarget(kind, g_player[sight->player].ps, &pos, &sectnum);
+
+    if ((unsigned)s->sectnum >= (unsigned)numsectors || (unsigned)sectnum >= (unsigned)numsectors)
+        return;
+
+    if (kind == ACTORSIGHT_VIEW)
+        z[numz++] = s->z-sight->zoff;
+    else
+    {
+        const int32_t mask = sightzmask[kind];
+        int32_t m;
+
+        for (m=mask, numz=1; m; m &= m-1)
+            numz <<= 1;
+
+        for (k=0; k<numz; k++)
+            z[k] = s->z-A_SightZoff(mask, k);
+    }
+
+    if (cansee_multi(s->x, s->y, z, numz, s->sectnum, pos.x, pos.y, pos.z, sectnum,
+                     sectbitmap, sectlist, &numsects, &sight->seemask) < 0)
+        return;
+
+    sight->numsectors = -1;
+
+    if (numsects <= ACTORJOBS_MAXSIGHTSECTORS)
+    {
+        Bmemcpy(sightsectors[spritenum][kind], sectlist, numsects * sizeof(int16_t));
+        sight->numsectors = numsects;
+        sight->hash = G_SightHash(sectlist, numsects);
+    }
+
+    sight->pos = pos;
+    sight->sectnum = sectnum;
+    sight->phase = phase;
+}
+
+typedef struct
+{
+    int16_t *sectlist;      // the sectors all the hitscans went through
+    int32_t numsects;       // -1 if there were too many or one of them couldn't run here
+    int16_t hitsectlist[MAXSECTORS];
+} shootread_t;
+
+//
+// A_CheckHitSpriteRead
+//
+// The checkhit of ifcanshoottarget in the read phase, A_CheckHitSprite without turning or lowering the sprite.
+//
+static int32_t A_CheckHitSpriteRead(int32_t i, int32_t dang, int16_t *hitsp, void *data)
+{
+    shootread_t *const sr = (shootread_t *)data;
+    const spritetype *const s = &sprite[i];
+    const int32_t ang = s->ang+dang;
+    vec3_t pos = { s->x, s->y, s->z };
+    hitdata_t hit;
+    int32_t numsects, j, k;
+
+    *hitsp = -1;
+
+    if (sr->numsects < 0)
+        return 0;
+
+    if (A_CheckEnemySprite(s))
+        pos.z -= (42<<8);
+    else if (s->picnum == APLAYER)
+        pos.z -= (39<<8);
+
+    if (hitscan_sectlist(&pos, s->sectnum, sintable[(ang+512)&2047], sintable[ang&2047], 0, &hit, CLIPMASK1,
+                         sr->hitsectlist, &numsects) < 0)
+    {
+        sr->numsects = -1;
+        return 0;
+    }
+
+    for (k=0; k<numsects; k++)
+    {
+        for (j=0; j<sr->numsects; j++)
+            if (sr->sectlist[j] == sr->hitsectlist[k])
+                break;
+
+        if (j < sr->numsects)
+            continue;
+
+        if (sr->numsects == ACTORJOBS_MAXSHOOTSECTORS)
+        {
+            sr->numsects = -1;
+            return 0;
+        }
+
+        sr->sectlist[sr->numsects++] = sr->hitsectlist[k];
+    }
+
+    *hitsp = hit.sprite;
+
+    if (hit.wall >= 0 && (wall[hit.wall].cstat&16) && A_CheckEnemySprite(s))
+        return 1<<30;
+
+    return FindDistance2D(hit.pos.x-s->x, hit.pos.y-s->y);
+}
+
+//
+// A_ReadCanShootTarget
+//
+static void A_ReadCanShootTarget(int32_t spritenum, int32_t phase, shootread_t *sr)
+{
+    const spritetype *const s = &sprite[spritenum];
+    actorread_t *const r = &actorread[spritenum];
+
+    r->shootphase = 0;
+
+    if (!r->shootwant || readstatnum != STAT_ACTOR)
+        return;
+
+    r->shootwant = 0;
+
+    // A_CheckHitSprite lowers the sprite while it looks, a ray could hit it there if it faced any other way
+    if ((s->cstat&48) != 0 && (s->cstat&256) != 0)
+        return;
+
+    // closer than that it's a yes without looking
+    if ((unsigned)s->sectnum >= (unsigned)numsectors || r->dist <= 1024)
+        return;
+
+    sr->sectlist = shootsectors[spritenum];
+    sr->numsects = 0;
+
+    r->shootresult = A_CanShootTarget(spritenum, r->dist, A_CheckHitSpriteRead, sr);
+
+    if (sr->numsects < 0)
+        return;
+
+    r->numshootsectors = sr->numsects;
+    r->ang = s->ang;
+    r->cstat = s->cstat;
+    r->picnum = s->picnum;
+    r->xrepeat = s->xrepeat;
+    r->shootphase = phase;
+}
+
+//
+// G_ActorReadJob
+//
+// Runs on the workers while the game thread waits in G_ActorReadPhase, nothing is written to the world.
+//
+static void G_ActorReadJob(void *data, int begin, int end)
+{
+    const int32_t phase = *(const int32_t *)data;
+    uint8_t sectbitmap[MAXSECTORS>>3];
+    int16_t sectlist[MAXSECTORS];
+    shootread_t sr;
+
+    for (int i = begin; i < end; i++)
+    {
+        const int32_t spritenum = readlist[i];
+        const spritetype *const s = &sprite[spritenum];
+        actorread_t *const r = &actorread[spritenum];
+
+        r->pos = *(const vec3_t *)s;
+        r->sectnum = s->sectnum;
+        r->player = A_FindPlayer(s, &r->dist);
+        r->phase = phase;
+
+        for (int kind = 0; kind < ACTORSIGHT_NUM; kind++)
+            A_ReadSight(spritenum, kind, phase, sectbitmap, sectlist);
+
+        A_ReadCanShootTarget(spritenum, phase, &sr);
+    }
+}
+
+//
+// G_ActorReadPhase
+//
+void G_ActorReadPhase(int32_t statnum)
+{
+    int32_t i, n = 0;
+
+    if (g_actorJobs == ACTORJOBS_OFF)
+        return;
+
+    for (SPRITES_OF(statnum, i))
+        readlist[n++] = i;
+
+    // a read from an older phase is never trusted, even if its inputs happen to match
+    g_actorReadPhase++;
+    g_actorJobStats.phases++;
+
+    readstatnum = statnum;
+    readworldwrites = g_vmWorldWrites;
+#if !defined LUNATIC
+    // only G_MoveActors says when it runs code other than scripts
+    readworldintact = (statnum == STAT_ACTOR);
+#else
+    readworldintact = 0;
+#endif
+
+    if (n == 0)
+        return;
+
+    numreadplayers = G_GetReadPlayers(readplayers);
+
+    if (n < ACTORJOBS_MINSPRITES || !jobSystem.IsInitialized())
+    {
+        G_ActorReadJob(&g_actorReadPhase, 0, n);
+        return;
+    }
+
+    BuildJobCounter counter;
+    jobSystem.ParallelFor(n, ACTORJOBS_BATCHSIZE, G_ActorReadJob, &g_actorReadPhase, &counter);
+    jobSystem.Wait(&counter);
+}
+
+//
+// A_FindPlayerRead
+//
+int32_t A_FindPlayerRead(int32_t spritenum, int32_t *d)
+{
+    const spritetype *const s = &sprite[spritenum];
+    const actorread_t *const r = &actorread[spritenum];
+
+    if (g_actorJobs == ACTORJOBS_OFF)
+        return A_FindPlayer(s, d);
+
+    g_actorJobStats.reads++;
+
+    // anything earlier in the commit phase may have moved this sprite or a player
+    if (r->phase != g_actorReadPhase || r->pos.x != s->x || r->pos.y != s->y || r->pos.z != s->z ||
+        !G_ReadPlayersValid())
+    {
+        g_actorJobStats.misses++;
+        return A_FindPlayer(s, d);
+    }
+
+    g_actorJobStats.hits++;
+
+    if (g_actorJobs == ACTORJOBS_CHECK)
+    {
+        int32_t dist;
+        const int32_t p = A_FindPlayer(s, &dist);
+
+        g_actorJobStats.checks++;
+
+        if (p != r->player || dist != r->dist)
+        {
+            if (g_actorJobStats.divergences++ < ACTORJOBS_MAXREPORTS)
+                OSD_Printf(OSD_ERROR "actorjobs: sprite %d read player %d dist %d, serial player %d dist %d\n",
+                           spritenum, r->player, r->dist, p, dist);
+
+            if (d)
+                *d = dist;
+            return p;
+        }
+    }
+
+    if (d)
+        *d = r->dist;
+    return r->player;
+}
+
+//
+// G_ReadWorldIntact
+//
+// True while walls, sectors and every sprite but the actors' own are as the read phase saw them.
+//
+static inline int32_t G_ReadWorldIntact(void)
+{
+    return readworldintact && g_vmWorldWrites == readworldwrites;
+}
+
+//
+// G_SectorsClean
+//
+static int32_t G_SectorsClean(const int16_t *sectlist, int32_t numsects)
+{
+    int32_t k;
+
+    for (k=0; k<numsects; k++)
+        if (dirtyphase[sectlist[k]] == g_actorReadPhase)
+            return 0;
+
+    return 1;
+}
+
+//
+// A_CanSeePlayerRead
+//
+int32_t A_CanSeePlayerRead(int32_t spritenum, int32_t zoff, int32_t p)
+{
+    return A_CanSeeRead(spritenum, ACTORSIGHT_VIEW, zoff, p);
+}
+
+//
+// A_CanSeeRead
+//
+int32_t A_CanSeeRead(int32_t spritenum, int32_t kind, int32_t zoff, int32_t p)
+{
+    const spritetype *const s = &sprite[spritenum];
+    const actorread_t *const r = &actorread[spritenum];
+    actorsight_t *const sight = &actorread[spritenum].sight[kind];
+    int16_t sectnum;
+    vec3_t pos;
+
+    G_ActorSightTarget(kind, g_player[p].ps, &pos, &sectnum);
+
+    if (g_actorJobs == ACTORJOBS_OFF)
+        return cansee(s->x, s->y, s->z-zoff, s->sectnum, pos.x, pos.y, pos.z, sectnum);
+
+    g_actorJobStats.sightreads++;
+
+    // the same question is read ahead in the next phase
+    sight->want = 1;
+
+    if (sight->phase != g_actorReadPhase || sight->player != p ||
+        (kind == ACTORSIGHT_VIEW ? sight->zoff != zoff : (zoff & ~sightzmask[kind]) != 0) ||
+        r->pos.x != s->x || r->pos.y != s->y || r->pos.z != s->z || r->sectnum != s->sectnum ||
+        sight->pos.x != pos.x || sight->pos.y != pos.y || sight->pos.z != pos.z || sight->sectnum != sectnum ||
+        (!G_ReadWorldIntact() && (sight->numsectors < 0 ||
+                                  G_SightHash(sightsectors[spritenum][kind], sight->numsectors) != sight->hash)))
+    {
+        sight->zoff = zoff;
+        sight->player = p;
+        return cansee(s->x, s->y, s->z-zoff, s->sectnum, pos.x, pos.y, pos.z, sectnum);
+    }
+
+    g_actorJobStats.sighthits++;
+
+    const int32_t seen = (sight->seemask >> A_SightZoffIndex(sightzmask[kind], zoff)) & 1;
+
+    if (g_actorJobs == ACTORJOBS_CHECK)
+    {
+        const int32_t j = cansee(s->x, s->y, s->z-zoff, s->sectnum, pos.x, pos.y, pos.z, sectnum);
+
+        g_actorJobStats.checks++;
+
+        if (j != seen)
+        {
+            if (g_actorJobStats.divergences++ < ACTORJOBS_MAXREPORTS)
+                OSD_Printf(OSD_ERROR "actorjobs: sprite %d read cansee %d to player %d from %d, serial %d\n",
+                           spritenum, seen, p, zoff, j);
+            return j;
+        }
+    }
+
+    return seen;
+}
+
+//
+// A_CanShootTargetRead
+//
+int32_t A_CanShootTargetRead(int32_t spritenum, int32_t dist)
+{
+    const spritetype *const s = &sprite[spritenum];
+    actorread_t *const r = &actorread[spritenum];
+
+    if (g_actorJobs == ACTORJOBS_OFF || dist <= 1024)
+        return A_CanShootTarget(spritenum, dist, A_CheckHitSpriteTurned, NULL);
+
+    g_actorJobStats.shootreads++;
+
+    r->shootwant = 1;
+
+#ifdef YAX_ENABLE
+    // hitscans through TROR restart from the bunch they cross into
+    if (numyaxbunches > 0)
+        r->shootwant = 0;
+#endif
+
+    // the decision doesn't depend on dist past 1024
+    if (r->shootphase != g_actorReadPhase || !G_ReadWorldIntact() ||
+        r->pos.x != s->x || r->pos.y != s->y || r->pos.z != s->z || r->sectnum != s->sectnum ||
+        r->ang != s->ang || r->cstat != s->cstat || r->picnum != s->picnum || r->xrepeat != s->xrepeat ||
+        !G_SectorsClean(shootsectors[spritenum], r->numshootsectors))
+        return A_CanShootTarget(spritenum, dist, A_CheckHitSpriteTurned, NULL);
+
+    g_actorJobStats.shoothits++;
+
+    if (g_actorJobs == ACTORJOBS_CHECK)
+    {
+        const int32_t j = A_CanShootTarget(spritenum, dist, A_CheckHitSpriteTurned, NULL);
+
+        g_actorJobStats.checks++;
+
+        if (j != r->shootresult)
+        {
+            if (g_actorJobStats.divergences++ < ACTORJOBS_MAXREPORTS)
+                OSD_Printf(OSD_ERROR "actorjobs: sprite %d read ifcanshoottarget %d, serial %d\n",
+                           spritenum, r->shootresult, j);
+            return j;
+        }
+    }
+
+    return r->shootresult;
+}
+
+//
+// G_MarkSectorDirty
+//
+static inline void G_MarkSectorDirty(int32_t sectnum)
+{
+    if ((unsigned)sectnum < MAXSECTORS)
+        dirtyphase[sectnum] = g_actorReadPhase;
+}
+
+//
+// G_ActorCommitBegin
+//
+void G_ActorCommitBegin(int32_t i, int32_t native)
+{
+    if (g_actorJobs == ACTORJOBS_OFF)
+        return;
+
+    commitsectnum = sprite[i].sectnum;
+
+    // native code isn't tracked, it may change anything
+    if (native)
+        readworldintact = 0;
+}
+
+//
+// G_ActorCommitEnd
+//
+// The actor may have left, moved or changed in its old sector, and arrived in or changed in the new one.
+//
+void G_ActorCommitEnd(int32_t i)
+{
+    if (g_actorJobs == ACTORJOBS_OFF)
+        return;
+
+    G_MarkSectorDirty(commitsectnum);
+    G_MarkSectorDirty(sprite[i].sectnum);
+}
+
+//
+// G_ActorScriptJob
+//
+// Each worker runs with its own thread local vm, scripts in a batch only touch their own sprite and actor.
+//
+static void G_ActorScriptJob(void *data, int begin, int end)
+{
+    UNREFERENCED_PARAMETER(data);
+
+    for (int k = begin; k < end; k++)
+        scriptkill[k] = A_ExecuteScript(&scriptctx[k]);
+}
+
+//
+// G_ActorScriptBatch
+//
+int32_t G_ActorScriptBatch(int32_t i, int32_t *nexti)
+{
+#if !defined LUNATIC
+    int32_t j, k, n = 0, m = 0;
+
+    if (!g_actorScripts || g_netServer || g_netClient || ud.multimode > 1 || !jobSystem.IsInitialized())
+        return 0;
+
+    for (j = i; j >= 0 && n < ACTORJOBS_MAXSCRIPTS && A_CanRunScriptConcurrently(j); j = nextspritestat[j])
+        batchlist[n++] = j;
+
+    if (n < 2)
+        return 0;
+
+    // same order as the serial loop up to the script itself
+    for (k=0; k<n; k++)
+    {
+        const int32_t s = batchlist[k];
+        int32_t x;
+        const int32_t p = A_FindPlayerRead(s, &x);
+        vmstate_t ctx = { s, p, x, &actor[s].t_data[0], &sprite[s], g_player[p].ps, 0 };
+
+        Bmemcpy(&actor[s].bpos, &sprite[s], sizeof(vec3_t));
+        G_MarkSectorDirty(sprite[s].sectnum);
+
+        vm = ctx;
+
+        if (A_ExecuteBegin(&ctx))
+            scriptctx[m++] = ctx;
+    }
+
+    BuildJobCounter counter;
+    const double t = EDUKE32_PREDICT_FALSE(g_demoBench) ? Demo_BenchVMEnter() : 0.0;
+
+    jobSystem.ParallelFor(m, ACTORJOBS_SCRIPTBATCH, G_ActorScriptJob, NULL, &counter);
+    jobSystem.Wait(&counter);
+
+    if (EDUKE32_PREDICT_FALSE(g_demoBench))
+        Demo_BenchVMLeave(t);
+
+    *nexti = nextspritestat[batchlist[n-1]];
+
+    for (k=0; k<m; k++)
+    {
+        // A_ExecuteEnd may delete or put to sleep the last one, like the serial loop read its nexti first
+        if (scriptctx[k].g_i == batchlist[n-1])
+            *nexti = nextspritestat[batchlist[n-1]];
+
+        A_ExecuteEnd(&scriptctx[k], scriptkill[k]);
+        G_MarkSectorDirty(sprite[scriptctx[k].g_i].sectnum);
+    }
+
+    g_actorJobStats.batches++;
+    g_actorJobStats.scripts += m;
+
+    return 1;
+#else
+    UNREFERENCED_PARAMETER(i);
+    UNREFERENCED_PARAMETER(nexti);
+    return 0;
+#endif
+}
+
+//
+// G_WorldChecksum
+//
+uint32_t G_WorldChecksum(void)
+{
+    XXH32_stateSpace_t state;
+    int32_t i, k;
+
+    XXH32_resetState(&state, 0x1F2E3D4C);
+
+    for (k=0; k<MAXSTATUS; k++)
+    {
+        for (SPRITES_OF(k, i))
+        {
+            const actor_t *const a = &actor[i];
+
+            XXH32_update(&state, &i, sizeof(i));
+            XXH32_update(&state, &sprite[i], sizeof(spritetype));
+            XXH32_update(&state, a->t_data, sizeof(a->t_data));
+            XXH32_update(&state, &a->floorz, sizeof(a->floorz));
+            XXH32_update(&state, &a->ceilingz, sizeof(a->ceilingz));
+            XXH32_update(&state, &a->lastvx, sizeof(a->lastvx));
+            XXH32_update(&state, &a->lastvy, sizeof(a->lastvy));
+            XXH32_update(&state, &a->picnum, sizeof(a->picnum));
+            XXH32_update(&state, &a->ang, sizeof(a->ang));
+            XXH32_update(&state, &a->extra, sizeof(a->extra));
+            XXH32_update(&state, &a->owner, sizeof(a->owner));
+            XXH32_update(&state, &a->movflag, sizeof(a->movflag));
+            XXH32_update(&state, &a->timetosleep, sizeof(a->timetosleep));
+        }
+    }
+
+    for (TRAVERSE_CONNECT(i))
+    {
+        const DukePlayer_t *const ps = g_player[i].ps;
+
+        XXH32_update(&state, &ps->pos, sizeof(ps->pos));
+        XXH32_update(&state, &ps->vel, sizeof(ps->vel));
+        XXH32_update(&state, &ps->ang, sizeof(ps->ang));
+        XXH32_update(&state, &ps->horiz, sizeof(ps->horiz));
+        XXH32_update(&state, &ps->cursectnum, sizeof(ps->cursectnum));
+    }
+
+    XXH32_update(&state, sector, numsectors * sizeof(sectortype));
+    XXH32_update(&state, &randomseed, sizeof(randomseed));
+    XXH32_update(&state, &g_globalRandom, sizeof(g_globalRandom));
+
+    return XXH32_digest(&state);
+}
+
+//
+// G_RecordWorldChecksum
+//
+void G_RecordWorldChecksum(void)
+{
+    if (checksumfp == NULL)
+        return;
+
+    Bfprintf(checksumfp, "%u %08x\n", checksumtick++, G_WorldChecksum());
+}
+
+//
+// G_VerifyActorJobs
+//
+void G_VerifyActorJobs(int32_t tics)
+{
+    const int32_t levelnum = ud.volume_number*MAXLEVELS+ud.level_number;
+    mapstate_t *const heldstate = MapInfo[levelnum].savedstate;
+    const int32_t soundtoggle = ud.config.SoundToggle, actorjobs = g_actorJobs, actorscripts = g_actorScripts;
+    DukePlayer_t *const ps = g_player[myconnectindex].ps;
+    DukePlayer_t *const heldplayer = (DukePlayer_t *)Xmalloc(sizeof(DukePlayer_t));
+    const int16_t heldextra = sprite[ps->i].extra;
+    uint32_t *const sums = (uint32_t *)Xmalloc(tics * sizeof(uint32_t));
+    uint32_t firstsum = 0;
+    int32_t pass, i, first = -1, numdiffs = 0;
+
+    // don't clobber a state the script saved with savemapstate
+    MapInfo[levelnum].savedstate = NULL;
+    G_SaveMapState();
+    Bmemcpy(heldplayer, ps, sizeof(DukePlayer_t));
+
+    ud.config.SoundToggle = 0;
+
+    for (pass=0; pass<2; pass++)
+    {
+        g_actorJobs = pass ? ACTORJOBS_PARALLEL : ACTORJOBS_OFF;
+        g_actorScripts = pass;
+
+        for (i=0; i<tics; i++)
+        {
+            G_MoveWorld();
+
+            const uint32_t sum = G_WorldChecksum();
+
+            if (pass == 0)
+                sums[i] = sum;
+            else if (sum != sums[i] && numdiffs++ == 0)
+            {
+                first = i;
+                firstsum = sum;
+            }
+        }
+
+        // G_RestoreMapState keeps the players' health and doesn't know about the rest of the player
+        G_RestoreMapState();
+        Bmemcpy(ps, heldplayer, sizeof(DukePlayer_t));
+        sprite[ps->i].extra = heldextra;
+    }
+
+    if (numdiffs)
+        OSD_Printf(OSD_ERROR "actorjobs_verify: %d of %d tics differ, first at tic %d: serial %08x, parallel %08x\n",
+                   numdiffs, tics, first, sums[first], firstsum);
+    else
+        OSD_Printf("actorjobs_verify: %d tics match, last checksum %08x\n", tics, sums[tics-1]);
+
+    G_FreeMapState(levelnum);
+    MapInfo[levelnum].savedstate = heldstate;
+
+    ud.config.SoundToggle = soundtoggle;
+    g_actorJobs = actorjobs;
+    g_actorScripts = actorscripts;
+
+    Bfree(sums);
+    Bfree(heldplayer);
+}
+
+static int32_t osdcmd_actorjobs_stats(const osdfuncparm_t *parm)
+{
+    OSD_Printf("actor jobs: mode %d, %d workers\n", g_actorJobs, jobSystem.GetNumWorkers());
+    OSD_Printf("  read phases: %u, reads: %u, used: %u, recomputed: %u\n", g_actorJobStats.phases,
+               g_actorJobStats.reads, g_actorJobStats.hits, g_actorJobStats.misses);
+    OSD_Printf("  line of sight reads: %u, used: %u\n", g_actorJobStats.sightreads, g_actorJobStats.sighthits);
+    OSD_Printf("  ifcanshoottarget reads: %u, used: %u\n", g_actorJobStats.shootreads, g_actorJobStats.shoothits);
+    OSD_Printf("  checked: %u, divergences: %u\n", g_actorJobStats.checks, g_actorJobStats.divergences);
+    OSD_Printf("  script batches: %u, concurrent scripts: %u\n", g_actorJobStats.batches, g_actorJobStats.scripts);
+
+    if (parm->numparms > 0 && !Bstrcasecmp(parm->parms[0], "reset"))
+        Bmemset(&g_actorJobStats, 0, sizeof(g_actorJobStats));
+
+    return OSDCMD_OK;
+}
+
+static int32_t osdcmd_worldchecksum(const osdfuncparm_t *parm)
+{
+    if (checksumfp)
+    {
+        Bfclose(checksumfp);
+        checksumfp = NULL;
+        OSD_Printf("worldchecksum: stopped after %u ticks\n", checksumtick);
+    }
+
+    if (parm->numparms == 0)
+    {
+        OSD_Printf("world checksum: %08x\n", G_WorldChecksum());
+        return OSDCMD_OK;
+    }
+
+    if ((checksumfp = Bfopen(parm->parms[0], "w")) == NULL)
+    {
+        OSD_Printf("worldchecksum: couldn't open \"%s\"\n", parm->parms[0]);
+        return OSDCMD_OK;
+    }
+
+    checksumtick = 0;
+    OSD_Printf("worldchecksum: recording to \"%s\"\n", parm->parms[0]);
+
+    return OSDCMD_OK;
+}
+
+static int32_t osdcmd_actorjobs_verify(const osdfuncparm_t *parm)
+{
+    int32_t tics;
+
+    if (parm->numparms != 1 || (tics = Batol(parm->parms[0])) <= 0)
+        return OSDCMD_SHOWHELP;
+
+    if (numplayers > 1 || (g_player[myconnectindex].ps->gm & MODE_GAME) == 0)
+    {
+        OSD_Printf("actorjobs_verify: needs a single-player game in progress\n");
+        return OSDCMD_OK;
+    }
+
+    G_VerifyActorJobs(tics);
+    return OSDCMD_OK;
+}
+
+//
+// G_InitActorJobsOSD
+//
+void G_InitActorJobsOSD(void)
+{
+    static cvar_t cvar_actorjobs =
+        { "g_actorjobs", "actor update read phase: 0: serial  1: parallel  2: parallel, checked against serial", (void *)&g_actorJobs, CVAR_INT, 0, 2 };
+
+    static cvar_t cvar_actorscripts =
+        { "g_actorscripts", "run consecutive actors with local scripts on the job system: 0: off  1: on", (void *)&g_actorScripts, CVAR_BOOL, 0, 1 };
+
+    if (!OSD_RegisterCvar(&cvar_actorjobs))
+        OSD_RegisterFunction(cvar_actorjobs.name, cvar_actorjobs.desc, osdcmd_cvar_set);
+
+    if (!OSD_RegisterCvar(&cvar_actorscripts))
+        OSD_RegisterFunction(cvar_actorscripts.name, cvar_actorscripts.desc, osdcmd_cvar_set);
+
+    OSD_RegisterFunction("actorjobs_stats", "actorjobs_stats [reset]: prints actor read phase statistics", osdcmd_actorjobs_stats);
+    OSD_RegisterFunction("actorjobs_verify", "actorjobs_verify <tics>: runs the current map for <tics> serially and with g_actorjobs and g_actorscripts on, and compares the world checksums", osdcmd_actorjobs_verify);
+    OSD_RegisterFunction("worldchecksum", "worldchecksum [file]: prints the world checksum, or writes one per game tick to a file for comparing runs", osdcmd_worldchecksum);
+}
@@ -0,0 +1,142 @@
+// actorjobs.h
+//
+// Opt-in split of G_MoveWorld into a read phase that runs on the job system and the existing serial pass,
+// which becomes the commit phase. The read phase only computes values the serial pass would compute itself:
+// the nearest player, the lines of sight to a player that the sprite asked for in the previous phase, and
+// for actors, the hitscans behind ifcanshoottarget. Each one is checked against the inputs it was taken from
+// before it is used, so the result is bit exact against the plain serial path. actorjobs_verify runs both
+// paths from the same state and compares them.
+//
+// The random heights ifcansee and ifcanseetarget look from are all read at once, the script still draws the
+// number and picks one. While G_MoveActors only ran script instructions that C_KeywordWritesWorld lets
+// through and no actor with native code, the walls and sectors are as the read phase saw them and the only
+// sprites that moved are actors, whose sectors G_ActorCommitEnd marks. Reads are then checked against those
+// marks instead of being hashed.
+//
+// With g_actorscripts on, G_MoveActors also runs consecutive actors whose scripts the compiler classified as
+// local (see g_actorScriptLocal) concurrently: the serial A_ExecuteBegin for each, their scripts on the job
+// system, then the serial A_ExecuteEnd for each in list order. The serial path stays the reference, compare
+// the two with actorjobs_verify or worldchecksum.
+//
+
+#ifndef actorjobs_h_
+#define actorjobs_h_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+    ACTORJOBS_OFF,
+    ACTORJOBS_PARALLEL,
+    ACTORJOBS_CHECK,    // parallel, and every read is recomputed serially and compared
+};
+
+// Below this many sprites in a list the read phase runs inline.
+#define ACTORJOBS_MINSPRITES    64
+#define ACTORJOBS_BATCHSIZE     32
+
+// Longest run of actor scripts run as one batch, and the number of scripts per job.
+#define ACTORJOBS_MAXSCRIPTS    1024
+#define ACTORJOBS_SCRIPTBATCH   8
+
+// Lines of sight through more sectors than this aren't hashed, checking them costs about as much as cansee.
+#define ACTORJOBS_MAXSIGHTSECTORS   16
+
+// The hitscans of one ifcanshoottarget through more sectors than this aren't kept.
+#define ACTORJOBS_MAXSHOOTSECTORS   32
+
+enum
+{
+    ACTORSIGHT_VIEW,        // A_CanSeePlayerRead, to the player's view
+    ACTORSIGHT_TARGET,      // ifcanseetarget, to the player's view from (krand()&41)<<8 above the sprite
+    ACTORSIGHT_SPRITE,      // ifcansee, to the player's sprite from krand()&(47<<8) above the sprite
+    ACTORSIGHT_NUM
+};
+
+typedef struct
+{
+    vec3_t pos;             // position looked at
+    int32_t zoff;           // ACTORSIGHT_VIEW: height above the sprite it was looked from
+    int32_t phase;          // phase it was read in, 0 if it wasn't
+    uint32_t seemask;       // bit k set if the k-th height can see
+    uint32_t hash;          // G_SightHash of the sectors it went through
+    int16_t player;
+    int16_t sectnum;        // sector looked into
+    int16_t numsectors;     // -1 if there were more than ACTORJOBS_MAXSIGHTSECTORS
+    int8_t want;            // asked for in the commit phase, read in the next one
+    int8_t filler;
+} actorsight_t;
+
+typedef struct
+{
+    vec3_t pos;             // sprite position the read was taken at
+    int32_t dist;
+    int16_t player;
+    int16_t sectnum;
+    int32_t phase;          // g_actorReadPhase the read belongs to
+
+    // the rest of the sprite ifcanshoottarget looks at, and its result
+    int16_t ang, cstat, picnum;
+    uint8_t xrepeat;
+    int8_t shootwant, shootresult;
+    int8_t filler;
+    int16_t numshootsectors;
+    int32_t shootphase;     // phase ifcanshoottarget was read in, 0 if it wasn't
+
+    actorsight_t sight[ACTORSIGHT_NUM];
+} actorread_t;
+
+typedef struct
+{
+    uint32_t phases, reads, hits, misses;
+    uint32_t sightreads, sighthits;
+    uint32_t shootreads, shoothits;
+    uint32_t checks, divergences;
+    uint32_t batches, scripts;
+} actorjobstats_t;
+
+extern int32_t g_actorJobs;
+extern int32_t g_actorScripts;
+extern actorjobstats_t g_actorJobStats;
+
+// Read phase for one status list, results stay valid until the next call.
+void G_ActorReadPhase(int32_t statnum);
+
+// Drop-in for A_FindPlayer in the commit phase.
+int32_t A_FindPlayerRead(int32_t spritenum, int32_t *d);
+
+// Drop-in for cansee from zoff above the sprite to player p's view in the commit phase.
+int32_t A_CanSeePlayerRead(int32_t spritenum, int32_t zoff, int32_t p);
+
+// The line of sight of an ACTORSIGHT_ kind from zoff above the sprite to player p in the commit phase.
+int32_t A_CanSeeRead(int32_t spritenum, int32_t kind, int32_t zoff, int32_t p);
+
+// Drop-in for ifcanshoottarget in the commit phase, dist is the distance to the sprite's player.
+int32_t A_CanShootTargetRead(int32_t spritenum, int32_t dist);
+
+// G_MoveActors brackets each actor it updates with these, native is nonzero if the actor has native code.
+void G_ActorCommitBegin(int32_t i, int32_t native);
+void G_ActorCommitEnd(int32_t i);
+
+// Runs the scripts of the actors starting at sprite i on the job system, if there are at least two in a row
+// that A_CanRunScriptConcurrently accepts. Returns nonzero and the sprite to continue with in nexti if it did.
+int32_t G_ActorScriptBatch(int32_t i, int32_t *nexti);
+int32_t A_CanRunScriptConcurrently(int32_t i);
+
+// Checksum of the simulation state touched by G_MoveWorld, for comparing runs.
+uint32_t G_WorldChecksum(void);
+void G_RecordWorldChecksum(void);
+
+// Runs G_MoveWorld for the given number of tics serially and then from the same state with the read phase
+// and concurrent scripts on, reports the first tic whose checksum differs and puts the map state back.
+void G_VerifyActorJobs(int32_t tics);
+
+void G_InitActorJobsOSD(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -24,8 +24,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "pch.h"
 #define actors_c_
 #include "duke3d.h"
+#include "actorjobs.h"
+#include "demobench.h"
 
-#include "../Build/src/PolymerNG/PolymerNG_Public.h"
+#include "../Build/src/Profiler/profiler.h"
+
+#include "../Build/src/PolymerNG/PolymerNG_public.h"
 
 #if KRANDDEBUG
 # define ACTOR_STATIC
@@ -882,7 +886,7 @@ ACTOR_STATIC void G_MoveZombieActors(void)
 
         int32_t x;
         spritetype *const s = &sprite[i];
-        const int32_t p = A_FindPlayer(s,&x);
+        const int32_t p = A_FindPlayerRead(i, &x);
 
         int16_t ssect = s->sectnum;
         int16_t psect = s->sectnum;
@@ -1634,7 +1638,7 @@ ACTOR_STATIC void G_MoveStandables(void)
                         {
                             if (s->owner==-2)
                             {
-                                int32_t p = A_FindPlayer(s, NULL);
+                                int32_t p = A_FindPlayerRead(i, NULL);
                                 A_PlaySound(DUKE_GRUNT,g_player[p].ps->i);
                                 if (g_player[p].ps->on_crane == i)
                                     g_player[p].ps->on_crane = -1;
@@ -1722,7 +1726,7 @@ ACTOR_STATIC void G_MoveStandables(void)
 
             if (s->owner != -1)
             {
-                int32_t p = A_FindPlayer(s, NULL);
+                int32_t p = A_FindPlayerRead(i, NULL);
 
                 if (A_IncurDamage(i) >= 0)
                 {
@@ -1773,7 +1777,7 @@ ACTOR_STATIC void G_MoveStandables(void)
                 }
                 else
                 {
-                    A_FindPlayer(s,&x);
+                    A_FindPlayerRead(i, &x);
 
                     if (x > 512)
                     {
@@ -1887,7 +1891,7 @@ ACTOR_STATIC void G_MoveStandables(void)
             switch (T1)
             {
             default:
-                A_FindPlayer(s,&x);
+                A_FindPlayerRead(i, &x);
                 if (x > 768 || T1 > 16) T1++;
                 break;
 
@@ -2242,7 +2246,7 @@ DETONATE:
                 KILLIT(i);
 
             {
-                const int32_t p = A_FindPlayer(s, &x);
+                const int32_t p = A_FindPlayerRead(i, &x);
                 const DukePlayer_t *const ps = g_player[p].ps;
 
                 if (dist(&sprite[ps->i], s) < VIEWSCREEN_ACTIVE_DISTANCE)
@@ -2282,7 +2286,7 @@ DETONATE:
             //        case SIDEBOLT1+1:
             //        case SIDEBOLT1+2:
             //        case SIDEBOLT1+3:
-            A_FindPlayer(s, &x);
+            A_FindPlayerRead(i, &x);
             if (x > 20480) goto BOLT;
 
 CLEAR_THE_BOLT2:
@@ -2321,7 +2325,7 @@ CLEAR_THE_BOLT2:
             //        case BOLT1+1:
             //        case BOLT1+2:
             //        case BOLT1+3:
-            A_FindPlayer(s, &x);
+            A_FindPlayerRead(i, &x);
             if (x > 20480) goto BOLT;
 
             if (t[3] == 0)
@@ -2526,7 +2530,7 @@ CLEAR_THE_BOLT:
             if (!G_HaveActor(sprite[i].picnum))
                 goto BOLT;
             {
-                int32_t p = A_FindPlayer(s, &x);
+                int32_t p = A_FindPlayerRead(i, &x);
                 A_Execute(i,p,x);
             }
             goto BOLT;
@@ -2707,7 +2711,7 @@ ACTOR_STATIC void Proj_MoveCustom(int32_t i)
         if (!G_HaveActor(sprite[i].picnum))
             return;
         {
-            int32_t x, p = A_FindPlayer(s, &x);
+            int32_t x, p = A_FindPlayerRead(i, &x);
             A_Execute(i, p, x);
         }
         return;
@@ -3244,7 +3248,7 @@ COOLEXPLOSION:
             if (!G_HaveActor(sprite[i].picnum))
                 goto BOLT;
             {
-                int32_t p = A_FindPlayer(s,&x);
+                int32_t p = A_FindPlayerRead(i, &x);
                 A_Execute(i,p,x);
             }
             goto BOLT;
@@ -3655,6 +3659,61 @@ static int16_t A_FindLocator(int32_t n, int32_t sn)
     return -1;
 }
 
+// Tiles G_MoveActors handles natively before or instead of running their script.
+static int32_t A_HasNativeMove(int32_t picnum)
+{
+    if (picnum > GREENSLIME && picnum <= GREENSLIME+7)
+        return 1;
+
+    switch (DYNAMICTILEMAP(picnum))
+    {
+    case DUCK__STATIC:
+    case TARGET__STATIC:
+    case RESPAWNMARKERRED__STATIC:
+    case RESPAWNMARKERYELLOW__STATIC:
+    case RESPAWNMARKERGREEN__STATIC:
+    case HELECOPT__STATIC:
+    case DUKECAR__STATIC:
+    case RAT__STATIC:
+    case QUEBALL__STATIC:
+    case STRIPEBALL__STATIC:
+    case FORCESPHERE__STATIC:
+    case RECON__STATIC:
+    case OOZ__STATIC:
+    case OOZ2__STATIC:
+    case GREENSLIME__STATIC:
+    case BOUNCEMINE__STATIC:
+    case MORTER__STATIC:
+    case HEAVYHBOMB__STATIC:
+    case REACTORBURNT__STATIC:
+    case REACTOR2BURNT__STATIC:
+    case REACTOR__STATIC:
+    case REACTOR2__STATIC:
+    case CAMERA1__STATIC:
+        return 1;
+    }
+
+    return 0;
+}
+
+//
+// A_CanRunScriptConcurrently
+//
+// True if G_MoveActors would do nothing for sprite i but run its script, and that script is local.
+//
+int32_t A_CanRunScriptConcurrently(int32_t i)
+{
+    const spritetype *const s = &sprite[i];
+
+    if (s->xrepeat == 0 || (unsigned)s->sectnum >= MAXSECTORS)
+        return 0;
+
+    if (!G_HaveActor(s->picnum) || !g_actorScriptLocal[s->picnum] || A_HasNativeMove(s->picnum))
+        return 0;
+
+    return (g_noEnemies == 0 || !A_CheckEnemySprite(s));
+}
+
 ACTOR_STATIC void G_MoveActors(void)
 {
     int32_t x, m, l;
@@ -3664,6 +3723,13 @@ ACTOR_STATIC void G_MoveActors(void)
 
     while (i >= 0)
     {
+        // a run of actors with local scripts goes through the job system in one go
+        if (G_ActorScriptBatch(i, &j))
+        {
+            i = j;
+            continue;
+        }
+
         const int32_t nexti = nextspritestat[i];
 
         spritetype *const s = &sprite[i];
@@ -3672,6 +3738,8 @@ ACTOR_STATIC void G_MoveActors(void)
         int32_t switchpicnum;
         int32_t *const t = actor[i].t_data;
 
+        G_ActorCommitBegin(i, A_HasNativeMove(s->picnum));
+
         if (s->xrepeat == 0 || sect < 0 || sect >= MAXSECTORS)
             KILLIT(i);
 
@@ -3818,7 +3886,7 @@ ACTOR_STATIC void G_MoveActors(void)
             }
             else
             {
-                const int32_t p = A_FindPlayer(s,&x);
+                const int32_t p = A_FindPlayerRead(i, &x);
                 DukePlayer_t *const ps = g_player[p].ps;
 
                 if (x < 1596)
@@ -3992,7 +4060,7 @@ ACTOR_STATIC void G_MoveActors(void)
                     s->z = actor[i].floorz-(48<<8);
             }
 
-            p = A_FindPlayer(s,&x);
+            p = A_FindPlayerRead(i, &x);
             ps = g_player[p].ps;
 
             j = s->owner;
@@ -4010,7 +4078,7 @@ ACTOR_STATIC void G_MoveActors(void)
                     A_Shoot(i,FIRELASER);
                     s->ang = a;
                 }
-                if (t[2] > (GAMETICSPERSEC*3) || !cansee(s->x,s->y,s->z-(16<<8),s->sectnum, ps->pos.x,ps->pos.y,ps->pos.z,ps->cursectnum))
+                if (t[2] > (GAMETICSPERSEC*3) || !A_CanSeePlayerRead(i, 16<<8, p))
                 {
                     t[0] = 0;
                     t[2] = 0;
@@ -4033,7 +4101,7 @@ ACTOR_STATIC void G_MoveActors(void)
                 else
                 {
                     t[2]++;
-                    if (t[2] > (GAMETICSPERSEC*3) || !cansee(s->x,s->y,s->z-(16<<8),s->sectnum, ps->pos.x,ps->pos.y,ps->pos.z,ps->cursectnum))
+                    if (t[2] > (GAMETICSPERSEC*3) || !A_CanSeePlayerRead(i, 16<<8, p))
                     {
                         t[0] = 1;
                         t[2] = 0;
@@ -4167,7 +4235,7 @@ ACTOR_STATIC void G_MoveActors(void)
             if (sector[sect].floorstat&1)
                 KILLIT(i);
 
-            p = A_FindPlayer(s,&x);
+            p = A_FindPlayerRead(i, &x);
             ps = g_player[p].ps;
 
             if (x > 20480)
@@ -4548,7 +4616,7 @@ ACTOR_STATIC void G_MoveActors(void)
                 goto BOLT;
             }
 
-            p = A_FindPlayer(s,&x);
+            p = A_FindPlayerRead(i, &x);
             ps = g_player[p].ps;
 
             if (x < 1220) s->cstat &= ~257;
@@ -4724,7 +4792,7 @@ DETONATEB:
                 }
             }
             else if (s->picnum == HEAVYHBOMB && x < 788 && t[0] > 7 && s->xvel == 0)
-                if (cansee(s->x,s->y,s->z-(8<<8),s->sectnum,ps->pos.x,ps->pos.y,ps->pos.z,ps->cursectnum))
+                if (A_CanSeePlayerRead(i, 8<<8, p))
                     if (ps->ammo_amount[HANDBOMB_WEAPON] < ps->max_ammo_amount[HANDBOMB_WEAPON])
                     {
                         if ((GametypeFlags[ud.coop] & GAMETYPE_WEAPSTAY) && s->owner == i)
@@ -4813,7 +4881,7 @@ DETONATEB:
                 goto BOLT;
             }
 
-            p = A_FindPlayer(s,&x);
+            p = A_FindPlayerRead(i, &x);
             ps = g_player[p].ps;
 
             t[2]++;
@@ -4948,10 +5016,11 @@ DETONATEB:
 
         if (G_HaveActor(sprite[i].picnum))
         {
-            int32_t p = A_FindPlayer(s,&x);
+            int32_t p = A_FindPlayerRead(i, &x);
             A_Execute(i,p,x);
         }
 BOLT:
+        G_ActorCommitEnd(i);
         i = nexti;
     }
 }
@@ -5133,7 +5202,7 @@ ACTOR_STATIC void G_MoveMisc(void)  // STATNUM 5
             {
                 //        case INNERJAW+1:
 
-                int32_t p = A_FindPlayer(s,&x);
+                int32_t p = A_FindPlayerRead(i, &x);
                 if (x < 512)
                 {
                     P_PalFrom(g_player[p].ps, 32, 32,0,0);
@@ -5314,7 +5383,7 @@ ACTOR_STATIC void G_MoveMisc(void)  // STATNUM 5
 
                 A_Fall(i);
 
-                p = A_FindPlayer(s,&x);
+                p = A_FindPlayerRead(i, &x);
                 ps = g_player[p].ps;
 
                 s->z = actor[i].floorz - 1;
@@ -5393,7 +5462,7 @@ ACTOR_STATIC void G_MoveMisc(void)  // STATNUM 5
                 if (!G_HaveActor(sprite[i].picnum))
                     goto BOLT;
                 {
-                    int32_t p = A_FindPlayer(s,&x);
+                    int32_t p = A_FindPlayerRead(i, &x);
                     A_Execute(i,p,x);
                 }
                 goto BOLT;
@@ -5644,7 +5713,7 @@ ACTOR_STATIC void G_MoveEffectors(void)   //STATNUM 3
         const int32_t nexti = nextspritestat[i];
         spritetype *const s = &sprite[i];
 
-        int32_t p, pl = A_FindPlayer(s, &p);
+        int32_t p, pl = A_FindPlayerRead(i, &p);
 
         if (VM_OnEventWithBoth(EVENT_MOVEEFFECTORS, i, pl, p, 0))
         {
@@ -5932,7 +6001,7 @@ ACTOR_STATIC void G_MoveEffectors(void)   //STATNUM 3
                     }
                     else if (ud.monsters_off == 0 && sc->floorpal == 0 && (sc->floorstat&1) && rnd(8))
                     {
-                        p = A_FindPlayer(s,&x);
+                        p = A_FindPlayerRead(i, &x);
                         if (x < 20480)
                         {
                             j = s->ang;
@@ -6407,7 +6476,7 @@ ACTOR_STATIC void G_MoveEffectors(void)   //STATNUM 3
             //BOSS
         case SE_5:
         {
-            const int32_t p = A_FindPlayer(s,&x);
+            const int32_t p = A_FindPlayerRead(i, &x);
             DukePlayer_t *const ps = g_player[p].ps;
 
             if (x < 8192)
@@ -7469,7 +7538,7 @@ ACTOR_STATIC void G_MoveEffectors(void)   //STATNUM 3
 
             actor[i].tempang = s->ang;
 
-            p = A_FindPlayer(s,&x);
+            p = A_FindPlayerRead(i, &x);
             ps = g_player[p].ps;
 
             if (sprite[ps->i].extra > 0 && myconnectindex == screenpeek)
@@ -7481,7 +7550,7 @@ ACTOR_STATIC void G_MoveEffectors(void)   //STATNUM 3
                 }
                 else if (ud.recstat == 2 && ps->newowner == -1)
                 {
-                    if (cansee(s->x,s->y,s->z,SECT,ps->pos.x,ps->pos.y,ps->pos.z,ps->cursectnum))
+                    if (A_CanSeePlayerRead(i, 0, p))
                     {
                         if (x < (int32_t)((unsigned)sh))
                         {
@@ -7527,7 +7596,7 @@ ACTOR_STATIC void G_MoveEffectors(void)   //STATNUM 3
 
             if (T1 == 0)
             {
-                A_FindPlayer(s,&x);
+                A_FindPlayerRead(i, &x);
                 if (x > 15500)
                     break;
                 T1 = 1;
@@ -7555,7 +7624,7 @@ ACTOR_STATIC void G_MoveEffectors(void)   //STATNUM 3
                 }
                 else if (T3 > (T2>>3) && T3 < (T2>>2))
                 {
-                    if (cansee(s->x,s->y,s->z,s->sectnum,g_player[screenpeek].ps->pos.x,g_player[screenpeek].ps->pos.y,g_player[screenpeek].ps->pos.z,g_player[screenpeek].ps->cursectnum))
+                    if (A_CanSeePlayerRead(i, 0, screenpeek))
                         j = 1;
                     else j = 0;
 
@@ -7579,7 +7648,7 @@ ACTOR_STATIC void G_MoveEffectors(void)   //STATNUM 3
                                 sprite[j].cstat &= 32767;
                                 A_Spawn(j,SMALLSMOKE);
 
-                                p = A_FindPlayer(s, NULL);
+                                p = A_FindPlayerRead(i, NULL);
                                 ps = g_player[p].ps;
 
                                 x = ldist(&sprite[ps->i], &sprite[j]);
@@ -8350,6 +8419,8 @@ void G_MoveWorld(void)
 {
     extern double g_moveActorsTime;
 
+    BUILD_PROFILE_SCOPE("G_MoveWorld");
+
     VM_OnEvent(EVENT_PREWORLD, -1, -1);
 
     if (EDUKE32_PREDICT_FALSE(VM_HaveEvent(EVENT_PREGAME)))
@@ -8378,28 +8449,48 @@ void G_MoveWorld(void)
         } while (k < MAXSTATUS);
     }
 
+    // With g_actorjobs set, each list's read phase runs on the job system right before the serial pass
+    // over that list, which then only trusts reads whose inputs are still unchanged.
+    G_ActorReadPhase(STAT_ZOMBIEACTOR);
     G_MoveZombieActors();     //ST 2
-    G_MoveWeapons();          //ST 4
+    G_ActorReadPhase(STAT_PROJECTILE);
+    {
+        const double t = gethiticks();
+
+        G_MoveWeapons();          //ST 4
+
+        if (EDUKE32_PREDICT_FALSE(g_demoBench))
+            g_demoBenchMs[DEMOBENCH_MOVEWEAPONS] += gethiticks()-t;
+    }
     G_MoveTransports();       //ST 9
 
     G_MovePlayers();          //ST 10
     G_MoveFallers();          //ST 12
+    G_ActorReadPhase(STAT_MISC);
     G_MoveMisc();             //ST 5
 
     {
+        BUILD_PROFILE_SCOPE("G_MoveActors");
         double t = gethiticks();
 
+        G_ActorReadPhase(STAT_ACTOR);
         G_MoveActors();           //ST 1
 
-        g_moveActorsTime = (1-0.033)*g_moveActorsTime + 0.033*(gethiticks()-t);
+        t = gethiticks()-t;
+        g_moveActorsTime = (1-0.033)*g_moveActorsTime + 0.033*t;
+
+        if (EDUKE32_PREDICT_FALSE(g_demoBench))
+            g_demoBenchMs[DEMOBENCH_MOVEACTORS] += t;
     }
 
     // XXX: Has to be before effectors, in particular movers?
     // TODO: lights in moving sectors ought to be interpolated
     G_DoEffectorLights();
 
+    G_ActorReadPhase(STAT_EFFECTOR);
     G_MoveEffectors();        //ST 3
 
+    G_ActorReadPhase(STAT_STANDABLE);
     G_MoveStandables();       //ST 6
 
 
@@ -8435,4 +8526,6 @@ void G_MoveWorld(void)
     G_RefreshLights();
     G_DoSectorAnimations();
     G_MoveFX();               //ST 11
+
+    G_RecordWorldChecksum();
 }
@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "pch.h"
 #include "duke3d.h"
 #include "demo.h"
+#include "demobench.h"
 #include "screens.h"
 #include "renderlayer.h"
 
@@ -54,6 +55,7 @@ void G_ShowParameterHelp(void)
         "-connect [host]\tConnect to a multiplayer game\n"
         "-c#\t\tUse MP mode #, 1 = Dukematch, 2 = Coop, 3 = Dukematch(no spawn)\n"
         "-d [file.edm or demonum]\tPlay a demo\n"
+        "-demobench [file.edm or demonum] [file.json]\tPlay a demo without drawing or sound, write timings to a file and quit\n"
         "-g [file.grp]\tLoad additional game data\n"
         "-h [file.def]\tLoad an alternate definitions file\n"
         "-j [dir]\t\tAdds a directory to EDuke32's search list\n"
@@ -481,6 +483,23 @@ void G_CheckCommandLine(int32_t argc, char const * const * argv)
                     i++;
                     continue;
                 }
+                if (!Bstrcasecmp(c+1, "demobench"))
+                {
+                    if (argc > i+2)
+                    {
+                        // profiling with no frames per tic, the status screen and sound are off while benchmarking
+                        Demo_SetFirst(argv[i+1]);
+                        Demo_SetBenchmark(argv[i+2]);
+                        Demo_PlayFirst(1, 1);
+                        g_noLogo = 1;
+                        g_noSound = 2;
+                        g_noMusic = 1;
+                        initprintf("Benchmark demo %s, results in %s.\n", g_firstDemoFile, argv[i+2]);
+                        i += 2;
+                    }
+                    i++;
+                    continue;
+                }
 #ifdef HAVE_CLIPSHAPE_FEATURE
                 if (!Bstrcasecmp(c+1, "clipmap"))
                 {
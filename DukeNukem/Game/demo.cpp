@@ -22,6 +22,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "pch.h"
 #include "duke3d.h"
 #include "demo.h"
+#include "demobench.h"
 //#include "premap.h"  // G_UpdateScreenArea()
 #include "menus.h"
 #include "savegame.h"
@@ -395,10 +396,15 @@ static void Demo_StopProfiling(void)
     g_demo_stopProfile = 1;
 }
 
-static void Demo_GToc(double t)
+static void Demo_GToc(double t, int32_t outofsync)
 {
+    const double ms = gethiticks()-t;
+
     g_prof.numtics++;
-    g_prof.totalgamems += gethiticks()-t;
+    g_prof.totalgamems += ms;
+
+    if (g_demoBench)
+        Demo_BenchmarkTic(ms, outofsync);
 }
 
 static void Demo_RToc(double t1, double t2)
@@ -436,6 +442,9 @@ static void Demo_SetupProfile(void)
     Bmemset(&g_prof, 0, sizeof(g_prof));
 
     g_prof.starthiticks = gethiticks();
+
+    if (Demo_BenchmarkPending())
+        Demo_BeginBenchmark();
 }
 
 static void Demo_FinishProfile(void)
@@ -449,6 +458,9 @@ static void Demo_FinishProfile(void)
 
         ud.config.SoundToggle = g_demo_soundToggle;
 
+        if (g_demoBench)
+            Demo_FinishBenchmark(g_firstDemoFile, g_demo_cnt, g_demo_totalCnt);
+
         if (nt > 0)
         {
             OSD_Printf("== demo %d: %d gametics\n", dn, nt);
@@ -519,6 +531,9 @@ RECHECK:
 
     if (foundemo == 0)
     {
+        if (Demo_BenchmarkPending())
+            G_GameExit("Demo benchmark: couldn't play the demo.");
+
         ud.recstat = 0;
 
         if (g_whichDemo > 1)
@@ -740,7 +755,7 @@ nextdemo_nomenu:
                 {
                     double t = gethiticks();
                     G_DoMoveThings();
-                    Demo_GToc(t);
+                    Demo_GToc(t, outofsync);
                 }
                 else if (!g_demo_paused)
                 {
@@ -844,8 +859,9 @@ nextdemo_nomenu:
 
                 totalclock = ototalclock+4;
 
-                // draw status
-                Demo_DisplayProfStatus();
+                // draw status, unless there's nobody to look at it
+                if (!g_demoBench)
+                    Demo_DisplayProfStatus();
 
                 if (handleevents_peekkeys())
                     Demo_StopProfiling();
@@ -0,0 +1,189 @@
+// demobench.cpp
+//
+
+#include "pch.h"
+#include "duke3d.h"
+#include "demobench.h"
+#include "actorjobs.h"
+
+int32_t g_demoBench = 0;
+double g_demoBenchMs[DEMOBENCH_NUMTIMERS];
+int32_t g_demoBenchVMDepth = 0;
+
+static char benchfilename[BMAX_PATH];
+
+static const char *const timernames[DEMOBENCH_NUMTIMERS] =
+{
+    "tic", "G_MoveActors", "G_MoveWeapons", "VM_Execute", "clipmove", "hitscan"
+};
+
+// one row of g_demoBenchMs per tic
+static double (*ticms)[DEMOBENCH_NUMTIMERS];
+static int32_t numtics, maxtics;
+static int32_t outofsynctics;
+static uint32_t clipmoves, hitscans;
+static double starthiticks;
+
+//
+// Demo_SetBenchmark
+//
+void Demo_SetBenchmark(const char *filename)
+{
+    Bstrncpyz(benchfilename, filename, sizeof(benchfilename));
+}
+
+//
+// Demo_BenchmarkPending
+//
+int32_t Demo_BenchmarkPending(void)
+{
+    return (benchfilename[0] != 0);
+}
+
+//
+// Demo_BeginBenchmark
+//
+void Demo_BeginBenchmark(void)
+{
+    numtics = 0;
+    outofsynctics = 0;
+    clipmoves = hitscans = 0;
+
+    Bmemset(g_demoBenchMs, 0, sizeof(g_demoBenchMs));
+    Bmemset(&clipprofile, 0, sizeof(clipprofile));
+    g_demoBenchVMDepth = 0;
+
+    clipprofiling = 1;
+    g_demoBench = 1;
+
+    starthiticks = gethiticks();
+}
+
+//
+// Demo_BenchmarkTic
+//
+void Demo_BenchmarkTic(double ms, int32_t outofsync)
+{
+    if (!g_demoBench)
+        return;
+
+    if (numtics == maxtics)
+    {
+        maxtics = maxtics ? maxtics*2 : 4096;
+        ticms = (double (*)[DEMOBENCH_NUMTIMERS])Xrealloc(ticms, maxtics * sizeof(ticms[0]));
+    }
+
+    g_demoBenchMs[DEMOBENCH_TIC] = ms;
+    g_demoBenchMs[DEMOBENCH_CLIPMOVE] = clipprofile.clipmovems;
+    g_demoBenchMs[DEMOBENCH_HITSCAN] = clipprofile.hitscanms;
+
+    Bmemcpy(ticms[numtics++], g_demoBenchMs, sizeof(g_demoBenchMs));
+
+    clipmoves += clipprofile.clipmoves;
+    hitscans += clipprofile.hitscans;
+    outofsynctics += (outofsync != 0);
+
+    Bmemset(g_demoBenchMs, 0, sizeof(g_demoBenchMs));
+    Bmemset(&clipprofile, 0, sizeof(clipprofile));
+}
+
+static int32_t Demo_CompareMs(const void *a, const void *b)
+{
+    const double da = *(const double *)a, db = *(const double *)b;
+
+    return (da > db) - (da < db);
+}
+
+// nearest rank
+static double Demo_Percentile(const double *sorted, int32_t n, int32_t percent)
+{
+    const int32_t rank = (n * percent + 99) / 100;
+
+    return sorted[max(rank, 1) - 1];
+}
+
+static void Demo_WriteString(FILE *fp, const char *s)
+{
+    Bfputc('"', fp);
+
+    for (; *s; s++)
+    {
+        if (*s == '"' || *s == '\\')
+            Bfputc('\\', fp);
+
+        if ((uint8_t)*s >= 32)
+            Bfputc(*s, fp);
+    }
+
+    Bfputc('"', fp);
+}
+
+static void Demo_WriteTimer(FILE *fp, int32_t timer, double *column)
+{
+    double total = 0.0;
+
+    for (int32_t i = 0; i < numtics; i++)
+        total += (column[i] = ticms[i][timer]);
+
+    qsort(column, numtics, sizeof(double), Demo_CompareMs);
+
+    Bfprintf(fp, "    \"%s\": { \"total_ms\": %.4f, \"mean_ms\": %.6f, \"p50_ms\": %.6f, \"p95_ms\": %.6f, \"p99_ms\": %.6f, "
+             "\"max_ms\": %.6f",
+             timernames[timer], total, total / numtics, Demo_Percentile(column, numtics, 50),
+             Demo_Percentile(column, numtics, 95), Demo_Percentile(column, numtics, 99), column[numtics-1]);
+
+    if (timer == DEMOBENCH_CLIPMOVE || timer == DEMOBENCH_HITSCAN)
+        Bfprintf(fp, ", \"calls\": %u", timer == DEMOBENCH_CLIPMOVE ? clipmoves : hitscans);
+
+    Bfprintf(fp, " }%s\n", timer < DEMOBENCH_NUMTIMERS-1 ? "," : "");
+}
+
+//
+// Demo_FinishBenchmark
+//
+void Demo_FinishBenchmark(const char *demoname, int32_t numplayed, int32_t totaltics)
+{
+    FILE *fp;
+
+    if (!g_demoBench)
+        return;
+
+    g_demoBench = 0;
+    clipprofiling = 0;
+
+    const double totalms = gethiticks() - starthiticks;
+    const uint32_t checksum = G_WorldChecksum();
+
+    if ((fp = Bfopen(benchfilename, "w")) == NULL)
+        initprintf("demobench: couldn't open \"%s\" for writing\n", benchfilename);
+    else
+    {
+        Bfprintf(fp, "{\n  \"demo\": ");
+        Demo_WriteString(fp, demoname);
+        Bfprintf(fp, ",\n  \"tics\": %d,\n  \"demo_tics\": %d,\n  \"complete\": %s,\n", numplayed, totaltics,
+                 numplayed >= totaltics ? "true" : "false");
+        Bfprintf(fp, "  \"out_of_sync_tics\": %d,\n  \"checksum\": \"%08x\",\n", outofsynctics, checksum);
+        Bfprintf(fp, "  \"actorjobs\": %d,\n  \"actorscripts\": %d,\n", g_actorJobs, g_actorScripts);
+        Bfprintf(fp, "  \"wall_ms\": %.4f,\n  \"timers\": {\n", totalms);
+
+        if (numtics > 0)
+        {
+            double *const column = (double *)Xmalloc(numtics * sizeof(double));
+
+            for (int32_t i = 0; i < DEMOBENCH_NUMTIMERS; i++)
+                Demo_WriteTimer(fp, i, column);
+
+            Bfree(column);
+        }
+
+        Bfprintf(fp, "  }\n}\n");
+        Bfclose(fp);
+
+        initprintf("demobench: %d tics, checksum %08x, %d out of sync, results in \"%s\"\n", numtics, checksum,
+                   outofsynctics, benchfilename);
+    }
+
+    DO_FREE_AND_NULL(ticms);
+    numtics = maxtics = 0;
+    benchfilename[0] = 0;
+}
@@ -0,0 +1,61 @@
+// demobench.h
+//
+// Headless demo benchmark, started with -demobench. The demo plays through the profiling path of
+// G_PlaybackDemo with no frames drawn, no status screen and no sound. Every game tic is timed along with the
+// subsystems below, and once the demo ends the results are written to a JSON file and the game quits.
+//
+// Subsystem times are inclusive and overlap: the VM and clipping time spent inside G_MoveActors also counts
+// towards G_MoveActors. The world checksum at the end and the number of tics whose random seed didn't match
+// the recording tell whether the run stayed in sync, so only results with the same checksum are comparable.
+//
+
+#ifndef demobench_h_
+#define demobench_h_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+    DEMOBENCH_TIC,          // the whole G_DoMoveThings
+    DEMOBENCH_MOVEACTORS,
+    DEMOBENCH_MOVEWEAPONS,
+    DEMOBENCH_VM,           // actor scripts and events, as seen from the game thread
+    DEMOBENCH_CLIPMOVE,
+    DEMOBENCH_HITSCAN,
+    DEMOBENCH_NUMTIMERS
+};
+
+extern int32_t g_demoBench;                         // set while the benchmark times tics
+extern double g_demoBenchMs[DEMOBENCH_NUMTIMERS];   // the tic in progress, in ms
+extern int32_t g_demoBenchVMDepth;
+
+// The outermost VM entry on the game thread times the whole call, scripts and events run from it are part of
+// it. Concurrent actor scripts count once, as the time the game thread waits for them.
+FORCE_INLINE double Demo_BenchVMEnter(void)
+{
+    return g_demoBenchVMDepth++ ? 0.0 : gethiticks();
+}
+
+FORCE_INLINE void Demo_BenchVMLeave(double t)
+{
+    if (--g_demoBenchVMDepth == 0)
+        g_demoBenchMs[DEMOBENCH_VM] += gethiticks()-t;
+}
+
+// From the command line, the first demo played is benchmarked and the results go to filename.
+void Demo_SetBenchmark(const char *filename);
+
+// Nonzero from Demo_SetBenchmark until the results are written.
+int32_t Demo_BenchmarkPending(void);
+
+void Demo_BeginBenchmark(void);
+void Demo_BenchmarkTic(double ms, int32_t outofsync);
+void Demo_FinishBenchmark(const char *demoname, int32_t numplayed, int32_t totaltics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -35,12 +35,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "demo.h"
 #include "input.h"
 #include "colmatch.h"
-#include "cheats.h"
+#include "Cheats.h"
 #include "sbar.h"
 #include "screens.h"
 #include "cmdline.h"
 
-#include "../Build/src/PolymerNG/PolymerNG_Public.h"
+#include "../Build/src/PolymerNG/PolymerNG_public.h"
 
 #ifdef __ANDROID__
 #include "android.h"
@@ -65,6 +65,7 @@ static int32_t C_SetScriptSize(int32_t size);
 #endif
 
 int32_t g_numQuoteRedefinitions = 0;
+uint8_t g_actorScriptLocal[MAXTILES];
 
 #ifdef LUNATIC
 weapondata_t g_playerWeapon[MAXPLAYERS][MAX_WEAPONS];
@@ -1645,6 +1646,511 @@ static int32_t parse_hex_constant(const char *hexnum)
     return x;
 }
 
+// Classification of actor scripts for A_ExecuteScript on the job system. An actor is local if its code and
+// every state it calls only read its own sprite and actor data, only write script-private state (t_data,
+// the sleep time and per-actor gamevars), and never consume krand(). A batch runs every script before the
+// first A_ExecuteEnd, so a write to the sprite itself (cstat, clipdist, size, pal, strength, picnum or
+// killit) would be seen by the movement of the actors before it, which the serial order doesn't allow.
+// Everything else (arrays, structs, global or per-player gamevars, anything spawning, sounds, other
+// sprites, the player) runs serially. The marks are collected while parsing and resolved in C_Compile once
+// every state label is known.
+enum
+{
+    CLASSIFY_NONLOCAL,  // unit uses something that isn't local
+    CLASSIFY_STATE,     // unit calls state `arg'
+    CLASSIFY_MOVE,      // `move' at script offset `arg', local unless its flags ask for random_angle
+    CLASSIFY_AI,        // `ai' at script offset `arg', same as above for the ai's move flags
+    CLASSIFY_ACTOR,     // unit is the definition of actor `arg'
+};
+
+#define CLASSIFY_NONE   INT32_MIN
+
+typedef struct
+{
+    int32_t unit, type, arg;
+} classifyref_t;
+
+// label index of the state being parsed, -1-n for the n-th actor definition, or CLASSIFY_NONE
+static int32_t g_classifyUnit = CLASSIFY_NONE, g_classifyMarked, g_classifyNumActors;
+static classifyref_t *g_classifyRefs;
+static int32_t g_classifyNumRefs, g_classifyMaxRefs;
+
+static void C_ClassifyRef(int32_t type, int32_t arg)
+{
+    if (g_classifyUnit == CLASSIFY_NONE)
+        return;
+
+    if (type == CLASSIFY_NONLOCAL)
+    {
+        if (g_classifyMarked)
+            return;
+        g_classifyMarked = 1;
+    }
+
+    if (g_classifyNumRefs >= g_classifyMaxRefs)
+    {
+        g_classifyMaxRefs = g_classifyMaxRefs ? g_classifyMaxRefs<<1 : 1024;
+        g_classifyRefs = (classifyref_t *)Xrealloc(g_classifyRefs, g_classifyMaxRefs * sizeof(classifyref_t));
+    }
+
+    classifyref_t *const ref = &g_classifyRefs[g_classifyNumRefs++];
+    ref->unit = g_classifyUnit;
+    ref->type = type;
+    ref->arg = arg;
+}
+
+static void C_ClassifyBegin(int32_t unit)
+{
+    g_classifyUnit = unit;
+    g_classifyMarked = 0;
+}
+
+// The instructions that only touch the actor's own script state, see above. move and ai depend on their flags.
+static int32_t C_KeywordIsLocal(int32_t tw)
+{
+    switch (tw)
+    {
+    case CON_LEFTBRACE:
+    case CON_RIGHTBRACE:
+    case CON_ELSE:
+    case CON_STATE:
+    case CON_ENDA:
+    case CON_ENDS:
+    case CON_NULLOP:
+    case CON_RETURN:
+    case CON_BREAK:
+    case CON_ACTION:
+    case CON_IFACTION:
+    case CON_IFAI:
+    case CON_IFMOVE:
+    case CON_IFACTIONCOUNT:
+    case CON_RESETACTIONCOUNT:
+    case CON_IFCOUNT:
+    case CON_RESETCOUNT:
+    case CON_COUNT:
+    case CON_IFPDISTL:
+    case CON_IFPDISTG:
+    case CON_IFSPRITEPAL:
+    case CON_IFSPAWNEDBY:
+    case CON_IFDEAD:
+    case CON_IFGAPZL:
+    case CON_IFFLOORDISTL:
+    case CON_IFCEILINGDISTL:
+    case CON_IFINWATER:
+    case CON_IFONWATER:
+    case CON_IFINSPACE:
+    case CON_IFINOUTERSPACE:
+    case CON_IFOUTSIDE:
+    case CON_IFNOTMOVING:
+    case CON_IFAWAYFROMWALL:
+    case CON_IFSTRENGTH:
+    case CON_IFACTOR:
+    case CON_SLEEPTIME:
+    case CON_IFANGDIFFL:
+    case CON_IFACTORNOTSTAYPUT:
+    case CON_IFRESPAWN:
+    case CON_IFMULTIPLAYER:
+    // the gamevar operands are checked in C_GetNextVarType
+    case CON_IFVARL:
+    case CON_IFVARG:
+    case CON_IFVARE:
+    case CON_IFVARN:
+    case CON_IFVARAND:
+    case CON_IFVARVARL:
+    case CON_IFVARVARG:
+    case CON_IFVARVARE:
+    case CON_IFVARVARN:
+    case CON_IFVARVARAND:
+    case CON_SETVAR:
+    case CON_ADDVAR:
+    case CON_SUBVAR:
+    case CON_MULVAR:
+    case CON_DIVVAR:
+    case CON_MODVAR:
+    case CON_ANDVAR:
+    case CON_ORVAR:
+    case CON_XORVAR:
+    case CON_SETVARVAR:
+    case CON_ADDVARVAR:
+    case CON_SUBVARVAR:
+    case CON_MULVARVAR:
+    case CON_DIVVARVAR:
+    case CON_MODVARVAR:
+    case CON_ANDVARVAR:
+    case CON_ORVARVAR:
+    case CON_XORVARVAR:
+        return 1;
+    }
+
+    return 0;
+}
+
+//
+// C_KeywordWritesWorld
+//
+// Whether an instruction may change sectors, walls, the sprite lists or any sprite but the actor's own. The
+// local ones can't, and neither can the ones below, which only read the world, consume krand(), play sounds,
+// or write the actor's own sprite or its player's counters. The optimized instructions are gamevar and own
+// actor ones.
+//
+int32_t C_KeywordWritesWorld(int32_t tw)
+{
+    if (tw >= CON_END)
+        return (tw >= CON_OPT_END);
+
+    if (C_KeywordIsLocal(tw))
+        return 0;
+
+    switch (tw)
+    {
+    case CON_MOVE:
+    case CON_AI:
+    case CON_IFRND:
+    case CON_IFCANSEE:
+    case CON_IFCANSEETARGET:
+    case CON_IFCANSHOOTTARGET:
+    case CON_IFP:
+    case CON_IFPHEALTHL:
+    case CON_IFPINVENTORY:
+    case CON_IFHITWEAPON:
+    case CON_IFSOUND:
+    case CON_IFNOSOUNDS:
+    case CON_CSTAT:
+    case CON_CSTATOR:
+    case CON_SPRITEPAL:
+    case CON_SIZEAT:
+    case CON_SIZETO:
+    case CON_STRENGTH:
+    case CON_CLIPDIST:
+    case CON_CACTOR:
+    case CON_KILLIT:
+    case CON_SOUND:
+    case CON_SOUNDONCE:
+    case CON_STOPSOUND:
+    case CON_GLOBALSOUND:
+    case CON_ADDKILLS:
+        return 0;
+    }
+
+    return 1;
+}
+
+static void C_ClassifyKeyword(int32_t tw)
+{
+    if (g_classifyUnit == CLASSIFY_NONE || C_KeywordIsLocal(tw))
+        return;
+
+    switch (tw)
+    {
+    case CON_MOVE:
+        C_ClassifyRef(CLASSIFY_MOVE, g_scriptPtr-script-1);
+        return;
+
+    case CON_AI:
+        C_ClassifyRef(CLASSIFY_AI, g_scriptPtr-script-1);
+        return;
+
+    default:
+        C_ClassifyRef(CLASSIFY_NONLOCAL, tw);
+        return;
+    }
+}
+
+static void C_ClassifyVar(int32_t i)
+{
+    if (i != g_iThisActorID && !(aGameVars[i].dwFlags & GAMEVAR_PERACTOR))
+        C_ClassifyRef(CLASSIFY_NONLOCAL, i);
+}
+
+//
+// C_ClassifyActors
+//
+// Resolves the marks collected during parsing into g_actorScriptLocal[].
+//
+static void C_ClassifyActors(void)
+{
+    uint8_t *const statenonlocal = (uint8_t *)Xcalloc(g_numLabels + 1, 1);
+    uint8_t *const actornonlocal = (uint8_t *)Xcalloc(g_classifyNumActors + 1, 1);
+    int32_t i, changed, numlocal = 0;
+
+#define UNIT_NONLOCAL(unit) ((unit) < 0 ? &actornonlocal[-1-(unit)] : &statenonlocal[(unit)])
+
+    for (i=0; i<g_classifyNumRefs; i++)
+    {
+        const classifyref_t *const ref = &g_classifyRefs[i];
+        int32_t flags;
+
+        switch (ref->type)
+        {
+        case CLASSIFY_NONLOCAL:
+            *UNIT_NONLOCAL(ref->unit) = 1;
+            break;
+        case CLASSIFY_MOVE:
+            flags = script[ref->arg+2];
+            if (flags & random_angle)
+                *UNIT_NONLOCAL(ref->unit) = 1;
+            break;
+        case CLASSIFY_AI:
+            flags = script[script[ref->arg+1]+2];
+            if (flags & random_angle)
+                *UNIT_NONLOCAL(ref->unit) = 1;
+            break;
+        }
+    }
+
+    // callers of nonlocal states are nonlocal, until nothing changes
+    do
+    {
+        changed = 0;
+
+        for (i=0; i<g_classifyNumRefs; i++)
+        {
+            const classifyref_t *const ref = &g_classifyRefs[i];
+
+            if (ref->type == CLASSIFY_STATE && statenonlocal[ref->arg] && !*UNIT_NONLOCAL(ref->unit))
+            {
+                *UNIT_NONLOCAL(ref->unit) = 1;
+                changed = 1;
+            }
+        }
+    }
+    while (changed);
+
+    // a redefined actor takes the classification of its last definition, like its execPtr
+    for (i=0; i<g_classifyNumRefs; i++)
+    {
+        const classifyref_t *const ref = &g_classifyRefs[i];
+
+        if (ref->type == CLASSIFY_ACTOR)
+            g_actorScriptLocal[ref->arg] = !actornonlocal[-1-ref->unit];
+    }
+
+#undef UNIT_NONLOCAL
+
+    for (i=0; i<MAXTILES; i++)
+        numlocal += g_actorScriptLocal[i];
+
+    if (g_scriptDebug)
+        initprintf("%d actor script%s can run concurrently\n", numlocal, numlocal == 1 ? "" : "s");
+
+    Bfree(statenonlocal);
+    Bfree(actornonlocal);
+}
+
+static void C_ClassifyReset(void)
+{
+    DO_FREE_AND_NULL(g_classifyRefs);
+    g_classifyNumRefs = g_classifyMaxRefs = g_classifyNumActors = 0;
+    g_classifyUnit = CLASSIFY_NONE;
+}
+
+// Every keyword the parser emits, so C_OptimizeScript knows where instructions start. Entries can go stale
+// when the parser backs up over something it already emitted, so each one is checked against the script.
+typedef struct
+{
+    int32_t ofs, tw;
+} scriptinst_t;
+
+static scriptinst_t *g_scriptInsts;
+static int32_t g_numScriptInsts, g_maxScriptInsts;
+
+typedef struct
+{
+    int32_t ofs;
+    intptr_t orig, opt;
+} scriptopt_t;
+
+static scriptopt_t *g_scriptOpts;
+static int32_t g_numScriptOpts, g_maxScriptOpts;
+
+int32_t g_scriptOptimize = 1;
+
+static void C_NoteInstruction(int32_t tw)
+{
+    if (tw < 0)
+        return;
+
+    if (g_numScriptInsts >= g_maxScriptInsts)
+    {
+        g_maxScriptInsts = g_maxScriptInsts ? g_maxScriptInsts<<1 : 4096;
+        g_scriptInsts = (scriptinst_t *)Xrealloc(g_scriptInsts, g_maxScriptInsts * sizeof(scriptinst_t));
+    }
+
+    g_scriptInsts[g_numScriptInsts].ofs = g_scriptPtr-script-1;
+    g_scriptInsts[g_numScriptInsts].tw = tw;
+    g_numScriptInsts++;
+}
+
+static void C_AddOptimization(int32_t ofs, int32_t op)
+{
+    if (g_numScriptOpts >= g_maxScriptOpts)
+    {
+        g_maxScriptOpts = g_maxScriptOpts ? g_maxScriptOpts<<1 : 1024;
+        g_scriptOpts = (scriptopt_t *)Xrealloc(g_scriptOpts, g_maxScriptOpts * sizeof(scriptopt_t));
+    }
+
+    scriptopt_t *const so = &g_scriptOpts[g_numScriptOpts++];
+    so->ofs = ofs;
+    so->orig = script[ofs];
+    so->opt = (script[ofs] & ~VM_INSTMASK) | op;
+}
+
+// 0: not a plain gamevar, 1: global, 2: per-actor
+static int32_t C_PlainVarKind(intptr_t id)
+{
+    if ((uintptr_t)id >= (uintptr_t)g_gameVarCount || id == g_iThisActorID || (aGameVars[id].dwFlags & GAMEVAR_SPECIAL))
+        return 0;
+
+    switch (aGameVars[id].dwFlags & (GAMEVAR_USER_MASK|GAMEVAR_PTR_MASK))
+    {
+    case 0: return 1;
+    case GAMEVAR_PERACTOR: return 2;
+    }
+
+    return 0;
+}
+
+//
+// C_OptimizeScript
+//
+// The first call after a compile looks for the sequences CON_OPT_* stand for and records them, every call
+// then writes either the optimized or the original opcodes over the script. Returns the number of
+// instructions in the requested state.
+//
+int32_t C_OptimizeScript(int32_t enable)
+{
+    int32_t i, n = 0;
+
+    if (script == NULL)
+        return 0;
+
+    if (g_scriptInsts != NULL)
+    {
+        uint8_t *const isinst = (uint8_t *)Xcalloc(g_scriptSize, 1);
+
+        for (i=0; i<g_numScriptInsts; i++)
+        {
+            const scriptinst_t *const si = &g_scriptInsts[i];
+
+            if ((unsigned)si->ofs < (unsigned)g_scriptSize)
+                isinst[si->ofs] = ((script[si->ofs] & VM_INSTMASK) == si->tw);
+        }
+
+#define INST_AT(ofs, op) ((ofs) < g_scriptSize && isinst[ofs] && (script[ofs] & VM_INSTMASK) == (op))
+#define JUMP_AT(ofs) ((ofs) < g_scriptSize && BITPTR_IS_POINTER(ofs))
+
+        for (i=0; i<g_numScriptInsts; i++)
+        {
+            const int32_t ofs = g_scriptInsts[i].ofs;
+            const int32_t tw = g_scriptInsts[i].tw;
+            int32_t kind;
+
+            if (!INST_AT(ofs, tw))
+                continue;
+
+            switch (tw)
+            {
+            // [op][var][value][jump]
+            case CON_IFVARE:
+            case CON_IFVARN:
+            case CON_IFVARL:
+            case CON_IFVARG:
+            case CON_IFVARAND:
+            {
+                static const int32_t gops[] = { CON_OPT_IFGVARE, CON_OPT_IFGVARN, CON_OPT_IFGVARL, CON_OPT_IFGVARG, CON_OPT_IFGVARAND };
+                static const int32_t aops[] = { CON_OPT_IFAVARE, CON_OPT_IFAVARN, CON_OPT_IFAVARL, CON_OPT_IFAVARG, CON_OPT_IFAVARAND };
+                const int32_t k = (tw == CON_IFVARE) ? 0 : (tw == CON_IFVARN) ? 1 : (tw == CON_IFVARL) ? 2 : (tw == CON_IFVARG) ? 3 : 4;
+
+                if (!JUMP_AT(ofs+3) || (kind = C_PlainVarKind(script[ofs+1])) == 0)
+                    break;
+
+                C_AddOptimization(ofs, kind == 1 ? gops[k] : aops[k]);
+                break;
+            }
+
+            // [op][var][value]
+            case CON_SETVAR:
+            case CON_ADDVAR:
+                if ((kind = C_PlainVarKind(script[ofs+1])) == 0)
+                    break;
+
+                if (tw == CON_SETVAR)
+                    C_AddOptimization(ofs, kind == 1 ? CON_OPT_SETGVAR : CON_OPT_SETAVAR);
+                else
+                    C_AddOptimization(ofs, kind == 1 ? CON_OPT_ADDGVAR : CON_OPT_ADDAVAR);
+                break;
+
+            // [op][value][jump] directly followed by the [op][value][jump] that is its whole body
+            case CON_IFACTION:
+            case CON_IFAI:
+            case CON_IFMOVE:
+                if (!JUMP_AT(ofs+2) || !JUMP_AT(ofs+5))
+                    break;
+
+                if (tw == CON_IFACTION && INST_AT(ofs+3, CON_IFACTIONCOUNT))
+                    C_AddOptimization(ofs, CON_OPT_IFACTION_IFACTIONCOUNT);
+                else if (INST_AT(ofs+3, CON_IFCOUNT))
+                    C_AddOptimization(ofs, tw == CON_IFACTION ? CON_OPT_IFACTION_IFCOUNT :
+                                           tw == CON_IFAI ? CON_OPT_IFAI_IFCOUNT : CON_OPT_IFMOVE_IFCOUNT);
+                break;
+
+            // [getactor][THISACTOR][label][var] [addvar][var][value] [setactor][THISACTOR][label][var]
+            case CON_GETACTOR:
+            {
+                const intptr_t label = script[ofs+2], var = script[ofs+3];
+
+                if (script[ofs+1] != g_iThisActorID || (ActorLabels[label].flags & LABEL_HASPARM2) ||
+                        (uintptr_t)var >= (uintptr_t)g_gameVarCount || var == g_iThisActorID)
+                    break;
+
+                if (!INST_AT(ofs+4, CON_ADDVAR) || script[ofs+5] != var)
+                    break;
+
+                if (!INST_AT(ofs+7, CON_SETACTOR) || script[ofs+8] != g_iThisActorID || script[ofs+9] != label ||
+                        script[ofs+10] != var)
+                    break;
+
+                C_AddOptimization(ofs, CON_OPT_ACTORADD);
+                break;
+            }
+            }
+        }
+
+#undef INST_AT
+#undef JUMP_AT
+
+        Bfree(isinst);
+        DO_FREE_AND_NULL(g_scriptInsts);
+        g_numScriptInsts = g_maxScriptInsts = 0;
+    }
+
+    for (i=0; i<g_numScriptOpts; i++)
+    {
+        const scriptopt_t *const so = &g_scriptOpts[i];
+
+        if ((unsigned)so->ofs >= (unsigned)g_scriptSize)
+            continue;
+
+        // a loaded savegame brings its own copy of the script, leave anything that doesn't match alone
+        if (script[so->ofs] == (enable ? so->orig : so->opt))
+        {
+            script[so->ofs] = enable ? so->opt : so->orig;
+            n++;
+        }
+        else if (script[so->ofs] == (enable ? so->opt : so->orig))
+            n++;
+    }
+
+    return n;
+}
+
+static void C_ResetOptimizations(void)
+{
+    DO_FREE_AND_NULL(g_scriptInsts);
+    DO_FREE_AND_NULL(g_scriptOpts);
+    g_numScriptInsts = g_maxScriptInsts = g_numScriptOpts = g_maxScriptOpts = 0;
+}
+
 static void C_GetNextVarType(int32_t type)
 {
     int32_t i=0,f=0;
@@ -1706,6 +2212,8 @@ static void C_GetNextVarType(int32_t type)
     {
         int32_t lLabelID = -1;
 
+        C_ClassifyRef(CLASSIFY_NONLOCAL, 0);
+
         f |= (MAXGAMEVARS<<2);
         textptr++;
         i=GetADefID(label+(g_numLabels<<6));
@@ -1940,6 +2448,8 @@ static void C_GetNextVarType(int32_t type)
     if (!(g_numCompilerErrors || g_numCompilerWarnings) && g_scriptDebug > 1)
         initprintf("%s:%d: debug: gamevar `%s'.\n",g_szScriptFileName,g_lineNumber,label+(g_numLabels<<6));
 
+    C_ClassifyVar(i);
+
     BITPTR_CLEAR(g_scriptPtr-script);
     *g_scriptPtr++=(i|f);
 }
@@ -2839,7 +3349,11 @@ static int32_t C_ParseCommand(int32_t loop)
 
         int32_t const otw = g_lastKeyword;
 
-        switch ((g_lastKeyword = tw = C_GetNextKeyword()))
+        g_lastKeyword = tw = C_GetNextKeyword();
+        C_ClassifyKeyword(tw);
+        C_NoteInstruction(tw);
+
+        switch (tw)
         {
         default:
         case -1:
@@ -2864,6 +3378,7 @@ DO_DEFSTATE:
 
                 g_processingState = 1;
                 Bsprintf(g_szCurrentBlockName,"%s",label+(g_numLabels<<6));
+                C_ClassifyBegin(g_numLabels);
 
                 if (EDUKE32_PREDICT_FALSE(hash_find(&h_keywords,label+(g_numLabels<<6))>=0))
                 {
@@ -2909,6 +3424,7 @@ DO_DEFSTATE:
             if (!(g_numCompilerErrors || g_numCompilerWarnings) && g_scriptDebug > 1)
                 initprintf("%s:%d: debug: state label `%s'.\n", g_szScriptFileName, g_lineNumber, label+(j<<6));
             *g_scriptPtr = (intptr_t) (script+labelcode[j]);
+            C_ClassifyRef(CLASSIFY_STATE, j);
 
             // 'state' type labels are always script addresses, as far as I can see
             BITPTR_SET(g_scriptPtr-script);
@@ -2945,6 +3461,7 @@ DO_DEFSTATE:
                 }
 
                 g_processingState = 0;
+                C_ClassifyBegin(CLASSIFY_NONE);
                 Bsprintf(g_szCurrentBlockName,"(none)");
             }
             continue;
@@ -3434,6 +3951,9 @@ DO_DEFSTATE:
 
             g_tile[*g_scriptPtr].execPtr = script + g_parsingActorPtr;
 
+            C_ClassifyBegin(-1 - g_classifyNumActors++);
+            C_ClassifyRef(CLASSIFY_ACTOR, *g_scriptPtr);
+
             if (tw == CON_USERACTOR)
             {
                 if (j & 1)
@@ -5887,6 +6407,7 @@ repeatcase:
                 g_numCompilerErrors++;
             }
             g_parsingActorPtr = 0;
+            C_ClassifyBegin(CLASSIFY_NONE);
             Bsprintf(g_szCurrentBlockName,"(none)");
             continue;
 
@@ -6270,6 +6791,10 @@ void C_Compile(const char *filenam)
 
     C_InitProjectiles();
 
+    Bmemset(g_actorScriptLocal, 0, sizeof(g_actorScriptLocal));
+    C_ClassifyReset();
+    C_ResetOptimizations();
+
     int32_t fp = kopen4loadfrommod(filenam,g_loadFromGroupOnly);
 
     if (fp == -1) // JBF: was 0
@@ -6404,6 +6929,14 @@ void C_Compile(const char *filenam)
 
         C_SetScriptSize(g_scriptPtr-script+8);
 
+        C_ClassifyActors();
+        C_ClassifyReset();
+
+        i = C_OptimizeScript(g_scriptOptimize);
+
+        if (g_scriptDebug)
+            initprintf("%d instructions optimized\n", i);
+
         initprintf("Script compiled in %dms, %ld bytes%s\n", getticks() - startcompiletime,
                    (unsigned long)(g_scriptPtr-script), C_ScriptVersionString(g_scriptVersion));
 
@@ -31,6 +31,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 extern "C" {
 #endif
 
+// The interpreter state (vm, insptr and the error reporting globals) is per thread, so actor scripts can run on
+// the job system. Every invocation loads its own context and restores the caller's when it's done.
+#if defined __cplusplus
+# define VM_TLS thread_local
+#elif defined _MSC_VER
+# define VM_TLS __declspec(thread)
+#else
+# define VM_TLS _Thread_local
+#endif
+
 #define MAXGAMEEVENTS   128
 #define LABEL_HASPARM2  1
 #define LABEL_ISSTRING  2
@@ -51,7 +61,7 @@ extern "C" {
     g_numCompilerWarnings++; \
     } while (0)
 
-extern intptr_t const * insptr;
+extern VM_TLS intptr_t const * insptr;
 extern void VM_ScriptInfo(intptr_t const *ptr, int32_t range);
 
 extern hashtable_t h_gamefuncs;
@@ -103,6 +113,14 @@ extern char g_szScriptFileName[BMAX_PATH];
 extern int32_t g_totalLines,g_lineNumber;
 extern int32_t g_numCompilerErrors,g_numCompilerWarnings,g_numQuoteRedefinitions;
 extern int32_t g_scriptVersion;
+
+// Nonzero for actors whose script only reads their own sprite and actor data and only writes t_data, the sleep
+// time and per-actor gamevars, filled in by C_Compile. Those can run through A_ExecuteScript on the job system.
+extern uint8_t g_actorScriptLocal[MAXTILES];
+
+// Nonzero if instruction tw may change sectors, walls, the sprite lists or a sprite other than the actor's own.
+int32_t C_KeywordWritesWorld(int32_t tw);
+
 extern char g_szBuf[1024];
 
 extern const char *EventNames[];  // MAXEVENTS
@@ -147,7 +165,7 @@ typedef struct {
     int g_flags;
 } vmstate_t;
 
-extern vmstate_t vm;
+extern VM_TLS vmstate_t vm;
 
 void G_DoGameStartup(const int32_t *params);
 void C_DefineMusic(int32_t vol, int32_t lev, const char *fn);
@@ -173,8 +191,8 @@ void C_SetCfgName(const char *cfgname);
 void C_ReportError(int32_t iError);
 void C_Compile(const char *filenam);
 
-extern int32_t g_errorLineNum;
-extern int32_t g_tw;
+extern VM_TLS int32_t g_errorLineNum;
+extern VM_TLS int32_t g_tw;
 extern const char *keyw[];
 
 typedef struct {
@@ -1109,6 +1127,36 @@ enum ScriptKeywords_t
     CON_END
 };
 // KEEPINSYNC with the keyword list in lunatic/con_lang.lua
+
+// Instructions C_OptimizeScript writes over compiled ones once a compile succeeded. They are numbered past
+// CON_END so no keyword ever parses to them, and each one keeps the layout of what it replaces: jumps into
+// the middle of a fused sequence still land on an intact instruction.
+enum ScriptOptimizedInstructions_t
+{
+    CON_OPT_IFGVARE = CON_END,      // ifvar* on a global gamevar, read directly
+    CON_OPT_IFGVARN,
+    CON_OPT_IFGVARL,
+    CON_OPT_IFGVARG,
+    CON_OPT_IFGVARAND,
+    CON_OPT_SETGVAR,
+    CON_OPT_ADDGVAR,
+    CON_OPT_IFAVARE,                // same for a per-actor gamevar
+    CON_OPT_IFAVARN,
+    CON_OPT_IFAVARL,
+    CON_OPT_IFAVARG,
+    CON_OPT_IFAVARAND,
+    CON_OPT_SETAVAR,
+    CON_OPT_ADDAVAR,
+    CON_OPT_IFACTION_IFACTIONCOUNT, // if whose body is another if, both tested without recursing
+    CON_OPT_IFACTION_IFCOUNT,
+    CON_OPT_IFAI_IFCOUNT,
+    CON_OPT_IFMOVE_IFCOUNT,
+    CON_OPT_ACTORADD,               // getactor[THISACTOR].m v, addvar v n, setactor[THISACTOR].m v
+    CON_OPT_END
+};
+
+int32_t C_OptimizeScript(int32_t enable);
+extern int32_t g_scriptOptimize;
 #endif
 
 #ifdef __cplusplus
@@ -32,6 +32,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "menus.h"
 #include "input.h"
 #include "anim.h"
+#include "clipgrid.h"
+#include "actorjobs.h"
+#include "demobench.h"
+
+#include "../Build/src/Profiler/profiler.h"
 
 #ifdef LUNATIC
 # include "lunatic_game.h"
@@ -45,7 +50,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 # define GAMEEXEC_STATIC static
 #endif
 
-vmstate_t vm;
+VM_TLS vmstate_t vm;
 
 #if !defined LUNATIC
 enum vmflags_t {
@@ -54,11 +59,19 @@ enum vmflags_t {
     VM_NOEXECUTE    = 0x00000004,
 };
 
-int32_t g_tw;
-int32_t g_errorLineNum;
-int32_t g_currentEventExec = -1;
+VM_TLS int32_t g_tw;
+VM_TLS int32_t g_errorLineNum;
+VM_TLS int32_t g_currentEventExec = -1;
+VM_TLS uint64_t g_vmInstructions;
+uint32_t g_vmWorldWrites;
+
+// accumulated by A_ExecuteScript while G_BenchmarkScripts runs
+static int32_t g_benchmarkingScripts;
+static uint32_t g_benchmarkScripts;
+static uint64_t g_benchmarkOps;
+static double g_benchmarkMs;
 
-intptr_t const *insptr;
+VM_TLS intptr_t const *insptr;
 
 int32_t g_iReturnVarID = -1;     // var ID of "RETURN"
 int32_t g_iWeaponVarID = -1;     // var ID of "WEAPON"
@@ -195,11 +208,17 @@ FORCE_INLINE int32_t VM_EventCommon_(const int32_t iEventID, const int32_t iActo
     if ((unsigned)iPlayer >= (unsigned)playerswhenstarted)
         vm.g_pp = g_player[0].ps;
 
+    BUILD_PROFILE_SCOPE("VM_OnEvent");
+    const double t = EDUKE32_PREDICT_FALSE(g_demoBench) ? Demo_BenchVMEnter() : 0.0;
+
     VM_Execute(1);
 
     if (vm.g_flags & VM_KILL)
         VM_DeleteSprite(vm.g_i, vm.g_p);
 
+    if (EDUKE32_PREDICT_FALSE(g_demoBench))
+        Demo_BenchVMLeave(t);
+
     // this needs to happen after VM_DeleteSprite() because VM_DeleteSprite()
     // can trigger additional events
     vm = vm_backup;
@@ -1186,10 +1205,183 @@ LUNATIC_EXTERN void G_ShowView(vec3_t vec, int32_t a, int32_t horiz, int32_t sec
 }
 
 #if !defined LUNATIC
+#if defined __GNUC__ && !defined VM_SWITCH_DISPATCH
+// gcc and clang jump straight to each instruction through a table of label addresses instead of the switch's
+// range check and jump table. MSVC has no computed goto and keeps the switch, as does defining VM_SWITCH_DISPATCH.
+# define VM_COMPUTED_GOTO
+# define VM_CASE(op) case op: vm_##op
+# define VM_LABEL(op) { op, &&vm_##op }
+// Each instruction fetches and jumps to the next itself, giving the branch predictor one indirect jump per
+// instruction to learn from rather than the single one at the top of the loop.
+# define VM_NEXT                                                                                                       \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!loop || (vm.g_flags & (VM_RETURN | VM_KILL | VM_NOEXECUTE)))                                              \
+            goto vm_done;                                                                                              \
+        tw = *insptr;                                                                                                  \
+        g_errorLineNum = tw>>12;                                                                                       \
+        g_tw = tw &= VM_INSTMASK;                                                                                      \
+        numinstructions++;                                                                                             \
+        goto *dispatch.ops[tw];                                                                                        \
+    } while (0)
+
+typedef struct {
+    int32_t op;
+    void *label;
+} vmdispatchlabel_t;
+
+//
+// VmDispatchTable
+//
+// Label of every instruction VM_Execute has one for, the rest land on the switch. Instructions that may write
+// the world go through worldwrite first, which counts them in g_vmWorldWrites and continues at their label.
+//
+struct VmDispatchTable
+{
+    VmDispatchTable(void *fallback, void *worldwrite, const vmdispatchlabel_t *labels, int32_t numlabels)
+    {
+        for (int i = 0; i <= VM_INSTMASK; i++)
+            labelops[i] = fallback;
+        for (int i = 0; i < numlabels; i++)
+            labelops[labels[i].op] = labels[i].label;
+        for (int i = 0; i <= VM_INSTMASK; i++)
+            ops[i] = C_KeywordWritesWorld(i) ? worldwrite : labelops[i];
+    }
+
+    // indexed by the masked instruction, anything past CON_OPT_END reaches the switch's default
+    void *ops[VM_INSTMASK + 1];
+    void *labelops[VM_INSTMASK + 1];
+};
+#else
+# define VM_CASE(op) case op
+# define VM_NEXT continue
+
+//
+// VmWorldWrites
+//
+// C_KeywordWritesWorld for every instruction, counted in g_vmWorldWrites as they run.
+//
+static struct VmWorldWrites
+{
+    VmWorldWrites()
+    {
+        for (int i = 0; i <= VM_INSTMASK; i++)
+            writes[i] = C_KeywordWritesWorld(i);
+    }
+
+    uint8_t writes[VM_INSTMASK + 1];
+} vm_worldwrites;
+#endif
+
 GAMEEXEC_STATIC void VM_Execute(int loop)
 {
     int tw = *insptr;
     DukePlayer_t * const ps = vm.g_pp;
+    // kept in a register and added to the thread local once per call
+    uint32_t numinstructions = 0;
+
+#ifdef VM_COMPUTED_GOTO
+    // a VM_CASE left out of here still runs, through the switch, and -Wunused-label points it out
+    static const vmdispatchlabel_t labels[] = {
+        VM_LABEL(CON_LEFTBRACE), VM_LABEL(CON_RIGHTBRACE), VM_LABEL(CON_ELSE), VM_LABEL(CON_STATE),
+        VM_LABEL(CON_IFVARE), VM_LABEL(CON_REDEFINEQUOTE), VM_LABEL(CON_GETTHISPROJECTILE),
+        VM_LABEL(CON_SETTHISPROJECTILE), VM_LABEL(CON_IFRND), VM_LABEL(CON_IFCANSHOOTTARGET),
+        VM_LABEL(CON_IFCANSEETARGET), VM_LABEL(CON_IFACTORNOTSTAYPUT), VM_LABEL(CON_IFCANSEE),
+        VM_LABEL(CON_IFHITWEAPON), VM_LABEL(CON_IFSQUISHED), VM_LABEL(CON_IFDEAD), VM_LABEL(CON_AI),
+        VM_LABEL(CON_ACTION), VM_LABEL(CON_IFPLAYERSL), VM_LABEL(CON_IFPDISTL), VM_LABEL(CON_IFPDISTG),
+        VM_LABEL(CON_ADDSTRENGTH), VM_LABEL(CON_STRENGTH), VM_LABEL(CON_IFGOTWEAPONCE), VM_LABEL(CON_GETLASTPAL),
+        VM_LABEL(CON_TOSSWEAPON), VM_LABEL(CON_MIKESND), VM_LABEL(CON_PKICK), VM_LABEL(CON_SIZETO),
+        VM_LABEL(CON_SIZEAT), VM_LABEL(CON_SHOOT), VM_LABEL(CON_SOUNDONCE), VM_LABEL(CON_IFACTORSOUND),
+        VM_LABEL(CON_IFSOUND), VM_LABEL(CON_STOPSOUND), VM_LABEL(CON_STOPACTORSOUND), VM_LABEL(CON_SETACTORSOUNDPITCH),
+        VM_LABEL(CON_GLOBALSOUND), VM_LABEL(CON_SOUND), VM_LABEL(CON_TIP), VM_LABEL(CON_FALL), VM_LABEL(CON_RETURN),
+        VM_LABEL(CON_ENDA), VM_LABEL(CON_BREAK), VM_LABEL(CON_ENDS), VM_LABEL(CON_NULLOP), VM_LABEL(CON_ADDAMMO),
+        VM_LABEL(CON_MONEY), VM_LABEL(CON_MAIL), VM_LABEL(CON_SLEEPTIME), VM_LABEL(CON_PAPER), VM_LABEL(CON_ADDKILLS),
+        VM_LABEL(CON_LOTSOFGLASS), VM_LABEL(CON_KILLIT), VM_LABEL(CON_ADDWEAPON), VM_LABEL(CON_DEBUG),
+        VM_LABEL(CON_ENDOFGAME), VM_LABEL(CON_ENDOFLEVEL), VM_LABEL(CON_ADDPHEALTH), VM_LABEL(CON_MOVE),
+        VM_LABEL(CON_ADDWEAPONVAR), VM_LABEL(CON_ACTIVATEBYSECTOR), VM_LABEL(CON_OPERATESECTORS),
+        VM_LABEL(CON_OPERATEACTIVATORS), VM_LABEL(CON_SETASPECT), VM_LABEL(CON_SSP), VM_LABEL(CON_CANSEESPR),
+        VM_LABEL(CON_OPERATERESPAWNS), VM_LABEL(CON_OPERATEMASTERSWITCHES), VM_LABEL(CON_CHECKACTIVATORMOTION),
+        VM_LABEL(CON_INSERTSPRITEQ), VM_LABEL(CON_QSTRLEN), VM_LABEL(CON_QSTRDIM), VM_LABEL(CON_HEADSPRITESTAT),
+        VM_LABEL(CON_PREVSPRITESTAT), VM_LABEL(CON_NEXTSPRITESTAT), VM_LABEL(CON_HEADSPRITESECT),
+        VM_LABEL(CON_PREVSPRITESECT), VM_LABEL(CON_NEXTSPRITESECT), VM_LABEL(CON_GETKEYNAME), VM_LABEL(CON_QSUBSTR),
+        VM_LABEL(CON_GETPNAME), VM_LABEL(CON_QSTRNCAT), VM_LABEL(CON_QSTRCAT), VM_LABEL(CON_QSTRCPY),
+        VM_LABEL(CON_QGETSYSSTR), VM_LABEL(CON_CHANGESPRITESECT), VM_LABEL(CON_CHANGESPRITESTAT),
+        VM_LABEL(CON_STARTLEVEL), VM_LABEL(CON_MYOSX), VM_LABEL(CON_MYOSPALX), VM_LABEL(CON_MYOS),
+        VM_LABEL(CON_MYOSPAL), VM_LABEL(CON_SWITCH), VM_LABEL(CON_ENDSWITCH), VM_LABEL(CON_ENDEVENT),
+        VM_LABEL(CON_DISPLAYRAND), VM_LABEL(CON_DRAGPOINT), VM_LABEL(CON_LDIST), VM_LABEL(CON_DIST),
+        VM_LABEL(CON_GETANGLE), VM_LABEL(CON_GETINCANGLE), VM_LABEL(CON_MULSCALE), VM_LABEL(CON_INITTIMER),
+        VM_LABEL(CON_NEXTSECTORNEIGHBORZ), VM_LABEL(CON_MOVESECTOR), VM_LABEL(CON_TIME), VM_LABEL(CON_ESPAWNVAR),
+        VM_LABEL(CON_EQSPAWNVAR), VM_LABEL(CON_QSPAWNVAR), VM_LABEL(CON_ESPAWN), VM_LABEL(CON_EQSPAWN),
+        VM_LABEL(CON_QSPAWN), VM_LABEL(CON_ESHOOT), VM_LABEL(CON_EZSHOOT), VM_LABEL(CON_ZSHOOT), VM_LABEL(CON_SHOOTVAR),
+        VM_LABEL(CON_ESHOOTVAR), VM_LABEL(CON_EZSHOOTVAR), VM_LABEL(CON_ZSHOOTVAR), VM_LABEL(CON_CMENU),
+        VM_LABEL(CON_SOUNDVAR), VM_LABEL(CON_STOPSOUNDVAR), VM_LABEL(CON_SOUNDONCEVAR), VM_LABEL(CON_GLOBALSOUNDVAR),
+        VM_LABEL(CON_SCREENSOUND), VM_LABEL(CON_STARTCUTSCENE), VM_LABEL(CON_IFCUTSCENE), VM_LABEL(CON_GUNIQHUDID),
+        VM_LABEL(CON_SAVEGAMEVAR), VM_LABEL(CON_READGAMEVAR), VM_LABEL(CON_SHOWVIEW), VM_LABEL(CON_SHOWVIEWUNBIASED),
+        VM_LABEL(CON_ROTATESPRITEA), VM_LABEL(CON_ROTATESPRITE16), VM_LABEL(CON_ROTATESPRITE), VM_LABEL(CON_GAMETEXT),
+        VM_LABEL(CON_GAMETEXTZ), VM_LABEL(CON_DIGITALNUMBER), VM_LABEL(CON_DIGITALNUMBERZ), VM_LABEL(CON_MINITEXT),
+        VM_LABEL(CON_SCREENTEXT), VM_LABEL(CON_ANGOFF), VM_LABEL(CON_GETZRANGE), VM_LABEL(CON_SECTSETINTERPOLATION),
+        VM_LABEL(CON_SECTCLEARINTERPOLATION), VM_LABEL(CON_CALCHYPOTENUSE), VM_LABEL(CON_LINEINTERSECT),
+        VM_LABEL(CON_RAYINTERSECT), VM_LABEL(CON_CLIPMOVE), VM_LABEL(CON_CLIPMOVENOSLIDE), VM_LABEL(CON_HITSCAN),
+        VM_LABEL(CON_CANSEE), VM_LABEL(CON_ROTATEPOINT), VM_LABEL(CON_NEARTAG), VM_LABEL(CON_GETTIMEDATE),
+        VM_LABEL(CON_MOVESPRITE), VM_LABEL(CON_SETSPRITE), VM_LABEL(CON_GETFLORZOFSLOPE), VM_LABEL(CON_GETCEILZOFSLOPE),
+        VM_LABEL(CON_UPDATESECTOR), VM_LABEL(CON_UPDATESECTORZ), VM_LABEL(CON_SPAWN), VM_LABEL(CON_IFWASWEAPON),
+        VM_LABEL(CON_IFAI), VM_LABEL(CON_IFACTION), VM_LABEL(CON_IFACTIONCOUNT), VM_LABEL(CON_RESETACTIONCOUNT),
+        VM_LABEL(CON_DEBRIS), VM_LABEL(CON_COUNT), VM_LABEL(CON_CSTATOR), VM_LABEL(CON_CLIPDIST), VM_LABEL(CON_CSTAT),
+        VM_LABEL(CON_SAVENN), VM_LABEL(CON_SAVE), VM_LABEL(CON_QUAKE), VM_LABEL(CON_IFMOVE), VM_LABEL(CON_RESETPLAYER),
+        VM_LABEL(CON_RESETPLAYERFLAGS), VM_LABEL(CON_IFONWATER), VM_LABEL(CON_IFINWATER), VM_LABEL(CON_IFCOUNT),
+        VM_LABEL(CON_IFACTOR), VM_LABEL(CON_RESETCOUNT), VM_LABEL(CON_ADDINVENTORY), VM_LABEL(CON_HITRADIUSVAR),
+        VM_LABEL(CON_HITRADIUS), VM_LABEL(CON_IFP), VM_LABEL(CON_IFSTRENGTH), VM_LABEL(CON_GUTS),
+        VM_LABEL(CON_IFSPAWNEDBY), VM_LABEL(CON_WACKPLAYER), VM_LABEL(CON_FLASH), VM_LABEL(CON_SAVEMAPSTATE),
+        VM_LABEL(CON_LOADMAPSTATE), VM_LABEL(CON_CLEARMAPSTATE), VM_LABEL(CON_STOPALLSOUNDS), VM_LABEL(CON_IFGAPZL),
+        VM_LABEL(CON_IFHITSPACE), VM_LABEL(CON_IFOUTSIDE), VM_LABEL(CON_IFMULTIPLAYER), VM_LABEL(CON_IFCLIENT),
+        VM_LABEL(CON_IFSERVER), VM_LABEL(CON_OPERATE), VM_LABEL(CON_IFINSPACE), VM_LABEL(CON_SPRITEPAL),
+        VM_LABEL(CON_CACTOR), VM_LABEL(CON_IFBULLETNEAR), VM_LABEL(CON_IFRESPAWN), VM_LABEL(CON_IFFLOORDISTL),
+        VM_LABEL(CON_IFCEILINGDISTL), VM_LABEL(CON_PALFROM), VM_LABEL(CON_SECTOROFWALL), VM_LABEL(CON_QSPRINTF),
+        VM_LABEL(CON_ADDLOG), VM_LABEL(CON_ADDLOGVAR), VM_LABEL(CON_SETSECTOR), VM_LABEL(CON_GETSECTOR),
+        VM_LABEL(CON_SQRT), VM_LABEL(CON_FINDNEARACTOR), VM_LABEL(CON_FINDNEARSPRITE), VM_LABEL(CON_FINDNEARACTOR3D),
+        VM_LABEL(CON_FINDNEARSPRITE3D), VM_LABEL(CON_FINDNEARACTORVAR), VM_LABEL(CON_FINDNEARSPRITEVAR),
+        VM_LABEL(CON_FINDNEARACTOR3DVAR), VM_LABEL(CON_FINDNEARSPRITE3DVAR), VM_LABEL(CON_FINDNEARACTORZVAR),
+        VM_LABEL(CON_FINDNEARSPRITEZVAR), VM_LABEL(CON_FINDNEARACTORZ), VM_LABEL(CON_FINDNEARSPRITEZ),
+        VM_LABEL(CON_FINDPLAYER), VM_LABEL(CON_FINDOTHERPLAYER), VM_LABEL(CON_SETPLAYER), VM_LABEL(CON_GETPLAYER),
+        VM_LABEL(CON_GETINPUT), VM_LABEL(CON_SETINPUT), VM_LABEL(CON_GETUSERDEF), VM_LABEL(CON_SETUSERDEF),
+        VM_LABEL(CON_GETPROJECTILE), VM_LABEL(CON_SETPROJECTILE), VM_LABEL(CON_SETWALL), VM_LABEL(CON_GETWALL),
+        VM_LABEL(CON_SETACTORVAR), VM_LABEL(CON_GETACTORVAR), VM_LABEL(CON_SETPLAYERVAR), VM_LABEL(CON_GETPLAYERVAR),
+        VM_LABEL(CON_SETACTOR), VM_LABEL(CON_GETACTOR), VM_LABEL(CON_SETTSPR), VM_LABEL(CON_GETTSPR),
+        VM_LABEL(CON_GETANGLETOTARGET), VM_LABEL(CON_ANGOFFVAR), VM_LABEL(CON_LOCKPLAYER),
+        VM_LABEL(CON_CHECKAVAILWEAPON), VM_LABEL(CON_CHECKAVAILINVEN), VM_LABEL(CON_GETPLAYERANGLE),
+        VM_LABEL(CON_GETACTORANGLE), VM_LABEL(CON_SETPLAYERANGLE), VM_LABEL(CON_SETACTORANGLE), VM_LABEL(CON_SETVAR),
+        VM_LABEL(CON_KLABS), VM_LABEL(CON_SETARRAY), VM_LABEL(CON_WRITEARRAYTOFILE), VM_LABEL(CON_READARRAYFROMFILE),
+        VM_LABEL(CON_GETARRAYSIZE), VM_LABEL(CON_RESIZEARRAY), VM_LABEL(CON_COPY), VM_LABEL(CON_RANDVAR),
+        VM_LABEL(CON_DISPLAYRANDVAR), VM_LABEL(CON_INV), VM_LABEL(CON_MULVAR), VM_LABEL(CON_DIVVAR),
+        VM_LABEL(CON_MODVAR), VM_LABEL(CON_ANDVAR), VM_LABEL(CON_ORVAR), VM_LABEL(CON_XORVAR), VM_LABEL(CON_SETVARVAR),
+        VM_LABEL(CON_RANDVARVAR), VM_LABEL(CON_DISPLAYRANDVARVAR), VM_LABEL(CON_GMAXAMMO), VM_LABEL(CON_SMAXAMMO),
+        VM_LABEL(CON_MULVARVAR), VM_LABEL(CON_DIVVARVAR), VM_LABEL(CON_MODVARVAR), VM_LABEL(CON_ANDVARVAR),
+        VM_LABEL(CON_XORVARVAR), VM_LABEL(CON_ORVARVAR), VM_LABEL(CON_SUBVAR), VM_LABEL(CON_SUBVARVAR),
+        VM_LABEL(CON_ADDVAR), VM_LABEL(CON_SHIFTVARL), VM_LABEL(CON_SHIFTVARR), VM_LABEL(CON_SHIFTVARVARL),
+        VM_LABEL(CON_SHIFTVARVARR), VM_LABEL(CON_SIN), VM_LABEL(CON_COS), VM_LABEL(CON_ADDVARVAR),
+        VM_LABEL(CON_SPGETLOTAG), VM_LABEL(CON_SPGETHITAG), VM_LABEL(CON_SECTGETLOTAG), VM_LABEL(CON_SECTGETHITAG),
+        VM_LABEL(CON_GETTEXTUREFLOOR), VM_LABEL(CON_STARTTRACK), VM_LABEL(CON_STARTTRACKVAR),
+        VM_LABEL(CON_SETMUSICPOSITION), VM_LABEL(CON_GETMUSICPOSITION), VM_LABEL(CON_ACTIVATECHEAT),
+        VM_LABEL(CON_SETGAMEPALETTE), VM_LABEL(CON_GETTEXTURECEILING), VM_LABEL(CON_IFVARVARAND),
+        VM_LABEL(CON_IFVARVAROR), VM_LABEL(CON_IFVARVARXOR), VM_LABEL(CON_IFVARVAREITHER), VM_LABEL(CON_IFVARVARBOTH),
+        VM_LABEL(CON_IFVARVARN), VM_LABEL(CON_IFVARVARE), VM_LABEL(CON_IFVARVARG), VM_LABEL(CON_IFVARVARGE),
+        VM_LABEL(CON_IFVARVARL), VM_LABEL(CON_IFVARVARLE), VM_LABEL(CON_IFVARN), VM_LABEL(CON_WHILEVARN),
+        VM_LABEL(CON_WHILEVARL), VM_LABEL(CON_WHILEVARVARN), VM_LABEL(CON_WHILEVARVARL), VM_LABEL(CON_FOR),
+        VM_LABEL(CON_IFVARAND), VM_LABEL(CON_IFVAROR), VM_LABEL(CON_IFVARXOR), VM_LABEL(CON_IFVAREITHER),
+        VM_LABEL(CON_IFVARBOTH), VM_LABEL(CON_IFVARG), VM_LABEL(CON_IFVARGE), VM_LABEL(CON_IFVARL),
+        VM_LABEL(CON_IFVARLE), VM_LABEL(CON_IFPHEALTHL), VM_LABEL(CON_IFPINVENTORY), VM_LABEL(CON_PSTOMP),
+        VM_LABEL(CON_IFAWAYFROMWALL), VM_LABEL(CON_QUOTE), VM_LABEL(CON_USERQUOTE), VM_LABEL(CON_ECHO),
+        VM_LABEL(CON_IFINOUTERSPACE), VM_LABEL(CON_IFNOTMOVING), VM_LABEL(CON_RESPAWNHITAG), VM_LABEL(CON_IFSPRITEPAL),
+        VM_LABEL(CON_IFANGDIFFL), VM_LABEL(CON_IFNOSOUNDS), VM_LABEL(CON_SPRITEFLAGS), VM_LABEL(CON_GETTICKS),
+        VM_LABEL(CON_GETCURRADDRESS), VM_LABEL(CON_JUMP), VM_LABEL(CON_OPT_IFGVARE), VM_LABEL(CON_OPT_IFGVARN),
+        VM_LABEL(CON_OPT_IFGVARL), VM_LABEL(CON_OPT_IFGVARG), VM_LABEL(CON_OPT_IFGVARAND), VM_LABEL(CON_OPT_SETGVAR),
+        VM_LABEL(CON_OPT_ADDGVAR), VM_LABEL(CON_OPT_IFAVARE), VM_LABEL(CON_OPT_IFAVARN), VM_LABEL(CON_OPT_IFAVARL),
+        VM_LABEL(CON_OPT_IFAVARG), VM_LABEL(CON_OPT_IFAVARAND), VM_LABEL(CON_OPT_SETAVAR), VM_LABEL(CON_OPT_ADDAVAR),
+        VM_LABEL(CON_OPT_IFACTION_IFACTIONCOUNT), VM_LABEL(CON_OPT_IFACTION_IFCOUNT), VM_LABEL(CON_OPT_IFAI_IFCOUNT),
+        VM_LABEL(CON_OPT_IFMOVE_IFCOUNT), VM_LABEL(CON_OPT_ACTORADD)
+    };
+    static const VmDispatchTable dispatch(&&vm_switch, &&vm_worldwrite, labels, ARRAY_SIZE(labels));
+#endif
 
     // jump directly into the loop, saving us from the checks during the first iteration
     goto skip_check;
@@ -1207,6 +1399,17 @@ skip_check:
 
         g_errorLineNum = tw>>12;
         g_tw = tw &= VM_INSTMASK;
+        numinstructions++;
+
+#ifdef VM_COMPUTED_GOTO
+        goto *dispatch.ops[tw];
+
+vm_worldwrite:
+        g_vmWorldWrites++;
+        goto *dispatch.labelops[tw];
+#else
+        if (EDUKE32_PREDICT_FALSE(vm_worldwrites.writes[tw]))
+            g_vmWorldWrites++;
 
         if (tw == CON_LEFTBRACE)
         {
@@ -1231,16 +1434,42 @@ skip_check:
             insptr = tempscrptr;
             continue;
         }
+#endif
 
+#ifdef VM_COMPUTED_GOTO
+vm_switch:
+#endif
         switch (tw)
         {
-        case CON_IFVARE:
+        // tested ahead of the switch when there's no dispatch table, these are the most common instructions
+        VM_CASE(CON_LEFTBRACE):
+            insptr++, loop++;
+            VM_NEXT;
+
+        VM_CASE(CON_RIGHTBRACE):
+            insptr++, loop--;
+            VM_NEXT;
+
+        VM_CASE(CON_ELSE):
+            insptr = (intptr_t *) *(insptr+1);
+            VM_NEXT;
+
+        VM_CASE(CON_STATE):
+            {
+                intptr_t const * const tempscrptr = insptr + 2;
+                insptr = (intptr_t *)*(insptr + 1);
+                VM_Execute(1);
+                insptr = tempscrptr;
+                VM_NEXT;
+            }
+
+        VM_CASE(CON_IFVARE):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw == *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_REDEFINEQUOTE:
+        VM_CASE(CON_REDEFINEQUOTE):
             insptr++;
             {
                 int32_t q = *insptr++, i = *insptr++;
@@ -1250,10 +1479,10 @@ skip_check:
                     break;
                 }
                 Bstrcpy(ScriptQuotes[q],ScriptQuoteRedefinitions[i]);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETTHISPROJECTILE:
+        VM_CASE(CON_GETTHISPROJECTILE):
             insptr++;
             {
                 tw = *insptr++;
@@ -1262,10 +1491,10 @@ skip_check:
                 register int32_t const iActor = (tw != g_iThisActorID) ? Gv_GetVarX(tw) : vm.g_i;
 
                 Gv_SetVarX(lVar2, VM_GetActiveProjectile(iActor, lLabelID));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETTHISPROJECTILE:
+        VM_CASE(CON_SETTHISPROJECTILE):
             insptr++;
             {
                 tw = *insptr++;
@@ -1275,72 +1504,28 @@ skip_check:
                 register int32_t const iSet = Gv_GetVarX(lVar2);
 
                 VM_SetActiveProjectile(iActor, lLabelID, iSet);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_IFRND:
+        VM_CASE(CON_IFRND):
             VM_CONDITIONAL(rnd(*(++insptr)));
-            continue;
-
-        case CON_IFCANSHOOTTARGET:
-        {
-            if (vm.g_x > 1024)
-            {
-                int16_t temphit;
+            VM_NEXT;
 
-                if ((tw = A_CheckHitSprite(vm.g_i, &temphit)) == (1 << 30))
-                {
-                    VM_CONDITIONAL(1);
-                    continue;
-                }
-
-                int32_t sclip = 768, angdif = 16;
-
-                if (A_CheckEnemySprite(vm.g_sp) && vm.g_sp->xrepeat > 56)
-                {
-                    sclip = 3084;
-                    angdif = 48;
-                }
-
-#define CHECK(x) if (x >= 0 && sprite[x].picnum == vm.g_sp->picnum) { VM_CONDITIONAL(0); continue; }
-#define CHECK2(x) do { vm.g_sp->ang += x; tw = A_CheckHitSprite(vm.g_i, &temphit); vm.g_sp->ang -= x; } while(0)
-
-                if (tw > sclip)
-                {
-                    CHECK(temphit);
-                    CHECK2(angdif);
-
-                    if (tw > sclip)
-                    {
-                        CHECK(temphit);
-                        CHECK2(-angdif);
-
-                        if (tw > 768)
-                        {
-                            CHECK(temphit);
-                            VM_CONDITIONAL(1);
-                            continue;
-                        }
-                    }
-                }
-            }
-            VM_CONDITIONAL(1);
-        }
-        continue;
+        VM_CASE(CON_IFCANSHOOTTARGET):
+            VM_CONDITIONAL(A_CanShootTargetRead(vm.g_i, vm.g_x));
+            VM_NEXT;
 
-        case CON_IFCANSEETARGET:
-            tw = cansee(vm.g_sp->x, vm.g_sp->y, vm.g_sp->z-((krand()&41)<<8),
-                               vm.g_sp->sectnum, ps->pos.x, ps->pos.y,
-                               ps->pos.z/*-((krand()&41)<<8)*/, sprite[ps->i].sectnum);
+        VM_CASE(CON_IFCANSEETARGET):
+            tw = A_CanSeeRead(vm.g_i, ACTORSIGHT_TARGET, (krand()&41)<<8, vm.g_p);
             VM_CONDITIONAL(tw);
             if (tw) actor[vm.g_i].timetosleep = SLEEPTIME;
-        continue;
+        VM_NEXT;
 
-        case CON_IFACTORNOTSTAYPUT:
+        VM_CASE(CON_IFACTORNOTSTAYPUT):
             VM_CONDITIONAL(actor[vm.g_i].actorstayput == -1);
-            continue;
+            VM_NEXT;
 
-        case CON_IFCANSEE:
+        VM_CASE(CON_IFCANSEE):
         {
             tspritetype * s = (tspritetype *)&sprite[ps->i];
 
@@ -1362,8 +1547,11 @@ skip_check:
             }
 
             // can they see player, (or player's holoduke)
-            tw = cansee(vm.g_sp->x,vm.g_sp->y,vm.g_sp->z-(krand()&((47<<8))),vm.g_sp->sectnum,
-                       s->x,s->y,s->z-(24<<8),s->sectnum);
+            if (s == (tspritetype *)&sprite[ps->i])
+                tw = A_CanSeeRead(vm.g_i, ACTORSIGHT_SPRITE, krand()&(47<<8), vm.g_p);
+            else
+                tw = cansee(vm.g_sp->x,vm.g_sp->y,vm.g_sp->z-(krand()&((47<<8))),vm.g_sp->sectnum,
+                           s->x,s->y,s->z-(24<<8),s->sectnum);
 
             if (tw == 0)
             {
@@ -1387,22 +1575,22 @@ skip_check:
                 actor[vm.g_i].timetosleep = SLEEPTIME;
 
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
         }
 
-        case CON_IFHITWEAPON:
+        VM_CASE(CON_IFHITWEAPON):
             VM_CONDITIONAL(A_IncurDamage(vm.g_i) >= 0);
-            continue;
+            VM_NEXT;
 
-        case CON_IFSQUISHED:
+        VM_CASE(CON_IFSQUISHED):
             VM_CONDITIONAL(VM_CheckSquished());
-            continue;
+            VM_NEXT;
 
-        case CON_IFDEAD:
+        VM_CASE(CON_IFDEAD):
             VM_CONDITIONAL(vm.g_sp->extra <= 0);
-            continue;
+            VM_NEXT;
 
-        case CON_AI:
+        VM_CASE(CON_AI):
             insptr++;
             //Following changed to use pointersizes
             AC_AI_ID(vm.g_t) = *insptr++; // Ai
@@ -1420,41 +1608,41 @@ skip_check:
             if (!A_CheckEnemySprite(vm.g_sp) || vm.g_sp->extra > 0) // hack
                 if (vm.g_sp->hitag&random_angle)
                     vm.g_sp->ang = krand()&2047;
-            continue;
+            VM_NEXT;
 
-        case CON_ACTION:
+        VM_CASE(CON_ACTION):
             insptr++;
             AC_ACTION_COUNT(vm.g_t) = AC_CURFRAME(vm.g_t) = 0;
             AC_ACTION_ID(vm.g_t) = *insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_IFPLAYERSL:
+        VM_CASE(CON_IFPLAYERSL):
             VM_CONDITIONAL(numplayers < *(++insptr));
-            continue;
+            VM_NEXT;
 
-        case CON_IFPDISTL:
+        VM_CASE(CON_IFPDISTL):
             VM_CONDITIONAL(vm.g_x < *(++insptr));
             if (vm.g_x > MAXSLEEPDIST && actor[vm.g_i].timetosleep == 0)
                 actor[vm.g_i].timetosleep = SLEEPTIME;
-            continue;
+            VM_NEXT;
 
-        case CON_IFPDISTG:
+        VM_CASE(CON_IFPDISTG):
             VM_CONDITIONAL(vm.g_x > *(++insptr));
             if (vm.g_x > MAXSLEEPDIST && actor[vm.g_i].timetosleep == 0)
                 actor[vm.g_i].timetosleep = SLEEPTIME;
-            continue;
+            VM_NEXT;
 
-        case CON_ADDSTRENGTH:
+        VM_CASE(CON_ADDSTRENGTH):
             insptr++;
             vm.g_sp->extra += *insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_STRENGTH:
+        VM_CASE(CON_STRENGTH):
             insptr++;
             vm.g_sp->extra = *insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_IFGOTWEAPONCE:
+        VM_CASE(CON_IFGOTWEAPONCE):
             insptr++;
 
             if ((GametypeFlags[ud.coop]&GAMETYPE_WEAPSTAY) && (g_netServer || ud.multimode > 1))
@@ -1467,19 +1655,19 @@ skip_check:
                             break;
 
                     VM_CONDITIONAL(j < ps->weapreccnt && vm.g_sp->owner == vm.g_i);
-                    continue;
+                    VM_NEXT;
                 }
                 else if (ps->weapreccnt < MAX_WEAPONS)
                 {
                     ps->weaprecs[ps->weapreccnt++] = vm.g_sp->picnum;
                     VM_CONDITIONAL(vm.g_sp->owner == vm.g_i);
-                    continue;
+                    VM_NEXT;
                 }
             }
             VM_CONDITIONAL(0);
-            continue;
+            VM_NEXT;
 
-        case CON_GETLASTPAL:
+        VM_CASE(CON_GETLASTPAL):
             insptr++;
             if (vm.g_sp->picnum == APLAYER)
                 vm.g_sp->pal = g_player[P_GetP(vm.g_sp)].ps->palookup;
@@ -1490,26 +1678,26 @@ skip_check:
                 vm.g_sp->pal = actor[vm.g_i].tempang;
             }
             actor[vm.g_i].tempang = 0;
-            continue;
+            VM_NEXT;
 
-        case CON_TOSSWEAPON:
+        VM_CASE(CON_TOSSWEAPON):
             insptr++;
             // NOTE: assumes that current actor is APLAYER
             P_DropWeapon(P_GetP(vm.g_sp));
-            continue;
+            VM_NEXT;
 
-        case CON_MIKESND:
+        VM_CASE(CON_MIKESND):
             insptr++;
             if (EDUKE32_PREDICT_FALSE(((unsigned)vm.g_sp->yvel >= MAXSOUNDS)))
             {
                 CON_ERRPRINTF("Invalid sound %d\n", TrackerCast(vm.g_sp->yvel));
-                continue;
+                VM_NEXT;
             }
             if (!S_CheckSoundPlaying(vm.g_i,vm.g_sp->yvel))
                 A_PlaySound(vm.g_sp->yvel,vm.g_i);
-            continue;
+            VM_NEXT;
 
-        case CON_PKICK:
+        VM_CASE(CON_PKICK):
             insptr++;
 
             if ((g_netServer || ud.multimode > 1) && vm.g_sp->picnum == APLAYER)
@@ -1519,9 +1707,9 @@ skip_check:
             }
             else if (vm.g_sp->picnum != APLAYER && ps->quick_kick == 0)
                 ps->quick_kick = 14;
-            continue;
+            VM_NEXT;
 
-        case CON_SIZETO:
+        VM_CASE(CON_SIZETO):
             insptr++;
 
             tw = (*insptr++ - vm.g_sp->xrepeat)<<1;
@@ -1536,32 +1724,32 @@ skip_check:
 
             insptr++;
 
-            continue;
+            VM_NEXT;
 
-        case CON_SIZEAT:
+        VM_CASE(CON_SIZEAT):
             insptr++;
             vm.g_sp->xrepeat = (uint8_t) *insptr++;
             vm.g_sp->yrepeat = (uint8_t) *insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_SHOOT:
+        VM_CASE(CON_SHOOT):
             insptr++;
             A_Shoot(vm.g_i,*insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_SOUNDONCE:
+        VM_CASE(CON_SOUNDONCE):
             if (EDUKE32_PREDICT_FALSE((unsigned)*(++insptr) >= MAXSOUNDS))
             {
                 CON_ERRPRINTF("Invalid sound %d\n", (int32_t)*insptr++);
-                continue;
+                VM_NEXT;
             }
 
             if (!S_CheckSoundPlaying(vm.g_i, *insptr++))
                 A_PlaySound(*(insptr-1),vm.g_i);
 
-            continue;
+            VM_NEXT;
 
-        case CON_IFACTORSOUND:
+        VM_CASE(CON_IFACTORSOUND):
             insptr++;
             {
                 int const i = Gv_GetVarX(*insptr++), j = Gv_GetVarX(*insptr++);
@@ -1570,38 +1758,38 @@ skip_check:
                 {
                     CON_ERRPRINTF("Invalid sound %d\n", j);
                     insptr++;
-                    continue;
+                    VM_NEXT;
                 }
 
                 insptr--;
                 VM_CONDITIONAL(A_CheckSoundPlaying(i, j));
             }
-            continue;
+            VM_NEXT;
 
-        case CON_IFSOUND:
+        VM_CASE(CON_IFSOUND):
             if (EDUKE32_PREDICT_FALSE((unsigned)*(++insptr) >= MAXSOUNDS))
             {
                 CON_ERRPRINTF("Invalid sound %d\n", (int32_t)*insptr);
                 insptr++;
-                continue;
+                VM_NEXT;
             }
             VM_CONDITIONAL(S_CheckSoundPlaying(vm.g_i,*insptr));
             //    VM_DoConditional(SoundOwner[*insptr][0].ow == vm.g_i);
-            continue;
+            VM_NEXT;
 
-        case CON_STOPSOUND:
+        VM_CASE(CON_STOPSOUND):
             if (EDUKE32_PREDICT_FALSE((unsigned)*(++insptr) >= MAXSOUNDS))
             {
                 CON_ERRPRINTF("Invalid sound %d\n", (int32_t)*insptr);
                 insptr++;
-                continue;
+                VM_NEXT;
             }
             if (S_CheckSoundPlaying(vm.g_i,*insptr))
                 S_StopSound((int16_t)*insptr);
             insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_STOPACTORSOUND:
+        VM_CASE(CON_STOPACTORSOUND):
             insptr++;
             {
                 int const i = Gv_GetVarX(*insptr++), j = Gv_GetVarX(*insptr++);
@@ -1609,16 +1797,16 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)j >= MAXSOUNDS))
                 {
                     CON_ERRPRINTF("Invalid sound %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (A_CheckSoundPlaying(i, j))
                     S_StopEnvSound(j, i);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETACTORSOUNDPITCH:
+        VM_CASE(CON_SETACTORSOUNDPITCH):
             insptr++;
             {
                 int const i = Gv_GetVarX(*insptr++), j = Gv_GetVarX(*insptr++), pitchoffset = Gv_GetVarX(*insptr++);
@@ -1626,20 +1814,20 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)j>=MAXSOUNDS))
                 {
                     CON_ERRPRINTF("Invalid sound %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 S_ChangeSoundPitch(j,i,pitchoffset);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GLOBALSOUND:
+        VM_CASE(CON_GLOBALSOUND):
             if (EDUKE32_PREDICT_FALSE((unsigned)*(++insptr) >= MAXSOUNDS))
             {
                 CON_ERRPRINTF("Invalid sound %d\n", (int32_t)*insptr);
                 insptr++;
-                continue;
+                VM_NEXT;
             }
             if (vm.g_p == screenpeek || (GametypeFlags[ud.coop]&GAMETYPE_COOPSOUND)
 #ifdef SPLITSCREEN_MOD_HACKS
@@ -1648,39 +1836,39 @@ skip_check:
                 )
                 A_PlaySound(*insptr,g_player[screenpeek].ps->i);
             insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_SOUND:
+        VM_CASE(CON_SOUND):
             if (EDUKE32_PREDICT_FALSE((unsigned)*(++insptr) >= MAXSOUNDS))
             {
                 CON_ERRPRINTF("Invalid sound %d\n", (int32_t)*insptr);
                 insptr++;
-                continue;
+                VM_NEXT;
             }
             A_PlaySound(*insptr++,vm.g_i);
-            continue;
+            VM_NEXT;
 
-        case CON_TIP:
+        VM_CASE(CON_TIP):
             insptr++;
             ps->tipincs = GAMETICSPERSEC;
-            continue;
+            VM_NEXT;
 
-        case CON_FALL:
+        VM_CASE(CON_FALL):
             insptr++;
             VM_Fall(vm.g_i, vm.g_sp);
-            continue;
+            VM_NEXT;
 
-        case CON_RETURN:
+        VM_CASE(CON_RETURN):
             vm.g_flags |= VM_RETURN;
-        case CON_ENDA:
-        case CON_BREAK:
-        case CON_ENDS:
+        VM_CASE(CON_ENDA):
+        VM_CASE(CON_BREAK):
+        VM_CASE(CON_ENDS):
             return;
-        case CON_NULLOP:
+        VM_CASE(CON_NULLOP):
             insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_ADDAMMO:
+        VM_CASE(CON_ADDAMMO):
             insptr++;
             {
                 int const weap = *insptr++, amount = *insptr++;
@@ -1699,68 +1887,68 @@ skip_check:
 
                 P_AddWeaponAmmoCommon(ps, weap, amount);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_MONEY:
+        VM_CASE(CON_MONEY):
             insptr++;
             A_SpawnMultiple(vm.g_i, MONEY, *insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_MAIL:
+        VM_CASE(CON_MAIL):
             insptr++;
             A_SpawnMultiple(vm.g_i, MAIL, *insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_SLEEPTIME:
+        VM_CASE(CON_SLEEPTIME):
             insptr++;
             actor[vm.g_i].timetosleep = (int16_t)*insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_PAPER:
+        VM_CASE(CON_PAPER):
             insptr++;
             A_SpawnMultiple(vm.g_i, PAPER, *insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_ADDKILLS:
+        VM_CASE(CON_ADDKILLS):
             insptr++;
             ps->actors_killed += *insptr++;
             actor[vm.g_i].actorstayput = -1;
-            continue;
+            VM_NEXT;
 
-        case CON_LOTSOFGLASS:
+        VM_CASE(CON_LOTSOFGLASS):
             insptr++;
             A_SpawnGlass(vm.g_i,*insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_KILLIT:
+        VM_CASE(CON_KILLIT):
             insptr++;
             vm.g_flags |= VM_KILL;
             return;
 
-        case CON_ADDWEAPON:
+        VM_CASE(CON_ADDWEAPON):
             insptr++;
             {
                 int const weap=*insptr++, amount=*insptr++;
                 VM_AddWeapon(weap, amount, ps);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_DEBUG:
+        VM_CASE(CON_DEBUG):
             insptr++;
             initprintf("%" PRIdPTR "\n",*insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_ENDOFGAME:
-        case CON_ENDOFLEVEL:
+        VM_CASE(CON_ENDOFGAME):
+        VM_CASE(CON_ENDOFLEVEL):
             insptr++;
             ps->timebeforeexit = *insptr++;
             ps->customexitsound = -1;
             ud.eog = 1;
-            continue;
+            VM_NEXT;
 
-        case CON_ADDPHEALTH:
+        VM_CASE(CON_ADDPHEALTH):
             insptr++;
 
             {
@@ -1774,7 +1962,7 @@ skip_check:
                     if (j > ps->max_player_health && *insptr > 0)
                     {
                         insptr++;
-                        continue;
+                        VM_NEXT;
                     }
                     else
                     {
@@ -1810,32 +1998,32 @@ skip_check:
             }
 
             insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_MOVE:
+        VM_CASE(CON_MOVE):
             insptr++;
             AC_COUNT(vm.g_t) = 0;
             AC_MOVE_ID(vm.g_t) = *insptr++;
             vm.g_sp->hitag = *insptr++;
             if (A_CheckEnemySprite(vm.g_sp) && vm.g_sp->extra <= 0) // hack
-                continue;
+                VM_NEXT;
             if (vm.g_sp->hitag&random_angle)
                 vm.g_sp->ang = krand()&2047;
-            continue;
+            VM_NEXT;
 
-        case CON_ADDWEAPONVAR:
+        VM_CASE(CON_ADDWEAPONVAR):
             insptr++;
             {
                 int const weap = Gv_GetVarX(*insptr++), amount = Gv_GetVarX(*insptr++);
                 VM_AddWeapon(weap, amount, ps);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_ACTIVATEBYSECTOR:
-        case CON_OPERATESECTORS:
-        case CON_OPERATEACTIVATORS:
-        case CON_SETASPECT:
-        case CON_SSP:
+        VM_CASE(CON_ACTIVATEBYSECTOR):
+        VM_CASE(CON_OPERATESECTORS):
+        VM_CASE(CON_OPERATEACTIVATORS):
+        VM_CASE(CON_SETASPECT):
+        VM_CASE(CON_SSP):
             insptr++;
             {
                 int const var1 = Gv_GetVarX(*insptr++);
@@ -1885,10 +2073,10 @@ skip_check:
                     A_SetSprite(var1, var2);
                     break;
                 }
-                continue;
+                VM_NEXT;
             }
 
-        case CON_CANSEESPR:
+        VM_CASE(CON_CANSEESPR):
             insptr++;
             {
                 int const lVar1 = Gv_GetVarX(*insptr++), lVar2 = Gv_GetVarX(*insptr++);
@@ -1903,30 +2091,30 @@ skip_check:
                 }
 
                 Gv_SetVarX(*insptr++, res);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_OPERATERESPAWNS:
+        VM_CASE(CON_OPERATERESPAWNS):
             insptr++;
             G_OperateRespawns(Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_OPERATEMASTERSWITCHES:
+        VM_CASE(CON_OPERATEMASTERSWITCHES):
             insptr++;
             G_OperateMasterSwitches(Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_CHECKACTIVATORMOTION:
+        VM_CASE(CON_CHECKACTIVATORMOTION):
             insptr++;
             aGameVars[g_iReturnVarID].val.lValue = G_CheckActivatorMotion(Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_INSERTSPRITEQ:
+        VM_CASE(CON_INSERTSPRITEQ):
             insptr++;
             A_AddToDeleteQueue(vm.g_i);
-            continue;
+            VM_NEXT;
 
-        case CON_QSTRLEN:
+        VM_CASE(CON_QSTRLEN):
             insptr++;
             {
                 int const i = *insptr++,
@@ -1936,14 +2124,14 @@ skip_check:
                 {
                     CON_ERRPRINTF("null quote %d\n", j);
                     Gv_SetVarX(i, -1);
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(i, Bstrlen(ScriptQuotes[j]));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_QSTRDIM:
+        VM_CASE(CON_QSTRDIM):
             insptr++;
             {
                 vec2_t dim = { 0, 0, };
@@ -1972,10 +2160,10 @@ skip_check:
 
                 Gv_SetVarX(w, dim.x);
                 Gv_SetVarX(h, dim.y);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_HEADSPRITESTAT:
+        VM_CASE(CON_HEADSPRITESTAT):
             insptr++;
             {
                 int const i = *insptr++,
@@ -1984,14 +2172,14 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)j > MAXSTATUS))
                 {
                     CON_ERRPRINTF("invalid status list %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(i,headspritestat[j]);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_PREVSPRITESTAT:
+        VM_CASE(CON_PREVSPRITESTAT):
             insptr++;
             {
                 int const i = *insptr++,
@@ -2000,14 +2188,14 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)j >= MAXSPRITES))
                 {
                     CON_ERRPRINTF("invalid sprite ID %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(i, prevspritestat[j]);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_NEXTSPRITESTAT:
+        VM_CASE(CON_NEXTSPRITESTAT):
             insptr++;
             {
                 int const i = *insptr++,
@@ -2016,14 +2204,14 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)j >= MAXSPRITES))
                 {
                     CON_ERRPRINTF("invalid sprite ID %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(i,nextspritestat[j]);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_HEADSPRITESECT:
+        VM_CASE(CON_HEADSPRITESECT):
             insptr++;
             {
                 int const i = *insptr++,
@@ -2032,14 +2220,14 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)j >= (unsigned)numsectors))
                 {
                     CON_ERRPRINTF("invalid sector %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(i,headspritesect[j]);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_PREVSPRITESECT:
+        VM_CASE(CON_PREVSPRITESECT):
             insptr++;
             {
                 int const i = *insptr++;
@@ -2048,14 +2236,14 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)j >= MAXSPRITES))
                 {
                     CON_ERRPRINTF("invalid sprite ID %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(i, prevspritesect[j]);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_NEXTSPRITESECT:
+        VM_CASE(CON_NEXTSPRITESECT):
             insptr++;
             {
                 int const i=*insptr++;
@@ -2064,14 +2252,14 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)j >= MAXSPRITES))
                 {
                     CON_ERRPRINTF("invalid sprite ID %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(i,nextspritesect[j]);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETKEYNAME:
+        VM_CASE(CON_GETKEYNAME):
             insptr++;
             {
                 int const i = Gv_GetVarX(*insptr++),
@@ -2081,12 +2269,12 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)i >= MAXQUOTES || ScriptQuotes[i] == NULL))
                 {
                     CON_ERRPRINTF("invalid quote ID %d\n", i);
-                    continue;
+                    VM_NEXT;
                 }
                 else if (EDUKE32_PREDICT_FALSE((unsigned)f >= NUMGAMEFUNCTIONS))
                 {
                     CON_ERRPRINTF("invalid function %d\n", f);
-                    continue;
+                    VM_NEXT;
                 }
                 else
                 {
@@ -2104,10 +2292,10 @@ skip_check:
                 if (*tempbuf)
                     Bstrcpy(ScriptQuotes[i], tempbuf);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_QSUBSTR:
+        VM_CASE(CON_QSUBSTR):
             insptr++;
             {
                 int32_t params[4];
@@ -2119,13 +2307,13 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)q1>=MAXQUOTES || ScriptQuotes[q1] == NULL))
                 {
                     CON_ERRPRINTF("invalid quote ID %d\n", q1);
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (EDUKE32_PREDICT_FALSE((unsigned)q2>=MAXQUOTES || ScriptQuotes[q2] == NULL))
                 {
                     CON_ERRPRINTF("invalid quote ID %d\n", q2);
-                    continue;
+                    VM_NEXT;
                 }
 
                 int st = params[2], ln = params[3];
@@ -2133,13 +2321,13 @@ skip_check:
                 if (EDUKE32_PREDICT_FALSE((unsigned)st >= MAXQUOTELEN))
                 {
                     CON_ERRPRINTF("invalid start position %d\n", st);
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (EDUKE32_PREDICT_FALSE(ln < 0))
                 {
                     CON_ERRPRINTF("invalid length %d\n", ln);
-                    continue;
+                    VM_NEXT;
                 }
 
                 char *s1 = ScriptQuotes[q1];
@@ -2153,15 +2341,15 @@ skip_check:
                 }
                 *s1 = 0;
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETPNAME:
-        case CON_QSTRNCAT:
-        case CON_QSTRCAT:
-        case CON_QSTRCPY:
-        case CON_QGETSYSSTR:
-        case CON_CHANGESPRITESECT:
+        VM_CASE(CON_GETPNAME):
+        VM_CASE(CON_QSTRNCAT):
+        VM_CASE(CON_QSTRCAT):
+        VM_CASE(CON_QSTRCPY):
+        VM_CASE(CON_QGETSYSSTR):
+        VM_CASE(CON_CHANGESPRITESECT):
             insptr++;
             {
                 int32_t i = Gv_GetVarX(*insptr++), j;
@@ -2287,10 +2475,10 @@ nullquote:
                     CON_ERRPRINTF("null quote %d\n", ScriptQuotes[i] ? j : i);
                     break;
                 }
-                continue;
+                VM_NEXT;
             }
 
-        case CON_CHANGESPRITESTAT:
+        VM_CASE(CON_CHANGESPRITESTAT):
             insptr++;
             {
                 int32_t i = Gv_GetVarX(*insptr++);
@@ -2299,15 +2487,15 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)i >= MAXSPRITES))
                 {
                     CON_ERRPRINTF("Invalid sprite: %d\n", i);
-                    continue;
+                    VM_NEXT;
                 }
                 if (EDUKE32_PREDICT_FALSE((unsigned)j >= MAXSTATUS))
                 {
                     CON_ERRPRINTF("Invalid statnum: %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
                 if (sprite[i].statnum == j)
-                    continue;
+                    VM_NEXT;
 
                 /* initialize actor data when changing to an actor statnum because there's usually
                 garbage left over from being handled as a hard coded object */
@@ -2338,10 +2526,10 @@ nullquote:
                 }
 
                 changespritestat(i,j);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_STARTLEVEL:
+        VM_CASE(CON_STARTLEVEL):
             insptr++; // skip command
             {
                 // from 'level' cheat in game.c (about line 6250)
@@ -2350,13 +2538,13 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)volnume >= MAXVOLUMES))
                 {
                     CON_ERRPRINTF("invalid volume (%d)\n", volnume);
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (EDUKE32_PREDICT_FALSE((unsigned)levnume >= MAXLEVELS))
                 {
                     CON_ERRPRINTF("invalid level (%d)\n", levnume);
-                    continue;
+                    VM_NEXT;
                 }
 
                 ud.m_volume_number = ud.volume_number = volnume;
@@ -2369,13 +2557,13 @@ nullquote:
                     ud.display_bonus_screen = 0;
                 } // MODE_RESTART;
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_MYOSX:
-        case CON_MYOSPALX:
-        case CON_MYOS:
-        case CON_MYOSPAL:
+        VM_CASE(CON_MYOSX):
+        VM_CASE(CON_MYOSPALX):
+        VM_CASE(CON_MYOS):
+        VM_CASE(CON_MYOSPAL):
             insptr++;
             {
                 int32_t values[5];
@@ -2399,10 +2587,10 @@ nullquote:
                         VM_DrawTilePalSmall(pos.x, pos.y, tilenum, shade, orientation, Gv_GetVarX(*insptr++));
                         break;
                 }
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SWITCH:
+        VM_CASE(CON_SWITCH):
             insptr++;
             {
                 // command format:
@@ -2447,20 +2635,20 @@ nullquote:
             matched:
                 insptr = (intptr_t *)(lEnd + (intptr_t)&script[0]);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_ENDSWITCH:
+        VM_CASE(CON_ENDSWITCH):
             insptr++;
-        case CON_ENDEVENT:
+        VM_CASE(CON_ENDEVENT):
             return;
 
-        case CON_DISPLAYRAND:
+        VM_CASE(CON_DISPLAYRAND):
             insptr++;
             Gv_SetVarX(*insptr++, system_15bit_rand());
-            continue;
+            VM_NEXT;
 
-        case CON_DRAGPOINT:
+        VM_CASE(CON_DRAGPOINT):
             insptr++;
             {
                 int const wallnum = Gv_GetVarX(*insptr++);
@@ -2471,14 +2659,14 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)wallnum >= (unsigned)numwalls))
                 {
                     CON_ERRPRINTF("Invalid wall %d\n", wallnum);
-                    continue;
+                    VM_NEXT;
                 }
 
                 dragpoint(wallnum, n.x, n.y, 0);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_LDIST:
+        VM_CASE(CON_LDIST):
             insptr++;
             {
                 int const out = *insptr++;
@@ -2489,14 +2677,14 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)in.x >= MAXSPRITES || (unsigned)in.y >= MAXSPRITES))
                 {
                     CON_ERRPRINTF("invalid sprite %d %d\n", in.x, in.y);
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(out, ldist(&sprite[in.x], &sprite[in.y]));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_DIST:
+        VM_CASE(CON_DIST):
             insptr++;
             {
                 int const out = *insptr++;
@@ -2507,14 +2695,14 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)in.x >= MAXSPRITES || (unsigned)in.y >= MAXSPRITES))
                 {
                     CON_ERRPRINTF("invalid sprite %d %d\n", in.x, in.y);
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(out, dist(&sprite[in.x], &sprite[in.y]));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETANGLE:
+        VM_CASE(CON_GETANGLE):
             insptr++;
             {
                 int const out = *insptr++;
@@ -2522,10 +2710,10 @@ nullquote:
 
                 Gv_GetManyVars(2, (int32_t *)&in);
                 Gv_SetVarX(out, getangle(in.x, in.y));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETINCANGLE:
+        VM_CASE(CON_GETINCANGLE):
             insptr++;
             {
                 int const out = *insptr++;
@@ -2533,10 +2721,10 @@ nullquote:
 
                 Gv_GetManyVars(2, (int32_t *)&in);
                 Gv_SetVarX(out, G_GetAngleDelta(in.x, in.y));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_MULSCALE:
+        VM_CASE(CON_MULSCALE):
             insptr++;
             {
                 int const out = *insptr++;
@@ -2544,35 +2732,35 @@ nullquote:
 
                 Gv_GetManyVars(3, (int32_t *)&in);
                 Gv_SetVarX(out, mulscale(in.x, in.y, in.z));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_INITTIMER:
+        VM_CASE(CON_INITTIMER):
             insptr++;
             G_InitTimer(Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_NEXTSECTORNEIGHBORZ:
+        VM_CASE(CON_NEXTSECTORNEIGHBORZ):
             insptr++;
             {
                 int32_t params[4];
                 Gv_GetManyVars(4, params);
                 aGameVars[g_iReturnVarID].val.lValue = nextsectorneighborz(params[0], params[1], params[2], params[3]);
             }
-            continue;
+            VM_NEXT;
 
-        case CON_MOVESECTOR:
+        VM_CASE(CON_MOVESECTOR):
             insptr++;
             A_MoveSector(Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_TIME:
+        VM_CASE(CON_TIME):
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_ESPAWNVAR:
-        case CON_EQSPAWNVAR:
-        case CON_QSPAWNVAR:
+        VM_CASE(CON_ESPAWNVAR):
+        VM_CASE(CON_EQSPAWNVAR):
+        VM_CASE(CON_QSPAWNVAR):
             insptr++;
             {
                 int const lIn = Gv_GetVarX(*insptr++);
@@ -2580,7 +2768,7 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)vm.g_sp->sectnum >= (unsigned)numsectors))
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", TrackerCast(vm.g_sp->sectnum));
-                    continue;
+                    VM_NEXT;
                 }
                 int const j = A_Spawn(vm.g_i, lIn);
 
@@ -2598,12 +2786,12 @@ nullquote:
                         A_AddToDeleteQueue(j);
                     break;
                 }
-                continue;
+                VM_NEXT;
             }
 
-        case CON_ESPAWN:
-        case CON_EQSPAWN:
-        case CON_QSPAWN:
+        VM_CASE(CON_ESPAWN):
+        VM_CASE(CON_EQSPAWN):
+        VM_CASE(CON_QSPAWN):
             insptr++;
 
             {
@@ -2611,7 +2799,7 @@ nullquote:
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", TrackerCast(vm.g_sp->sectnum));
                     insptr++;
-                    continue;
+                    VM_NEXT;
                 }
 
                 int const j = A_Spawn(vm.g_i,*insptr++);
@@ -2630,11 +2818,11 @@ nullquote:
                     break;
                 }
             }
-            continue;
+            VM_NEXT;
 
-        case CON_ESHOOT:
-        case CON_EZSHOOT:
-        case CON_ZSHOOT:
+        VM_CASE(CON_ESHOOT):
+        VM_CASE(CON_EZSHOOT):
+        VM_CASE(CON_ZSHOOT):
             insptr++;
             {
                 // NOTE: (int16_t) cast because we want to exclude that
@@ -2646,7 +2834,7 @@ nullquote:
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", TrackerCast(vm.g_sp->sectnum));
                     insptr++;
-                    continue;
+                    VM_NEXT;
                 }
 
                 int const j = A_ShootWithZvel(vm.g_i,*insptr++,zvel);
@@ -2654,10 +2842,10 @@ nullquote:
                 if (tw != CON_ZSHOOT)
                     aGameVars[g_iReturnVarID].val.lValue = j;
             }
-            continue;
+            VM_NEXT;
 
-        case CON_SHOOTVAR:
-        case CON_ESHOOTVAR:
+        VM_CASE(CON_SHOOTVAR):
+        VM_CASE(CON_ESHOOTVAR):
             insptr++;
             {
                 int j = Gv_GetVarX(*insptr++);
@@ -2665,7 +2853,7 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)vm.g_sp->sectnum >= (unsigned)numsectors))
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", TrackerCast(vm.g_sp->sectnum));
-                    continue;
+                    VM_NEXT;
                 }
 
                 j = A_Shoot(vm.g_i, j);
@@ -2673,11 +2861,11 @@ nullquote:
                 if (tw == CON_ESHOOTVAR)
                     aGameVars[g_iReturnVarID].val.lValue = j;
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_EZSHOOTVAR:
-        case CON_ZSHOOTVAR:
+        VM_CASE(CON_EZSHOOTVAR):
+        VM_CASE(CON_ZSHOOTVAR):
             insptr++;
             {
                 int const zvel = (int16_t)Gv_GetVarX(*insptr++);
@@ -2686,7 +2874,7 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)vm.g_sp->sectnum >= (unsigned)numsectors))
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", TrackerCast(vm.g_sp->sectnum));
-                    continue;
+                    VM_NEXT;
                 }
 
                 j = A_ShootWithZvel(vm.g_i, j, zvel);
@@ -2694,19 +2882,19 @@ nullquote:
                 if (tw == CON_EZSHOOTVAR)
                     aGameVars[g_iReturnVarID].val.lValue = j;
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_CMENU:
+        VM_CASE(CON_CMENU):
             insptr++;
             M_ChangeMenu(Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_SOUNDVAR:
-        case CON_STOPSOUNDVAR:
-        case CON_SOUNDONCEVAR:
-        case CON_GLOBALSOUNDVAR:
-        case CON_SCREENSOUND:
+        VM_CASE(CON_SOUNDVAR):
+        VM_CASE(CON_STOPSOUNDVAR):
+        VM_CASE(CON_SOUNDONCEVAR):
+        VM_CASE(CON_GLOBALSOUNDVAR):
+        VM_CASE(CON_SCREENSOUND):
             insptr++;
             {
                 int const j = Gv_GetVarX(*insptr++);
@@ -2714,7 +2902,7 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)j>=MAXSOUNDS))
                 {
                     CON_ERRPRINTF("Invalid sound %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 switch (tw)
@@ -2723,23 +2911,23 @@ nullquote:
                         if (!S_CheckSoundPlaying(vm.g_i, j))
                     case CON_SOUNDVAR:
                         A_PlaySound((int16_t)j, vm.g_i);
-                        continue;
+                        VM_NEXT;
                     case CON_GLOBALSOUNDVAR:
                         A_PlaySound((int16_t)j, g_player[screenpeek].ps->i);
-                        continue;
+                        VM_NEXT;
                     case CON_STOPSOUNDVAR:
                         if (S_CheckSoundPlaying(vm.g_i, j))
                             S_StopSound((int16_t)j);
-                        continue;
+                        VM_NEXT;
                     case CON_SCREENSOUND:
                         A_PlaySound(j, -1);
-                        continue;
+                        VM_NEXT;
                 }
             }
-            continue;
+            VM_NEXT;
 
-        case CON_STARTCUTSCENE:
-        case CON_IFCUTSCENE:
+        VM_CASE(CON_STARTCUTSCENE):
+        VM_CASE(CON_IFCUTSCENE):
             insptr++;
             {
                 int const j = Gv_GetVarX(*insptr++);
@@ -2747,24 +2935,24 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)j >= MAXQUOTES || ScriptQuotes[j] == NULL))
                 {
                     CON_ERRPRINTF("invalid quote ID %d for anim!\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (tw == CON_IFCUTSCENE)
                 {
                     insptr--;
                     VM_CONDITIONAL(g_animPtr == Anim_Find(ScriptQuotes[j]));
-                    continue;
+                    VM_NEXT;
                 }
 
                 tw = ps->palette;
                 Anim_Play(ScriptQuotes[j]);
                 P_SetGamePalette(ps, tw, 2 + 16);
-                continue;
+                VM_NEXT;
             }
-            continue;
+            VM_NEXT;
 
-        case CON_GUNIQHUDID:
+        VM_CASE(CON_GUNIQHUDID):
             insptr++;
             {
                 tw = Gv_GetVarX(*insptr++);
@@ -2773,18 +2961,18 @@ nullquote:
                 else
                     guniqhudid = tw;
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SAVEGAMEVAR:
-        case CON_READGAMEVAR:
+        VM_CASE(CON_SAVEGAMEVAR):
+        VM_CASE(CON_READGAMEVAR):
         {
             int32_t i=0;
             insptr++;
             if (ud.config.scripthandle < 0)
             {
                 insptr++;
-                continue;
+                VM_NEXT;
             }
             switch (tw)
             {
@@ -2797,11 +2985,11 @@ nullquote:
                 Gv_SetVarX(*insptr++, i);
                 break;
             }
-            continue;
+            VM_NEXT;
         }
 
-        case CON_SHOWVIEW:
-        case CON_SHOWVIEWUNBIASED:
+        VM_CASE(CON_SHOWVIEW):
+        VM_CASE(CON_SHOWVIEWUNBIASED):
             insptr++;
             {
                 vec3_t vec;
@@ -2816,23 +3004,23 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE(scrn[0].x < 0 || scrn[0].y < 0 || scrn[1].x >= 320 || scrn[1].y >= 200))
                 {
                     CON_ERRPRINTF("incorrect coordinates\n");
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (EDUKE32_PREDICT_FALSE((unsigned)params[2] >= (unsigned)numsectors))
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", params[2]);
-                    continue;
+                    VM_NEXT;
                 }
 
                 G_ShowView(vec, params[0], params[1], params[2], scrn[0].x, scrn[0].y, scrn[1].x, scrn[1].y, (tw != CON_SHOWVIEW));
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_ROTATESPRITEA:
-        case CON_ROTATESPRITE16:
-        case CON_ROTATESPRITE:
+        VM_CASE(CON_ROTATESPRITEA):
+        VM_CASE(CON_ROTATESPRITE16):
+        VM_CASE(CON_ROTATESPRITE):
             insptr++;
             {
                 int32_t params[8];
@@ -2858,13 +3046,13 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)tilenum >= MAXTILES))
                 {
                     CON_ERRPRINTF("invalid tilenum %d\n", tilenum);
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (EDUKE32_PREDICT_FALSE(c.x < -(320<<16) || c.x >= (640<<16) || c.y < -(200<<16) || c.y >= (400<<16)))
                 {
                     CON_ERRPRINTF("invalid coordinates: %d, %d\n", c.x, c.y);
-                    continue;
+                    VM_NEXT;
                 }
 
                 int32_t blendidx = 0;
@@ -2873,11 +3061,11 @@ nullquote:
 
                 rotatesprite_(c.x, c.y, c.z, a, tilenum, shade, pal, 2 | orientation, alpha, blendidx,
                               scrn[0].x, scrn[0].y, scrn[1].x, scrn[1].y);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GAMETEXT:
-        case CON_GAMETEXTZ:
+        VM_CASE(CON_GAMETEXT):
+        VM_CASE(CON_GAMETEXTZ):
             insptr++;
             {
                 int32_t params[11];
@@ -2897,21 +3085,21 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE(tilenum < 0 || tilenum + 255 >= MAXTILES))
                 {
                     CON_ERRPRINTF("invalid base tilenum %d\n", tilenum);
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (EDUKE32_PREDICT_FALSE((unsigned)q >= MAXQUOTES || ScriptQuotes[q] == NULL))
                 {
                     CON_ERRPRINTF("invalid quote ID %d\n", q);
-                    continue;
+                    VM_NEXT;
                 }
 
                 G_PrintGameText(0, tilenum, x >> 1, y, ScriptQuotes[q], shade, pal, orientation, b1.x, b1.y, b2.x, b2.y, z, 0);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_DIGITALNUMBER:
-        case CON_DIGITALNUMBERZ:
+        VM_CASE(CON_DIGITALNUMBER):
+        VM_CASE(CON_DIGITALNUMBERZ):
             insptr++;
             {
                 int32_t params[11];
@@ -2931,14 +3119,14 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE(tilenum < 0 || tilenum+9 >= MAXTILES))
                 {
                     CON_ERRPRINTF("invalid base tilenum %d\n", tilenum);
-                    continue;
+                    VM_NEXT;
                 }
 
                 G_DrawTXDigiNumZ(tilenum, x, y, q, shade, pal, orientation, b1.x, b1.y, b2.x, b2.y, z);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_MINITEXT:
+        VM_CASE(CON_MINITEXT):
             insptr++;
             {
                 int32_t params[5];
@@ -2951,14 +3139,14 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)q >= MAXQUOTES || ScriptQuotes[q] == NULL))
                 {
                     CON_ERRPRINTF("invalid quote ID %d\n", q);
-                    continue;
+                    VM_NEXT;
                 }
 
                 minitextshade(x,y,ScriptQuotes[q],shade,pal, 2+8+16);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SCREENTEXT:
+        VM_CASE(CON_SCREENTEXT):
             insptr++;
             {
                 int32_t params[20];
@@ -2980,26 +3168,26 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE(tilenum < 0 || tilenum+255 >= MAXTILES))
                 {
                     CON_ERRPRINTF("invalid base tilenum %d\n", tilenum);
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (EDUKE32_PREDICT_FALSE((unsigned)q >= MAXQUOTES || ScriptQuotes[q] == NULL))
                 {
                     CON_ERRPRINTF("invalid quote ID %d\n", q);
-                    continue;
+                    VM_NEXT;
                 }
 
                 G_ScreenText(tilenum, v.x, v.y, v.z, blockangle, charangle, ScriptQuotes[q], shade, pal, 2 | orientation,
                              alpha, xspace, yline, xbetween, ybetween, f, scrn[0].x, scrn[0].y, scrn[1].x, scrn[1].y);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_ANGOFF:
+        VM_CASE(CON_ANGOFF):
             insptr++;
             spriteext[vm.g_i].angoff=*insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_GETZRANGE:
+        VM_CASE(CON_GETZRANGE):
             insptr++;
             {
                 vec3_t vect;
@@ -3014,7 +3202,7 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)sectnum >= (unsigned)numsectors))
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", sectnum);
-                    continue;
+                    VM_NEXT;
                 }
 
                 getzrange(&vect, sectnum, &ceilz, &ceilhit, &florz, &florhit, walldist, clipmask);
@@ -3023,11 +3211,11 @@ nullquote:
                 Gv_SetVarX(florzvar, florz);
                 Gv_SetVarX(florhitvar, florhit);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SECTSETINTERPOLATION:
-        case CON_SECTCLEARINTERPOLATION:
+        VM_CASE(CON_SECTSETINTERPOLATION):
+        VM_CASE(CON_SECTCLEARINTERPOLATION):
             insptr++;
             {
                 int const sectnum = Gv_GetVarX(*insptr++);
@@ -3035,7 +3223,7 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)sectnum >= (unsigned)numsectors))
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", sectnum);
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (tw==CON_SECTSETINTERPOLATION)
@@ -3043,10 +3231,10 @@ nullquote:
                 else
                     Sect_ClearInterpolation(sectnum);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_CALCHYPOTENUSE:
+        VM_CASE(CON_CALCHYPOTENUSE):
             insptr++;
             {
                 int32_t retvar=*insptr++;
@@ -3059,11 +3247,11 @@ nullquote:
                 else
                     Gv_SetVarX(retvar, ksqrt((uint32_t)hypsq));
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_LINEINTERSECT:
-        case CON_RAYINTERSECT:
+        VM_CASE(CON_LINEINTERSECT):
+        VM_CASE(CON_RAYINTERSECT):
             insptr++;
             {
                 vec3_t vec[2];
@@ -3092,11 +3280,11 @@ nullquote:
                     Gv_SetVarX(intzvar, in.z);
                 }
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_CLIPMOVE:
-        case CON_CLIPMOVENOSLIDE:
+        VM_CASE(CON_CLIPMOVE):
+        VM_CASE(CON_CLIPMOVENOSLIDE):
             insptr++;
             {
                 typedef struct {
@@ -3125,7 +3313,7 @@ nullquote:
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", sectnum);
                     Gv_SetVarX(retvar, 0);
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(retvar, clipmovex(&vec3, &sectnum, vec2.x, vec2.y, dist.w, dist.f, dist.c, clipmask, (tw == CON_CLIPMOVENOSLIDE)));
@@ -3133,10 +3321,10 @@ nullquote:
                 Gv_SetVarX(xvar, vec3.x);
                 Gv_SetVarX(yvar, vec3.y);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_HITSCAN:
+        VM_CASE(CON_HITSCAN):
             insptr++;
             {
                 vec3_t vect;
@@ -3153,7 +3341,7 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)sectnum >= (unsigned)numsectors))
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", sectnum);
-                    continue;
+                    VM_NEXT;
                 }
 
                 hitdata_t hit;
@@ -3165,10 +3353,10 @@ nullquote:
                 Gv_SetVarX(hitxvar, hit.pos.x);
                 Gv_SetVarX(hityvar, hit.pos.y);
                 Gv_SetVarX(hitzvar, hit.pos.z);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_CANSEE:
+        VM_CASE(CON_CANSEE):
             insptr++;
             {
                 vec3_t vec1;
@@ -3188,10 +3376,10 @@ nullquote:
                 }
 
                 Gv_SetVarX(rvar, cansee(vec1.x, vec1.y, vec1.z, sect1, vec2.x, vec2.y, vec2.z, sect2));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_ROTATEPOINT:
+        VM_CASE(CON_ROTATEPOINT):
             insptr++;
             {
                 vec2_t point[2];
@@ -3206,10 +3394,10 @@ nullquote:
 
                 Gv_SetVarX(x2var, result.x);
                 Gv_SetVarX(y2var, result.y);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_NEARTAG:
+        VM_CASE(CON_NEARTAG):
             insptr++;
             {
                 //             neartag(int32_t x, int32_t y, int32_t z, short sectnum, short ang,  //Starting position & angle
@@ -3232,7 +3420,7 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)sectnum >= (unsigned)numsectors))
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", sectnum);
-                    continue;
+                    VM_NEXT;
                 }
                 neartag(point.x, point.y, point.z, sectnum, ang, &neartagsector, &neartagwall, &neartagsprite,
                         &neartaghitdist, neartagrange, tagsearch, NULL);
@@ -3241,10 +3429,10 @@ nullquote:
                 Gv_SetVarX(neartagwallvar, neartagwall);
                 Gv_SetVarX(neartagspritevar, neartagsprite);
                 Gv_SetVarX(neartaghitdistvar, neartaghitdist);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETTIMEDATE:
+        VM_CASE(CON_GETTIMEDATE):
             insptr++;
             {
                 int32_t i, vals[8];
@@ -3254,10 +3442,10 @@ nullquote:
                 for (i=0; i<8; i++)
                     Gv_SetVarX(*insptr++, vals[i]);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_MOVESPRITE:
+        VM_CASE(CON_MOVESPRITE):
             insptr++;
             {
                 int const spritenum = Gv_GetVarX(*insptr++);
@@ -3271,14 +3459,14 @@ nullquote:
                 {
                     CON_ERRPRINTF("invalid sprite ID %d\n", spritenum);
                     insptr++;
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(*insptr++, A_MoveSprite(spritenum, &vect, cliptype));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETSPRITE:
+        VM_CASE(CON_SETSPRITE):
             insptr++;
             {
                 int const spritenum = Gv_GetVarX(*insptr++);
@@ -3289,14 +3477,14 @@ nullquote:
                 if (EDUKE32_PREDICT_FALSE((unsigned)spritenum >= MAXSPRITES))
                 {
                     CON_ERRPRINTF("invalid sprite ID %d\n", spritenum);
-                    continue;
+                    VM_NEXT;
                 }
                 setsprite(spritenum, &vect);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETFLORZOFSLOPE:
-        case CON_GETCEILZOFSLOPE:
+        VM_CASE(CON_GETFLORZOFSLOPE):
+        VM_CASE(CON_GETCEILZOFSLOPE):
             insptr++;
             {
                 int const sectnum = Gv_GetVarX(*insptr++);
@@ -3307,16 +3495,16 @@ nullquote:
                 {
                     CON_ERRPRINTF("Invalid sector %d\n", sectnum);
                     insptr++;
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_SetVarX(*insptr++, (tw == CON_GETFLORZOFSLOPE) ? getflorzofslope(sectnum, vect.x, vect.y) :
                                                                     getceilzofslope(sectnum, vect.x, vect.y));
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_UPDATESECTOR:
+        VM_CASE(CON_UPDATESECTOR):
             insptr++;
             {
                 vec2_t vect = { 0, 0 };
@@ -3327,10 +3515,10 @@ nullquote:
                 updatesector(vect.x, vect.y, &w);
 
                 Gv_SetVarX(var, w);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_UPDATESECTORZ:
+        VM_CASE(CON_UPDATESECTORZ):
             insptr++;
             {
                 vec3_t vect ={ 0, 0, 0 };
@@ -3341,46 +3529,46 @@ nullquote:
                 updatesectorz(vect.x, vect.y, vect.z, &w);
 
                 Gv_SetVarX(var, w);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SPAWN:
+        VM_CASE(CON_SPAWN):
             insptr++;
             if ((unsigned)vm.g_sp->sectnum >= MAXSECTORS)
             {
                 CON_ERRPRINTF("Invalid sector %d\n", TrackerCast(vm.g_sp->sectnum));
                 insptr++;
-                continue;
+                VM_NEXT;
             }
             A_Spawn(vm.g_i,*insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_IFWASWEAPON:
+        VM_CASE(CON_IFWASWEAPON):
             insptr++;
             VM_CONDITIONAL(actor[vm.g_i].picnum == *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFAI:
+        VM_CASE(CON_IFAI):
             insptr++;
             VM_CONDITIONAL(AC_AI_ID(vm.g_t) == *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFACTION:
+        VM_CASE(CON_IFACTION):
             insptr++;
             VM_CONDITIONAL(AC_ACTION_ID(vm.g_t) == *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFACTIONCOUNT:
+        VM_CASE(CON_IFACTIONCOUNT):
             insptr++;
             VM_CONDITIONAL(AC_ACTION_COUNT(vm.g_t) >= *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_RESETACTIONCOUNT:
+        VM_CASE(CON_RESETACTIONCOUNT):
             insptr++;
             AC_ACTION_COUNT(vm.g_t) = 0;
-            continue;
+            VM_NEXT;
 
-        case CON_DEBRIS:
+        VM_CASE(CON_DEBRIS):
             insptr++;
             {
                 int32_t dnum = *insptr++;
@@ -3405,36 +3593,36 @@ nullquote:
                     }
                 insptr++;
             }
-            continue;
+            VM_NEXT;
 
-        case CON_COUNT:
+        VM_CASE(CON_COUNT):
             insptr++;
             AC_COUNT(vm.g_t) = (int16_t) *insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_CSTATOR:
+        VM_CASE(CON_CSTATOR):
             insptr++;
             vm.g_sp->cstat |= (int16_t) *insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_CLIPDIST:
+        VM_CASE(CON_CLIPDIST):
             insptr++;
             vm.g_sp->clipdist = (int16_t) *insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_CSTAT:
+        VM_CASE(CON_CSTAT):
             insptr++;
             vm.g_sp->cstat = (int16_t) *insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_SAVENN:
-        case CON_SAVE:
+        VM_CASE(CON_SAVENN):
+        VM_CASE(CON_SAVE):
             insptr++;
             {
                 g_lastSaveSlot = *insptr++;
 
                 if ((unsigned)g_lastSaveSlot >= MAXSAVEGAMES)
-                    continue;
+                    VM_NEXT;
 
                 if (tw == CON_SAVE || ud.savegame[g_lastSaveSlot][0] == 0)
                 {
@@ -3455,54 +3643,54 @@ nullquote:
 
                 G_SavePlayerMaybeMulti(g_lastSaveSlot);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_QUAKE:
+        VM_CASE(CON_QUAKE):
             insptr++;
             g_earthquakeTime = Gv_GetVarX(*insptr++);
             A_PlaySound(EARTHQUAKE,g_player[screenpeek].ps->i);
-            continue;
+            VM_NEXT;
 
-        case CON_IFMOVE:
+        VM_CASE(CON_IFMOVE):
             insptr++;
             VM_CONDITIONAL(AC_MOVE_ID(vm.g_t) == *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_RESETPLAYER:
+        VM_CASE(CON_RESETPLAYER):
             insptr++;
             vm.g_flags = VM_ResetPlayer(vm.g_p, vm.g_flags, 0);
-            continue;
+            VM_NEXT;
 
-        case CON_RESETPLAYERFLAGS:
+        VM_CASE(CON_RESETPLAYERFLAGS):
             insptr++;
             vm.g_flags = VM_ResetPlayer(vm.g_p, vm.g_flags, Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_IFONWATER:
+        VM_CASE(CON_IFONWATER):
             VM_CONDITIONAL(sector[vm.g_sp->sectnum].lotag == ST_1_ABOVE_WATER && klabs(vm.g_sp->z-sector[vm.g_sp->sectnum].floorz) < (32<<8));
-            continue;
+            VM_NEXT;
 
-        case CON_IFINWATER:
+        VM_CASE(CON_IFINWATER):
             VM_CONDITIONAL(sector[vm.g_sp->sectnum].lotag == ST_2_UNDERWATER);
-            continue;
+            VM_NEXT;
 
-        case CON_IFCOUNT:
+        VM_CASE(CON_IFCOUNT):
             insptr++;
             VM_CONDITIONAL(AC_COUNT(vm.g_t) >= *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFACTOR:
+        VM_CASE(CON_IFACTOR):
             insptr++;
             VM_CONDITIONAL(vm.g_sp->picnum == *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_RESETCOUNT:
+        VM_CASE(CON_RESETCOUNT):
             insptr++;
             AC_COUNT(vm.g_t) = 0;
-            continue;
+            VM_NEXT;
 
-        case CON_ADDINVENTORY:
+        VM_CASE(CON_ADDINVENTORY):
         {
             insptr += 2;
 
@@ -3545,24 +3733,24 @@ nullquote:
                 break;
             }
             insptr++;
-            continue;
+            VM_NEXT;
         }
 
-        case CON_HITRADIUSVAR:
+        VM_CASE(CON_HITRADIUSVAR):
             insptr++;
             {
                 int32_t params[5];
                 Gv_GetManyVars(5, params);
                 A_RadiusDamage(vm.g_i, params[0], params[1], params[2], params[3], params[4]);
             }
-            continue;
+            VM_NEXT;
 
-        case CON_HITRADIUS:
+        VM_CASE(CON_HITRADIUS):
             A_RadiusDamage(vm.g_i,*(insptr+1),*(insptr+2),*(insptr+3),*(insptr+4),*(insptr+5));
             insptr += 6;
-            continue;
+            VM_NEXT;
 
-        case CON_IFP:
+        VM_CASE(CON_IFP):
         {
             int const l = *(++insptr);
             int j = 0;
@@ -3599,90 +3787,90 @@ nullquote:
             }
             VM_CONDITIONAL(j);
         }
-        continue;
+        VM_NEXT;
 
-        case CON_IFSTRENGTH:
+        VM_CASE(CON_IFSTRENGTH):
             insptr++;
             VM_CONDITIONAL(vm.g_sp->extra <= *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_GUTS:
+        VM_CASE(CON_GUTS):
             A_DoGuts(vm.g_i,*(insptr+1),*(insptr+2));
             insptr += 3;
-            continue;
+            VM_NEXT;
 
-        case CON_IFSPAWNEDBY:
+        VM_CASE(CON_IFSPAWNEDBY):
             insptr++;
             VM_CONDITIONAL(actor[vm.g_i].picnum == *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_WACKPLAYER:
+        VM_CASE(CON_WACKPLAYER):
             insptr++;
             P_ForceAngle(ps);
-            continue;
+            VM_NEXT;
 
-        case CON_FLASH:
+        VM_CASE(CON_FLASH):
             insptr++;
             sprite[vm.g_i].shade = -127;
             ps->visibility = -127;
-            continue;
+            VM_NEXT;
 
-        case CON_SAVEMAPSTATE:
+        VM_CASE(CON_SAVEMAPSTATE):
             G_SaveMapState();
             insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_LOADMAPSTATE:
+        VM_CASE(CON_LOADMAPSTATE):
             G_RestoreMapState();
             insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_CLEARMAPSTATE:
+        VM_CASE(CON_CLEARMAPSTATE):
             insptr++;
             {
                 int const j = Gv_GetVarX(*insptr++);
                 if (EDUKE32_PREDICT_FALSE((unsigned)j >= MAXVOLUMES*MAXLEVELS))
                 {
                     CON_ERRPRINTF("Invalid map number: %d\n", j);
-                    continue;
+                    VM_NEXT;
                 }
 
                 G_FreeMapState(j);
             }
-            continue;
+            VM_NEXT;
 
-        case CON_STOPALLSOUNDS:
+        VM_CASE(CON_STOPALLSOUNDS):
             insptr++;
             if (screenpeek == vm.g_p)
                 FX_StopAllSounds();
-            continue;
+            VM_NEXT;
 
-        case CON_IFGAPZL:
+        VM_CASE(CON_IFGAPZL):
             insptr++;
             VM_CONDITIONAL(((actor[vm.g_i].floorz - actor[vm.g_i].ceilingz) >> 8) < *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFHITSPACE:
+        VM_CASE(CON_IFHITSPACE):
             VM_CONDITIONAL(TEST_SYNC_KEY(g_player[vm.g_p].sync->bits, SK_OPEN));
-            continue;
+            VM_NEXT;
 
-        case CON_IFOUTSIDE:
+        VM_CASE(CON_IFOUTSIDE):
             VM_CONDITIONAL(sector[vm.g_sp->sectnum].ceilingstat&1);
-            continue;
+            VM_NEXT;
 
-        case CON_IFMULTIPLAYER:
+        VM_CASE(CON_IFMULTIPLAYER):
             VM_CONDITIONAL((g_netServer || g_netClient || ud.multimode > 1));
-            continue;
+            VM_NEXT;
 
-        case CON_IFCLIENT:
+        VM_CASE(CON_IFCLIENT):
             VM_CONDITIONAL(g_netClient != NULL);
-            continue;
+            VM_NEXT;
 
-        case CON_IFSERVER:
+        VM_CASE(CON_IFSERVER):
             VM_CONDITIONAL(g_netServer != NULL);
-            continue;
+            VM_NEXT;
 
-        case CON_OPERATE:
+        VM_CASE(CON_OPERATE):
             insptr++;
             if (sector[vm.g_sp->sectnum].lotag == 0)
             {
@@ -3706,45 +3894,45 @@ nullquote:
                                 G_OperateSectors(neartagsector,vm.g_i);
                         }
             }
-            continue;
+            VM_NEXT;
 
-        case CON_IFINSPACE:
+        VM_CASE(CON_IFINSPACE):
             VM_CONDITIONAL(G_CheckForSpaceCeiling(vm.g_sp->sectnum));
-            continue;
+            VM_NEXT;
 
-        case CON_SPRITEPAL:
+        VM_CASE(CON_SPRITEPAL):
             insptr++;
             if (vm.g_sp->picnum != APLAYER)
                 actor[vm.g_i].tempang = vm.g_sp->pal;
             vm.g_sp->pal = *insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_CACTOR:
+        VM_CASE(CON_CACTOR):
             insptr++;
             vm.g_sp->picnum = *insptr++;
-            continue;
+            VM_NEXT;
 
-        case CON_IFBULLETNEAR:
+        VM_CASE(CON_IFBULLETNEAR):
             VM_CONDITIONAL(A_Dodge(vm.g_sp) == 1);
-            continue;
+            VM_NEXT;
 
-        case CON_IFRESPAWN:
+        VM_CASE(CON_IFRESPAWN):
             if (A_CheckEnemySprite(vm.g_sp)) VM_CONDITIONAL(ud.respawn_monsters)
             else if (A_CheckInventorySprite(vm.g_sp)) VM_CONDITIONAL(ud.respawn_inventory)
             else VM_CONDITIONAL(ud.respawn_items)
-            continue;
+            VM_NEXT;
 
-        case CON_IFFLOORDISTL:
+        VM_CASE(CON_IFFLOORDISTL):
             insptr++;
             VM_CONDITIONAL((actor[vm.g_i].floorz - vm.g_sp->z) <= ((*insptr)<<8));
-            continue;
+            VM_NEXT;
 
-        case CON_IFCEILINGDISTL:
+        VM_CASE(CON_IFCEILINGDISTL):
             insptr++;
             VM_CONDITIONAL((vm.g_sp->z - actor[vm.g_i].ceilingz) <= ((*insptr)<<8));
-            continue;
+            VM_NEXT;
 
-        case CON_PALFROM:
+        VM_CASE(CON_PALFROM):
             insptr++;
             if (EDUKE32_PREDICT_FALSE((unsigned)vm.g_p >= (unsigned)playerswhenstarted))
             {
@@ -3757,15 +3945,15 @@ nullquote:
 
                 P_PalFrom(ps, f, r,g,b);
             }
-            continue;
+            VM_NEXT;
 
-        case CON_SECTOROFWALL:
+        VM_CASE(CON_SECTOROFWALL):
             insptr++;
             tw = *insptr++;
             Gv_SetVarX(tw, sectorofwall(Gv_GetVarX(*insptr++)));
-            continue;
+            VM_NEXT;
 
-        case CON_QSPRINTF:
+        VM_CASE(CON_QSPRINTF):
             insptr++;
             {
                 int32_t dq = Gv_GetVarX(*insptr++), sq = Gv_GetVarX(*insptr++);
@@ -3777,7 +3965,7 @@ nullquote:
                         Gv_GetVarX(*insptr++);
 
                     insptr++; // skip the NOP
-                    continue;
+                    VM_NEXT;
                 }
 
                 {
@@ -3851,19 +4039,19 @@ nullquote:
 finish_qsprintf:
                     tempbuf[j] = '\0';
                     Bstrncpyz(ScriptQuotes[dq], tempbuf, MAXQUOTELEN);
-                    continue;
+                    VM_NEXT;
                 }
             }
 
-        case CON_ADDLOG:
+        VM_CASE(CON_ADDLOG):
         {
             insptr++;
 
             OSD_Printf(OSDTEXT_GREEN "CONLOG: L=%d\n",g_errorLineNum);
-            continue;
+            VM_NEXT;
         }
 
-        case CON_ADDLOGVAR:
+        VM_CASE(CON_ADDLOGVAR):
             insptr++;
             {
                 int32_t m=1;
@@ -3895,12 +4083,12 @@ finish_qsprintf:
                             OSD_Printf(OSDTEXT_GREEN "%s: L=%d %s[%d] =%d\n", keyw[g_tw], g_errorLineNum,
                                        aGameArrays[lVarID].szLabel, index,
                                        (int32_t)(m*Gv_GetGameArrayValue(lVarID, index)));
-                            continue;
+                            VM_NEXT;
                         }
                         else
                         {
                             CON_ERRPRINTF("invalid array index\n");
-                            continue;
+                            VM_NEXT;
                         }
                     }
                     else if (*insptr&(MAXGAMEVARS<<3))
@@ -3915,10 +4103,10 @@ finish_qsprintf:
                             {
                                 CON_ERRPRINTF("invalid array index\n");
                                 Gv_GetVarX(*insptr++);
-                                continue;
+                                VM_NEXT;
                             }
                             OSD_Printf(OSDTEXT_GREEN "%s: L=%d %d %d\n",keyw[g_tw],g_errorLineNum,index,Gv_GetVar(*insptr++,index,vm.g_p));
-                            continue;
+                            VM_NEXT;
                         }
                     }
                     else if (EDUKE32_PREDICT_TRUE(*insptr&(MAXGAMEVARS<<1)))
@@ -3931,7 +4119,7 @@ finish_qsprintf:
                         // invalid varID
                         insptr++;
                         CON_ERRPRINTF("invalid variable\n");
-                        continue;  // out of switch
+                        VM_NEXT;  // out of switch
                     }
                 }
                 Bsprintf(szBuf,"CONLOGVAR: L=%d %s ",g_errorLineNum, aGameVars[lVarID].szLabel);
@@ -3959,10 +4147,10 @@ finish_qsprintf:
                 Bstrcat(g_szBuf,szBuf);
                 OSD_Printf(OSDTEXT_GREEN "%s",g_szBuf);
                 insptr++;
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETSECTOR:
+        VM_CASE(CON_SETSECTOR):
             insptr++;
             {
                 tw = *insptr++;
@@ -3972,10 +4160,10 @@ finish_qsprintf:
                 register int32_t const iSet = Gv_GetVarX(lVar2);
 
                 VM_SetSector(iSector, lLabelID, iSet);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETSECTOR:
+        VM_CASE(CON_GETSECTOR):
             insptr++;
             {
                 tw = *insptr++;
@@ -3984,22 +4172,22 @@ finish_qsprintf:
                 register int32_t const iSector = (tw != g_iThisActorID) ? Gv_GetVarX(tw) : sprite[vm.g_i].sectnum;
 
                 Gv_SetVarX(lVar2, VM_GetSector(iSector, lLabelID));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SQRT:
+        VM_CASE(CON_SQRT):
             insptr++;
             {
                 // syntax sqrt <invar> <outvar>
                 int const sqrtval = ksqrt((uint32_t)Gv_GetVarX(*insptr++));
                 Gv_SetVarX(*insptr++, sqrtval);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_FINDNEARACTOR:
-        case CON_FINDNEARSPRITE:
-        case CON_FINDNEARACTOR3D:
-        case CON_FINDNEARSPRITE3D:
+        VM_CASE(CON_FINDNEARACTOR):
+        VM_CASE(CON_FINDNEARSPRITE):
+        VM_CASE(CON_FINDNEARACTOR3D):
+        VM_CASE(CON_FINDNEARSPRITE3D):
             insptr++;
             {
                 // syntax findnearactorvar <type> <maxdist> <getvar>
@@ -4033,7 +4221,7 @@ finish_qsprintf:
                     }
                     while (k--);
                     Gv_SetVarX(lVarID, lFound);
-                    continue;
+                    VM_NEXT;
                 }
 
                 do
@@ -4055,13 +4243,13 @@ finish_qsprintf:
                 }
                 while (k--);
                 Gv_SetVarX(lVarID, lFound);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_FINDNEARACTORVAR:
-        case CON_FINDNEARSPRITEVAR:
-        case CON_FINDNEARACTOR3DVAR:
-        case CON_FINDNEARSPRITE3DVAR:
+        VM_CASE(CON_FINDNEARACTORVAR):
+        VM_CASE(CON_FINDNEARSPRITEVAR):
+        VM_CASE(CON_FINDNEARACTOR3DVAR):
+        VM_CASE(CON_FINDNEARSPRITE3DVAR):
             insptr++;
             {
                 // syntax findnearactorvar <type> <maxdistvar> <getvar>
@@ -4096,7 +4284,7 @@ finish_qsprintf:
                     }
                     while (k--);
                     Gv_SetVarX(lVarID, lFound);
-                    continue;
+                    VM_NEXT;
                 }
 
                 do
@@ -4119,11 +4307,11 @@ finish_qsprintf:
                 }
                 while (k--);
                 Gv_SetVarX(lVarID, lFound);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_FINDNEARACTORZVAR:
-        case CON_FINDNEARSPRITEZVAR:
+        VM_CASE(CON_FINDNEARACTORZVAR):
+        VM_CASE(CON_FINDNEARSPRITEZVAR):
             insptr++;
             {
                 // syntax findnearactorvar <type> <maxdistvar> <getvar>
@@ -4162,11 +4350,11 @@ finish_qsprintf:
                 while (k--);
                 Gv_SetVarX(lVarID, lFound);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_FINDNEARACTORZ:
-        case CON_FINDNEARSPRITEZ:
+        VM_CASE(CON_FINDNEARACTORZ):
+        VM_CASE(CON_FINDNEARSPRITEZ):
             insptr++;
             {
                 // syntax findnearactorvar <type> <maxdist> <getvar>
@@ -4205,22 +4393,22 @@ finish_qsprintf:
                 }
                 while (k--);
                 Gv_SetVarX(lVarID, lFound);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_FINDPLAYER:
+        VM_CASE(CON_FINDPLAYER):
             insptr++;
             aGameVars[g_iReturnVarID].val.lValue = A_FindPlayer(&sprite[vm.g_i], &tw);
             Gv_SetVarX(*insptr++, tw);
-            continue;
+            VM_NEXT;
 
-        case CON_FINDOTHERPLAYER:
+        VM_CASE(CON_FINDOTHERPLAYER):
             insptr++;
             aGameVars[g_iReturnVarID].val.lValue = P_FindOtherPlayer(vm.g_p,&tw);
             Gv_SetVarX(*insptr++, tw);
-            continue;
+            VM_NEXT;
 
-        case CON_SETPLAYER:
+        VM_CASE(CON_SETPLAYER):
             insptr++;
             {
                 tw=*insptr++;
@@ -4232,10 +4420,10 @@ finish_qsprintf:
                 register int32_t const iSet = Gv_GetVarX(lVar2);
 
                 VM_SetPlayer(iPlayer, lLabelID, lParm2, iSet);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETPLAYER:
+        VM_CASE(CON_GETPLAYER):
             insptr++;
             {
                 tw=*insptr++;
@@ -4246,10 +4434,10 @@ finish_qsprintf:
                 register int32_t const iPlayer = (tw != g_iThisActorID) ? Gv_GetVarX(tw) : vm.g_p;
 
                 Gv_SetVarX(lVar2, VM_GetPlayer(iPlayer, lLabelID, lParm2));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETINPUT:
+        VM_CASE(CON_GETINPUT):
             insptr++;
             {
                 tw=*insptr++;
@@ -4258,10 +4446,10 @@ finish_qsprintf:
                 register int32_t const iPlayer = (tw != g_iThisActorID) ? Gv_GetVarX(tw) : vm.g_p;
 
                 Gv_SetVarX(lVar2, VM_GetPlayerInput(iPlayer, lLabelID));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETINPUT:
+        VM_CASE(CON_SETINPUT):
             insptr++;
             {
                 tw=*insptr++;
@@ -4271,20 +4459,20 @@ finish_qsprintf:
                 register int32_t const iSet = Gv_GetVarX(lVar2);
 
                 VM_SetPlayerInput(iPlayer, lLabelID, iSet);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETUSERDEF:
+        VM_CASE(CON_GETUSERDEF):
             insptr++;
             {
                 tw=*insptr++;
                 int const lVar2=*insptr++;
 
                 Gv_SetVarX(lVar2, VM_GetUserdef(tw));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETUSERDEF:
+        VM_CASE(CON_SETUSERDEF):
             insptr++;
             {
                 tw=*insptr++;
@@ -4293,20 +4481,20 @@ finish_qsprintf:
                 register int32_t const iSet = Gv_GetVarX(lVar2);
 
                 VM_SetUserdef(tw, iSet);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETPROJECTILE:
+        VM_CASE(CON_GETPROJECTILE):
             insptr++;
             {
                 tw = Gv_GetVarX(*insptr++);
                 int const lLabelID = *insptr++, lVar2 = *insptr++;
 
                 Gv_SetVarX(lVar2, VM_GetProjectile(tw, lLabelID));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETPROJECTILE:
+        VM_CASE(CON_SETPROJECTILE):
             insptr++;
             {
                 tw=Gv_GetVarX(*insptr++);
@@ -4315,10 +4503,10 @@ finish_qsprintf:
                 register int32_t const iSet = Gv_GetVarX(lVar2);
 
                 VM_SetProjectile(tw, lLabelID, iSet);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETWALL:
+        VM_CASE(CON_SETWALL):
             insptr++;
             {
                 tw=*insptr++;
@@ -4328,10 +4516,10 @@ finish_qsprintf:
                 register int32_t const iSet = Gv_GetVarX(lVar2);
 
                 VM_SetWall(iWall, lLabelID, iSet);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETWALL:
+        VM_CASE(CON_GETWALL):
             insptr++;
             {
                 tw=*insptr++;
@@ -4340,11 +4528,11 @@ finish_qsprintf:
                 register int32_t const iWall = Gv_GetVarX(tw);
 
                 Gv_SetVarX(lVar2, VM_GetWall(iWall, lLabelID));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETACTORVAR:
-        case CON_GETACTORVAR:
+        VM_CASE(CON_SETACTORVAR):
+        VM_CASE(CON_GETACTORVAR):
             insptr++;
             {
                 int const lSprite=Gv_GetVarX(*insptr++), lVar1=*insptr++;
@@ -4355,20 +4543,20 @@ finish_qsprintf:
                     CON_ERRPRINTF("invalid sprite ID %d\n", lSprite);
                     if (lVar1 == MAXGAMEVARS || lVar1 & ((MAXGAMEVARS<<2)|(MAXGAMEVARS<<3))) insptr++;
                     if (lVar2 == MAXGAMEVARS || lVar2 & ((MAXGAMEVARS<<2)|(MAXGAMEVARS<<3))) insptr++;
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (tw == CON_SETACTORVAR)
                 {
                     Gv_SetVar(lVar1, Gv_GetVarX(lVar2), lSprite, vm.g_p);
-                    continue;
+                    VM_NEXT;
                 }
                 Gv_SetVarX(lVar2, Gv_GetVar(lVar1, lSprite, vm.g_p));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETPLAYERVAR:
-        case CON_GETPLAYERVAR:
+        VM_CASE(CON_SETPLAYERVAR):
+        VM_CASE(CON_GETPLAYERVAR):
             insptr++;
             {
                 int const iPlayer = (*insptr != g_iThisActorID) ? Gv_GetVarX(*insptr) : vm.g_p;
@@ -4387,7 +4575,7 @@ finish_qsprintf:
                     if (lVar2 == MAXGAMEVARS || lVar2 & ((MAXGAMEVARS << 2) | (MAXGAMEVARS << 3)))
                         insptr++;
 
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (tw == CON_SETPLAYERVAR)
@@ -4395,10 +4583,10 @@ finish_qsprintf:
                 else
                     Gv_SetVarX(lVar2, Gv_GetVar(lVar1, vm.g_i, iPlayer));
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETACTOR:
+        VM_CASE(CON_SETACTOR):
             insptr++;
             {
                 tw = *insptr++;
@@ -4410,10 +4598,10 @@ finish_qsprintf:
                 register int32_t const iSet = Gv_GetVarX(lVar2);
 
                 VM_SetSprite(iActor, lLabelID, lParm2, iSet);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETACTOR:
+        VM_CASE(CON_GETACTOR):
             insptr++;
             {
                 tw = *insptr++;
@@ -4424,10 +4612,10 @@ finish_qsprintf:
                 register int32_t const iActor = (tw != g_iThisActorID) ? Gv_GetVarX(tw) : vm.g_i;
 
                 Gv_SetVarX(lVar2, VM_GetSprite(iActor, lLabelID, lParm2));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_SETTSPR:
+        VM_CASE(CON_SETTSPR):
             insptr++;
             {
                 tw = *insptr++;
@@ -4437,10 +4625,10 @@ finish_qsprintf:
                 register int32_t const iSet = Gv_GetVarX(lVar2);
 
                 VM_SetTsprite(iActor, lLabelID, iSet);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETTSPR:
+        VM_CASE(CON_GETTSPR):
             insptr++;
             {
                 tw = *insptr++;
@@ -4449,26 +4637,26 @@ finish_qsprintf:
                 register int32_t const iActor = (tw != g_iThisActorID) ? Gv_GetVarX(tw) : vm.g_i;
 
                 Gv_SetVarX(lVar2, VM_GetTsprite(iActor, lLabelID));
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETANGLETOTARGET:
+        VM_CASE(CON_GETANGLETOTARGET):
             insptr++;
             // Actor[vm.g_i].lastvx and lastvy are last known location of target.
             Gv_SetVarX(*insptr++, getangle(actor[vm.g_i].lastvx-vm.g_sp->x,actor[vm.g_i].lastvy-vm.g_sp->y));
-            continue;
+            VM_NEXT;
 
-        case CON_ANGOFFVAR:
+        VM_CASE(CON_ANGOFFVAR):
             insptr++;
             spriteext[vm.g_i].angoff = Gv_GetVarX(*insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_LOCKPLAYER:
+        VM_CASE(CON_LOCKPLAYER):
             insptr++;
             ps->transporter_hold = Gv_GetVarX(*insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_CHECKAVAILWEAPON:
+        VM_CASE(CON_CHECKAVAILWEAPON):
             insptr++;
             tw = (*insptr != g_iThisActorID) ? Gv_GetVarX(*insptr) : vm.g_p;
             insptr++;
@@ -4476,13 +4664,13 @@ finish_qsprintf:
             if (EDUKE32_PREDICT_FALSE((unsigned)tw >= (unsigned)playerswhenstarted))
             {
                 CON_ERRPRINTF("Invalid player ID %d\n", tw);
-                continue;
+                VM_NEXT;
             }
 
             P_CheckWeapon(g_player[tw].ps);
-            continue;
+            VM_NEXT;
 
-        case CON_CHECKAVAILINVEN:
+        VM_CASE(CON_CHECKAVAILINVEN):
             insptr++;
             tw = (*insptr != g_iThisActorID) ? Gv_GetVarX(*insptr) : vm.g_p;
             insptr++;
@@ -4490,50 +4678,50 @@ finish_qsprintf:
             if (EDUKE32_PREDICT_FALSE((unsigned)tw >= (unsigned)playerswhenstarted))
             {
                 CON_ERRPRINTF("Invalid player ID %d\n", tw);
-                continue;
+                VM_NEXT;
             }
 
             P_SelectNextInvItem(g_player[tw].ps);
-            continue;
+            VM_NEXT;
 
-        case CON_GETPLAYERANGLE:
+        VM_CASE(CON_GETPLAYERANGLE):
             insptr++;
             Gv_SetVarX(*insptr++, ps->ang);
-            continue;
+            VM_NEXT;
 
-        case CON_GETACTORANGLE:
+        VM_CASE(CON_GETACTORANGLE):
             insptr++;
             Gv_SetVarX(*insptr++, vm.g_sp->ang);
-            continue;
+            VM_NEXT;
 
-        case CON_SETPLAYERANGLE:
+        VM_CASE(CON_SETPLAYERANGLE):
             insptr++;
             ps->ang = Gv_GetVarX(*insptr++) & 2047;
-            continue;
+            VM_NEXT;
 
-        case CON_SETACTORANGLE:
+        VM_CASE(CON_SETACTORANGLE):
             insptr++;
             vm.g_sp->ang = Gv_GetVarX(*insptr++) & 2047;
-            continue;
+            VM_NEXT;
 
-        case CON_SETVAR:
+        VM_CASE(CON_SETVAR):
             insptr++;
             if ((aGameVars[*insptr].dwFlags & (GAMEVAR_USER_MASK | GAMEVAR_PTR_MASK)) == 0)
                 aGameVars[*insptr].val.lValue = *(insptr + 1);
             else
                 Gv_SetVarX(*insptr, *(insptr + 1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_KLABS:
+        VM_CASE(CON_KLABS):
             if ((aGameVars[*(insptr + 1)].dwFlags & (GAMEVAR_USER_MASK | GAMEVAR_PTR_MASK)) == 0)
                 aGameVars[*(insptr + 1)].val.lValue = klabs(aGameVars[*(insptr + 1)].val.lValue);
             else
                 Gv_SetVarX(*(insptr + 1), klabs(Gv_GetVarX(*(insptr + 1))));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_SETARRAY:
+        VM_CASE(CON_SETARRAY):
             insptr++;
             {
                 tw=*insptr++;
@@ -4544,18 +4732,18 @@ finish_qsprintf:
                 {
                     OSD_Printf(OSD_ERROR "Gv_SetVar(): tried to set invalid array ID (%d) or index out of bounds from sprite %d (%d), player %d\n",
                         tw,vm.g_i,TrackerCast(sprite[vm.g_i].picnum),vm.g_p);
-                    continue;
+                    VM_NEXT;
                 }
                 if (EDUKE32_PREDICT_FALSE(aGameArrays[tw].dwFlags & GAMEARRAY_READONLY))
                 {
                     OSD_Printf("Tried to set on read-only array `%s'", aGameArrays[tw].szLabel);
-                    continue;
+                    VM_NEXT;
                 }
                 aGameArrays[tw].plValues[index]=value;
-                continue;
+                VM_NEXT;
             }
-        case CON_WRITEARRAYTOFILE:
-        case CON_READARRAYFROMFILE:
+        VM_CASE(CON_WRITEARRAYTOFILE):
+        VM_CASE(CON_READARRAYFROMFILE):
             insptr++;
             {
                 const int32_t j=*insptr++;
@@ -4564,7 +4752,7 @@ finish_qsprintf:
                 if (EDUKE32_PREDICT_FALSE(ScriptQuotes[q] == NULL))
                 {
                     CON_ERRPRINTF("null quote %d\n", q);
-                    continue;
+                    VM_NEXT;
                 }
 
                 if (tw == CON_READARRAYFROMFILE)
@@ -4572,7 +4760,7 @@ finish_qsprintf:
                     int32_t fil = kopen4loadfrommod(ScriptQuotes[q], 0);
 
                     if (fil < 0)
-                        continue;
+                        VM_NEXT;
 
                     int32_t numelts = kfilelength(fil) / sizeof(int32_t);
 
@@ -4602,7 +4790,7 @@ finish_qsprintf:
                     }
 
                     kclose(fil);
-                    continue;
+                    VM_NEXT;
                 }
 
                 char temp[BMAX_PATH];
@@ -4610,7 +4798,7 @@ finish_qsprintf:
                 if (EDUKE32_PREDICT_FALSE(G_ModDirSnprintf(temp, sizeof(temp), "%s", ScriptQuotes[q])))
                 {
                     CON_ERRPRINTF("file name too long\n");
-                    continue;
+                    VM_NEXT;
                 }
 
                 FILE *const fil = fopen(temp, "wb");
@@ -4618,7 +4806,7 @@ finish_qsprintf:
                 if (EDUKE32_PREDICT_FALSE(fil == NULL))
                 {
                     CON_ERRPRINTF("couldn't open file \"%s\"\n", temp);
-                    continue;
+                    VM_NEXT;
                 }
 
                 const int32_t n = aGameArrays[j].size;
@@ -4628,17 +4816,17 @@ finish_qsprintf:
                 Bfree(array);
                 fclose(fil);
 
-                continue;
+                VM_NEXT;
             }
 
-        case CON_GETARRAYSIZE:
+        VM_CASE(CON_GETARRAYSIZE):
             insptr++;
             tw = *insptr++;
             Gv_SetVarX(*insptr++,(aGameArrays[tw].dwFlags & GAMEARRAY_VARSIZE) ?
                        Gv_GetVarX(aGameArrays[tw].size) : aGameArrays[tw].size);
-            continue;
+            VM_NEXT;
 
-        case CON_RESIZEARRAY:
+        VM_CASE(CON_RESIZEARRAY):
             insptr++;
             {
                 tw=*insptr++;
@@ -4662,10 +4850,10 @@ finish_qsprintf:
                     if (newSize > oldSize)
                         memset(&aGameArrays[tw].plValues[oldSize], 0, GAR_ELTSZ * (newSize - oldSize));
                 }
-                continue;
+                VM_NEXT;
             }
 
-        case CON_COPY:
+        VM_CASE(CON_COPY):
             insptr++;
             {
                 int const si = *insptr++;
@@ -4692,7 +4880,7 @@ finish_qsprintf:
                     tw = 1;
                 }
 
-                if (EDUKE32_PREDICT_FALSE(tw)) continue; // dirty replacement for VMFLAG_ERROR
+                if (EDUKE32_PREDICT_FALSE(tw)) VM_NEXT; // dirty replacement for VMFLAG_ERROR
 
                 int const ssiz =
                 (aGameArrays[si].dwFlags & GAMEARRAY_VARSIZE) ? Gv_GetVarX(aGameArrays[si].size) : aGameArrays[si].size;
@@ -4700,7 +4888,7 @@ finish_qsprintf:
                 (aGameArrays[di].dwFlags & GAMEARRAY_VARSIZE) ? Gv_GetVarX(aGameArrays[si].size) : aGameArrays[di].size;
 
                 if (EDUKE32_PREDICT_FALSE(sidx > ssiz || didx > dsiz))
-                    continue;
+                    VM_NEXT;
                 if ((sidx + numelts) > ssiz)
                     numelts = ssiz - sidx;
                 if ((didx + numelts) > dsiz)
@@ -4755,79 +4943,79 @@ finish_qsprintf:
                         (aGameArrays[di].plValues)[didx++] = ((uint8_t *)aGameArrays[si].plValues)[sidx++];
                     break;
                 }
-                continue;
+                VM_NEXT;
             }
 
-        case CON_RANDVAR:
+        VM_CASE(CON_RANDVAR):
             insptr++;
             Gv_SetVarX(*insptr, mulscale16(krand(), *(insptr + 1) + 1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_DISPLAYRANDVAR:
+        VM_CASE(CON_DISPLAYRANDVAR):
             insptr++;
             Gv_SetVarX(*insptr, mulscale15(system_15bit_rand(), *(insptr + 1) + 1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_INV:
+        VM_CASE(CON_INV):
             if ((aGameVars[*(insptr + 1)].dwFlags & (GAMEVAR_USER_MASK | GAMEVAR_PTR_MASK)) == 0)
                 aGameVars[*(insptr + 1)].val.lValue = -aGameVars[*(insptr + 1)].val.lValue;
             else
                 Gv_SetVarX(*(insptr + 1), -Gv_GetVarX(*(insptr + 1)));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_MULVAR:
+        VM_CASE(CON_MULVAR):
             insptr++;
             Gv_MulVar(*insptr, *(insptr + 1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_DIVVAR:
+        VM_CASE(CON_DIVVAR):
             insptr++;
             if (EDUKE32_PREDICT_FALSE(*(insptr + 1) == 0))
             {
                 CON_ERRPRINTF("divide by zero!\n");
                 insptr += 2;
-                continue;
+                VM_NEXT;
             }
             Gv_DivVar(*insptr, *(insptr + 1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_MODVAR:
+        VM_CASE(CON_MODVAR):
             insptr++;
             if (EDUKE32_PREDICT_FALSE(*(insptr + 1) == 0))
             {
                 CON_ERRPRINTF("mod by zero!\n");
                 insptr += 2;
-                continue;
+                VM_NEXT;
             }
 
             Gv_ModVar(*insptr, *(insptr + 1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_ANDVAR:
+        VM_CASE(CON_ANDVAR):
             insptr++;
             Gv_AndVar(*insptr, *(insptr + 1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_ORVAR:
+        VM_CASE(CON_ORVAR):
             insptr++;
             Gv_OrVar(*insptr, *(insptr + 1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_XORVAR:
+        VM_CASE(CON_XORVAR):
             insptr++;
             Gv_XorVar(*insptr, *(insptr + 1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_SETVARVAR:
+        VM_CASE(CON_SETVARVAR):
             insptr++;
             {
                 tw = *insptr++;
@@ -4838,51 +5026,51 @@ finish_qsprintf:
                 else
                     Gv_SetVarX(tw, gv);
             }
-            continue;
+            VM_NEXT;
 
-        case CON_RANDVARVAR:
+        VM_CASE(CON_RANDVARVAR):
             insptr++;
             tw = *insptr++;
             Gv_SetVarX(tw, mulscale16(krand(), Gv_GetVarX(*insptr++) + 1));
-            continue;
+            VM_NEXT;
 
-        case CON_DISPLAYRANDVARVAR:
+        VM_CASE(CON_DISPLAYRANDVARVAR):
             insptr++;
             tw = *insptr++;
             Gv_SetVarX(tw, mulscale15(system_15bit_rand(), Gv_GetVarX(*insptr++) + 1));
-            continue;
+            VM_NEXT;
 
-        case CON_GMAXAMMO:
+        VM_CASE(CON_GMAXAMMO):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             if (EDUKE32_PREDICT_FALSE((unsigned)tw >= MAX_WEAPONS))
             {
                 CON_ERRPRINTF("Invalid weapon ID %d\n", tw);
                 insptr++;
-                continue;
+                VM_NEXT;
             }
             Gv_SetVarX(*insptr++, ps->max_ammo_amount[tw]);
-            continue;
+            VM_NEXT;
 
-        case CON_SMAXAMMO:
+        VM_CASE(CON_SMAXAMMO):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             if (EDUKE32_PREDICT_FALSE((unsigned)tw >= MAX_WEAPONS))
             {
                 CON_ERRPRINTF("Invalid weapon ID %d\n", tw);
                 insptr++;
-                continue;
+                VM_NEXT;
             }
             ps->max_ammo_amount[tw] = Gv_GetVarX(*insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_MULVARVAR:
+        VM_CASE(CON_MULVARVAR):
             insptr++;
             tw = *insptr++;
             Gv_MulVar(tw, Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_DIVVARVAR:
+        VM_CASE(CON_DIVVARVAR):
             insptr++;
             {
                 tw=*insptr++;
@@ -4891,14 +5079,14 @@ finish_qsprintf:
                 if (EDUKE32_PREDICT_FALSE(!l2))
                 {
                     CON_ERRPRINTF("divide by zero!\n");
-                    continue;
+                    VM_NEXT;
                 }
 
                 Gv_DivVar(tw, l2);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_MODVARVAR:
+        VM_CASE(CON_MODVARVAR):
             insptr++;
             {
                 tw=*insptr++;
@@ -4907,131 +5095,131 @@ finish_qsprintf:
                 if (EDUKE32_PREDICT_FALSE(!l2))
                 {
                     CON_ERRPRINTF("mod by zero!\n");
-                    continue;
+                    VM_NEXT;
                 }
 
 
                 Gv_ModVar(tw, l2);
-                continue;
+                VM_NEXT;
             }
 
-        case CON_ANDVARVAR:
+        VM_CASE(CON_ANDVARVAR):
             insptr++;
             tw = *insptr++;
             Gv_AndVar(tw, Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_XORVARVAR:
+        VM_CASE(CON_XORVARVAR):
             insptr++;
             tw = *insptr++;
             Gv_XorVar(tw, Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_ORVARVAR:
+        VM_CASE(CON_ORVARVAR):
             insptr++;
             tw = *insptr++;
             Gv_OrVar(tw, Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_SUBVAR:
+        VM_CASE(CON_SUBVAR):
             insptr++;
             Gv_SubVar(*insptr, *(insptr+1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_SUBVARVAR:
+        VM_CASE(CON_SUBVARVAR):
             insptr++;
             tw = *insptr++;
             Gv_SubVar(tw, Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_ADDVAR:
+        VM_CASE(CON_ADDVAR):
             insptr++;
             Gv_AddVar(*insptr, *(insptr+1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_SHIFTVARL:
+        VM_CASE(CON_SHIFTVARL):
             insptr++;
             if ((aGameVars[*insptr].dwFlags & (GAMEVAR_USER_MASK|GAMEVAR_PTR_MASK)) == 0)
             {
                 aGameVars[*insptr].val.lValue <<= *(insptr+1);
                 insptr += 2;
-                continue;
+                VM_NEXT;
             }
             Gv_SetVarX(*insptr, Gv_GetVarX(*insptr) << *(insptr+1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_SHIFTVARR:
+        VM_CASE(CON_SHIFTVARR):
             insptr++;
             if ((aGameVars[*insptr].dwFlags & (GAMEVAR_USER_MASK|GAMEVAR_PTR_MASK)) == 0)
             {
                 aGameVars[*insptr].val.lValue >>= *(insptr+1);
                 insptr += 2;
-                continue;
+                VM_NEXT;
             }
             Gv_SetVarX(*insptr, Gv_GetVarX(*insptr) >> *(insptr+1));
             insptr += 2;
-            continue;
+            VM_NEXT;
 
-        case CON_SHIFTVARVARL:
+        VM_CASE(CON_SHIFTVARVARL):
             insptr++;
             tw = *insptr++;
             Gv_SetVarX(tw, Gv_GetVarX(tw) << Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_SHIFTVARVARR:
+        VM_CASE(CON_SHIFTVARVARR):
             insptr++;
             tw = *insptr++;
             Gv_SetVarX(tw, Gv_GetVarX(tw) >> Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_SIN:
+        VM_CASE(CON_SIN):
             insptr++;
             tw = *insptr++;
             Gv_SetVarX(tw, sintable[Gv_GetVarX(*insptr++)&2047]);
-            continue;
+            VM_NEXT;
 
-        case CON_COS:
+        VM_CASE(CON_COS):
             insptr++;
             tw = *insptr++;
             Gv_SetVarX(tw, sintable[(Gv_GetVarX(*insptr++)+512)&2047]);
-            continue;
+            VM_NEXT;
 
-        case CON_ADDVARVAR:
+        VM_CASE(CON_ADDVARVAR):
             insptr++;
             tw = *insptr++;
             Gv_AddVar(tw, Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_SPGETLOTAG:
+        VM_CASE(CON_SPGETLOTAG):
             insptr++;
             aGameVars[g_iLoTagID].val.lValue = vm.g_sp->lotag;
-            continue;
+            VM_NEXT;
 
-        case CON_SPGETHITAG:
+        VM_CASE(CON_SPGETHITAG):
             insptr++;
             aGameVars[g_iHiTagID].val.lValue = vm.g_sp->hitag;
-            continue;
+            VM_NEXT;
 
-        case CON_SECTGETLOTAG:
+        VM_CASE(CON_SECTGETLOTAG):
             insptr++;
             aGameVars[g_iLoTagID].val.lValue = sector[vm.g_sp->sectnum].lotag;
-            continue;
+            VM_NEXT;
 
-        case CON_SECTGETHITAG:
+        VM_CASE(CON_SECTGETHITAG):
             insptr++;
             aGameVars[g_iHiTagID].val.lValue = sector[vm.g_sp->sectnum].hitag;
-            continue;
+            VM_NEXT;
 
-        case CON_GETTEXTUREFLOOR:
+        VM_CASE(CON_GETTEXTUREFLOOR):
             insptr++;
             aGameVars[g_iTextureID].val.lValue = sector[vm.g_sp->sectnum].floorpicnum;
-            continue;
+            VM_NEXT;
 
-        case CON_STARTTRACK:
-        case CON_STARTTRACKVAR:
+        VM_CASE(CON_STARTTRACK):
+        VM_CASE(CON_STARTTRACKVAR):
             insptr++;
             {
                 int32_t const level = (tw == CON_STARTTRACK) ? *(insptr++) :
@@ -5041,134 +5229,134 @@ finish_qsprintf:
                     CON_ERRPRINTF("invalid level %d or null music for volume %d level %d\n",
                                   level, ud.volume_number, level);
             }
-            continue;
+            VM_NEXT;
 
-        case CON_SETMUSICPOSITION:
+        VM_CASE(CON_SETMUSICPOSITION):
             insptr++;
             S_SetMusicPosition(Gv_GetVarX(*insptr++));
-            continue;
+            VM_NEXT;
 
-        case CON_GETMUSICPOSITION:
+        VM_CASE(CON_GETMUSICPOSITION):
             insptr++;
             Gv_SetVarX(*insptr++, S_GetMusicPosition());
-            continue;
+            VM_NEXT;
 
-        case CON_ACTIVATECHEAT:
+        VM_CASE(CON_ACTIVATECHEAT):
             insptr++;
             tw = Gv_GetVarX(*(insptr++));
             if (EDUKE32_PREDICT_FALSE(numplayers != 1 || !(g_player[myconnectindex].ps->gm & MODE_GAME)))
             {
                 CON_ERRPRINTF("not in a single-player game.\n");
-                continue;
+                VM_NEXT;
             }
             osdcmd_cheatsinfo_stat.cheatnum = tw;
-            continue;
+            VM_NEXT;
 
-        case CON_SETGAMEPALETTE:
+        VM_CASE(CON_SETGAMEPALETTE):
             insptr++;
             P_SetGamePalette(ps, Gv_GetVarX(*(insptr++)), 2+16);
-            continue;
+            VM_NEXT;
 
-        case CON_GETTEXTURECEILING:
+        VM_CASE(CON_GETTEXTURECEILING):
             insptr++;
             aGameVars[g_iTextureID].val.lValue = sector[vm.g_sp->sectnum].ceilingpicnum;
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVARAND:
+        VM_CASE(CON_IFVARVARAND):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw &= Gv_GetVarX(*insptr++);
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVAROR:
+        VM_CASE(CON_IFVARVAROR):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw |= Gv_GetVarX(*insptr++);
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVARXOR:
+        VM_CASE(CON_IFVARVARXOR):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw ^= Gv_GetVarX(*insptr++);
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVAREITHER:
+        VM_CASE(CON_IFVARVAREITHER):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw = (Gv_GetVarX(*insptr++) || tw);
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVARBOTH:
+        VM_CASE(CON_IFVARVARBOTH):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw = (Gv_GetVarX(*insptr++) && tw);
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVARN:
+        VM_CASE(CON_IFVARVARN):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw = (tw != Gv_GetVarX(*insptr++));
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVARE:
+        VM_CASE(CON_IFVARVARE):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw = (tw == Gv_GetVarX(*insptr++));
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVARG:
+        VM_CASE(CON_IFVARVARG):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw = (tw > Gv_GetVarX(*insptr++));
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVARGE:
+        VM_CASE(CON_IFVARVARGE):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw = (tw >= Gv_GetVarX(*insptr++));
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVARL:
+        VM_CASE(CON_IFVARVARL):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw = (tw < Gv_GetVarX(*insptr++));
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARVARLE:
+        VM_CASE(CON_IFVARVARLE):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             tw = (tw <= Gv_GetVarX(*insptr++));
             insptr--;
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARN:
+        VM_CASE(CON_IFVARN):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw != *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_WHILEVARN:
+        VM_CASE(CON_WHILEVARN):
         {
             intptr_t const *const savedinsptr = insptr + 2;
             do
@@ -5178,10 +5366,10 @@ finish_qsprintf:
                 VM_CONDITIONAL(tw);
             }
             while (tw);
-            continue;
+            VM_NEXT;
         }
 
-        case CON_WHILEVARL:
+        VM_CASE(CON_WHILEVARL):
         {
             intptr_t const *const savedinsptr = insptr + 2;
             do
@@ -5190,10 +5378,10 @@ finish_qsprintf:
                 tw = (Gv_GetVarX(*(insptr - 1)) < *insptr);
                 VM_CONDITIONAL(tw);
             } while (tw);
-            continue;
+            VM_NEXT;
         }
 
-        case CON_WHILEVARVARN:
+        VM_CASE(CON_WHILEVARVARN):
         {
             intptr_t const *const savedinsptr = insptr + 2;
             do
@@ -5205,10 +5393,10 @@ finish_qsprintf:
                 VM_CONDITIONAL(tw);
             }
             while (tw);
-            continue;
+            VM_NEXT;
         }
 
-        case CON_WHILEVARVARL:
+        VM_CASE(CON_WHILEVARVARL):
         {
             intptr_t const *const savedinsptr = insptr + 2;
             do
@@ -5219,10 +5407,10 @@ finish_qsprintf:
                 insptr--;
                 VM_CONDITIONAL(tw);
             } while (tw);
-            continue;
+            VM_NEXT;
         }
 
-        case CON_FOR:  // special-purpose iteration
+        VM_CASE(CON_FOR):  // special-purpose iteration
             insptr++;
             {
                 const int32_t var = *insptr++, how = *insptr++;
@@ -5357,76 +5545,76 @@ finish_qsprintf:
                     break;
                 default:
                     CON_ERRPRINTF("Unknown iteration type %d!", how);
-                    continue;
+                    VM_NEXT;
                 badindex:
                     OSD_Printf(OSD_ERROR "Line %d, %s %s: index %d out of range!\n", g_errorLineNum, keyw[g_tw],
                         iter_tokens[how].token, parm2);
-                    continue;
+                    VM_NEXT;
                 }
                 insptr = end;
             }
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARAND:
+        VM_CASE(CON_IFVARAND):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw & *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVAROR:
+        VM_CASE(CON_IFVAROR):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw | *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARXOR:
+        VM_CASE(CON_IFVARXOR):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw ^ *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVAREITHER:
+        VM_CASE(CON_IFVAREITHER):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw || *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARBOTH:
+        VM_CASE(CON_IFVARBOTH):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw && *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARG:
+        VM_CASE(CON_IFVARG):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw > *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARGE:
+        VM_CASE(CON_IFVARGE):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw >= *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARL:
+        VM_CASE(CON_IFVARL):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw < *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFVARLE:
+        VM_CASE(CON_IFVARLE):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             VM_CONDITIONAL(tw <= *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFPHEALTHL:
+        VM_CASE(CON_IFPHEALTHL):
             insptr++;
             VM_CONDITIONAL(sprite[ps->i].extra < *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFPINVENTORY:
+        VM_CASE(CON_IFPINVENTORY):
             insptr++;
 
             switch (*insptr++)
@@ -5451,9 +5639,9 @@ finish_qsprintf:
             }
 
             VM_CONDITIONAL(tw);
-            continue;
+            VM_NEXT;
 
-        case CON_PSTOMP:
+        VM_CASE(CON_PSTOMP):
             insptr++;
             if (ps->knee_incs == 0 && sprite[ps->i].xrepeat >= 40)
                 if (cansee(vm.g_sp->x, vm.g_sp->y, vm.g_sp->z - (4 << 8), vm.g_sp->sectnum, ps->pos.x,
@@ -5476,9 +5664,9 @@ finish_qsprintf:
                     }
                 }
 
-            continue;
+            VM_NEXT;
 
-        case CON_IFAWAYFROMWALL:
+        VM_CASE(CON_IFAWAYFROMWALL):
         {
             int16_t s1 = vm.g_sp->sectnum;
             tw = 0;
@@ -5506,63 +5694,63 @@ finish_qsprintf:
 #undef IFAWAYDIST
 
         }
-        continue;
+        VM_NEXT;
 
-        case CON_QUOTE:
+        VM_CASE(CON_QUOTE):
             insptr++;
 
             if (EDUKE32_PREDICT_FALSE((unsigned)(*insptr) >= MAXQUOTES) || ScriptQuotes[*insptr] == NULL)
             {
                 CON_ERRPRINTF("invalid quote ID %d\n", (int32_t)(*insptr));
                 insptr++;
-                continue;
+                VM_NEXT;
             }
 
             if (EDUKE32_PREDICT_FALSE((unsigned)vm.g_p >= MAXPLAYERS))
             {
                 CON_ERRPRINTF("bad player for quote %d: (%d)\n", (int32_t)*insptr,vm.g_p);
                 insptr++;
-                continue;
+                VM_NEXT;
             }
 
             P_DoQuote(*(insptr++)|MAXQUOTES,ps);
-            continue;
+            VM_NEXT;
 
-        case CON_USERQUOTE:
+        VM_CASE(CON_USERQUOTE):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
 
             if (EDUKE32_PREDICT_FALSE((unsigned)tw >= MAXQUOTES || ScriptQuotes[tw] == NULL))
             {
                 CON_ERRPRINTF("invalid quote ID %d\n", tw);
-                continue;
+                VM_NEXT;
             }
 
             G_AddUserQuote(ScriptQuotes[tw]);
-            continue;
+            VM_NEXT;
 
-        case CON_ECHO:
+        VM_CASE(CON_ECHO):
             insptr++;
             tw = Gv_GetVarX(*insptr++);
 
             if (EDUKE32_PREDICT_FALSE((unsigned)tw >= MAXQUOTES || ScriptQuotes[tw] == NULL))
             {
                 CON_ERRPRINTF("invalid quote ID %d\n", tw);
-                continue;
+                VM_NEXT;
             }
 
             OSD_Printf("%s\n", ScriptQuotes[tw]);
-            continue;
+            VM_NEXT;
 
-        case CON_IFINOUTERSPACE:
+        VM_CASE(CON_IFINOUTERSPACE):
             VM_CONDITIONAL(G_CheckForSpaceFloor(vm.g_sp->sectnum));
-            continue;
+            VM_NEXT;
 
-        case CON_IFNOTMOVING:
+        VM_CASE(CON_IFNOTMOVING):
             VM_CONDITIONAL((actor[vm.g_i].movflag&49152) > 16384);
-            continue;
+            VM_NEXT;
 
-        case CON_RESPAWNHITAG:
+        VM_CASE(CON_RESPAWNHITAG):
             insptr++;
             switch (DYNAMICTILEMAP(vm.g_sp->picnum))
             {
@@ -5587,44 +5775,187 @@ finish_qsprintf:
                     G_OperateRespawns(vm.g_sp->hitag);
                 break;
             }
-            continue;
+            VM_NEXT;
 
-        case CON_IFSPRITEPAL:
+        VM_CASE(CON_IFSPRITEPAL):
             insptr++;
             VM_CONDITIONAL(vm.g_sp->pal == *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFANGDIFFL:
+        VM_CASE(CON_IFANGDIFFL):
             insptr++;
             tw = klabs(G_GetAngleDelta(ps->ang, vm.g_sp->ang));
             VM_CONDITIONAL(tw <= *insptr);
-            continue;
+            VM_NEXT;
 
-        case CON_IFNOSOUNDS:
+        VM_CASE(CON_IFNOSOUNDS):
             VM_CONDITIONAL(!A_CheckAnySoundPlaying(vm.g_i));
-            continue;
+            VM_NEXT;
 
-        case CON_SPRITEFLAGS:
+        VM_CASE(CON_SPRITEFLAGS):
             insptr++;
             actor[vm.g_i].flags = Gv_GetVarX(*insptr++);
-            continue;
+            VM_NEXT;
 
-        case CON_GETTICKS:
+        VM_CASE(CON_GETTICKS):
             insptr++;
             Gv_SetVarX(*insptr++, getticks());
-            continue;
+            VM_NEXT;
 
-        case CON_GETCURRADDRESS:
+        VM_CASE(CON_GETCURRADDRESS):
             insptr++;
             tw = *insptr++;
             Gv_SetVarX(tw, (intptr_t)(insptr - script));
-            continue;
+            VM_NEXT;
 
-        case CON_JUMP:  // XXX XXX XXX
+        VM_CASE(CON_JUMP):  // XXX XXX XXX
             insptr++;
             tw = Gv_GetVarX(*insptr++);
             insptr = (intptr_t *)(tw + script);
-            continue;
+            VM_NEXT;
+
+        // CON_OPT_*: written over the compiled script by C_OptimizeScript, same layout as what they replace
+
+        VM_CASE(CON_OPT_IFGVARE):
+            tw = aGameVars[insptr[1]].val.lValue;
+            insptr += 2;
+            VM_CONDITIONAL(tw == *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFGVARN):
+            tw = aGameVars[insptr[1]].val.lValue;
+            insptr += 2;
+            VM_CONDITIONAL(tw != *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFGVARL):
+            tw = aGameVars[insptr[1]].val.lValue;
+            insptr += 2;
+            VM_CONDITIONAL(tw < *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFGVARG):
+            tw = aGameVars[insptr[1]].val.lValue;
+            insptr += 2;
+            VM_CONDITIONAL(tw > *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFGVARAND):
+            tw = aGameVars[insptr[1]].val.lValue;
+            insptr += 2;
+            VM_CONDITIONAL(tw & *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_SETGVAR):
+            aGameVars[insptr[1]].val.lValue = insptr[2];
+            insptr += 3;
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_ADDGVAR):
+            aGameVars[insptr[1]].val.lValue += (int32_t)insptr[2];
+            insptr += 3;
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFAVARE):
+            tw = aGameVars[insptr[1]].val.plValues[vm.g_i];
+            insptr += 2;
+            VM_CONDITIONAL(tw == *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFAVARN):
+            tw = aGameVars[insptr[1]].val.plValues[vm.g_i];
+            insptr += 2;
+            VM_CONDITIONAL(tw != *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFAVARL):
+            tw = aGameVars[insptr[1]].val.plValues[vm.g_i];
+            insptr += 2;
+            VM_CONDITIONAL(tw < *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFAVARG):
+            tw = aGameVars[insptr[1]].val.plValues[vm.g_i];
+            insptr += 2;
+            VM_CONDITIONAL(tw > *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFAVARAND):
+            tw = aGameVars[insptr[1]].val.plValues[vm.g_i];
+            insptr += 2;
+            VM_CONDITIONAL(tw & *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_SETAVAR):
+            if (EDUKE32_PREDICT_TRUE((unsigned)vm.g_i < MAXSPRITES))
+                aGameVars[insptr[1]].val.plValues[vm.g_i] = (int32_t)insptr[2];
+            else
+                Gv_SetVarX(insptr[1], (int32_t)insptr[2]);
+            insptr += 3;
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_ADDAVAR):
+            if (EDUKE32_PREDICT_TRUE((unsigned)vm.g_i < MAXSPRITES))
+                aGameVars[insptr[1]].val.plValues[vm.g_i] += (int32_t)insptr[2];
+            insptr += 3;
+            VM_NEXT;
+
+        // the second if is the whole body of the first, so it's tested here instead of in a recursive VM_Execute
+        VM_CASE(CON_OPT_IFACTION_IFACTIONCOUNT):
+            insptr++;
+            if (AC_ACTION_ID(vm.g_t) != *insptr)
+            {
+                VM_CONDITIONAL(0);
+                VM_NEXT;
+            }
+            insptr += 3;
+            VM_CONDITIONAL(AC_ACTION_COUNT(vm.g_t) >= *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFACTION_IFCOUNT):
+            insptr++;
+            if (AC_ACTION_ID(vm.g_t) != *insptr)
+            {
+                VM_CONDITIONAL(0);
+                VM_NEXT;
+            }
+            insptr += 3;
+            VM_CONDITIONAL(AC_COUNT(vm.g_t) >= *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFAI_IFCOUNT):
+            insptr++;
+            if (AC_AI_ID(vm.g_t) != *insptr)
+            {
+                VM_CONDITIONAL(0);
+                VM_NEXT;
+            }
+            insptr += 3;
+            VM_CONDITIONAL(AC_COUNT(vm.g_t) >= *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_IFMOVE_IFCOUNT):
+            insptr++;
+            if (AC_MOVE_ID(vm.g_t) != *insptr)
+            {
+                VM_CONDITIONAL(0);
+                VM_NEXT;
+            }
+            insptr += 3;
+            VM_CONDITIONAL(AC_COUNT(vm.g_t) >= *insptr);
+            VM_NEXT;
+
+        VM_CASE(CON_OPT_ACTORADD):
+            {
+                int const lLabelID = insptr[2];
+                int const lVar = insptr[3];
+
+                Gv_SetVarX(lVar, VM_GetSprite(vm.g_i, lLabelID, 0));
+                Gv_AddVar(lVar, (int32_t)insptr[6]);
+                VM_SetSprite(vm.g_i, lLabelID, 0, Gv_GetVarX(lVar));
+                insptr += 11;
+                VM_NEXT;
+            }
 
         default:
             VM_ScriptInfo(insptr, 64);
@@ -5638,6 +5969,11 @@ finish_qsprintf:
             break;
         }
     }
+
+#ifdef VM_COMPUTED_GOTO
+vm_done:
+#endif
+    g_vmInstructions += numinstructions;
 }
 
 // NORECURSE
@@ -5672,14 +6008,14 @@ void A_LoadActor(int32_t iActor)
 #endif
 
 // NORECURSE
-void A_Execute(int32_t iActor, int32_t iPlayer, int32_t lDist)
+//
+// A_ExecuteBegin
+//
+// The part of A_Execute before the actor's script runs, returns 0 if the sprite had to be deleted.
+//
+int32_t A_ExecuteBegin(vmstate_t *ctx)
 {
-    vmstate_t tempvm = { iActor, iPlayer, lDist, &actor[iActor].t_data[0], &sprite[iActor], g_player[iPlayer].ps, 0 };
-    vm = tempvm;
-
-#ifdef LUNATIC
-    int32_t killit=0;
-#else
+#if !defined LUNATIC
     intptr_t actionofs, *actionptr;
 #endif
 
@@ -5694,17 +6030,17 @@ void A_Execute(int32_t iActor, int32_t iPlayer, int32_t lDist)
     if (g_netServer || g_netClient)
         randomseed = ticrandomseed;
 
-    if (EDUKE32_PREDICT_FALSE((unsigned)vm.g_sp->sectnum >= MAXSECTORS))
+    if (EDUKE32_PREDICT_FALSE((unsigned)ctx->g_sp->sectnum >= MAXSECTORS))
     {
-        if (A_CheckEnemySprite(vm.g_sp))
-            vm.g_pp->actors_killed++;
+        if (A_CheckEnemySprite(ctx->g_sp))
+            ctx->g_pp->actors_killed++;
 
-        A_DeleteSprite(vm.g_i);
-        return;
+        A_DeleteSprite(ctx->g_i);
+        return 0;
     }
 
 #if !defined LUNATIC
-    actionofs = AC_ACTION_ID(vm.g_t);
+    actionofs = AC_ACTION_ID(ctx->g_t);
     actionptr = (actionofs != 0 && actionofs + 4u < (unsigned)g_scriptSize) ? &script[actionofs] : NULL;
 
     if (actionptr != NULL)
@@ -5715,32 +6051,46 @@ void A_Execute(int32_t iActor, int32_t iPlayer, int32_t lDist)
         const int32_t action_incval = actionptr[3];
         const int32_t action_delay = actionptr[4];
 #else
-        const int32_t action_frames = actor[vm.g_i].ac.numframes;
-        const int32_t action_incval = actor[vm.g_i].ac.incval;
-        const int32_t action_delay = actor[vm.g_i].ac.delay;
+        const int32_t action_frames = actor[ctx->g_i].ac.numframes;
+        const int32_t action_incval = actor[ctx->g_i].ac.incval;
+        const int32_t action_delay = actor[ctx->g_i].ac.delay;
 #endif
-        uint16_t *actionticsptr = &AC_ACTIONTICS(vm.g_sp, &actor[vm.g_i]);
+        uint16_t *actionticsptr = &AC_ACTIONTICS(ctx->g_sp, &actor[ctx->g_i]);
         *actionticsptr += TICSPERFRAME;
 
         if (*actionticsptr > action_delay)
         {
             *actionticsptr = 0;
-            AC_ACTION_COUNT(vm.g_t)++;
-            AC_CURFRAME(vm.g_t) += action_incval;
+            AC_ACTION_COUNT(ctx->g_t)++;
+            AC_CURFRAME(ctx->g_t) += action_incval;
         }
 
-        if (klabs(AC_CURFRAME(vm.g_t)) >= klabs(action_frames * action_incval))
-            AC_CURFRAME(vm.g_t) = 0;
+        if (klabs(AC_CURFRAME(ctx->g_t)) >= klabs(action_frames * action_incval))
+            AC_CURFRAME(ctx->g_t) = 0;
     }
 
+    return 1;
+}
+
+//
+// A_ExecuteScript
+//
+// Runs the actor's script with ctx as the interpreter state of the calling thread and stores the final
+// state back into ctx. Returns nonzero if the script killed the actor.
+//
+int32_t A_ExecuteScript(vmstate_t *ctx)
+{
+    vm = *ctx;
+
 #ifdef LUNATIC
+    int32_t killit=0;
     const int32_t picnum = vm.g_sp->picnum;
 
     if (L_IsInitialized(&g_ElState) && El_HaveActor(picnum))
     {
         double t = gethiticks();
 
-        killit = (El_CallActor(&g_ElState, picnum, iActor, iPlayer, lDist)==1);
+        killit = (El_CallActor(&g_ElState, picnum, vm.g_i, vm.g_p, vm.g_x)==1);
 
         t = gethiticks()-t;
         g_actorTotalMs[picnum] += t;
@@ -5749,18 +6099,47 @@ void A_Execute(int32_t iActor, int32_t iPlayer, int32_t lDist)
         g_actorCalls[picnum]++;
     }
 #else
-    insptr = 4 + (g_tile[vm.g_sp->picnum].execPtr);
-    VM_Execute(1);
-    insptr = NULL;
+    if (EDUKE32_PREDICT_FALSE(g_benchmarkingScripts))
+    {
+        const uint64_t ops = g_vmInstructions;
+        const double t = gethiticks();
+
+        insptr = 4 + (g_tile[vm.g_sp->picnum].execPtr);
+        VM_Execute(1);
+        insptr = NULL;
+
+        g_benchmarkMs += gethiticks() - t;
+        g_benchmarkOps += g_vmInstructions - ops;
+        g_benchmarkScripts++;
+    }
+    else
+    {
+        BUILD_PROFILE_SCOPE("VM_Execute");
+
+        insptr = 4 + (g_tile[vm.g_sp->picnum].execPtr);
+        VM_Execute(1);
+        insptr = NULL;
+    }
+
+    const int32_t killit = (vm.g_flags & VM_KILL);
 #endif
 
-#ifdef LUNATIC
+    *ctx = vm;
+    return killit;
+}
+
+//
+// A_ExecuteEnd
+//
+// The part of A_Execute after the actor's script ran: deletion, movement and going to sleep.
+//
+void A_ExecuteEnd(vmstate_t *ctx, int32_t killit)
+{
+    vm = *ctx;
+
     if (killit)
-#else
-    if (vm.g_flags & VM_KILL)
-#endif
     {
-        VM_DeleteSprite(iActor, iPlayer);
+        VM_DeleteSprite(vm.g_i, vm.g_p);
         return;
     }
 
@@ -5814,6 +6193,85 @@ void A_Execute(int32_t iActor, int32_t iPlayer, int32_t lDist)
     }
 }
 
+void A_Execute(int32_t iActor, int32_t iPlayer, int32_t lDist)
+{
+    vmstate_t ctx = { iActor, iPlayer, lDist, &actor[iActor].t_data[0], &sprite[iActor], g_player[iPlayer].ps, 0 };
+
+    vm = ctx;
+
+    if (!A_ExecuteBegin(&ctx))
+        return;
+
+    const double t = EDUKE32_PREDICT_FALSE(g_demoBench) ? Demo_BenchVMEnter() : 0.0;
+    const int32_t killit = A_ExecuteScript(&ctx);
+
+    if (EDUKE32_PREDICT_FALSE(g_demoBench))
+        Demo_BenchVMLeave(t);
+
+    A_ExecuteEnd(&ctx, killit);
+}
+
+#if !defined LUNATIC
+//
+// G_BenchmarkScripts
+//
+// Runs G_MoveWorld for the given number of tics without drawing or sound, once with the script as compiled
+// and once with C_OptimizeScript's instructions, both from the same map state, which is put back afterwards.
+//
+void G_BenchmarkScripts(int32_t tics)
+{
+    const int32_t levelnum = ud.volume_number*MAXLEVELS+ud.level_number;
+    mapstate_t *const heldstate = MapInfo[levelnum].savedstate;
+    const int32_t soundtoggle = ud.config.SoundToggle, actorscripts = g_actorScripts;
+    const int32_t seed = randomseed, globalrandom = g_globalRandom;
+    int32_t pass, i;
+
+    // don't clobber a state the script saved with savemapstate
+    MapInfo[levelnum].savedstate = NULL;
+    G_SaveMapState();
+
+    ud.config.SoundToggle = 0;
+    g_actorScripts = 0;
+
+    for (pass=0; pass<2; pass++)
+    {
+        const int32_t numopt = C_OptimizeScript(pass);
+
+        randomseed = seed;
+        g_globalRandom = globalrandom;
+
+        g_benchmarkMs = 0;
+        g_benchmarkOps = 0;
+        g_benchmarkScripts = 0;
+        g_benchmarkingScripts = 1;
+
+        double t = gethiticks();
+
+        for (i=0; i<tics; i++)
+            G_MoveWorld();
+
+        t = gethiticks() - t;
+        g_benchmarkingScripts = 0;
+
+        OSD_Printf("vm_benchmark: %s (%d instructions replaced): %d tics in %.1f ms\n", pass ? "optimized" : "as compiled",
+                   numopt, tics, t);
+        OSD_Printf("  %u actor scripts, %llu instructions in %.1f ms, %.2f ns/instruction\n", g_benchmarkScripts,
+                   (unsigned long long)g_benchmarkOps, g_benchmarkMs,
+                   g_benchmarkOps ? g_benchmarkMs * 1000000.0 / (double)g_benchmarkOps : 0.0);
+
+        G_RestoreMapState();
+    }
+
+    C_OptimizeScript(g_scriptOptimize);
+
+    G_FreeMapState(levelnum);
+    MapInfo[levelnum].savedstate = heldstate;
+
+    ud.config.SoundToggle = soundtoggle;
+    g_actorScripts = actorscripts;
+}
+#endif
+
 void G_SaveMapState(void)
 {
     int32_t levelnum = ud.volume_number*MAXLEVELS+ud.level_number;
@@ -5974,6 +6432,7 @@ void G_RestoreMapState(void)
         Bmemcpy(&headspritestat[0],&save->headspritestat[0],sizeof(headspritestat));
         Bmemcpy(&prevspritestat[0],&save->prevspritestat[0],sizeof(prevspritestat));
         Bmemcpy(&nextspritestat[0],&save->nextspritestat[0],sizeof(nextspritestat));
+        clipgrid_invalidate();
 #ifdef YAX_ENABLE
         Bmemcpy(&numyaxbunches, &save->numyaxbunches, sizeof(numyaxbunches));
 # if !defined NEW_MAP_FORMAT
@@ -38,16 +38,28 @@ extern "C" {
 
 extern int32_t ticrandomseed;
 
-extern vmstate_t vm;
+extern VM_TLS vmstate_t vm;
 #if !defined LUNATIC
-extern int32_t g_tw;
-extern int32_t g_errorLineNum;
-extern int32_t g_currentEventExec;
+extern VM_TLS int32_t g_tw;
+extern VM_TLS int32_t g_errorLineNum;
+extern VM_TLS int32_t g_currentEventExec;
+extern VM_TLS uint64_t g_vmInstructions;   // instructions dispatched by VM_Execute on this thread, added as each call returns
+extern uint32_t g_vmWorldWrites;            // instructions run that C_KeywordWritesWorld flags, on the game thread
 
 void A_LoadActor(int32_t iActor);
 #endif
 
 void A_Execute(int32_t iActor, int32_t iPlayer, int32_t lDist);
+
+// A_Execute in three steps, so scripts flagged in g_actorScriptLocal[] can run on the job system between
+// the serial first and last steps.
+int32_t A_ExecuteBegin(vmstate_t *ctx);
+int32_t A_ExecuteScript(vmstate_t *ctx);
+void A_ExecuteEnd(vmstate_t *ctx, int32_t killit);
+
+#if !defined LUNATIC
+void G_BenchmarkScripts(int32_t tics);
+#endif
 void A_Fall(int32_t iActor);
 int32_t A_FurthestVisiblePoint(int32_t iActor,tspritetype * const ts,int32_t *dax,int32_t *day);
 int32_t A_GetFurthestAngle(int32_t iActor,int32_t angs);
@@ -400,11 +400,11 @@ static void ProcessGroups(CACHE1D_FIND_REC *srch)
             initprintf(" Checksumming %s...", sidx->name);
             do
             {
-                b = _read(fh, buf, BUFFER_SIZE);
+                b = Bread(fh, buf, BUFFER_SIZE);
                 if (b > 0) crcval = Bcrc32((uint8_t *)buf, b, crcval);
             }
             while (b == BUFFER_SIZE);
-            _close(fh);
+            Bclose(fh);
             initprintf(" Done\n");
 
             grpinfo_t const * const grptype = FindGrpInfo(crcval, st.st_size);
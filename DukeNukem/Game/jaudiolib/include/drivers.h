@@ -26,7 +26,9 @@
 #undef HAVE_SDL
 #undef HAVE_DS
 
+#ifndef BUILD_HEADLESS
 #define HAVE_SDL 1
+#endif
 
 typedef enum
 {
@@ -37,7 +39,8 @@ typedef enum
     ASS_SDL,
 #endif
     ASS_NumSoundCards,
-    ASS_AutoDetect = -2
+    ASS_AutoDetect = -2,
+    ASS_Headless = -3    // the no sound driver, mixing only when FX_Benchmark services it
 } soundcardnames;
 
 extern int32_t ASS_SoundDriver;
@@ -90,12 +90,38 @@ int32_t FX_SoundsPlaying(void);
 int32_t FX_StopSound(int32_t handle);
 int32_t FX_StopAllSounds(void);
 
+// The calls above only queue the change for the mixer thread. This returns once it has caught up, so the memory a
+// stopped sound played from can be freed. FX_Shutdown does the same.
+void FX_SyncVoices(void);
+
 int32_t FX_SetVoiceCallback(int32_t handle, uint32_t callbackval);
 int32_t FX_SetPrintf(void(*function)(const char *, ...));
 
 int32_t FX_GetPosition(int32_t handle, int32_t *position);
 int32_t FX_SetPosition(int32_t handle, int32_t position);
 
+// Whether the sound is decoded block by block as it plays, Ogg Vorbis and FLAC are.
+int32_t FX_IsCompressed(const char *ptr, uint32_t ptrlength);
+
+// Decodes a whole Ogg Vorbis or FLAC sound into a 16 bit WAV in memory, which plays without decoding anything.
+// Returns FX_Ok and a buffer to Bfree, or FX_Error for other formats, sounds with loop tags and sounds that would
+// take more than maxlength bytes. Sounds whose data is broken also set error to the decoder's error code, it's 0
+// otherwise. Needs no sound device, prints nothing and doesn't touch FX_ErrorCode, so it can run on any thread.
+int32_t FX_DecodeSound(char *ptr, uint32_t ptrlength, uint32_t maxlength, char **wav, uint32_t *wavlength, int32_t *error);
+
+typedef struct
+{
+    int32_t voices;         // voices playing through the whole run
+    int32_t buffers;        // mix buffers serviced
+    double milliseconds;    // time spent mixing them
+    double voicesPerMs;     // voice buffers mixed per millisecond
+    double realtimeVoices;  // voices one core could keep up with at this mix rate
+} FX_BenchmarkResult;
+
+// Shuts the sound system down and mixes numbuffers buffers of numvoices looping voices on the no sound driver,
+// call FX_Init again afterwards.
+int32_t FX_Benchmark(int32_t numvoices, int32_t numbuffers, int32_t numchannels, unsigned mixrate, FX_BenchmarkResult *result);
+
 #ifdef __cplusplus
 }
 #endif
@@ -77,7 +77,7 @@ typedef struct VoiceNode
 
     playbackstatus (*GetSound)(struct VoiceNode *voice);
 
-    void (*mix)(uint32_t position, uint32_t rate, const char *start, uint32_t length);
+    uint32_t (*mix)(float *dest, const char *start, uint32_t position, uint32_t rate, uint32_t last, uint32_t length);
 
     const char *sound;
 
@@ -174,25 +174,65 @@ void MV_ReleaseVorbisVoice(VoiceNode *voice);
 void MV_ReleaseFLACVoice(VoiceNode *voice);
 void MV_ReleaseXAVoice(VoiceNode *voice);
 
-// implemented in mix.c
-void MV_Mix16BitMono(uint32_t position, uint32_t rate, const char *start, uint32_t length);
-void MV_Mix16BitStereo(uint32_t position, uint32_t rate, const char *start, uint32_t length);
-void MV_Mix16BitMono16(uint32_t position, uint32_t rate, const char *start, uint32_t length);
-void MV_Mix16BitStereo16(uint32_t position, uint32_t rate, const char *start, uint32_t length);
-void MV_16BitReverb( char const *src, char *dest, int16_t *volume, int32_t count );
-
-// implemented in mixst.c
-void MV_Mix16BitMono8Stereo(uint32_t position, uint32_t rate, const char *start, uint32_t length);
-void MV_Mix16BitStereo8Stereo(uint32_t position, uint32_t rate, const char *start, uint32_t length);
-void MV_Mix16BitMono16Stereo(uint32_t position, uint32_t rate, const char *start, uint32_t length);
-void MV_Mix16BitStereo16Stereo(uint32_t position, uint32_t rate, const char *start, uint32_t length);
-
-extern char *MV_MixDestination;  // pointer to the next output sample
-extern uint32_t MV_MixPosition;  // return value of where the source pointer got to
-extern const int16_t *MV_LeftVolume;
-extern const int16_t *MV_RightVolume;
-extern int32_t MV_SampleSize;
-extern int32_t MV_RightChannelOffset;
+/*
+ Whole sound decoders, for FX_DecodeSound
+
+ Decode all of a sound to interleaved little endian 16 bit PCM in a
+ malloc()ed buffer. Sounds with loop tags, with more than one format in
+ them or longer than maxlength bytes of PCM fail with MV_Error. A sound
+ that fails because its data is broken also sets *error to the decoder
+ library's error code, the others leave it at 0. These keep no state,
+ leave MV_ErrorCode alone and print nothing, so they are safe on any
+ thread; the caller reports errors from its own thread.
+ */
+int32_t MV_DecodeVorbis(char *ptr, uint32_t length, uint32_t maxlength, char **pcm, uint32_t *pcmlength,
+                        int32_t *rate, int32_t *channels, int32_t *error);
+int32_t MV_DecodeFLAC(char *ptr, uint32_t length, uint32_t maxlength, char **pcm, uint32_t *pcmlength,
+                      int32_t *rate, int32_t *channels, int32_t *error);
+
+/*
+ Resamplers, implemented in mix.c and mixst.c
+
+ Convert length frames of the source, starting at the 16.16 fixed point
+ position and stepping by rate, into floats at 16 bit scale in dest.
+ Stereo sources write interleaved left and right. Each frame is linearly
+ interpolated with the one after it, frame last is the final one in the
+ block and is held rather than read past. Returns the position after the
+ last frame.
+ */
+uint32_t MV_Resample8BitMono(float *dest, const char *start, uint32_t position, uint32_t rate, uint32_t last, uint32_t length);
+uint32_t MV_Resample16BitMono(float *dest, const char *start, uint32_t position, uint32_t rate, uint32_t last, uint32_t length);
+uint32_t MV_Resample8BitStereo(float *dest, const char *start, uint32_t position, uint32_t rate, uint32_t last, uint32_t length);
+uint32_t MV_Resample16BitStereo(float *dest, const char *start, uint32_t position, uint32_t rate, uint32_t last, uint32_t length);
+
+// number of frames from position that still have a frame after them to interpolate towards
+static inline uint32_t MV_InterpolatedFrames(uint32_t position, uint32_t rate, uint32_t last, uint32_t length)
+{
+    uint32_t const end = last << 16;
+
+    if (position >= end)
+        return 0;
+
+    if (rate == 0)
+        return length;
+
+    uint32_t const frames = (end - position + rate - 1) / rate;
+    return frames < length ? frames : length;
+}
+
+/*
+ Mix bus, implemented in mix.c
+
+ Voices are added to a float bus at 16 bit scale and the bus is saturated
+ to the 16 bit output once per buffer. These use SSE2, AVX2 or NEON when
+ the compiler targets them.
+ */
+// bus[i] += source[i] * gain, with gain0 on even and gain1 on odd samples
+void MV_AddToBus(float *bus, const float *source, int32_t count, float gain0, float gain1);
+void MV_AddMonoToStereoBus(float *bus, const float *source, int32_t frames, float left, float right);
+void MV_AddStereoToMonoBus(float *bus, const float *source, int32_t frames, float gain);
+void MV_SaturateBus(int16_t *dest, const float *bus, int32_t count);
+void MV_16BitReverb(char const *src, float *dest, float gain, int32_t count);
 
 #define loopStartTagCount 2
 extern const char *loopStartTags[loopStartTagCount];
@@ -205,4 +245,48 @@ extern const char *loopLengthTags[loopLengthTagCount];
 # define BIGENDIAN
 #endif
 
+// 16 bit sources are always little endian
+static inline int32_t MV_Sample16(uint16_t const *source, uint32_t index)
+{
+#ifdef BIGENDIAN
+    uint16_t const sample = source[index];
+    return (int16_t) ((sample >> 8) | (sample << 8));
+#else
+    return (int16_t) source[index];
+#endif
+}
+
+// 8 bit sources are unsigned, scaled up to 16 bits
+static inline int32_t MV_Sample8(uint8_t const *source, uint32_t index) { return ((int32_t) source[index] - 128) << 8; }
+
+#if defined __AVX2__
+# include <immintrin.h>
+# define MV_MIX_AVX2
+# define MV_MIX_X86
+#elif defined _M_X64 || defined __x86_64__ || defined __SSE2__ || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define MV_MIX_SSE2
+# define MV_MIX_X86
+#elif defined __ARM_NEON || defined __ARM_NEON__
+# include <arm_neon.h>
+# define MV_MIX_NEON
+#endif
+
+#ifdef MV_MIX_X86
+#include <string.h>
+
+// unaligned loads for picking a frame and the one after it up together
+static inline int32_t MV_Load32(void const *ptr) { int32_t value; memcpy(&value, ptr, 4); return value; }
+static inline int32_t MV_Load16(void const *ptr) { uint16_t value; memcpy(&value, ptr, 2); return value; }
+
+// sample0 + (sample1 - sample0) * the fraction of each 16.16 position
+static inline __m128 MV_Interpolate(__m128i sample0, __m128i sample1, __m128i position)
+{
+    __m128 const s0 = _mm_cvtepi32_ps(sample0);
+    __m128 const frac = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(position, _mm_set1_epi32(0xffff))), _mm_set1_ps(1.f / 65536.f));
+
+    return _mm_add_ps(s0, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(sample1), s0), frac));
+}
+#endif
+
 #endif
@@ -52,18 +52,34 @@ void NoSoundDrv_PCM_Shutdown(void)
 {
 }
 
+static void ( *MixCallBack )( void ) = 0;
+
 int32_t NoSoundDrv_PCM_BeginPlayback(char *BufferStart, int32_t BufferSize,
 						int32_t NumDivisions, void ( *CallBackFunc )( void ) )
 {
     UNREFERENCED_PARAMETER(BufferStart);
     UNREFERENCED_PARAMETER(BufferSize);
     UNREFERENCED_PARAMETER(NumDivisions);
-    UNREFERENCED_PARAMETER(CallBackFunc);
+    MixCallBack = CallBackFunc;
     return 0;
 }
 
 void NoSoundDrv_PCM_StopPlayback(void)
 {
+    MixCallBack = 0;
+}
+
+/**
+ * Nothing drains the buffers on its own, this mixes count of them
+ * on the calling thread. Used for benchmarking the mixer.
+ */
+void NoSoundDrv_PCM_Service(int32_t count)
+{
+    if (!MixCallBack)
+        return;
+
+    while (count-- > 0)
+        MixCallBack();
 }
 
 void NoSoundDrv_PCM_Lock(void)
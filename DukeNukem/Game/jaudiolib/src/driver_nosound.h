@@ -28,3 +28,4 @@ int NoSoundDrv_PCM_BeginPlayback(char *BufferStart, int BufferSize,
 void NoSoundDrv_PCM_StopPlayback(void);
 void NoSoundDrv_PCM_Lock(void);
 void NoSoundDrv_PCM_Unlock(void);
+void NoSoundDrv_PCM_Service(int count);
@@ -66,8 +66,12 @@ const char * SoundDriver_ErrorString(int32_t ErrorNumber)
 
 int32_t SoundDriver_Init(int32_t *mixrate, int32_t *numchannels, void *initdata)
 {
-	// Force the right sound driver.
-	ASS_SoundDriver = ASS_SDL;
+	// Force the right sound driver, headless runs never open a device.
+#ifdef BUILD_HEADLESS
+	ASS_SoundDriver = ASS_NoSound;
+#else
+	ASS_SoundDriver = (ASS_SoundDriver == ASS_Headless) ? ASS_NoSound : ASS_SDL;
+#endif
 	return SoundDrivers[ASS_SoundDriver].Init(mixrate, numchannels, initdata);
 }
 
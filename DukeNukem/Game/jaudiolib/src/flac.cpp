@@ -663,11 +663,199 @@ void MV_ReleaseFLACVoice(VoiceNode *voice)
 
     voice->rawdataptr = 0;
 }
+
+
+// whole sound decoding, the flac_data has to come first for the read callbacks
+
+typedef struct
+{
+    flac_data fd;
+
+    char *pcm;
+    size_t pcmlength;
+    size_t pcmsize;
+    size_t maxlength;
+
+    uint32_t channels;
+    uint32_t rate;
+    int32_t loops;
+    int32_t error;          // FLAC__StreamDecoderErrorStatus + 1 of the first error, 0 if there was none
+} flac_decode;
+
+static void metadata_flac_decode(const FLAC__StreamDecoder *decoder, const FLAC__StreamMetadata *metadata,
+                                 void *client_data)
+{
+    flac_decode *dec = (flac_decode *)client_data;
+
+    UNREFERENCED_PARAMETER(decoder);
+
+    if (metadata->type != FLAC__METADATA_TYPE_VORBIS_COMMENT)
+        return;
+
+    for (FLAC__uint32 comment = 0; comment < metadata->data.vorbis_comment.num_comments; ++comment)
+    {
+        const char *entry = (const char *)metadata->data.vorbis_comment.comments[comment].entry;
+        const char *value = entry ? strchr(entry, '=') : NULL;
+
+        if (value == NULL)
+            continue;
+
+        for (uint8_t loopTagCount = 0; loopTagCount < loopStartTagCount; ++loopTagCount)
+            if (strncasecmp(entry, loopStartTags[loopTagCount], value - entry) == 0)
+                dec->loops = 1;
+    }
+}
+
+static FLAC__StreamDecoderWriteStatus write_flac_decode(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame,
+                                                        const FLAC__int32 *const ibuffer[], void *client_data)
+{
+    flac_decode *dec = (flac_decode *)client_data;
+    uint32_t const channels = frame->header.channels;
+    uint32_t const bits = frame->header.bits_per_sample;
+    size_t const samples = frame->header.blocksize;
+    size_t const size = samples * channels * 2;
+
+    UNREFERENCED_PARAMETER(decoder);
+
+    if (dec->loops || (channels != 1 && channels != 2) || bits < 4 || bits > 32)
+        return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+    if (dec->channels == 0)
+    {
+        dec->channels = channels;
+        dec->rate = frame->header.sample_rate;
+    }
+    else if (channels != dec->channels || frame->header.sample_rate != dec->rate)
+        return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+    if (dec->pcmlength + size > dec->maxlength)
+        return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+    if (dec->pcmlength + size > dec->pcmsize)
+    {
+        size_t newsize = max(dec->pcmsize * 2, dec->pcmlength + size);
+        char *pcm = (char *)realloc(dec->pcm, min(newsize, dec->maxlength));
+
+        if (!pcm)
+            return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+        dec->pcm = pcm;
+        dec->pcmsize = min(newsize, dec->maxlength);
+    }
+
+    char *obuffer = dec->pcm + dec->pcmlength;
+
+    for (size_t sample = 0; sample < samples; ++sample)
+        for (uint32_t channel = 0; channel < channels; ++channel)
+        {
+            FLAC__int32 val = ibuffer[channel][sample];
+
+            if (bits > 16)
+                val >>= bits - 16;
+            else
+                val *= 1 << (16 - bits);
+
+            *obuffer++ = val & 0xff;
+            *obuffer++ = (val >> 8) & 0xff;
+        }
+
+    dec->pcmlength += size;
+
+    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+// error_flac_stream prints, which isn't safe off the game thread, so decoding only remembers the first error.
+static void error_flac_decode(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+    flac_decode *dec = (flac_decode *)client_data;
+
+    UNREFERENCED_PARAMETER(decoder);
+
+    if (dec->error == 0)
+        dec->error = (int32_t)status + 1;
+}
+
+/*---------------------------------------------------------------------
+Function: MV_DecodeFLAC
+
+Decodes a whole FLAC sound to 16 bit PCM.
+---------------------------------------------------------------------*/
+
+int32_t MV_DecodeFLAC(char *ptr, uint32_t ptrlength, uint32_t maxlength, char **pcm, uint32_t *pcmlength,
+                      int32_t *rate, int32_t *channels, int32_t *error)
+{
+    *error = 0;
+
+    flac_decode *dec = (flac_decode *)calloc(1, sizeof(flac_decode));
+
+    if (!dec)
+        return MV_Error;
+
+    dec->fd.ptr = ptr;
+    dec->fd.length = ptrlength;
+    dec->maxlength = maxlength;
+
+    if ((dec->fd.stream = FLAC__stream_decoder_new()) == NULL)
+    {
+        free(dec);
+        return MV_Error;
+    }
+
+    FLAC__stream_decoder_set_metadata_respond(dec->fd.stream, FLAC__METADATA_TYPE_VORBIS_COMMENT);
+
+    int32_t status = MV_Error;
+
+    if (FLAC__stream_decoder_init_stream(dec->fd.stream, read_flac_stream, seek_flac_stream, tell_flac_stream,
+                                         length_flac_stream, eof_flac_stream, write_flac_decode, metadata_flac_decode,
+                                         error_flac_decode, (void *)dec) == FLAC__STREAM_DECODER_INIT_STATUS_OK)
+    {
+        if (FLAC__stream_decoder_process_until_end_of_stream(dec->fd.stream) &&
+            FLAC__stream_decoder_get_state(dec->fd.stream) == FLAC__STREAM_DECODER_END_OF_STREAM &&
+            !dec->loops && dec->pcmlength > 0)
+            status = MV_Ok;
+
+        FLAC__stream_decoder_finish(dec->fd.stream);
+    }
+
+    FLAC__stream_decoder_delete(dec->fd.stream);
+
+    if (status == MV_Ok)
+    {
+        *pcm = dec->pcm;
+        *pcmlength = (uint32_t)dec->pcmlength;
+        *rate = dec->rate;
+        *channels = dec->channels;
+    }
+    else
+    {
+        *error = dec->error;
+        free(dec->pcm);
+    }
+
+    free(dec);
+
+    return status;
+}
 #else
 #include <stdlib.h>
 #include <stdio.h>
 #include "_multivc.h"
 
+int32_t MV_DecodeFLAC(char *ptr, uint32_t ptrlength, uint32_t maxlength, char **pcm, uint32_t *pcmlength,
+                      int32_t *rate, int32_t *channels, int32_t *error)
+{
+    UNREFERENCED_PARAMETER(ptr);
+    UNREFERENCED_PARAMETER(ptrlength);
+    UNREFERENCED_PARAMETER(maxlength);
+    UNREFERENCED_PARAMETER(pcm);
+    UNREFERENCED_PARAMETER(pcmlength);
+    UNREFERENCED_PARAMETER(rate);
+    UNREFERENCED_PARAMETER(channels);
+
+    *error = 0;
+    return MV_Error;
+}
+
 int32_t MV_PlayFLAC(char *ptr, uint32_t ptrlength, int32_t loopstart, int32_t loopend, int32_t pitchoffset,
     int32_t vol, int32_t left, int32_t right, int32_t priority, uint32_t callbackval)
 {
@@ -30,12 +30,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
    (c) Copyright 1994 James R. Dose.  All Rights Reserved.
 **********************************************************************/
 
+#include <chrono>  // ahead of compat.h, its min and max macros break some standard headers
 #include "compat.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "drivers.h"
+#include "driver_nosound.h"
 #include "multivoc.h"
+#include "_multivc.h"
 #include "fx_man.h"
 
 int32_t FX_ErrorCode = FX_Ok;
@@ -86,16 +89,20 @@ int32_t FX_Init(int32_t SoundCard, int32_t numvoices, int32_t numchannels, unsig
 		SoundCard = ASS_NoSound;
     }
 
-    if (SoundCard < 0 || SoundCard >= ASS_NumSoundCards)
+    // headless runs never open a device, nothing is mixed unless something services the driver
+    if (SoundCard != ASS_Headless)
     {
-        FX_SetErrorCode(FX_InvalidCard);
-        return FX_Error;
-    }
-
-    if (SoundDriver_IsSupported(SoundCard) == 0)
-    {
-        // unsupported cards fall back to no sound
-        SoundCard = ASS_NoSound;
+        if (SoundCard < 0 || SoundCard >= ASS_NumSoundCards)
+        {
+            FX_SetErrorCode(FX_InvalidCard);
+            return FX_Error;
+        }
+
+        if (SoundDriver_IsSupported(SoundCard) == 0)
+        {
+            // unsupported cards fall back to no sound
+            SoundCard = ASS_NoSound;
+        }
     }
 
     int status = FX_Ok;
@@ -178,6 +185,8 @@ int32_t FX_SoundsPlaying(void) { return MV_VoicesPlaying(); }
 
 int32_t FX_StopSound(int32_t handle) { return FX_CheckMVErr(MV_Kill(handle)); }
 
+void FX_SyncVoices(void) { MV_SyncVoices(); }
+
 int32_t FX_StopAllSounds(void) { return FX_CheckMVErr(MV_KillAllVoices()); }
 
 static wavefmt_t FX_AutoDetectFormat(const char *ptr, uint32_t length)
@@ -293,3 +302,171 @@ int32_t FX_SetPrintf(void (*function)(const char *, ...))
 
     return FX_Ok;
 }
+
+#define FX_WAVHEADERSIZE (sizeof(riff_header) + sizeof(format_header) + sizeof(data_header))
+
+// Fills in the headers of a PCM WAV with datasize bytes of samples after them.
+static void FX_WriteWAVHeader(char *ptr, int32_t bits, int32_t channels, int32_t rate, uint32_t datasize)
+{
+    riff_header riff;
+    memcpy(riff.RIFF, "RIFF", 4);
+    riff.file_size = LITTLE32(FX_WAVHEADERSIZE + datasize - 8);
+    memcpy(riff.WAVE, "WAVE", 4);
+    memcpy(riff.fmt, "fmt ", 4);
+    riff.format_size = LITTLE32(sizeof(format_header));
+
+    format_header format;
+    format.wFormatTag = LITTLE16(1);
+    format.nChannels = LITTLE16(channels);
+    format.nSamplesPerSec = LITTLE32(rate);
+    format.nAvgBytesPerSec = LITTLE32(rate * channels * (bits / 8));
+    format.nBlockAlign = LITTLE16(channels * (bits / 8));
+    format.nBitsPerSample = LITTLE16(bits);
+
+    data_header data;
+    memcpy(data.DATA, "data", 4);
+    data.size = LITTLE32(datasize);
+
+    memcpy(ptr, &riff, sizeof(riff_header));
+    memcpy(ptr + sizeof(riff_header), &format, sizeof(format_header));
+    memcpy(ptr + sizeof(riff_header) + sizeof(format_header), &data, sizeof(data_header));
+}
+
+int32_t FX_IsCompressed(const char *ptr, uint32_t length)
+{
+    wavefmt_t const fmt = FX_AutoDetectFormat(ptr, length);
+
+    return fmt == FMT_VORBIS || fmt == FMT_FLAC;
+}
+
+int32_t FX_DecodeSound(char *ptr, uint32_t length, uint32_t maxlength, char **wav, uint32_t *wavlength, int32_t *error)
+{
+    EDUKE32_STATIC_ASSERT(FMT_MAX == 7);
+
+    static int32_t (*const func[FMT_MAX])(char *, uint32_t, uint32_t, char **, uint32_t *, int32_t *, int32_t *, int32_t *) =
+    { NULL, NULL, NULL, NULL, MV_DecodeVorbis, MV_DecodeFLAC, NULL };
+
+    wavefmt_t const fmt = FX_AutoDetectFormat(ptr, length);
+
+    *error = 0;
+
+    if (func[fmt] == NULL || maxlength <= FX_WAVHEADERSIZE)
+        return FX_Error;
+
+    char *pcm;
+    uint32_t pcmlength;
+    int32_t rate, channels;
+
+    if (func[fmt](ptr, length, maxlength - FX_WAVHEADERSIZE, &pcm, &pcmlength, &rate, &channels, error) != MV_Ok)
+        return FX_Error;
+
+    *wavlength = FX_WAVHEADERSIZE + pcmlength;
+    *wav = (char *)Xmalloc(*wavlength);
+
+    FX_WriteWAVHeader(*wav, 16, channels, rate, pcmlength);
+    memcpy(*wav + FX_WAVHEADERSIZE, pcm, pcmlength);
+    free(pcm);
+
+    return FX_Ok;
+}
+
+// A looping tone with some noise on it, so the resamplers have something other than silence to interpolate.
+static char *FX_MakeBenchmarkWAV(int32_t bits, int32_t channels, int32_t rate, int32_t frames, uint32_t *length)
+{
+    int32_t const datasize = frames * channels * (bits / 8);
+    *length = FX_WAVHEADERSIZE + datasize;
+
+    char *ptr = (char *)Xmalloc(*length);
+
+    FX_WriteWAVHeader(ptr, bits, channels, rate, datasize);
+
+    char *samples = ptr + FX_WAVHEADERSIZE;
+    uint32_t noise = 0x1234567;
+
+    for (int32_t i = 0; i < frames * channels; i++)
+    {
+        noise = noise * 1664525 + 1013904223;
+
+        // triangle wave, a period of 64 frames on the left and 48 on the right
+        int32_t const period = 64 - 16 * (i % channels);
+        int32_t const phase = (i / channels) % period;
+        int32_t const sample = (phase < period / 2 ? phase : period - phase) * 65536 / period - 16384 + (int32_t)(noise >> 20) - 2048;
+
+        if (bits == 16)
+        {
+            samples[i * 2] = (char)(sample & 255);
+            samples[i * 2 + 1] = (char)((sample >> 8) & 255);
+        }
+        else
+            samples[i] = (char)((sample >> 8) + 128);
+    }
+
+    return ptr;
+}
+
+int32_t FX_Benchmark(int32_t numvoices, int32_t numbuffers, int32_t numchannels, unsigned mixrate, FX_BenchmarkResult *result)
+{
+    if (FX_Installed)
+        FX_Shutdown();
+
+    Bmemset(result, 0, sizeof(FX_BenchmarkResult));
+
+    if (MV_Init(ASS_Headless, mixrate, numvoices, numchannels, NULL) != MV_Ok)
+    {
+        FX_SetErrorCode(FX_MultiVocError);
+        return FX_Error;
+    }
+
+    // every source format, at rates that need resampling
+    static const struct { int32_t bits, channels, rate; } formats[] = { { 8, 1, 11025 }, { 16, 1, 22050 }, { 8, 2, 22050 }, { 16, 2, 32000 } };
+    int32_t const numformats = ARRAY_SIZE(formats);
+
+    char *sounds[ARRAY_SIZE(formats)];
+    uint32_t lengths[ARRAY_SIZE(formats)];
+
+    for (int32_t i = 0; i < numformats; i++)
+        sounds[i] = FX_MakeBenchmarkWAV(formats[i].bits, formats[i].channels, formats[i].rate, formats[i].rate / 2, &lengths[i]);
+
+    int32_t status = FX_Ok;
+
+    for (int32_t i = 0; i < numvoices; i++)
+    {
+        // spread the voices around the listener and over a range of pitches, none far enough away to go quiet
+        if (MV_PlayWAV3D(sounds[i % numformats], lengths[i % numformats], FX_LOOP, ((i % 9) - 4) * 64, (i * 13) & MV_MAXPANPOSITION,
+                         (i * 37) % 192, 0, i) <= MV_Ok)
+        {
+            FX_SetErrorCode(FX_MultiVocError);
+            status = FX_Error;
+            break;
+        }
+    }
+
+    if (status == FX_Ok)
+    {
+        // the first buffers pull the voices' first blocks in
+        NoSoundDrv_PCM_Service(MV_NUMBEROFBUFFERS);
+
+        auto const start = std::chrono::high_resolution_clock::now();
+        NoSoundDrv_PCM_Service(numbuffers);
+        auto const end = std::chrono::high_resolution_clock::now();
+
+        result->voices = MV_VoicesPlaying();
+        result->buffers = numbuffers;
+        result->milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+        if (result->milliseconds > 0.0)
+        {
+            double const audioms = (double)numbuffers * MV_MIXBUFFERSIZE * 1000.0 / mixrate;
+
+            result->voicesPerMs = (double)result->voices * numbuffers / result->milliseconds;
+            result->realtimeVoices = (double)result->voices * audioms / result->milliseconds;
+        }
+    }
+
+    MV_Shutdown();
+
+    for (int32_t i = 0; i < numformats; i++)
+        Bfree(sounds[i]);
+
+    return status;
+}
@@ -27,154 +27,320 @@
  rate = resampling increment
  start = sound data
  length = count of samples to mix
+ last = index of the final sample in start
+ dest = float samples at 16 bit scale, added to the bus afterwards
  */
 
-// 8-bit mono source, 16-bit mono output
-void MV_Mix16BitMono(uint32_t position, uint32_t rate, const char *start, uint32_t length)
+// 8-bit mono source
+uint32_t MV_Resample8BitMono(float *dest, const char *start, uint32_t position, uint32_t rate, uint32_t last, uint32_t length)
 {
-    uint8_t const * const source = (uint8_t *) start;
-    int16_t *dest = (int16_t *) MV_MixDestination;
-    int32_t sample0;
-    
+    uint8_t const * const source = (uint8_t const *) start;
+    uint32_t interpolated = MV_InterpolatedFrames(position, rate, last, length);
+
+    length -= interpolated;
+
+#ifdef MV_MIX_X86
+    __m128i pos = _mm_setr_epi32((int) position, (int) (position + rate), (int) (position + rate * 2), (int) (position + rate * 3));
+
+    for (; interpolated >= 4; interpolated -= 4) {
+        // one 16 bit load picks up a frame and the one after it
+        __m128i const pairs = _mm_setr_epi32(MV_Load16(source + (position >> 16)), MV_Load16(source + ((position + rate) >> 16)),
+                                             MV_Load16(source + ((position + rate * 2) >> 16)), MV_Load16(source + ((position + rate * 3) >> 16)));
+        __m128i const bias = _mm_set1_epi32(128);
+        __m128i const sample0 = _mm_slli_epi32(_mm_sub_epi32(_mm_and_si128(pairs, _mm_set1_epi32(255)), bias), 8);
+        __m128i const sample1 = _mm_slli_epi32(_mm_sub_epi32(_mm_srli_epi32(pairs, 8), bias), 8);
+
+        _mm_storeu_ps(dest, MV_Interpolate(sample0, sample1, pos));
+        dest += 4;
+        position += rate * 4;
+        pos = _mm_add_epi32(pos, _mm_set1_epi32((int) (rate * 4)));
+    }
+#endif
+
+    while (interpolated--) {
+        uint32_t const index = position >> 16;
+        // a 15 bit fraction keeps the difference times it inside of 32 bits
+        int32_t const frac = (position & 0xffff) >> 1;
+        int32_t const sample0 = MV_Sample8(source, index);
+
+        *dest++ = (float) (sample0 + ((MV_Sample8(source, index + 1) - sample0) * frac >> 15));
+        position += rate;
+    }
+
+    // the caller never asks for a frame past last, so these all land on it
     while (length--) {
-        sample0 = source[position >> 16];
+        *dest++ = (float) MV_Sample8(source, position >> 16);
         position += rate;
-        
-        sample0 = MV_LeftVolume[sample0] + *dest;
-        if (sample0 < -32768) sample0 = -32768;
-        else if (sample0 > 32767) sample0 = 32767;
-        
-        *dest = (int16_t) sample0;
-        
-        dest += MV_SampleSize / 2;
-    }
-    
-    MV_MixPosition = position;
-    MV_MixDestination = (char *) dest;
+    }
+
+    return position;
 }
 
-// 8-bit mono source, 16-bit stereo output
-void MV_Mix16BitStereo(uint32_t position, uint32_t rate, const char *start, uint32_t length)
+// 16-bit mono source
+uint32_t MV_Resample16BitMono(float *dest, const char *start, uint32_t position, uint32_t rate, uint32_t last, uint32_t length)
 {
-    uint8_t const * const source = (uint8_t *) start;
-    int16_t *dest = (int16_t *) MV_MixDestination;
-    int32_t sample0, sample1;
-    
+    uint16_t const * const source = (uint16_t const *) start;
+    uint32_t interpolated = MV_InterpolatedFrames(position, rate, last, length);
+
+    length -= interpolated;
+
+#ifdef MV_MIX_X86
+    __m128i pos = _mm_setr_epi32((int) position, (int) (position + rate), (int) (position + rate * 2), (int) (position + rate * 3));
+
+    for (; interpolated >= 4; interpolated -= 4) {
+        // one 32 bit load picks up a frame and the one after it
+        __m128i const pairs = _mm_setr_epi32(MV_Load32(source + (position >> 16)), MV_Load32(source + ((position + rate) >> 16)),
+                                             MV_Load32(source + ((position + rate * 2) >> 16)), MV_Load32(source + ((position + rate * 3) >> 16)));
+
+        _mm_storeu_ps(dest, MV_Interpolate(_mm_srai_epi32(_mm_slli_epi32(pairs, 16), 16), _mm_srai_epi32(pairs, 16), pos));
+        dest += 4;
+        position += rate * 4;
+        pos = _mm_add_epi32(pos, _mm_set1_epi32((int) (rate * 4)));
+    }
+#endif
+
+    while (interpolated--) {
+        uint32_t const index = position >> 16;
+        int32_t const frac = (position & 0xffff) >> 1;
+        int32_t const sample0 = MV_Sample16(source, index);
+
+        *dest++ = (float) (sample0 + ((MV_Sample16(source, index + 1) - sample0) * frac >> 15));
+        position += rate;
+    }
+
     while (length--) {
-        sample0 = source[position >> 16];
-        sample1 = sample0;
+        *dest++ = (float) MV_Sample16(source, position >> 16);
         position += rate;
-        
-        sample0 = MV_LeftVolume[sample0] + *dest;
-        sample1 = MV_RightVolume[sample1] + *(dest + MV_RightChannelOffset / 2);
-        if (sample0 < -32768) sample0 = -32768;
-        else if (sample0 > 32767) sample0 = 32767;
-        if (sample1 < -32768) sample1 = -32768;
-        else if (sample1 > 32767) sample1 = 32767;
-        
-        *dest = (int16_t) sample0;
-        *(dest + MV_RightChannelOffset/2) = (int16_t) sample1;
-        
-        dest += MV_SampleSize / 2;
-    }
-    
-    MV_MixPosition = position;
-    MV_MixDestination = (char *) dest;
+    }
+
+    return position;
 }
 
-// 16-bit mono source, 16-bit mono output
-void MV_Mix16BitMono16(uint32_t position, uint32_t rate, const char *start, uint32_t length)
+void MV_AddToBus(float *bus, const float *source, int32_t count, float gain0, float gain1)
 {
-    uint16_t const * const source = (uint16_t *) start;
-    int16_t *dest = (int16_t *) MV_MixDestination;
-    int32_t sample0l, sample0h, sample0;
-    
-    while (length--) {
-        sample0 = source[position >> 16];
-#ifdef BIGENDIAN
-        sample0l = sample0 >> 8;
-        sample0h = (sample0 & 255) ^ 128;
-#else
-        sample0l = sample0 & 255;
-        sample0h = (sample0 >> 8) ^ 128;
+    int32_t i = 0;
+
+#if defined MV_MIX_AVX2
+    __m256 const gain = _mm256_setr_ps(gain0, gain1, gain0, gain1, gain0, gain1, gain0, gain1);
+
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(bus + i, _mm256_add_ps(_mm256_loadu_ps(bus + i), _mm256_mul_ps(_mm256_loadu_ps(source + i), gain)));
+#elif defined MV_MIX_SSE2
+    __m128 const gain = _mm_setr_ps(gain0, gain1, gain0, gain1);
+
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(bus + i, _mm_add_ps(_mm_loadu_ps(bus + i), _mm_mul_ps(_mm_loadu_ps(source + i), gain)));
+#elif defined MV_MIX_NEON
+    float const gains[4] = { gain0, gain1, gain0, gain1 };
+    float32x4_t const gain = vld1q_f32(gains);
+
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(bus + i, vmlaq_f32(vld1q_f32(bus + i), vld1q_f32(source + i), gain));
 #endif
-        position += rate;
-        
-        sample0l = MV_LeftVolume[sample0l] >> 8;
-        sample0h = MV_LeftVolume[sample0h];
-        sample0 = sample0l + sample0h + 128 + *dest;
-        if (sample0 < -32768) sample0 = -32768;
-        else if (sample0 > 32767) sample0 = 32767;
-        
-        *dest = (int16_t) sample0;
-        
-        dest += MV_SampleSize / 2;
-    }
-    
-    MV_MixPosition = position;
-    MV_MixDestination = (char *) dest;
+
+    for (; i < count; i++)
+        bus[i] += source[i] * ((i & 1) ? gain1 : gain0);
 }
 
-// 16-bit mono source, 16-bit stereo output
-void MV_Mix16BitStereo16(uint32_t position, uint32_t rate, const char *start, uint32_t length)
+void MV_AddMonoToStereoBus(float *bus, const float *source, int32_t frames, float left, float right)
 {
-    uint16_t const * const source = (uint16_t *) start;
-    int16_t *dest = (int16_t *) MV_MixDestination;
-    int32_t sample0l, sample0h, sample0;
-    int32_t sample1l, sample1h, sample1;
-    
-    while (length--) {
-        sample0 = source[position >> 16];
-#ifdef BIGENDIAN
-        sample0l = sample0 >> 8;
-        sample0h = (sample0 & 255) ^ 128;
-#else
-        sample0l = sample0 & 255;
-        sample0h = (sample0 >> 8) ^ 128;
+    int32_t i = 0;
+
+#if defined MV_MIX_AVX2
+    __m256 const gain = _mm256_setr_ps(left, right, left, right, left, right, left, right);
+
+    for (; i + 8 <= frames; i += 8)
+    {
+        __m256 const sample = _mm256_loadu_ps(source + i);
+        __m256 const lo = _mm256_unpacklo_ps(sample, sample);  // 0 0 1 1 | 4 4 5 5
+        __m256 const hi = _mm256_unpackhi_ps(sample, sample);  // 2 2 3 3 | 6 6 7 7
+        float * const out = bus + (i << 1);
+
+        _mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out), _mm256_mul_ps(_mm256_permute2f128_ps(lo, hi, 0x20), gain)));
+        _mm256_storeu_ps(out + 8, _mm256_add_ps(_mm256_loadu_ps(out + 8), _mm256_mul_ps(_mm256_permute2f128_ps(lo, hi, 0x31), gain)));
+    }
+#elif defined MV_MIX_SSE2
+    __m128 const gain = _mm_setr_ps(left, right, left, right);
+
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128 const sample = _mm_loadu_ps(source + i);
+        float * const out = bus + (i << 1);
+
+        _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(_mm_unpacklo_ps(sample, sample), gain)));
+        _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(_mm_unpackhi_ps(sample, sample), gain)));
+    }
+#elif defined MV_MIX_NEON
+    float const gains[4] = { left, right, left, right };
+    float32x4_t const gain = vld1q_f32(gains);
+
+    for (; i + 4 <= frames; i += 4)
+    {
+        float32x4_t const sample = vld1q_f32(source + i);
+        float32x4x2_t const pairs = vzipq_f32(sample, sample);
+        float * const out = bus + (i << 1);
+
+        vst1q_f32(out, vmlaq_f32(vld1q_f32(out), pairs.val[0], gain));
+        vst1q_f32(out + 4, vmlaq_f32(vld1q_f32(out + 4), pairs.val[1], gain));
+    }
 #endif
-        sample1l = sample0l;
-        sample1h = sample0h;
-        position += rate;
-        
-        sample0l = MV_LeftVolume[sample0l] >> 8;
-        sample0h = MV_LeftVolume[sample0h];
-        sample1l = MV_RightVolume[sample1l] >> 8;
-        sample1h = MV_RightVolume[sample1h];
-        sample0 = sample0l + sample0h + 128 + *dest;
-        sample1 = sample1l + sample1h + 128 + *(dest + MV_RightChannelOffset/2);
-        if (sample0 < -32768) sample0 = -32768;
-        else if (sample0 > 32767) sample0 = 32767;
-        if (sample1 < -32768) sample1 = -32768;
-        else if (sample1 > 32767) sample1 = 32767;
-        
-        *dest = (int16_t) sample0;
-        *(dest + MV_RightChannelOffset/2) = (int16_t) sample1;
-        
-        dest += MV_SampleSize / 2;
-    }
-    
-    MV_MixPosition = position;
-    MV_MixDestination = (char *) dest;
+
+    for (; i < frames; i++)
+    {
+        bus[i << 1] += source[i] * left;
+        bus[(i << 1) + 1] += source[i] * right;
+    }
+}
+
+void MV_AddStereoToMonoBus(float *bus, const float *source, int32_t frames, float gain)
+{
+    int32_t i = 0;
+
+    gain *= 0.5f;
+
+#if defined MV_MIX_AVX2
+    __m256 const gains = _mm256_set1_ps(gain);
+
+    for (; i + 8 <= frames; i += 8)
+    {
+        // hadd pairs up within each 128 bit lane, the permute puts the frames back in order
+        __m256 const sum = _mm256_hadd_ps(_mm256_loadu_ps(source + (i << 1)), _mm256_loadu_ps(source + (i << 1) + 8));
+        __m256 const mono = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), _MM_SHUFFLE(3, 1, 2, 0)));
+
+        _mm256_storeu_ps(bus + i, _mm256_add_ps(_mm256_loadu_ps(bus + i), _mm256_mul_ps(mono, gains)));
+    }
+#elif defined MV_MIX_SSE2
+    __m128 const gains = _mm_set1_ps(gain);
+
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128 const a = _mm_loadu_ps(source + (i << 1));
+        __m128 const b = _mm_loadu_ps(source + (i << 1) + 4);
+        __m128 const mono = _mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        _mm_storeu_ps(bus + i, _mm_add_ps(_mm_loadu_ps(bus + i), _mm_mul_ps(mono, gains)));
+    }
+#elif defined MV_MIX_NEON
+    for (; i + 4 <= frames; i += 4)
+    {
+        float32x4x2_t const channels = vuzpq_f32(vld1q_f32(source + (i << 1)), vld1q_f32(source + (i << 1) + 4));
+
+        vst1q_f32(bus + i, vmlaq_n_f32(vld1q_f32(bus + i), vaddq_f32(channels.val[0], channels.val[1]), gain));
+    }
+#endif
+
+    for (; i < frames; i++)
+        bus[i] += (source[i << 1] + source[(i << 1) + 1]) * gain;
+}
+
+/*
+ The bus is clamped before converting, out of range floats convert to
+ INT_MIN on x86 and a loud positive sample would wrap to full negative.
+ Every path adds 0.5 with the sign of the sample and truncates, the
+ same float operations as the scalar loop, so the output doesn't depend
+ on which SIMD path mixed it. The native round to nearest conversions
+ round halves to even instead.
+ */
+void MV_SaturateBus(int16_t *dest, const float *bus, int32_t count)
+{
+    int32_t i = 0;
+
+#if defined MV_MIX_AVX2
+    __m256 const lo = _mm256_set1_ps(-32768.f);
+    __m256 const hi = _mm256_set1_ps(32767.f);
+    __m256 const half = _mm256_set1_ps(0.5f);
+    __m256 const sign = _mm256_set1_ps(-0.f);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256 const fa = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(bus + i), lo), hi);
+        __m256 const fb = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(bus + i + 8), lo), hi);
+        __m256i const a = _mm256_cvttps_epi32(_mm256_add_ps(fa, _mm256_or_ps(half, _mm256_and_ps(fa, sign))));
+        __m256i const b = _mm256_cvttps_epi32(_mm256_add_ps(fb, _mm256_or_ps(half, _mm256_and_ps(fb, sign))));
+
+        // packs works within each 128 bit lane, the permute puts the samples back in order
+        _mm256_storeu_si256((__m256i *) (dest + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+#elif defined MV_MIX_SSE2
+    __m128 const lo = _mm_set1_ps(-32768.f);
+    __m128 const hi = _mm_set1_ps(32767.f);
+    __m128 const half = _mm_set1_ps(0.5f);
+    __m128 const sign = _mm_set1_ps(-0.f);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128 const fa = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(bus + i), lo), hi);
+        __m128 const fb = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(bus + i + 4), lo), hi);
+        __m128i const a = _mm_cvttps_epi32(_mm_add_ps(fa, _mm_or_ps(half, _mm_and_ps(fa, sign))));
+        __m128i const b = _mm_cvttps_epi32(_mm_add_ps(fb, _mm_or_ps(half, _mm_and_ps(fb, sign))));
+
+        _mm_storeu_si128((__m128i *) (dest + i), _mm_packs_epi32(a, b));
+    }
+#elif defined MV_MIX_NEON
+    float32x4_t const lo = vdupq_n_f32(-32768.f);
+    float32x4_t const hi = vdupq_n_f32(32767.f);
+    float32x4_t const half = vdupq_n_f32(0.5f);
+    uint32x4_t const sign = vdupq_n_u32(0x80000000u);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        float32x4_t const fa = vminq_f32(vmaxq_f32(vld1q_f32(bus + i), lo), hi);
+        float32x4_t const fb = vminq_f32(vmaxq_f32(vld1q_f32(bus + i + 4), lo), hi);
+
+        // vcvtq_s32_f32 truncates on both 32 and 64 bit ARM
+        int32x4_t const a = vcvtq_s32_f32(vaddq_f32(fa, vbslq_f32(sign, fa, half)));
+        int32x4_t const b = vcvtq_s32_f32(vaddq_f32(fb, vbslq_f32(sign, fb, half)));
+
+        vst1q_s16(dest + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        float sample = bus[i];
+
+        if (sample < -32768.f) sample = -32768.f;
+        else if (sample > 32767.f) sample = 32767.f;
+
+        dest[i] = (int16_t) (sample + (sample >= 0.f ? 0.5f : -0.5f));
+    }
 }
 
-void MV_16BitReverb(char const *src, char *dest, int16_t *volume, int32_t count)
+void MV_16BitReverb(char const *src, float *dest, float gain, int32_t count)
 {
-    uint16_t const * input = (uint16_t *) src;
-    int16_t * output = (int16_t *) dest;
-    int16_t sample0l, sample0h, sample0;
-    
-    do {
-        sample0 = *input++;
-#if 0 //def BIGENDIAN
-        sample0l = sample0 >> 8;
-        sample0h = (sample0 & 255) ^ 128;
-#else
-        sample0l = sample0 & 255;
-        sample0h = (sample0 >> 8) ^ 128;
+    int16_t const * input = (int16_t const *) src;
+    int32_t i = 0;
+
+#if defined MV_MIX_AVX2
+    __m256 const gains = _mm256_set1_ps(gain);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i const sample = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i const *) (input + i)));
+        _mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_cvtepi32_ps(sample), gains));
+    }
+#elif defined MV_MIX_SSE2
+    __m128 const gains = _mm_set1_ps(gain);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i const sample = _mm_loadu_si128((__m128i const *) (input + i));
+        __m128i const lo = _mm_srai_epi32(_mm_unpacklo_epi16(sample, sample), 16);
+        __m128i const hi = _mm_srai_epi32(_mm_unpackhi_epi16(sample, sample), 16);
+
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), gains));
+        _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), gains));
+    }
+#elif defined MV_MIX_NEON
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t const sample = vld1q_s16(input + i);
+
+        vst1q_f32(dest + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(sample))), gain));
+        vst1q_f32(dest + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(sample))), gain));
+    }
 #endif
-        
-        sample0l = ((int16_t *) volume)[sample0l] >> 8;
-        sample0h = ((int16_t *) volume)[sample0h];
-        *output++ = (int16_t) (sample0l + sample0h + 128);
-    } while (--count > 0);
+
+    for (; i < count; i++)
+        dest[i] = (float) input[i] * gain;
 }
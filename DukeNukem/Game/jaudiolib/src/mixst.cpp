@@ -28,147 +28,107 @@
  rate = resampling increment
  start = sound data
  length = count of samples to mix
+ last = index of the final sample in start
+ dest = float samples at 16 bit scale, left and right interleaved
  */
 
-// 8-bit stereo source, 16-bit mono output
-void MV_Mix16BitMono8Stereo(uint32_t position, uint32_t rate, const char *start, uint32_t length)
+// 8-bit stereo source
+uint32_t MV_Resample8BitStereo(float *dest, const char *start, uint32_t position, uint32_t rate, uint32_t last, uint32_t length)
 {
-    uint8_t const * const source = (uint8_t *) start;
-    int16_t *dest = (int16_t *) MV_MixDestination;
-    int32_t sample0, sample1;
-    
-    while (length--) {
-        sample0 = source[(position >> 16) << 1];
-        sample1 = source[((position >> 16) << 1) + 1];
+    uint8_t const * const source = (uint8_t const *) start;
+    uint32_t interpolated = MV_InterpolatedFrames(position, rate, last, length);
+
+    length -= interpolated;
+
+#ifdef MV_MIX_X86
+    __m128i pos = _mm_setr_epi32((int) position, (int) position, (int) (position + rate), (int) (position + rate));
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const bias = _mm_set1_epi32(128);
+
+    for (; interpolated >= 2; interpolated -= 2) {
+        // two frames and the ones after them, L0 R0 L1 R1 for each
+        __m128i const frames = _mm_unpacklo_epi8(_mm_setr_epi32(MV_Load32(source + ((position >> 16) << 1)),
+                                                                MV_Load32(source + (((position + rate) >> 16) << 1)), 0, 0), zero);
+        __m128i const first = _mm_unpacklo_epi16(_mm_shuffle_epi32(frames, _MM_SHUFFLE(2, 0, 2, 0)), zero);
+        __m128i const second = _mm_unpacklo_epi16(_mm_shuffle_epi32(frames, _MM_SHUFFLE(3, 1, 3, 1)), zero);
+
+        _mm_storeu_ps(dest, MV_Interpolate(_mm_slli_epi32(_mm_sub_epi32(first, bias), 8), _mm_slli_epi32(_mm_sub_epi32(second, bias), 8), pos));
+        dest += 4;
+        position += rate * 2;
+        pos = _mm_add_epi32(pos, _mm_set1_epi32((int) (rate * 2)));
+    }
+#endif
+
+    while (interpolated--) {
+        uint32_t const index = (position >> 16) << 1;
+        int32_t const frac = (position & 0xffff) >> 1;
+        int32_t const sample0 = MV_Sample8(source, index);
+        int32_t const sample1 = MV_Sample8(source, index + 1);
+
+        dest[0] = (float) (sample0 + ((MV_Sample8(source, index + 2) - sample0) * frac >> 15));
+        dest[1] = (float) (sample1 + ((MV_Sample8(source, index + 3) - sample1) * frac >> 15));
+        dest += 2;
         position += rate;
-        
-        sample0 = (MV_LeftVolume[sample0] + MV_LeftVolume[sample1]) / 2 + *dest;
-        if (sample0 < -32768) sample0 = -32768;
-        else if (sample0 > 32767) sample0 = 32767;
-        
-        *dest = (int16_t) sample0;
-        
-        dest += MV_SampleSize / 2;
     }
-    
-    MV_MixPosition = position;
-    MV_MixDestination = (char *) dest;
-}
 
-// 8-bit stereo source, 16-bit stereo output
-void MV_Mix16BitStereo8Stereo(uint32_t position, uint32_t rate, const char *start, uint32_t length)
-{
-    uint8_t const * const source = (uint8_t *) start;
-    int16_t *dest = (int16_t *) MV_MixDestination;
-    int32_t sample0, sample1;
-    
     while (length--) {
-        sample0 = source[(position >> 16) << 1];
-        sample1 = source[((position >> 16) << 1) + 1];
+        uint32_t const index = (position >> 16) << 1;
+
+        dest[0] = (float) MV_Sample8(source, index);
+        dest[1] = (float) MV_Sample8(source, index + 1);
+        dest += 2;
         position += rate;
-        
-        sample0 = MV_LeftVolume[sample0] + *dest;
-        sample1 = MV_RightVolume[sample1] + *(dest + MV_RightChannelOffset / 2);
-        if (sample0 < -32768) sample0 = -32768;
-        else if (sample0 > 32767) sample0 = 32767;
-        if (sample1 < -32768) sample1 = -32768;
-        else if (sample1 > 32767) sample1 = 32767;
-        
-        *dest = (int16_t) sample0;
-        *(dest + MV_RightChannelOffset/2) = (int16_t) sample1;
-        
-        dest += MV_SampleSize / 2;
     }
-    
-    MV_MixPosition = position;
-    MV_MixDestination = (char *) dest;
+
+    return position;
 }
 
-// 16-bit stereo source, 16-bit mono output
-void MV_Mix16BitMono16Stereo(uint32_t position, uint32_t rate, const char *start, uint32_t length)
+// 16-bit stereo source
+uint32_t MV_Resample16BitStereo(float *dest, const char *start, uint32_t position, uint32_t rate, uint32_t last, uint32_t length)
 {
-    uint16_t const * const source = (uint16_t *) start;
-    int16_t *dest = (int16_t *) MV_MixDestination;
-    int32_t sample0l, sample0h, sample0;
-    int32_t sample1l, sample1h, sample1;
-    
-    while (length--) {
-        sample0 = source[(position >> 16) << 1];
-        sample1 = source[((position >> 16) << 1) + 1];
-#ifdef BIGENDIAN
-        sample0l = sample0 >> 8;
-        sample0h = (sample0 & 255) ^ 128;
-        sample1l = sample1 >> 8;
-        sample1h = (sample1 & 255) ^ 128;
-#else
-        sample0l = sample0 & 255;
-        sample0h = (sample0 >> 8) ^ 128;
-        sample1l = sample1 & 255;
-        sample1h = (sample1 >> 8) ^ 128;
+    uint16_t const * const source = (uint16_t const *) start;
+    uint32_t interpolated = MV_InterpolatedFrames(position, rate, last, length);
+
+    length -= interpolated;
+
+#ifdef MV_MIX_X86
+    __m128i pos = _mm_setr_epi32((int) position, (int) position, (int) (position + rate), (int) (position + rate));
+
+    for (; interpolated >= 2; interpolated -= 2) {
+        // two frames and the ones after them, L0 R0 L1 R1 for each
+        __m128i const frames = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i const *) (source + ((position >> 16) << 1))),
+                                                  _mm_loadl_epi64((__m128i const *) (source + (((position + rate) >> 16) << 1))));
+        __m128i const first = _mm_shuffle_epi32(frames, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128i const second = _mm_shuffle_epi32(frames, _MM_SHUFFLE(3, 1, 3, 1));
+
+        _mm_storeu_ps(dest, MV_Interpolate(_mm_srai_epi32(_mm_unpacklo_epi16(first, first), 16),
+                                           _mm_srai_epi32(_mm_unpacklo_epi16(second, second), 16), pos));
+        dest += 4;
+        position += rate * 2;
+        pos = _mm_add_epi32(pos, _mm_set1_epi32((int) (rate * 2)));
+    }
 #endif
+
+    while (interpolated--) {
+        uint32_t const index = (position >> 16) << 1;
+        int32_t const frac = (position & 0xffff) >> 1;
+        int32_t const sample0 = MV_Sample16(source, index);
+        int32_t const sample1 = MV_Sample16(source, index + 1);
+
+        dest[0] = (float) (sample0 + ((MV_Sample16(source, index + 2) - sample0) * frac >> 15));
+        dest[1] = (float) (sample1 + ((MV_Sample16(source, index + 3) - sample1) * frac >> 15));
+        dest += 2;
         position += rate;
-        
-        sample0l = MV_LeftVolume[sample0l] >> 8;
-        sample0h = MV_LeftVolume[sample0h];
-        sample0 = sample0l + sample0h + 128;
-        sample1l = MV_LeftVolume[sample1l] >> 8;
-        sample1h = MV_LeftVolume[sample1h];
-        sample1 = sample1l + sample1h + 128;
-        
-        sample0 = (sample0 + sample1) / 2 + *dest;
-        if (sample0 < -32768) sample0 = -32768;
-        else if (sample0 > 32767) sample0 = 32767;
-        
-        *dest = (int16_t) sample0;
-        
-        dest += MV_SampleSize / 2;
     }
-    
-    MV_MixPosition = position;
-    MV_MixDestination = (char *) dest;
-}
 
-// 16-bit stereo source, 16-bit stereo output
-void MV_Mix16BitStereo16Stereo(uint32_t position, uint32_t rate, const char *start, uint32_t length)
-{
-    uint16_t const * const source = (uint16_t *) start;
-    int16_t *dest = (int16_t *) MV_MixDestination;
-    int32_t sample0l, sample0h, sample0;
-    int32_t sample1l, sample1h, sample1;
-    
     while (length--) {
-        sample0 = source[(position >> 16) << 1];
-        sample1 = source[((position >> 16) << 1) + 1];
-#ifdef BIGENDIAN
-        sample0l = sample0 >> 8;
-        sample0h = (sample0 & 255) ^ 128;
-        sample1l = sample1 >> 8;
-        sample1h = (sample1 & 255) ^ 128;
-#else
-        sample0l = sample0 & 255;
-        sample0h = (sample0 >> 8) ^ 128;
-        sample1l = sample1 & 255;
-        sample1h = (sample1 >> 8) ^ 128;
-#endif
+        uint32_t const index = (position >> 16) << 1;
+
+        dest[0] = (float) MV_Sample16(source, index);
+        dest[1] = (float) MV_Sample16(source, index + 1);
+        dest += 2;
         position += rate;
-        
-        sample0l = MV_LeftVolume[sample0l] >> 8;
-        sample0h = MV_LeftVolume[sample0h];
-        sample1l = MV_RightVolume[sample1l] >> 8;
-        sample1h = MV_RightVolume[sample1h];
-        sample0 = sample0l + sample0h + 128 + *dest;
-        sample1 = sample1l + sample1h + 128 + *(dest + MV_RightChannelOffset/2);
-        if (sample0 < -32768) sample0 = -32768;
-        else if (sample0 > 32767) sample0 = 32767;
-        if (sample1 < -32768) sample1 = -32768;
-        else if (sample1 > 32767) sample1 = 32767;
-        
-        *dest = (int16_t) sample0;
-        *(dest + MV_RightChannelOffset/2) = (int16_t) sample1;
-        
-        dest += MV_SampleSize / 2;
     }
-    
-    MV_MixPosition = position;
-    MV_MixDestination = (char *) dest;
+
+    return position;
 }
@@ -31,6 +31,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
    (c) Copyright 1993 James R. Dose.  All Rights Reserved.
 **********************************************************************/
 
+#include <atomic>  // ahead of compat.h, its min and max macros break some standard headers
 #include "compat.h"
 #include "pragmas.h"
 #include <stdlib.h>
@@ -44,8 +45,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "multivoc.h"
 #include "_multivc.h"
 
-static void MV_Mix(VoiceNode *voice, int32_t buffer);
-static void MV_StopVoice(VoiceNode *voice);
+static void MV_Mix(VoiceNode *voice, float *bus);
+static void MV_RetireVoice(VoiceNode *voice);
 static void MV_ServiceVoc(void);
 
 static VoiceNode *MV_GetVoice(int32_t handle);
@@ -58,9 +59,9 @@ static void MV_CalcPanTable(void);
 
 static int32_t MV_ReverbLevel;
 static int32_t MV_ReverbDelay;
-static int16_t *MV_ReverbTable = NULL;
 
 static int16_t MV_VolumeTable[MV_MAXVOLUME + 1][256];
+static float MV_VolumeGain[MV_MAXVOLUME + 1];
 Pan MV_PanTable[MV_NUMPANPOSITIONS][MV_MAXVOLUME + 1];
 
 int32_t MV_Installed = FALSE;
@@ -81,40 +82,75 @@ int32_t MV_MixRate;
 static int32_t MV_BufferEmpty[MV_NUMBEROFBUFFERS];
 char *MV_MixBuffer[MV_NUMBEROFBUFFERS + 1];
 
+// There are two nodes for every voice. The game thread owns the free ones in VoicePool and the mixer owns the
+// ones in VoiceList, so a voice can start in place of one the game just killed while the mixer still has its node.
 static VoiceNode *MV_Voices = NULL;
+static int32_t MV_NumVoiceNodes;
 
 static volatile VoiceNode VoiceList;
 static volatile VoiceNode VoicePool;
 
+// The game thread's view of the handles, MV_Voices index + 1 of the voice playing on each or 0. Set by the game
+// when it allocates a voice and cleared by whichever side ends it, MV_VoicesActive follows the handles in use.
+static std::atomic<int32_t> *MV_HandleVoice;
+static std::atomic<int32_t> MV_VoicesActive;
+
+// The mixer's view of the same, only touched by whoever runs the command queue.
+static VoiceNode **MV_MixerVoice;
+
+// Last position the mixer saw for each node playing a streamed format, for MV_GetPosition.
+static std::atomic<int32_t> *MV_VoicePosition;
+
+// Nodes the mixer is done with, on their way back to VoicePool. Every node is in it at most once, so it can't fill up.
+static VoiceNode **MV_Retired;
+static std::atomic<uint32_t> MV_RetiredHead, MV_RetiredTail;
+
+/*---------------------------------------------------------------------
+   Everything the game thread does to a playing voice is queued here
+   and run by the mixer at the start of each buffer, so the game never
+   waits on the audio lock. One producer, the game thread, and one
+   consumer, MV_RunCommands, which only runs inside the mixer or with
+   the driver locked.
+---------------------------------------------------------------------*/
+#define MV_COMMANDQUEUESIZE 1024
+
+enum MV_CommandType
+{
+    MV_CMD_PLAY,
+    MV_CMD_KILL,
+    MV_CMD_PAN,
+    MV_CMD_PITCH,
+    MV_CMD_FREQUENCY,
+    MV_CMD_PAUSE,
+    MV_CMD_ENDLOOP,
+    MV_CMD_POSITION,
+    MV_CMD_CALLBACK,
+};
+
+typedef struct
+{
+    int32_t type;
+    int32_t handle;
+    VoiceNode *voice;  // MV_CMD_PLAY, the others look the handle up when they run
+    int32_t arg[3];
+} MV_Command;
+
+static MV_Command MV_Commands[MV_COMMANDQUEUESIZE];
+static std::atomic<uint32_t> MV_CommandHead, MV_CommandTail;
+
 static int32_t MV_MixPage = 0;
 
 void (*MV_Printf)(const char *fmt, ...) = NULL;
 static void (*MV_CallBackFunc)(uint32_t) = NULL;
 
-char *MV_MixDestination;
-const int16_t *MV_LeftVolume;
-const int16_t *MV_RightVolume;
 int32_t MV_SampleSize = 1;
-int32_t MV_RightChannelOffset;
 
-uint32_t MV_MixPosition;
+// voices are added up here at 16 bit scale and saturated into the mix buffer once they're all in
+static float MV_MixBus[MV_MIXBUFFERSIZE * 2];
+static float MV_MixScratch[MV_MIXBUFFERSIZE * 2];
 
 int32_t MV_ErrorCode = MV_NotInstalled;
 
-static int32_t lockdepth = 0;
-
-static inline void DisableInterrupts(void)
-{
-    if (lockdepth++ <= 0)
-        SoundDriver_Lock();
-}
-
-static inline void RestoreInterrupts(void)
-{
-    if (--lockdepth <= 0)
-        SoundDriver_Unlock();
-}
-
 const char *MV_ErrorString(int32_t ErrorNumber)
 {
     switch (ErrorNumber)
@@ -148,7 +184,10 @@ const char *MV_ErrorString(int32_t ErrorNumber)
     }
 }
 
-static void MV_Mix(VoiceNode *voice, int32_t buffer)
+// the volume tables are only kept for their identity now, the bus uses the matching gain
+static inline float MV_GetVolumeGain(const int16_t *table) { return MV_VolumeGain[(table - MV_VolumeTable[0]) >> 8]; }
+
+static void MV_Mix(VoiceNode *voice, float *bus)
 {
     /* cheap fix for a crash under 64-bit linux */
     /*                            v  v  v  v    */
@@ -158,15 +197,8 @@ static void MV_Mix(VoiceNode *voice, int32_t buffer)
     int32_t length = MV_MIXBUFFERSIZE;
     uint32_t FixedPointBufferSize = voice->FixedPointBufferSize;
 
-    MV_MixDestination = MV_MixBuffer[buffer];
-    MV_LeftVolume = voice->LeftVolume;
-    MV_RightVolume = voice->RightVolume;
-
-    if ((MV_Channels == 2) && (IS_QUIET(MV_LeftVolume)))
-    {
-        MV_LeftVolume = MV_RightVolume;
-        MV_MixDestination += MV_RightChannelOffset;
-    }
+    float const LeftGain = MV_GetVolumeGain(voice->LeftVolume);
+    float const RightGain = MV_GetVolumeGain(voice->RightVolume);
 
     // Add this voice to the mix
     while (length > 0)
@@ -192,10 +224,26 @@ static void MV_Mix(VoiceNode *voice, int32_t buffer)
             voclength = length;
 
         if (voice->mix)
-            voice->mix(position, rate, start, voclength);
+        {
+            voice->position = voice->mix(MV_MixScratch, start, position, rate, (voice->length - 1) >> 16, voclength);
 
-        voice->position = MV_MixPosition;
+            // the channel count can change between blocks of a stream, so look at it every time
+            if (voice->channels == 2)
+            {
+                if (MV_Channels == 2)
+                    MV_AddToBus(bus, MV_MixScratch, voclength * 2, LeftGain, RightGain);
+                else
+                    MV_AddStereoToMonoBus(bus, MV_MixScratch, voclength, LeftGain);
+            }
+            else if (MV_Channels == 2)
+                MV_AddMonoToStereoBus(bus, MV_MixScratch, voclength, LeftGain, RightGain);
+            else
+                MV_AddToBus(bus, MV_MixScratch, voclength, LeftGain, LeftGain);
+        }
+        else
+            voice->position = position + rate * voclength;
 
+        bus += voclength * MV_Channels;
         length -= voclength;
 
         if (voice->position >= voice->length)
@@ -213,22 +261,48 @@ static void MV_Mix(VoiceNode *voice, int32_t buffer)
     }
 }
 
-void MV_PlayVoice(VoiceNode *voice)
+static inline int32_t MV_VoiceIndex(VoiceNode const *voice) { return (int32_t)(voice - MV_Voices); }
+
+static void MV_UpdatePosition(VoiceNode *voice)
 {
-    DisableInterrupts();
-    LL_SortedInsertion(&VoiceList, voice, prev, next, VoiceNode, priority);
-    RestoreInterrupts();
+    int32_t position;
+
+    switch (voice->wavetype)
+    {
+#ifdef HAVE_VORBIS
+        case FMT_VORBIS: position = MV_GetVorbisPosition(voice); break;
+#endif
+#ifdef HAVE_FLAC
+        case FMT_FLAC: position = MV_GetFLACPosition(voice); break;
+#endif
+        case FMT_XA: position = MV_GetXAPosition(voice); break;
+        default: return;
+    }
+
+    MV_VoicePosition[MV_VoiceIndex(voice)].store(position, std::memory_order_relaxed);
 }
 
-static void MV_StopVoice(VoiceNode *voice)
+static void MV_SetVoicePosition(VoiceNode *voice, int32_t position)
 {
-    DisableInterrupts();
+    switch (voice->wavetype)
+    {
+#ifdef HAVE_VORBIS
+        case FMT_VORBIS: MV_SetVorbisPosition(voice, position); break;
+#endif
+#ifdef HAVE_FLAC
+        case FMT_FLAC: MV_SetFLACPosition(voice, position); break;
+#endif
+        case FMT_XA: MV_SetXAPosition(voice, position); break;
+        default: return;
+    }
 
-    // move the voice from the play list to the free list
-    LL_Remove(voice, next, prev);
-    LL_Add((VoiceNode*) &VoicePool, voice, next, prev);
+    MV_UpdatePosition(voice);
+}
 
-    RestoreInterrupts();
+// Takes a voice out of the mix and hands its node back to the game thread, mixer side.
+static void MV_RetireVoice(VoiceNode *voice)
+{
+    LL_Remove(voice, next, prev);
 
     switch (voice->wavetype)
     {
@@ -242,39 +316,124 @@ static void MV_StopVoice(VoiceNode *voice)
         default: break;
     }
 
-    voice->handle = 0;
+    int32_t const handle = voice->handle;
+    uint32_t const callbackval = voice->callbackval;
+    int32_t index = MV_VoiceIndex(voice) + 1;
+
+    MV_MixerVoice[handle] = NULL;
+
+    // a voice the game killed has given up its handle already, and it may be playing something else by now
+    if (MV_HandleVoice[handle].compare_exchange_strong(index, 0, std::memory_order_acq_rel))
+        MV_VoicesActive.fetch_sub(1, std::memory_order_release);
+
+    uint32_t const tail = MV_RetiredTail.load(std::memory_order_relaxed);
+
+    MV_Retired[tail % MV_NumVoiceNodes] = voice;
+    MV_RetiredTail.store(tail + 1, std::memory_order_release);
+
+    // killed or not, this is the one callback for the voice, and nothing reads its sound after it
+    if (MV_CallBackFunc)
+        MV_CallBackFunc(callbackval);
+}
+
+static void MV_RunCommands(void)
+{
+    uint32_t head = MV_CommandHead.load(std::memory_order_relaxed);
+    uint32_t const tail = MV_CommandTail.load(std::memory_order_acquire);
+
+    for (; head != tail; head++)
+    {
+        MV_Command const *const cmd = &MV_Commands[head & (MV_COMMANDQUEUESIZE - 1)];
+
+        if (cmd->type == MV_CMD_PLAY)
+        {
+            MV_MixerVoice[cmd->handle] = cmd->voice;
+            LL_SortedInsertion(&VoiceList, cmd->voice, prev, next, VoiceNode, priority);
+            continue;
+        }
+
+        VoiceNode *const voice = MV_MixerVoice[cmd->handle];
+
+        // it ran out before the command got here
+        if (voice == NULL)
+            continue;
+
+        switch (cmd->type)
+        {
+            case MV_CMD_KILL: MV_RetireVoice(voice); break;
+            case MV_CMD_PAN: MV_SetVoiceVolume(voice, cmd->arg[0], cmd->arg[1], cmd->arg[2]); break;
+            case MV_CMD_PITCH: MV_SetVoicePitch(voice, voice->SamplingRate, cmd->arg[0]); break;
+            case MV_CMD_FREQUENCY: MV_SetVoicePitch(voice, cmd->arg[0], 0); break;
+            case MV_CMD_PAUSE: voice->Paused = cmd->arg[0]; break;
+            case MV_CMD_ENDLOOP:
+                voice->LoopCount = 0;
+                voice->LoopStart = NULL;
+                voice->LoopEnd = NULL;
+                break;
+            case MV_CMD_POSITION: MV_SetVoicePosition(voice, cmd->arg[0]); break;
+            case MV_CMD_CALLBACK: voice->callbackval = (uint32_t)cmd->arg[0]; break;
+        }
+    }
+
+    MV_CommandHead.store(head, std::memory_order_release);
+}
+
+static void MV_PostCommand(MV_Command const *cmd)
+{
+    uint32_t const tail = MV_CommandTail.load(std::memory_order_relaxed);
+
+    if (tail - MV_CommandHead.load(std::memory_order_acquire) == MV_COMMANDQUEUESIZE)
+    {
+        // the mixer hasn't run for a while, the device has probably stalled
+        SoundDriver_Lock();
+        MV_RunCommands();
+        SoundDriver_Unlock();
+    }
+
+    MV_Commands[tail & (MV_COMMANDQUEUESIZE - 1)] = *cmd;
+    MV_CommandTail.store(tail + 1, std::memory_order_release);
+}
+
+void MV_PlayVoice(VoiceNode *voice)
+{
+    MV_Command const cmd = { MV_CMD_PLAY, voice->handle, voice, { 0, 0, 0 } };
+    MV_PostCommand(&cmd);
+}
+
+void MV_SyncVoices(void)
+{
+    if (!MV_Installed)
+        return;
+
+    SoundDriver_Lock();
+    MV_RunCommands();
+    SoundDriver_Unlock();
 }
 
 /*---------------------------------------------------------------------
-   JBF: no synchronisation happens inside MV_ServiceVoc nor the
-        supporting functions it calls. This would cause a deadlock
-        between the mixer thread in the driver vs the nested
-        locking in the user-space functions of MultiVoc. The call
-        to MV_ServiceVoc is synchronised in the driver.
+   MV_ServiceVoc runs in the driver's mixer thread with the driver
+   locked. It owns every voice in VoiceList and takes no locks of its
+   own, the game thread reaches those voices through the command queue.
 ---------------------------------------------------------------------*/
 static void MV_ServiceVoc(void)
 {
+    MV_RunCommands();
+
     // Toggle which buffer we'll mix next
     if (++MV_MixPage >= MV_NumberOfBuffers)
         MV_MixPage -= MV_NumberOfBuffers;
 
+    int32_t const samples = MV_MIXBUFFERSIZE * MV_Channels;
+    int32_t mixed = FALSE;
+
     if (MV_ReverbLevel == 0)
-    {
-        // Initialize buffer
-        //Commented out so that the buffer is always cleared.
-        //This is so the guys at Echo Speech can mix into the
-        //buffer even when no sounds are playing.
-        if (!MV_BufferEmpty[MV_MixPage])
-        {
-            Bmemset(MV_MixBuffer[MV_MixPage], 0, MV_BufferSize);
-            MV_BufferEmpty[ MV_MixPage ] = TRUE;
-        }
-    }
+        Bmemset(MV_MixBus, 0, samples * sizeof(float));
     else
     {
         char const *const end = MV_MixBuffer[0] + MV_BufferLength;
-        char *dest = MV_MixBuffer[MV_MixPage];
+        float *dest = MV_MixBus;
         char const *source = MV_MixBuffer[MV_MixPage] - MV_ReverbDelay;
+        float const gain = MV_VolumeGain[MV_ReverbLevel];
 
         if (source < MV_MixBuffer[ 0 ])
             source += MV_BufferLength;
@@ -285,121 +444,101 @@ static void MV_ServiceVoc(void)
         {
             int const count = (source + length > end) ? (end - source) : length;
 
-            MV_16BitReverb(source, dest, MV_ReverbTable, count / 2);
+            MV_16BitReverb(source, dest, gain, count / 2);
 
             // if we go through the loop again, it means that we've wrapped around the buffer
             source  = MV_MixBuffer[ 0 ];
-            dest   += count;
+            dest   += count / 2;
             length -= count;
         }
+
+        mixed = TRUE;
     }
 
     // Play any waiting voices
-    //DisableInterrupts();
-
-    VoiceNode *voice;
-
-    if (!VoiceList.next || (voice = VoiceList.next) == &VoiceList)
-        return;
-
-    int iter = 0;
-
-    VoiceNode *next;
+    VoiceNode *voice = VoiceList.next;
 
-    do
+    if (voice && voice != &VoiceList)
     {
-        next = voice->next;
+        int iter = 0;
 
-        if (++iter > MV_MaxVoices && MV_Printf)
-            MV_Printf("more iterations than voices! iter: %d\n",iter);
+        VoiceNode *next;
 
-        if (voice->Paused)
-            continue;
+        do
+        {
+            next = voice->next;
 
-        MV_BufferEmpty[ MV_MixPage ] = FALSE;
+            if (++iter > MV_MaxVoices && MV_Printf)
+                MV_Printf("more iterations than voices! iter: %d\n",iter);
 
-        MV_Mix(voice, MV_MixPage);
+            if (voice->Paused)
+                continue;
 
-        // Is this voice done?
-        if (!voice->Playing)
-        {
-            //JBF: prevent a deadlock caused by MV_StopVoice grabbing the mutex again
-            //MV_StopVoice( voice );
-            LL_Remove(voice, next, prev);
-            LL_Add((VoiceNode*) &VoicePool, voice, next, prev);
-
-            switch (voice->wavetype)
-            {
-#ifdef HAVE_VORBIS
-                case FMT_VORBIS: MV_ReleaseVorbisVoice(voice); break;
-#endif
-#ifdef HAVE_FLAC
-                case FMT_FLAC: MV_ReleaseFLACVoice(voice); break;
-#endif
-                case FMT_XA: MV_ReleaseXAVoice(voice); break;
-                default: break;
-            }
+            mixed = TRUE;
 
-            voice->handle = 0;
+            MV_Mix(voice, MV_MixBus);
 
-            if (MV_CallBackFunc)
-                MV_CallBackFunc(voice->callbackval);
+            // Is this voice done?
+            if (!voice->Playing)
+                MV_RetireVoice(voice);
+            else
+                MV_UpdatePosition(voice);
         }
+        while ((voice = next) != &VoiceList);
     }
-    while ((voice = next) != &VoiceList);
 
-    //RestoreInterrupts();
+    // Saturate once for the whole buffer. A page nothing was mixed into only needs clearing the first time.
+    if (mixed)
+    {
+        MV_SaturateBus((int16_t *) MV_MixBuffer[MV_MixPage], MV_MixBus, samples);
+        MV_BufferEmpty[ MV_MixPage ] = FALSE;
+    }
+    else if (!MV_BufferEmpty[MV_MixPage])
+    {
+        Bmemset(MV_MixBuffer[MV_MixPage], 0, MV_BufferSize);
+        MV_BufferEmpty[ MV_MixPage ] = TRUE;
+    }
 }
 
+// The voice playing on a handle as far as the game thread knows, it may have run out in the mixer since.
 static VoiceNode *MV_GetVoice(int32_t handle)
 {
+    if (!MV_Installed)
+        return NULL;
+
     if (handle < MV_MINVOICEHANDLE || handle > MV_MaxVoices)
     {
         if (MV_Printf)
             MV_Printf("MV_GetVoice(): bad handle (%d)!\n", handle);
+        MV_SetErrorCode(MV_VoiceNotFound);
         return NULL;
     }
 
-    DisableInterrupts();
+    int32_t const index = MV_HandleVoice[handle].load(std::memory_order_acquire);
 
-    for (VoiceNode *voice = VoiceList.next; voice != &VoiceList; voice = voice->next)
+    if (index == 0)
     {
-        if (handle == voice->handle)
-        {
-            RestoreInterrupts();
-            return voice;
-        }
+        MV_SetErrorCode(MV_VoiceNotFound);
+        return NULL;
     }
 
-    RestoreInterrupts();
-    MV_SetErrorCode(MV_VoiceNotFound);
-    return NULL;
+    return &MV_Voices[index - 1];
 }
 
-VoiceNode *MV_BeginService(int32_t handle)
+static int32_t MV_PostVoiceCommand(int32_t type, int32_t handle, int32_t arg0, int32_t arg1, int32_t arg2)
 {
-    if (!MV_Installed)
-        return NULL;
-
-    DisableInterrupts();
+    if (MV_GetVoice(handle) == NULL)
+        return MV_Error;
 
-    VoiceNode *voice;
+    MV_Command const cmd = { type, handle, NULL, { arg0, arg1, arg2 } };
+    MV_PostCommand(&cmd);
 
-    if ((voice = MV_GetVoice(handle)) == NULL)
-    {
-        RestoreInterrupts();
-        MV_SetErrorCode(MV_VoiceNotFound);
-        return NULL;
-    }
-
-    return voice;
+    return MV_Ok;
 }
 
-static inline void MV_EndService(void) { RestoreInterrupts(); }
-
 int32_t MV_VoicePlaying(int32_t handle)
 {
-    return (MV_Installed && MV_GetVoice(handle)) ? TRUE : FALSE;
+    return MV_GetVoice(handle) ? TRUE : FALSE;
 }
 
 int32_t MV_KillAllVoices(void)
@@ -407,49 +546,33 @@ int32_t MV_KillAllVoices(void)
     if (!MV_Installed)
         return MV_Error;
 
-    DisableInterrupts();
-
-    if (&VoiceList == VoiceList.next)
-    {
-        RestoreInterrupts();
-        return MV_Ok;
-    }
-
-    VoiceNode * voice = VoiceList.prev;
-
-    // Remove all the voices from the list
-    while (voice != &VoiceList)
+    for (int32_t handle = MV_MINVOICEHANDLE; handle <= MV_MaxVoices; handle++)
     {
-        if (voice->priority == MV_MUSIC_PRIORITY)
-        {
-            voice = voice->prev;
-            continue;
-        }
+        int32_t const index = MV_HandleVoice[handle].load(std::memory_order_acquire);
 
-        MV_Kill(voice->handle);
-        voice = VoiceList.prev;
+        if (index && MV_Voices[index - 1].priority != MV_MUSIC_PRIORITY)
+            MV_Kill(handle);
     }
 
-    RestoreInterrupts();
-
     return MV_Ok;
 }
 
 int32_t MV_Kill(int32_t handle)
 {
-    VoiceNode *voice = MV_BeginService(handle);
-
-    if (voice == NULL)
+    if (MV_GetVoice(handle) == NULL)
         return MV_Error;
 
-    uint32_t const callbackval = voice->callbackval;
+    // the mixer may have just ended it on its own, and then it has made the callback already
+    if (MV_HandleVoice[handle].exchange(0, std::memory_order_acq_rel) == 0)
+    {
+        MV_SetErrorCode(MV_VoiceNotFound);
+        return MV_Error;
+    }
 
-    MV_StopVoice(voice);
+    MV_VoicesActive.fetch_sub(1, std::memory_order_release);
 
-    MV_EndService();
-
-    if (MV_CallBackFunc)
-        MV_CallBackFunc(callbackval);
+    MV_Command const cmd = { MV_CMD_KILL, handle, NULL, { 0, 0, 0 } };
+    MV_PostCommand(&cmd);
 
     return MV_Ok;
 }
@@ -459,48 +582,62 @@ int32_t MV_VoicesPlaying(void)
     if (!MV_Installed)
         return 0;
 
-    DisableInterrupts();
+    return MV_VoicesActive.load(std::memory_order_acquire);
+}
+
+// Puts the nodes the mixer has let go of back in VoicePool.
+static void MV_ReclaimVoices(void)
+{
+    uint32_t head = MV_RetiredHead.load(std::memory_order_relaxed);
+    uint32_t const tail = MV_RetiredTail.load(std::memory_order_acquire);
+
+    for (; head != tail; head++)
+    {
+        VoiceNode *const voice = MV_Retired[head % MV_NumVoiceNodes];
+        LL_Add((VoiceNode*) &VoicePool, voice, next, prev);
+    }
+
+    MV_RetiredHead.store(head, std::memory_order_release);
+}
 
-    int NumVoices = 0;
+static VoiceNode *MV_GetLowestPriorityVoice(void)
+{
+    VoiceNode *lowest = NULL;
 
-    for (VoiceNode *voice = VoiceList.next; voice != &VoiceList; voice = voice->next)
-        NumVoices++;
+    for (int32_t handle = MV_MINVOICEHANDLE; handle <= MV_MaxVoices; handle++)
+    {
+        int32_t const index = MV_HandleVoice[handle].load(std::memory_order_acquire);
 
-    RestoreInterrupts();
+        if (index && (lowest == NULL || MV_Voices[index - 1].priority < lowest->priority))
+            lowest = &MV_Voices[index - 1];
+    }
 
-    return NumVoices;
+    return lowest;
 }
 
 VoiceNode *MV_AllocVoice(int32_t priority)
 {
-    VoiceNode   *voice, *node;
-
-    DisableInterrupts();
+    MV_ReclaimVoices();
 
     // Check if we have any free voices
-    if (LL_Empty(&VoicePool, next, prev))
+    if (MV_VoicesActive.load(std::memory_order_acquire) >= MV_MaxVoices)
     {
         // check if we have a higher priority than a voice that is playing.
-        for (voice = node = VoiceList.next; node != &VoiceList; node = node->next)
-        {
-            if (node->priority < voice->priority)
-                voice = node;
-        }
+        VoiceNode *const voice = MV_GetLowestPriorityVoice();
 
-        if (priority >= voice->priority && voice != &VoiceList && voice->handle >= MV_MINVOICEHANDLE)
+        if (voice && priority >= voice->priority)
             MV_Kill(voice->handle);
 
-        if (LL_Empty(&VoicePool, next, prev))
-        {
-            // No free voices
-            RestoreInterrupts();
+        if (MV_VoicesActive.load(std::memory_order_acquire) >= MV_MaxVoices)
             return NULL;
-        }
     }
 
-    voice = VoicePool.next;
+    // the spare nodes are all still waiting on the mixer
+    if (LL_Empty(&VoicePool, next, prev))
+        return NULL;
+
+    VoiceNode *voice = VoicePool.next;
     LL_Remove(voice, next, prev);
-    RestoreInterrupts();
 
     int32_t vhan = MV_MINVOICEHANDLE;
 
@@ -509,38 +646,35 @@ VoiceNode *MV_AllocVoice(int32_t priority)
     {
         if (++vhan < MV_MINVOICEHANDLE || vhan > MV_MaxVoices)
             vhan = MV_MINVOICEHANDLE;
-    } while (MV_VoicePlaying(vhan));
+    } while (MV_HandleVoice[vhan].load(std::memory_order_relaxed));
 
     voice->handle = vhan;
 
+    MV_VoicePosition[MV_VoiceIndex(voice)].store(0, std::memory_order_relaxed);
+    MV_VoicesActive.fetch_add(1, std::memory_order_relaxed);
+    MV_HandleVoice[vhan].store(MV_VoiceIndex(voice) + 1, std::memory_order_release);
+
     return voice;
 }
 
 int32_t MV_VoiceAvailable(int32_t priority)
 {
-    // Check if we have any free voices
-    if (!LL_Empty(&VoicePool, next, prev))
-        return TRUE;
+    if (!MV_Installed)
+        return FALSE;
 
-    DisableInterrupts();
+    MV_ReclaimVoices();
 
-    VoiceNode   *voice, *node;
+    if (LL_Empty(&VoicePool, next, prev))
+        return FALSE;
 
-    // check if we have a higher priority than a voice that is playing.
-    for (voice = node = VoiceList.next; node != &VoiceList; node = node->next)
-    {
-        if (node->priority < voice->priority)
-            voice = node;
-    }
+    // Check if we have any free voices
+    if (MV_VoicesActive.load(std::memory_order_acquire) < MV_MaxVoices)
+        return TRUE;
 
-    if ((voice == &VoiceList) || (priority < voice->priority))
-    {
-        RestoreInterrupts();
-        return FALSE;
-    }
+    // check if we have a higher priority than a voice that is playing.
+    VoiceNode const *const voice = MV_GetLowestPriorityVoice();
 
-    RestoreInterrupts();
-    return TRUE;
+    return (voice && priority >= voice->priority) ? TRUE : FALSE;
 }
 
 void MV_SetVoicePitch(VoiceNode *voice, uint32_t rate, int32_t pitchoffset)
@@ -556,28 +690,12 @@ void MV_SetVoicePitch(VoiceNode *voice, uint32_t rate, int32_t pitchoffset)
 
 int32_t MV_SetPitch(int32_t handle, int32_t pitchoffset)
 {
-    VoiceNode *voice = MV_BeginService(handle);
-
-    if (voice == NULL)
-        return MV_Error;
-
-    MV_SetVoicePitch(voice, voice->SamplingRate, pitchoffset);
-    MV_EndService();
-
-    return MV_Ok;
+    return MV_PostVoiceCommand(MV_CMD_PITCH, handle, pitchoffset, 0, 0);
 }
 
 int32_t MV_SetFrequency(int32_t handle, int32_t frequency)
 {
-    VoiceNode *voice = MV_BeginService(handle);
-
-    if (voice == NULL)
-        return MV_Error;
-
-    MV_SetVoicePitch(voice, frequency, 0);
-    MV_EndService();
-
-    return MV_Ok;
+    return MV_PostVoiceCommand(MV_CMD_FREQUENCY, handle, frequency, 0, 0);
 }
 
 static inline const int16_t *MV_GetVolumeTable(int32_t vol) { return MV_VolumeTable[MIX_VOLUME(vol)]; }
@@ -585,67 +703,46 @@ static inline const int16_t *MV_GetVolumeTable(int32_t vol) { return MV_VolumeTa
 /*---------------------------------------------------------------------
    Function: MV_SetVoiceMixMode
 
-   Selects which method should be used to mix the voice.
-
-   16Bit        16Bit |  8Bit  16Bit  8Bit  16Bit |
-   Mono         Ster  |  Mono  Mono   Ster  Ster  |  Mixer
-   Out          Out   |  In    In     In    In    |
-----------------------+---------------------------+-------------
-    X                 |         X                 | Mix16BitMono16
-    X                 |   X                       | Mix16BitMono
-                 X    |         X                 | Mix16BitStereo16
-                 X    |   X                       | Mix16BitStereo
-----------------------+---------------------------+-------------
-                 X    |                      X    | Mix16BitStereo16Stereo
-                 X    |                X          | Mix16BitStereo8Stereo
-    X                 |                      X    | Mix16BitMono16Stereo
-    X                 |                X          | Mix16BitMono8Stereo
+   Selects which method should be used to resample the voice. The
+   resampled block is added to the mono or stereo bus by MV_Mix, so
+   only the source format matters here.
+
+   8Bit  16Bit  8Bit  16Bit |
+   Mono  Mono   Ster  Ster  |  Resampler
+   In    In     In    In    |
+----------------------------+-------------------
+    X                       | Resample8BitMono
+          X                 | Resample16BitMono
+                X           | Resample8BitStereo
+                      X     | Resample16BitStereo
 ---------------------------------------------------------------------*/
 
 void MV_SetVoiceMixMode(VoiceNode *voice)
 {
     int32_t type = T_DEFAULT;
 
-    if (MV_Channels == 1)
-        type |= T_MONO;
-    else
-    {
-        if (IS_QUIET(voice->RightVolume))
-            type |= T_RIGHTQUIET;
-        else if (IS_QUIET(voice->LeftVolume))
-            type |= T_LEFTQUIET;
-    }
-
     if (voice->bits == 16)
         type |= T_16BITSOURCE;
 
     if (voice->channels == 2)
-    {
         type |= T_STEREOSOURCE;
-        type &= ~(T_RIGHTQUIET | T_LEFTQUIET);
+
+    // a voice that can't be heard only has to keep its place, MV_Mix steps it along without a mixer
+    if (IS_QUIET(voice->LeftVolume) && IS_QUIET(voice->RightVolume))
+    {
+        voice->mix = NULL;
+        return;
     }
 
     switch (type)
     {
-        case T_16BITSOURCE | T_LEFTQUIET: MV_LeftVolume = MV_RightVolume;
-        case T_16BITSOURCE | T_MONO:
-        case T_16BITSOURCE | T_RIGHTQUIET: voice->mix = MV_Mix16BitMono16; break;
+        case T_DEFAULT: voice->mix = MV_Resample8BitMono; break;
 
-        case T_LEFTQUIET: MV_LeftVolume = MV_RightVolume;
-        case T_MONO:
-        case T_RIGHTQUIET: voice->mix = MV_Mix16BitMono; break;
+        case T_16BITSOURCE: voice->mix = MV_Resample16BitMono; break;
 
-        case T_16BITSOURCE: voice->mix = MV_Mix16BitStereo16; break;
+        case T_STEREOSOURCE: voice->mix = MV_Resample8BitStereo; break;
 
-        case T_SIXTEENBIT_STEREO: voice->mix = MV_Mix16BitStereo; break;
-
-        case T_16BITSOURCE | T_STEREOSOURCE: voice->mix = MV_Mix16BitStereo16Stereo; break;
-
-        case T_16BITSOURCE | T_STEREOSOURCE | T_MONO: voice->mix = MV_Mix16BitMono16Stereo; break;
-
-        case T_STEREOSOURCE: voice->mix = MV_Mix16BitStereo8Stereo; break;
-
-        case T_STEREOSOURCE | T_MONO: voice->mix = MV_Mix16BitMono8Stereo; break;
+        case T_16BITSOURCE | T_STEREOSOURCE: voice->mix = MV_Resample16BitStereo; break;
 
         default: voice->mix = NULL; break;
     }
@@ -673,91 +770,41 @@ void MV_SetVoiceVolume(VoiceNode *voice, int32_t vol, int32_t left, int32_t righ
 
 int32_t MV_PauseVoice(int32_t handle, int32_t pause)
 {
-    VoiceNode *voice = MV_BeginService(handle);
-
-    if (voice == NULL)
-        return MV_Error;
-
-    voice->Paused = pause;
-    MV_EndService();
-
-    return MV_Ok;
+    return MV_PostVoiceCommand(MV_CMD_PAUSE, handle, pause, 0, 0);
 }
 
+// For streamed formats, as of the last buffer the mixer finished.
 int32_t MV_GetPosition(int32_t handle, int32_t *position)
 {
-    VoiceNode *voice = MV_BeginService(handle);
+    VoiceNode const *const voice = MV_GetVoice(handle);
 
     if (voice == NULL)
         return MV_Error;
 
     switch (voice->wavetype)
     {
-#ifdef HAVE_VORBIS
-        case FMT_VORBIS: *position = MV_GetVorbisPosition(voice); break;
-#endif
-#ifdef HAVE_FLAC
-        case FMT_FLAC: *position = MV_GetFLACPosition(voice); break;
-#endif
-        case FMT_XA: *position = MV_GetXAPosition(voice); break;
+        case FMT_VORBIS:
+        case FMT_FLAC:
+        case FMT_XA: *position = MV_VoicePosition[MV_VoiceIndex(voice)].load(std::memory_order_relaxed); break;
         default: break;
     }
 
-    MV_EndService();
-
     return MV_Ok;
 }
 
 int32_t MV_SetPosition(int32_t handle, int32_t position)
 {
-    VoiceNode *voice = MV_BeginService(handle);
-
-    if (voice == NULL)
-        return MV_Error;
-
-    switch (voice->wavetype)
-    {
-#ifdef HAVE_VORBIS
-        case FMT_VORBIS: MV_SetVorbisPosition(voice, position); break;
-#endif
-#ifdef HAVE_FLAC
-        case FMT_FLAC: MV_SetFLACPosition(voice, position); break;
-#endif
-        case FMT_XA: MV_SetXAPosition(voice, position); break;
-        default: break;
-    }
-
-    MV_EndService();
-
-    return MV_Ok;
+    return MV_PostVoiceCommand(MV_CMD_POSITION, handle, position, 0, 0);
 }
 
 int32_t MV_EndLooping(int32_t handle)
 {
-    VoiceNode *voice = MV_BeginService(handle);
-
-    if (voice == NULL)
-        return MV_Error;
-
-    voice->LoopCount = 0;
-    voice->LoopStart = NULL;
-    voice->LoopEnd = NULL;
-
-    MV_EndService();
-
-    return MV_Ok;
+    return MV_PostVoiceCommand(MV_CMD_ENDLOOP, handle, 0, 0, 0);
 }
 
 int32_t MV_SetPan(int32_t handle, int32_t vol, int32_t left, int32_t right)
 {
-    VoiceNode *voice = MV_BeginService(handle);
-
-    if (voice == NULL)
-        return MV_Error;
-
-    MV_SetVoiceVolume(voice, vol, left, right);
-    MV_EndService();
-    return MV_Ok;
+    return MV_PostVoiceCommand(MV_CMD_PAN, handle, vol, left, right);
 }
 
 int32_t MV_Pan3D(int32_t handle, int32_t angle, int32_t distance)
@@ -780,7 +827,6 @@ int32_t MV_Pan3D(int32_t handle, int32_t angle, int32_t distance)
 void MV_SetReverb(int32_t reverb)
 {
     MV_ReverbLevel = MIX_VOLUME(reverb);
-    MV_ReverbTable = &MV_VolumeTable[MV_ReverbLevel][0];
 }
 
 int32_t MV_GetMaxReverbDelay(void) { return MV_MIXBUFFERSIZE * MV_NumberOfBuffers; }
@@ -804,8 +850,6 @@ static int32_t MV_SetMixMode(int32_t numchannels)
     MV_NumberOfBuffers = MV_TOTALBUFFERSIZE / MV_BufferSize;
     MV_BufferLength = MV_TOTALBUFFERSIZE;
 
-    MV_RightChannelOffset = MV_SampleSize >> 1;
-
     return MV_Ok;
 }
 
@@ -832,22 +876,15 @@ static void MV_StopPlayback(void)
 {
     SoundDriver_StopPlayback();
 
-    // Make sure all callbacks are done.
-    DisableInterrupts();
+    // The mixer won't run again. Finish what was queued for it and make sure all callbacks are done.
+    SoundDriver_Lock();
 
-    VoiceNode *voice, *next;
+    MV_RunCommands();
 
-    for (voice = VoiceList.next; voice != &VoiceList; voice = next)
-    {
-        next = voice->next;
-
-        MV_StopVoice(voice);
-
-        if (MV_CallBackFunc)
-            MV_CallBackFunc(voice->callbackval);
-    }
+    while (VoiceList.next != &VoiceList)
+        MV_RetireVoice(VoiceList.next);
 
-    RestoreInterrupts();
+    SoundDriver_Unlock();
 }
 
 static void MV_CalcVolume(int32_t MaxVolume)
@@ -861,6 +898,8 @@ static void MV_CalcVolume(int32_t MaxVolume)
 
         for (int i = 0; i < 65536; i += 256)
             MV_VolumeTable[volume][i / 256] = ((i - 0x8000) * level) / MV_MAXVOLUME;
+
+        MV_VolumeGain[volume] = (float) level / MV_MAXVOLUME;
     }
 }
 
@@ -906,6 +945,19 @@ void MV_SetReverseStereo(int32_t setting) { MV_ReverseStereo = setting; }
 
 int32_t MV_GetReverseStereo(void) { return MV_ReverseStereo; }
 
+static void MV_FreeVoices(void)
+{
+    ALIGNED_FREE_AND_NULL(MV_Voices);
+    DO_FREE_AND_NULL(MV_MixerVoice);
+    DO_FREE_AND_NULL(MV_Retired);
+
+    delete[] MV_HandleVoice;
+    delete[] MV_VoicePosition;
+
+    MV_HandleVoice = NULL;
+    MV_VoicePosition = NULL;
+}
+
 int32_t MV_Init(int32_t soundcard, int32_t MixRate, int32_t Voices, int32_t numchannels, void *initdata)
 {
     if (MV_Installed)
@@ -914,7 +966,9 @@ int32_t MV_Init(int32_t soundcard, int32_t MixRate, int32_t Voices, int32_t numc
     MV_SetErrorCode(MV_Ok);
 
     // MV_TotalMemory + 2: FIXME, see valgrind_errors.log
-    int const totalmem = Voices * sizeof(VoiceNode) + MV_TOTALBUFFERSIZE + 2;
+    MV_NumVoiceNodes = Voices * 2;
+
+    int const totalmem = MV_NumVoiceNodes * sizeof(VoiceNode) + MV_TOTALBUFFERSIZE + 2;
     
     char *ptr = (char *) Xaligned_alloc(16, totalmem);
 
@@ -927,15 +981,26 @@ int32_t MV_Init(int32_t soundcard, int32_t MixRate, int32_t Voices, int32_t numc
     Bmemset(ptr, 0, totalmem);
 
     MV_Voices = (VoiceNode *)ptr;
-    ptr += Voices * sizeof(VoiceNode);
+    ptr += MV_NumVoiceNodes * sizeof(VoiceNode);
 
     // Set number of voices before calculating volume table
     MV_MaxVoices = Voices;
 
+    MV_HandleVoice = new std::atomic<int32_t>[Voices + 1]();
+    MV_VoicePosition = new std::atomic<int32_t>[MV_NumVoiceNodes]();
+    MV_MixerVoice = (VoiceNode **)Xcalloc(Voices + 1, sizeof(VoiceNode *));
+    MV_Retired = (VoiceNode **)Xcalloc(MV_NumVoiceNodes, sizeof(VoiceNode *));
+
+    MV_VoicesActive.store(0, std::memory_order_relaxed);
+    MV_CommandHead.store(0, std::memory_order_relaxed);
+    MV_CommandTail.store(0, std::memory_order_relaxed);
+    MV_RetiredHead.store(0, std::memory_order_relaxed);
+    MV_RetiredTail.store(0, std::memory_order_relaxed);
+
     LL_Reset((VoiceNode*) &VoiceList, next, prev);
     LL_Reset((VoiceNode*) &VoicePool, next, prev);
 
-    for (int index = 0; index < Voices; index++)
+    for (int index = 0; index < MV_NumVoiceNodes; index++)
     {
         LL_Add((VoiceNode*) &VoicePool, &MV_Voices[ index ], next, prev);
     }
@@ -951,7 +1016,7 @@ int32_t MV_Init(int32_t soundcard, int32_t MixRate, int32_t Voices, int32_t numc
 
     if (MV_ErrorCode != MV_Ok)
     {
-        ALIGNED_FREE_AND_NULL(MV_Voices);
+        MV_FreeVoices();
 
         return MV_Error;
     }
@@ -959,7 +1024,6 @@ int32_t MV_Init(int32_t soundcard, int32_t MixRate, int32_t Voices, int32_t numc
     MV_Installed    = TRUE;
     MV_CallBackFunc = NULL;
     MV_ReverbLevel  = 0;
-    MV_ReverbTable  = NULL;
 
     // Set the sampling rate
     MV_MixRate = MixRate;
@@ -1010,7 +1074,7 @@ int32_t MV_Shutdown(void)
     SoundDriver_Shutdown();
 
     // Free any voices we allocated
-    ALIGNED_FREE_AND_NULL(MV_Voices);
+    MV_FreeVoices();
 
     LL_Reset((VoiceNode*) &VoiceList, next, prev);
     LL_Reset((VoiceNode*) &VoicePool, next, prev);
@@ -1028,16 +1092,7 @@ int32_t MV_Shutdown(void)
 
 int32_t MV_SetVoiceCallback(int32_t handle, uint32_t callbackval)
 {
-    VoiceNode *voice = MV_BeginService(handle);
-
-    if (voice == NULL)
-        return MV_Error;
-
-    voice->callbackval = callbackval;
-
-    MV_EndService();
-
-    return MV_Ok;
+    return MV_PostVoiceCommand(MV_CMD_CALLBACK, handle, (int32_t)callbackval, 0, 0);
 }
 
 void MV_SetPrintf(void (*function)(const char *, ...)) { MV_Printf = function; }
@@ -116,6 +116,9 @@ const char *MV_ErrorString(int32_t ErrorNumber);
 int32_t MV_VoicePlaying(int32_t handle);
 int32_t MV_KillAllVoices(void);
 int32_t MV_Kill(int32_t handle);
+// Voice changes are queued for the mixer, this waits until it has run them. Memory a killed voice played from can
+// be freed after it.
+void MV_SyncVoices(void);
 int32_t MV_VoicesPlaying(void);
 int32_t MV_VoiceAvailable(int32_t priority);
 int32_t MV_SetPitch(int32_t handle, int32_t pitchoffset);
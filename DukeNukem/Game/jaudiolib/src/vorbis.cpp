@@ -473,11 +473,127 @@ void MV_ReleaseVorbisVoice( VoiceNode * voice )
 
     voice->rawdataptr = 0;
 }
+
+
+/*---------------------------------------------------------------------
+Function: MV_DecodeVorbis
+
+Decodes a whole OggVorbis sound to 16 bit PCM.
+---------------------------------------------------------------------*/
+
+int32_t MV_DecodeVorbis(char *ptr, uint32_t ptrlength, uint32_t maxlength, char **pcm, uint32_t *pcmlength,
+                        int32_t *rate, int32_t *channels, int32_t *error)
+{
+    *error = 0;
+
+    vorbis_data *vd = (vorbis_data *)calloc(1, sizeof(vorbis_data));
+
+    if (!vd)
+        return MV_Error;
+
+    vd->ptr = ptr;
+    vd->pos = 0;
+    vd->length = ptrlength;
+    vd->lastbitstream = -1;
+
+    int32_t const openstatus = ov_open_callbacks((void *)vd, &vd->vf, 0, 0, vorbis_callbacks);
+
+    if (openstatus < 0)
+    {
+        *error = openstatus;
+        free(vd);
+        return MV_Error;
+    }
+
+    vorbis_info *vi = ov_info(&vd->vf, 0);
+
+    // only the loop tags get filled in
+    VoiceNode loops;
+    memset(&loops, 0, sizeof(VoiceNode));
+    MV_GetVorbisCommentLoops(&loops, ov_comment(&vd->vf, 0));
+
+    ogg_int64_t const frames = ov_pcm_total(&vd->vf, -1);
+    char *buffer = NULL;
+    uint32_t bytesread = 0;
+
+    if (!vi || (vi->channels != 1 && vi->channels != 2) || ov_streams(&vd->vf) != 1 || loops.LoopSize > 0 ||
+        frames <= 0 || frames * vi->channels * 2 > (ogg_int64_t)maxlength)
+        goto fail;
+
+    {
+        uint32_t const size = (uint32_t)(frames * vi->channels * 2);
+
+        if ((buffer = (char *)malloc(size)) == NULL)
+            goto fail;
+
+        while (bytesread < size)
+        {
+            int32_t bitstream;
+#ifdef USING_TREMOR
+            int32_t bytes = ov_read(&vd->vf, buffer + bytesread, size - bytesread, &bitstream);
+#else
+            int32_t bytes = ov_read(&vd->vf, buffer + bytesread, size - bytesread, 0, 2, 1, &bitstream);
+#endif
+            if (bytes == OV_HOLE)
+                continue;
+            else if (bytes == 0)
+                break;
+            else if (bytes < 0)
+            {
+                *error = bytes;
+                goto fail;
+            }
+
+            bytesread += bytes;
+        }
+    }
+
+    if (bytesread == 0)
+        goto fail;
+
+#ifdef GEKKO
+    {
+        int16_t *data = (int16_t *)buffer;
+        for (uint32_t i = 0; i < bytesread / 2; ++i)
+            data[i] = (data[i] & 0xff) << 8 | ((data[i] & 0xff00) >> 8);
+    }
+#endif
+
+    *pcm = buffer;
+    *pcmlength = bytesread;
+    *rate = vi->rate;
+    *channels = vi->channels;
+
+    ov_clear(&vd->vf);
+    free(vd);
+    return MV_Ok;
+
+fail:
+    free(buffer);
+    ov_clear(&vd->vf);
+    free(vd);
+    return MV_Error;
+}
 #else
 #include <stdlib.h>
 #include <stdio.h>
 #include "_multivc.h"
 
+int32_t MV_DecodeVorbis(char *ptr, uint32_t ptrlength, uint32_t maxlength, char **pcm, uint32_t *pcmlength,
+                        int32_t *rate, int32_t *channels, int32_t *error)
+{
+    UNREFERENCED_PARAMETER(ptr);
+    UNREFERENCED_PARAMETER(ptrlength);
+    UNREFERENCED_PARAMETER(maxlength);
+    UNREFERENCED_PARAMETER(pcm);
+    UNREFERENCED_PARAMETER(pcmlength);
+    UNREFERENCED_PARAMETER(rate);
+    UNREFERENCED_PARAMETER(channels);
+
+    *error = 0;
+    return MV_Error;
+}
+
 int32_t MV_PlayVorbis(char *ptr, uint32_t ptrlength, int32_t loopstart, int32_t loopend, int32_t pitchoffset,
     int32_t vol, int32_t left, int32_t right, int32_t priority, uint32_t callbackval)
 {
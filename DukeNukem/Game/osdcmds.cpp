@@ -25,8 +25,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "menus.h"
 #include "osdfuncs.h"
 #include "demo.h"  // g_firstDemoFile[]
-#include "cheats.h"
+#include "Cheats.h"
 #include "sbar.h"
+#include "actorjobs.h"
+#include "soundcache.h"
 
 #ifdef LUNATIC
 # include "lunatic_game.h"
@@ -371,6 +373,43 @@ static int32_t osdcmd_restartsound(const osdfuncparm_t *parm)
     return OSDCMD_OK;
 }
 
+static int32_t osdcmd_snd_benchmark(const osdfuncparm_t *parm)
+{
+    int32_t voices = 64, buffers = 2000, status;
+    FX_BenchmarkResult result;
+
+    if (parm->numparms > 2)
+        return OSDCMD_SHOWHELP;
+
+    if (parm->numparms >= 1 && (voices = Batol(parm->parms[0])) <= 0)
+        return OSDCMD_SHOWHELP;
+
+    if (parm->numparms == 2 && (buffers = Batol(parm->parms[1])) <= 0)
+        return OSDCMD_SHOWHELP;
+
+    S_SoundShutdown();
+    S_MusicShutdown();
+
+    status = FX_Benchmark(voices, buffers, ud.config.NumChannels, ud.config.MixRate, &result);
+
+    if (status != FX_Ok)
+        OSD_Printf("snd_benchmark: %s\n", FX_ErrorString(FX_Error));
+    else
+        OSD_Printf("snd_benchmark: %d voices, %d buffers in %.2f ms, %.1f voice buffers/ms, %.0f voices in real time\n",
+                   result.voices, result.buffers, result.milliseconds, result.voicesPerMs, result.realtimeVoices);
+
+    S_MusicStartup();
+    S_SoundStartup();
+
+    FX_StopAllSounds();
+    S_ClearSoundLocks();
+
+    if (ud.config.MusicToggle)
+        S_RestartMusic();
+
+    return OSDCMD_OK;
+}
+
 static int32_t osdcmd_music(const osdfuncparm_t *parm)
 {
     if (parm->numparms == 1)
@@ -654,6 +693,23 @@ static int32_t osdcmd_setactorvar(const osdfuncparm_t *parm)
         Gv_SetVar(i, varval, ID, -1);
     return OSDCMD_OK;
 }
+
+static int32_t osdcmd_vm_benchmark(const osdfuncparm_t *parm)
+{
+    int32_t tics;
+
+    if (parm->numparms != 1 || (tics = Batol(parm->parms[0])) <= 0)
+        return OSDCMD_SHOWHELP;
+
+    if (numplayers > 1 || (g_player[myconnectindex].ps->gm & MODE_GAME) == 0)
+    {
+        OSD_Printf("vm_benchmark: needs a single-player game in progress\n");
+        return OSDCMD_OK;
+    }
+
+    G_BenchmarkScripts(tics);
+    return OSDCMD_OK;
+}
 #else
 static int32_t osdcmd_lua(const osdfuncparm_t *parm)
 {
@@ -1412,6 +1468,12 @@ static int32_t osdcmd_cvar_set_game(const osdfuncparm_t *parm)
             r_ambientlightrecip = 256.f;
         else r_ambientlightrecip = 1.f/r_ambientlight;
     }
+#if !defined LUNATIC
+    else if (!Bstrcasecmp(parm->name, "vm_optimize"))
+    {
+        C_OptimizeScript(g_scriptOptimize);
+    }
+#endif
     else if (!Bstrcasecmp(parm->name, "in_mouse"))
     {
         CONTROL_MouseEnabled = (ud.config.UseMouse && CONTROL_MousePresent);
@@ -1645,6 +1707,9 @@ int32_t registerosdcommands(void)
         { "vid_gamma","adjusts gamma component of gamma ramp",(void *)&vid_gamma, CVAR_FLOAT|CVAR_FUNCPTR, 0, 10 },
         { "vid_contrast","adjusts contrast component of gamma ramp",(void *)&vid_contrast, CVAR_FLOAT|CVAR_FUNCPTR, 0, 10 },
         { "vid_brightness","adjusts brightness component of gamma ramp",(void *)&vid_brightness, CVAR_FLOAT|CVAR_FUNCPTR, 0, 10 },
+#if !defined LUNATIC
+        { "vm_optimize","enable/disable the script optimizer's specialized and fused instructions",(void *)&g_scriptOptimize, CVAR_BOOL|CVAR_FUNCPTR, 0, 1 },
+#endif
         { "wchoice","sets weapon autoselection order", (void *)ud.wchoice, CVAR_STRING|CVAR_FUNCPTR, 0, MAX_WEAPONS },
     };
 
@@ -1684,6 +1749,9 @@ int32_t registerosdcommands(void)
     OSD_RegisterFunction("cmenu","cmenu <#>: jumps to menu", osdcmd_cmenu);
     OSD_RegisterFunction("crosshaircolor","crosshaircolor: changes the crosshair color", osdcmd_crosshaircolor);
 
+    G_InitActorJobsOSD();
+    S_InitSoundCacheOSD();
+
     OSD_RegisterFunction("connect","connect: connects to a multiplayer game", osdcmd_connect);
     OSD_RegisterFunction("disconnect","disconnect: disconnects from the local multiplayer game", osdcmd_disconnect);
 
@@ -1728,12 +1796,14 @@ int32_t registerosdcommands(void)
 
     OSD_RegisterFunction("restartmap", "restartmap: restarts the current map", osdcmd_restartmap);
     OSD_RegisterFunction("restartsound","restartsound: reinitializes the sound system",osdcmd_restartsound);
+    OSD_RegisterFunction("snd_benchmark","snd_benchmark [voices] [buffers]: mixes looping voices without a sound device and prints how many one core keeps up with, then reinitializes the sound system",osdcmd_snd_benchmark);
     OSD_RegisterFunction("restartvid","restartvid: reinitializes the video mode",osdcmd_restartvid);
 #if !defined LUNATIC
     OSD_RegisterFunction("addlogvar","addlogvar <gamevar>: prints the value of a gamevar", osdcmd_addlogvar);
     OSD_RegisterFunction("setvar","setvar <gamevar> <value>: sets the value of a gamevar", osdcmd_setvar);
     OSD_RegisterFunction("setvarvar","setvarvar <gamevar1> <gamevar2>: sets the value of <gamevar1> to <gamevar2>", osdcmd_setvar);
     OSD_RegisterFunction("setactorvar","setactorvar <actor#> <gamevar> <value>: sets the value of <actor#>'s <gamevar> to <value>", osdcmd_setactorvar);
+    OSD_RegisterFunction("vm_benchmark","vm_benchmark <tics>: runs the current map for <tics> without drawing, with and without vm_optimize, and prints the time per script instruction", osdcmd_vm_benchmark);
 #else
     OSD_RegisterFunction("lua", "lua \"Lua code...\": runs Lunatic code", osdcmd_lua);
 #endif
@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "anim.h"
 #include "menus.h"
 #include "demo.h"
+#include "soundcache.h"
 
 #ifdef LUNATIC
 # include "lunatic_game.h"
@@ -303,6 +304,7 @@ static void G_PrecacheSounds(void)
     int32_t i, j = 0;
 
     for (i=MAXSOUNDS-1; i>=0; i--)
+    {
         if (g_sounds[i].ptr == 0)
         {
             j++;
@@ -311,6 +313,11 @@ static void G_PrecacheSounds(void)
 
             G_CacheSound(i);
         }
+
+        // Ogg Vorbis and FLAC sounds decode on the job system while the rest of the level loads
+        if (g_sounds[i].ptr != 0)
+            S_PrecacheDecodedSound(i);
+    }
 }
 
 static void G_DoLoadScreen(const char *statustext, int32_t percent)
@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "menus.h"  // menutext
 #include "prlights.h"
 #include "savegame.h"
+#include "clipgrid.h"
 #ifdef LUNATIC
 # include "lunatic_game.h"
 static int32_t g_savedOK;
@@ -1700,6 +1701,9 @@ static void sv_postactordata()
 //        actor[i].lightptr = NULL;
         actor[i].lightId = -1;
     }
+
+    // on load, the sprite lists were read in wholesale
+    clipgrid_invalidate();
 }
 
 static void sv_preanimateptrsave()
@@ -32,6 +32,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "osdfuncs.h"
 #include "demo.h"
 
+#include "../Build/src/Profiler/profiler.h"
+
 #ifdef __ANDROID__
 #include "android.h"
 #endif
@@ -1173,6 +1175,7 @@ void G_DisplayRest(int32_t smoothratio)
 #endif
 
     G_PrintFPS();
+    buildProfiler.DrawOverlay(windowx1+2, windowy1+2+FPS_YOFFSET, COLOR_WHITE);
 
     // JBF 20040124: display level stats in screen corner
     if (ud.overhead_on != 2 && ud.levelstats && VM_OnEvent(EVENT_DISPLAYLEVELSTATS, g_player[myconnectindex].ps->i, myconnectindex) == 0)
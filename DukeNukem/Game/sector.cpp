@@ -2899,6 +2899,72 @@ int32_t A_CheckHitSprite(int32_t i, int16_t *hitsp)
     return FindDistance2D(hit.pos.x-SX,hit.pos.y-SY);
 }
 
+//
+// A_CheckHitSpriteTurned
+//
+// A_CheckHitSprite with the sprite turned by dang, the checkhit of the serial ifcanshoottarget.
+//
+int32_t A_CheckHitSpriteTurned(int32_t i, int32_t dang, int16_t *hitsp, void *data)
+{
+    int32_t dist;
+
+    UNREFERENCED_PARAMETER(data);
+
+    SA += dang;
+    dist = A_CheckHitSprite(i, hitsp);
+    SA -= dang;
+
+    return dist;
+}
+
+//
+// A_CanShootTarget
+//
+// ifcanshoottarget for sprite i, dist away from its player. checkhit(i, dang, hitsp, data) looks like
+// A_CheckHitSprite would with the sprite turned by dang, so the actor read phase can look on its own.
+//
+int32_t A_CanShootTarget(int32_t i, int32_t dist, int32_t (*checkhit)(int32_t, int32_t, int16_t *, void *), void *data)
+{
+    int32_t sclip = 768, angdif = 16, hitdist;
+    int16_t hitsp;
+
+    if (dist <= 1024)
+        return 1;
+
+    if ((hitdist = checkhit(i, 0, &hitsp, data)) == (1<<30))
+        return 1;
+
+    if (A_CheckEnemySprite(&sprite[i]) && sprite[i].xrepeat > 56)
+    {
+        sclip = 3084;
+        angdif = 48;
+    }
+
+#define CHECK(x) if (x >= 0 && sprite[x].picnum == PN) return 0;
+
+    if (hitdist > sclip)
+    {
+        CHECK(hitsp);
+        hitdist = checkhit(i, angdif, &hitsp, data);
+
+        if (hitdist > sclip)
+        {
+            CHECK(hitsp);
+            hitdist = checkhit(i, -angdif, &hitsp, data);
+
+            if (hitdist > 768)
+            {
+                CHECK(hitsp);
+                return 1;
+            }
+        }
+    }
+
+#undef CHECK
+
+    return 1;
+}
+
 static int32_t P_FindWall(DukePlayer_t *p, int16_t *hitw)
 {
     hitdata_t hit;
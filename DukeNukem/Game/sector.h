@@ -114,6 +114,8 @@ void G_ActivateBySector(int32_t sect,int32_t j);
 int32_t S_FindMusicSFX(int32_t sn, int32_t *sndptr);
 int32_t A_CallSound(int32_t sn,int32_t whatsprite);
 int32_t A_CheckHitSprite(int32_t i,int16_t *hitsp);
+int32_t A_CheckHitSpriteTurned(int32_t i, int32_t dang, int16_t *hitsp, void *data);
+int32_t A_CanShootTarget(int32_t i, int32_t dist, int32_t (*checkhit)(int32_t, int32_t, int16_t *, void *), void *data);
 void A_DamageObject(int32_t i,int32_t sn);
 void A_DamageWall(int32_t spr,int32_t dawallnum,const vec3_t *pos,int32_t atwith);
 int32_t __fastcall A_FindPlayer(const spritetype *s,int32_t *d);
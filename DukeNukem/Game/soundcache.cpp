@@ -0,0 +1,371 @@
+// soundcache.cpp
+//
+
+#include "pch.h"
+#include "duke3d.h"
+#include "soundcache.h"
+
+#include <atomic>
+
+#include "../Build/src/Threading/jobsystem.h"
+
+int32_t snd_decodecache = 1;
+int32_t snd_cachesize = 32768;
+soundcachestats_t g_soundCacheStats;
+
+typedef struct
+{
+    char *wav;              // decoded sound, NULL if the sound isn't resident
+    uint32_t wavlength;
+    int32_t srcsize;        // g_sounds[].soundsiz it was decoded from
+    int32_t failedsize;     // g_sounds[].soundsiz of a decode that failed, it isn't tried again
+    int16_t prev, next;     // least recently played order, only valid while wav is set
+    int16_t request;        // request slot + 1 while a decode is in flight
+    int16_t voices;         // voices playing wav that the mixer hasn't retired yet
+} soundcacheentry_t;
+
+typedef struct
+{
+    int32_t busy;
+    int32_t num;
+    char *src;              // copy of the compressed file, the 1D cache can move the original
+    uint32_t srclength;
+    uint32_t maxlength;
+
+    // written by the job
+    char *wav;
+    uint32_t wavlength;
+    int32_t status;
+    int32_t error;          // decoder error code, reported by S_FinishDecodes
+    double ms;
+    std::atomic<int32_t> done;
+} soundcacherequest_t;
+
+static soundcacheentry_t cacheentries[MAXSOUNDS];
+static soundcacherequest_t requests[SOUNDCACHE_MAXPENDING];
+static BuildJobCounter decodeCounter;
+
+// most recently played first
+static int16_t lruhead = -1, lrutail = -1;
+
+static inline uint32_t S_CacheBytes(void)
+{
+    return (uint32_t)snd_cachesize << 10;
+}
+
+static void S_LinkEntry(int32_t num)
+{
+    soundcacheentry_t *const entry = &cacheentries[num];
+
+    entry->prev = -1;
+    entry->next = lruhead;
+
+    if (lruhead >= 0)
+        cacheentries[lruhead].prev = (int16_t)num;
+    else
+        lrutail = (int16_t)num;
+
+    lruhead = (int16_t)num;
+}
+
+static void S_UnlinkEntry(int32_t num)
+{
+    soundcacheentry_t *const entry = &cacheentries[num];
+
+    if (entry->prev >= 0)
+        cacheentries[entry->prev].next = entry->next;
+    else
+        lruhead = entry->next;
+
+    if (entry->next >= 0)
+        cacheentries[entry->next].prev = entry->prev;
+    else
+        lrutail = entry->prev;
+}
+
+static void S_FreeEntry(int32_t num)
+{
+    soundcacheentry_t *const entry = &cacheentries[num];
+
+    S_UnlinkEntry(num);
+
+    g_soundCacheStats.bytes -= entry->wavlength;
+    g_soundCacheStats.entries--;
+
+    DO_FREE_AND_NULL(entry->wav);
+    entry->wavlength = 0;
+}
+
+static void S_DecodeSoundJob(void *data, int begin, int end)
+{
+    soundcacherequest_t *const request = (soundcacherequest_t *)data;
+    double const start = gethiticks();
+
+    UNREFERENCED_PARAMETER(begin);
+    UNREFERENCED_PARAMETER(end);
+
+    request->status = FX_DecodeSound(request->src, request->srclength, request->maxlength, &request->wav,
+                                     &request->wavlength, &request->error);
+    request->ms = gethiticks() - start;
+    request->done.store(1, std::memory_order_release);
+}
+
+//
+// S_FinishDecodes
+//
+static void S_FinishDecodes(void)
+{
+    for (int32_t i = 0; i < SOUNDCACHE_MAXPENDING && g_soundCacheStats.pending > 0; i++)
+    {
+        soundcacherequest_t *const request = &requests[i];
+
+        if (!request->busy || !request->done.load(std::memory_order_acquire))
+            continue;
+
+        int32_t const num = request->num;
+        soundcacheentry_t *const entry = &cacheentries[num];
+
+        g_soundCacheStats.decodems += request->ms;
+
+        if (request->status == FX_Ok)
+        {
+            // a copy decoded from an older file of the same sound has to go first, unless it's still playing
+            if (entry->wav && entry->voices == 0)
+                S_FreeEntry(num);
+
+            if (entry->wav == NULL)
+            {
+                entry->wav = request->wav;
+                entry->wavlength = request->wavlength;
+                entry->srcsize = request->srclength;
+                S_LinkEntry(num);
+
+                g_soundCacheStats.decodes++;
+                g_soundCacheStats.entries++;
+                g_soundCacheStats.bytes += entry->wavlength;
+                g_soundCacheStats.peakbytes = max(g_soundCacheStats.peakbytes, g_soundCacheStats.bytes);
+            }
+            else
+                Bfree(request->wav);
+        }
+        else
+        {
+            // the decoders run on workers and don't print, so their errors get reported here
+            if (request->error)
+                OSD_Printf("S_FinishDecodes: sound %d (%s) failed to decode, error %d\n", num, g_sounds[num].filename,
+                           request->error);
+
+            entry->failedsize = request->srclength;
+            g_soundCacheStats.failures++;
+        }
+
+        DO_FREE_AND_NULL(request->src);
+        request->wav = NULL;
+        request->busy = 0;
+        entry->request = 0;
+        g_soundCacheStats.pending--;
+    }
+}
+
+//
+// S_QueueDecode
+//
+static void S_QueueDecode(int32_t num, int32_t block)
+{
+    soundcacheentry_t *const entry = &cacheentries[num];
+    int32_t const srcsize = g_sounds[num].soundsiz;
+
+    if (entry->request || (entry->wav && entry->srcsize == srcsize) || entry->failedsize == srcsize)
+        return;
+
+    if (g_soundCacheStats.pending == SOUNDCACHE_MAXPENDING)
+    {
+        if (!block)
+            return;
+
+        jobSystem.Wait(&decodeCounter);
+        S_FinishDecodes();
+    }
+
+    int32_t slot = 0;
+
+    while (requests[slot].busy)
+        slot++;
+
+    soundcacherequest_t *const request = &requests[slot];
+
+    request->busy = 1;
+    request->num = num;
+    request->srclength = srcsize;
+    request->src = (char *)Xmalloc(srcsize);
+    request->maxlength = S_CacheBytes() >> SOUNDCACHE_MAXENTRYSHIFT;
+    request->wav = NULL;
+    request->done.store(0, std::memory_order_relaxed);
+    Bmemcpy(request->src, g_sounds[num].ptr, srcsize);
+
+    entry->request = (int16_t)(slot + 1);
+    g_soundCacheStats.pending++;
+
+    if (jobSystem.IsInitialized())
+        jobSystem.Run(S_DecodeSoundJob, request, &decodeCounter);
+    else
+        S_DecodeSoundJob(request, 0, 1);
+}
+
+//
+// S_GetCachedSound
+//
+char *S_GetCachedSound(int32_t num, uint32_t *length)
+{
+    soundcacheentry_t *const entry = &cacheentries[num];
+
+    if (!snd_decodecache || entry->wav == NULL || entry->srcsize != g_sounds[num].soundsiz)
+        return NULL;
+
+    if (lruhead != num)
+    {
+        S_UnlinkEntry(num);
+        S_LinkEntry(num);
+    }
+
+    g_soundCacheStats.hits++;
+
+    *length = entry->wavlength;
+    return entry->wav;
+}
+
+//
+// S_RetainCachedSound
+//
+void S_RetainCachedSound(int32_t num)
+{
+    cacheentries[num].voices++;
+}
+
+//
+// S_ReleaseCachedSound
+//
+void S_ReleaseCachedSound(int32_t num)
+{
+    if (cacheentries[num].voices > 0)
+        cacheentries[num].voices--;
+}
+
+//
+// S_QueueSoundDecode
+//
+void S_QueueSoundDecode(int32_t num)
+{
+    if (!snd_decodecache || g_sounds[num].ptr == NULL || cacheentries[num].failedsize == g_sounds[num].soundsiz ||
+        !FX_IsCompressed(g_sounds[num].ptr, g_sounds[num].soundsiz))
+        return;
+
+    g_soundCacheStats.misses++;
+
+    // without workers this would decode in the middle of the frame, those sounds are only cached at level load
+    if (jobSystem.IsInitialized())
+        S_QueueDecode(num, 0);
+}
+
+//
+// S_PrecacheDecodedSound
+//
+void S_PrecacheDecodedSound(int32_t num)
+{
+    if (!snd_decodecache || g_sounds[num].ptr == NULL || !FX_IsCompressed(g_sounds[num].ptr, g_sounds[num].soundsiz))
+        return;
+
+    S_QueueDecode(num, 1);
+}
+
+//
+// S_UpdateSoundCache
+//
+void S_UpdateSoundCache(void)
+{
+    if (g_soundCacheStats.pending > 0)
+        S_FinishDecodes();
+
+    uint32_t const budget = snd_decodecache ? S_CacheBytes() : 0;
+    int32_t num = lrutail;
+
+    while (g_soundCacheStats.bytes > budget && num >= 0)
+    {
+        int32_t const prev = cacheentries[num].prev;
+
+        if (cacheentries[num].voices == 0)
+        {
+            S_FreeEntry(num);
+            g_soundCacheStats.evictions++;
+        }
+
+        num = prev;
+    }
+}
+
+//
+// S_FlushSoundCache
+//
+void S_FlushSoundCache(void)
+{
+    if (g_soundCacheStats.pending > 0)
+    {
+        if (jobSystem.IsInitialized())
+            jobSystem.Wait(&decodeCounter);
+
+        S_FinishDecodes();
+    }
+
+    while (lruhead >= 0)
+        S_FreeEntry(lruhead);
+
+    for (int32_t i = 0; i < MAXSOUNDS; i++)
+    {
+        cacheentries[i].failedsize = 0;
+        cacheentries[i].voices = 0;
+    }
+}
+
+static int32_t osdcmd_snd_cachestats(const osdfuncparm_t *parm)
+{
+    soundcachestats_t const *const stats = &g_soundCacheStats;
+    uint32_t const plays = stats->hits + stats->misses;
+
+    OSD_Printf("sound cache: %s, %u entries, %u of %d KB (peak %u KB), %u decodes pending\n",
+               snd_decodecache ? "on" : "off", stats->entries, stats->bytes >> 10, snd_cachesize, stats->peakbytes >> 10,
+               stats->pending);
+    OSD_Printf("  plays: %u, hits: %u, misses: %u, hit rate: %.1f%%\n", plays, stats->hits, stats->misses,
+               plays ? 100.0 * stats->hits / plays : 0.0);
+    OSD_Printf("  decodes: %u (%.2f ms average), failed or too large: %u, evictions: %u\n", stats->decodes,
+               stats->decodes ? stats->decodems / stats->decodes : 0.0, stats->failures, stats->evictions);
+
+    if (parm->numparms > 0 && !Bstrcasecmp(parm->parms[0], "reset"))
+    {
+        g_soundCacheStats.hits = g_soundCacheStats.misses = 0;
+        g_soundCacheStats.decodes = g_soundCacheStats.failures = g_soundCacheStats.evictions = 0;
+        g_soundCacheStats.peakbytes = g_soundCacheStats.bytes;
+        g_soundCacheStats.decodems = 0.0;
+    }
+
+    return OSDCMD_OK;
+}
+
+//
+// S_InitSoundCacheOSD
+//
+void S_InitSoundCacheOSD(void)
+{
+    static cvar_t cvar_decodecache =
+        { "snd_decodecache", "play Ogg Vorbis and FLAC sounds from decoded copies: 0: off  1: on", (void *)&snd_decodecache, CVAR_BOOL, 0, 1 };
+
+    static cvar_t cvar_cachesize =
+        { "snd_cachesize", "kilobytes of decoded sounds to keep", (void *)&snd_cachesize, CVAR_INT, 1024, 1048576 };
+
+    if (!OSD_RegisterCvar(&cvar_decodecache))
+        OSD_RegisterFunction(cvar_decodecache.name, cvar_decodecache.desc, osdcmd_cvar_set);
+
+    if (!OSD_RegisterCvar(&cvar_cachesize))
+        OSD_RegisterFunction(cvar_cachesize.name, cvar_cachesize.desc, osdcmd_cvar_set);
+
+    OSD_RegisterFunction("snd_cachestats", "snd_cachestats [reset]: prints decoded sound cache memory use and hit rate", osdcmd_snd_cachestats);
+}
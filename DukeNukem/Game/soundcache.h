@@ -0,0 +1,71 @@
+// soundcache.h
+//
+// Decoded copies of Ogg Vorbis and FLAC sounds. jaudiolib decodes those a block at a time in the mixer callback
+// every time a voice plays them, so sounds fired over and over (weapons, footsteps) get decoded over and over. The
+// first play of one queues a decode of the whole file on the job system, and once that is done the sound plays from
+// a 16 bit WAV in memory instead.
+//
+// Entries are keyed by sound number and the size of the file they were decoded from, so a sound that gets redefined
+// to another file is decoded again. They are kept in least recently played order and evicted down to snd_cachesize,
+// but never while a voice playing the decoded copy is still in the mixer. g_sounds[].num drops as soon as the game
+// thread stops a voice, the mixer only lets go of it on its next pass, so the cache counts the voices itself and
+// S_Cleanup releases them from the mixer callbacks. All of this runs on the game thread except the decodes
+// themselves.
+//
+
+#ifndef soundcache_h_
+#define soundcache_h_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Decodes in flight at once, plays past that just miss until a slot frees up.
+#define SOUNDCACHE_MAXPENDING       64
+
+// A sound that decodes to more than snd_cachesize >> SOUNDCACHE_MAXENTRYSHIFT isn't cached, long speech would only
+// push everything else out.
+#define SOUNDCACHE_MAXENTRYSHIFT    3
+
+typedef struct
+{
+    uint32_t hits, misses;          // plays of compressed sounds from the cache / from the compressed file
+    uint32_t decodes, failures;     // failures include sounds with loop tags and sounds too large to cache
+    uint32_t evictions;
+    uint32_t entries, pending;
+    uint32_t bytes, peakbytes;
+    double decodems;                // job system time spent decoding
+} soundcachestats_t;
+
+extern int32_t snd_decodecache;
+extern int32_t snd_cachesize;       // in kilobytes
+extern soundcachestats_t g_soundCacheStats;
+
+// The decoded sound and its length if num is resident, NULL if it isn't.
+char *S_GetCachedSound(int32_t num, uint32_t *length);
+
+// A voice started playing the decoded copy S_GetCachedSound returned, which stays resident until
+// S_ReleaseCachedSound is called for it once the mixer has retired the voice.
+void S_RetainCachedSound(int32_t num);
+void S_ReleaseCachedSound(int32_t num);
+
+// Counts a miss for a compressed sound that just played from g_sounds[num].ptr and queues a decode of it.
+void S_QueueSoundDecode(int32_t num);
+
+// Queues a decode of g_sounds[num].ptr if it's compressed, for the level load. Without job system workers the
+// decode runs right away.
+void S_PrecacheDecodedSound(int32_t num);
+
+// Moves finished decodes into the cache and evicts down to snd_cachesize, once a frame.
+void S_UpdateSoundCache(void);
+
+// Waits for the decodes in flight and frees everything. No voice may still be playing a cached sound.
+void S_FlushSoundCache(void);
+
+void S_InitSoundCacheOSD(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
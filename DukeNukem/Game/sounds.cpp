@@ -29,9 +29,17 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "pch.h"
 #include "duke3d.h"
 #include "renderlayer.h" // for win_gethwnd()
+#include "soundcache.h"
+#include "demobench.h"
 
 #define DQSIZE 128
 
+// callback values carry the generation of their slot above the sound and instance, see S_FreeSlot, and whether the
+// voice plays the decoded copy from the sound cache
+#define SLOTGEN_SHIFT 16
+#define SLOTID_MASK ((1 << SLOTGEN_SHIFT) - 1)
+#define SLOTCACHED_BIT (1 << 24)
+
 int32_t g_numEnvSoundsPlaying, g_maxSoundPos = 0;
 
 static int32_t MusicIsWaveform = 0;
@@ -42,6 +50,38 @@ static int32_t SoundPaused = 0;
 
 static mutex_t s_mutex;
 static volatile uint32_t dq[DQSIZE], dnum = 0;
+static uint8_t s_slotgen[MAXSOUNDS][MAXSOUNDINSTANCES];
+
+static inline uint32_t S_SlotCallbackVal(int32_t num, int32_t j, int32_t cached)
+{
+    return (cached ? SLOTCACHED_BIT : 0) | ((uint32_t)s_slotgen[num][j] << SLOTGEN_SHIFT) | ((num * MAXSOUNDINSTANCES) + j);
+}
+
+//
+// S_FreeSlot
+//
+// Gives up a voice's slot. The mixer calls back for every voice it retires, even ones the game thread stopped and
+// already freed the slot of, so bumping the generation makes that late callback only drop the sound's lock.
+//
+static void S_FreeSlot(int32_t num, int32_t j)
+{
+    int32_t const i = g_sounds[num].SoundOwner[j].ow;
+
+    if (g_sounds[num].num > 0)
+        g_sounds[num].num--;
+
+    // MUSICANDSFX uses t_data[0] to control restarting the sound
+    // CLEAR_SOUND_T0
+    if (i != -1 && S_IsAmbientSFX(i) && sector[sprite[i].sectnum].lotag < 3)  // ST_2_UNDERWATER
+        actor[i].t_data[0] = 0;
+
+    g_sounds[num].SoundOwner[j].ow = -1;
+    g_sounds[num].SoundOwner[j].voice = 0;
+    g_sounds[num].SoundOwner[j].sndist = UINT32_MAX;
+    g_sounds[num].SoundOwner[j].clock = 0;
+
+    s_slotgen[num][j]++;
+}
 
 void S_SoundStartup(void)
 {
@@ -53,7 +93,8 @@ void S_SoundStartup(void)
 
     initprintf("Initializing sound... ");
 
-    if (FX_Init(ASS_AutoDetect, ud.config.NumVoices, ud.config.NumChannels, ud.config.MixRate, initdata) != FX_Ok)
+    // the demo benchmark runs without a sound device
+    if (FX_Init(Demo_BenchmarkPending() ? ASS_Headless : ASS_AutoDetect, ud.config.NumVoices, ud.config.NumChannels, ud.config.MixRate, initdata) != FX_Ok)
     {
         initprintf("failed! %s\n", FX_ErrorString(FX_Error));
         return;
@@ -95,6 +136,9 @@ void S_SoundShutdown(void)
         Bsprintf(tempbuf, "S_SoundShutdown(): error: %s", FX_ErrorString(FX_Error));
         G_GameExit(tempbuf);
     }
+
+    // every voice is gone, so nothing plays from the decoded copies anymore
+    S_FlushSoundCache();
 }
 
 void S_MusicStartup(void)
@@ -268,6 +312,7 @@ void S_StopMusic(void)
     if (MusicIsWaveform && MusicVoice >= 0)
     {
         FX_StopSound(MusicVoice);
+        FX_SyncVoices();  // MusicPtr is freed below
         MusicVoice = -1;
         MusicIsWaveform = 0;
     }
@@ -314,6 +359,11 @@ void S_Cleanup(void)
             continue;
         }
 
+        uint8_t const gen = (uint8_t)(num >> SLOTGEN_SHIFT);
+        int32_t const cached = num & SLOTCACHED_BIT;
+
+        num &= SLOTID_MASK;
+
         // num + (MAXSOUNDS*MAXSOUNDINSTANCES) is a sound played globally
         // for which there was no open slot to keep track of the voice
         if (num >= (MAXSOUNDS*MAXSOUNDINSTANCES))
@@ -326,24 +376,19 @@ void S_Cleanup(void)
 
         num = (num - j) / MAXSOUNDINSTANCES;
 
-        int32_t i = g_sounds[num].SoundOwner[j].ow;
+        // the mixer is done reading the decoded copy, the cache may evict it now
+        if (cached)
+            S_ReleaseCachedSound(num);
 
         if (EDUKE32_PREDICT_FALSE(g_sounds[num].num > MAXSOUNDINSTANCES))
             OSD_Printf(OSD_ERROR "S_Cleanup(): num exceeds MAXSOUNDINSTANCES! g_sounds[%d].num %d wtf?\n", num, g_sounds[num].num);
 
-        if (g_sounds[num].num > 0)
-            g_sounds[num].num--;
-
-        // MUSICANDSFX uses t_data[0] to control restarting the sound
-        // CLEAR_SOUND_T0
-        if (i != -1 && S_IsAmbientSFX(i) && sector[sprite[i].sectnum].lotag < 3)  // ST_2_UNDERWATER
-            actor[i].t_data[0] = 0;
-
-        g_sounds[num].SoundOwner[j].ow = -1;
-        g_sounds[num].SoundOwner[j].voice = 0;
-        g_sounds[num].SoundOwner[j].sndist = UINT32_MAX;
-        g_sounds[num].SoundOwner[j].clock = 0;
+        // an older generation means the game thread stopped this voice and freed the slot itself,
+        // the slot may have a new voice in it by now
+        if (gen == s_slotgen[num][j])
+            S_FreeSlot(num, j);
 
+        // the sound stays locked until the mixer is done with the voice
         g_soundlocks[num]--;
     }
     while (ldnum--);
@@ -411,10 +456,7 @@ static int32_t S_TakeSlot(int32_t num)
     if (FX_SoundActive(g_sounds[num].SoundOwner[i].voice))
         FX_StopSound(g_sounds[num].SoundOwner[i].voice);
 
-    mutex_lock(&s_mutex);
-    dq[dnum++] = (num * MAXSOUNDINSTANCES) + i;
-    mutex_unlock(&s_mutex);
-    S_Cleanup();
+    S_FreeSlot(num, i);
 
     return i;
 }
@@ -598,7 +640,11 @@ int32_t S_PlaySound3D(int32_t num, int32_t i, const vec3_t *pos)
     if (g_sounds[num].num > 0 && PN != MUSICANDSFX)
         S_StopEnvSound(num, i);
 
-    if (g_sounds[num].ptr == 0)
+    uint32_t soundlength;
+    char *soundptr = S_GetCachedSound(num, &soundlength);
+    int32_t const cached = (soundptr != NULL);
+
+    if (soundptr == NULL && g_sounds[num].ptr == 0)
     {
         if (S_LoadSound(num) == 0)
             return -1;
@@ -610,6 +656,13 @@ int32_t S_PlaySound3D(int32_t num, int32_t i, const vec3_t *pos)
         else g_soundlocks[num]++;
     }
 
+    if (soundptr == NULL)
+    {
+        soundptr = g_sounds[num].ptr;
+        soundlength = g_sounds[num].soundsiz;
+        S_QueueSoundDecode(num);
+    }
+
     j = S_GetSlot(num);
 
     if (j >= MAXSOUNDINSTANCES)
@@ -630,17 +683,17 @@ int32_t S_PlaySound3D(int32_t num, int32_t i, const vec3_t *pos)
 
         if (repeatp && !ambsfxp)
         {
-            voice = FX_PlayLoopedAuto(g_sounds[num].ptr, g_sounds[num].soundsiz, 0, -1,
+            voice = FX_PlayLoopedAuto(soundptr, soundlength, 0, -1,
                                       pitch, FX_VOLUME(sndist>>6), FX_VOLUME(sndist>>6), 0,  // XXX: why is 'right' 0?
-                                      g_sounds[num].pr, (num * MAXSOUNDINSTANCES) + j);
+                                      g_sounds[num].pr, S_SlotCallbackVal(num, j, cached));
         }
         else
         {
             // Ambient MUSICANDSFX always start playing using the 3D routines!
-            voice = FX_PlayAuto3D(g_sounds[num].ptr, g_sounds[num].soundsiz,
+            voice = FX_PlayAuto3D(soundptr, soundlength,
                                   repeatp ? FX_LOOP : FX_ONESHOT,
                                   pitch, sndang>>4, FX_VOLUME(sndist>>6),
-                                  g_sounds[num].pr, (num * MAXSOUNDINSTANCES) + j);
+                                  g_sounds[num].pr, S_SlotCallbackVal(num, j, cached));
         }
     }
 
@@ -650,6 +703,9 @@ int32_t S_PlaySound3D(int32_t num, int32_t i, const vec3_t *pos)
         return -1;
     }
 
+    if (cached)
+        S_RetainCachedSound(num);
+
     g_sounds[num].num++;
     g_sounds[num].SoundOwner[j].ow = i;
     g_sounds[num].SoundOwner[j].voice = voice;
@@ -685,7 +741,11 @@ int32_t S_PlaySound(int32_t num)
 
     pitch = S_GetPitch(num);
 
-    if (g_sounds[num].ptr == NULL && !S_LoadSound(num))
+    uint32_t soundlength;
+    char *soundptr = S_GetCachedSound(num, &soundlength);
+    int32_t const cached = (soundptr != NULL);
+
+    if (soundptr == NULL && g_sounds[num].ptr == NULL && !S_LoadSound(num))
         return -1;
     else
     {
@@ -694,6 +754,13 @@ int32_t S_PlaySound(int32_t num)
         else g_soundlocks[num]++;
     }
 
+    if (soundptr == NULL)
+    {
+        soundptr = g_sounds[num].ptr;
+        soundlength = g_sounds[num].soundsiz;
+        S_QueueSoundDecode(num);
+    }
+
     j = S_GetSlot(num);
 
     if (j >= MAXSOUNDINSTANCES)
@@ -703,13 +770,13 @@ int32_t S_PlaySound(int32_t num)
     }
 
     if (g_sounds[num].m & SF_LOOP)
-        voice = FX_PlayLoopedAuto(g_sounds[num].ptr, g_sounds[num].soundsiz, 0, -1,
+        voice = FX_PlayLoopedAuto(soundptr, soundlength, 0, -1,
                                   pitch,FX_VOLUME(LOUDESTVOLUME), FX_VOLUME(LOUDESTVOLUME), FX_VOLUME(LOUDESTVOLUME),
-                                  g_sounds[num].soundsiz, (num * MAXSOUNDINSTANCES) + j);
+                                  g_sounds[num].soundsiz, S_SlotCallbackVal(num, j, cached));
     else
-        voice = FX_PlayAuto3D(g_sounds[num].ptr, g_sounds[num].soundsiz, FX_ONESHOT,
+        voice = FX_PlayAuto3D(soundptr, soundlength, FX_ONESHOT,
                               pitch, 0, FX_VOLUME(255-LOUDESTVOLUME),
-                              g_sounds[num].pr, (num * MAXSOUNDINSTANCES) + j);
+                              g_sounds[num].pr, S_SlotCallbackVal(num, j, cached));
 
     if (voice <= FX_Ok)
     {
@@ -717,6 +784,9 @@ int32_t S_PlaySound(int32_t num)
         return -1;
     }
 
+    if (cached)
+        S_RetainCachedSound(num);
+
     g_sounds[num].num++;
     g_sounds[num].SoundOwner[j].ow = -1;
     g_sounds[num].SoundOwner[j].voice = voice;
@@ -739,26 +809,22 @@ void S_StopEnvSound(int32_t num, int32_t i)
     if (EDUKE32_PREDICT_FALSE((unsigned)num > (unsigned)g_maxSoundPos) || g_sounds[num].num <= 0)
         return;
 
-    int32_t j;
+    S_Cleanup();
 
-    do
+    // the mixer only retires the voices on its next pass, so free their slots here instead of waiting for that
+    for (int32_t j=0; j<MAXSOUNDINSTANCES; ++j)
     {
-        for (j=0; j<MAXSOUNDINSTANCES; ++j)
+        if ((i == -1 && g_sounds[num].SoundOwner[j].voice > FX_Ok) || (i != -1 && g_sounds[num].SoundOwner[j].ow == i))
         {
-            if ((i == -1 && g_sounds[num].SoundOwner[j].voice > FX_Ok) || (i != -1 && g_sounds[num].SoundOwner[j].ow == i))
+            if (EDUKE32_PREDICT_FALSE(i >= 0 && g_sounds[num].SoundOwner[j].voice <= FX_Ok))
+                initprintf(OSD_ERROR "S_StopEnvSound(): bad voice %d for sound ID %d index %d!\n", g_sounds[num].SoundOwner[j].voice, num, j);
+            else if (g_sounds[num].SoundOwner[j].voice > FX_Ok)
             {
-                if (EDUKE32_PREDICT_FALSE(i >= 0 && g_sounds[num].SoundOwner[j].voice <= FX_Ok))
-                    initprintf(OSD_ERROR "S_StopEnvSound(): bad voice %d for sound ID %d index %d!\n", g_sounds[num].SoundOwner[j].voice, num, j);
-                else if (g_sounds[num].SoundOwner[j].voice > FX_Ok)
-                {
-                    FX_StopSound(g_sounds[num].SoundOwner[j].voice);
-                    S_Cleanup();
-                    break;
-                }
+                FX_StopSound(g_sounds[num].SoundOwner[j].voice);
+                S_FreeSlot(num, j);
             }
         }
     }
-    while (j < MAXSOUNDINSTANCES);
 }
 
 void S_ChangeSoundPitch(int32_t num, int32_t i, int32_t pitchoffset)
@@ -785,6 +851,7 @@ void S_ChangeSoundPitch(int32_t num, int32_t i, int32_t pitchoffset)
 void S_Update(void)
 {
     S_Cleanup();
+    S_UpdateSoundCache();
 
     if ((g_player[myconnectindex].ps->gm & (MODE_GAME|MODE_DEMO)) == 0)
         return;
@@ -849,6 +916,9 @@ void S_ClearSoundLocks(void)
     int32_t i;
     int32_t const msp = g_maxSoundPos;
 
+    // callers have just stopped every sound, let the mixer finish with them before the cache can take their memory
+    FX_SyncVoices();
+
     for (i = 0; i < 11; ++i)
         if (rts_lumplockbyte[i] >= 200)
             rts_lumplockbyte[i] = 199;
@@ -481,6 +481,9 @@ void S_ClearSoundLocks(void)
 {
     int32_t i;
 
+    // callers have just stopped every sound, let the mixer finish with them before the cache can take their memory
+    FX_SyncVoices();
+
     for (i=0; i<MAXSOUNDS; i++)
         if (g_sounds[i].lock >= 200)
             g_sounds[i].lock = 199;
@@ -11,5 +11,7 @@
 #define UNIVERSALWINDOWSAPP 1
 #define HAVE_VORBIS 1
 
+#ifdef _WIN32
 #include <winsock2.h>
+#endif
 #include <stdint.h>
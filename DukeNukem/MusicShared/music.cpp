@@ -54,7 +54,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 int32_t MUSIC_SoundDevice = -1;
 int32_t MUSIC_ErrorCode = MUSIC_Ok;
 
-BYTE RedBookSong[40]; // Referenced by Shadow Warrior, not used.
+uint8_t RedBookSong[40]; // Referenced by Shadow Warrior, not used.
 
 static midifuncs MUSIC_MidiFunctions;
 
@@ -590,7 +590,7 @@ void MUSIC_RegisterTimbreBank
     UNREFERENCED_PARAMETER(timbres);
 }
 
-BYTE playTrack = 0;
+uint8_t playTrack = 0;
 int cdvalid = 0;
 
 void MUSIC_Update(void)
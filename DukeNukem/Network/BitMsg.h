@@ -26,6 +26,10 @@ public:
 
 	void WriteData(byte *data, int length);
 
+	// Variable length unsigned integer, 7 bits per byte.
+	unsigned int ReadVarUInt();
+	void WriteVarUInt(unsigned int var);
+
 	byte *GetBuffer() { return buffer; }
 	int GetLength() { return msglen; }
 	int GetWrittenLength() { return currentposition; }
@@ -80,4 +84,30 @@ __forceinline void BitMsg::WriteData(byte *data, int length)
 {
 	memcpy(&buffer[currentposition], data, length);
 	currentposition += length;
-}
\ No newline at end of file
+}
+
+__forceinline unsigned int BitMsg::ReadVarUInt()
+{
+	unsigned int var = 0;
+	int shift = 0;
+	byte b;
+
+	do
+	{
+		b = buffer[currentposition++];
+		var |= (unsigned int)(b & 0x7f) << shift;
+		shift += 7;
+	} while (b & 0x80);
+
+	return var;
+}
+
+__forceinline void BitMsg::WriteVarUInt(unsigned int var)
+{
+	while (var >= 0x80)
+	{
+		buffer[currentposition++] = (byte)(var | 0x80);
+		var >>= 7;
+	}
+	buffer[currentposition++] = (byte)var;
+}
@@ -0,0 +1,323 @@
+// NetworkCompression.cpp
+//
+
+#include "pch.h"
+
+#include "Build.h"
+#include "baselayer.h"
+#include "lz4.h"
+#include "NetworkCompression.h"
+
+extern "C" void initprintf(const char *f, ...);
+
+// codec byte plus a 7 bit encoded raw length.
+#define NET_HEADER_MAX				6
+
+//
+// WriteHeader
+//
+static int WriteHeader(byte *buffer, int codec, unsigned int rawLength)
+{
+	int position = 0;
+
+	buffer[position++] = (byte)codec;
+	while (rawLength >= 0x80)
+	{
+		buffer[position++] = (byte)(rawLength | 0x80);
+		rawLength >>= 7;
+	}
+	buffer[position++] = (byte)rawLength;
+
+	return position;
+}
+
+//
+// ReadHeader
+//
+static int ReadHeader(const byte *buffer, int length, int *codec, int *rawLength)
+{
+	int position = 0;
+	unsigned int value = 0;
+	int shift = 0;
+
+	if (length < 2)
+		return -1;
+
+	*codec = buffer[position++];
+	while (position < length && position < NET_HEADER_MAX)
+	{
+		byte b = buffer[position++];
+		value |= (unsigned int)(b & 0x7f) << shift;
+		shift += 7;
+		if (!(b & 0x80))
+		{
+			*rawLength = (int)value;
+			return position;
+		}
+	}
+
+	return -1;
+}
+
+NetPacketPool::NetPacketPool()
+{
+	memset(freeList, 0, sizeof(freeList));
+	numAllocated = 0;
+}
+
+NetPacketPool::~NetPacketPool()
+{
+	for (int i = 0; i < NET_PACKET_POOL_BUCKETS; i++)
+	{
+		while (freeList[i] != NULL)
+		{
+			NetPacketBuffer *buffer = freeList[i];
+			freeList[i] = buffer->next;
+			delete[] buffer->data;
+			delete buffer;
+		}
+	}
+}
+
+//
+// NetPacketPool::Alloc
+//
+NetPacketBuffer *NetPacketPool::Alloc(int length)
+{
+	int numFragments = (length + NET_FRAGMENT_PAYLOAD - 1) / NET_FRAGMENT_PAYLOAD;
+	int bucket = 0;
+
+	while ((1 << bucket) < numFragments)
+		bucket++;
+
+	if (bucket < NET_PACKET_POOL_BUCKETS && freeList[bucket] != NULL)
+	{
+		NetPacketBuffer *buffer = freeList[bucket];
+		freeList[bucket] = buffer->next;
+		buffer->next = NULL;
+		return buffer;
+	}
+
+	NetPacketBuffer *buffer = new NetPacketBuffer();
+	buffer->next = NULL;
+	buffer->bucket = (bucket < NET_PACKET_POOL_BUCKETS) ? bucket : -1;
+	buffer->capacity = (bucket < NET_PACKET_POOL_BUCKETS) ? (int)((1 << bucket) * NET_FRAGMENT_PAYLOAD) : length;
+	buffer->data = new byte[buffer->capacity];
+	numAllocated++;
+
+	return buffer;
+}
+
+//
+// NetPacketPool::Free
+//
+void NetPacketPool::Free(NetPacketBuffer *buffer)
+{
+	if (buffer->bucket < 0)
+	{
+		delete[] buffer->data;
+		delete buffer;
+		numAllocated--;
+		return;
+	}
+
+	buffer->next = freeList[buffer->bucket];
+	freeList[buffer->bucket] = buffer;
+}
+
+NetPeerContext::NetPeerContext()
+{
+	memset(&stats, 0, sizeof(stats));
+
+	encodeHistory = new char[NET_STREAM_BUFFER_SIZE];
+	encodePosition = 0;
+	lz4Encoder = LZ4_create(encodeHistory);
+
+	// The decoder always has a full 64k prefix in front of it, so a corrupt match offset stays
+	// inside the buffer.
+	decodeHistory = new char[NET_STREAM_BUFFER_SIZE];
+	memset(decodeHistory, 0, NET_STREAM_HISTORY_SIZE);
+	decodePosition = NET_STREAM_HISTORY_SIZE;
+
+	memset(&deflateStream, 0, sizeof(deflateStream));
+	deflateInit(&deflateStream, Z_BEST_SPEED);
+
+	memset(&inflateStream, 0, sizeof(inflateStream));
+	inflateInit(&inflateStream);
+
+	scratch = NULL;
+	scratchSize = 0;
+}
+
+NetPeerContext::~NetPeerContext()
+{
+	LZ4_free(lz4Encoder);
+	deflateEnd(&deflateStream);
+	inflateEnd(&inflateStream);
+
+	delete[] encodeHistory;
+	delete[] decodeHistory;
+	delete[] scratch;
+}
+
+//
+// NetPeerContext::ReserveScratch
+//
+byte *NetPeerContext::ReserveScratch(int length)
+{
+	if (length > scratchSize)
+	{
+		delete[] scratch;
+		scratchSize = length;
+		scratch = new byte[scratchSize];
+	}
+
+	return scratch;
+}
+
+//
+// NetPeerContext::Encode
+//
+NetPacketBuffer *NetPeerContext::Encode(NetPacketPool &pool, const byte *data, int length, int *encodedLength)
+{
+	double startTime = gethiticks();
+	NetPacketBuffer *buffer;
+	int headerLength;
+	int payloadLength;
+
+	if (length < NET_COMPRESS_MIN_SIZE)
+	{
+		buffer = pool.Alloc(length + NET_HEADER_MAX);
+		headerLength = WriteHeader(buffer->data, NET_CODEC_RAW, length);
+		memcpy(buffer->data + headerLength, data, length);
+		payloadLength = length;
+	}
+	else if (length <= NET_STREAM_MAX_BLOCK)
+	{
+		// The encoder needs every block laid out right after the previous one.
+		if (encodePosition + length > NET_STREAM_BUFFER_SIZE)
+		{
+			encodePosition = (int)(LZ4_slideInputBuffer(lz4Encoder) - encodeHistory);
+		}
+		memcpy(encodeHistory + encodePosition, data, length);
+
+		buffer = pool.Alloc(LZ4_compressBound(length) + NET_HEADER_MAX);
+		headerLength = WriteHeader(buffer->data, NET_CODEC_LZ4STREAM, length);
+		payloadLength = LZ4_compress_continue(lz4Encoder, encodeHistory + encodePosition, (char *)buffer->data + headerLength, length);
+		encodePosition += length;
+	}
+	else
+	{
+		buffer = pool.Alloc((int)deflateBound(&deflateStream, length) + NET_HEADER_MAX);
+		headerLength = WriteHeader(buffer->data, NET_CODEC_ZLIB, length);
+
+		deflateReset(&deflateStream);
+		deflateStream.next_in = (Bytef *)data;
+		deflateStream.avail_in = length;
+		deflateStream.next_out = buffer->data + headerLength;
+		deflateStream.avail_out = buffer->capacity - headerLength;
+		deflate(&deflateStream, Z_FINISH);
+		payloadLength = (int)deflateStream.total_out;
+	}
+
+	*encodedLength = headerLength + payloadLength;
+
+	stats.packetsOut++;
+	stats.rawBytesOut += length;
+	stats.wireBytesOut += *encodedLength;
+	stats.encodeTimeMs += gethiticks() - startTime;
+
+	return buffer;
+}
+
+//
+// NetPeerContext::Decode
+//
+byte *NetPeerContext::Decode(const byte *data, int length, int *decodedLength)
+{
+	double startTime = gethiticks();
+	int codec = NET_CODEC_RAW;
+	int rawLength = 0;
+	byte *output = NULL;
+
+	int headerLength = ReadHeader(data, length, &codec, &rawLength);
+	if (headerLength < 0)
+	{
+		initprintf("NetPeerContext::Decode: malformed packet header\n");
+		return NULL;
+	}
+
+	const byte *payload = data + headerLength;
+	int payloadLength = length - headerLength;
+
+	// The length comes off the wire, so check it against what the encoder would have picked for
+	// that codec before it sizes anything.
+	int maxLength = NET_MAX_PACKET_SIZE;
+	if (codec == NET_CODEC_RAW)
+		maxLength = NET_COMPRESS_MIN_SIZE - 1;
+	else if (codec == NET_CODEC_LZ4STREAM)
+		maxLength = NET_STREAM_MAX_BLOCK;
+
+	if (rawLength <= 0 || rawLength > maxLength)
+	{
+		initprintf("NetPeerContext::Decode: bad packet length %d\n", rawLength);
+		return NULL;
+	}
+
+	switch (codec)
+	{
+		case NET_CODEC_RAW:
+			if (payloadLength != rawLength)
+			{
+				initprintf("NetPeerContext::Decode: raw packet length mismatch\n");
+				return NULL;
+			}
+			output = ReserveScratch(rawLength);
+			memcpy(output, payload, rawLength);
+			break;
+
+		case NET_CODEC_LZ4STREAM:
+			// Keep the last 64k the encoder can refer to right in front of the output.
+			if (decodePosition + rawLength > NET_STREAM_BUFFER_SIZE)
+			{
+				memmove(decodeHistory, decodeHistory + decodePosition - NET_STREAM_HISTORY_SIZE, NET_STREAM_HISTORY_SIZE);
+				decodePosition = NET_STREAM_HISTORY_SIZE;
+			}
+
+			output = (byte *)decodeHistory + decodePosition;
+			if (LZ4_decompress_safe_withPrefix64k((const char *)payload, (char *)output, payloadLength, rawLength) != rawLength)
+			{
+				initprintf("NetPeerContext::Decode: LZ4 stream is corrupt\n");
+				return NULL;
+			}
+			decodePosition += rawLength;
+			break;
+
+		case NET_CODEC_ZLIB:
+			output = ReserveScratch(rawLength);
+			inflateReset(&inflateStream);
+			inflateStream.next_in = (Bytef *)payload;
+			inflateStream.avail_in = payloadLength;
+			inflateStream.next_out = output;
+			inflateStream.avail_out = rawLength;
+			if (inflate(&inflateStream, Z_FINISH) != Z_STREAM_END || inflateStream.avail_out != 0)
+			{
+				initprintf("NetPeerContext::Decode: zlib packet is corrupt\n");
+				return NULL;
+			}
+			break;
+
+		default:
+			initprintf("NetPeerContext::Decode: unknown codec %d\n", codec);
+			return NULL;
+	}
+
+	*decodedLength = rawLength;
+
+	stats.packetsIn++;
+	stats.rawBytesIn += rawLength;
+	stats.wireBytesIn += length;
+	stats.decodeTimeMs += gethiticks() - startTime;
+
+	return output;
+}
@@ -0,0 +1,112 @@
+// NetworkCompression.h
+//
+
+#pragma once
+
+#include <enet/enet.h>
+#include "../Third-Party/zlib/zlib.h"
+
+// Packets up to this size go through the per-peer LZ4 stream, larger ones fall back to zlib.
+#define NET_STREAM_BUFFER_SIZE		(1024 * 1024)
+#define NET_STREAM_HISTORY_SIZE		(64 * 1024)
+#define NET_STREAM_MAX_BLOCK		(NET_STREAM_BUFFER_SIZE - NET_STREAM_HISTORY_SIZE)
+
+// Largest packet a peer accepts, the snapshot buffers are sizeof(Snapshot) * 2.
+#define NET_MAX_PACKET_SIZE			(16 * 1024 * 1024)
+
+// Packets below this size are not worth compressing.
+#define NET_COMPRESS_MIN_SIZE		32
+
+// Payload carried by a single enet fragment at the default MTU.
+#define NET_FRAGMENT_PAYLOAD		(ENET_HOST_DEFAULT_MTU - sizeof(ENetProtocolHeader) - sizeof(ENetProtocolSendFragment))
+
+#define NET_PACKET_POOL_BUCKETS		16
+
+enum NetCodec
+{
+	NET_CODEC_RAW = 0,
+	NET_CODEC_LZ4STREAM,
+	NET_CODEC_ZLIB
+};
+
+//
+// NetPeerStats
+//
+struct NetPeerStats
+{
+	uint64_t			packetsOut;
+	uint64_t			rawBytesOut;
+	uint64_t			wireBytesOut;
+	uint64_t			packetsIn;
+	uint64_t			rawBytesIn;
+	uint64_t			wireBytesIn;
+	double				encodeTimeMs;
+	double				decodeTimeMs;
+};
+
+//
+// NetPacketBuffer
+//
+struct NetPacketBuffer
+{
+	NetPacketBuffer		*next;
+	int					bucket;
+	int					capacity;
+	byte				*data;
+};
+
+//
+// NetPacketPool
+//
+// Free lists of packet buffers, bucketed by the number of enet fragments they span.
+//
+class NetPacketPool
+{
+public:
+	NetPacketPool();
+	~NetPacketPool();
+
+	NetPacketBuffer		*Alloc(int length);
+	void				Free(NetPacketBuffer *buffer);
+
+	int					GetNumAllocated() { return numAllocated; }
+private:
+	NetPacketBuffer		*freeList[NET_PACKET_POOL_BUCKETS];
+	int					numAllocated;
+};
+
+//
+// NetPeerContext
+//
+// Compression state that lives as long as the connection to a peer. The LZ4 stream relies on
+// the reliable, ordered channel so both ends see the same history.
+//
+class NetPeerContext
+{
+public:
+	NetPeerContext();
+	~NetPeerContext();
+
+	// Encodes length bytes into a pooled buffer, the result has to be returned to the pool.
+	NetPacketBuffer		*Encode(NetPacketPool &pool, const byte *data, int length, int *encodedLength);
+
+	// Decodes a packet, the returned pointer stays valid until the next call.
+	byte				*Decode(const byte *data, int length, int *decodedLength);
+
+	NetPeerStats		stats;
+private:
+	byte				*ReserveScratch(int length);
+
+	void				*lz4Encoder;
+	char				*encodeHistory;
+	int					encodePosition;
+
+	char				*decodeHistory;
+	int					decodePosition;
+
+	z_stream			deflateStream;
+	z_stream			inflateStream;
+
+	byte				*scratch;
+	int					scratchSize;
+};
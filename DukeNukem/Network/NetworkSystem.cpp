@@ -1,20 +1,25 @@
 #include "pch.h"
 
 #include "Build.h"
+#include "baselayer.h"
+#include "osd.h"
 #include "BitMsg.h"
 #include "Snapshot.h"
 #include "NetworkSystem_local.h"
 #include "mmulti.h"
-#include "../Third-Party/zlib/zlib.h"
 
 NetworkSystemLocal networkSystemLocal;
 NetworkSystem *networkSystem = &networkSystemLocal;
 
+// net_record files start with this, followed by a length prefixed copy of every packet sent.
+#define NET_RECORD_MAGIC			"BuildNetRecord1"
+
 NetworkSystemLocal::NetworkSystemLocal()
 {
 	client = NULL;
 	server = NULL;
 	peer = NULL;
+	recordFile = NULL;
 }
 
 void NetworkSystemLocal::StartServer(int port, int maxclients)
@@ -106,6 +111,7 @@ bool NetworkSystemLocal::JoinServer(const char *ipaddress, int port)
 	}
 
 	initprintf("Connected to host\n");
+	CreatePeerContext(peer);
 
 	enet_host_service(client, &event, 5000);
 	//NetPackets::SendInitialConnectionHandshake();
@@ -113,7 +119,35 @@ bool NetworkSystemLocal::JoinServer(const char *ipaddress, int port)
 	return true;
 }
 
-bool NetworkSystemLocal::GetNextPacket(BitMsg &msg)
+//
+// NetworkSystemLocal::CreatePeerContext
+//
+void NetworkSystemLocal::CreatePeerContext(ENetPeer *newPeer)
+{
+	if (newPeer->data == NULL)
+	{
+		newPeer->data = new NetPeerContext();
+	}
+}
+
+//
+// NetworkSystemLocal::FreePeerContext
+//
+void NetworkSystemLocal::FreePeerContext(ENetPeer *oldPeer)
+{
+	delete (NetPeerContext *)oldPeer->data;
+	oldPeer->data = NULL;
+}
+
+//
+// NetworkSystemLocal::FreePacketBuffer
+//
+void NetworkSystemLocal::FreePacketBuffer(ENetPacket *packet)
+{
+	networkSystemLocal.packetPool.Free((NetPacketBuffer *)packet->userData);
+}
+
+bool NetworkSystemLocal::GetNextPacket(BitMsg &msg, int *peerNum)
 {
 	static ENetEvent event;
 	int ret = 0;
@@ -126,37 +160,28 @@ bool NetworkSystemLocal::GetNextPacket(BitMsg &msg)
 	{
 		if (event.type == ENET_EVENT_TYPE_RECEIVE)
 		{
-			static int packet_length = 0;
-
-			static char *packet_data = NULL;
-			if (packet_data == NULL)
+			NetPeerContext *context = (NetPeerContext *)event.peer->data;
+			if (context == NULL)
 			{
-				packet_data = new char[sizeof(Snapshot) * 2];
+				CreatePeerContext(event.peer);
+				context = (NetPeerContext *)event.peer->data;
 			}
 
-			//initprintf("event.packet->dataLength=%d\n", event.packet->dataLength);
-			//if (event.packet->dataLength == 134683)
-			//{
-			//	initprintf("recieved world packet\n");
-			//}
+			int decodedLength = 0;
+			byte *decoded = context->Decode(event.packet->data, (int)event.packet->dataLength, &decodedLength);
+			enet_packet_destroy(event.packet);
 
-			z_stream infstream;
-			infstream.zalloc = Z_NULL;
-			infstream.zfree = Z_NULL;
-			infstream.opaque = Z_NULL;
-			// setup "b" as the input and "c" as the compressed output
-			infstream.avail_in = (uInt)(event.packet->dataLength); // size of input
-			infstream.next_in = (Bytef *)event.packet->data; // input char array
-			infstream.avail_out = (uInt)sizeof(Snapshot) * 2; // size of output
-			infstream.next_out = (Bytef *)packet_data; // output char array
-															  // the actual DE-compression work.
-			inflateInit(&infstream);
-			inflate(&infstream, Z_FINISH);
-			inflateEnd(&infstream);
-			
+			if (decoded == NULL)
+			{
+				return false;
+			}
 
-			msg.SetData((byte *)&packet_data[0], infstream.total_out);
-			enet_packet_destroy(event.packet);
+			if (peerNum != NULL)
+			{
+				*peerNum = (int)(event.peer - event.peer->host->peers);
+			}
+
+			msg.SetData(decoded, decodedLength);
 			return true;
 		}
 	}
@@ -164,50 +189,109 @@ bool NetworkSystemLocal::GetNextPacket(BitMsg &msg)
 	return false;
 }
 
-void NetworkSystemLocal::SendPacket(byte *buffer, int length, bool isReliablePacket)
+//
+// NetworkSystemLocal::SendEncodedPacket
+//
+void NetworkSystemLocal::SendEncodedPacket(ENetPeer *currentPeer, byte *buffer, int length)
 {
-	static byte *compressedBuffer = NULL;
-	
-	if (compressedBuffer == NULL)
+	CreatePeerContext(currentPeer);
+
+	int encodedLength = 0;
+	NetPacketBuffer *encoded = ((NetPeerContext *)currentPeer->data)->Encode(packetPool, buffer, length, &encodedLength);
+
+	// The LZ4 stream relies on in order delivery, so everything goes out reliable.
+	ENetPacket * packet = enet_packet_create(encoded->data, encodedLength, ENET_PACKET_FLAG_RELIABLE | ENET_PACKET_FLAG_NO_ALLOCATE);
+	packet->userData = encoded;
+	packet->freeCallback = FreePacketBuffer;
+
+	if (enet_peer_send(currentPeer, 1, packet) < 0)
 	{
-		compressedBuffer = new byte[sizeof(Snapshot) * 2];
+		enet_packet_destroy(packet);
 	}
+}
 
-	z_stream defstream;
-	defstream.zalloc = Z_NULL;
-	defstream.zfree = Z_NULL;
-	defstream.opaque = Z_NULL;
+//
+// NetworkSystemLocal::RecordPacket
+//
+void NetworkSystemLocal::RecordPacket(const byte *buffer, int length)
+{
+	if (recordFile == NULL)
+		return;
 
-	defstream.avail_in = length; // size of input, string + terminator
-	defstream.next_in = buffer; // input char array
-	defstream.avail_out = sizeof(Snapshot) * 2; // size of output
-	defstream.next_out = compressedBuffer; // output char array
+	int32_t recordLength = length;
+	Bfwrite(&recordLength, sizeof(recordLength), 1, recordFile);
+	Bfwrite(buffer, length, 1, recordFile);
+}
 
-	deflateInit(&defstream, Z_BEST_SPEED);
-	deflate(&defstream, Z_FINISH);
-	deflateEnd(&defstream);
+void NetworkSystemLocal::SendPacket(byte *buffer, int length, bool isReliablePacket)
+{
+	ENetHost *host = peer->host;
 
-	//enet_uint32 packetFlag = ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT;
-	//if (isReliablePacket)
-	//	packetFlag = ENET_PACKET_FLAG_RELIABLE;
+	RecordPacket(buffer, length);
 
-	ENetPacket * packet = enet_packet_create(compressedBuffer, defstream.total_out, ENET_PACKET_FLAG_RELIABLE);
+	// Each peer has its own compression history, so the packet is encoded per peer.
+	for (size_t i = 0; i < host->peerCount; i++)
+	{
+		ENetPeer *currentPeer = &host->peers[i];
+		if (currentPeer->state != ENET_PEER_STATE_CONNECTED)
+			continue;
 
-	enet_host_broadcast(peer->host, 1, packet);
+		SendEncodedPacket(currentPeer, buffer, length);
+	}
 	//enet_host_flush(peer->host);
+}
 
-	if (packet->referenceCount == 0)
-		enet_packet_destroy(packet);
+//
+// NetworkSystemLocal::IsPeerConnected
+//
+bool NetworkSystemLocal::IsPeerConnected(int peerNum)
+{
+	if (peer == NULL || peerNum < 0 || peerNum >= (int)peer->host->peerCount)
+		return false;
+
+	return peer->host->peers[peerNum].state == ENET_PEER_STATE_CONNECTED;
+}
+
+//
+// NetworkSystemLocal::SendPacketToPeer
+//
+void NetworkSystemLocal::SendPacketToPeer(int peerNum, byte *buffer, int length, bool isReliablePacket)
+{
+	UNREFERENCED_PARAMETER(isReliablePacket);
+
+	if (!IsPeerConnected(peerNum))
+		return;
+
+	RecordPacket(buffer, length);
+	SendEncodedPacket(&peer->host->peers[peerNum], buffer, length);
 }
 
 void NetworkSystemLocal::SendPacket(BitMsg *msg)
 {
-	ENetPacket * packet = enet_packet_create(msg->GetBuffer(), msg->GetLength(), ENET_PACKET_FLAG_RELIABLE);
+	SendPacket(msg->GetBuffer(), msg->GetWrittenLength(), true);
+}
 
-	enet_host_broadcast(peer->host, 1, packet);
-//	enet_host_flush(peer->host);
-	if (packet->referenceCount == 0)
-		enet_packet_destroy(packet);
+void NetworkSystemLocal::PrintStats()
+{
+	ENetHost *host = (server != NULL) ? server : client;
+	if (host == NULL)
+		return;
+
+	initprintf("-------- NetworkSystem::PrintStats ---------\n");
+	initprintf("%d pooled packet buffers\n", packetPool.GetNumAllocated());
+
+	for (size_t i = 0; i < host->peerCount; i++)
+	{
+		NetPeerContext *context = (NetPeerContext *)host->peers[i].data;
+		if (context == NULL)
+			continue;
+
+		const NetPeerStats &stats = context->stats;
+		initprintf("peer %d: out %llu packets %llu -> %llu bytes, %.2fms encode\n", (int)i,
+			(unsigned long long)stats.packetsOut, (unsigned long long)stats.rawBytesOut, (unsigned long long)stats.wireBytesOut, stats.encodeTimeMs);
+		initprintf("peer %d: in %llu packets %llu -> %llu bytes, %.2fms decode\n", (int)i,
+			(unsigned long long)stats.packetsIn, (unsigned long long)stats.wireBytesIn, (unsigned long long)stats.rawBytesIn, stats.decodeTimeMs);
+	}
 }
 
 bool NetworkSystemLocal::IsWaitingForClients()
@@ -222,8 +306,13 @@ bool NetworkSystemLocal::IsWaitingForClients()
 			case ENET_EVENT_TYPE_CONNECT:
 				initprintf("Client Connection Event Received\n");
 				peer = event.peer;
+				CreatePeerContext(peer);
 				numConnectedClients++;
 				break;
+
+			case ENET_EVENT_TYPE_DISCONNECT:
+				FreePeerContext(event.peer);
+				break;
 		}
 	}
 
@@ -233,4 +322,225 @@ bool NetworkSystemLocal::IsWaitingForClients()
 int NetworkSystemLocal::GetNumConnectedPlayers()
 {
 	return numConnectedClients;
-}
\ No newline at end of file
+}
+
+//
+// NetworkSystemLocal::StartRecording
+//
+bool NetworkSystemLocal::StartRecording(const char *filename)
+{
+	StopRecording();
+
+	recordFile = Bfopen(filename, "wb");
+	if (recordFile == NULL)
+		return false;
+
+	Bfwrite(NET_RECORD_MAGIC, sizeof(NET_RECORD_MAGIC), 1, recordFile);
+	return true;
+}
+
+//
+// NetworkSystemLocal::StopRecording
+//
+void NetworkSystemLocal::StopRecording()
+{
+	if (recordFile != NULL)
+	{
+		Bfclose(recordFile);
+		recordFile = NULL;
+	}
+}
+
+//
+// osdcmd_net_stats
+//
+static int32_t osdcmd_net_stats(const osdfuncparm_t *parm)
+{
+	UNREFERENCED_PARAMETER(parm);
+
+	networkSystemLocal.PrintStats();
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_net_record
+//
+static int32_t osdcmd_net_record(const osdfuncparm_t *parm)
+{
+	networkSystemLocal.StopRecording();
+
+	if (parm->numparms != 1)
+	{
+		initprintf("net_record: stopped\n");
+		return OSDCMD_OK;
+	}
+
+	if (!networkSystemLocal.StartRecording(parm->parms[0]))
+		initprintf("net_record: couldn't open \"%s\"\n", parm->parms[0]);
+	else
+		initprintf("net_record: recording to \"%s\"\n", parm->parms[0]);
+
+	return OSDCMD_OK;
+}
+
+//
+// osdcmd_net_benchmark
+//
+// Replays a net_record file through a loopback pair of peer contexts and through the old path
+// that set up and tore down a zlib stream for every packet, and checks both decode back to the
+// recorded packets.
+//
+static int32_t osdcmd_net_benchmark(const osdfuncparm_t *parm)
+{
+	char magic[sizeof(NET_RECORD_MAGIC)];
+	int32_t length;
+
+	if (parm->numparms < 1 || parm->numparms > 2)
+		return OSDCMD_SHOWHELP;
+
+	const int passes = (parm->numparms == 2) ? max(Batol(parm->parms[1]), 1) : 1;
+
+	FILE *fp = Bfopen(parm->parms[0], "rb");
+	if (fp == NULL)
+	{
+		initprintf("net_benchmark: couldn't open \"%s\"\n", parm->parms[0]);
+		return OSDCMD_OK;
+	}
+
+	if (Bfread(magic, sizeof(magic), 1, fp) != 1 || Bmemcmp(magic, NET_RECORD_MAGIC, sizeof(magic)))
+	{
+		initprintf("net_benchmark: \"%s\" isn't a net_record file\n", parm->parms[0]);
+		Bfclose(fp);
+		return OSDCMD_OK;
+	}
+
+	// Everything is read up front so the file doesn't show up in the timings.
+	byte **packets = NULL;
+	int *lengths = NULL;
+	int numPackets = 0, maxLength = 0;
+	uint64_t rawBytes = 0;
+
+	while (Bfread(&length, sizeof(length), 1, fp) == 1)
+	{
+		if (length <= 0 || length > NET_MAX_PACKET_SIZE)
+			break;
+
+		byte *packet = new byte[length];
+		if (Bfread(packet, length, 1, fp) != 1)
+		{
+			delete[] packet;
+			break;
+		}
+
+		if ((numPackets & (numPackets - 1)) == 0)
+		{
+			const int capacity = numPackets ? numPackets * 2 : 1;
+			packets = (byte **)Xrealloc(packets, capacity * sizeof(byte *));
+			lengths = (int *)Xrealloc(lengths, capacity * sizeof(int));
+		}
+
+		packets[numPackets] = packet;
+		lengths[numPackets++] = length;
+		maxLength = max(maxLength, (int)length);
+		rawBytes += length;
+	}
+
+	Bfclose(fp);
+
+	if (numPackets == 0)
+	{
+		initprintf("net_benchmark: \"%s\" has no packets\n", parm->parms[0]);
+		return OSDCMD_OK;
+	}
+
+	const int compressedSize = (int)compressBound(maxLength);
+	byte *compressed = new byte[compressedSize];
+	byte *decompressed = new byte[maxLength];
+
+	uint64_t zlibBytes = 0, streamBytes = 0;
+	int mismatches = 0;
+
+	// The old path: a fresh deflate and inflate stream for every packet.
+	double startTime = gethiticks();
+	for (int pass = 0; pass < passes; pass++)
+	{
+		for (int i = 0; i < numPackets; i++)
+		{
+			z_stream defstream;
+			memset(&defstream, 0, sizeof(defstream));
+			defstream.next_in = packets[i];
+			defstream.avail_in = lengths[i];
+			defstream.next_out = compressed;
+			defstream.avail_out = compressedSize;
+			deflateInit(&defstream, Z_BEST_SPEED);
+			deflate(&defstream, Z_FINISH);
+			deflateEnd(&defstream);
+
+			z_stream infstream;
+			memset(&infstream, 0, sizeof(infstream));
+			infstream.next_in = compressed;
+			infstream.avail_in = (uInt)defstream.total_out;
+			infstream.next_out = decompressed;
+			infstream.avail_out = maxLength;
+			inflateInit(&infstream);
+			inflate(&infstream, Z_FINISH);
+			inflateEnd(&infstream);
+
+			if (pass == 0)
+			{
+				zlibBytes += defstream.total_out;
+				mismatches += (infstream.total_out != (uLong)lengths[i] || memcmp(decompressed, packets[i], lengths[i]) != 0);
+			}
+		}
+	}
+	const double zlibTime = gethiticks() - startTime;
+
+	// The per-peer contexts, every pass is a new connection.
+	NetPacketPool pool;
+	startTime = gethiticks();
+	for (int pass = 0; pass < passes; pass++)
+	{
+		NetPeerContext sender, receiver;
+
+		for (int i = 0; i < numPackets; i++)
+		{
+			int encodedLength = 0, decodedLength = 0;
+			NetPacketBuffer *encoded = sender.Encode(pool, packets[i], lengths[i], &encodedLength);
+			byte *decoded = receiver.Decode(encoded->data, encodedLength, &decodedLength);
+
+			if (pass == 0)
+			{
+				streamBytes += encodedLength;
+				mismatches += (decoded == NULL || decodedLength != lengths[i] || memcmp(decoded, packets[i], lengths[i]) != 0);
+			}
+
+			pool.Free(encoded);
+		}
+	}
+	const double streamTime = gethiticks() - startTime;
+
+	const double megabytes = (double)rawBytes * passes / (1024.0 * 1024.0);
+
+	initprintf("net_benchmark: %d packets, %.2f MB, %d passes, %d mismatches\n", numPackets, (double)rawBytes / (1024.0 * 1024.0), passes, mismatches);
+	initprintf("net_benchmark: per packet zlib %.2fms, %.1f MB/s, %.1f%% of raw\n", zlibTime, megabytes * 1000.0 / max(zlibTime, 0.001), 100.0 * zlibBytes / rawBytes);
+	initprintf("net_benchmark: peer streams    %.2fms, %.1f MB/s, %.1f%% of raw\n", streamTime, megabytes * 1000.0 / max(streamTime, 0.001), 100.0 * streamBytes / rawBytes);
+
+	delete[] compressed;
+	delete[] decompressed;
+	for (int i = 0; i < numPackets; i++)
+		delete[] packets[i];
+	Bfree(packets);
+	Bfree(lengths);
+
+	return OSDCMD_OK;
+}
+
+//
+// NetworkSystemLocal::InitOSD
+//
+void NetworkSystemLocal::InitOSD()
+{
+	OSD_RegisterFunction("net_stats", "net_stats: prints per peer traffic and compression counters", osdcmd_net_stats);
+	OSD_RegisterFunction("net_record", "net_record [file]: records every packet sent to a file, no file stops recording", osdcmd_net_record);
+	OSD_RegisterFunction("net_benchmark", "net_benchmark <file> [passes]: replays a net_record file through per packet zlib and the per peer compression streams", osdcmd_net_benchmark);
+}
@@ -19,7 +19,19 @@ public:
 	virtual int					GetNumConnectedPlayers() = 0;
 
 	virtual void				SendPacket(byte *buffer, int length, bool isReliablePacket = false) = 0;
-	virtual bool				GetNextPacket(BitMsg &msg) = 0;
+
+	// Peers are numbered by their slot on the host, so a client only ever sees peer 0.
+	virtual bool				IsPeerConnected(int peerNum) = 0;
+	virtual void				SendPacketToPeer(int peerNum, byte *buffer, int length, bool isReliablePacket = false) = 0;
+
+	// peerNum, if given, receives the peer the packet came from.
+	virtual bool				GetNextPacket(BitMsg &msg, int *peerNum = NULL) = 0;
+
+	// Prints per peer traffic and compression counters.
+	virtual void				PrintStats() = 0;
+
+	// Registers net_stats, net_record and net_benchmark.
+	virtual void				InitOSD() = 0;
 };
 
 extern NetworkSystem *networkSystem;
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <enet/enet.h>
 
 #include "NetworkSystem.h"
+#include "NetworkCompression.h"
 
 
 extern "C" void initprintf(const char *f, ...);
@@ -38,12 +39,35 @@ public:
 
 	virtual void				SendPacket(byte *buffer, int length, bool isReliablePacket);
 	virtual void				SendPacket(BitMsg *msg);
-	virtual bool				GetNextPacket(BitMsg &msg);
+
+	virtual bool				IsPeerConnected(int peerNum);
+	virtual void				SendPacketToPeer(int peerNum, byte *buffer, int length, bool isReliablePacket);
+
+	virtual bool				GetNextPacket(BitMsg &msg, int *peerNum);
+
+	virtual void				PrintStats();
+
+	virtual void				InitOSD();
+
+	// Appends every packet handed to SendPacket to a file for net_benchmark, NULL stops.
+	bool						StartRecording(const char *filename);
+	void						StopRecording();
 private:
+	void						CreatePeerContext(ENetPeer *newPeer);
+	void						RecordPacket(const byte *buffer, int length);
+	void						FreePeerContext(ENetPeer *oldPeer);
+	void						SendEncodedPacket(ENetPeer *currentPeer, byte *buffer, int length);
+
+	static void					FreePacketBuffer(ENetPacket *packet);
+
 	ENetHost * client;
 	ENetHost * server;
 	ENetPeer * peer;
 
+	NetPacketPool packetPool;
+
+	FILE *recordFile;
+
 	int maxClients;
 	int numConnectedClients;
 };
@@ -13,226 +13,475 @@ void WritePlayerSnapshotInfo(BitMsg &msg);
 void NetModifyPlayerVisibility(SPRITETYPE *snapshotsprites);
 void NetHideLocalPlayer();
 
+#define SNAPSHOT_MARKER				6666
+
+//
+// SnapshotField
+//
+struct SnapshotField
+{
+	uint16_t offset;
+	uint16_t size;
+};
+
+#define SNAPSHOT_FIELD(type, name) { (uint16_t)offsetof(type, name), (uint16_t)sizeof(((type *)0)->name) }
+
+static const SnapshotField wallFields[] = {
+	SNAPSHOT_FIELD(walltype, x),
+	SNAPSHOT_FIELD(walltype, y),
+	SNAPSHOT_FIELD(walltype, point2),
+	SNAPSHOT_FIELD(walltype, nextwall),
+	SNAPSHOT_FIELD(walltype, nextsector),
+	SNAPSHOT_FIELD(walltype, cstat),
+	SNAPSHOT_FIELD(walltype, picnum),
+	SNAPSHOT_FIELD(walltype, overpicnum),
+	SNAPSHOT_FIELD(walltype, shade),
+	SNAPSHOT_FIELD(walltype, pal),
+	SNAPSHOT_FIELD(walltype, xrepeat),
+	SNAPSHOT_FIELD(walltype, yrepeat),
+	SNAPSHOT_FIELD(walltype, xpanning),
+	SNAPSHOT_FIELD(walltype, ypanning),
+	SNAPSHOT_FIELD(walltype, lotag),
+	SNAPSHOT_FIELD(walltype, hitag),
+	SNAPSHOT_FIELD(walltype, extra)
+};
+
+static const SnapshotField sectorFields[] = {
+	SNAPSHOT_FIELD(sectortype, wallptr),
+	SNAPSHOT_FIELD(sectortype, wallnum),
+	SNAPSHOT_FIELD(sectortype, ceilingz),
+	SNAPSHOT_FIELD(sectortype, floorz),
+	SNAPSHOT_FIELD(sectortype, ceilingstat),
+	SNAPSHOT_FIELD(sectortype, floorstat),
+	SNAPSHOT_FIELD(sectortype, ceilingpicnum),
+	SNAPSHOT_FIELD(sectortype, ceilingheinum),
+	SNAPSHOT_FIELD(sectortype, ceilingshade),
+	SNAPSHOT_FIELD(sectortype, ceilingpal),
+	SNAPSHOT_FIELD(sectortype, ceilingxpanning),
+	SNAPSHOT_FIELD(sectortype, ceilingypanning),
+	SNAPSHOT_FIELD(sectortype, floorpicnum),
+	SNAPSHOT_FIELD(sectortype, floorheinum),
+	SNAPSHOT_FIELD(sectortype, floorshade),
+	SNAPSHOT_FIELD(sectortype, floorpal),
+	SNAPSHOT_FIELD(sectortype, floorxpanning),
+	SNAPSHOT_FIELD(sectortype, floorypanning),
+	SNAPSHOT_FIELD(sectortype, visibility),
+	SNAPSHOT_FIELD(sectortype, fogpal),
+	SNAPSHOT_FIELD(sectortype, lotag),
+	SNAPSHOT_FIELD(sectortype, hitag),
+	SNAPSHOT_FIELD(sectortype, extra)
+};
+
+static const SnapshotField spriteFields[] = {
+	SNAPSHOT_FIELD(SPRITETYPE, x),
+	SNAPSHOT_FIELD(SPRITETYPE, y),
+	SNAPSHOT_FIELD(SPRITETYPE, z),
+	SNAPSHOT_FIELD(SPRITETYPE, cstat),
+	SNAPSHOT_FIELD(SPRITETYPE, picnum),
+	SNAPSHOT_FIELD(SPRITETYPE, shade),
+	SNAPSHOT_FIELD(SPRITETYPE, pal),
+	SNAPSHOT_FIELD(SPRITETYPE, clipdist),
+	SNAPSHOT_FIELD(SPRITETYPE, blend),
+	SNAPSHOT_FIELD(SPRITETYPE, xrepeat),
+	SNAPSHOT_FIELD(SPRITETYPE, yrepeat),
+	SNAPSHOT_FIELD(SPRITETYPE, xoffset),
+	SNAPSHOT_FIELD(SPRITETYPE, yoffset),
+	SNAPSHOT_FIELD(SPRITETYPE, sectnum),
+	SNAPSHOT_FIELD(SPRITETYPE, statnum),
+	SNAPSHOT_FIELD(SPRITETYPE, ang),
+	SNAPSHOT_FIELD(SPRITETYPE, owner),
+	SNAPSHOT_FIELD(SPRITETYPE, xvel),
+	SNAPSHOT_FIELD(SPRITETYPE, yvel),
+	SNAPSHOT_FIELD(SPRITETYPE, zvel),
+	SNAPSHOT_FIELD(SPRITETYPE, lotag),
+	SNAPSHOT_FIELD(SPRITETYPE, hitag),
+	SNAPSHOT_FIELD(SPRITETYPE, extra)
+};
+
+#define NUM_SNAPSHOT_FIELDS(fields) ((int)(sizeof(fields) / sizeof(fields[0])))
+
+static SnapshotBaseline serverBaselines[SNAPSHOT_MAX_CLIENTS];
+static Snapshot *serverScratch = NULL;
+
+static Snapshot *clientBaseline = NULL;
+static int clientSequence = SNAPSHOT_REQUEST_FULL;
+
 Snapshot::Snapshot()
 {
 	memset(this, 0, sizeof(Snapshot));
 }
 
-bool CompareSprite(tspritetype &s1, tspritetype &s2)
+//
+// SnapshotFieldValue
+//
+static __forceinline uint32_t SnapshotFieldValue(const byte *entry, const SnapshotField &field)
 {
-	return (s1.x == s2.x && s1.y == s2.z && s1.z == s2.z &&
-		s1.cstat == s2.cstat &&
-		s1.picnum == s2.picnum &&
-		s1.shade == s2.shade &&
-		s1.pal == s2.pal && s1.clipdist == s2.clipdist && s1.blend == s2.blend &&
-		s1.xrepeat == s2.xrepeat && s1.yrepeat == s2.yrepeat &&
-		s1.xoffset == s2.xoffset && s1.yoffset == s2.yoffset &&
-		s1.sectnum == s2.sectnum && s1.statnum == s2.statnum &&
-		s1.ang == s2.ang && s1.owner == s2.owner && s1.xvel == s2.xvel && s1.yvel == s2.yvel && s1.zvel == s2.zvel &&
-		s1.lotag == s2.lotag && s1.hitag == s2.hitag &&
-		s1.extra == s2.extra);
+	uint32_t value = 0;
+	memcpy(&value, entry + field.offset, field.size);
+	return value;
 }
 
-bool CompareSector(sectortype &s1, sectortype &s2)
+//
+// WriteEntryDelta
+//
+// Writes a mask of the fields that differ from the baseline, followed by each changed field
+// XOR'ed against its baseline value, then brings the baseline up to date.
+//
+static void WriteEntryDelta(BitMsg &msg, const SnapshotField *fields, int numFields, const byte *current, byte *baseline)
 {
-	if (s1.wallptr != s2.wallptr || s1.wallnum != s2.wallnum)
-		return false;
-
-	if (s1.ceilingz != s2.ceilingz || s1.floorz != s2.floorz)
-		return false;
-
-	if (s1.ceilingstat != s2.ceilingstat || s1.floorstat != s2.floorstat)
-		return false;
-
-	if (s1.ceilingpicnum != s2.ceilingpicnum || s1.ceilingheinum != s2.ceilingheinum)
-		return false;
-
-	if (s1.ceilingshade != s2.ceilingshade)
-		return false;
-
-	if (s1.ceilingpal != s2.ceilingpal || s1.ceilingxpanning != s2.ceilingxpanning || s1.ceilingypanning != s2.ceilingypanning)
-		return false;
-
-	if (s1.floorpicnum != s2.floorpicnum || s1.floorheinum != s2.floorheinum)
-		return false;
+	unsigned int fieldMask = 0;
+	for (int f = 0; f < numFields; f++)
+	{
+		if (memcmp(current + fields[f].offset, baseline + fields[f].offset, fields[f].size))
+		{
+			fieldMask |= 1u << f;
+		}
+	}
 
-	if (s1.floorshade != s2.floorshade)
-		return false;
+	msg.WriteVarUInt(fieldMask);
+	for (int f = 0; f < numFields; f++)
+	{
+		if (!(fieldMask & (1u << f)))
+			continue;
 
-	if (s1.floorpal != s2.floorpal || s1.floorxpanning != s2.floorxpanning || s1.floorypanning != s2.floorypanning)
-		return false;
+		uint32_t delta = SnapshotFieldValue(current, fields[f]) ^ SnapshotFieldValue(baseline, fields[f]);
+		msg.WriteData((byte *)&delta, fields[f].size);
+		memcpy(baseline + fields[f].offset, current + fields[f].offset, fields[f].size);
+	}
+}
 
-	if (s1.lotag != s2.lotag || s1.hitag != s2.hitag)
-		return false;
+//
+// ReadEntryDelta
+//
+static void ReadEntryDelta(BitMsg &msg, const SnapshotField *fields, int numFields, byte *baseline)
+{
+	unsigned int fieldMask = msg.ReadVarUInt();
+	for (int f = 0; f < numFields; f++)
+	{
+		if (!(fieldMask & (1u << f)))
+			continue;
 
-	if (s1.extra != s2.extra)
-		return false;
+		uint32_t delta = 0;
+		msg.ReadData((byte *)&delta, fields[f].size);
 
-	return true;
+		uint32_t value = SnapshotFieldValue(baseline, fields[f]) ^ delta;
+		memcpy(baseline + fields[f].offset, &value, fields[f].size);
+	}
 }
 
-bool CompareWall(walltype &w1, walltype &w2)
+//
+// MarkAllPending
+//
+static void MarkAllPending(SnapshotPending *pending)
 {
-	if (w1.x != w2.x || w1.y != w2.y)
-		return false;
+	memset(pending, 0xff, sizeof(SnapshotPending));
+}
 
-	if (w1.point2 != w2.point2 || w1.nextwall != w2.nextwall || w1.nextsector != w2.nextsector)
-		return false;
+//
+// GatherChangeJournal
+//
+// Moves the engine change journal into the pending sets of every active client.
+//
+static void GatherChangeJournal()
+{
+	for (int c = 0; c < SNAPSHOT_MAX_CLIENTS; c++)
+	{
+		SnapshotBaseline &baseline = serverBaselines[c];
+		if (!baseline.active)
+			continue;
 
-	if (w1.cstat != w2.cstat)
-		return false;
+		SnapshotPending *pending = baseline.pending;
+		if (changejournalreset)
+		{
+			MarkAllPending(pending);
+			continue;
+		}
 
-	if (w1.picnum != w2.picnum || w1.overpicnum != w2.overpicnum)
-		return false;
+		for (int i = 0; i < (int)sizeof(pending->sprites); i++)
+			pending->sprites[i] |= spritejournal[i];
+		for (int i = 0; i < (int)sizeof(pending->spriteLinks); i++)
+			pending->spriteLinks[i] |= spritelinkjournal[i];
+		for (int i = 0; i < (int)sizeof(pending->headSect); i++)
+			pending->headSect[i] |= headsectjournal[i];
+		for (int i = 0; i < (int)sizeof(pending->headStat); i++)
+			pending->headStat[i] |= headstatjournal[i];
+		for (int i = 0; i < (int)sizeof(pending->sectors); i++)
+			pending->sectors[i] |= sectorjournal[i];
+		for (int i = 0; i < (int)sizeof(pending->walls); i++)
+			pending->walls[i] |= walljournal[i];
+	}
 
-	if (w1.shade != w2.shade)
-		return false;
+	clearchangejournal();
+}
 
-	if (w1.pal != w2.pal || w1.xrepeat != w2.xrepeat || w1.yrepeat != w2.yrepeat || w1.xpanning != w2.xpanning || w1.ypanning != w2.ypanning)
-		return false;
+//
+// ResetServerBaseline
+//
+static void ResetServerBaseline(SnapshotBaseline &baseline)
+{
+	memset(baseline.state, 0, sizeof(Snapshot));
+	MarkAllPending(baseline.pending);
+	baseline.sequence = SNAPSHOT_FULL_BASELINE;
+	baseline.acknowledgedSequence = SNAPSHOT_FULL_BASELINE;
+	baseline.needsFullUpdate = false;
+}
 
-	if (w1.lotag != w2.lotag || w1.hitag != w2.hitag)
+//
+// Snapshot::CanSendSnapshot
+//
+bool Snapshot::CanSendSnapshot(int clientNum)
+{
+	if (clientNum < 0 || clientNum >= SNAPSHOT_MAX_CLIENTS)
 		return false;
 
-	if (w1.extra != w2.extra)
-		return false;
+	const SnapshotBaseline &baseline = serverBaselines[clientNum];
+	if (!baseline.active || baseline.needsFullUpdate)
+		return true;
 
-	return true;
+	return baseline.sequence - baseline.acknowledgedSequence < SNAPSHOT_MAX_UNACKED;
 }
 
 //
 // CreateSnapshotPacket
 //
-void Snapshot::CreateSnapshotPacket(BitMsg &msg)
+// Only live walls, sectors and sprites plus whatever the engine journaled are compared
+// against the client baseline; the sprite lists are sent purely from the journal.
+//
+void Snapshot::CreateSnapshotPacket(BitMsg &msg, int clientNum)
 {
-	static Snapshot *snapshot = NULL;
-	static Snapshot *prevSnapShot = NULL;
+	SnapshotBaseline &baseline = serverBaselines[clientNum];
 
-	if (snapshot == NULL)
+	if (serverScratch == NULL)
 	{
-		snapshot = new Snapshot();
-		prevSnapShot = new Snapshot();
+		serverScratch = new Snapshot();
+	}
 
-	//	snapshot->CreateSnapshot();
-	//	memcpy(prevSnapShot, snapshot, sizeof(Snapshot));
+	if (!baseline.active)
+	{
+		baseline.state = new Snapshot();
+		baseline.pending = new SnapshotPending();
+		baseline.active = true;
+		ResetServerBaseline(baseline);
 	}
-	snapshot->CreateSnapshot();
 
-	NetModifyPlayerVisibility(&snapshot->_sprite[0]);
+	GatherChangeJournal();
 
-	int numWallsToUpdate = 0;
-	int numSectorstoUpdate = 0;
-	int numSpritesToUpdate = 0;
+	if (baseline.needsFullUpdate)
 	{
-		// Find how many walls have changed.
+		ResetServerBaseline(baseline);
+	}
 
-		for (int i = 0; i < MAXWALLS; i++)
-		{
-			if (CompareWall(snapshot->_wall[i], prevSnapShot->_wall[i]))
-			{
-				continue;
-			}
+	Snapshot *base = baseline.state;
+	SnapshotPending *pending = baseline.pending;
 
-			numWallsToUpdate++;
-		}
+	int baselineSequence = baseline.sequence;
+	baseline.sequence++;
 
-		// Find how many sectors have changed.
+	msg.Write<int>(SNAPSHOT_MARKER);
+	msg.Write<int>(baseline.sequence);
+	msg.Write<int>(baselineSequence);
 
-		for (int i = 0; i < MAXSECTORS; i++)
+	// Write out the changed walls.
+	int lastIndex = -1;
+	int numWallsToCheck = (::numwalls > base->_numwalls) ? ::numwalls : base->_numwalls;
+	for (int i = 0; i < MAXWALLS; i++)
+	{
+		if (i >= numWallsToCheck && !journal_test(pending->walls, i))
 		{
-			if (CompareSector(snapshot->_sector[i], prevSnapShot->_sector[i]))
-			{
-				continue;
-			}
-
-			numSectorstoUpdate++;
+			continue;
 		}
 
-		// Find how many sprites have changed. 
-		for (int i = 0; i < MAXSPRITES; i++)
+		if (!memcmp(&::wall[i], &base->_wall[i], sizeof(walltype)))
 		{
-			if (CompareSprite(snapshot->_sprite[i], prevSnapShot->_sprite[i]) /*&& snapshot->spriteext[i] == snapshot->spriteext[i]*/)
-			{
-				continue;
-			}
-		
-			numSpritesToUpdate++;
+			continue;
 		}
+
+		msg.WriteVarUInt(i - lastIndex);
+		WriteEntryDelta(msg, wallFields, NUM_SNAPSHOT_FIELDS(wallFields), (byte *)&::wall[i], (byte *)&base->_wall[i]);
+		lastIndex = i;
 	}
+	msg.WriteVarUInt(0);
+	base->_numwalls = ::numwalls;
+	memset(pending->walls, 0, sizeof(pending->walls));
 
-	msg.Write<int>(6666);
+	msg.Write<int>(SNAPSHOT_MARKER);
 
-	// Write out the changed walls.
-	msg.Write<int>(numWallsToUpdate);
-	for (int i = 0; i < MAXWALLS; i++)
+	// Write out the changed sectors.
+	lastIndex = -1;
+	int numSectorsToCheck = (::numsectors > base->_numsectors) ? ::numsectors : base->_numsectors;
+	for (int i = 0; i < MAXSECTORS; i++)
 	{
-		if (CompareWall(snapshot->_wall[i], prevSnapShot->_wall[i]))
+		if (i >= numSectorsToCheck && !journal_test(pending->sectors, i))
 		{
 			continue;
 		}
-		
-		msg.Write<int>(i);
-		msg.WriteData((byte *)&snapshot->_wall[i], sizeof(walltype));
+
+		if (!memcmp(&::sector[i], &base->_sector[i], sizeof(sectortype)))
+		{
+			continue;
+		}
+
+		msg.WriteVarUInt(i - lastIndex);
+		WriteEntryDelta(msg, sectorFields, NUM_SNAPSHOT_FIELDS(sectorFields), (byte *)&::sector[i], (byte *)&base->_sector[i]);
+		lastIndex = i;
 	}
+	msg.WriteVarUInt(0);
+	base->_numsectors = ::numsectors;
+	memset(pending->sectors, 0, sizeof(pending->sectors));
 
-	msg.Write<int>(6666);
+	msg.Write<int>(SNAPSHOT_MARKER);
 
-	// Write out the changed sectors.
-	msg.Write<int>(numSectorstoUpdate);
-	for (int i = 0; i < MAXSECTORS; i++)
+	// Sprites in the world are compared every packet since the game writes their fields
+	// directly, sprites that left the world are picked up from the journal.
+	for (int stat = 0; stat < MAXSTATUS; stat++)
 	{
-		if (CompareSector(snapshot->_sector[i], prevSnapShot->_sector[i]))
+		for (int i = headspritestat[stat]; i >= 0; i = nextspritestat[i])
 		{
-			continue;
+			journal_mark(pending->sprites, i);
 		}
+	}
 
-		msg.Write<int>(i);
-		msg.WriteData((byte *)&snapshot->_sector[i], sizeof(sectortype));
+	for (int i = 0; i < MAXSPRITES; i++)
+	{
+		if (journal_test(pending->sprites, i))
+		{
+			memcpy(&serverScratch->_sprite[i], &::sprite[i], sizeof(SPRITETYPE));
+		}
 	}
 
-	msg.Write<int>(6666);
+	NetModifyPlayerVisibility(&serverScratch->_sprite[0]);
 
 	// Write out the changed sprites
 	msg.Write<int>(Numsprites);
-	msg.Write<int>(numSpritesToUpdate);
-	int numActualUpdatedSprites = 0;
+	lastIndex = -1;
+	for (int i = 0; i < MAXSPRITES; i++)
+	{
+		if (!journal_test(pending->sprites, i))
+		{
+			continue;
+		}
+
+		if (!memcmp(&serverScratch->_sprite[i], &base->_sprite[i], sizeof(SPRITETYPE)))
+		{
+			continue;
+		}
+
+		msg.WriteVarUInt(i - lastIndex);
+		WriteEntryDelta(msg, spriteFields, NUM_SNAPSHOT_FIELDS(spriteFields), (byte *)&serverScratch->_sprite[i], (byte *)&base->_sprite[i]);
+		lastIndex = i;
+	}
+	msg.WriteVarUInt(0);
+	memset(pending->sprites, 0, sizeof(pending->sprites));
+
+	msg.Write<int>(SNAPSHOT_MARKER);
+
+	// Write out the sprite list links the engine touched.
+	SnapshotSpriteStat &baseStat = base->_snapshotSpriteStat;
+	lastIndex = -1;
 	for (int i = 0; i < MAXSPRITES; i++)
 	{
-		if (CompareSprite(snapshot->_sprite[i], prevSnapShot->_sprite[i]) /*&& snapshot->spriteext[i] == snapshot->spriteext[i]*/)
+		if (!journal_test(pending->spriteLinks, i))
+		{
+			continue;
+		}
+
+		int16_t links[4] = { prevspritesect[i], nextspritesect[i], prevspritestat[i], nextspritestat[i] };
+		int16_t *baseLinks[4] = { &baseStat.prevspritesect[i], &baseStat.nextspritesect[i], &baseStat.prevspritestat[i], &baseStat.nextspritestat[i] };
+
+		unsigned int linkMask = 0;
+		for (int l = 0; l < 4; l++)
+		{
+			if (links[l] != *baseLinks[l])
+				linkMask |= 1u << l;
+		}
+
+		if (linkMask == 0)
 		{
 			continue;
 		}
-	
-		msg.Write<int>(i);
-		msg.WriteData((byte *)&snapshot->_sprite[i], sizeof(SPRITETYPE));
 
-		numActualUpdatedSprites++;
+		msg.WriteVarUInt(i - lastIndex);
+		msg.Write<byte>((byte)linkMask);
+		for (int l = 0; l < 4; l++)
+		{
+			if (linkMask & (1u << l))
+			{
+				msg.Write<int16_t>(links[l]);
+				*baseLinks[l] = links[l];
+			}
+		}
+		lastIndex = i;
 	}
+	msg.WriteVarUInt(0);
+	memset(pending->spriteLinks, 0, sizeof(pending->spriteLinks));
+
+	// Write out the list heads the engine touched.
+	lastIndex = -1;
+	for (int i = 0; i <= MAXSECTORS; i++)
+	{
+		if (!journal_test(pending->headSect, i) || headspritesect[i] == baseStat.headspritesect[i])
+		{
+			continue;
+		}
+
+		msg.WriteVarUInt(i - lastIndex);
+		msg.Write<int16_t>(headspritesect[i]);
+		baseStat.headspritesect[i] = headspritesect[i];
+		lastIndex = i;
+	}
+	msg.WriteVarUInt(0);
+	memset(pending->headSect, 0, sizeof(pending->headSect));
+
+	lastIndex = -1;
+	for (int i = 0; i <= MAXSTATUS; i++)
+	{
+		if (!journal_test(pending->headStat, i) || headspritestat[i] == baseStat.headspritestat[i])
+		{
+			continue;
+		}
 
-	msg.Write<int>(6666);
-
-	//Write out the changed spritesext.
-	//for (int i = 0; i < MAXSPRITES; i++)
-	//{
-	//	if (CompareSprite(snapshot->_sprite[i], prevSnapShot->_sprite[i]) /*&& snapshot->spriteext[i] == snapshot->spriteext[i]*/)
-	//	{
-	//		continue;
-	//	}
-	//
-	//	msg.Write<int>(i);
-	//	msg.WriteData((byte *)&snapshot->_spriteext[i], sizeof(spriteext_t));
-	//}
-
-	msg.WriteData((byte *)&snapshot->_snapshotSpriteStat.headspritesect[0], sizeof(int16_t) * MAXSECTORS);
-	msg.WriteData((byte *)&snapshot->_snapshotSpriteStat.headspritestat[0], sizeof(int16_t) * MAXSTATUS);
-	msg.WriteData((byte *)&snapshot->_snapshotSpriteStat.prevspritesect[0], sizeof(int16_t) * MAXSPRITES);
-	msg.WriteData((byte *)&snapshot->_snapshotSpriteStat.prevspritestat[0], sizeof(int16_t) * MAXSPRITES);
-	msg.WriteData((byte *)&snapshot->_snapshotSpriteStat.nextspritesect[0], sizeof(int16_t) * MAXSPRITES);
-	msg.WriteData((byte *)&snapshot->_snapshotSpriteStat.nextspritestat[0], sizeof(int16_t) * MAXSPRITES);
+		msg.WriteVarUInt(i - lastIndex);
+		msg.Write<int16_t>(headspritestat[i]);
+		baseStat.headspritestat[i] = headspritestat[i];
+		lastIndex = i;
+	}
+	msg.WriteVarUInt(0);
+	memset(pending->headStat, 0, sizeof(pending->headStat));
 
 	WritePlayerSnapshotInfo(msg);
+}
 
-	memcpy(prevSnapShot, snapshot, sizeof(Snapshot));
+//
+// Snapshot::AcknowledgeSnapshot
+//
+void Snapshot::AcknowledgeSnapshot(int clientNum, int sequence)
+{
+	if (clientNum < 0 || clientNum >= SNAPSHOT_MAX_CLIENTS)
+		return;
+
+	SnapshotBaseline &baseline = serverBaselines[clientNum];
+	if (!baseline.active)
+		return;
+
+	if (sequence == SNAPSHOT_REQUEST_FULL)
+	{
+		baseline.needsFullUpdate = true;
+		return;
+	}
+
+	// Acks still in flight from before a rebase refer to sequences we haven't reached again.
+	if (sequence > baseline.sequence || sequence < baseline.acknowledgedSequence)
+		return;
+
+	baseline.acknowledgedSequence = sequence;
+}
+
+//
+// Snapshot::GetAcknowledgeSequence
+//
+int Snapshot::GetAcknowledgeSequence()
+{
+	return clientSequence;
 }
 
 //
@@ -240,65 +489,100 @@ void Snapshot::CreateSnapshotPacket(BitMsg &msg)
 //
 void Snapshot::RestoreSnapshotPacket(BitMsg &msg)
 {
-	if (msg.Read<int>() != 6666)
+	if (clientBaseline == NULL)
+	{
+		clientBaseline = new Snapshot();
+	}
+
+	if (msg.Read<int>() != SNAPSHOT_MARKER)
 	{
 		initprintf("packet error\n");
 	}
 
-	int numWallsToUpdate = msg.Read<int>();
-	for (int i = 0; i < numWallsToUpdate; i++)
+	int sequence = msg.Read<int>();
+	int baselineSequence = msg.Read<int>();
+
+	if (baselineSequence == SNAPSHOT_FULL_BASELINE)
 	{
-		int wallNum = msg.Read<int>();
-		if (wallNum == 2358)
-		{
-			static bool myTempBool = false;
-			myTempBool = true;
-		}
-		memcpy(&::wall[wallNum], msg.ReadData(sizeof(walltype)), sizeof(walltype));
+		memset(clientBaseline, 0, sizeof(Snapshot));
+	}
+	else if (baselineSequence != clientSequence)
+	{
+		initprintf("Snapshot %d is against baseline %d, we have %d, requesting full update\n", sequence, baselineSequence, clientSequence);
+		clientSequence = SNAPSHOT_REQUEST_FULL;
+		return;
+	}
+
+	int index = -1;
+	for (unsigned int delta = msg.ReadVarUInt(); delta != 0; delta = msg.ReadVarUInt())
+	{
+		index += delta;
+		ReadEntryDelta(msg, wallFields, NUM_SNAPSHOT_FIELDS(wallFields), (byte *)&clientBaseline->_wall[index]);
+		memcpy(&::wall[index], &clientBaseline->_wall[index], sizeof(walltype));
 	}
 
-	if (msg.Read<int>() != 6666)
+	if (msg.Read<int>() != SNAPSHOT_MARKER)
 	{
 		initprintf("packet error\n");
 	}
 
-	int numSectorsToUpdate = msg.Read<int>();
-	for (int i = 0; i < numSectorsToUpdate; i++)
+	index = -1;
+	for (unsigned int delta = msg.ReadVarUInt(); delta != 0; delta = msg.ReadVarUInt())
 	{
-		int sectorNum = msg.Read<int>();
-		memcpy(&::sector[sectorNum], msg.ReadData(sizeof(sectortype)), sizeof(sectortype));
+		index += delta;
+		ReadEntryDelta(msg, sectorFields, NUM_SNAPSHOT_FIELDS(sectorFields), (byte *)&clientBaseline->_sector[index]);
+		memcpy(&::sector[index], &clientBaseline->_sector[index], sizeof(sectortype));
 	}
 
-	if (msg.Read<int>() != 6666)
+	if (msg.Read<int>() != SNAPSHOT_MARKER)
 	{
 		initprintf("packet error\n");
 	}
 
 	Numsprites = msg.Read<int>();
-	int numSpritesToUpdate = msg.Read<int>();
-	for (int i = 0; i < numSpritesToUpdate; i++)
+	index = -1;
+	for (unsigned int delta = msg.ReadVarUInt(); delta != 0; delta = msg.ReadVarUInt())
 	{
-		int spriteNum = msg.Read<int>();
-		memcpy(&::sprite[spriteNum], msg.ReadData(sizeof(SPRITETYPE)), sizeof(SPRITETYPE));
+		index += delta;
+		ReadEntryDelta(msg, spriteFields, NUM_SNAPSHOT_FIELDS(spriteFields), (byte *)&clientBaseline->_sprite[index]);
+		memcpy(&::sprite[index], &clientBaseline->_sprite[index], sizeof(SPRITETYPE));
 	}
 
-	if (msg.Read<int>() != 6666)
+	if (msg.Read<int>() != SNAPSHOT_MARKER)
 	{
 		initprintf("packet error\n");
 	}
-	
-	//for (int i = 0; i < numSpritesToUpdate; i++)
-	//{
-	//	int spriteNum = msg.Read<int>();
-	//	memcpy(&::spriteext[spriteNum], msg.ReadData(sizeof(spriteext_t)), sizeof(spriteext_t));
-	//}
-
-	msg.ReadData((byte *)&headspritesect[0], sizeof(int16_t) * MAXSECTORS);
-	msg.ReadData((byte *)&headspritestat[0], sizeof(int16_t) * MAXSTATUS);
-	msg.ReadData((byte *)&prevspritesect[0], sizeof(int16_t) * MAXSPRITES);
-	msg.ReadData((byte *)&prevspritestat[0], sizeof(int16_t) * MAXSPRITES);
-	msg.ReadData((byte *)&nextspritesect[0], sizeof(int16_t) * MAXSPRITES);
-	msg.ReadData((byte *)&nextspritestat[0], sizeof(int16_t) * MAXSPRITES);
+
+	int16_t *links[4] = { prevspritesect, nextspritesect, prevspritestat, nextspritestat };
+	index = -1;
+	for (unsigned int delta = msg.ReadVarUInt(); delta != 0; delta = msg.ReadVarUInt())
+	{
+		index += delta;
+		byte linkMask = msg.Read<byte>();
+		for (int l = 0; l < 4; l++)
+		{
+			if (linkMask & (1u << l))
+			{
+				links[l][index] = msg.Read<int16_t>();
+			}
+		}
+	}
+
+	index = -1;
+	for (unsigned int delta = msg.ReadVarUInt(); delta != 0; delta = msg.ReadVarUInt())
+	{
+		index += delta;
+		headspritesect[index] = msg.Read<int16_t>();
+	}
+
+	index = -1;
+	for (unsigned int delta = msg.ReadVarUInt(); delta != 0; delta = msg.ReadVarUInt())
+	{
+		index += delta;
+		headspritestat[index] = msg.Read<int16_t>();
+	}
+
+	clientSequence = sequence;
 
 	ReadPlayerSnapshotInfo(msg);
 
@@ -341,4 +625,4 @@ void Snapshot::RestoreSnapshot()
 	//memcpy(&::prevspritestat[0], &snapshotSpriteStat.prevspritestat[0], sizeof(int16_t) * MAXSPRITES);
 	//memcpy(&::nextspritesect[0], &snapshotSpriteStat.nextspritesect[0], sizeof(int16_t) * MAXSPRITES);
 	//memcpy(&::nextspritestat[0], &snapshotSpriteStat.nextspritestat[0], sizeof(int16_t) * MAXSPRITES);
-}
\ No newline at end of file
+}
@@ -5,6 +5,18 @@
 
 #include "BitMsg.h"
 
+#define SNAPSHOT_MAX_CLIENTS			16
+
+// Baseline sequence that tells the client to delta against an empty world.
+#define SNAPSHOT_FULL_BASELINE			0
+
+// Sequence a client acknowledges to request a full update.
+#define SNAPSHOT_REQUEST_FULL			-1
+
+// Snapshots a client may have outstanding before the server holds off; the pending sets keep
+// collecting changes in the meantime, so the next snapshot still covers everything.
+#define SNAPSHOT_MAX_UNACKED			32
+
 //
 // SnapshotSpriteStat
 //
@@ -18,6 +30,41 @@ struct SnapshotSpriteStat
 	int16_t nextspritestat[MAXSPRITES];
 };
 
+//
+// SnapshotPending
+//
+// Entries that have to be compared against a client baseline on the next packet,
+// gathered from the engine change journal.
+//
+struct SnapshotPending
+{
+	uint8_t sprites[(MAXSPRITES + 7) >> 3];
+	uint8_t spriteLinks[(MAXSPRITES + 7) >> 3];
+	uint8_t headSect[(MAXSECTORS + 1 + 7) >> 3];
+	uint8_t headStat[(MAXSTATUS + 1 + 7) >> 3];
+	uint8_t sectors[(MAXSECTORS + 7) >> 3];
+	uint8_t walls[(MAXWALLS + 7) >> 3];
+};
+
+class Snapshot;
+
+//
+// SnapshotBaseline
+//
+// The world state a client is known to hold. Snapshots are sent on a reliable, ordered
+// channel, so everything the server has written against a baseline is what the client
+// holds once it has acknowledged it; the client can ask for a rebase on an empty world.
+//
+struct SnapshotBaseline
+{
+	bool				active;
+	bool				needsFullUpdate;
+	int					sequence;
+	int					acknowledgedSequence;
+	Snapshot			*state;
+	SnapshotPending		*pending;
+};
+
 //
 // Snapshot
 //
@@ -28,8 +75,17 @@ public:
 	void				CreateSnapshot();
 	void				RestoreSnapshot();
 
-	static void			CreateSnapshotPacket(BitMsg &msg);
+	static void			CreateSnapshotPacket(BitMsg &msg, int clientNum = 0);
 	static void			RestoreSnapshotPacket(BitMsg &msg);
+
+	// Server side, false while the client is SNAPSHOT_MAX_UNACKED snapshots behind.
+	static bool			CanSendSnapshot(int clientNum);
+
+	// Server side, called when a client acknowledges a snapshot sequence.
+	static void			AcknowledgeSnapshot(int clientNum, int sequence);
+
+	// Client side, the sequence that should be acknowledged to the server.
+	static int			GetAcknowledgeSequence();
 public:
 	int16_t _numwalls;
 	walltype _wall[MAXWALLS];
@@ -38,4 +94,4 @@ public:
 	SPRITETYPE _sprite[MAXSPRITES];
 	spriteext_t _spriteext[MAXSPRITES];
 	SnapshotSpriteStat _snapshotSpriteStat;
-};
\ No newline at end of file
+};
@@ -1094,6 +1094,7 @@ InitGame ( VOID )
     InitAutoNet();
     inittimer ( 120 );
     CON_InitConsole();  // Init console command list
+    networkSystem->InitOSD();
     CDAudio_Init();         // Init Red Book Audio
     ////DSPRINTF(ds,"%s, %d",__FILE__,__LINE__);   MONO_PRINT(ds);
     //InitFX();
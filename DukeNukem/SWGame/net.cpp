@@ -1090,7 +1090,7 @@ faketimerhandler ( void )
 		msg.Write<byte>(PACKET_TYPE_SENDPLAYERINPUT);
 		msg.Write<int>(myconnectindex);
 		msg.WriteData((byte *)&loc, sizeof(SW_PACKET));
-		networkSystem->SendPacket(msg.GetBuffer(), msg.GetLength(), true);
+		networkSystem->SendPacket(msg.GetBuffer(), msg.GetWrittenLength(), true);
 	}
     pp->movefifoend++;
     #if 0
@@ -1175,17 +1175,24 @@ faketimerhandler ( void )
 			// Only send this packet every 20ms.
 			if (currentTick - lastTick > 20)
 			{
-				BitMsg msg;
 				static char *snapShotBuffer = NULL;
 				if (snapShotBuffer == NULL)
 				{
 					snapShotBuffer = new char[sizeof(Snapshot) * 2];
 				}
 
-				msg.SetData((byte *)snapShotBuffer, sizeof(Snapshot) + 1);
-				msg.Write<byte>(PACKET_TYPE_SNAPSHOT);
-				Snapshot::CreateSnapshotPacket(msg);
-				netsendpacket(0, (char *)msg.GetBuffer(), msg.GetWrittenLength(), true);
+				// Every client is delta'd against its own baseline.
+				for (int clientNum = 0; clientNum < SNAPSHOT_MAX_CLIENTS; clientNum++)
+				{
+					if (!networkSystem->IsPeerConnected(clientNum) || !Snapshot::CanSendSnapshot(clientNum))
+						continue;
+
+					BitMsg msg;
+					msg.SetData((byte *)snapShotBuffer, sizeof(Snapshot) * 2);
+					msg.Write<byte>(PACKET_TYPE_SNAPSHOT);
+					Snapshot::CreateSnapshotPacket(msg, clientNum);
+					networkSystem->SendPacketToPeer(clientNum, msg.GetBuffer(), msg.GetWrittenLength(), true);
+				}
 				lastTick = GetTickCount64();
 			}
 		}
@@ -1424,7 +1431,8 @@ getpackets ( VOID )
 	}
 
 	BitMsg msg;
-	while (networkSystem->GetNextPacket(msg))
+	int peerNum;
+	while (networkSystem->GetNextPacket(msg, &peerNum))
     {
 		if (isServer)
 		{
@@ -1444,9 +1452,27 @@ getpackets ( VOID )
 					net_recievedFirstPacket = true;
 					msg.Read<byte>(); // skip the opcode.
 					Snapshot::RestoreSnapshotPacket(msg);
+
+					// Let the server know which baseline we hold.
+					BitMsg ackMsg;
+					byte ackBuffer[16];
+					ackMsg.SetData(ackBuffer, sizeof(ackBuffer));
+					ackMsg.Write<byte>(PACKET_TYPE_SNAPSHOTACK);
+					ackMsg.Write<int>(myconnectindex);
+					ackMsg.Write<int>(Snapshot::GetAcknowledgeSequence());
+					networkSystem->SendPacket(ackMsg.GetBuffer(), ackMsg.GetWrittenLength(), true);
 				}
 			break;
 
+			case PACKET_TYPE_SNAPSHOTACK:
+				if (isServer)
+				{
+					msg.Read<byte>(); // skip the opcode.
+					msg.Read<int>(); // remote client id, the baseline belongs to the peer that sent the ack.
+					Snapshot::AcknowledgeSnapshot(peerNum, msg.Read<int>());
+				}
+				break;
+
 			case PACKET_TYPE_SENDPLAYERINPUT:
 				if (isServer)
 				{
@@ -46,6 +46,7 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 #define PACKET_TYPE_SPAWNPLAYERS					39
 #define PACKET_TYPE_SNAPSHOT						40
 #define PACKET_TYPE_SENDPLAYERINPUT					41
+#define PACKET_TYPE_SNAPSHOTACK						42
 // jmarshall end
 
 #define PACKET_TYPE_NULL_PACKET                     127
@@ -57,6 +57,7 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 #include "player.h"
 
 #include "saveable.h"
+#include "clipgrid.h"
 
 //void TimerFunc(task * Task);
 
@@ -906,6 +907,7 @@ int LoadGame ( short save_num )
     MREAD ( headspritestat, sizeof ( headspritestat ), 1, fil );
     MREAD ( prevspritestat, sizeof ( prevspritestat ), 1, fil );
     MREAD ( nextspritestat, sizeof ( nextspritestat ), 1, fil );
+    clipgrid_invalidate();
     //User information
     memset ( User, 0, sizeof ( User ) );
     MREAD ( &SpriteNum, sizeof ( SpriteNum ), 1, fil );
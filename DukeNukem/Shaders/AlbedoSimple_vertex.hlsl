@@ -19,7 +19,7 @@ VertexShaderOutput main(VertexShaderInput input)
 	output.position = vertex;
 	output.texcoord0 = input.texcoord0;
 	output.texcoord1 = input.position.xyz; // mul(mWorldView, float4(input.position.xyz, 1.0));
-	output.texcoord2 = mul(transpose(mWorldViewInverse), float4(input.normal.xyz, 1.0));
+	output.texcoord2 = mul(transpose(mWorldViewInverse), float4(GetVertexNormal(input), 1.0));
 	output.texcoord3 = viewpositionanddepthoffset.xyz - input.position.xyz;
 #ifdef FAKE_TRANSPARENT
 	output.eyeposition.xyz = viewpositionanddepthoffset.xyz;
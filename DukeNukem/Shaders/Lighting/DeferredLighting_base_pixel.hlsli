@@ -16,6 +16,7 @@ cbuffer PS_CONSTANT_BUFFER : register(b0)
 	float4x4 invViewMatrix;
 	float4 spotDir;
 	float4 spotRadius;
+	float4 lightScreenRect;
 };
 
 #define USE_SLOW_POSITION_METHOD
@@ -1,5 +1,11 @@
 #include "../guishader.hlsli"
 
+// Same constant buffer as the pixel shader, we only need the screen tiles the light was binned into.
+cbuffer PS_CONSTANT_BUFFER : register(b0)
+{
+	float4 lightScreenRect : packoffset(c27);
+};
+
 struct VertexShaderInputWithoutBuffers
 {
 	uint vertexid : SV_VERTEXID;
@@ -9,7 +15,7 @@ VertexShaderOutput main(VertexShaderInputWithoutBuffers input)
 {
 	VertexShaderOutput output;
 
-	float2 texcoord = float2(input.vertexid & 1, input.vertexid >> 1);
+	float2 texcoord = lerp(lightScreenRect.xy, lightScreenRect.zw, float2(input.vertexid & 1, input.vertexid >> 1));
 	float4 vertex = float4((texcoord.x - 0.5f) * 2, -(texcoord.y - 0.5f) * 2, 0, 1);
 	output.position = vertex;
 	output.texcoord0 = texcoord;
@@ -1,4 +1,5 @@
 #include "AlbedoSimple.hlsli"
+#include "VertexShaderShared.hlsli"
 
 cbuffer VS_CONSTANT_BUFFER : register(b0)
 {
@@ -8,13 +9,6 @@ cbuffer VS_CONSTANT_BUFFER : register(b0)
 };
 
 
-struct VertexShaderInput
-{
-	float4 position  : POSITION;
-	float2 texcoord0 : TEXCOORD0;
-	float3 normal    : NORMAL;
-};
-
 float3 TransformPoint(float3 inpos)
 {
 	//	float3 pos;
@@ -32,9 +26,9 @@ VertexShaderOutput main(VertexShaderInput input)
 	float4 vertex = mul(mWorldViewProjection, float4(input.position.xyz, 1.0));
 	vertex.w += viewposition.w;
 	output.position = vertex;
-	output.texcoord0 = input.texcoord0;
+	output.texcoord0 = input.texcoord0.xy;
 	output.texcoord1 = input.position; // mul(mView, float4(input.position.xyz, 1.0));
-	output.texcoord2 = mul(transpose(mWorldViewInverse), float4(input.normal.xyz, 1.0));
+	output.texcoord2 = mul(transpose(mWorldViewInverse), float4(GetVertexNormal(input), 1.0));
 	output.texcoord3 = viewposition - input.position.xyz;
 	output.vDepthVS = vertex;
 	return output;
@@ -1,3 +1,29 @@
+// Has to match BUILD3D_PACKED_VERTEX in build3d.h.
+//#define BUILD3D_PACKED_VERTEX
+
+#ifdef BUILD3D_PACKED_VERTEX
+struct VertexShaderInput
+{
+	float4 position  : POSITION;
+	float4 texcoord0 : TEXCOORD0;
+	float2 normal : NORMAL;
+};
+
+//
+// GetVertexNormal
+//
+// Undoes the octahedral encoding in Build3D_PackVertex.
+//
+float3 GetVertexNormal(VertexShaderInput input)
+{
+	float3 n = float3(input.normal.xy, 1.0 - abs(input.normal.x) - abs(input.normal.y));
+	if (n.z < 0.0)
+	{
+		n.xy = (1.0 - abs(n.yx)) * (n.xy >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(n);
+}
+#else
 struct VertexShaderInput
 {
 	float4 position  : POSITION;
@@ -6,3 +32,12 @@ struct VertexShaderInput
 	//float4 binormal : BINORMAL;
 	float4 normal : NORMAL;
 };
+
+//
+// GetVertexNormal
+//
+float3 GetVertexNormal(VertexShaderInput input)
+{
+	return input.normal.xyz;
+}
+#endif
@@ -427,7 +427,6 @@ unsigned copy;
 }
 
 /* Macros for inflate(): */
-unsigned long ZEXPORT crc322(crc, buf, len);
 
 /* check function to use adler32() for zlib or crc32() for gzip */
 #ifdef GUNZIP
@@ -0,0 +1,24 @@
+// prefix.h
+//
+// Forced into every file of the headless Linux build. MSVC's standard headers put min and max in parentheses to get
+// past the compat.h and windows.h macros, libstdc++ doesn't, so the standard headers have to come first.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#endif
+
+#define __forceinline inline __attribute__((always_inline))
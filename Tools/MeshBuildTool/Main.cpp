@@ -1,13 +1,25 @@
 // Main.cpp
 //
+// Builds game_meshes.payloads out of every model under a directory. Models are imported with Assimp and optimized on
+// all cores, duplicate vertexes are welded, the triangles are reordered for the post transform cache and overdraw,
+// and the vertexes are renumbered in the order they are drawn. Every surface gets its bounds worked out for culling.
+//
+// The vertexes and indexes are written in deflated chunks (see MODELCACHE_PAYLOAD_CHUNKED_IDEN) and the payloads are
+// streamed to disk in order as they finish, so memory stays bounded no matter how many models there are.
+//
 
-#include <windows.h>
 #include <stdio.h>
+#include <string.h>
+#include <float.h>
 #include <string>
 #include <vector>
-#include <stack>
-#include <direct.h>
 #include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 
 #include "AssetImport/include/assimp/Importer.hpp"
 #include "AssetImport/include/assimp/scene.h"
@@ -15,99 +27,389 @@
 
 #define NOASM
 
+// build3d.h pulls in windows.h, so std::min and std::max are called as (std::min) below.
+
 #include "../../DukeNukem/Build/include/build3d.h"
 #include "../../DukeNukem/Build/src/PolymerNG/Models/ModelCacheFormat.h"
 
 #include "../../DukeNukem/Third-Party/zlib/zlib.h"
 
+#include "MeshOptimize.h"
+
+#ifdef _MSC_VER
 #define _CRT_SECURE_NO_WARNINGS
 #pragma warning(disable : 4996)
+#endif
 
-using namespace std;
+namespace fs = std::filesystem;
 
-bool ListFiles(string path, string mask, vector<string>& files) {
-	HANDLE hFind = INVALID_HANDLE_VALUE;
-	WIN32_FIND_DATAA ffd;
-	string spec;
-	stack<string> directories;
+// How far the workers can run ahead of the payload being written.
+#define MAX_PAYLOADS_IN_FLIGHT	16
 
-	directories.push(path);
-	files.clear();
+// Cluster sorting for overdraw may cost this much extra ACMR.
+#define OVERDRAW_ACMR_THRESHOLD	1.05f
 
-	while (!directories.empty()) {
-		path = directories.top();
-		spec = path + "\\" + mask;
-		directories.pop();
+//
+// MeshBuildStats
+//
+struct MeshBuildStats
+{
+	MeshBuildStats()
+	{
+		memset(this, 0, sizeof(MeshBuildStats));
+	}
 
-		hFind = FindFirstFileA(spec.c_str(), &ffd);
-		if (hFind == INVALID_HANDLE_VALUE) {
-			return false;
-		}
-		do {
-			if (strcmp(ffd.cFileName, ".") != 0 &&
-				strcmp(ffd.cFileName, "..") != 0) {
-				if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-					directories.push(path + "\\" + ffd.cFileName);
-				}
-				else
-				{
-					if (strstr(ffd.cFileName, ".md3") || strstr(ffd.cFileName, ".md2") || strstr(ffd.cFileName, ".fbx") || strstr(ffd.cFileName, ".3ds") || strstr(ffd.cFileName, ".ase") || strstr(ffd.cFileName, ".blender") || strstr(ffd.cFileName, ".obj"))
-					{
-						files.push_back(path + "\\" + ffd.cFileName);
-					}
-				}
-			}
-		} while (FindNextFileA(hFind, &ffd) != 0);
+	void Add(const MeshBuildStats &stats)
+	{
+		numSourceVertexes += stats.numSourceVertexes;
+		numVertexes += stats.numVertexes;
+		numTriangles += stats.numTriangles;
+		sourceMisses += stats.sourceMisses;
+		optimizedMisses += stats.optimizedMisses;
+		numUncompressedBytes += stats.numUncompressedBytes;
+		numCompressedBytes += stats.numCompressedBytes;
+	}
+
+	int64_t numSourceVertexes;
+	int64_t numVertexes;
+	int64_t numTriangles;
+
+	// ACMR times triangles, so models can be summed.
+	double sourceMisses;
+	double optimizedMisses;
+
+	int64_t numUncompressedBytes;
+	int64_t numCompressedBytes;
+};
+
+//
+// BuildOptions
+//
+struct BuildOptions
+{
+	BuildOptions()
+	{
+		packVertexes = false;
+		zlibLevel = Z_BEST_COMPRESSION;
+		numThreads = 0;
+		verbose = false;
+	}
+
+	bool packVertexes;
+	int zlibLevel;
+	int numThreads;
+	bool verbose;
+};
 
-		if (GetLastError() != ERROR_NO_MORE_FILES) {
-			FindClose(hFind);
+//
+// BuildJob
+//
+struct BuildJob
+{
+	BuildJob()
+	{
+		failed = false;
+		isDone = false;
+	}
+
+	std::string fullPath;
+	ModelCachePayloadHeader payloadHeader;
+
+	// Everything from the payload info to the end chunk, ready to write.
+	std::vector<unsigned char> payloadData;
+	MeshBuildStats stats;
+
+	bool failed;
+	bool isDone;
+};
+
+//
+// ListFiles
+//
+static bool ListFiles(const fs::path &root, std::vector<std::string> &files)
+{
+	static const char *extensions[] = { ".md3", ".md2", ".fbx", ".3ds", ".ase", ".blender", ".obj" };
+
+	std::error_code error;
+	fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, error);
+	if (error)
+	{
+		printf("Failed to read %s: %s\n", root.string().c_str(), error.message().c_str());
+		return false;
+	}
+
+	for (; it != fs::recursive_directory_iterator(); it.increment(error))
+	{
+		if (error)
+		{
+			printf("Failed to read %s: %s\n", root.string().c_str(), error.message().c_str());
 			return false;
 		}
 
-		FindClose(hFind);
-		hFind = INVALID_HANDLE_VALUE;
+		if (!it->is_regular_file())
+			continue;
+
+		std::string extension = it->path().extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		for (int i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++)
+		{
+			if (extension == extensions[i])
+			{
+				files.push_back(it->path().string());
+				break;
+			}
+		}
 	}
 
+	// Directory order differs between platforms and file systems, this keeps the output the same everywhere.
+	std::sort(files.begin(), files.end());
 	return true;
 }
 
 //
-// CovertedMeshInternal
+// AppendData
 //
-struct CovertedMeshInternal
+static void AppendData(std::vector<unsigned char> &out, const void *data, int length)
 {
+	const unsigned char *bytes = (const unsigned char *)data;
+	out.insert(out.end(), bytes, bytes + length);
+}
+
+//
+// AppendChunks
+//
+// Splits the elements into chunks of at most MODELCACHE_CHUNK_SIZE and deflates each one, chunks that don't get any
+// smaller are stored.
+//
+static void AppendChunks(std::vector<unsigned char> &out, ModelCacheChunkType type, const void *data, int numElements, int elementSize, const BuildOptions &options, MeshBuildStats &stats)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	int elementsPerChunk = MODELCACHE_CHUNK_SIZE / elementSize;
+	std::vector<unsigned char> compressed;
+
+	for (int start = 0; start < numElements; start += elementsPerChunk)
+	{
+		int length = (std::min)(elementsPerChunk, numElements - start) * elementSize;
+		const unsigned char *chunkData = &bytes[start * elementSize];
+
+		z_stream defstream;
+		memset(&defstream, 0, sizeof(defstream));
+		deflateInit(&defstream, options.zlibLevel);
+		compressed.resize(deflateBound(&defstream, length));
+
+		defstream.avail_in = length;
+		defstream.next_in = (Bytef *)chunkData;
+		defstream.avail_out = compressed.size();
+		defstream.next_out = (Bytef *)&compressed[0];
+
+		int compressedLength = 0;
+		if (deflate(&defstream, Z_FINISH) == Z_STREAM_END)
+			compressedLength = defstream.total_out;
+		deflateEnd(&defstream);
+
+		ModelCacheChunkHeader chunk;
+		chunk.type = type;
+		chunk.decompressedLength = length;
+		if (compressedLength <= 0 || compressedLength >= length)
+		{
+			chunk.codec = MODELCACHE_CODEC_STORED;
+			chunk.compressedLength = length;
+			AppendData(out, &chunk, sizeof(ModelCacheChunkHeader));
+			AppendData(out, chunkData, length);
+		}
+		else
+		{
+			chunk.codec = MODELCACHE_CODEC_ZLIB;
+			chunk.compressedLength = compressedLength;
+			AppendData(out, &chunk, sizeof(ModelCacheChunkHeader));
+			AppendData(out, &compressed[0], compressedLength);
+		}
+
+		stats.numUncompressedBytes += length;
+		stats.numCompressedBytes += chunk.compressedLength;
+	}
+}
+
+//
+// BuildModel
+//
+static bool BuildModel(BuildJob &job, const BuildOptions &options)
+{
+	// Importers aren't shared between threads, separate ones are safe to use at the same time.
+	Assimp::Importer Importer;
+
+	const aiScene* pScene = Importer.ReadFile(job.fullPath.c_str(), aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs);
+	if (pScene == NULL)
+	{
+		printf("%s: Failed to load: %s\n", job.fullPath.c_str(), Importer.GetErrorString());
+		return false;
+	}
+
+	if (pScene->mNumMeshes > MAX_MODEL_SURFACES)
+	{
+		printf("%s: %d meshes, the engine can only draw %d\n", job.fullPath.c_str(), pScene->mNumMeshes, MAX_MODEL_SURFACES);
+		return false;
+	}
+
 	ModelCachePayloadInfo meshCacheInfo;
-	std::vector<ModelCacheSurface> surfaces;
+	std::vector<ModelCacheSurface> surfaces(pScene->mNumMeshes);
+	std::vector<ModelCacheSurfaceBounds> surfaceBounds(pScene->mNumMeshes);
 	std::vector<Build3DVertex> vertexes;
 	std::vector<unsigned int> indexes;
-};
 
-std::vector<CovertedMeshInternal> meshes;
-std::vector<ModelCachePayloadHeader> payloadHeaders;
+	// Create all the meshes.
+	for (int d = 0; d < pScene->mNumMeshes; d++)
+	{
+		aiMesh *_aimesh = pScene->mMeshes[d];
+		ModelCacheSurface *_cacheMesh = &surfaces[d];
 
-void WriteCompressedData(FILE *file, void *data, int data_length)
-{
-	// zlib struct
-	z_stream defstream;
-	defstream.zalloc = Z_NULL;
-	defstream.zfree = Z_NULL;
-	defstream.opaque = Z_NULL;
+		memset(_cacheMesh, 0, sizeof(ModelCacheSurface));
 
-	byte *compressed_buffer = new byte[data_length];
+		// Grab the surface name which is the mesh name(todo we need to do some preprocessing here probably).
+		strncpy(_cacheMesh->material, _aimesh->mName.C_Str(), sizeof(_cacheMesh->material) - 1);
 
-	// Now write out all the payloads, while recording were each payload is in the file.
-	defstream.avail_in = data_length; // size of input, string + terminator
-	defstream.next_in = (Bytef *)data; // input char array
-	defstream.avail_out = data_length; // size of output
-	defstream.next_out = (Bytef *)compressed_buffer; // output char array
+		// Grab all the vertexes.
+		std::vector<Build3DVertex> surfaceVertexes(_aimesh->mNumVertices);
+		for (int v = 0; v < _aimesh->mNumVertices; v++)
+		{
+			Build3DVertex &vertex = surfaceVertexes[v];
+
+			vertex.position.x = _aimesh->mVertices[v].x;
+			vertex.position.y = _aimesh->mVertices[v].y;
+			vertex.position.z = _aimesh->mVertices[v].z;
 
-	deflateInit(&defstream, Z_BEST_COMPRESSION);
-	deflate(&defstream, Z_FINISH);
-	deflateEnd(&defstream);
+			if (_aimesh->HasTextureCoords(0))
+			{
+				vertex.uv.x = _aimesh->mTextureCoords[0][v].x;
+				vertex.uv.y = _aimesh->mTextureCoords[0][v].y;
+			}
+
+			if (_aimesh->HasNormals())
+			{
+				vertex.normal.x = _aimesh->mNormals[v].x;
+				vertex.normal.y = _aimesh->mNormals[v].y;
+				vertex.normal.z = _aimesh->mNormals[v].z;
+			}
+		}
+
+		// Grab all the indexes, points and lines that made it through triangulation are dropped.
+		std::vector<unsigned int> surfaceIndexes;
+		for (int v = 0; v < _aimesh->mNumFaces; v++)
+		{
+			aiFace *face = &_aimesh->mFaces[v];
+			if (face->mNumIndices != 3)
+				continue;
+
+			surfaceIndexes.push_back(face->mIndices[0]);
+			surfaceIndexes.push_back(face->mIndices[1]);
+			surfaceIndexes.push_back(face->mIndices[2]);
+		}
+
+		int numVertexes = surfaceVertexes.size();
+		job.stats.numSourceVertexes += numVertexes;
+		job.stats.numTriangles += surfaceIndexes.size() / 3;
+		job.stats.sourceMisses += MeshOpt_ComputeACMR(surfaceIndexes, numVertexes) * (surfaceIndexes.size() / 3);
+
+		if (numVertexes > 0)
+		{
+			numVertexes = MeshOpt_WeldVertexes(&surfaceVertexes[0], numVertexes, sizeof(Build3DVertex), surfaceIndexes);
+			MeshOpt_OptimizeVertexCache(surfaceIndexes, numVertexes);
+			MeshOpt_OptimizeOverdraw(surfaceIndexes, &surfaceVertexes[0].position.x, sizeof(Build3DVertex), numVertexes, OVERDRAW_ACMR_THRESHOLD);
+			numVertexes = MeshOpt_OptimizeVertexFetch(&surfaceVertexes[0], numVertexes, sizeof(Build3DVertex), surfaceIndexes);
+			surfaceVertexes.resize(numVertexes);
+		}
 
-	fwrite(compressed_buffer, defstream.total_out, 1, file);
+		job.stats.numVertexes += numVertexes;
+		job.stats.optimizedMisses += MeshOpt_ComputeACMR(surfaceIndexes, numVertexes) * (surfaceIndexes.size() / 3);
 
-	delete compressed_buffer;
+		ModelCacheSurfaceBounds &bounds = surfaceBounds[d];
+		for (int i = 0; i < 3; i++)
+		{
+			bounds.mins[i] = numVertexes > 0 ? FLT_MAX : 0.0f;
+			bounds.maxs[i] = numVertexes > 0 ? -FLT_MAX : 0.0f;
+		}
+		for (int v = 0; v < numVertexes; v++)
+		{
+			const float *position = &surfaceVertexes[v].position.x;
+			for (int i = 0; i < 3; i++)
+			{
+				bounds.mins[i] = (std::min)(bounds.mins[i], position[i]);
+				bounds.maxs[i] = (std::max)(bounds.maxs[i], position[i]);
+			}
+		}
+
+		_cacheMesh->startVertex = vertexes.size();
+		_cacheMesh->numVertexes = numVertexes;
+		_cacheMesh->startIndex = indexes.size();
+		_cacheMesh->numIndexes = surfaceIndexes.size();
+
+		vertexes.insert(vertexes.end(), surfaceVertexes.begin(), surfaceVertexes.end());
+		indexes.insert(indexes.end(), surfaceIndexes.begin(), surfaceIndexes.end());
+	}
+
+	meshCacheInfo.numFrames = 1;
+	meshCacheInfo.numVertexes = vertexes.size();
+	meshCacheInfo.numIndexes = indexes.size();
+	meshCacheInfo.numSurfaces = surfaces.size();
+
+	std::vector<unsigned char> &out = job.payloadData;
+	AppendData(out, &meshCacheInfo, sizeof(ModelCachePayloadInfo));
+	if (!surfaces.empty())
+	{
+		AppendData(out, &surfaces[0], surfaces.size() * sizeof(ModelCacheSurface));
+		AppendData(out, &surfaceBounds[0], surfaceBounds.size() * sizeof(ModelCacheSurfaceBounds));
+	}
+
+	// Write out all the vertexes.
+	if (options.packVertexes)
+	{
+		std::vector<Build3DPackedVertex> packedVertexes(vertexes.size());
+		for (int d = 0; d < vertexes.size(); d++)
+		{
+			Build3D_PackVertex(vertexes[d], -1, packedVertexes[d]);
+		}
+		AppendChunks(out, MODELCACHE_CHUNK_PACKED_VERTEXES, packedVertexes.data(), packedVertexes.size(), sizeof(Build3DPackedVertex), options, job.stats);
+	}
+	else
+	{
+		AppendChunks(out, MODELCACHE_CHUNK_VERTEXES, vertexes.data(), vertexes.size(), sizeof(Build3DVertex), options, job.stats);
+	}
+
+	// Write out all the indexes.
+	AppendChunks(out, MODELCACHE_CHUNK_INDEXES, indexes.data(), indexes.size(), sizeof(unsigned int), options, job.stats);
+
+	ModelCacheChunkHeader endChunk;
+	memset(&endChunk, 0, sizeof(ModelCacheChunkHeader));
+	endChunk.type = MODELCACHE_CHUNK_END;
+	AppendData(out, &endChunk, sizeof(ModelCacheChunkHeader));
+
+	return true;
+}
+
+//
+// PrintUsage
+//
+static void PrintUsage()
+{
+	printf("Usage: MeshBuildTool [options] [directory]\n");
+	printf("  -packed       writes Build3DPackedVertex, what BUILD3D_PACKED_VERTEX builds want\n");
+	printf("  -level <n>    zlib level, 0-9, defaults to 9\n");
+	printf("  -threads <n>  worker threads, defaults to one per core\n");
+	printf("  -v            prints the stats of every model\n");
+}
+
+//
+// PrintStats
+//
+static void PrintStats(const char *name, const MeshBuildStats &stats)
+{
+	double numTriangles = stats.numTriangles > 0 ? (double)stats.numTriangles : 1.0;
+	double vertexReduction = stats.numSourceVertexes > 0 ? 100.0 * (1.0 - (double)stats.numVertexes / stats.numSourceVertexes) : 0.0;
+
+	printf("%s: %lld tris, %lld to %lld vertexes (-%.1f%%), ACMR %.3f to %.3f, %lldkb to %lldkb\n", name, (long long)stats.numTriangles,
+		(long long)stats.numSourceVertexes, (long long)stats.numVertexes, vertexReduction,
+		stats.sourceMisses / numTriangles, stats.optimizedMisses / numTriangles,
+		(long long)(stats.numUncompressedBytes >> 10), (long long)(stats.numCompressedBytes >> 10));
 }
 
 //
@@ -115,143 +417,209 @@ void WriteCompressedData(FILE *file, void *data, int data_length)
 //
 int main(int argc, char **argv)
 {
-	vector<string> files;
+	BuildOptions options;
+	fs::path root = fs::current_path();
 
-	char *cwd = _getcwd(NULL, 0);
+	printf("MeshBuildTool v0.02 by Justin Marshall\n");
 
-	printf("MeshBuildTool v0.01 by Justin Marshall\n");
-	printf("Finding model files...\n");
-	if (!ListFiles(cwd, "*", files))
+	for (int i = 1; i < argc; i++)
 	{
-		return 0;
+		if (!strcmp(argv[i], "-packed"))
+		{
+			options.packVertexes = true;
+		}
+		else if (!strcmp(argv[i], "-level") && i + 1 < argc)
+		{
+			options.zlibLevel = (std::min)((std::max)(atoi(argv[++i]), 0), 9);
+		}
+		else if (!strcmp(argv[i], "-threads") && i + 1 < argc)
+		{
+			options.numThreads = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "-v"))
+		{
+			options.verbose = true;
+		}
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage();
+			return 1;
+		}
+		else
+		{
+			root = argv[i];
+		}
 	}
 
-	printf("Found %d assets\n", files.size());
+	if (options.numThreads <= 0)
+	{
+		options.numThreads = (std::max)((int)std::thread::hardware_concurrency(), 1);
+	}
 
-	for (int i = 0; i < files.size(); i++)
+	printf("Finding model files...\n");
+	std::vector<std::string> files;
+	if (!ListFiles(root, files))
 	{
-		printf("Processing(%d/%d) %s\n", i, files.size(), files[i].c_str());
-		OutputDebugStringA(files[i].c_str());
-		OutputDebugStringA("\n");
+		return 1;
+	}
 
-		Assimp::Importer Importer;
+	printf("Found %d assets\n", (int)files.size());
+	if (files.empty())
+	{
+		return 0;
+	}
 
-		const aiScene* pScene = Importer.ReadFile(files[i].c_str(), aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs);
-		if (pScene == NULL)
+	std::vector<BuildJob> jobs(files.size());
+	for (int i = 0; i < files.size(); i++)
+	{
+		std::string name = fs::relative(files[i], root).generic_string();
+		if (name.size() >= sizeof(jobs[i].payloadHeader.modelpath))
 		{
-			printf("...Failed to load!\n");
-			OutputDebugStringA("...Failed to load\n");
-			return 0;
+			printf("%s: name is longer than %d characters\n", name.c_str(), (int)sizeof(jobs[i].payloadHeader.modelpath) - 1);
+			return 1;
 		}
 
-		printf("...%d mesh detected\n", pScene->mNumMeshes);
+		jobs[i].fullPath = files[i];
+		memset(jobs[i].payloadHeader.modelpath, 0, sizeof(jobs[i].payloadHeader.modelpath));
+		strcpy(jobs[i].payloadHeader.modelpath, name.c_str());
+		jobs[i].payloadHeader.modelWritePosition = 0;
+	}
 
-		CovertedMeshInternal mesh;
-		mesh.surfaces.resize(pScene->mNumMeshes);
+	const std::string payloadFileName = (root / "game_meshes.payloads").string();
+	const std::string tempFileName = payloadFileName + ".tmp";
 
-		// Create all the meshes.
-		for (int d = 0; d < pScene->mNumMeshes; d++)
-		{
-			aiMesh *_aimesh = pScene->mMeshes[d];
-			ModelCacheSurface *_cacheMesh = &mesh.surfaces[d];
+	FILE *cacheFile = fopen(tempFileName.c_str(), "wb");
+	if (cacheFile == NULL)
+	{
+		printf("Failed to open %s for writing\n", tempFileName.c_str());
+		return 1;
+	}
 
-			_cacheMesh->startVertex = mesh.vertexes.size();
-			_cacheMesh->numVertexes = _aimesh->mNumVertices;
+	ModelCacheHeader header;
+	memset(header.iden, 0, sizeof(header.iden));
+	strcpy(header.iden, MODELCACHE_PAYLOAD_CHUNKED_IDEN);
+	header.numPayloads = jobs.size();
+	fwrite(&header, sizeof(ModelCacheHeader), 1, cacheFile);
 
-			// Grab all the vertexes.
-			for (int v = 0; v < _aimesh->mNumVertices; v++)
-			{
-				Build3DVertex vertex;
+	// The payload headers get filled in once we know where everything ended up.
+	long payloadStartPosition = ftell(cacheFile);
+	for (int i = 0; i < jobs.size(); i++)
+	{
+		fwrite(&jobs[i].payloadHeader, sizeof(ModelCachePayloadHeader), 1, cacheFile);
+	}
 
-				vertex.position.x = _aimesh->mVertices[v].x;
-				vertex.position.y = _aimesh->mVertices[v].y;
-				vertex.position.z = _aimesh->mVertices[v].z;
+	printf("Building %d models on %d threads...\n", (int)jobs.size(), options.numThreads);
+	auto startTime = std::chrono::steady_clock::now();
 
-				vertex.uv.x = _aimesh->mTextureCoords[0][v].x;
-				vertex.uv.y = _aimesh->mTextureCoords[0][v].y;
+	std::mutex jobLock;
+	std::condition_variable jobDone;
+	std::condition_variable jobWritten;
+	std::atomic<int> nextJob(0);
+	std::atomic<bool> abortBuild(false);
+	int numWritten = 0;
 
-				mesh.vertexes.push_back(vertex);
-			}
+	auto worker = [&]()
+	{
+		for (;;)
+		{
+			int jobNum = nextJob++;
+			if (jobNum >= jobs.size())
+				break;
 
-			_cacheMesh->startIndex = mesh.indexes.size();
-			_cacheMesh->numIndexes = 0;
+			// Don't get too far ahead of the writer, everything in flight is held in memory.
+			{
+				std::unique_lock<std::mutex> lock(jobLock);
+				jobWritten.wait(lock, [&] { return jobNum < numWritten + MAX_PAYLOADS_IN_FLIGHT || abortBuild; });
+			}
 
-			// Grab the surface name which is the mesh name(todo we need to do some preprocessing here probably).
-			strcpy(_cacheMesh->material, _aimesh->mName.C_Str());
+			BuildJob &job = jobs[jobNum];
+			bool failed = abortBuild || !BuildModel(job, options);
 
-			// Grab all the indexes.
-			for (int v = 0; v < _aimesh->mNumFaces; v++)
 			{
-				aiFace *face = &_aimesh->mFaces[v];
-				for (int ii = 0; ii < face->mNumIndices; ii++)
+				std::lock_guard<std::mutex> lock(jobLock);
+				job.failed = failed;
+				job.isDone = true;
+				if (failed)
 				{
-					mesh.indexes.push_back(face->mIndices[ii]);
-					_cacheMesh->numIndexes++;
+					abortBuild = true;
 				}
 			}
+			jobDone.notify_all();
+			jobWritten.notify_all();
 		}
+	};
 
-		ModelCachePayloadHeader payloadHeader;
-		memset(payloadHeader.modelpath, 0, sizeof(payloadHeader.modelpath));
-		std::replace(files[i].begin(), files[i].end(), '\\', '/');
-		strcpy(payloadHeader.modelpath, files[i].c_str() + strlen(cwd) + 1);
-		payloadHeader.modelWritePosition = 0;
-		payloadHeaders.push_back(payloadHeader);
-
-		mesh.meshCacheInfo.numFrames = 1;
-		mesh.meshCacheInfo.numVertexes = mesh.vertexes.size();
-		mesh.meshCacheInfo.numIndexes = mesh.indexes.size();
-		mesh.meshCacheInfo.numSurfaces = mesh.surfaces.size();
-
-		meshes.push_back(mesh);
-	}
-
-	printf("Writing mesh payloads files.\n");
-	// Write out our payload info's.
-	FILE *cacheFile = fopen("game_meshes.payloads", "wb");
-	ModelCacheHeader header;
-	header.numPayloads = meshes.size();
-	fwrite(&header, sizeof(ModelCacheHeader), 1, cacheFile);
-
-	// Write out all the payload headers.
-	int payloadStartPosition = ftell(cacheFile);
-	for (int i = 0; i < meshes.size(); i++)
+	std::vector<std::thread> workers;
+	for (int i = 0; i < options.numThreads; i++)
 	{
-		fwrite(&payloadHeaders[i], sizeof(ModelCachePayloadHeader), 1, cacheFile);
+		workers.push_back(std::thread(worker));
 	}
 
-	// Write out each model.
-	for (int i = 0; i < meshes.size(); i++)
+	// Stream the payloads out in order as they finish.
+	MeshBuildStats totalStats;
+	for (int i = 0; i < jobs.size() && !abortBuild; i++)
 	{
-		CovertedMeshInternal *mesh = &meshes[i];
+		BuildJob &job = jobs[i];
+		{
+			std::unique_lock<std::mutex> lock(jobLock);
+			jobDone.wait(lock, [&] { return job.isDone; });
+		}
 
-		printf("Writing Mesh Data(%d/%d)\n", i, meshes.size());
+		if (job.failed)
+			break;
+
+		job.payloadHeader.modelWritePosition = ftell(cacheFile);
+		fwrite(&job.payloadData[0], job.payloadData.size(), 1, cacheFile);
+		std::vector<unsigned char>().swap(job.payloadData);
+
+		if (options.verbose)
+		{
+			PrintStats(job.payloadHeader.modelpath, job.stats);
+		}
+		totalStats.Add(job.stats);
 
-		payloadHeaders[i].modelWritePosition = ftell(cacheFile);
+		{
+			std::lock_guard<std::mutex> lock(jobLock);
+			numWritten = i + 1;
+		}
+		jobWritten.notify_all();
 
-		// Write out the cache info.
-		fwrite(&mesh->meshCacheInfo, sizeof(ModelCachePayloadInfo), 1, cacheFile);
-		
-		// Write out each surface for this mesh.
-		for (int d = 0; d < mesh->surfaces.size(); d++)
+		if (!options.verbose && ((i + 1) % 64 == 0 || i + 1 == jobs.size()))
 		{
-			fwrite(&mesh->surfaces[d], sizeof(ModelCacheSurface), 1, cacheFile);
+			printf("..%d/%d models\n", i + 1, (int)jobs.size());
 		}
+	}
 
-		// Write out all the vertexes.
-		fwrite(&mesh->vertexes[0], sizeof(Build3DVertex) * mesh->vertexes.size(), 1, cacheFile);
-		//WriteCompressedData(cacheFile, &mesh->vertexes[0], sizeof(Build3DVertex) * mesh->vertexes.size());
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
 
-		// Write out all the indexes.
-		fwrite(&mesh->indexes[0], sizeof(unsigned int) * mesh->indexes.size(), 1, cacheFile);
-		//WriteCompressedData(cacheFile, &mesh->indexes[0], sizeof(unsigned int) * mesh->indexes.size());
+	if (abortBuild)
+	{
+		fclose(cacheFile);
+		remove(tempFileName.c_str());
+		return 1;
 	}
 
 	// Re-write out all the payload headers with the updated position.
 	fseek(cacheFile, payloadStartPosition, SEEK_SET);
-	for (int i = 0; i < meshes.size(); i++)
+	for (int i = 0; i < jobs.size(); i++)
+	{
+		fwrite(&jobs[i].payloadHeader, sizeof(ModelCachePayloadHeader), 1, cacheFile);
+	}
+	fclose(cacheFile);
+
+	std::error_code error;
+	fs::rename(tempFileName, payloadFileName, error);
+	if (error)
 	{
-		fwrite(&payloadHeaders[i], sizeof(ModelCachePayloadHeader), 1, cacheFile);
+		printf("Failed to replace %s: %s\n", payloadFileName.c_str(), error.message().c_str());
+		return 1;
 	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	PrintStats("Total", totalStats);
+	printf("Wrote %d models in %.1f seconds\n", (int)jobs.size(), seconds);
 	return 0;
-};
\ No newline at end of file
+}
@@ -0,0 +1,434 @@
+// MeshOptimize.cpp
+//
+
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+
+#include "MeshOptimize.h"
+
+// Cache the triangle order is optimized for, bigger than MESHOPT_ACMR_CACHE_SIZE so it still does well on GPUs with
+// a bigger cache.
+#define FORSYTH_CACHE_SIZE			32
+#define FORSYTH_CACHE_DECAY_POWER	1.5f
+#define FORSYTH_LAST_TRI_SCORE		0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE	2.0f
+#define FORSYTH_VALENCE_BOOST_POWER	0.5f
+
+//
+// HashVertex
+//
+static uint32_t HashVertex(const unsigned char *vertex, int vertexSize)
+{
+	uint32_t hash = 2166136261U;
+	for (int i = 0; i < vertexSize; i++)
+	{
+		hash ^= vertex[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+//
+// MeshOpt_WeldVertexes
+//
+int MeshOpt_WeldVertexes(void *vertexes, int numVertexes, int vertexSize, std::vector<unsigned int> &indexes)
+{
+	unsigned char *data = (unsigned char *)vertexes;
+
+	int tableSize = 1;
+	while (tableSize < numVertexes * 2)
+	{
+		tableSize <<= 1;
+	}
+
+	// Open addressing, each slot holds a welded vertex number or -1.
+	std::vector<int> table(tableSize, -1);
+	std::vector<unsigned int> remap(numVertexes);
+	int numWelded = 0;
+
+	for (int i = 0; i < numVertexes; i++)
+	{
+		const unsigned char *vertex = &data[i * vertexSize];
+		uint32_t slot = HashVertex(vertex, vertexSize) & (tableSize - 1);
+
+		while (table[slot] != -1 && memcmp(&data[table[slot] * vertexSize], vertex, vertexSize))
+		{
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if (table[slot] == -1)
+		{
+			// Welded vertexes never move forward, so compacting in place is safe.
+			if (numWelded != i)
+			{
+				memcpy(&data[numWelded * vertexSize], vertex, vertexSize);
+			}
+			table[slot] = numWelded++;
+		}
+
+		remap[i] = table[slot];
+	}
+
+	for (int i = 0; i < indexes.size(); i++)
+	{
+		indexes[i] = remap[indexes[i]];
+	}
+
+	return numWelded;
+}
+
+//
+// FindVertexScore
+//
+static float FindVertexScore(int cachePosition, int remainingValence)
+{
+	if (remainingValence == 0)
+	{
+		// Nothing left to draw with this vertex.
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// The last triangle's vertexes get a fixed score so it doesn't just draw the same edge again.
+		if (cachePosition < 3)
+		{
+			score = FORSYTH_LAST_TRI_SCORE;
+		}
+		else
+		{
+			score = 1.0f - (cachePosition - 3) * (1.0f / (FORSYTH_CACHE_SIZE - 3));
+			score = powf(score, FORSYTH_CACHE_DECAY_POWER);
+		}
+	}
+
+	// Favour vertexes with few triangles left so lone triangles don't get left behind.
+	score += FORSYTH_VALENCE_BOOST_SCALE * powf((float)remainingValence, -FORSYTH_VALENCE_BOOST_POWER);
+	return score;
+}
+
+//
+// MeshOpt_OptimizeVertexCache
+//
+void MeshOpt_OptimizeVertexCache(std::vector<unsigned int> &indexes, int numVertexes)
+{
+	int numTriangles = indexes.size() / 3;
+	if (numTriangles == 0)
+		return;
+
+	// Triangles using each vertex, the first remainingValence of every vertex's list are the ones not drawn yet.
+	std::vector<int> triangleOffsets(numVertexes + 1, 0);
+	std::vector<int> remainingValence(numVertexes, 0);
+	for (int i = 0; i < numTriangles * 3; i++)
+	{
+		remainingValence[indexes[i]]++;
+	}
+	for (int i = 0; i < numVertexes; i++)
+	{
+		triangleOffsets[i + 1] = triangleOffsets[i] + remainingValence[i];
+	}
+
+	std::vector<int> vertexTriangles(numTriangles * 3);
+	std::vector<int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+	for (int i = 0; i < numTriangles * 3; i++)
+	{
+		vertexTriangles[fill[indexes[i]]++] = i / 3;
+	}
+
+	std::vector<int> cachePosition(numVertexes, -1);
+	std::vector<float> vertexScore(numVertexes);
+	for (int i = 0; i < numVertexes; i++)
+	{
+		vertexScore[i] = FindVertexScore(-1, remainingValence[i]);
+	}
+
+	std::vector<float> triangleScore(numTriangles);
+	std::vector<bool> triangleAdded(numTriangles, false);
+	for (int i = 0; i < numTriangles; i++)
+	{
+		triangleScore[i] = vertexScore[indexes[i * 3 + 0]] + vertexScore[indexes[i * 3 + 1]] + vertexScore[indexes[i * 3 + 2]];
+	}
+
+	int bestTriangle = (int)(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+	int nextUnaddedTriangle = 0;
+
+	std::vector<unsigned int> optimized;
+	optimized.reserve(numTriangles * 3);
+
+	std::vector<int> cache;
+	std::vector<int> newCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+	for (int drawn = 0; drawn < numTriangles; drawn++)
+	{
+		// Nothing in the cache had triangles left, carry on with whatever hasn't been drawn yet.
+		if (bestTriangle == -1)
+		{
+			while (triangleAdded[nextUnaddedTriangle])
+			{
+				nextUnaddedTriangle++;
+			}
+			bestTriangle = nextUnaddedTriangle;
+		}
+
+		const unsigned int *triangle = &indexes[bestTriangle * 3];
+		triangleAdded[bestTriangle] = true;
+
+		newCache.clear();
+		for (int i = 0; i < 3; i++)
+		{
+			int vertex = triangle[i];
+			optimized.push_back(vertex);
+			newCache.push_back(vertex);
+
+			// Take the triangle out of the vertex's remaining list.
+			int *triangles = &vertexTriangles[triangleOffsets[vertex]];
+			for (int d = 0; d < remainingValence[vertex]; d++)
+			{
+				if (triangles[d] == bestTriangle)
+				{
+					std::swap(triangles[d], triangles[remainingValence[vertex] - 1]);
+					remainingValence[vertex]--;
+					break;
+				}
+			}
+		}
+
+		for (int i = 0; i < cache.size(); i++)
+		{
+			int vertex = cache[i];
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+			{
+				newCache.push_back(vertex);
+			}
+		}
+
+		// Everything pushed out of the cache loses its cache score.
+		for (int i = FORSYTH_CACHE_SIZE; i < newCache.size(); i++)
+		{
+			cachePosition[newCache[i]] = -1;
+			vertexScore[newCache[i]] = FindVertexScore(-1, remainingValence[newCache[i]]);
+		}
+		if (newCache.size() > FORSYTH_CACHE_SIZE)
+		{
+			newCache.resize(FORSYTH_CACHE_SIZE);
+		}
+
+		for (int i = 0; i < newCache.size(); i++)
+		{
+			cachePosition[newCache[i]] = i;
+			vertexScore[newCache[i]] = FindVertexScore(i, remainingValence[newCache[i]]);
+		}
+
+		// Only triangles touching the cache can have changed, the best of them goes next.
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (int i = 0; i < newCache.size(); i++)
+		{
+			int vertex = newCache[i];
+			const int *triangles = &vertexTriangles[triangleOffsets[vertex]];
+			for (int d = 0; d < remainingValence[vertex]; d++)
+			{
+				int t = triangles[d];
+				triangleScore[t] = vertexScore[indexes[t * 3 + 0]] + vertexScore[indexes[t * 3 + 1]] + vertexScore[indexes[t * 3 + 2]];
+				if (triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					bestTriangle = t;
+				}
+			}
+		}
+
+		cache.swap(newCache);
+	}
+
+	indexes.swap(optimized);
+}
+
+//
+// ComputeTriangleMisses
+//
+// Runs a FIFO cache over the triangles and writes how many vertexes each one had to transform.
+//
+static int ComputeTriangleMisses(const std::vector<unsigned int> &indexes, int numVertexes, unsigned char *triangleMisses)
+{
+	std::vector<unsigned int> cacheTime(numVertexes, 0);
+	unsigned int time = MESHOPT_ACMR_CACHE_SIZE + 1;
+	int totalMisses = 0;
+
+	for (int i = 0; i < indexes.size(); i += 3)
+	{
+		int misses = 0;
+		for (int d = 0; d < 3; d++)
+		{
+			unsigned int vertex = indexes[i + d];
+			if (time - cacheTime[vertex] > MESHOPT_ACMR_CACHE_SIZE)
+			{
+				cacheTime[vertex] = time++;
+				misses++;
+			}
+		}
+
+		if (triangleMisses != NULL)
+		{
+			triangleMisses[i / 3] = misses;
+		}
+		totalMisses += misses;
+	}
+
+	return totalMisses;
+}
+
+//
+// MeshOpt_ComputeACMR
+//
+float MeshOpt_ComputeACMR(const std::vector<unsigned int> &indexes, int numVertexes)
+{
+	if (indexes.size() < 3)
+		return 0.0f;
+
+	return (float)ComputeTriangleMisses(indexes, numVertexes, NULL) / (indexes.size() / 3);
+}
+
+//
+// OverdrawCluster
+//
+struct OverdrawCluster
+{
+	int startTriangle;
+	int numTriangles;
+	float sortKey;
+};
+
+//
+// MeshOpt_OptimizeOverdraw
+//
+void MeshOpt_OptimizeOverdraw(std::vector<unsigned int> &indexes, const float *positions, int positionStride, int numVertexes, float threshold)
+{
+	int numTriangles = indexes.size() / 3;
+	if (numTriangles < 2)
+		return;
+
+	const unsigned char *positionData = (const unsigned char *)positions;
+	#define POSITION(v) ((const float *)(positionData + (v) * positionStride))
+
+	// A triangle that misses on all 3 vertexes is where the cache order jumped somewhere new, clusters start there so
+	// moving them around barely changes the cache hits.
+	std::vector<unsigned char> triangleMisses(numTriangles);
+	int totalMisses = ComputeTriangleMisses(indexes, numVertexes, &triangleMisses[0]);
+
+	std::vector<OverdrawCluster> clusters;
+	for (int i = 0; i < numTriangles; i++)
+	{
+		if (i == 0 || triangleMisses[i] == 3)
+		{
+			OverdrawCluster cluster;
+			cluster.startTriangle = i;
+			cluster.numTriangles = 0;
+			cluster.sortKey = 0.0f;
+			clusters.push_back(cluster);
+		}
+		clusters.back().numTriangles++;
+	}
+
+	if (clusters.size() < 2)
+		return;
+
+	float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < numTriangles * 3; i++)
+	{
+		const float *position = POSITION(indexes[i]);
+		meshCentroid[0] += position[0];
+		meshCentroid[1] += position[1];
+		meshCentroid[2] += position[2];
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		meshCentroid[i] /= numTriangles * 3;
+	}
+
+	// Clusters whose area weighted normal points away from the middle of the mesh are likely in front of the rest.
+	for (int i = 0; i < clusters.size(); i++)
+	{
+		OverdrawCluster &cluster = clusters[i];
+		float centroid[3] = { 0.0f, 0.0f, 0.0f };
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		float totalArea = 0.0f;
+
+		for (int t = cluster.startTriangle; t < cluster.startTriangle + cluster.numTriangles; t++)
+		{
+			const float *p0 = POSITION(indexes[t * 3 + 0]);
+			const float *p1 = POSITION(indexes[t * 3 + 1]);
+			const float *p2 = POSITION(indexes[t * 3 + 2]);
+
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float area = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for (int d = 0; d < 3; d++)
+			{
+				centroid[d] += (p0[d] + p1[d] + p2[d]) * (area / 3.0f);
+				normal[d] += n[d];
+			}
+			totalArea += area;
+		}
+
+		float normalLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (totalArea <= 0.0f || normalLength <= 0.0f)
+			continue;
+
+		for (int d = 0; d < 3; d++)
+		{
+			cluster.sortKey += (centroid[d] / totalArea - meshCentroid[d]) * (normal[d] / normalLength);
+		}
+	}
+
+	#undef POSITION
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const OverdrawCluster &a, const OverdrawCluster &b) { return a.sortKey > b.sortKey; });
+
+	std::vector<unsigned int> sorted;
+	sorted.reserve(indexes.size());
+	for (int i = 0; i < clusters.size(); i++)
+	{
+		sorted.insert(sorted.end(), indexes.begin() + clusters[i].startTriangle * 3, indexes.begin() + (clusters[i].startTriangle + clusters[i].numTriangles) * 3);
+	}
+
+	if (ComputeTriangleMisses(sorted, numVertexes, NULL) <= totalMisses * threshold)
+	{
+		indexes.swap(sorted);
+	}
+}
+
+//
+// MeshOpt_OptimizeVertexFetch
+//
+int MeshOpt_OptimizeVertexFetch(void *vertexes, int numVertexes, int vertexSize, std::vector<unsigned int> &indexes)
+{
+	const unsigned char *data = (const unsigned char *)vertexes;
+	std::vector<int> remap(numVertexes, -1);
+	std::vector<unsigned char> reordered;
+	int numUsed = 0;
+
+	for (int i = 0; i < indexes.size(); i++)
+	{
+		unsigned int vertex = indexes[i];
+		if (remap[vertex] == -1)
+		{
+			remap[vertex] = numUsed++;
+			reordered.insert(reordered.end(), data + vertex * vertexSize, data + (vertex + 1) * vertexSize);
+		}
+		indexes[i] = remap[vertex];
+	}
+
+	if (numUsed > 0)
+	{
+		memcpy(vertexes, &reordered[0], numUsed * vertexSize);
+	}
+	return numUsed;
+}
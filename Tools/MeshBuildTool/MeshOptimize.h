@@ -0,0 +1,54 @@
+// MeshOptimize.h
+//
+
+#pragma once
+
+#include <vector>
+
+//
+// Triangle list optimizations for a single surface. Every function here works on indexes relative to the surface and
+// keeps no state, so surfaces can be optimized on as many threads at once as you like.
+//
+
+// Vertex cache size MeshOpt_ComputeACMR simulates, a FIFO this size is a fair stand-in for most GPUs.
+#define MESHOPT_ACMR_CACHE_SIZE 16
+
+//
+// MeshOpt_WeldVertexes
+//
+// Collapses bitwise identical vertexes, remaps the indexes and returns the new vertex count. vertexes is
+// numVertexes * vertexSize bytes and gets compacted in place.
+//
+int MeshOpt_WeldVertexes(void *vertexes, int numVertexes, int vertexSize, std::vector<unsigned int> &indexes);
+
+//
+// MeshOpt_OptimizeVertexCache
+//
+// Reorders the triangles for post transform cache hits, Tom Forsyth's linear speed vertex cache optimization.
+//
+void MeshOpt_OptimizeVertexCache(std::vector<unsigned int> &indexes, int numVertexes);
+
+//
+// MeshOpt_OptimizeOverdraw
+//
+// Splits a cache optimized triangle list into clusters at its cache flushes and sorts the clusters so the ones
+// facing out of the mesh get drawn first. The new order is only kept if it doesn't cost more than threshold times
+// the ACMR of the old one. positions points at the x of the first vertex, positionStride bytes between vertexes.
+//
+void MeshOpt_OptimizeOverdraw(std::vector<unsigned int> &indexes, const float *positions, int positionStride, int numVertexes, float threshold);
+
+//
+// MeshOpt_OptimizeVertexFetch
+//
+// Renumbers the vertexes in the order the indexes first use them so vertex fetch walks memory linearly. Vertexes no
+// triangle uses are dropped, returns the new vertex count.
+//
+int MeshOpt_OptimizeVertexFetch(void *vertexes, int numVertexes, int vertexSize, std::vector<unsigned int> &indexes);
+
+//
+// MeshOpt_ComputeACMR
+//
+// Average cache miss ratio, transformed vertexes per triangle. 3 is no reuse at all, 0.5 is the best a regular grid
+// can do.
+//
+float MeshOpt_ComputeACMR(const std::vector<unsigned int> &indexes, int numVertexes);
@@ -1,74 +1,188 @@
 // Main.cpp
 //
+// Builds game_textures.payloads out of every PNG and JPG under a directory. Images get decoded with kplib and block
+// compressed and deflated on all cores, and the payloads are streamed to disk in order as they finish, so memory
+// stays bounded no matter how big the pack is.
+//
+// A manifest with the content hash of every source image is written next to the payload file. The next run copies
+// the already compressed payload of every image whose hash did not change straight out of the old file instead of
+// encoding it again.
+//
 
-#include <windows.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <string>
 #include <vector>
-#include <stack>
-#include <direct.h>
 #include <algorithm>
-#include <assert.h>
+#include <unordered_map>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 
-#include "IL/il.h"
-#include "IL/ilu.h"
-#include "IL/ilut.h"
+typedef unsigned char byte;
 
 #include "../../DukeNukem/Third-Party/zlib/zlib.h"
+#include "lz4.h"
+#include "xxhash.h"
 #include "../../DukeNukem/Build/src/PolymerNG/TextureCache/TextureCacheFormat.h"
+#include "../../DukeNukem/Build/src/DXTCompressor/DXT5YcocgCompression.h"
 
+#ifdef _MSC_VER
 #define _CRT_SECURE_NO_WARNINGS
 #pragma warning(disable : 4996)
+#endif
 
-using namespace std;
+namespace fs = std::filesystem;
 
-bool ListFiles(string path, string mask, vector<string>& files) {
-	HANDLE hFind = INVALID_HANDLE_VALUE;
-	WIN32_FIND_DATAA ffd;
-	string spec;
-	stack<string> directories;
+// kplib.h pulls in compat.h, and its min/max macros break the standard headers.
+extern "C"
+{
+	void kpgetdim(const char *buffer, int32_t length, int32_t *xsiz, int32_t *ysiz);
+	int32_t kprender(const char *buffer, int32_t length, intptr_t frameptr, int32_t bpl, int32_t xdim, int32_t ydim);
+	void initdivtables(void);
 
-	directories.push(path);
-	files.clear();
+	// kplib's zip code wants this from cache1d, we load the files ourselves and never call it.
+	char toupperlookup[256];
+}
 
-	while (!directories.empty()) {
-		path = directories.top();
-		spec = path + "\\" + mask;
-		directories.pop();
+#define MANIFEST_IDEN			"jmtexmanifest"
+#define MANIFEST_IDEN_LENGTH	13
+#define MANIFEST_VERSION		1
 
-		hFind = FindFirstFileA(spec.c_str(), &ffd);
-		if (hFind == INVALID_HANDLE_VALUE) {
-			return false;
-		}
-		do {
-			if (strcmp(ffd.cFileName, ".") != 0 &&
-				strcmp(ffd.cFileName, "..") != 0) {
-				if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-					directories.push(path + "\\" + ffd.cFileName);
-				}
-				else 
-				{
-					if (strstr(ffd.cFileName, ".png") || strstr(ffd.cFileName, ".jpg"))
-					{
-						files.push_back(path + "\\" + ffd.cFileName);
-					}
-				}
-			}
-		} while (FindNextFileA(hFind, &ffd) != 0);
+// How far the workers can run ahead of the payload being written.
+#define MAX_PAYLOADS_IN_FLIGHT	64
+
+//
+// ManifestHeader
+//
+struct ManifestHeader
+{
+	char iden[MANIFEST_IDEN_LENGTH];
+	unsigned char version;
+	int numEntries;
+};
+
+//
+// ManifestEntry
+//
+struct ManifestEntry
+{
+	char cacheFileName[128];
+	uint64_t contentHash;
+	int codec;			// Codec that was asked for, a payload can still end up stored.
+	int reserved;
+};
+
+//
+// BuildJob
+//
+struct BuildJob
+{
+	BuildJob()
+	{
+		contentHash = 0;
+		reusePayload = -1;
+		failed = false;
+		isDone = false;
+	}
+
+	std::string fullPath;
+	std::string cacheFileName;
+	uint64_t contentHash;
+
+	// Payload in the previous file we can copy as is, -1 if it has to be encoded.
+	int reusePayload;
+
+	CachePayloadInfo info;
+	std::vector<byte> payloadData;
+	bool failed;
+	bool isDone;
+};
+
+//
+// BuildOptions
+//
+struct BuildOptions
+{
+	BuildOptions()
+	{
+		codec = TEXTURE_CACHE_CODEC_ZLIB;
+		zlibLevel = Z_BEST_COMPRESSION;
+		numThreads = 0;
+		fullRebuild = false;
+		verbose = false;
+	}
 
-		if (GetLastError() != ERROR_NO_MORE_FILES) {
-			FindClose(hFind);
+	TextureCacheCodec codec;
+	int zlibLevel;
+	int numThreads;
+	bool fullRebuild;
+	bool verbose;
+};
+
+static std::mutex kplibLock;
+
+//
+// ListFiles
+//
+static bool ListFiles(const fs::path &root, std::vector<std::string> &files)
+{
+	std::error_code error;
+	fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, error);
+	if (error)
+	{
+		printf("Failed to read %s: %s\n", root.string().c_str(), error.message().c_str());
+		return false;
+	}
+
+	for (; it != fs::recursive_directory_iterator(); it.increment(error))
+	{
+		if (error)
+		{
+			printf("Failed to read %s: %s\n", root.string().c_str(), error.message().c_str());
 			return false;
 		}
 
-		FindClose(hFind);
-		hFind = INVALID_HANDLE_VALUE;
+		if (!it->is_regular_file())
+			continue;
+
+		std::string extension = it->path().extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		if (extension == ".png" || extension == ".jpg")
+		{
+			files.push_back(it->path().string());
+		}
 	}
 
+	// Directory order differs between platforms and file systems, this keeps the output the same everywhere.
+	std::sort(files.begin(), files.end());
 	return true;
 }
 
-bool is_power_of_2(int i) 
+//
+// ReadWholeFile
+//
+static bool ReadWholeFile(const std::string &path, std::vector<char> &buffer)
+{
+	FILE *file = fopen(path.c_str(), "rb");
+	if (file == NULL)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	buffer.resize(length);
+	bool result = length == 0 || fread(&buffer[0], length, 1, file) == 1;
+	fclose(file);
+	return result;
+}
+
+static bool is_power_of_2(int i)
 {
 	if (i <= 0) {
 		return 0;
@@ -76,216 +190,559 @@ bool is_power_of_2(int i)
 	return !(i & (i - 1));
 }
 
+static int NextPowerOfTwo(int i)
+{
+	int result = 1;
+	while (result < i)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+
 //
-// Main
+// ResizeImage
 //
-int main(int argc, char **argv)
+// Bilinear, only ever used to scale up to the next power of two.
+//
+static void ResizeImage(const byte *in, int width, int height, byte *out, int outWidth, int outHeight)
+{
+	for (int y = 0; y < outHeight; y++)
+	{
+		float fy = ((y + 0.5f) * height) / outHeight - 0.5f;
+		int y0 = (fy > 0.0f) ? (int)fy : 0;
+		int y1 = (y0 + 1 < height) ? y0 + 1 : height - 1;
+		float ty = (fy > y0) ? fy - y0 : 0.0f;
+
+		for (int x = 0; x < outWidth; x++)
+		{
+			float fx = ((x + 0.5f) * width) / outWidth - 0.5f;
+			int x0 = (fx > 0.0f) ? (int)fx : 0;
+			int x1 = (x0 + 1 < width) ? x0 + 1 : width - 1;
+			float tx = (fx > x0) ? fx - x0 : 0.0f;
+
+			const byte *p00 = &in[(y0 * width + x0) * 4];
+			const byte *p10 = &in[(y0 * width + x1) * 4];
+			const byte *p01 = &in[(y1 * width + x0) * 4];
+			const byte *p11 = &in[(y1 * width + x1) * 4];
+			byte *dest = &out[(y * outWidth + x) * 4];
+
+			for (int c = 0; c < 4; c++)
+			{
+				float top = p00[c] + (p10[c] - p00[c]) * tx;
+				float bottom = p01[c] + (p11[c] - p01[c]) * tx;
+				dest[c] = (byte)(top + (bottom - top) * ty + 0.5f);
+			}
+		}
+	}
+}
+
+//
+// HasSuffix
+//
+static bool HasSuffix(const std::string &name, const char *suffix)
 {
-	vector<string> files;
+	std::string lower = name;
+	std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
 
-	char *cwd = _getcwd(NULL, 0);
+	return strstr(lower.c_str(), (std::string(suffix) + ".png").c_str()) || strstr(lower.c_str(), (std::string(suffix) + ".jpg").c_str());
+}
 
-	printf("VirtualTextureBuilder v0.01 by Justin Marshall\n");
-	printf("Finding PNG files...\n");
-	if (!ListFiles(cwd, "*", files))
+//
+// CompressPayload
+//
+// Deflates or lz4's the block data into job.payloadData, falls back to storing it if it doesn't get any smaller.
+//
+static void CompressPayload(BuildJob &job, const std::vector<byte> &blocks, const BuildOptions &options)
+{
+	int length = blocks.size();
+	int compressedLength = 0;
+
+	if (options.codec == TEXTURE_CACHE_CODEC_LZ4)
 	{
-		return 0;
+		job.payloadData.resize(LZ4_compressBound(length));
+		compressedLength = LZ4_compress((const char *)&blocks[0], (char *)&job.payloadData[0], length);
 	}
+	else
+	{
+		z_stream defstream;
+		memset(&defstream, 0, sizeof(defstream));
 
-	printf("Found %d assets\n", files.size());
+		deflateInit(&defstream, options.zlibLevel);
+		job.payloadData.resize(deflateBound(&defstream, length));
 
-	ilInit();
+		defstream.avail_in = length;
+		defstream.next_in = (Bytef *)&blocks[0];
+		defstream.avail_out = job.payloadData.size();
+		defstream.next_out = (Bytef *)&job.payloadData[0];
 
-	std::vector<CachePayloadInternal> payloads;
-	payloads.reserve(files.size());
+		int result = deflate(&defstream, Z_FINISH);
+		if (result == Z_STREAM_END)
+			compressedLength = defstream.total_out;
+		deflateEnd(&defstream);
+	}
 
-	int numNonPowerOfTwoImages = 0;
-	// Loop through all the images
-	for (int i = 0; i < files.size(); i++)
+	job.info.decompressedPayloadLength = length;
+	if (compressedLength <= 0 || compressedLength >= length)
 	{
-		if (!ilLoadImage(files[i].c_str()))
+		job.info.codec = TEXTURE_CACHE_CODEC_STORED;
+		job.info.compressedPayloadLength = length;
+		job.payloadData = blocks;
+	}
+	else
+	{
+		job.info.codec = options.codec;
+		job.info.compressedPayloadLength = compressedLength;
+		job.payloadData.resize(compressedLength);
+	}
+}
+
+//
+// EncodeImage
+//
+static bool EncodeImage(BuildJob &job, const std::vector<char> &fileData, const BuildOptions &options)
+{
+	int32_t width = 0, height = 0;
+	std::vector<byte> pixels;
+
+	// kplib decodes through a pile of globals, so only one image at a time gets to use it.
+	{
+		std::lock_guard<std::mutex> lock(kplibLock);
+
+		kpgetdim(&fileData[0], fileData.size(), &width, &height);
+		if (width <= 0 || height <= 0)
 		{
-			printf("ilLoadImage: Failed to load %s\n", files[i].c_str());
-			return 0;
+			printf("kpgetdim: Failed to load %s\n", job.fullPath.c_str());
+			return false;
 		}
 
-		ILinfo imageinfo;
-		iluGetImageInfo(&imageinfo);
-		if (!is_power_of_2(imageinfo.Width) || !is_power_of_2(imageinfo.Height))
+		pixels.resize(width * height * 4);
+		if (kprender(&fileData[0], fileData.size(), (intptr_t)&pixels[0], width * 4, width, height) < 0)
 		{
-			int scaled_width, scaled_height;
-			for (scaled_width = 1; scaled_width < imageinfo.Width; scaled_width <<= 1)
-			{
+			printf("kprender: Failed to load %s\n", job.fullPath.c_str());
+			return false;
+		}
+	}
 
-			}
-			for (scaled_height = 1; scaled_height < imageinfo.Height; scaled_height <<= 1)
-			{
+	// kplib hands back BGRA.
+	bool hasAlpha = false;
+	for (int i = 0; i < width * height; i++)
+	{
+		std::swap(pixels[i * 4 + 0], pixels[i * 4 + 2]);
+		hasAlpha |= pixels[i * 4 + 3] != 255;
+	}
 
-			}
-			printf("Making Payload %s with stats RESIZED (%dx%d) from (%dx%d)\n", files[i].c_str(), scaled_width, scaled_height, imageinfo.Width, imageinfo.Height);
+	if (!is_power_of_2(width) || !is_power_of_2(height))
+	{
+		int scaledWidth = NextPowerOfTwo(width);
+		int scaledHeight = NextPowerOfTwo(height);
 
-			iluScale(scaled_width, scaled_height, ilGetInteger(IL_IMAGE_DEPTH));
+		if (options.verbose)
+			printf("Resizing %s to (%dx%d) from (%dx%d)\n", job.cacheFileName.c_str(), scaledWidth, scaledHeight, width, height);
+
+		std::vector<byte> scaled(scaledWidth * scaledHeight * 4);
+		ResizeImage(&pixels[0], width, height, &scaled[0], scaledWidth, scaledHeight);
+		pixels.swap(scaled);
+		width = scaledWidth;
+		height = scaledHeight;
+	}
 
-			iluGetImageInfo(&imageinfo);
+	// _n images are normal maps, x goes in alpha where the shaders read it. _s images are specular maps.
+	if (HasSuffix(job.cacheFileName, "_n"))
+	{
+		job.info.format = TEXTURE_CACHE_BC3;
+		for (int i = 0; i < width * height; i++)
+		{
+			pixels[i * 4 + 3] = pixels[i * 4 + 0];
+			pixels[i * 4 + 0] = 0;
+		}
+	}
+	else if (HasSuffix(job.cacheFileName, "_s") || !hasAlpha)
+	{
+		job.info.format = TEXTURE_CACHE_DXT1;
+	}
+	else
+	{
+		job.info.format = TEXTURE_CACHE_DXT5;
+	}
+
+	int blockSize = (job.info.format == TEXTURE_CACHE_DXT1) ? 8 : 16;
+	std::vector<byte> blocks(DXT_GetCompressedSize(width, height, blockSize));
+
+	int outputBytes = 0;
+	if (job.info.format == TEXTURE_CACHE_DXT1)
+	{
+		CompressImageDXT1(&pixels[0], &blocks[0], width, height, outputBytes);
+	}
+	else
+	{
+		CompressImageDXT5(&pixels[0], &blocks[0], width, height, outputBytes);
+	}
+
+	job.info.width = width;
+	job.info.height = height;
+
+	CompressPayload(job, blocks, options);
+	return true;
+}
+
+//
+// LoadPreviousBuild
+//
+// Reads the payload infos and the manifest of the last run, returns false if there is nothing we can reuse.
+//
+static bool LoadPreviousBuild(FILE *previousFile, const char *manifestFileName, std::vector<CachePayloadInfo> &previousInfos, std::unordered_map<std::string, int> &previousPayloads, std::vector<ManifestEntry> &previousManifest)
+{
+	PayloadHeader header;
+	if (fread(&header, sizeof(PayloadHeader), 1, previousFile) != 1)
+		return false;
+
+	if (memcmp(header.iden, PAYLOAD_IDEN, PAYLOAD_IDEN_LENGTH) || header.version != PAYLOAD_VERSION || header.numPayloads <= 0)
+		return false;
+
+	previousInfos.resize(header.numPayloads);
+	if (fread(&previousInfos[0], sizeof(CachePayloadInfo), header.numPayloads, previousFile) != header.numPayloads)
+		return false;
+
+	FILE *manifestFile = fopen(manifestFileName, "rb");
+	if (manifestFile == NULL)
+		return false;
+
+	ManifestHeader manifestHeader;
+	bool result = fread(&manifestHeader, sizeof(ManifestHeader), 1, manifestFile) == 1;
+	result = result && !memcmp(manifestHeader.iden, MANIFEST_IDEN, MANIFEST_IDEN_LENGTH) && manifestHeader.version == MANIFEST_VERSION;
+	result = result && manifestHeader.numEntries == header.numPayloads;
+	if (result)
+	{
+		previousManifest.resize(manifestHeader.numEntries);
+		result = fread(&previousManifest[0], sizeof(ManifestEntry), manifestHeader.numEntries, manifestFile) == manifestHeader.numEntries;
+	}
+	fclose(manifestFile);
+
+	if (!result)
+		return false;
+
+	for (int i = 0; i < header.numPayloads; i++)
+	{
+		previousPayloads[previousInfos[i].cacheFileName] = i;
+	}
+
+	return true;
+}
+
+//
+// PrintUsage
+//
+static void PrintUsage()
+{
+	printf("Usage: VirtualTextureBuildTool [options] [directory]\n");
+	printf("  -lz4          trades some file size for much faster loads\n");
+	printf("  -level <n>    zlib level, 0-9, defaults to 9\n");
+	printf("  -threads <n>  worker threads, defaults to one per core\n");
+	printf("  -full         re-encodes every image even if it didn't change\n");
+	printf("  -v            prints every payload\n");
+}
+
+//
+// Main
+//
+int main(int argc, char **argv)
+{
+	BuildOptions options;
+	fs::path root = fs::current_path();
+
+	printf("VirtualTextureBuilder v0.02 by Justin Marshall\n");
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-lz4"))
+		{
+			options.codec = TEXTURE_CACHE_CODEC_LZ4;
+		}
+		else if (!strcmp(argv[i], "-level") && i + 1 < argc)
+		{
+			options.zlibLevel = std::min(std::max(atoi(argv[++i]), 0), 9);
+		}
+		else if (!strcmp(argv[i], "-threads") && i + 1 < argc)
+		{
+			options.numThreads = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "-full"))
+		{
+			options.fullRebuild = true;
+		}
+		else if (!strcmp(argv[i], "-v"))
+		{
+			options.verbose = true;
+		}
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage();
+			return 1;
 		}
 		else
 		{
-			printf("Making Payload %s with stats (%dx%d)\n", files[i].c_str(), imageinfo.Width, imageinfo.Height);
+			root = argv[i];
 		}
+	}
+
+	// kplib divides through these.
+	initdivtables();
+
+	if (options.numThreads <= 0)
+	{
+		options.numThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+	}
+
+	printf("Finding PNG and JPG files...\n");
+	std::vector<std::string> files;
+	if (!ListFiles(root, files))
+	{
+		return 1;
+	}
 
-		CachePayloadInternal payload;
-		ILenum compressionFormat = IL_DXT5;
-		payload.info.format = TEXTURE_CACHE_DXT5;
+	printf("Found %d assets\n", (int)files.size());
+	if (files.empty())
+	{
+		return 0;
+	}
 
-		// HACK _n.png/jpg and _s.png/jpg
-		if (strstr(files[i].c_str(), "_n.png") || strstr(files[i].c_str(), "_n.jpg"))
+	std::vector<BuildJob> jobs(files.size());
+	for (int i = 0; i < files.size(); i++)
+	{
+		std::string name = fs::relative(files[i], root).string();
+		if (name.size() >= sizeof(jobs[i].info.cacheFileName))
 		{
-			if (is_power_of_2(imageinfo.Width) && is_power_of_2(imageinfo.Height))
-			{
-				compressionFormat = IL_RXGB;
-				payload.info.format = TEXTURE_CACHE_BC3;
-				printf("...Using BC3 compression\n");
-			}
-			else
-			{
-				//char temp[1024];
-				//sprintf(temp, "Detected NON POT - %d (%s - %dx%d)\n", numNonPowerOfTwoImages, files[i].c_str(), imageinfo.Width, imageinfo.Height);
-				//OutputDebugStringA(temp);
-				//payload.info.format = TEXTURE_CACHE_UNCOMPRESSED;
-				//numNonPowerOfTwoImages++;
-				//printf("...Using TEXTURE_CACHE_UNCOMPRESSED because non power of 2\n");
-				assert(0);
-			}
+			printf("%s: name is longer than %d characters\n", name.c_str(), (int)sizeof(jobs[i].info.cacheFileName) - 1);
+			return 1;
 		}
-		else if (strstr(files[i].c_str(), "_s.png") || strstr(files[i].c_str(), "_s.jpg"))
+
+		jobs[i].fullPath = files[i];
+		jobs[i].cacheFileName = name;
+		strcpy(jobs[i].info.cacheFileName, name.c_str());
+	}
+
+	const std::string payloadFileName = (root / "game_textures.payloads").string();
+	const std::string manifestFileName = payloadFileName + ".manifest";
+	const std::string tempFileName = payloadFileName + ".tmp";
+
+	// See what the last run left us.
+	std::vector<CachePayloadInfo> previousInfos;
+	std::unordered_map<std::string, int> previousPayloads;
+	std::vector<ManifestEntry> previousManifest;
+	FILE *previousFile = NULL;
+	if (!options.fullRebuild)
+	{
+		previousFile = fopen(payloadFileName.c_str(), "rb");
+		if (previousFile != NULL && !LoadPreviousBuild(previousFile, manifestFileName.c_str(), previousInfos, previousPayloads, previousManifest))
 		{
-			compressionFormat = IL_DXT1;
-			payload.info.format = TEXTURE_CACHE_DXT1;
-			printf("...Using DXT1 compression\n");
+			printf("No usable previous build, encoding everything\n");
+			fclose(previousFile);
+			previousFile = NULL;
 		}
-		else
+	}
+
+	FILE *cacheFile = fopen(tempFileName.c_str(), "wb");
+	if (cacheFile == NULL)
+	{
+		printf("Failed to open %s for writing\n", tempFileName.c_str());
+		return 1;
+	}
+
+	PayloadHeader header;
+	header.numPayloads = jobs.size();
+	fwrite(&header, sizeof(PayloadHeader), 1, cacheFile);
+
+	// The payload infos get filled in once we know where everything ended up.
+	long payloadInfoPosition = ftell(cacheFile);
+	for (int i = 0; i < jobs.size(); i++)
+	{
+		fwrite(&jobs[i].info, sizeof(CachePayloadInfo), 1, cacheFile);
+	}
+
+	// Write out the name index, sorted by hash so it can be searched in place.
+	std::vector<CachePayloadIndexEntry> index(jobs.size());
+	for (int i = 0; i < jobs.size(); i++)
+	{
+		index[i].nameHash = TextureCache_HashName(jobs[i].info.cacheFileName);
+		index[i].payloadNum = i;
+		index[i].reserved = 0;
+	}
+	std::sort(index.begin(), index.end(), [](const CachePayloadIndexEntry &a, const CachePayloadIndexEntry &b) { return a.nameHash < b.nameHash; });
+	fwrite(&index[0], sizeof(CachePayloadIndexEntry), index.size(), cacheFile);
+
+	printf("Building %d payloads on %d threads...\n", (int)jobs.size(), options.numThreads);
+	auto startTime = std::chrono::steady_clock::now();
+
+	std::mutex jobLock;
+	std::condition_variable jobDone;
+	std::condition_variable jobWritten;
+	std::atomic<int> nextJob(0);
+	int numWritten = 0;
+
+	auto worker = [&]()
+	{
+		std::vector<char> fileData;
+		for (;;)
 		{
-			if (is_power_of_2(imageinfo.Width) && is_power_of_2(imageinfo.Height))
+			int jobNum = nextJob++;
+			if (jobNum >= jobs.size())
+				break;
+
+			// Don't get too far ahead of the writer, everything in flight is held in memory.
+			{
+				std::unique_lock<std::mutex> lock(jobLock);
+				jobWritten.wait(lock, [&] { return jobNum < numWritten + MAX_PAYLOADS_IN_FLIGHT; });
+			}
+
+			BuildJob &job = jobs[jobNum];
+			if (!ReadWholeFile(job.fullPath, fileData) || fileData.empty())
+			{
+				printf("Failed to read %s\n", job.fullPath.c_str());
+				job.failed = true;
+			}
+			else
 			{
-				// I hate DevIL, I can't figure how to know if there is a alpha channel or not when the PNG was compressed with using
-				// there awful PNG index system. Oh well, just force indexed palettes to have a alpha for the time being. :/.
-				if (imageinfo.Format == IL_RGBA || imageinfo.Format == IL_COLOUR_INDEX)
+				job.contentHash = XXH64(&fileData[0], fileData.size(), 0);
+
+				auto previous = previousPayloads.find(job.cacheFileName);
+				if (previous != previousPayloads.end() && previousManifest[previous->second].contentHash == job.contentHash && previousManifest[previous->second].codec == options.codec)
 				{
-					compressionFormat = IL_DXT5;
-					payload.info.format = TEXTURE_CACHE_DXT5;
-					printf("...Using DXT5 compression(alpha channel detected)\n");
+					job.reusePayload = previous->second;
 				}
 				else
 				{
-					compressionFormat = IL_DXT1;
-					payload.info.format = TEXTURE_CACHE_DXT1;
-					printf("...Using DXT1 compression(no alpha channel detected)\n");
+					job.failed = !EncodeImage(job, fileData, options);
 				}
 			}
-			else
+
 			{
-				//char temp[1024];
-				//sprintf(temp, "Detected NON POT - %d (%s - %dx%d)\n", numNonPowerOfTwoImages, files[i].c_str(), imageinfo.Width, imageinfo.Height);
-				//OutputDebugStringA(temp);
-				//payload.info.format = TEXTURE_CACHE_UNCOMPRESSED;
-				//numNonPowerOfTwoImages++;
-				//printf("...Using TEXTURE_CACHE_UNCOMPRESSED because non power of 2\n");
-				assert(0);
+				std::lock_guard<std::mutex> lock(jobLock);
+				job.isDone = true;
 			}
+			jobDone.notify_all();
 		}
+	};
 
-		payload.info.decompressedPayloadLength = imageinfo.SizeOfData;
+	std::vector<std::thread> workers;
+	for (int i = 0; i < options.numThreads; i++)
+	{
+		workers.push_back(std::thread(worker));
+	}
 
-		if (payload.info.format == TEXTURE_CACHE_UNCOMPRESSED)
+	// Stream the payloads out in order as they finish.
+	int numReused = 0;
+	bool failed = false;
+	std::vector<byte> copyBuffer;
+	for (int i = 0; i < jobs.size(); i++)
+	{
+		BuildJob &job = jobs[i];
 		{
-			payload.info.decompressedPayloadLength = imageinfo.Width * imageinfo.Height * 4;
-			payload.compressedDataBlob = new byte[payload.info.decompressedPayloadLength];
-			payload.zlibDataBlob = new byte[payload.info.decompressedPayloadLength]; // Allocate the zlib data blob to be the same size as the dxt5 data blob.
+			std::unique_lock<std::mutex> lock(jobLock);
+			jobDone.wait(lock, [&] { return job.isDone; });
+		}
 
-			byte *palette = ilGetPalette();
+		if (job.failed)
+		{
+			failed = true;
+		}
+		else if (job.reusePayload != -1)
+		{
+			const CachePayloadInfo &previousInfo = previousInfos[job.reusePayload];
+			job.info = previousInfo;
+			job.info.startPosition = ftell(cacheFile);
 
-			if (palette == NULL)
-			{
-				ilConvertImage(IL_RGBA, IL_BYTE);
-				iluGetImageInfo(&imageinfo);
-				memcpy(payload.compressedDataBlob, imageinfo.Data, payload.info.decompressedPayloadLength);
-			}
-			else
+			copyBuffer.resize(previousInfo.compressedPayloadLength);
+			fseek(previousFile, previousInfo.startPosition, SEEK_SET);
+			if (fread(&copyBuffer[0], previousInfo.compressedPayloadLength, 1, previousFile) != 1)
 			{
-				for (int d = 0, f = 0; d < imageinfo.Width * imageinfo.Height; d++, f+=4)
-				{
-					byte *pal = &palette[imageinfo.Data[d]];
-					payload.compressedDataBlob[f + 0] = pal[0];
-					payload.compressedDataBlob[f + 1] = pal[1];
-					payload.compressedDataBlob[f + 2] = pal[2];
-					payload.compressedDataBlob[f + 3] = 255;
-				}
+				printf("Failed to read %s from the previous payload file\n", job.cacheFileName.c_str());
+				failed = true;
 			}
+			fwrite(&copyBuffer[0], previousInfo.compressedPayloadLength, 1, cacheFile);
+			numReused++;
 		}
 		else
 		{
-			payload.compressedDataBlob = new byte[payload.info.decompressedPayloadLength];
-			payload.zlibDataBlob = new byte[payload.info.decompressedPayloadLength]; // Allocate the zlib data blob to be the same size as the dxt5 data blob.
-			if (!ilGetDXTCData(payload.compressedDataBlob, payload.info.decompressedPayloadLength, compressionFormat))
+			job.info.startPosition = ftell(cacheFile);
+			fwrite(&job.payloadData[0], job.info.compressedPayloadLength, 1, cacheFile);
+
+			if (options.verbose)
 			{
-				printf("ilImageToDxtcData: Failed to convert image\n");
-				return 0;
+				printf("Payload (%d/%d) %s (%dx%d) %d bytes to %d bytes\n", i + 1, (int)jobs.size(), job.cacheFileName.c_str(), job.info.width, job.info.height, job.info.decompressedPayloadLength, job.info.compressedPayloadLength);
 			}
 		}
-		std::replace(files[i].begin(), files[i].end(), '\\', '/');
-		strcpy(payload.info.cacheFileName, files[i].c_str() + strlen(cwd) + 1);
-		payload.info.width = imageinfo.Width;
-		payload.info.height = imageinfo.Height;
-		payloads.push_back(payload);
-	}
 
-	printf("Writing game payload file...\n");
+		std::vector<byte>().swap(job.payloadData);
 
-	// Write out our payload info's.
-	FILE *cacheFile = fopen("game_textures.payloads", "wb");
-	PayloadHeader header;
-	header.numPayloads = files.size();
-	fwrite(&header, sizeof(PayloadHeader), 1, cacheFile);
+		{
+			std::lock_guard<std::mutex> lock(jobLock);
+			numWritten = i + 1;
+		}
+		jobWritten.notify_all();
 
-	int payloadStartPosition = ftell(cacheFile);
-	for (int i = 0; i < files.size(); i++)
+		if (!options.verbose && ((i + 1) % 256 == 0 || i + 1 == jobs.size()))
+		{
+			printf("..%d/%d payloads\n", i + 1, (int)jobs.size());
+		}
+	}
+
+	for (int i = 0; i < workers.size(); i++)
 	{
-		fwrite(&payloads[i].info, sizeof(CachePayloadInfo), 1, cacheFile);
+		workers[i].join();
 	}
 
-	// zlib struct
-	z_stream defstream;
-	defstream.zalloc = Z_NULL;
-	defstream.zfree = Z_NULL;
-	defstream.opaque = Z_NULL;
+	if (previousFile != NULL)
+	{
+		fclose(previousFile);
+	}
 
-	// Now write out all the payloads, while recording were each payload is in the file.
-	for (int i = 0; i < files.size(); i++)
+	// Re-write the header with the payload info.
+	fseek(cacheFile, payloadInfoPosition, SEEK_SET);
+	for (int i = 0; i < jobs.size(); i++)
 	{
-		printf("Compressing Payload (%d/%d)", i, files.size());
+		fwrite(&jobs[i].info, sizeof(CachePayloadInfo), 1, cacheFile);
+	}
 
-		defstream.avail_in = payloads[i].info.decompressedPayloadLength; // size of input, string + terminator
-		defstream.next_in = (Bytef *)payloads[i].compressedDataBlob; // input char array
-		defstream.avail_out = payloads[i].info.decompressedPayloadLength; // size of output
-		defstream.next_out = (Bytef *)payloads[i].zlibDataBlob; // output char array
+	fclose(cacheFile);
 
-		deflateInit(&defstream, Z_BEST_COMPRESSION);
-		deflate(&defstream, Z_FINISH);
-		deflateEnd(&defstream);
+	if (failed)
+	{
+		remove(tempFileName.c_str());
+		return 1;
+	}
 
-		payloads[i].info.startPosition = ftell(cacheFile);
-		payloads[i].info.compressedPayloadLength = defstream.total_out;
-		fwrite(payloads[i].zlibDataBlob, defstream.total_out, 1, cacheFile);		
-		printf(" %d bytes zlib compressed to %d bytes\n", payloads[i].info.decompressedPayloadLength, payloads[i].info.compressedPayloadLength);
+	std::error_code error;
+	fs::rename(tempFileName, payloadFileName, error);
+	if (error)
+	{
+		printf("Failed to replace %s: %s\n", payloadFileName.c_str(), error.message().c_str());
+		return 1;
 	}
 
-	// Re-write the header with the payload info.
-	fseek(cacheFile, payloadStartPosition, SEEK_SET);
-	for (int i = 0; i < files.size(); i++)
+	// Only written once the payloads are in place, a run that dies halfway leaves the last good pair behind.
+	FILE *manifestFile = fopen(manifestFileName.c_str(), "wb");
+	if (manifestFile != NULL)
 	{
-		fwrite(&payloads[i].info, sizeof(CachePayloadInfo), 1, cacheFile);
+		ManifestHeader manifestHeader;
+		memcpy(manifestHeader.iden, MANIFEST_IDEN, MANIFEST_IDEN_LENGTH);
+		manifestHeader.version = MANIFEST_VERSION;
+		manifestHeader.numEntries = jobs.size();
+		fwrite(&manifestHeader, sizeof(ManifestHeader), 1, manifestFile);
+
+		for (int i = 0; i < jobs.size(); i++)
+		{
+			ManifestEntry entry;
+			memset(&entry, 0, sizeof(entry));
+			strcpy(entry.cacheFileName, jobs[i].info.cacheFileName);
+			entry.contentHash = jobs[i].contentHash;
+			entry.codec = options.codec;
+			fwrite(&entry, sizeof(ManifestEntry), 1, manifestFile);
+		}
+		fclose(manifestFile);
 	}
 
-	fclose(cacheFile);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	printf("Wrote %d payloads, %d encoded and %d reused, in %.1f seconds\n", (int)jobs.size(), (int)jobs.size() - numReused, numReused, seconds);
 	return 0;
-}
\ No newline at end of file
+}